@@ -48,13 +48,48 @@ typedef struct ParserNum
 
 /** Static Globals *************************************************/
 static GHashTable   *variable_bindings = NULL;
-static ParseError    last_error        = PARSER_NO_ERROR;
-static GNCParseError last_gncp_error   = NO_ERR;
 static gboolean      parser_inited     = FALSE;
+static GHashTable   *compiled_exprs    = NULL;
+
+/* The errors belong to the thread which parsed, so that compiled
+ * expressions can be evaluated on several threads at once.  Both
+ * enums start at zero for "no error". */
+static GPrivate      last_error_key      = G_PRIVATE_INIT (NULL);
+static GPrivate      last_gncp_error_key = G_PRIVATE_INIT (NULL);
+
+/* Guards the variable bindings, the compiled expression cache and the
+ * parser itself, none of which is reentrant. */
+G_LOCK_DEFINE_STATIC (parser_state);
+
+static void gnc_exp_cache_clear (void);
 
 
 /** Implementations ************************************************/
 
+static void
+set_last_error (ParseError error)
+{
+    g_private_set (&last_error_key, GINT_TO_POINTER (error));
+}
+
+static ParseError
+get_last_error (void)
+{
+    return (ParseError) GPOINTER_TO_INT (g_private_get (&last_error_key));
+}
+
+static void
+set_last_gncp_error (GNCParseError error)
+{
+    g_private_set (&last_gncp_error_key, GINT_TO_POINTER (error));
+}
+
+static GNCParseError
+get_last_gncp_error (void)
+{
+    return (GNCParseError) GPOINTER_TO_INT (g_private_get (&last_gncp_error_key));
+}
+
 static gchar *
 gnc_exp_parser_filname (void)
 {
@@ -131,6 +166,8 @@ gnc_exp_parser_shutdown (void)
     GKeyFile* key_file;
     gchar *filename;
 
+    gnc_exp_cache_clear ();
+
     if (!parser_inited)
         return;
 
@@ -148,8 +185,8 @@ gnc_exp_parser_shutdown (void)
     g_hash_table_destroy (variable_bindings);
     variable_bindings = NULL;
 
-    last_error = PARSER_NO_ERROR;
-    last_gncp_error = NO_ERR;
+    set_last_error (PARSER_NO_ERROR);
+    set_last_gncp_error (NO_ERR);
 
     parser_inited = FALSE;
 }
@@ -465,7 +502,7 @@ gnc_exp_parser_parse( const char * expression, gnc_numeric *value_p,
     if ( !allVarsHaveValues )
     {
         toRet = FALSE;
-        last_gncp_error = VARIABLE_IN_EXP;
+        set_last_gncp_error (VARIABLE_IN_EXP);
     }
 
 cleanup:
@@ -487,10 +524,13 @@ gnc_exp_parser_parse_separate_vars (const char * expression,
     var_store result;
     char * error_loc;
     ParserNum *pnum;
+    ParseError error;
 
     if (expression == NULL)
         return FALSE;
 
+    G_LOCK (parser_state);
+
     if (!parser_inited)
         gnc_exp_parser_real_init ( (varHash == NULL) );
 
@@ -522,7 +562,7 @@ gnc_exp_parser_parse_separate_vars (const char * expression,
             if (error_loc_p != NULL)
                 *error_loc_p = (char *) expression;
 
-            last_error = NUMERIC_ERROR;
+            error = NUMERIC_ERROR;
         }
         else
         {
@@ -538,7 +578,7 @@ gnc_exp_parser_parse_separate_vars (const char * expression,
             if (error_loc_p != NULL)
                 *error_loc_p = NULL;
 
-            last_error = PARSER_NO_ERROR;
+            error = PARSER_NO_ERROR;
         }
     }
     else
@@ -546,7 +586,7 @@ gnc_exp_parser_parse_separate_vars (const char * expression,
         if (error_loc_p != NULL)
             *error_loc_p = error_loc;
 
-        last_error = get_parse_error (pe);
+        error = get_parse_error (pe);
     }
 
     if ( varHash != NULL )
@@ -584,15 +624,563 @@ gnc_exp_parser_parse_separate_vars (const char * expression,
 
     exit_parser (pe);
 
-    return last_error == PARSER_NO_ERROR;
+    G_UNLOCK (parser_state);
+
+    set_last_error (error);
+    return error == PARSER_NO_ERROR;
+}
+
+/** Compiled expressions *******************************************/
+
+/* Compiled expressions are the side-effect free subset of the parser's
+ * grammar: numbers, variables, binary + - * /, unary signs and
+ * parentheses.  Anything else (assignments, strings, functions and
+ * every syntax error) is left to the full parser, so that errors are
+ * still reported exactly where it reports them.  Unary minus on a
+ * bare variable is left to it too, because it negates the variable in
+ * place.  The compiler follows the structure of the recursive descent
+ * parser in calculation/expression_parser.cpp, so that precedence and
+ * associativity, and with them the rounding of the gnc_numeric
+ * operations, come out the same. */
+
+#define GEP_OP_NUM      'I'
+#define GEP_OP_VAR      'V'
+#define GEP_OP_NEG      'N'
+
+#define GEP_MAX_DEPTH   32
+#define GEP_MAX_SLOTS   32
+#define GEP_MAX_NAME    127
+#define GEP_CACHE_SIZE  256
+
+typedef struct
+{
+    char        op;     /* ADD_OP, SUB_OP, MUL_OP, DIV_OP or GEP_OP_* */
+    int         slot;   /* variable slot for GEP_OP_VAR */
+    gnc_numeric value;  /* operand for GEP_OP_NUM */
+} GEPInstr;
+
+struct GNCExpProgram
+{
+    GEPInstr *code;     /* NULL if the expression can't be compiled */
+    int       n_code;
+    char    **slots;    /* variable names, in order of first use */
+    int       n_slots;
+};
+
+typedef struct
+{
+    const char *parse_str;
+    char        token;
+    char        name[GEP_MAX_NAME + 1];
+    gnc_numeric number;
+    char        tokens[4];      /* the first tokens, for the "(num)" rule */
+    int         n_tokens;
+    GArray     *code;
+    GPtrArray  *slots;
+    int         depth;
+    gboolean    failed;
+} GEPCompiler;
+
+static void
+gep_next_token (GEPCompiler *gc)
+{
+    const char *str = gc->parse_str;
+    char *end;
+
+    while (isspace (*str))
+        str++;
+
+    if (!*str)
+    {
+        gc->token = EOS;
+        gc->parse_str = str;
+        return;
+    }
+
+    if (strchr ("+-*/()", *str))
+    {
+        gc->token = *str++;
+        /* compound assignment */
+        if (*str == ASN_OP)
+            gc->failed = TRUE;
+    }
+    else if (isalpha (*str) || (*str == '_'))
+    {
+        int len = 0;
+
+        while ((*str == '_') || isalpha (*str) || isdigit (*str))
+        {
+            if (len == GEP_MAX_NAME)
+            {
+                gc->failed = TRUE;
+                return;
+            }
+            gc->name[len++] = *str++;
+        }
+        gc->name[len] = EOS;
+        /* function call */
+        if (*str == '(')
+            gc->failed = TRUE;
+        gc->token = GEP_OP_VAR;
+    }
+    else if (!strchr ("=:\"", *str)
+             && xaccParseAmount (str, TRUE, &gc->number, &end))
+    {
+        gc->token = GEP_OP_NUM;
+        str = end;
+    }
+    else
+    {
+        gc->failed = TRUE;
+        return;
+    }
+
+    if (gc->n_tokens < (int) sizeof (gc->tokens))
+        gc->tokens[gc->n_tokens] = gc->token;
+    gc->n_tokens++;
+    gc->parse_str = str;
+}
+
+static void
+gep_emit (GEPCompiler *gc, char op, int slot, gnc_numeric value)
+{
+    GEPInstr instr;
+
+    instr.op = op;
+    instr.slot = slot;
+    instr.value = value;
+    g_array_append_val (gc->code, instr);
+
+    if ((op == GEP_OP_NUM) || (op == GEP_OP_VAR))
+    {
+        if (++gc->depth > GEP_MAX_DEPTH)
+            gc->failed = TRUE;
+    }
+    else if (op != GEP_OP_NEG)
+    {
+        gc->depth--;
+    }
+}
+
+static int
+gep_slot (GEPCompiler *gc, const char *name)
+{
+    guint i;
+
+    for (i = 0; i < gc->slots->len; i++)
+        if (strcmp ((char *) g_ptr_array_index (gc->slots, i), name) == 0)
+            return i;
+
+    if (gc->slots->len == GEP_MAX_SLOTS)
+    {
+        gc->failed = TRUE;
+        return 0;
+    }
+
+    g_ptr_array_add (gc->slots, g_strdup (name));
+    return gc->slots->len - 1;
+}
+
+static gboolean gep_add_sub (GEPCompiler *gc);
+
+/* Returns TRUE if the value left on the stack is a bare variable. */
+static gboolean
+gep_primary (GEPCompiler *gc)
+{
+    char ltoken = gc->token;
+    gnc_numeric number = gc->number;
+    gboolean is_var = FALSE;
+    int slot = 0;
+
+    if (ltoken == GEP_OP_VAR)
+        slot = gep_slot (gc, gc->name);
+
+    gep_next_token (gc);
+    if (gc->failed)
+        return FALSE;
+
+    switch (ltoken)
+    {
+    case '(':
+        is_var = gep_add_sub (gc);
+        if (gc->failed)
+            return FALSE;
+        if (gc->token != ')')
+        {
+            gc->failed = TRUE;
+            return FALSE;
+        }
+        gep_next_token (gc);
+        break;
+
+    case ADD_OP:
+    case SUB_OP:
+        is_var = gep_primary (gc);
+        if (gc->failed)
+            return FALSE;
+        if (ltoken == SUB_OP)
+        {
+            if (is_var)
+                gc->failed = TRUE;
+            else
+                gep_emit (gc, GEP_OP_NEG, 0, gnc_numeric_zero ());
+        }
+        break;
+
+    case GEP_OP_NUM:
+    case GEP_OP_VAR:
+        if ((gc->token == GEP_OP_NUM) || (gc->token == GEP_OP_VAR))
+        {
+            gc->failed = TRUE;
+            return FALSE;
+        }
+        gep_emit (gc, ltoken, slot, number);
+        is_var = (ltoken == GEP_OP_VAR);
+        break;
+
+    default:
+        gc->failed = TRUE;
+        break;
+    }
+
+    return is_var;
+}
+
+static gboolean
+gep_mul_div (GEPCompiler *gc)
+{
+    gboolean is_var;
+    char op;
+
+    is_var = gep_primary (gc);
+
+    while (!gc->failed && ((gc->token == MUL_OP) || (gc->token == DIV_OP)))
+    {
+        op = gc->token;
+        gep_next_token (gc);
+        if (gc->failed)
+            break;
+        gep_primary (gc);
+        gep_emit (gc, op, 0, gnc_numeric_zero ());
+        is_var = FALSE;
+    }
+
+    return is_var;
+}
+
+static gboolean
+gep_add_sub (GEPCompiler *gc)
+{
+    gboolean is_var;
+    char op;
+
+    is_var = gep_mul_div (gc);
+
+    while (!gc->failed && ((gc->token == ADD_OP) || (gc->token == SUB_OP)))
+    {
+        op = gc->token;
+        gep_next_token (gc);
+        if (gc->failed)
+            break;
+        gep_mul_div (gc);
+        gep_emit (gc, op, 0, gnc_numeric_zero ());
+        is_var = FALSE;
+    }
+
+    return is_var;
+}
+
+static GNCExpProgram *
+gep_compile (const char *expression)
+{
+    GNCExpProgram *program = g_new0 (GNCExpProgram, 1);
+    GEPCompiler gc;
+    guint i;
+
+    memset (&gc, 0, sizeof (gc));
+    gc.parse_str = expression;
+    gc.code = g_array_new (FALSE, FALSE, sizeof (GEPInstr));
+    gc.slots = g_ptr_array_new ();
+
+    gep_next_token (&gc);
+    if (!gc.failed)
+        gep_add_sub (&gc);
+    if (!gc.failed && (gc.token != EOS))
+        gc.failed = TRUE;
+
+    /* The parser reads "(num)" as -num, accountancy style. */
+    if (!gc.failed && (gc.n_tokens == 3)
+            && (strncmp (gc.tokens, "(I)", 3) == 0))
+        gep_emit (&gc, GEP_OP_NEG, 0, gnc_numeric_zero ());
+
+    if (gc.failed)
+    {
+        for (i = 0; i < gc.slots->len; i++)
+            g_free (g_ptr_array_index (gc.slots, i));
+        g_ptr_array_free (gc.slots, TRUE);
+        g_array_free (gc.code, TRUE);
+        return program;
+    }
+
+    program->n_code = gc.code->len;
+    program->code = (GEPInstr *) g_array_free (gc.code, FALSE);
+    program->n_slots = gc.slots->len;
+    program->slots = (char **) g_ptr_array_free (gc.slots, FALSE);
+
+    return program;
+}
+
+static void
+gep_program_free (gpointer data)
+{
+    GNCExpProgram *program = (GNCExpProgram *) data;
+    int i;
+
+    for (i = 0; i < program->n_slots; i++)
+        g_free (program->slots[i]);
+    g_free (program->slots);
+    g_free (program->code);
+    g_free (program);
+}
+
+static void
+gnc_exp_cache_clear (void)
+{
+    if (compiled_exprs == NULL)
+        return;
+
+    g_hash_table_destroy (compiled_exprs);
+    compiled_exprs = NULL;
+}
+
+const GNCExpProgram *
+gnc_exp_parser_compile (const char *expression)
+{
+    GNCExpProgram *program;
+
+    if (expression == NULL)
+        return NULL;
+
+    G_LOCK (parser_state);
+
+    if (compiled_exprs == NULL)
+        compiled_exprs = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                g_free, gep_program_free);
+
+    program = (GNCExpProgram *) g_hash_table_lookup (compiled_exprs, expression);
+    if (program == NULL)
+    {
+        /* Formulas come from a small, fixed set of templates; an
+         * overflowing cache means something else is feeding it.  The
+         * programs handed out must stay valid, so rather than evict
+         * any, leave the rest to the parser. */
+        if (g_hash_table_size (compiled_exprs) < GEP_CACHE_SIZE)
+        {
+            program = gep_compile (expression);
+            g_hash_table_insert (compiled_exprs, g_strdup (expression), program);
+        }
+    }
+
+    G_UNLOCK (parser_state);
+
+    return (program && program->code) ? program : NULL;
+}
+
+/* Run program and return a mask of the slots which had no binding and
+ * were taken as zero.  *result is an error value if the arithmetic
+ * failed.  If the parser isn't initialized yet, it is initialized
+ * with or without the predefined variables as add_predefined says.
+ * The parser lock is only taken to read the parser's own variables,
+ * and lookup is called without it. */
+static guint32
+gep_program_run (const GNCExpProgram *program, GNCExpVarLookup lookup,
+                 gpointer user_data, gboolean add_predefined,
+                 gnc_numeric *result)
+{
+    gnc_numeric slots[GEP_MAX_SLOTS];
+    gnc_numeric stack[GEP_MAX_DEPTH];
+    guint32 pending = 0;
+    guint32 unbound = 0;
+    ParserNum *pnum;
+    int i, sp = 0;
+
+    for (i = 0; i < program->n_slots; i++)
+    {
+        if (!lookup || !lookup (program->slots[i], &slots[i], user_data))
+            pending |= (guint32) 1 << i;
+    }
+
+    G_LOCK (parser_state);
+
+    if (!parser_inited)
+        gnc_exp_parser_real_init (add_predefined);
+
+    for (i = 0; pending && (i < program->n_slots); i++)
+    {
+        if (!(pending & ((guint32) 1 << i)))
+            continue;
+
+        pnum = (ParserNum *) g_hash_table_lookup (variable_bindings,
+                                                  program->slots[i]);
+        if (pnum)
+        {
+            slots[i] = pnum->value;
+        }
+        else
+        {
+            slots[i] = gnc_numeric_zero ();
+            unbound |= (guint32) 1 << i;
+        }
+    }
+
+    G_UNLOCK (parser_state);
+
+    for (i = 0; i < program->n_code; i++)
+    {
+        const GEPInstr *instr = &program->code[i];
+
+        switch (instr->op)
+        {
+        case GEP_OP_NUM:
+            stack[sp++] = instr->value;
+            break;
+        case GEP_OP_VAR:
+            stack[sp++] = slots[instr->slot];
+            break;
+        case GEP_OP_NEG:
+            stack[sp - 1] = gnc_numeric_neg (stack[sp - 1]);
+            break;
+        case ADD_OP:
+            sp--;
+            stack[sp - 1] = gnc_numeric_add (stack[sp - 1], stack[sp],
+                                             GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+            break;
+        case SUB_OP:
+            sp--;
+            stack[sp - 1] = gnc_numeric_sub (stack[sp - 1], stack[sp],
+                                             GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+            break;
+        case MUL_OP:
+            sp--;
+            stack[sp - 1] = gnc_numeric_mul (stack[sp - 1], stack[sp],
+                                             GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+            break;
+        case DIV_OP:
+            sp--;
+            stack[sp - 1] = gnc_numeric_div (stack[sp - 1], stack[sp],
+                                             GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+            break;
+        }
+    }
+
+    *result = stack[0];
+    return unbound;
+}
+
+gboolean
+gnc_exp_program_eval (const GNCExpProgram *program, GNCExpVarLookup lookup,
+                      gpointer user_data, gnc_numeric *value_p)
+{
+    gnc_numeric result;
+
+    g_return_val_if_fail (program != NULL && program->code != NULL, FALSE);
+
+    gep_program_run (program, lookup, user_data, (lookup == NULL), &result);
+
+    if (gnc_numeric_check (result))
+    {
+        set_last_error (NUMERIC_ERROR);
+        return FALSE;
+    }
+
+    if (value_p)
+        *value_p = gnc_numeric_reduce (result);
+
+    set_last_error (PARSER_NO_ERROR);
+    return TRUE;
+}
+
+static gboolean
+gep_varhash_lookup (const char *name, gnc_numeric *value, gpointer user_data)
+{
+    gpointer num;
+
+    if (!g_hash_table_lookup_extended ((GHashTable *) user_data, name,
+                                       NULL, &num))
+        return FALSE;
+
+    /* gnc_exp_parser_parse_separate_vars reads a NULL value as 0/0. */
+    *value = num ? *(gnc_numeric *) num : gnc_numeric_create (0, 0);
+    return TRUE;
+}
+
+gboolean
+gnc_exp_parser_parse_cached (const char * expression,
+                             gnc_numeric *value_p,
+                             char **error_loc_p,
+                             GHashTable *varHash )
+{
+    const GNCExpProgram *program;
+    gnc_numeric result;
+    ParseError error;
+    guint32 unbound;
+    int i;
+
+    program = gnc_exp_parser_compile (expression);
+    if (program == NULL)
+        return gnc_exp_parser_parse_separate_vars (expression, value_p,
+                error_loc_p, varHash);
+
+    unbound = gep_program_run (program,
+                               varHash ? gep_varhash_lookup : NULL,
+                               varHash, (varHash == NULL), &result);
+
+    if (gnc_numeric_check (result))
+    {
+        if (error_loc_p != NULL)
+            *error_loc_p = (char *) expression;
+
+        error = NUMERIC_ERROR;
+    }
+    else
+    {
+        if (value_p)
+            *value_p = gnc_numeric_reduce (result);
+
+        if (error_loc_p != NULL)
+            *error_loc_p = NULL;
+
+        error = PARSER_NO_ERROR;
+    }
+
+    /* Hand the variables nobody defined back to the caller as zero,
+     * as the parser does. */
+    if (varHash != NULL)
+    {
+        for (i = 0; i < program->n_slots; i++)
+        {
+            if (unbound & ((guint32) 1 << i))
+            {
+                gnc_numeric *numericValue = g_new0 (gnc_numeric, 1);
+                *numericValue = gnc_numeric_zero ();
+                g_hash_table_insert (varHash, g_strdup (program->slots[i]),
+                                     numericValue);
+            }
+        }
+    }
+
+    set_last_error (error);
+    return error == PARSER_NO_ERROR;
 }
 
 const char *
 gnc_exp_parser_error_string (void)
 {
+    ParseError last_error = get_last_error ();
+
     if ( last_error == PARSER_NO_ERROR )
     {
-        switch ( last_gncp_error )
+        switch ( get_last_gncp_error () )
         {
         default:
         case NO_ERR:
@@ -85,6 +85,60 @@ gboolean gnc_exp_parser_parse_separate_vars (const char * expression,
         char **error_loc_p,
         GHashTable *varHash );
 
+/**
+ * A compiled expression.  Expressions built only from numbers,
+ * variables, the four arithmetic operators, unary signs and
+ * parentheses are compiled once into a short program over
+ * gnc_numeric which can then be evaluated any number of times with
+ * different variable values, without parsing the text again.
+ **/
+typedef struct GNCExpProgram GNCExpProgram;
+
+/**
+ * Supplies the value of the variable name to gnc_exp_program_eval.
+ * Returns FALSE if the variable is not bound, in which case the
+ * parser's own variable definitions are tried, and then zero.
+ **/
+typedef gboolean (*GNCExpVarLookup) (const char *name, gnc_numeric *value,
+                                     gpointer user_data);
+
+/**
+ * Return the compiled form of expression, or NULL if it uses
+ * anything besides numbers, variables, + - * /, unary signs and
+ * parentheses; such expressions must be evaluated by
+ * gnc_exp_parser_parse_separate_vars instead.  NULL is also returned
+ * once the cache is full.  Compiled expressions are cached by their
+ * text, and the program is owned by the cache: it stays valid until
+ * gnc_exp_parser_shutdown.
+ **/
+const GNCExpProgram *gnc_exp_parser_compile (const char *expression);
+
+/**
+ * Evaluate program, binding each variable through lookup if it is
+ * non-NULL.  On success return TRUE and, if value_p is non-NULL,
+ * store the result in *value_p.  If the arithmetic fails return
+ * FALSE, leaving *value_p unchanged; gnc_exp_parser_error_string
+ * then describes the problem.
+ *
+ * @note Programs may be compiled and evaluated on several threads at
+ * once, as long as no thread sets or removes variables or shuts the
+ * parser down meanwhile.  The other parsing routines are serialized,
+ * and the error string is kept per thread.
+ **/
+gboolean gnc_exp_program_eval (const GNCExpProgram *program,
+                               GNCExpVarLookup lookup, gpointer user_data,
+                               gnc_numeric *value_p);
+
+/**
+ * Same as gnc_exp_parser_parse_separate_vars, including the
+ * variables added to varHash, but evaluates expression through the
+ * compiled expression cache when it can be compiled.
+ **/
+gboolean gnc_exp_parser_parse_cached (const char * expression,
+                                      gnc_numeric *value_p,
+                                      char **error_loc_p,
+                                      GHashTable *varHash );
+
 /* If the last parse returned FALSE, return an error string describing
  * the problem. Otherwise, return NULL. */
 const char * gnc_exp_parser_error_string (void);
@@ -89,6 +89,18 @@ _var_numeric_to_sx_var(gchar *name, gnc_numeric *num, GHashTable *sx_var_hash)
     ((GncSxVariable*)p_var)->value = *num;
 }
 
+static gboolean
+_sx_var_lookup(const char *name, gnc_numeric *value, gpointer sx_var_hash)
+{
+    GncSxVariable *var;
+
+    var = (GncSxVariable*)g_hash_table_lookup((GHashTable*)sx_var_hash, name);
+    if (var == NULL)
+        return FALSE;
+    *value = var->value;
+    return TRUE;
+}
+
 static void
 _wipe_parsed_sx_var(gchar *key, GncSxVariable *var, gpointer unused_user_data)
 {
@@ -121,7 +133,7 @@ gnc_sx_parse_vars_from_formula(const char *formula,
     parser_vars = gnc_sx_instance_get_variables_for_parser(var_hash);
 
     num = gnc_numeric_zero();
-    if (!gnc_exp_parser_parse_separate_vars(formula, &num, &errLoc, parser_vars))
+    if (!gnc_exp_parser_parse_cached(formula, &num, &errLoc, parser_vars))
     {
         toRet = -1;
     }
@@ -939,7 +951,7 @@ _get_template_split_account(const SchedXaction* sx, const Split *template_split,
         return FALSE;
     }
     acct_guid = kvp_value_get_guid( kvp_val );
-    *split_acct = xaccAccountLookup(acct_guid, gnc_get_current_book());
+    *split_acct = xaccAccountLookup(acct_guid, qof_instance_get_book(sx));
     if (*split_acct == NULL)
     {
         char guid_str[GUID_ENCODING_LENGTH+1];
@@ -990,15 +1002,34 @@ _get_sx_formula_value(const SchedXaction* sx, const Split *template_split, gnc_n
     formula_str = kvp_value_get_string(kvp_val);
     if (formula_str != NULL && strlen(formula_str) != 0)
     {
+        const GNCExpProgram *program;
         GHashTable *parser_vars = NULL;
-        if (variable_bindings)
+        gboolean ok;
+
+        /* Every instance of the SX evaluates the same few formulas, so
+         * use the compiled form if there is one and bind the instance's
+         * variables to it directly. */
+        program = gnc_exp_parser_compile(formula_str);
+        if (program != NULL)
+        {
+            ok = gnc_exp_program_eval(program,
+                                      variable_bindings ? _sx_var_lookup : NULL,
+                                      variable_bindings,
+                                      numeric);
+            parseErrorLoc = formula_str;
+        }
+        else
         {
-            parser_vars = gnc_sx_instance_get_variables_for_parser(variable_bindings);
+            if (variable_bindings)
+            {
+                parser_vars = gnc_sx_instance_get_variables_for_parser(variable_bindings);
+            }
+            ok = gnc_exp_parser_parse_separate_vars(formula_str,
+                                                    numeric,
+                                                    &parseErrorLoc,
+                                                    parser_vars);
         }
-        if (!gnc_exp_parser_parse_separate_vars(formula_str,
-                                                numeric,
-                                                &parseErrorLoc,
-                                                parser_vars))
+        if (!ok)
         {
             GString *err = g_string_new("");
             g_string_printf(err, "Error parsing SX [%s] key [%s]=formula [%s] at [%s]: %s",
@@ -1502,6 +1533,10 @@ typedef struct
     GList **creation_errors;
     const SchedXaction *sx;
     gnc_numeric count;
+    /* Accumulate without logging, for worker threads: the debug log
+     * formats numbers into a shared buffer.  The totals are checked
+     * when they are merged on the main thread. */
+    gboolean quiet;
 } SxCashflowData;
 
 static void add_to_hash_amount(GHashTable* hash, const GncGUID* guid, const gnc_numeric* amount)
@@ -1561,6 +1596,31 @@ static void add_to_hash_amount(GHashTable* hash, const GncGUID* guid, const gnc_
             gnc_num_dbg_to_string(*elem));
 }
 
+static void add_to_hash_amount_quiet(GHashTable* hash, const GncGUID* guid, const gnc_numeric* amount)
+{
+    gnc_numeric* elem = (gnc_numeric*) g_hash_table_lookup(hash, guid);
+    if (!elem)
+    {
+        elem = g_new0(gnc_numeric, 1);
+        *elem = gnc_numeric_zero();
+        g_hash_table_insert(hash, (gpointer) guid, elem);
+    }
+
+    /* An error value stays in the total and is reported by the
+     * merge. */
+    if (gnc_numeric_check(*elem) != GNC_ERROR_OK)
+        return;
+    if (gnc_numeric_check(*amount) != GNC_ERROR_OK)
+    {
+        *elem = *amount;
+        return;
+    }
+
+    *elem = gnc_numeric_add(*elem, *amount,
+                            GNC_DENOM_AUTO,
+                            GNC_HOW_DENOM_REDUCE | GNC_HOW_RND_NEVER);
+}
+
 static gboolean
 create_cashflow_helper(Transaction *template_txn, void *user_data)
 {
@@ -1656,7 +1716,10 @@ create_cashflow_helper(Transaction *template_txn, void *user_data)
             }
 
             /* And add the resulting value to the hash */
-            add_to_hash_amount(creation_data->hash, xaccAccountGetGUID(split_acct), &final);
+            if (creation_data->quiet)
+                add_to_hash_amount_quiet(creation_data->hash, xaccAccountGetGUID(split_acct), &final);
+            else
+                add_to_hash_amount(creation_data->hash, xaccAccountGetGUID(split_acct), &final);
         }
     }
 
@@ -1665,11 +1728,13 @@ create_cashflow_helper(Transaction *template_txn, void *user_data)
 
 static void
 instantiate_cashflow_internal(const SchedXaction* sx,
+                              Account* sx_template_account,
                               GHashTable* map,
-                              GList **creation_errors, gint count)
+                              GList **creation_errors, gint count,
+                              gboolean quiet)
 {
     SxCashflowData create_cashflow_data;
-    Account* sx_template_account = gnc_sx_get_template_transaction_account(sx);
+    GHashTable *seen;
 
     if (!sx_template_account)
     {
@@ -1688,12 +1753,25 @@ instantiate_cashflow_internal(const SchedXaction* sx,
     create_cashflow_data.creation_errors = creation_errors;
     create_cashflow_data.sx = sx;
     create_cashflow_data.count = gnc_numeric_create(count, 1);
+    create_cashflow_data.quiet = quiet;
 
     /* The cash flow numbers are in the transactions of the template
-     * account, so run this foreach on the transactions. */
-    xaccAccountForEachTransaction(sx_template_account,
-                                  create_cashflow_helper,
-                                  &create_cashflow_data);
+     * account, so visit each of them once.  This walks the splits
+     * rather than using xaccAccountForEachTransaction, whose
+     * transaction markers would be written by every thread. */
+    seen = g_hash_table_new(g_direct_hash, g_direct_equal);
+    SplitList_t template_splits = xaccAccountGetSplitList(sx_template_account);
+    for (SplitList_t::const_iterator it = template_splits.begin();
+            it != template_splits.end(); it++)
+    {
+        Transaction *template_txn = xaccSplitGetParent(*it);
+
+        if (!template_txn || g_hash_table_lookup(seen, template_txn))
+            continue;
+        g_hash_table_insert(seen, template_txn, template_txn);
+        create_cashflow_helper(template_txn, &create_cashflow_data);
+    }
+    g_hash_table_destroy(seen);
 }
 
 typedef struct
@@ -1722,9 +1800,10 @@ static void instantiate_cashflow_cb(gpointer data, gpointer _user_data)
          * cash flow and add it to the result
          * g_hash<GUID,gnc_numeric> */
         instantiate_cashflow_internal(sx,
+                                      gnc_sx_get_template_transaction_account(sx),
                                       userdata->hash,
                                       userdata->creation_errors,
-                                      count);
+                                      count, FALSE);
     }
 }
 
@@ -1746,14 +1825,140 @@ void gnc_sx_all_instantiate_cashflow(std::list<SchedXaction*> all_sxes,
     }
 }
 
+/* One SX of a parallel cash flow projection.  Everything a worker
+ * would have to look up in the book is resolved beforehand. */
+typedef struct
+{
+    const SchedXaction *sx;
+    Account *template_account;
+    GList *creation_errors;
+} SxCashflowJob;
+
+typedef struct
+{
+    SxCashflowJob *jobs;
+    gint n_jobs;
+    gint next_job;      /* claimed with g_atomic_int_add */
+    const GDate *range_start;
+    const GDate *range_end;
+    gboolean keep_errors;
+} SxCashflowQueue;
+
+typedef struct
+{
+    SxCashflowQueue *queue;
+    GHashTable *hash;   /* this worker's totals */
+} SxCashflowWorker;
+
+static gpointer
+cashflow_worker(gpointer data)
+{
+    SxCashflowWorker *worker = (SxCashflowWorker*) data;
+    SxCashflowQueue *queue = worker->queue;
+    gint i;
+
+    while ((i = g_atomic_int_add(&queue->next_job, 1)) < queue->n_jobs)
+    {
+        SxCashflowJob *job = &queue->jobs[i];
+        gint count;
+
+        count = gnc_sx_get_num_occur_daterange(job->sx, queue->range_start,
+                                               queue->range_end);
+        if (count > 0)
+            instantiate_cashflow_internal(job->sx, job->template_account,
+                                          worker->hash,
+                                          queue->keep_errors ? &job->creation_errors : NULL,
+                                          count, TRUE);
+    }
+
+    return NULL;
+}
+
+void gnc_sx_all_instantiate_cashflow_parallel(const std::list<SchedXaction*> &all_sxes,
+                                              const GDate *range_start, const GDate *range_end,
+                                              GHashTable* map, GList **creation_errors,
+                                              guint n_workers)
+{
+    SxCashflowQueue queue;
+    SxCashflowWorker *workers;
+    GThread **threads;
+    guint w;
+    gint i;
+
+    g_return_if_fail(map != NULL);
+
+    queue.n_jobs = all_sxes.size();
+    if (queue.n_jobs == 0)
+        return;
+
+    if (n_workers == 0)
+        n_workers = g_get_num_processors();
+    n_workers = CLAMP(n_workers, 1, (guint) queue.n_jobs);
+
+    queue.jobs = g_new0(SxCashflowJob, queue.n_jobs);
+    queue.next_job = 0;
+    queue.range_start = range_start;
+    queue.range_end = range_end;
+    queue.keep_errors = (creation_errors != NULL);
+
+    i = 0;
+    for (std::list<SchedXaction*>::const_iterator it = all_sxes.begin();
+            it != all_sxes.end(); it++, i++)
+    {
+        queue.jobs[i].sx = *it;
+        queue.jobs[i].template_account = gnc_sx_get_template_transaction_account(*it);
+    }
+
+    g_debug("Projecting cash flow of %d SXes on %u workers", queue.n_jobs, n_workers);
+
+    workers = g_new0(SxCashflowWorker, n_workers);
+    threads = g_new0(GThread*, n_workers);
+    for (w = 0; w < n_workers; w++)
+    {
+        workers[w].queue = &queue;
+        workers[w].hash = gnc_g_hash_new_guid_numeric();
+        /* The calling thread takes the last share itself. */
+        if (w + 1 < n_workers)
+            threads[w] = g_thread_try_new("sx_cashflow_thread",
+                                          cashflow_worker, &workers[w], NULL);
+    }
+    cashflow_worker(&workers[n_workers - 1]);
+    for (w = 0; w < n_workers; w++)
+        if (threads[w])
+            g_thread_join(threads[w]);
+
+    /* A worker that couldn't be started left its share to the
+     * others, so the queue is empty by now. */
+    for (w = 0; w < n_workers; w++)
+    {
+        GHashTableIter iter;
+        gpointer key, value;
+
+        g_hash_table_iter_init(&iter, workers[w].hash);
+        while (g_hash_table_iter_next(&iter, &key, &value))
+            add_to_hash_amount(map, (const GncGUID*) key, (const gnc_numeric*) value);
+        g_hash_table_destroy(workers[w].hash);
+    }
+
+    /* Report the errors in the order of the SXes, as the serial
+     * projection does. */
+    for (i = 0; i < queue.n_jobs; i++)
+        if (queue.jobs[i].creation_errors)
+            *creation_errors = g_list_concat(*creation_errors,
+                                             queue.jobs[i].creation_errors);
+
+    g_free(threads);
+    g_free(workers);
+    g_free(queue.jobs);
+}
 
 GHashTable* gnc_sx_all_instantiate_cashflow_all(GDate range_start, GDate range_end)
 {
     GHashTable *result_map = gnc_g_hash_new_guid_numeric();
     std::list<SchedXaction*> all_sxes = gnc_book_get_schedxactions(gnc_get_current_book())->sx_list;
-    gnc_sx_all_instantiate_cashflow(all_sxes,
-                                    &range_start, &range_end,
-                                    result_map, NULL);
+    gnc_sx_all_instantiate_cashflow_parallel(all_sxes,
+                                             &range_start, &range_end,
+                                             result_map, NULL, 0);
     return result_map;
 }
 
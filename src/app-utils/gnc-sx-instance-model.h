@@ -240,8 +240,19 @@ void gnc_sx_all_instantiate_cashflow(std::list<SchedXaction*> all_sxes,
                                      const GDate *range_start, const GDate *range_end,
                                      GHashTable* map, GList **creation_errors);
 
-/** Simplified wrapper around gnc_sx_all_instantiate_cashflow(): Run
- * that function on all SX of the current book for the given date
+/** Same as gnc_sx_all_instantiate_cashflow(), but the SXs are shared
+ * out among n_workers threads, or one per processor if n_workers is
+ * 0.  Each thread adds up its own totals, which are merged into map
+ * at the end; the errors are appended in the order of the SXs.
+ *
+ * The book must not be changed while the projection runs. */
+void gnc_sx_all_instantiate_cashflow_parallel(const std::list<SchedXaction*> &all_sxes,
+                                              const GDate *range_start, const GDate *range_end,
+                                              GHashTable* map, GList **creation_errors,
+                                              guint n_workers);
+
+/** Simplified wrapper around gnc_sx_all_instantiate_cashflow_parallel():
+ * Run that function on all SX of the current book for the given date
  * range. Ignore any potential error messages. Returns a newly
  * allocated GHashTable with the result, which is a GHashTable<GUID*,
  * gnc_numeric*>, identical to what gnc_g_hash_new_guid_numeric()
@@ -180,6 +180,38 @@ gnc_ui_account_get_print_report_balance (xaccGetBalanceInCurrencyFn fn,
 }
 
 
+typedef struct
+{
+    gnc_commodity *currency;
+    time64 date;
+    gnc_numeric balance;
+} BalanceAsOfDate;
+
+static void
+add_child_balance_as_of_date (Account *child, gpointer data)
+{
+    BalanceAsOfDate *bd = (BalanceAsOfDate *) data;
+    gnc_numeric child_balance;
+
+    child_balance = xaccAccountGetBalanceAsOfDate (child, bd->date);
+    child_balance = xaccAccountConvertBalanceToCurrency (child,
+                    child_balance, xaccAccountGetCommodity (child),
+                    bd->currency);
+    bd->balance = gnc_numeric_add_fixed (bd->balance, child_balance);
+}
+
+void
+gnc_ui_book_load_history_since (QofBook *book, time64 date)
+{
+    Timespec ts;
+
+    if (book == NULL)
+        return;
+
+    timespecFromTime64 (&ts, date);
+    qof_backend_run_load_since (qof_book_get_backend (book), book, ts);
+}
+
 gnc_numeric
 gnc_ui_account_get_balance_as_of_date (Account *account,
                                        time64 date,
@@ -191,25 +223,22 @@ gnc_ui_account_get_balance_as_of_date (Account *account,
     if (account == NULL)
         return gnc_numeric_zero ();
 
+    gnc_ui_book_load_history_since (gnc_account_get_book (account), date);
+
     currency = xaccAccountGetCommodity (account);
     balance = xaccAccountGetBalanceAsOfDate (account, date);
 
+    /* Walk the tree in place rather than copying out the descendants. */
     if (include_children)
     {
-        AccountList_t children = gnc_account_get_descendants(account);
-
-        for (AccountList_t::iterator node = children.begin(); node != children.end(); node++)
-        {
-            gnc_commodity *child_currency;
-            gnc_numeric child_balance;
-
-            Account * child = *node;
-            child_currency = xaccAccountGetCommodity (child);
-            child_balance = xaccAccountGetBalanceAsOfDate (child, date);
-            child_balance = xaccAccountConvertBalanceToCurrency (child,
-                            child_balance, child_currency, currency);
-            balance = gnc_numeric_add_fixed (balance, child_balance);
-        }
+        BalanceAsOfDate bd;
+
+        bd.currency = currency;
+        bd.date = date;
+        bd.balance = balance;
+        gnc_account_foreach_descendant (account, add_child_balance_as_of_date,
+                                        &bd);
+        balance = bd.balance;
     }
 
     /* reverse sign if needed */
@@ -107,6 +107,13 @@ gnc_ui_account_get_print_report_balance (xaccGetBalanceInCurrencyFn fn,
         gboolean recurse,
         gboolean *negative);
 
+/** Loads the transactions posted on or after 'date' that the backend
+ *  left out of a partially loaded book.  Call this before asking the
+ *  engine for balances as of an older date.  A no-op for a fully loaded
+ *  book.
+ */
+void gnc_ui_book_load_history_since (QofBook *book, time64 date);
+
 gnc_numeric gnc_ui_account_get_balance_as_of_date (Account *account,
 						   time64 date,
 						   gboolean include_children);
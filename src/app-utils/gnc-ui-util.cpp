@@ -1104,30 +1104,123 @@ PrintAmountInternal(char *buf, gnc_numeric val, const GNCPrintAmountInfo *info)
     return strlen(buf);
 }
 
-/**
- * @param bufp Should be at least 64 chars.
- **/
-int
-xaccSPrintAmount (char * bufp, gnc_numeric val, GNCPrintAmountInfo info)
+/* Prints the absolute value of an amount whose denominator is a power of
+ * ten, which is nearly all of them, with integer arithmetic only; the
+ * caller adds the sign.  Returns -1 for anything else, which
+ * PrintAmountInternal then handles. */
+static int
+PrintAmountFixed(char *buf, gnc_numeric val, const GNCPrintAmountFormat *format)
 {
-    struct lconv *lc;
+    const GNCPrintAmountInfo *info = &format->info;
+    char whole_buf[160];
+    char frac_buf[24];
+    char *whole_ptr = whole_buf + sizeof (whole_buf);
+    char *buf_ptr = buf;
+    guint64 num, scale = 1, whole, frac;
+    int places = 0, min_dp, max_dp, num_decimal_places, i;
+
+    if (val.denom <= 0 || val.num == G_MININT64)
+        return -1;
+    while (scale < (guint64)val.denom)
+    {
+        if (places == 18)
+            return -1;
+        scale *= 10;
+        places++;
+    }
+    if (scale != (guint64)val.denom)
+        return -1;
+    num = val.num < 0 ? -val.num : val.num;
 
-    char *orig_bufp = bufp;
-    const char *currency_symbol;
-    const char *sign;
+    if (auto_decimal_enabled)
+    {
+        min_dp = MAX(auto_decimal_places, info->min_decimal_places);
+        max_dp = MAX(auto_decimal_places, info->max_decimal_places);
+    }
+    else
+    {
+        min_dp = info->min_decimal_places;
+        max_dp = info->max_decimal_places;
+    }
+    if (!info->force_fit)
+        max_dp = 99;
 
-    char cs_precedes;
-    char sep_by_space;
-    char sign_posn;
+    /* Round half up at max_dp; the digits beyond it are dropped below. */
+    if (info->round && info->force_fit && places > max_dp)
+    {
+        guint64 half = 5;
+        for (i = max_dp + 1; i < places; i++)
+            half *= 10;
+        if (num > G_MAXINT64 - half)
+            return -1;
+        num += half;
+    }
+    whole = num / scale;
+    frac = num % scale;
 
-    gboolean print_sign = TRUE;
+    /* The whole part, right to left, grouped like PrintAmountInternal. */
+    {
+        const char *group = format->grouping;
+        size_t sep_len = strlen (format->separator);
+        int group_count = 0;
+
+        while (TRUE)
+        {
+            *--whole_ptr = '0' + whole % 10;
+            whole /= 10;
+            if (whole == 0)
+                break;
+            if (!info->use_separators || *group == CHAR_MAX)
+                continue;
+            if (++group_count == *group)
+            {
+                whole_ptr -= sep_len;
+                memcpy (whole_ptr, format->separator, sep_len);
+                group_count = 0;
+                if (group[1] != '\0')
+                    group++;
+            }
+        }
+        i = whole_buf + sizeof (whole_buf) - whole_ptr;
+        memcpy (buf_ptr, whole_ptr, i);
+        buf_ptr += i;
+    }
+
+    /* The fraction, truncated at max_dp, with trailing zeros trimmed back
+     * to min_dp. */
+    for (i = places - 1; i >= 0; i--)
+    {
+        frac_buf[i] = '0' + frac % 10;
+        frac /= 10;
+    }
+    num_decimal_places = MIN(places, max_dp);
+    while (num_decimal_places > min_dp && frac_buf[num_decimal_places - 1] == '0')
+        num_decimal_places--;
+    if (num_decimal_places > 0 || min_dp > 0)
+    {
+        buf_ptr = g_stpcpy (buf_ptr, format->decimal_point);
+        memcpy (buf_ptr, frac_buf, num_decimal_places);
+        buf_ptr += num_decimal_places;
+        for (; num_decimal_places < min_dp; num_decimal_places++)
+            *buf_ptr++ = '0';
+    }
+    *buf_ptr = '\0';
+
+    return buf_ptr - buf;
+}
+
+void
+gnc_print_amount_format_init (GNCPrintAmountFormat *format,
+                              GNCPrintAmountInfo info)
+{
+    struct lconv *lc;
     gboolean is_shares = FALSE;
-    gboolean print_absolute = FALSE;
+    int neg;
 
-    if (!bufp)
-        return 0;
+    g_return_if_fail (format != NULL);
 
     lc = gnc_localeconv();
+    format->currency_symbol = NULL;
 
     if (info.use_symbol)
     {
@@ -1135,52 +1228,71 @@ xaccSPrintAmount (char * bufp, gnc_numeric val, GNCPrintAmountInfo info)
         if (gnc_commodity_equiv (info.commodity,
                                  gnc_locale_default_currency_nodefault ()))
         {
-            currency_symbol = lc->currency_symbol;
+            format->currency_symbol = lc->currency_symbol;
         }
         else
         {
             if (info.commodity && !gnc_commodity_is_iso (info.commodity))
                 is_shares = TRUE;
 
-            currency_symbol = gnc_commodity_get_mnemonic (info.commodity);
+            format->currency_symbol = gnc_commodity_get_mnemonic (info.commodity);
             info.use_locale = 0;
         }
 
-        if (currency_symbol == NULL)
-            currency_symbol = "";
+        if (format->currency_symbol == NULL)
+            format->currency_symbol = "";
     }
-    else
-        currency_symbol = NULL;
 
-    if (!info.use_locale)
+    for (neg = 0; neg < 2; neg++)
     {
-        cs_precedes = is_shares ? 0 : 1;
-        sep_by_space = 1;
-    }
-    else
-    {
-        if (gnc_numeric_negative_p (val))
+        if (!info.use_locale)
         {
-            cs_precedes  = lc->n_cs_precedes;
-            sep_by_space = lc->n_sep_by_space;
+            format->cs_precedes[neg] = is_shares ? 0 : 1;
+            format->sep_by_space[neg] = 1;
         }
         else
         {
-            cs_precedes  = lc->p_cs_precedes;
-            sep_by_space = lc->p_sep_by_space;
+            format->cs_precedes[neg] = neg ? lc->n_cs_precedes : lc->p_cs_precedes;
+            format->sep_by_space[neg] = neg ? lc->n_sep_by_space : lc->p_sep_by_space;
         }
+        format->sign[neg] = neg ? lc->negative_sign : lc->positive_sign;
+        format->sign_posn[neg] = neg ? lc->n_sign_posn : lc->p_sign_posn;
     }
 
-    if (gnc_numeric_negative_p (val))
-    {
-        sign = lc->negative_sign;
-        sign_posn = lc->n_sign_posn;
-    }
-    else
-    {
-        sign = lc->positive_sign;
-        sign_posn = lc->p_sign_posn;
-    }
+    /* PrintAmountInternal only ever uses the first character of these. */
+    g_utf8_strncpy (format->decimal_point,
+                    info.monetary ? lc->mon_decimal_point : lc->decimal_point, 1);
+    g_utf8_strncpy (format->separator,
+                    info.monetary ? lc->mon_thousands_sep : lc->thousands_sep, 1);
+    format->grouping = info.monetary ? lc->mon_grouping : lc->grouping;
+
+    format->info = info;
+}
+
+int
+gnc_print_amount_format_sprint (char * bufp, gnc_numeric val,
+                                const GNCPrintAmountFormat *format)
+{
+    char *orig_bufp = bufp;
+    const char *sign;
+    int neg, len;
+
+    char cs_precedes;
+    char sep_by_space;
+    char sign_posn;
+
+    gboolean print_sign = TRUE;
+    gboolean print_absolute = FALSE;
+
+    if (!bufp)
+        return 0;
+    g_return_val_if_fail (format != NULL, 0);
+
+    neg = gnc_numeric_negative_p (val) ? 1 : 0;
+    cs_precedes = format->cs_precedes[neg];
+    sep_by_space = format->sep_by_space[neg];
+    sign = format->sign[neg];
+    sign_posn = format->sign_posn[neg];
 
     if (gnc_numeric_zero_p (val) || (sign == NULL) || (sign[0] == 0))
         print_sign = FALSE;
@@ -1196,9 +1308,9 @@ xaccSPrintAmount (char * bufp, gnc_numeric val, GNCPrintAmountInfo info)
         if (print_sign && (sign_posn == 3))
             bufp = g_stpcpy(bufp, sign);
 
-        if (info.use_symbol)
+        if (format->info.use_symbol)
         {
-            bufp = g_stpcpy(bufp, currency_symbol);
+            bufp = g_stpcpy(bufp, format->currency_symbol);
             if (sep_by_space)
                 bufp = g_stpcpy(bufp, " ");
         }
@@ -1216,9 +1328,12 @@ xaccSPrintAmount (char * bufp, gnc_numeric val, GNCPrintAmountInfo info)
     }
 
     /* Now print the value */
-    bufp += PrintAmountInternal(bufp,
-                                print_absolute ? gnc_numeric_abs(val) : val,
-                                &info);
+    len = PrintAmountFixed(bufp, val, format);
+    if (len < 0)
+        len = PrintAmountInternal(bufp,
+                                  print_absolute ? gnc_numeric_abs(val) : val,
+                                  &format->info);
+    bufp += len;
 
     /* Now see if we print parentheses */
     if (print_sign && (sign_posn == 0))
@@ -1231,11 +1346,11 @@ xaccSPrintAmount (char * bufp, gnc_numeric val, GNCPrintAmountInfo info)
         if (print_sign && (sign_posn == 3))
             bufp = g_stpcpy(bufp, sign);
 
-        if (info.use_symbol)
+        if (format->info.use_symbol)
         {
             if (sep_by_space)
                 bufp = g_stpcpy(bufp, " ");
-            bufp = g_stpcpy(bufp, currency_symbol);
+            bufp = g_stpcpy(bufp, format->currency_symbol);
         }
 
         /* See if we print sign now */
@@ -1251,6 +1366,109 @@ xaccSPrintAmount (char * bufp, gnc_numeric val, GNCPrintAmountInfo info)
     return (bufp - orig_bufp);
 }
 
+/* Formats set up by xaccSPrintAmount, keyed by commodity (NULL
+ * included), each a GSList of PrintFormatEntry for the print infos
+ * seen with that commodity.  Registers and reports print every amount
+ * of an account the same way, so a handful of formats serve them all.
+ * A commodity's formats go when it is changed or destroyed, since they
+ * borrow its mnemonic. */
+typedef struct
+{
+    GNCPrintAmountInfo info;         /* As asked for; format.info may differ */
+    const gnc_commodity *default_currency;
+    GNCPrintAmountFormat format;
+} PrintFormatEntry;
+
+static GHashTable *print_format_cache = NULL;
+
+static void
+print_format_list_free (gpointer data)
+{
+    g_slist_free_full ((GSList *) data, g_free);
+}
+
+static void
+print_format_event_handler (QofInstance *ent, QofEventId event_type,
+                            gpointer user_data, gpointer event_data)
+{
+    if (0 == (event_type & (QOF_EVENT_MODIFY | QOF_EVENT_DESTROY)))
+        return;
+    g_hash_table_remove (print_format_cache, ent);
+}
+
+static gboolean
+print_info_equal (const GNCPrintAmountInfo *a, const GNCPrintAmountInfo *b)
+{
+    return (a->commodity == b->commodity &&
+            a->max_decimal_places == b->max_decimal_places &&
+            a->min_decimal_places == b->min_decimal_places &&
+            a->use_separators == b->use_separators &&
+            a->use_symbol == b->use_symbol &&
+            a->use_locale == b->use_locale &&
+            a->monetary == b->monetary &&
+            a->force_fit == b->force_fit &&
+            a->round == b->round);
+}
+
+static const GNCPrintAmountFormat *
+print_format_lookup (GNCPrintAmountInfo info)
+{
+    const gnc_commodity *default_currency = NULL;
+    PrintFormatEntry *entry;
+    GSList *formats, *node;
+
+    if (!print_format_cache)
+    {
+        print_format_cache = g_hash_table_new_full (g_direct_hash,
+                             g_direct_equal, NULL,
+                             print_format_list_free);
+        qof_event_register_handler (print_format_event_handler, NULL);
+    }
+
+    /* Whether the locale's symbol is used depends on the current book's
+     * idea of the default currency, which sends no event of its own. */
+    if (info.use_symbol)
+        default_currency = gnc_locale_default_currency_nodefault ();
+
+    formats = g_hash_table_lookup (print_format_cache, info.commodity);
+    for (node = formats; node; node = node->next)
+    {
+        entry = node->data;
+        if (!print_info_equal (&entry->info, &info))
+            continue;
+
+        if (entry->default_currency != default_currency)
+        {
+            gnc_print_amount_format_init (&entry->format, info);
+            entry->default_currency = default_currency;
+        }
+        return &entry->format;
+    }
+
+    entry = g_new (PrintFormatEntry, 1);
+    entry->info = info;
+    entry->default_currency = default_currency;
+    gnc_print_amount_format_init (&entry->format, info);
+
+    g_hash_table_steal (print_format_cache, info.commodity);
+    g_hash_table_insert (print_format_cache, (gpointer) info.commodity,
+                         g_slist_prepend (formats, entry));
+    return &entry->format;
+}
+
+/**
+ * @param bufp Should be at least 64 chars.
+ **/
+int
+xaccSPrintAmount (char * bufp, gnc_numeric val, GNCPrintAmountInfo info)
+{
+    if (!bufp)
+        return 0;
+
+    return gnc_print_amount_format_sprint (bufp, val,
+                                           print_format_lookup (info));
+}
+
 const char *
 xaccPrintAmount (gnc_numeric val, GNCPrintAmountInfo info)
 {
@@ -211,6 +211,33 @@ GNCPrintAmountInfo gnc_integral_print_info (void);
 const char * xaccPrintAmount (gnc_numeric val, GNCPrintAmountInfo info);
 int xaccSPrintAmount (char *buf, gnc_numeric val, GNCPrintAmountInfo info);
 
+/* A GNCPrintAmountFormat is a GNCPrintAmountInfo with the locale
+ * separators, sign placement and currency symbol already looked up, for
+ * callers such as registers and reports that print many amounts the same
+ * way.  Amounts with a power of ten denominator are then printed with
+ * integer arithmetic straight into the buffer.  The currency symbol is
+ * borrowed from the commodity, so re-initialize the format if the
+ * commodity changes. */
+typedef struct _GNCPrintAmountFormat
+{
+    GNCPrintAmountInfo info;
+    const char *currency_symbol;     /* NULL unless info.use_symbol */
+    const char *grouping;
+    char decimal_point[8];
+    char separator[8];
+
+    /* Indexed by 1 for negative amounts, 0 otherwise */
+    const char *sign[2];
+    char sign_posn[2];
+    char cs_precedes[2];
+    char sep_by_space[2];
+} GNCPrintAmountFormat;
+
+void gnc_print_amount_format_init (GNCPrintAmountFormat *format,
+                                   GNCPrintAmountInfo info);
+int gnc_print_amount_format_sprint (char *buf, gnc_numeric val,
+                                    const GNCPrintAmountFormat *format);
+
 const gchar *printable_value(gdouble val, gint denom);
 gchar *number_to_words(gdouble val, gint64 denom);
 gchar *numeric_to_words(gnc_numeric val);
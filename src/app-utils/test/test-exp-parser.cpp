@@ -2,6 +2,7 @@
 #include <glib.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "gnc-gconf-utils.h"
 #include "gnc-exp-parser.h"
@@ -124,6 +125,59 @@ run_parser_tests (void)
         run_parser_test (node->data);
 }
 
+/* The compiled expression cache must agree with the parser on every
+ * expression, including those it hands back to the parser. */
+static void
+run_cached_parser_test (TestNode *node)
+{
+    gnc_numeric result, cached_result;
+    char *error_loc = NULL, *cached_error_loc = NULL;
+    GHashTable *vars, *cached_vars;
+    gboolean succeeded, cached_succeeded;
+    gchar *msg = "[func_op()] function eval error: [[func_op(]\n";
+    guint loglevel = G_LOG_LEVEL_CRITICAL, hdlr;
+    TestErrorStruct check = { loglevel, "gnc.gui", msg };
+
+    result = cached_result = gnc_numeric_error( -1 );
+    vars = g_hash_table_new (g_str_hash, g_str_equal);
+    cached_vars = g_hash_table_new (g_str_hash, g_str_equal);
+    hdlr = g_log_set_handler ("gnc.gui", loglevel,
+                              (GLogFunc)test_checked_handler, &check);
+    succeeded = gnc_exp_parser_parse_separate_vars (node->exp, &result,
+                &error_loc, vars);
+    cached_succeeded = gnc_exp_parser_parse_cached (node->exp, &cached_result,
+                       &cached_error_loc, cached_vars);
+    g_log_remove_handler ("gnc.gui", hdlr);
+
+    if (cached_succeeded != succeeded)
+        failure_args (node->test_name, node->file, node->line,
+                      "cached parse %s on \"%s\"",
+                      cached_succeeded ? "succeeded" : "failed", node->exp);
+    else if (succeeded && !gnc_numeric_equal (cached_result, result))
+        failure_args (node->test_name, node->file, node->line,
+                      "cached parse gave a different result");
+    else if (!succeeded && cached_error_loc != error_loc)
+        failure_args (node->test_name, node->file, node->line,
+                      "cached parse failed at a different offset");
+    else if (g_hash_table_size (cached_vars) != g_hash_table_size (vars))
+        failure_args (node->test_name, node->file, node->line,
+                      "cached parse found different variables");
+    else
+        success (node->test_name);
+
+    g_hash_table_destroy (vars);
+    g_hash_table_destroy (cached_vars);
+}
+
+static void
+run_cached_parser_tests (void)
+{
+    GList *node;
+
+    for (node = tests; node; node = node->next)
+        run_cached_parser_test (node->data);
+}
+
 static void
 test_parser (void)
 {
@@ -168,8 +222,14 @@ test_parser (void)
                    "22.32 * 2 + 16.8 + 34.2 * 2 + 18.81 + 85.44"
                    "- 42.72 + 13.32 + 15.48 + 23.4 + 115.4",
                    gnc_numeric_create(35897, 100) );
+    add_pass_test( "(5)", NULL, gnc_numeric_create (-5, 1) );
+    add_pass_test( "-(3 + 4) * -2", NULL, gnc_numeric_create (14, 1) );
+    add_pass_test( "1 / 3 * 3", NULL, gnc_numeric_create (1, 1) );
+    add_fail_test( "bad expression", "1 + )", 5);
+    add_fail_test( "bad expression", "1 += 2", -1);
 
     run_parser_tests ();
+    run_cached_parser_tests ();
 
     gnc_exp_parser_shutdown ();
     success ("shutdown expression parser");
@@ -186,11 +246,134 @@ test_variable_expressions()
     success("variable found");
 }
 
+static void
+test_cached_variable_expressions()
+{
+    gnc_numeric num, *value;
+    gchar *errLoc = NULL;
+    GHashTable *vars = g_hash_table_new(g_str_hash, g_str_equal);
+    gnc_numeric rate = gnc_numeric_create(3, 2);
+
+    g_hash_table_insert(vars, (gpointer)"rate", &rate);
+    do_test(gnc_exp_parser_parse_cached("rate * (b + 4)", &num, &errLoc, vars),
+            "parsing");
+    do_test(gnc_numeric_equal(num, gnc_numeric_create(6, 1)), "'b' taken as zero");
+    value = (gnc_numeric*)g_hash_table_lookup(vars, "b");
+    do_test(g_hash_table_size(vars) == 2 && value != NULL
+            && gnc_numeric_zero_p(*value), "'b' is returned as a variable");
+    do_test(gnc_exp_parser_compile("rate * (b + 4)")
+            == gnc_exp_parser_compile("rate * (b + 4)"), "program is cached");
+    do_test(gnc_exp_parser_compile("a = 2") == NULL, "assignment is not compiled");
+    gnc_exp_parser_shutdown();
+    success("cached variables");
+}
+
+typedef struct
+{
+    gnc_numeric amount;
+    gnc_numeric rate;
+    gnc_numeric fee;
+} BenchmarkVars;
+
+static gboolean
+benchmark_lookup(const char *name, gnc_numeric *value, gpointer user_data)
+{
+    BenchmarkVars *bv = (BenchmarkVars*)user_data;
+
+    if (strcmp(name, "amount") == 0)
+        *value = bv->amount;
+    else if (strcmp(name, "rate") == 0)
+        *value = bv->rate;
+    else if (strcmp(name, "fee") == 0)
+        *value = bv->fee;
+    else
+        return FALSE;
+    return TRUE;
+}
+
+/* Scheduled transaction projection evaluates the credit and debit
+ * formulas of every template split once per occurrence.  Run them
+ * through the parser, as projection used to, and through the compiled
+ * cache, and check that the two agree.  Run with -m perf for 30000
+ * occurrences and timings. */
+static void
+test_formula_benchmark()
+{
+    const char *formulas[] =
+    {
+        "amount",
+        "amount * rate / 12",
+        "(amount - fee) * (1 + rate)",
+        "fee + 12.50",
+        "1234.56",
+        NULL
+    };
+    int occurrences = g_test_perf() ? 30000 : 300;
+    BenchmarkVars bv;
+    gnc_numeric before = gnc_numeric_zero(), after = gnc_numeric_zero();
+    double elapsed;
+    int i, f;
+
+    g_test_timer_start();
+    for (i = 0; i < occurrences; i++)
+    {
+        GHashTable *vars = g_hash_table_new(g_str_hash, g_str_equal);
+
+        bv.amount = gnc_numeric_create(100000 + i, 100);
+        bv.rate = gnc_numeric_create(5, 100);
+        bv.fee = gnc_numeric_create(i % 50, 1);
+        g_hash_table_insert(vars, (gpointer)"amount", &bv.amount);
+        g_hash_table_insert(vars, (gpointer)"rate", &bv.rate);
+        g_hash_table_insert(vars, (gpointer)"fee", &bv.fee);
+        for (f = 0; formulas[f]; f++)
+        {
+            gnc_numeric num = gnc_numeric_zero();
+            gnc_exp_parser_parse_separate_vars(formulas[f], &num, NULL, vars);
+            before = gnc_numeric_add(before, num, GNC_DENOM_AUTO,
+                                     GNC_HOW_DENOM_EXACT);
+        }
+        g_hash_table_destroy(vars);
+    }
+    elapsed = g_test_timer_elapsed();
+    if (g_test_perf())
+        g_test_minimized_result(elapsed, "Parsed SX formulas for %d occurrences in %g seconds",
+                                occurrences, elapsed);
+
+    g_test_timer_start();
+    for (i = 0; i < occurrences; i++)
+    {
+        bv.amount = gnc_numeric_create(100000 + i, 100);
+        bv.rate = gnc_numeric_create(5, 100);
+        bv.fee = gnc_numeric_create(i % 50, 1);
+        for (f = 0; formulas[f]; f++)
+        {
+            gnc_numeric num = gnc_numeric_zero();
+            gnc_exp_program_eval(gnc_exp_parser_compile(formulas[f]),
+                                 benchmark_lookup, &bv, &num);
+            after = gnc_numeric_add(after, num, GNC_DENOM_AUTO,
+                                    GNC_HOW_DENOM_EXACT);
+        }
+    }
+    elapsed = g_test_timer_elapsed();
+    if (g_test_perf())
+        g_test_minimized_result(elapsed, "Evaluated compiled SX formulas for %d occurrences in %g seconds",
+                                occurrences, elapsed);
+
+    do_test(gnc_numeric_equal(before, after), "compiled formulas agree");
+    gnc_exp_parser_shutdown();
+}
+
 int main ( int argc, char **argv )
 {
+    /* Only to pick up -m perf; the checks report their own failures,
+     * so don't let g_test_init make warnings fatal. */
+    g_test_init(&argc, &argv, NULL);
+    g_log_set_always_fatal(G_LOG_FATAL_MASK);
     /* set_should_print_success (TRUE); */
     test_parser();
     test_variable_expressions();
+    test_cached_variable_expressions();
+    test_formula_benchmark();
     print_test_results();
     exit(get_rv());
 }
@@ -1,8 +1,10 @@
 #include "config.h"
 #include <glib.h>
 #include <stdlib.h>
+#include <string.h>
 #include <glib/gprintf.h>
 
+#include "cashobjects.h"
 #include "gnc-ui-util.h"
 #include "gnc-numeric.h"
 #include "test-engine-stuff.h"
@@ -95,6 +97,93 @@ test_num (gnc_numeric n)
     }
 }
 
+static void
+test_print_format (void)
+{
+    struct
+    {
+        gint64 num;
+        gint64 denom;
+        guint8 max_dp;
+        guint8 min_dp;
+        gboolean separators;
+        gboolean round;
+        const char *expected;
+    } cases[] =
+    {
+        { 123456789, 100, 2, 2, TRUE, FALSE, "1,234,567.89" },
+        { -5, 10, 2, 2, TRUE, FALSE, "-0.50" },
+        { 1234, 1, 2, 0, TRUE, FALSE, "1,234" },
+        { 0, 100, 2, 2, TRUE, FALSE, "0.00" },
+        { 12345678, 100, 2, 2, FALSE, FALSE, "123456.78" },
+        { 123456, 1000, 2, 0, TRUE, FALSE, "123.45" },
+        { 123456, 1000, 2, 0, TRUE, TRUE, "123.46" },
+        { 1200, 1000, 3, 0, TRUE, FALSE, "1.2" },
+        { 1, 3, 2, 0, TRUE, FALSE, "1/3" },
+    };
+    GNCPrintAmountInfo print_info;
+    GNCPrintAmountFormat format;
+    char buf[128];
+    guint i;
+
+    print_info.commodity = NULL;
+    print_info.use_locale = 1;
+    print_info.use_symbol = 0;
+    print_info.monetary = 1;
+    print_info.force_fit = 1;
+
+    for (i = 0; i < G_N_ELEMENTS (cases); i++)
+    {
+        gnc_numeric n = gnc_numeric_create (cases[i].num, cases[i].denom);
+
+        print_info.max_decimal_places = cases[i].max_dp;
+        print_info.min_decimal_places = cases[i].min_dp;
+        print_info.use_separators = cases[i].separators;
+        print_info.round = cases[i].round;
+        gnc_print_amount_format_init (&format, print_info);
+        gnc_print_amount_format_sprint (buf, n, &format);
+        do_test_args (strcmp (buf, cases[i].expected) == 0,
+                      "fixed format", __FILE__, __LINE__,
+                      "num: %s, expected %s, got %s",
+                      gnc_numeric_to_string (n), cases[i].expected, buf);
+    }
+}
+
+/* xaccSPrintAmount keeps the formats it sets up; a changed commodity
+ * must not go on printing with the old one. */
+static void
+test_print_format_cache (void)
+{
+    QofBook *book = qof_book_new ();
+    gnc_commodity *comm = gnc_commodity_new (book, "Foo Corp", "NASDAQ",
+                          "FOO", NULL, 100);
+    /* Keeps the cached "FOO" string alive after comm lets go of it */
+    gnc_commodity *other = gnc_commodity_new (book, "Foo Inc", "NYSE",
+                           "FOO", NULL, 100);
+    GNCPrintAmountInfo print_info = gnc_commodity_print_info (comm, TRUE);
+    gnc_numeric n = gnc_numeric_create (123456, 100);
+    char buf[128];
+
+    xaccSPrintAmount (buf, n, print_info);
+    do_test_args (strcmp (buf, "1,234.56 FOO") == 0,
+                  "cached format", __FILE__, __LINE__,
+                  "expected 1,234.56 FOO, got %s", buf);
+    xaccSPrintAmount (buf, n, print_info);
+    do_test_args (strcmp (buf, "1,234.56 FOO") == 0,
+                  "cached format reused", __FILE__, __LINE__,
+                  "expected 1,234.56 FOO, got %s", buf);
+
+    gnc_commodity_set_mnemonic (comm, "BAR");
+    xaccSPrintAmount (buf, n, print_info);
+    do_test_args (strcmp (buf, "1,234.56 BAR") == 0,
+                  "cached format after a change", __FILE__, __LINE__,
+                  "expected 1,234.56 BAR, got %s", buf);
+
+    gnc_commodity_destroy (comm);
+    gnc_commodity_destroy (other);
+    qof_book_destroy (book);
+}
+
 #define IS_VALID_NUM(n,m)                                               \
     if (gnc_numeric_check(n)) {                                         \
         do_test_args(gnc_numeric_check(n) == GNC_ERROR_OVERFLOW,        \
@@ -110,6 +199,9 @@ run_tests (void)
 {
     int i;
 
+    test_print_format ();
+    test_print_format_cache ();
+
     for (i = 0; i < 50; i++)
     {
         gnc_numeric n;
@@ -132,6 +224,8 @@ run_tests (void)
 int
 main (int argc, char **argv)
 {
+    qof_init ();
+    cashobjects_register ();
     run_tests ();
     print_test_results ();
     exit (get_rv ());
@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <glib.h>
 #include "SX-book.h"
+#include "SX-ttinfo.h"
 #include "gnc-sx-instance-model.h"
 #include "gnc-ui-util.h"
 #include <gnc-gdate-utils.h>
@@ -59,6 +60,120 @@ test_basic()
     remove_sx(one_sx);
 }
 
+static void
+test_long_history()
+{
+    GDate today, start, last_occur, window_end;
+    SchedXaction *sx;
+
+    g_date_clear(&today, 1);
+    gnc_gdate_set_today (&today);
+    start = today;
+    g_date_subtract_days(&start, 7300);
+    last_occur = start;
+    g_date_add_days(&last_occur, 10);
+    window_end = today;
+    g_date_add_days(&window_end, 29);
+
+    sx = add_daily_sx("twenty years", &start, NULL, &last_occur);
+    do_test(gnc_sx_get_num_occur_daterange(sx, &today, &window_end) == 30,
+            "30 occurrences in the next 30 days");
+    do_test(gnc_sx_get_num_occur_daterange(sx, &start, &last_occur) == 0,
+            "0 occurrences up to the last one");
+
+    /* 7289 occurrences between the last one and today, then 5 more. */
+    xaccSchedXactionSetNumOccur(sx, 8000);
+    xaccSchedXactionSetRemOccur(sx, 7294);
+    do_test(gnc_sx_get_num_occur_daterange(sx, &today, &window_end) == 5,
+            "5 occurrences left in the next 30 days");
+    xaccSchedXactionSetRemOccur(sx, 7289);
+    do_test(gnc_sx_get_num_occur_daterange(sx, &today, &window_end) == 0,
+            "no occurrences left by today");
+
+    remove_sx(sx);
+}
+
+static SchedXaction*
+add_cashflow_sx(gchar *name, const GDate *start, Account *from, Account *to,
+                const char *formula)
+{
+    SchedXaction *sx = add_daily_sx(name, start, NULL, NULL);
+    TTInfo *tti = gnc_ttinfo_malloc();
+    TTSplitInfo *debit = gnc_ttsplitinfo_malloc();
+    TTSplitInfo *credit = gnc_ttsplitinfo_malloc();
+    GList *txns;
+
+    gnc_ttinfo_set_description(tti, name);
+    gnc_ttsplitinfo_set_account(debit, to);
+    gnc_ttsplitinfo_set_debit_formula(debit, formula);
+    gnc_ttinfo_append_template_split(tti, debit);
+    gnc_ttsplitinfo_set_account(credit, from);
+    gnc_ttsplitinfo_set_credit_formula(credit, formula);
+    gnc_ttinfo_append_template_split(tti, credit);
+
+    txns = g_list_append(NULL, tti);
+    xaccSchedXactionSetTemplateTrans(sx, txns, gnc_get_current_book());
+    g_list_free(txns);
+    gnc_ttinfo_free(tti);
+
+    return sx;
+}
+
+static void
+test_parallel_cashflow()
+{
+    const char *formulas[] = { "12.50", "2 * 3 + 1", "100 / 8" };
+    QofBook *book = gnc_get_current_book();
+    Account *bank = xaccMallocAccount(book);
+    Account *expense = xaccMallocAccount(book);
+    std::list<SchedXaction*> sxes;
+    GHashTable *serial, *parallel;
+    GList *errors = NULL;
+    GDate today, window_end;
+    gnc_numeric *total;
+    char name[32];
+    int i;
+
+    g_date_clear(&today, 1);
+    gnc_gdate_set_today (&today);
+    window_end = today;
+    g_date_add_days(&window_end, 9);
+
+    for (i = 0; i < 8; i++)
+    {
+        g_snprintf(name, sizeof(name), "cashflow %d", i);
+        sxes.push_back(add_cashflow_sx(name, &today, bank, expense,
+                                       formulas[i % 3]));
+    }
+
+    serial = gnc_g_hash_new_guid_numeric();
+    gnc_sx_all_instantiate_cashflow(sxes, &today, &window_end, serial, NULL);
+    parallel = gnc_g_hash_new_guid_numeric();
+    gnc_sx_all_instantiate_cashflow_parallel(sxes, &today, &window_end,
+                                             parallel, &errors, 4);
+
+    do_test(errors == NULL, "no errors from the parallel projection");
+    do_test(g_hash_table_size(parallel) == g_hash_table_size(serial),
+            "parallel projection has the same accounts");
+
+    /* 10 days of 5 x 12.50 and 3 x 7. */
+    total = (gnc_numeric*) g_hash_table_lookup(parallel, xaccAccountGetGUID(expense));
+    do_test(total && gnc_numeric_equal(*total, gnc_numeric_create(835, 1)),
+            "parallel projection of the debits");
+    total = (gnc_numeric*) g_hash_table_lookup(parallel, xaccAccountGetGUID(bank));
+    do_test(total && gnc_numeric_equal(*total, gnc_numeric_create(-835, 1)),
+            "parallel projection of the credits");
+    total = (gnc_numeric*) g_hash_table_lookup(serial, xaccAccountGetGUID(bank));
+    do_test(total && gnc_numeric_equal(*total, gnc_numeric_create(-835, 1)),
+            "serial projection of the credits");
+
+    g_hash_table_destroy(serial);
+    g_hash_table_destroy(parallel);
+    for (std::list<SchedXaction*>::const_iterator it = sxes.begin();
+            it != sxes.end(); it++)
+        remove_sx(*it);
+}
+
 static void
 test_empty()
 {
@@ -205,6 +320,8 @@ main(int argc, char **argv)
             test_once();
     }
     test_basic();
+    test_long_history();
+    test_parallel_cashflow();
     test_state_changes();
 
     print_test_results();
@@ -54,6 +54,8 @@ static QofLogModule log_module = G_LOG_DOMAIN;
 static /*@ null @*//*@ dependent @*/ gpointer get_parent( gpointer pObject );
 static void set_parent( gpointer pObject, /*@ null @*/ gpointer pValue );
 static void set_parent_guid( gpointer pObject, /*@ null @*/ gpointer pValue );
+static /*@ dependent @*/ const gchar* get_account_type( gpointer pObject );
+static void set_account_type( gpointer pObject, /*@ null @*/ gpointer pValue );
 
 #define ACCOUNT_MAX_NAME_LEN 2048
 #define ACCOUNT_MAX_TYPE_LEN 2048
@@ -63,27 +65,57 @@ static void set_parent_guid( gpointer pObject, /*@ null @*/ gpointer pValue );
 static const GncSqlColumnTableEntry col_table[] =
 {
     /*@ -full_init_block @*/
-    { "guid",           CT_GUID,         0,                           COL_NNUL | COL_PKEY, "guid" },
-    { "name",           CT_STRING,       ACCOUNT_MAX_NAME_LEN,        COL_NNUL,          "name" },
-    { "account_type",   CT_STRING,       ACCOUNT_MAX_TYPE_LEN,        COL_NNUL,          NULL, ACCOUNT_TYPE_ },
-    { "commodity_guid", CT_COMMODITYREF, 0,                           0,                 "commodity" },
-    { "commodity_scu",  CT_INT,          0,                           COL_NNUL,          "commodity-scu" },
-    { "non_std_scu",    CT_BOOLEAN,      0,                           COL_NNUL,          "non-std-scu" },
     {
-        "parent_guid",    CT_GUID,         0,                           0,                 NULL, NULL,
+        "guid",           CT_GUID,         0,                           COL_NNUL | COL_PKEY,
+        (QofAccessFunc)qof_instance_get_guid, (QofSetterFunc)qof_instance_set_guid
+    },
+    {
+        "name",           CT_STRING,       ACCOUNT_MAX_NAME_LEN,        COL_NNUL,
+        (QofAccessFunc)xaccAccountGetName, (QofSetterFunc)xaccAccountSetName
+    },
+    {
+        "account_type",   CT_STRING,       ACCOUNT_MAX_TYPE_LEN,        COL_NNUL,
+        (QofAccessFunc)get_account_type, set_account_type
+    },
+    {
+        "commodity_guid", CT_COMMODITYREF, 0,                           0,
+        (QofAccessFunc)xaccAccountGetCommodity, (QofSetterFunc)xaccAccountSetCommodity
+    },
+    {
+        "commodity_scu",  CT_INT,          0,                           COL_NNUL,
+        (QofAccessFunc)xaccAccountGetCommoditySCUi, (QofSetterFunc)xaccAccountSetCommoditySCU
+    },
+    {
+        "non_std_scu",    CT_BOOLEAN,      0,                           COL_NNUL,
+        (QofAccessFunc)xaccAccountGetNonStdSCU, (QofSetterFunc)xaccAccountSetNonStdSCU
+    },
+    {
+        "parent_guid",    CT_GUID,         0,                           0,
         (QofAccessFunc)get_parent, set_parent
     },
-    { "code",           CT_STRING,       ACCOUNT_MAX_CODE_LEN,        0,                 "code" },
-    { "description",    CT_STRING,       ACCOUNT_MAX_DESCRIPTION_LEN, 0,                 "description" },
-    { "hidden",         CT_BOOLEAN,      0,                           0,                 "hidden" },
-    { "placeholder",    CT_BOOLEAN,      0,                           0,                 "placeholder" },
+    {
+        "code",           CT_STRING,       ACCOUNT_MAX_CODE_LEN,        0,
+        (QofAccessFunc)xaccAccountGetCode, (QofSetterFunc)xaccAccountSetCode
+    },
+    {
+        "description",    CT_STRING,       ACCOUNT_MAX_DESCRIPTION_LEN, 0,
+        (QofAccessFunc)xaccAccountGetDescription, (QofSetterFunc)xaccAccountSetDescription
+    },
+    {
+        "hidden",         CT_BOOLEAN,      0,                           0,
+        (QofAccessFunc)xaccAccountGetHidden, (QofSetterFunc)xaccAccountSetHidden
+    },
+    {
+        "placeholder",    CT_BOOLEAN,      0,                           0,
+        (QofAccessFunc)xaccAccountGetPlaceholder, (QofSetterFunc)xaccAccountSetPlaceholder
+    },
     { NULL }
     /*@ +full_init_block @*/
 };
 static GncSqlColumnTableEntry parent_col_table[] =
 {
     /*@ -full_init_block @*/
-    { "parent_guid", CT_GUID, 0, 0, NULL, NULL, NULL, set_parent_guid },
+    { "parent_guid", CT_GUID, 0, 0, NULL, set_parent_guid },
     { NULL }
     /*@ +full_init_block @*/
 };
@@ -143,6 +175,23 @@ set_parent( gpointer pObject, /*@ null @*/ gpointer pValue )
     }
 }
 
+static /*@ dependent @*/ const gchar*
+get_account_type( gpointer pObject )
+{
+    g_return_val_if_fail( pObject != NULL, NULL );
+
+    return xaccAccountTypeEnumAsString( xaccAccountGetType( (Account*)pObject ) );
+}
+
+static void
+set_account_type( gpointer pObject, /*@ null @*/ gpointer pValue )
+{
+    g_return_if_fail( pObject != NULL );
+    g_return_if_fail( pValue != NULL );
+
+    xaccAccountSetType( (Account*)pObject, xaccAccountStringToEnum( (const gchar*)pValue ) );
+}
+
 static void
 set_parent_guid( gpointer pObject, /*@ null @*/ gpointer pValue )
 {
@@ -227,6 +276,7 @@ load_all_accounts( GncSqlBackend* be )
         while ( row != NULL )
         {
             load_single_account( be, row, &l_accounts_needing_parents );
+            qof_backend_load_yield( &be->be );
             row = gnc_sql_result_get_next_row( result );
         }
         gnc_sql_result_dispose( result );
@@ -294,12 +344,15 @@ load_all_accounts( GncSqlBackend* be )
         {
             acct_balances_t* balances = (acct_balances_t*)bal->data;
 
-            g_object_set( balances->acct,
-                          "start-balance", &balances->balance,
-                          "start-cleared-balance", &balances->cleared_balance,
-                          "start-reconciled-balance", &balances->reconciled_balance,
-                          NULL);
-
+            if ( balances->acct != NULL )
+            {
+                gnc_account_set_start_balance( balances->acct, balances->balance );
+                gnc_account_set_start_cleared_balance( balances->acct,
+                                                       balances->cleared_balance );
+                gnc_account_set_start_reconciled_balance( balances->acct,
+                        balances->reconciled_balance );
+            }
+            g_free( balances );
         }
         if ( bal_slist != NULL )
         {
@@ -355,13 +408,13 @@ gnc_sql_save_account( GncSqlBackend* be, QofInstance* inst )
     {
         op = OP_DB_DELETE;
     }
-    else if ( be->is_pristine_db || is_infant )
+    else if ( be->is_pristine_db )
     {
         op = OP_DB_INSERT;
     }
     else
     {
-        op = OP_DB_UPDATE;
+        op = OP_DB_UPSERT;
     }
 
     // If not deleting the account, ensure the commodity is in the db
@@ -416,15 +469,7 @@ load_account_guid( const GncSqlBackend* be, GncSqlRow* row,
         account = xaccAccountLookup( &guid, be->book );
         if ( account != NULL )
         {
-            if ( table_row->gobj_param_name != NULL )
-            {
-                g_object_set( pObject, table_row->gobj_param_name, account, NULL );
-            }
-            else
-            {
-                g_return_if_fail( setter != NULL );
-                (*setter)( pObject, (const gpointer)account );
-            }
+            (*setter)( pObject, (const gpointer)account );
         }
         else
         {
@@ -433,11 +478,40 @@ load_account_guid( const GncSqlBackend* be, GncSqlRow* row,
     }
 }
 
+static void
+load_account_guid_at_index( const GncSqlBackend* be, GncSqlRow* row,
+                            /*@ null @*/ QofSetterFunc setter, gpointer pObject,
+                            const GncSqlColumnTableEntry* table_row, const gint* col_indices )
+{
+    GncGUID guid;
+    Account* account = NULL;
+
+    g_return_if_fail( be != NULL );
+    g_return_if_fail( row != NULL );
+    g_return_if_fail( pObject != NULL );
+    g_return_if_fail( table_row != NULL );
+
+    if ( gnc_sql_row_get_guid_at_col_index( row, col_indices[0], &guid ) )
+    {
+        account = xaccAccountLookup( &guid, be->book );
+        if ( account != NULL )
+        {
+            (*setter)( pObject, (const gpointer)account );
+        }
+        else
+        {
+            PWARN( "Account ref '%s' not found",
+                   gnc_sql_row_get_string_at_col_index( row, col_indices[0] ) );
+        }
+    }
+}
+
 static GncSqlColumnTypeHandler account_guid_handler
 = { load_account_guid,
     gnc_sql_add_objectref_guid_col_info_to_list,
     gnc_sql_add_colname_to_list,
-    gnc_sql_add_gvalue_objectref_guid_to_slist
+    gnc_sql_add_gvalue_objectref_guid_to_slist,
+    load_account_guid_at_index
   };
 /* ================================================================= */
 void
@@ -450,9 +524,6 @@ gnc_sql_init_account_handler( void )
         gnc_sql_save_account,		/* commit */
         load_all_accounts,			/* initial_load */
         create_account_tables,		/* create_tables */
-        NULL,                       /* compile_query */
-        NULL,                       /* run_query */
-        NULL,                       /* free_query */
         NULL                        /* write */
     };
 
@@ -51,14 +51,38 @@ G_GNUC_UNUSED static QofLogModule log_module = G_LOG_DOMAIN;
 
 static GncSqlColumnTableEntry col_table[] =
 {
-    { "name",  CT_STRING, ADDRESS_MAX_NAME_LEN,         COL_NNUL, "name" },
-    { "addr1", CT_STRING, ADDRESS_MAX_ADDRESS_LINE_LEN, COL_NNUL, "addr1" },
-    { "addr2", CT_STRING, ADDRESS_MAX_ADDRESS_LINE_LEN, COL_NNUL, "addr2" },
-    { "addr3", CT_STRING, ADDRESS_MAX_ADDRESS_LINE_LEN, COL_NNUL, "addr3" },
-    { "addr4", CT_STRING, ADDRESS_MAX_ADDRESS_LINE_LEN, COL_NNUL, "addr4" },
-    { "phone", CT_STRING, ADDRESS_MAX_PHONE_LEN,        COL_NNUL, "phone" },
-    { "fax",   CT_STRING, ADDRESS_MAX_FAX_LEN,          COL_NNUL, "fax" },
-    { "email", CT_STRING, ADDRESS_MAX_EMAIL_LEN,        COL_NNUL, "email" },
+    {
+        "name", CT_STRING, ADDRESS_MAX_NAME_LEN, COL_NNUL,
+        (QofAccessFunc)gncAddressGetName, (QofSetterFunc)gncAddressSetName
+    },
+    {
+        "addr1", CT_STRING, ADDRESS_MAX_ADDRESS_LINE_LEN, COL_NNUL,
+        (QofAccessFunc)gncAddressGetAddr1, (QofSetterFunc)gncAddressSetAddr1
+    },
+    {
+        "addr2", CT_STRING, ADDRESS_MAX_ADDRESS_LINE_LEN, COL_NNUL,
+        (QofAccessFunc)gncAddressGetAddr2, (QofSetterFunc)gncAddressSetAddr2
+    },
+    {
+        "addr3", CT_STRING, ADDRESS_MAX_ADDRESS_LINE_LEN, COL_NNUL,
+        (QofAccessFunc)gncAddressGetAddr3, (QofSetterFunc)gncAddressSetAddr3
+    },
+    {
+        "addr4", CT_STRING, ADDRESS_MAX_ADDRESS_LINE_LEN, COL_NNUL,
+        (QofAccessFunc)gncAddressGetAddr4, (QofSetterFunc)gncAddressSetAddr4
+    },
+    {
+        "phone", CT_STRING, ADDRESS_MAX_PHONE_LEN, COL_NNUL,
+        (QofAccessFunc)gncAddressGetPhone, (QofSetterFunc)gncAddressSetPhone
+    },
+    {
+        "fax", CT_STRING, ADDRESS_MAX_FAX_LEN, COL_NNUL,
+        (QofAccessFunc)gncAddressGetFax, (QofSetterFunc)gncAddressSetFax
+    },
+    {
+        "email", CT_STRING, ADDRESS_MAX_EMAIL_LEN, COL_NNUL,
+        (QofAccessFunc)gncAddressGetEmail, (QofSetterFunc)gncAddressSetEmail
+    },
     { NULL }
 };
 
@@ -96,31 +120,9 @@ load_address( const GncSqlBackend* be, GncSqlRow* row,
         {
             s = g_value_get_string( val );
         }
-        if ( subtable->gobj_param_name != NULL )
-        {
-            g_object_set( addr, subtable->gobj_param_name, s, NULL );
-        }
-        else
-        {
-            if ( subtable->qof_param_name != NULL )
-            {
-                setter = qof_class_get_parameter_setter( GNC_ID_ADDRESS, subtable->qof_param_name );
-            }
-            else
-            {
-                setter = subtable->setter;
-            }
-            (*setter)( addr, (const gpointer)s );
-        }
-    }
-    if ( table_row->gobj_param_name != NULL )
-    {
-        g_object_set( pObject, table_row->gobj_param_name, addr, NULL );
-    }
-    else
-    {
-        (*a_setter)( pObject, addr );
+        (*subtable->setter)( addr, (const gpointer)s );
     }
+    (*a_setter)( pObject, addr );
 }
 
 static void
@@ -155,42 +157,14 @@ add_address_colname_to_list( const GncSqlColumnTableEntry* table_row, GList** pL
     gnc_sql_add_subtable_colnames_to_list( table_row, col_table, pList );
 }
 
-static void
-get_gvalue_address( const GncSqlBackend* be, QofIdTypeConst obj_name, const gpointer pObject,
-                    const GncSqlColumnTableEntry* table_row, GValue* value )
-{
-    AddressGetterFunc getter;
-    GncAddress* addr;
-
-    g_return_if_fail( be != NULL );
-    g_return_if_fail( obj_name != NULL );
-    g_return_if_fail( pObject != NULL );
-    g_return_if_fail( table_row != NULL );
-    g_return_if_fail( value != NULL );
-
-    memset( value, 0, sizeof( GValue ) );
-    if ( table_row->gobj_param_name != NULL )
-    {
-        g_object_get( pObject, table_row->gobj_param_name, &addr, NULL );
-    }
-    else
-    {
-        getter = (AddressGetterFunc)gnc_sql_get_getter( obj_name, table_row );
-        addr = (*getter)( pObject );
-    }
-    g_value_init( value, gnc_address_get_type() );
-    g_value_set_object( value, addr );
-}
-
 static void
 add_gvalue_address_to_slist( const GncSqlBackend* be, QofIdTypeConst obj_name,
                              const gpointer pObject, const GncSqlColumnTableEntry* table_row, GSList** pList )
 {
-    GValue value;
+    AddressGetterFunc getter;
     GValue* subfield_value;
     GncAddress* addr;
     gchar* s;
-    QofAccessFunc getter;
     const GncSqlColumnTableEntry* subtable_row;
 
     g_return_if_fail( be != NULL );
@@ -198,24 +172,15 @@ add_gvalue_address_to_slist( const GncSqlBackend* be, QofIdTypeConst obj_name,
     g_return_if_fail( pObject != NULL );
     g_return_if_fail( table_row != NULL );
 
-    memset( &value, 0, sizeof( GValue ) );
-    get_gvalue_address( be, obj_name, pObject, table_row, &value );
-
-    if ( G_VALUE_TYPE(&value) != 0 )
+    getter = (AddressGetterFunc)gnc_sql_get_getter( obj_name, table_row );
+    g_return_if_fail( getter != NULL );
+    addr = (*getter)( pObject );
+    if ( addr != NULL )
     {
-        addr = g_value_get_object( &value );
         for ( subtable_row = col_table; subtable_row->col_name != NULL; subtable_row++ )
         {
             subfield_value = g_new0( GValue, 1 );
-            if ( subtable_row->gobj_param_name != NULL )
-            {
-                g_object_get( addr, subtable_row->gobj_param_name, &s, NULL );
-            }
-            else
-            {
-                getter = gnc_sql_get_getter( GNC_ID_ADDRESS, subtable_row );
-                s = (gchar*)(*getter)( addr, NULL );
-            }
+            s = (gchar*)(*subtable_row->getter)( addr, NULL );
             g_value_init( subfield_value, G_TYPE_STRING );
             if ( s )
             {
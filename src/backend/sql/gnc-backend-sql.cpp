@@ -35,8 +35,6 @@
 #include <glib/gstdio.h>
 
 #include "qof.h"
-#include "qofquery-p.h"
-#include "qofquerycore-p.h"
 #include "AccountP.h"
 #include "TransLog.h"
 #include "gnc-engine.h"
@@ -89,11 +87,20 @@ static void update_progress( GncSqlBackend* be );
 static void finish_progress( GncSqlBackend* be );
 static void register_standard_col_type_handlers( void );
 static gboolean reset_version_info( GncSqlBackend* be );
+/* What an INSERT does when the key is already in the table */
+typedef enum
+{
+    INSERT_PLAIN,       /* Fail */
+    INSERT_OR_UPDATE,   /* Update the existing row */
+    INSERT_OR_IGNORE    /* Leave the existing row alone */
+} insert_conflict_t;
+
 /*@ null @*/
 static GncSqlStatement* build_insert_statement( GncSqlBackend* be,
         const gchar* table_name,
         QofIdTypeConst obj_name, gpointer pObject,
-        const GncSqlColumnTableEntry* table );
+        const GncSqlColumnTableEntry* table,
+        insert_conflict_t conflict );
 /*@ null @*/
 static GncSqlStatement* build_update_statement( GncSqlBackend* be,
         const gchar* table_name,
@@ -107,13 +114,6 @@ static GncSqlStatement* build_delete_statement( GncSqlBackend* be,
 
 #define TRANSACTION_NAME "trans"
 
-typedef struct
-{
-    /*@ dependent @*/ QofIdType searchObj;
-    /*@ dependent @*/
-    gpointer pCompiledQuery;
-} gnc_sql_query_info;
-
 /* callback structure */
 typedef struct
 {
@@ -123,12 +123,6 @@ typedef struct
     GncSqlBackend* be;
     /*@ dependent @*/
     QofInstance* inst;
-    /*@ dependent @*/
-    QofQuery* pQuery;
-    /*@ dependent @*/
-    gpointer pCompiledQuery;
-    /*@ owned @*/
-    gnc_sql_query_info* pQueryInfo;
 } sql_backend;
 
 static QofLogModule log_module = G_LOG_DOMAIN;
@@ -233,6 +227,17 @@ gnc_sql_load( GncSqlBackend* be, /*@ dependent @*/ QofBook *book, QofBackendLoad
         g_assert( be->book == NULL );
         be->book = book;
 
+        /* With a load window, only transactions posted since the start of
+         * the first day in the window are read.  The accounts get the sum
+         * of the older splits as their starting balances. */
+        be->tx_partially_loaded = FALSE;
+        if ( be->tx_load_window > 0 )
+        {
+            time64 cutoff = gnc_time( NULL ) - (time64)be->tx_load_window * 24 * 60 * 60;
+            timespecFromTime64( &be->tx_loaded_from, gnc_time64_get_day_start( cutoff ) );
+            be->tx_partially_loaded = TRUE;
+        }
+
         /* Load any initial stuff. Some of this needs to happen in a certain order */
         for ( i = 0; fixed_load_order[i] != NULL; i++ )
         {
@@ -265,8 +270,12 @@ gnc_sql_load( GncSqlBackend* be, /*@ dependent @*/ QofBook *book, QofBackendLoad
     }
     else if ( loadType == LOAD_TYPE_LOAD_ALL )
     {
-        // Load all transactions
-        gnc_sql_transaction_load_all_tx( be );
+        // Only a windowed initial load leaves transactions in the db, so a
+        // fully loaded book has nothing to read.
+        if ( be->tx_partially_loaded )
+        {
+            gnc_sql_transaction_load_all_tx( be );
+        }
     }
 
     be->loading = FALSE;
@@ -280,6 +289,27 @@ gnc_sql_load( GncSqlBackend* be, /*@ dependent @*/ QofBook *book, QofBackendLoad
     LEAVE( "" );
 }
 
+void
+gnc_sql_load_since( GncSqlBackend* be, Timespec since )
+{
+    g_return_if_fail( be != NULL );
+
+    if ( be->loading || !be->tx_partially_loaded ) return;
+    if ( timespec_cmp( &since, &be->tx_loaded_from ) >= 0 ) return;
+
+    ENTER( "be=%p, since=%" G_GINT64_FORMAT, be, since.tv_sec );
+
+    be->loading = TRUE;
+    qof_event_suspend();
+
+    gnc_sql_transaction_load_tx_since( be, since );
+
+    qof_event_resume();
+    be->loading = FALSE;
+
+    LEAVE( "" );
+}
+
 /* ================================================================= */
 
 #if 0
@@ -338,9 +368,8 @@ write_commodities( GncSqlBackend* be, QofBook* book )
 static gboolean
 write_account_tree( GncSqlBackend* be, Account* root )
 {
-    GList* descendants;
-    /*@ dependent @*/
-    GList* node;
+    AccountList_t descendants;
+    AccountList_t::iterator node;
     gboolean is_ok = TRUE;
 
     g_return_val_if_fail( be != NULL, FALSE );
@@ -350,12 +379,11 @@ write_account_tree( GncSqlBackend* be, Account* root )
     if ( is_ok )
     {
         descendants = gnc_account_get_descendants( root );
-        for ( node = descendants; node != NULL && is_ok; node = g_list_next(node) )
+        for ( node = descendants.begin(); node != descendants.end() && is_ok; node++ )
         {
-            is_ok = gnc_sql_save_account( be, QOF_INSTANCE((Account*)(node->data)) );
+            is_ok = gnc_sql_save_account( be, QOF_INSTANCE(*node) );
             if ( !is_ok ) break;
         }
-        g_list_free( descendants );
     }
     update_progress( be );
 
@@ -439,18 +467,17 @@ write_template_transactions( GncSqlBackend* be )
 static gboolean
 write_schedXactions( GncSqlBackend* be )
 {
-    GList* schedXactions;
-    SchedXaction* tmpSX;
+    SchedXactions* sxes;
+    std::list<SchedXaction*>::iterator node;
     gboolean is_ok = TRUE;
 
     g_return_val_if_fail( be != NULL, FALSE );
 
-    schedXactions = gnc_book_get_schedxactions( be->book )->sx_list;
+    sxes = gnc_book_get_schedxactions( be->book );
 
-    for ( ; schedXactions != NULL && is_ok; schedXactions = schedXactions->next )
+    for ( node = sxes->sx_list.begin(); node != sxes->sx_list.end() && is_ok; node++ )
     {
-        tmpSX = schedXactions->data;
-        is_ok = gnc_sql_save_schedxaction( be, QOF_INSTANCE( tmpSX ) );
+        is_ok = gnc_sql_save_schedxaction( be, QOF_INSTANCE( *node ) );
     }
     update_progress( be );
 
@@ -498,6 +525,7 @@ gnc_sql_sync_all( GncSqlBackend* be, /*@ dependent @*/ QofBook *book )
     ENTER( "book=%p, be->book=%p", book, be->book );
     update_progress( be );
     (void)reset_version_info( be );
+    gnc_sql_slots_forget_all( be );
     gnc_sql_set_table_version( be, "Gnucash", gnc_get_long_version() );
     gnc_sql_set_table_version( be, "Gnucash-Resave", GNUCASH_RESAVE_VERSION );
 
@@ -684,8 +712,10 @@ gnc_sql_commit_edit( GncSqlBackend *be, QofInstance *inst )
     }
     if ( !be_data.is_ok )
     {
-        // Error - roll it back
+        // Error - roll it back.  The slots kept for diffing may describe
+        // what was written before the rollback.
         (void)gnc_sql_connection_rollback_transaction( be->conn );
+        gnc_sql_slots_forget_all( be );
 
         // This *should* leave things marked dirty
         LEAVE( "Rolled back - database error" );
@@ -699,386 +729,6 @@ gnc_sql_commit_edit( GncSqlBackend *be, QofInstance *inst )
 
     LEAVE( "" );
 }
-/* ---------------------------------------------------------------------- */
-
-/* Query processing */
-static void
-handle_and_term( QofQueryTerm* pTerm, GString* sql )
-{
-    GSList* pParamPath;
-    QofQueryPredData* pPredData;
-    gboolean isInverted;
-    GSList* name;
-    gchar val[G_ASCII_DTOSTR_BUF_SIZE];
-
-    g_return_if_fail( pTerm != NULL );
-    g_return_if_fail( sql != NULL );
-
-    pParamPath = qof_query_term_get_param_path( pTerm );
-    pPredData = qof_query_term_get_pred_data( pTerm );
-    isInverted = qof_query_term_is_inverted( pTerm );
-
-    if ( strcmp( pPredData->type_name, QOF_TYPE_GUID ) == 0 )
-    {
-        query_guid_t guid_data = (query_guid_t)pPredData;
-        GList* guid_entry;
-
-        for ( name = pParamPath; name != NULL; name = name->next )
-        {
-            if ( name != pParamPath ) g_string_append( sql, "." );
-            g_string_append( sql, name->data );
-        }
-
-        if ( guid_data->options == QOF_GUID_MATCH_ANY )
-        {
-            if ( isInverted ) g_string_append( sql, " NOT " );
-            g_string_append( sql, " IN (" );
-        }
-        for ( guid_entry = guid_data->guids; guid_entry != NULL; guid_entry = guid_entry->next )
-        {
-            if ( guid_entry != guid_data->guids ) g_string_append( sql, "." );
-            (void)guid_to_string_buff( guid_entry->data, val );
-            g_string_append( sql, "'" );
-            g_string_append( sql, val );
-            g_string_append( sql, "'" );
-        }
-        if ( guid_data->options == QOF_GUID_MATCH_ANY )
-        {
-            g_string_append( sql, ")" );
-        }
-    }
-
-    g_string_append( sql, "(" );
-    if ( isInverted )
-    {
-        g_string_append( sql, "!" );
-    }
-
-    for ( name = pParamPath; name != NULL; name = name->next )
-    {
-        if ( name != pParamPath ) g_string_append( sql, "." );
-        g_string_append( sql, name->data );
-    }
-
-    if ( pPredData->how == QOF_COMPARE_LT )
-    {
-        g_string_append( sql, "<" );
-    }
-    else if ( pPredData->how == QOF_COMPARE_LTE )
-    {
-        g_string_append( sql, "<=" );
-    }
-    else if ( pPredData->how == QOF_COMPARE_EQUAL )
-    {
-        g_string_append( sql, "=" );
-    }
-    else if ( pPredData->how == QOF_COMPARE_GT )
-    {
-        g_string_append( sql, ">" );
-    }
-    else if ( pPredData->how == QOF_COMPARE_GTE )
-    {
-        g_string_append( sql, ">=" );
-    }
-    else if ( pPredData->how == QOF_COMPARE_NEQ )
-    {
-        g_string_append( sql, "~=" );
-    }
-    else
-    {
-        g_string_append( sql, "??" );
-    }
-
-    if ( strcmp( pPredData->type_name, "string" ) == 0 )
-    {
-        query_string_t pData = (query_string_t)pPredData;
-        g_string_append( sql, "'" );
-        g_string_append( sql, pData->matchstring );
-        g_string_append( sql, "'" );
-    }
-    else if ( strcmp( pPredData->type_name, "date" ) == 0 )
-    {
-        query_date_t pData = (query_date_t)pPredData;
-
-        (void)gnc_timespec_to_iso8601_buff( pData->date, val );
-        g_string_append( sql, "'" );
-        //g_string_append( sql, val, 4+1+2+1+2 );
-        g_string_append( sql, "'" );
-    }
-    else if ( strcmp( pPredData->type_name, "numeric" ) == 0 )
-    {
-        /* query_numeric_t pData = (query_numeric_t)pPredData; */
-
-        g_string_append( sql, "numeric" );
-    }
-    else if ( strcmp( pPredData->type_name, QOF_TYPE_GUID ) == 0 )
-    {
-    }
-    else if ( strcmp( pPredData->type_name, "gint32" ) == 0 )
-    {
-        query_int32_t pData = (query_int32_t)pPredData;
-
-        sprintf( val, "%d", pData->val );
-        g_string_append( sql, val );
-    }
-    else if ( strcmp( pPredData->type_name, "gint64" ) == 0 )
-    {
-        query_int64_t pData = (query_int64_t)pPredData;
-
-        sprintf( val, "%" G_GINT64_FORMAT, pData->val );
-        g_string_append( sql, val );
-    }
-    else if ( strcmp( pPredData->type_name, "double" ) == 0 )
-    {
-        query_double_t pData = (query_double_t)pPredData;
-
-        g_ascii_dtostr( val, sizeof(val), pData->val );
-        g_string_append( sql, val );
-    }
-    else if ( strcmp( pPredData->type_name, "boolean" ) == 0 )
-    {
-        query_boolean_t pData = (query_boolean_t)pPredData;
-
-        sprintf( val, "%d", pData->val );
-        g_string_append( sql, val );
-    }
-    else
-    {
-        g_assert( FALSE );
-    }
-
-    g_string_append( sql, ")" );
-}
-
-static void
-compile_query_cb( const gchar* type, gpointer data_p, gpointer be_data_p )
-{
-    GncSqlObjectBackend* pData = data_p;
-    sql_backend* be_data = be_data_p;
-
-    g_return_if_fail( type != NULL && pData != NULL && be_data != NULL );
-    g_return_if_fail( pData->version == GNC_SQL_BACKEND_VERSION );
-
-    // Is this the right item?
-    if ( strcmp( type, be_data->pQueryInfo->searchObj ) != 0 ) return;
-    if ( be_data->is_ok ) return;
-
-    if ( pData->compile_query != NULL )
-    {
-        be_data->pQueryInfo->pCompiledQuery = (pData->compile_query)(
-            be_data->be,
-            be_data->pQuery );
-        be_data->is_ok = TRUE;
-    }
-}
-
-gchar* gnc_sql_compile_query_to_sql( GncSqlBackend* be, QofQuery* query );
-
-/*@ null @*/
-gpointer
-gnc_sql_compile_query( QofBackend* pBEnd, QofQuery* pQuery )
-{
-    GncSqlBackend *be = (GncSqlBackend*)pBEnd;
-    QofIdType searchObj;
-    sql_backend be_data;
-    gnc_sql_query_info* pQueryInfo;
-
-    g_return_val_if_fail( pBEnd != NULL, NULL );
-    g_return_val_if_fail( pQuery != NULL, NULL );
-
-    ENTER( " " );
-
-//gnc_sql_compile_query_to_sql( be, pQuery );
-    searchObj = qof_query_get_search_for( pQuery );
-
-    pQueryInfo = g_malloc( (gsize)sizeof( gnc_sql_query_info ) );
-    g_assert( pQueryInfo != NULL );
-    pQueryInfo->pCompiledQuery = NULL;
-    pQueryInfo->searchObj = searchObj;
-
-    // Try various objects first
-    be_data.is_ok = FALSE;
-    be_data.be = be;
-    be_data.pQuery = pQuery;
-    be_data.pQueryInfo = pQueryInfo;
-
-    qof_object_foreach_backend( GNC_SQL_BACKEND, compile_query_cb, &be_data );
-    if ( be_data.is_ok )
-    {
-        LEAVE( "" );
-        return be_data.pQueryInfo;
-    }
-
-    LEAVE( "" );
-
-    return pQueryInfo;
-}
-
-static const gchar*
-convert_search_obj( QofIdType objType )
-{
-    return (gchar*)objType;
-}
-
-gchar*
-gnc_sql_compile_query_to_sql( GncSqlBackend* be, QofQuery* query )
-{
-    QofIdType searchObj;
-    GString* sql;
-
-    g_return_val_if_fail( be != NULL, NULL );
-    g_return_val_if_fail( query != NULL, NULL );
-
-    searchObj = qof_query_get_search_for( query );
-
-    /* Convert search object type to table name */
-    sql = g_string_new( "" );
-    g_string_append( sql, "SELECT * FROM " );
-    g_string_append( sql, convert_search_obj( searchObj ) );
-    if ( !qof_query_has_terms( query ) )
-    {
-        g_string_append( sql, ";" );
-    }
-    else
-    {
-        GList* orterms = qof_query_get_terms( query );
-        GList* orTerm;
-
-        g_string_append( sql, " WHERE " );
-
-        for ( orTerm = orterms; orTerm != NULL; orTerm = orTerm->next )
-        {
-            GList* andterms = (GList*)orTerm->data;
-            GList* andTerm;
-
-            if ( orTerm != orterms ) g_string_append( sql, " OR " );
-            g_string_append( sql, "(" );
-            for ( andTerm = andterms; andTerm != NULL; andTerm = andTerm->next )
-            {
-                if ( andTerm != andterms ) g_string_append( sql, " AND " );
-                handle_and_term( (QofQueryTerm*)andTerm->data, sql );
-            }
-            g_string_append( sql, ")" );
-        }
-    }
-
-    DEBUG( "Compiled: %s\n", sql->str );
-    return g_string_free( sql, FALSE );
-}
-
-static void
-free_query_cb( const gchar* type, gpointer data_p, gpointer be_data_p )
-{
-    GncSqlObjectBackend* pData = data_p;
-    sql_backend* be_data = be_data_p;
-
-    g_return_if_fail( type != NULL && pData != NULL && be_data != NULL );
-    g_return_if_fail( pData->version == GNC_SQL_BACKEND_VERSION );
-    if ( be_data->is_ok ) return;
-    if ( strcmp( type, be_data->pQueryInfo->searchObj ) != 0 ) return;
-
-    if ( pData->free_query != NULL )
-    {
-        (pData->free_query)( be_data->be, be_data->pCompiledQuery );
-        be_data->is_ok = TRUE;
-    }
-}
-
-void
-gnc_sql_free_query( QofBackend* pBEnd, gpointer pQuery )
-{
-    GncSqlBackend *be = (GncSqlBackend*)pBEnd;
-    gnc_sql_query_info* pQueryInfo = (gnc_sql_query_info*)pQuery;
-    sql_backend be_data;
-
-    g_return_if_fail( pBEnd != NULL );
-    g_return_if_fail( pQuery != NULL );
-
-    ENTER( " " );
-
-    // Try various objects first
-    be_data.is_ok = FALSE;
-    be_data.be = be;
-    be_data.pCompiledQuery = pQuery;
-    be_data.pQueryInfo = pQueryInfo;
-
-    qof_object_foreach_backend( GNC_SQL_BACKEND, free_query_cb, &be_data );
-    if ( be_data.is_ok )
-    {
-        LEAVE( "" );
-        return;
-    }
-
-    if ( pQueryInfo->pCompiledQuery != NULL )
-    {
-        DEBUG( "%s\n", (gchar*)pQueryInfo->pCompiledQuery );
-        g_free( pQueryInfo->pCompiledQuery );
-    }
-    g_free( pQueryInfo );
-
-    LEAVE( "" );
-}
-
-static void
-run_query_cb( const gchar* type, gpointer data_p, gpointer be_data_p )
-{
-    GncSqlObjectBackend* pData = data_p;
-    sql_backend* be_data = be_data_p;
-
-    g_return_if_fail( type != NULL && pData != NULL && be_data != NULL );
-    g_return_if_fail( pData->version == GNC_SQL_BACKEND_VERSION );
-    if ( be_data->is_ok ) return;
-
-    // Is this the right item?
-    if ( strcmp( type, be_data->pQueryInfo->searchObj ) != 0 ) return;
-
-    if ( pData->run_query != NULL )
-    {
-        (pData->run_query)( be_data->be, be_data->pCompiledQuery );
-        be_data->is_ok = TRUE;
-    }
-}
-
-void
-gnc_sql_run_query( QofBackend* pBEnd, gpointer pQuery )
-{
-    GncSqlBackend *be = (GncSqlBackend*)pBEnd;
-    gnc_sql_query_info* pQueryInfo = (gnc_sql_query_info*)pQuery;
-    sql_backend be_data;
-
-    g_return_if_fail( pBEnd != NULL );
-    g_return_if_fail( pQuery != NULL );
-    g_return_if_fail( !be->in_query );
-
-    ENTER( " " );
-
-    be->loading = TRUE;
-    be->in_query = TRUE;
-
-    qof_event_suspend();
-
-    // Try various objects first
-    be_data.is_ok = FALSE;
-    be_data.be = be;
-    be_data.pCompiledQuery = pQueryInfo->pCompiledQuery;
-    be_data.pQueryInfo = pQueryInfo;
-
-    qof_object_foreach_backend( GNC_SQL_BACKEND, run_query_cb, &be_data );
-    be->loading = FALSE;
-    be->in_query = FALSE;
-    qof_event_resume();
-//    if( be_data.is_ok ) {
-//        LEAVE( "" );
-//        return;
-//    }
-
-    // Mark the book as clean
-    qof_instance_mark_clean( QOF_INSTANCE(be->book) );
-
-//    DEBUG( "%s\n", (gchar*)pQueryInfo->pCompiledQuery );
-
-    LEAVE( "" );
-}
 
 /* ================================================================= */
 /* Order in which business objects need to be loaded */
@@ -1191,11 +841,6 @@ gnc_sql_get_getter( QofIdTypeConst obj_name, const GncSqlColumnTableEntry* table
     {
         getter = get_autoinc_id;
     }
-    else if ( table_row->qof_param_name != NULL )
-    {
-        getter = qof_class_get_parameter_getter( obj_name,
-        table_row->qof_param_name );
-    }
     else
     {
         getter = table_row->getter;
@@ -1258,20 +903,30 @@ const GncSqlColumnTableEntry* table_row )
     g_return_if_fail( row != NULL );
     g_return_if_fail( pObject != NULL );
     g_return_if_fail( table_row != NULL );
-    g_return_if_fail( table_row->gobj_param_name != NULL || setter != NULL );
+    g_return_if_fail( setter != NULL );
 
     val = gnc_sql_row_get_value_at_col_name( row, table_row->col_name );
     g_return_if_fail( val != NULL );
     s = g_value_get_string( val );
-    if ( table_row->gobj_param_name != NULL )
-    {
-        g_object_set( pObject, table_row->gobj_param_name, s, NULL );
-    }
-    else
-    {
-        g_return_if_fail( setter != NULL );
-        (*setter)( pObject, (const gpointer)s );
-    }
+    (*setter)( pObject, (const gpointer)s );
+}
+
+static void
+load_string_at_index( const GncSqlBackend* be, GncSqlRow* row,
+/*@ null @*/ QofSetterFunc setter, gpointer pObject,
+const GncSqlColumnTableEntry* table_row, const gint* col_indices )
+{
+    const gchar* s;
+
+    g_return_if_fail( be != NULL );
+    g_return_if_fail( row != NULL );
+    g_return_if_fail( pObject != NULL );
+    g_return_if_fail( table_row != NULL );
+    g_return_if_fail( setter != NULL );
+
+    s = gnc_sql_row_get_string_at_col_index( row, col_indices[0] );
+    /* Like load_string, a NULL column is passed on to the setter as NULL */
+    (*setter)( pObject, (const gpointer)s );
 }
 
 static void
@@ -1306,20 +961,13 @@ const gpointer pObject, const GncSqlColumnTableEntry* table_row, GSList** pList
     value = g_new0( GValue, 1 );
     g_assert( value != NULL );
     memset( value, 0, sizeof( GValue ) );
-    if ( table_row->gobj_param_name != NULL )
-    {
-        g_object_get( pObject, table_row->gobj_param_name, &s, NULL );
-    }
-    else
+    getter = gnc_sql_get_getter( obj_name, table_row );
+    if ( getter != NULL )
     {
-        getter = gnc_sql_get_getter( obj_name, table_row );
-        if ( getter != NULL )
+        s = (gchar*)(*getter)( pObject, NULL );
+        if ( s != NULL )
         {
-            s = (gchar*)(*getter)( pObject, NULL );
-            if ( s != NULL )
-            {
-                s = g_strdup( s );
-            }
+            s = g_strdup( s );
         }
     }
     (void)g_value_init( value, G_TYPE_STRING );
@@ -1337,7 +985,8 @@ static GncSqlColumnTypeHandler string_handler
     load_string,
     add_string_col_info_to_list,
     gnc_sql_add_colname_to_list,
-    add_gvalue_string_to_slist
+    add_gvalue_string_to_slist,
+    load_string_at_index
 };
 /* ----------------------------------------------------------------- */
 typedef gint (*IntAccessFunc)( const gpointer );
@@ -1356,7 +1005,7 @@ load_int( const GncSqlBackend* be, GncSqlRow* row,
     g_return_if_fail( row != NULL );
     g_return_if_fail( pObject != NULL );
     g_return_if_fail( table_row != NULL );
-    g_return_if_fail( table_row->gobj_param_name != NULL || setter != NULL );
+    g_return_if_fail( setter != NULL );
 
     val = gnc_sql_row_get_value_at_col_name( row, table_row->col_name );
     if ( val == NULL )
@@ -1367,16 +1016,27 @@ load_int( const GncSqlBackend* be, GncSqlRow* row,
     {
         int_value = (gint)gnc_sql_get_integer_value( val );
     }
-    if ( table_row->gobj_param_name != NULL )
-    {
-        g_object_set( pObject, table_row->gobj_param_name, int_value, NULL );
-    }
-    else
-    {
-        g_return_if_fail( setter != NULL );
-        i_setter = (IntSetterFunc)setter;
-        (*i_setter)( pObject, int_value );
-    }
+    i_setter = (IntSetterFunc)setter;
+    (*i_setter)( pObject, int_value );
+}
+
+static void
+load_int_at_index( const GncSqlBackend* be, GncSqlRow* row,
+                   /*@ null @*/ QofSetterFunc setter, gpointer pObject,
+                   const GncSqlColumnTableEntry* table_row, const gint* col_indices )
+{
+    gint64 i64_value = 0;
+    IntSetterFunc i_setter;
+
+    g_return_if_fail( be != NULL );
+    g_return_if_fail( row != NULL );
+    g_return_if_fail( pObject != NULL );
+    g_return_if_fail( table_row != NULL );
+    g_return_if_fail( setter != NULL );
+
+    (void)gnc_sql_row_get_int64_at_col_index( row, col_indices[0], &i64_value );
+    i_setter = (IntSetterFunc)setter;
+    (*i_setter)( pObject, (gint)i64_value );
 }
 
 static void
@@ -1412,19 +1072,12 @@ add_gvalue_int_to_slist( const GncSqlBackend* be, QofIdTypeConst obj_name,
     g_assert( value != NULL );
     (void)g_value_init( value, G_TYPE_INT );
 
-    if ( table_row->gobj_param_name != NULL )
+    i_getter = (IntAccessFunc)gnc_sql_get_getter( obj_name, table_row );
+    if ( i_getter != NULL )
     {
-        g_object_get_property( pObject, table_row->gobj_param_name, value );
-    }
-    else
-    {
-        i_getter = (IntAccessFunc)gnc_sql_get_getter( obj_name, table_row );
-        if ( i_getter != NULL )
-        {
-            int_value = (*i_getter)( pObject );
-        }
-        g_value_set_int( value, int_value );
+        int_value = (*i_getter)( pObject );
     }
+    g_value_set_int( value, int_value );
 
     (*pList) = g_slist_append( (*pList), value );
 }
@@ -1435,11 +1088,12 @@ static GncSqlColumnTypeHandler int_handler
     load_int,
     add_int_col_info_to_list,
     gnc_sql_add_colname_to_list,
-    add_gvalue_int_to_slist
+    add_gvalue_int_to_slist,
+    load_int_at_index
 };
 /* ----------------------------------------------------------------- */
-typedef gboolean (*BooleanAccessFunc)( const gpointer );
-typedef void (*BooleanSetterFunc)( const gpointer, gboolean );
+typedef bool (*BooleanAccessFunc)( const gpointer );
+typedef void (*BooleanSetterFunc)( const gpointer, bool );
 
 static void
 load_boolean( const GncSqlBackend* be, GncSqlRow* row,
@@ -1454,7 +1108,7 @@ load_boolean( const GncSqlBackend* be, GncSqlRow* row,
     g_return_if_fail( row != NULL );
     g_return_if_fail( pObject != NULL );
     g_return_if_fail( table_row != NULL );
-    g_return_if_fail( table_row->gobj_param_name != NULL || setter != NULL );
+    g_return_if_fail( setter != NULL );
 
     val = gnc_sql_row_get_value_at_col_name( row, table_row->col_name );
     if ( val == NULL )
@@ -1465,16 +1119,27 @@ load_boolean( const GncSqlBackend* be, GncSqlRow* row,
     {
         int_value = (gint)gnc_sql_get_integer_value( val );
     }
-    if ( table_row->gobj_param_name != NULL )
-    {
-        g_object_set( pObject, table_row->gobj_param_name, int_value, NULL );
-    }
-    else
-    {
-        g_return_if_fail( setter != NULL );
-        b_setter = (BooleanSetterFunc)setter;
-        (*b_setter)( pObject, (int_value != 0) ? TRUE : FALSE );
-    }
+    b_setter = (BooleanSetterFunc)setter;
+    (*b_setter)( pObject, int_value != 0 );
+}
+
+static void
+load_boolean_at_index( const GncSqlBackend* be, GncSqlRow* row,
+                       /*@ null @*/ QofSetterFunc setter, gpointer pObject,
+                       const GncSqlColumnTableEntry* table_row, const gint* col_indices )
+{
+    gint64 i64_value = 0;
+    BooleanSetterFunc b_setter;
+
+    g_return_if_fail( be != NULL );
+    g_return_if_fail( row != NULL );
+    g_return_if_fail( pObject != NULL );
+    g_return_if_fail( table_row != NULL );
+    g_return_if_fail( setter != NULL );
+
+    (void)gnc_sql_row_get_int64_at_col_index( row, col_indices[0], &i64_value );
+    b_setter = (BooleanSetterFunc)setter;
+    (*b_setter)( pObject, i64_value != 0 );
 }
 
 static void
@@ -1509,17 +1174,10 @@ add_gvalue_boolean_to_slist( const GncSqlBackend* be, QofIdTypeConst obj_name,
     value = g_new0( GValue, 1 );
     g_assert( value != NULL );
 
-    if ( table_row->gobj_param_name != NULL )
-    {
-        g_object_get( pObject, table_row->gobj_param_name, &int_value, NULL );
-    }
-    else
+    b_getter = (BooleanAccessFunc)gnc_sql_get_getter( obj_name, table_row );
+    if ( b_getter != NULL )
     {
-        b_getter = (BooleanAccessFunc)gnc_sql_get_getter( obj_name, table_row );
-        if ( b_getter != NULL )
-        {
-            int_value = ((*b_getter)( pObject )) ? 1 : 0;
-        }
+        int_value = ((*b_getter)( pObject )) ? 1 : 0;
     }
     (void)g_value_init( value, G_TYPE_INT );
     g_value_set_int( value, int_value );
@@ -1533,7 +1191,8 @@ static GncSqlColumnTypeHandler boolean_handler
     load_boolean,
     add_boolean_col_info_to_list,
     gnc_sql_add_colname_to_list,
-    add_gvalue_boolean_to_slist
+    add_gvalue_boolean_to_slist,
+    load_boolean_at_index
 };
 /* ----------------------------------------------------------------- */
 typedef gint64 (*Int64AccessFunc)( const gpointer );
@@ -1544,28 +1203,39 @@ load_int64( const GncSqlBackend* be, GncSqlRow* row,
             /*@ null @*/ QofSetterFunc setter, gpointer pObject,
             const GncSqlColumnTableEntry* table_row )
 {
-    const GValue* val;
+    const GValue* val;
+    gint64 i64_value = 0;
+    Int64SetterFunc i64_setter = (Int64SetterFunc)setter;
+
+    g_return_if_fail( be != NULL );
+    g_return_if_fail( row != NULL );
+    g_return_if_fail( table_row != NULL );
+    g_return_if_fail( setter != NULL );
+
+    val = gnc_sql_row_get_value_at_col_name( row, table_row->col_name );
+    if ( val != NULL )
+    {
+        i64_value = gnc_sql_get_integer_value( val );
+    }
+    (*i64_setter)( pObject, i64_value );
+}
+
+static void
+load_int64_at_index( const GncSqlBackend* be, GncSqlRow* row,
+                     /*@ null @*/ QofSetterFunc setter, gpointer pObject,
+                     const GncSqlColumnTableEntry* table_row, const gint* col_indices )
+{
     gint64 i64_value = 0;
     Int64SetterFunc i64_setter = (Int64SetterFunc)setter;
 
     g_return_if_fail( be != NULL );
     g_return_if_fail( row != NULL );
+    g_return_if_fail( pObject != NULL );
     g_return_if_fail( table_row != NULL );
-    g_return_if_fail( table_row->gobj_param_name != NULL || setter != NULL );
+    g_return_if_fail( setter != NULL );
 
-    val = gnc_sql_row_get_value_at_col_name( row, table_row->col_name );
-    if ( val != NULL )
-    {
-        i64_value = gnc_sql_get_integer_value( val );
-    }
-    if ( table_row->gobj_param_name != NULL )
-    {
-        g_object_set( pObject, table_row->gobj_param_name, i64_value, NULL );
-    }
-    else
-    {
-        (*i64_setter)( pObject, i64_value );
-    }
+    (void)gnc_sql_row_get_int64_at_col_index( row, col_indices[0], &i64_value );
+    (*i64_setter)( pObject, i64_value );
 }
 
 static void
@@ -1599,17 +1269,10 @@ add_gvalue_int64_to_slist( const GncSqlBackend* be, QofIdTypeConst obj_name,
 
     value = g_new0( GValue, 1 );
     g_assert( value != NULL );
-    if ( table_row->gobj_param_name != NULL )
-    {
-        g_object_get( pObject, table_row->gobj_param_name, &i64_value, NULL );
-    }
-    else
+    getter = (Int64AccessFunc)gnc_sql_get_getter( obj_name, table_row );
+    if ( getter != NULL )
     {
-        getter = (Int64AccessFunc)gnc_sql_get_getter( obj_name, table_row );
-        if ( getter != NULL )
-        {
-            i64_value = (*getter)( pObject );
-        }
+        i64_value = (*getter)( pObject );
     }
     (void)g_value_init( value, G_TYPE_INT64 );
     g_value_set_int64( value, i64_value );
@@ -1623,7 +1286,8 @@ static GncSqlColumnTypeHandler int64_handler
     load_int64,
     add_int64_col_info_to_list,
     gnc_sql_add_colname_to_list,
-    add_gvalue_int64_to_slist
+    add_gvalue_int64_to_slist,
+    load_int64_at_index
 };
 /* ----------------------------------------------------------------- */
 
@@ -1639,7 +1303,7 @@ load_double( const GncSqlBackend* be, GncSqlRow* row,
     g_return_if_fail( row != NULL );
     g_return_if_fail( pObject != NULL );
     g_return_if_fail( table_row != NULL );
-    g_return_if_fail( table_row->gobj_param_name != NULL || setter != NULL );
+    g_return_if_fail( setter != NULL );
 
     val = gnc_sql_row_get_value_at_col_name( row, table_row->col_name );
     if ( val == NULL )
@@ -1665,14 +1329,7 @@ load_double( const GncSqlBackend* be, GncSqlRow* row,
             PWARN( "Unknown float value type: %s\n", g_type_name( G_VALUE_TYPE(val) ) );
             d_value = 0;
         }
-        if ( table_row->gobj_param_name != NULL )
-        {
-            g_object_set( pObject, table_row->gobj_param_name, d_value, NULL );
-        }
-        else
-        {
-            (*setter)( pObject, (gpointer)&d_value );
-        }
+        (*setter)( pObject, (gpointer)&d_value );
     }
 }
 
@@ -1750,7 +1407,7 @@ load_guid( const GncSqlBackend* be, GncSqlRow* row,
     g_return_if_fail( row != NULL );
     g_return_if_fail( pObject != NULL );
     g_return_if_fail( table_row != NULL );
-    g_return_if_fail( table_row->gobj_param_name != NULL || setter != NULL );
+    g_return_if_fail( setter != NULL );
 
     val = gnc_sql_row_get_value_at_col_name( row, table_row->col_name );
     if ( val == NULL || g_value_get_string( val ) == NULL )
@@ -1764,15 +1421,26 @@ load_guid( const GncSqlBackend* be, GncSqlRow* row,
     }
     if ( pGuid != NULL )
     {
-        if ( table_row->gobj_param_name != NULL )
-        {
-            g_object_set( pObject, table_row->gobj_param_name, pGuid, NULL );
-        }
-        else
-        {
-            g_return_if_fail( setter != NULL );
-            (*setter)( pObject, (const gpointer)pGuid );
-        }
+        (*setter)( pObject, (const gpointer)pGuid );
+    }
+}
+
+static void
+load_guid_at_index( const GncSqlBackend* be, GncSqlRow* row,
+                    /*@ null @*/ QofSetterFunc setter, gpointer pObject,
+                    const GncSqlColumnTableEntry* table_row, const gint* col_indices )
+{
+    GncGUID guid;
+
+    g_return_if_fail( be != NULL );
+    g_return_if_fail( row != NULL );
+    g_return_if_fail( pObject != NULL );
+    g_return_if_fail( table_row != NULL );
+    g_return_if_fail( setter != NULL );
+
+    if ( gnc_sql_row_get_guid_at_col_index( row, col_indices[0], &guid ) )
+    {
+        (*setter)( pObject, (const gpointer)&guid );
     }
 }
 
@@ -1807,17 +1475,10 @@ add_gvalue_guid_to_slist( const GncSqlBackend* be, QofIdTypeConst obj_name,
 
     value = g_new0( GValue, 1 );
     g_assert( value != NULL );
-    if ( table_row->gobj_param_name != NULL )
-    {
-        g_object_get( pObject, table_row->gobj_param_name, &guid, NULL );
-    }
-    else
+    getter = gnc_sql_get_getter( obj_name, table_row );
+    if ( getter != NULL )
     {
-        getter = gnc_sql_get_getter( obj_name, table_row );
-        if ( getter != NULL )
-        {
-            guid = (*getter)( pObject, NULL );
-        }
+        guid = (*getter)( pObject, NULL );
     }
     (void)g_value_init( value, G_TYPE_STRING );
     if ( guid != NULL )
@@ -1836,13 +1497,14 @@ static GncSqlColumnTypeHandler guid_handler
     load_guid,
     add_guid_col_info_to_list,
     gnc_sql_add_colname_to_list,
-    add_gvalue_guid_to_slist
+    add_gvalue_guid_to_slist,
+    load_guid_at_index
 };
 /* ----------------------------------------------------------------- */
 
 void
 gnc_sql_add_gvalue_objectref_guid_to_slist( const GncSqlBackend* be, QofIdTypeConst obj_name,
-        const gpointer pObject, const GncSqlColumnTableEntry* table_row, GSList** pList )
+        const void* pObject, const GncSqlColumnTableEntry* table_row, GSList** pList )
 {
     QofAccessFunc getter;
     const GncGUID* guid = NULL;
@@ -1857,17 +1519,10 @@ gnc_sql_add_gvalue_objectref_guid_to_slist( const GncSqlBackend* be, QofIdTypeCo
 
     value = g_new0( GValue, 1 );
     g_assert( value != NULL );
-    if ( table_row->gobj_param_name != NULL )
-    {
-        g_object_get( pObject, table_row->gobj_param_name, &inst, NULL );
-    }
-    else
+    getter = gnc_sql_get_getter( obj_name, table_row );
+    if ( getter != NULL )
     {
-        getter = gnc_sql_get_getter( obj_name, table_row );
-        if ( getter != NULL )
-        {
-            inst = (*getter)( pObject, NULL );
-        }
+        inst = (*getter)( pObject, NULL );
     }
     if ( inst != NULL )
     {
@@ -1917,6 +1572,30 @@ gnc_sql_convert_timespec_to_string( const GncSqlBackend* be, Timespec ts )
     return datebuf;
 }
 
+/* Converts a timespec in the db format (YYYYMMDDHHMMSS) to a Timespec */
+static Timespec
+timespec_from_db_string( const gchar* s )
+{
+    gchar buf[4 + 1 + 2 + 1 + 2 + 1 + 2 + 1 + 2 + 1 + 2 + 1];
+
+    (void)g_snprintf( buf, sizeof( buf ), "%c%c%c%c-%c%c-%c%c %c%c:%c%c:%c%c",
+                      s[0], s[1], s[2], s[3],
+                      s[4], s[5],
+                      s[6], s[7],
+                      s[8], s[9],
+                      s[10], s[11],
+                      s[12], s[13] );
+    return gnc_iso8601_to_timespec_gmt( buf );
+}
+
+static void
+set_timespec( gpointer pObject, /*@ null @*/ QofSetterFunc setter,
+              const GncSqlColumnTableEntry* table_row, Timespec ts )
+{
+    TimespecSetterFunc ts_setter = (TimespecSetterFunc)setter;
+    (*ts_setter)( pObject, ts );
+}
+
 static void
 load_timespec( const GncSqlBackend* be, GncSqlRow* row,
                /*@ null @*/ QofSetterFunc setter, gpointer pObject,
@@ -1924,16 +1603,14 @@ load_timespec( const GncSqlBackend* be, GncSqlRow* row,
 {
     const GValue* val;
     Timespec ts = {0, 0};
-    TimespecSetterFunc ts_setter;
     gboolean isOK = FALSE;
 
     g_return_if_fail( be != NULL );
     g_return_if_fail( row != NULL );
     g_return_if_fail( pObject != NULL );
     g_return_if_fail( table_row != NULL );
-    g_return_if_fail( table_row->gobj_param_name != NULL || setter != NULL );
+    g_return_if_fail( setter != NULL );
 
-    ts_setter = (TimespecSetterFunc)setter;
     val = gnc_sql_row_get_value_at_col_name( row, table_row->col_name );
     if ( val == NULL )
     {
@@ -1946,16 +1623,7 @@ load_timespec( const GncSqlBackend* be, GncSqlRow* row,
             const gchar* s = g_value_get_string( val );
             if ( s != NULL )
             {
-                gchar* buf;
-                buf = g_strdup_printf( "%c%c%c%c-%c%c-%c%c %c%c:%c%c:%c%c",
-                                       s[0], s[1], s[2], s[3],
-                                       s[4], s[5],
-                                       s[6], s[7],
-                                       s[8], s[9],
-                                       s[10], s[11],
-                                       s[12], s[13] );
-                ts = gnc_iso8601_to_timespec_gmt( buf );
-                g_free( buf );
+                ts = timespec_from_db_string( s );
                 isOK = TRUE;
             }
 
@@ -1967,15 +1635,30 @@ load_timespec( const GncSqlBackend* be, GncSqlRow* row,
     }
     if ( isOK )
     {
-        if (table_row->gobj_param_name != NULL)
-        {
-            g_object_set( pObject, table_row->gobj_param_name, &ts, NULL );
-        }
-        else
-        {
-            (*ts_setter)( pObject, ts );
-        }
+        set_timespec( pObject, setter, table_row, ts );
+    }
+}
+
+static void
+load_timespec_at_index( const GncSqlBackend* be, GncSqlRow* row,
+                        /*@ null @*/ QofSetterFunc setter, gpointer pObject,
+                        const GncSqlColumnTableEntry* table_row, const gint* col_indices )
+{
+    const gchar* s;
+    Timespec ts = {0, 0};
+
+    g_return_if_fail( be != NULL );
+    g_return_if_fail( row != NULL );
+    g_return_if_fail( pObject != NULL );
+    g_return_if_fail( table_row != NULL );
+    g_return_if_fail( setter != NULL );
+
+    s = gnc_sql_row_get_string_at_col_index( row, col_indices[0] );
+    if ( s != NULL )
+    {
+        ts = timespec_from_db_string( s );
     }
+    set_timespec( pObject, setter, table_row, ts );
 }
 
 static void
@@ -2008,18 +1691,9 @@ add_gvalue_timespec_to_slist( const GncSqlBackend* be, QofIdTypeConst obj_name,
     g_return_if_fail( table_row != NULL );
     g_return_if_fail( pList != NULL );
 
-    if ( table_row->gobj_param_name != NULL )
-    {
-        Timespec* pts;
-        g_object_get( pObject, table_row->gobj_param_name, &pts, NULL );
-        ts = *pts;
-    }
-    else
-    {
-        ts_getter = (TimespecAccessFunc)gnc_sql_get_getter( obj_name, table_row );
-        g_return_if_fail( ts_getter != NULL );
-        ts = (*ts_getter)( pObject );
-    }
+    ts_getter = (TimespecAccessFunc)gnc_sql_get_getter( obj_name, table_row );
+    g_return_if_fail( ts_getter != NULL );
+    ts = (*ts_getter)( pObject );
 
     value = g_new0( GValue, 1 );
     g_assert( value != NULL );
@@ -2039,7 +1713,8 @@ static GncSqlColumnTypeHandler timespec_handler
     load_timespec,
     add_timespec_col_info_to_list,
     gnc_sql_add_colname_to_list,
-    add_gvalue_timespec_to_slist
+    add_gvalue_timespec_to_slist,
+    load_timespec_at_index
 };
 /* ----------------------------------------------------------------- */
 #define DATE_COL_SIZE 8
@@ -2056,7 +1731,7 @@ load_date( const GncSqlBackend* be, GncSqlRow* row,
     g_return_if_fail( row != NULL );
     g_return_if_fail( pObject != NULL );
     g_return_if_fail( table_row != NULL );
-    g_return_if_fail( table_row->gobj_param_name != NULL || setter != NULL );
+    g_return_if_fail( setter != NULL );
 
     val = gnc_sql_row_get_value_at_col_name( row, table_row->col_name );
     if ( val != NULL )
@@ -2085,14 +1760,7 @@ load_date( const GncSqlBackend* be, GncSqlRow* row,
                 if ( year != 0 || month != 0 || day != (GDateDay)0 )
                 {
                     date = g_date_new_dmy( day, month, year );
-                    if ( table_row->gobj_param_name != NULL )
-                    {
-                        g_object_set( pObject, table_row->gobj_param_name, date, NULL );
-                    }
-                    else
-                    {
-                        (*setter)( pObject, date );
-                    }
+                    (*setter)( pObject, date );
                     g_date_free( date );
                 }
             }
@@ -2137,17 +1805,10 @@ add_gvalue_date_to_slist( const GncSqlBackend* be, QofIdTypeConst obj_name,
     value = g_new0( GValue, 1 );
     g_assert( value != NULL );
     (void)g_value_init( value, G_TYPE_STRING );
-    if ( table_row->gobj_param_name != NULL )
-    {
-        g_object_get( pObject, table_row->gobj_param_name, &date, NULL );
-    }
-    else
+    getter = gnc_sql_get_getter( obj_name, table_row );
+    if ( getter != NULL )
     {
-        getter = gnc_sql_get_getter( obj_name, table_row );
-        if ( getter != NULL )
-        {
-            date = (GDate*)(*getter)( pObject, NULL );
-        }
+        date = (GDate*)(*getter)( pObject, NULL );
     }
     if ( date && g_date_valid( date ) )
     {
@@ -2174,8 +1835,8 @@ typedef void (*NumericSetterFunc)( gpointer, gnc_numeric );
 static const GncSqlColumnTableEntry numeric_col_table[] =
 {
     /*@ -full_init_block @*/
-    { "num",    CT_INT64, 0, COL_NNUL, "guid" },
-    { "denom",  CT_INT64, 0, COL_NNUL, "guid" },
+    { "num",    CT_INT64, 0, COL_NNUL },
+    { "denom",  CT_INT64, 0, COL_NNUL },
     { NULL }
     /*@ +full_init_block @*/
 };
@@ -2195,7 +1856,7 @@ load_numeric( const GncSqlBackend* be, GncSqlRow* row,
     g_return_if_fail( row != NULL );
     g_return_if_fail( pObject != NULL );
     g_return_if_fail( table_row != NULL );
-    g_return_if_fail( table_row->gobj_param_name != NULL || setter != NULL );
+    g_return_if_fail( setter != NULL );
 
     buf = g_strdup_printf( "%s_num", table_row->col_name );
     val = gnc_sql_row_get_value_at_col_name( row, buf );
@@ -2224,18 +1885,34 @@ load_numeric( const GncSqlBackend* be, GncSqlRow* row,
     n = gnc_numeric_create( num, denom );
     if ( !isNull )
     {
-        if ( table_row->gobj_param_name != NULL )
-        {
-            g_object_set( pObject, table_row->gobj_param_name, &n, NULL );
-        }
-        else
-        {
-            NumericSetterFunc n_setter = (NumericSetterFunc)setter;
-            (*n_setter)( pObject, n );
-        }
+        NumericSetterFunc n_setter = (NumericSetterFunc)setter;
+        (*n_setter)( pObject, n );
     }
 }
 
+static void
+load_numeric_at_index( const GncSqlBackend* be, GncSqlRow* row,
+                       /*@ null @*/ QofSetterFunc setter, gpointer pObject,
+                       const GncSqlColumnTableEntry* table_row, const gint* col_indices )
+{
+    gint64 num = 0, denom = 1;
+    gnc_numeric n;
+
+    g_return_if_fail( be != NULL );
+    g_return_if_fail( row != NULL );
+    g_return_if_fail( pObject != NULL );
+    g_return_if_fail( table_row != NULL );
+    g_return_if_fail( setter != NULL );
+
+    // Columns are in add_numeric_colname_to_list() order: _num, _denom
+    if ( !gnc_sql_row_get_int64_at_col_index( row, col_indices[0], &num ) ) return;
+    if ( !gnc_sql_row_get_int64_at_col_index( row, col_indices[1], &denom ) ) return;
+
+    n = gnc_numeric_create( num, denom );
+    NumericSetterFunc n_setter = (NumericSetterFunc)setter;
+    (*n_setter)( pObject, n );
+}
+
 static void
 add_numeric_col_info_to_list( const GncSqlBackend* be, const GncSqlColumnTableEntry* table_row,
                               GList** pList )
@@ -2282,23 +1959,14 @@ add_gvalue_numeric_to_slist( const GncSqlBackend* be, QofIdTypeConst obj_name,
     g_return_if_fail( pObject != NULL );
     g_return_if_fail( table_row != NULL );
 
-    if ( table_row->gobj_param_name != NULL )
+    getter = (NumericGetterFunc)gnc_sql_get_getter( obj_name, table_row );
+    if ( getter != NULL )
     {
-        gnc_numeric *s;
-        g_object_get( pObject, table_row->gobj_param_name, &s, NULL );
-        n = *s;
+        n = (*getter)( pObject );
     }
     else
     {
-        getter = (NumericGetterFunc)gnc_sql_get_getter( obj_name, table_row );
-        if ( getter != NULL )
-        {
-            n = (*getter)( pObject );
-        }
-        else
-        {
-            n = gnc_numeric_zero();
-        }
+        n = gnc_numeric_zero();
     }
 
     num_value = g_new0( GValue, 1 );
@@ -2318,7 +1986,8 @@ static GncSqlColumnTypeHandler numeric_handler
 = { load_numeric,
     add_numeric_col_info_to_list,
     add_numeric_colname_to_list,
-    add_gvalue_numeric_to_slist
+    add_gvalue_numeric_to_slist,
+    load_numeric_at_index
   };
 /* ================================================================= */
 
@@ -2392,7 +2061,7 @@ _retrieve_guid_( gpointer pObject, /*@ null @*/ gpointer pValue )
 static GncSqlColumnTableEntry guid_table[] =
 {
     /*@ -full_init_block @*/
-    { "guid", CT_GUID, 0, 0, NULL, NULL, NULL, _retrieve_guid_ },
+    { "guid", CT_GUID, 0, 0, NULL, _retrieve_guid_ },
     { NULL }
     /*@ +full_init_block @*/
 };
@@ -2415,7 +2084,7 @@ gnc_sql_load_guid( const GncSqlBackend* be, GncSqlRow* row )
 static GncSqlColumnTableEntry tx_guid_table[] =
 {
     /*@ -full_init_block @*/
-    { "tx_guid", CT_GUID, 0, 0, NULL, NULL, NULL, _retrieve_guid_ },
+    { "tx_guid", CT_GUID, 0, 0, NULL, _retrieve_guid_ },
     { NULL }
     /*@ +full_init_block @*/
 };
@@ -2434,6 +2103,23 @@ gnc_sql_load_tx_guid( const GncSqlBackend* be, GncSqlRow* row )
     return &guid;
 }
 
+/*@ null @*/ static QofSetterFunc
+get_setter( /*@ null @*/ QofIdTypeConst obj_name, const GncSqlColumnTableEntry* table_row )
+{
+    QofSetterFunc setter;
+
+    if ( (table_row->flags & COL_AUTOINC) != 0 )
+    {
+        setter = set_autoinc_id;
+    }
+    else
+    {
+        setter = table_row->setter;
+    }
+
+    return setter;
+}
+
 void
 gnc_sql_load_object( const GncSqlBackend* be, GncSqlRow* row,
                      /*@ null @*/ QofIdTypeConst obj_name, gpointer pObject,
@@ -2450,26 +2136,167 @@ gnc_sql_load_object( const GncSqlBackend* be, GncSqlRow* row,
 
     for ( table_row = table; table_row->col_name != NULL; table_row++ )
     {
-        if ( (table_row->flags & COL_AUTOINC) != 0 )
+        setter = get_setter( obj_name, table_row );
+        pHandler = get_handler( table_row );
+        g_assert( pHandler != NULL );
+        pHandler->load_fn( be, row, setter, pObject, table_row );
+    }
+}
+
+/* ================================================================= */
+/* Column index maps.
+ *
+ * For each entry of a column table, the map holds the entry's setter and
+ * column type handler, plus the result set indices of the entry's columns.
+ * If any column of an entry can't be resolved, or the handler has no
+ * load_at_index_fn, that entry is loaded by column name.
+ */
+struct GncSqlColumnIndexMap
+{
+    /*@ dependent @*/ const GncSqlColumnTableEntry* table;
+    guint num_entries;
+    QofSetterFunc* setters;
+    GncSqlColumnTypeHandler** handlers;
+    gint** col_indices;
+};
+
+/*@ null @*/ GncSqlColumnIndexMap*
+gnc_sql_result_map_columns( const GncSqlBackend* be, GncSqlResult* result,
+                            /*@ null @*/ QofIdTypeConst obj_name,
+                            const GncSqlColumnTableEntry* table )
+{
+    GncSqlColumnIndexMap* map;
+    const GncSqlColumnTableEntry* table_row;
+    guint i;
+
+    g_return_val_if_fail( be != NULL, NULL );
+    g_return_val_if_fail( result != NULL, NULL );
+    g_return_val_if_fail( table != NULL, NULL );
+
+    if ( result->getColIndex == NULL ) return NULL;
+
+    map = g_new0( GncSqlColumnIndexMap, 1 );
+    map->table = table;
+    for ( table_row = table; table_row->col_name != NULL; table_row++ )
+    {
+        map->num_entries++;
+    }
+    map->setters = g_new0( QofSetterFunc, map->num_entries );
+    map->handlers = g_new0( GncSqlColumnTypeHandler*, map->num_entries );
+    map->col_indices = g_new0( gint*, map->num_entries );
+
+    for ( i = 0, table_row = table; i < map->num_entries; i++, table_row++ )
+    {
+        GList* colnames = NULL;
+        GList* node;
+        gint* indices;
+        guint col;
+        gboolean resolved = TRUE;
+
+        map->setters[i] = get_setter( obj_name, table_row );
+        map->handlers[i] = get_handler( table_row );
+        g_assert( map->handlers[i] != NULL );
+        if ( map->handlers[i]->load_at_index_fn == NULL ) continue;
+
+        map->handlers[i]->add_colname_to_list_fn( table_row, &colnames );
+        indices = g_new( gint, g_list_length( colnames ) );
+        for ( col = 0, node = colnames; node != NULL; col++, node = node->next )
         {
-            setter = set_autoinc_id;
+            indices[col] = gnc_sql_result_get_col_index( result, (const gchar*)node->data );
+            if ( indices[col] < 0 )
+            {
+                resolved = FALSE;
+            }
+            g_free( node->data );
         }
-        else if ( table_row->qof_param_name != NULL )
+        g_list_free( colnames );
+
+        if ( resolved )
         {
-            g_assert( obj_name != NULL );
-            setter = qof_class_get_parameter_setter( obj_name,
-                     table_row->qof_param_name );
+            map->col_indices[i] = indices;
         }
         else
         {
-            setter = table_row->setter;
+            g_free( indices );
+        }
+    }
+
+    return map;
+}
+
+void
+gnc_sql_column_index_map_free( /*@ null @*//*@ only @*/ GncSqlColumnIndexMap* map )
+{
+    guint i;
+
+    if ( map == NULL ) return;
+
+    for ( i = 0; i < map->num_entries; i++ )
+    {
+        g_free( map->col_indices[i] );
+    }
+    g_free( map->col_indices );
+    g_free( map->handlers );
+    g_free( map->setters );
+    g_free( map );
+}
+
+void
+gnc_sql_load_object_mapped( const GncSqlBackend* be, GncSqlRow* row,
+                            /*@ null @*/ QofIdTypeConst obj_name, gpointer pObject,
+                            const GncSqlColumnTableEntry* table,
+                            /*@ null @*/ const GncSqlColumnIndexMap* map )
+{
+    guint i;
+
+    if ( map == NULL )
+    {
+        gnc_sql_load_object( be, row, obj_name, pObject, table );
+        return;
+    }
+
+    g_return_if_fail( be != NULL );
+    g_return_if_fail( row != NULL );
+    g_return_if_fail( pObject != NULL );
+    g_return_if_fail( map->table == table );
+
+    for ( i = 0; i < map->num_entries; i++ )
+    {
+        GncSqlColumnTypeHandler* pHandler = map->handlers[i];
+
+        if ( map->col_indices[i] != NULL )
+        {
+            pHandler->load_at_index_fn( be, row, map->setters[i], pObject,
+                                        &table[i], map->col_indices[i] );
+        }
+        else
+        {
+            pHandler->load_fn( be, row, map->setters[i], pObject, &table[i] );
         }
-        pHandler = get_handler( table_row );
-        g_assert( pHandler != NULL );
-        pHandler->load_fn( be, row, setter, pObject, table_row );
     }
 }
 
+/*@ null @*/ GncSqlColumnIndexMap*
+gnc_sql_result_map_guid( const GncSqlBackend* be, GncSqlResult* result )
+{
+    return gnc_sql_result_map_columns( be, result, NULL, guid_table );
+}
+
+/*@ null @*/
+const GncGUID*
+gnc_sql_load_guid_mapped( const GncSqlBackend* be, GncSqlRow* row,
+                          /*@ null @*/ const GncSqlColumnIndexMap* map )
+{
+    static GncGUID guid;
+
+    g_return_val_if_fail( be != NULL, NULL );
+    g_return_val_if_fail( row != NULL, NULL );
+
+    gnc_sql_load_object_mapped( be, row, NULL, &guid, guid_table, map );
+
+    return &guid;
+}
+
 /* ================================================================= */
 /*@ null @*/ GncSqlStatement*
 gnc_sql_create_select_statement( GncSqlBackend* be, const gchar* table_name )
@@ -2674,6 +2501,26 @@ gnc_sql_object_is_it_in_db( GncSqlBackend* be, const gchar* table_name,
     }
 }
 
+/* Executes a statement built for an object and disposes of it.  Returns the
+ * number of rows changed, or -1 on error. */
+static gint
+execute_object_statement( GncSqlBackend* be, /*@ null @*/ /*@ only @*/ GncSqlStatement* stmt )
+{
+    gint result;
+
+    if ( stmt == NULL ) return -1;
+
+    result = gnc_sql_connection_execute_nonselect_statement( be->conn, stmt );
+    if ( result == -1 )
+    {
+        PERR( "SQL error: %s\n", gnc_sql_statement_to_sql( stmt ) );
+        qof_backend_set_error( &be->be, ERR_BACKEND_SERVER_ERR );
+    }
+    gnc_sql_statement_dispose( stmt );
+
+    return result;
+}
+
 gboolean
 gnc_sql_do_db_operation( GncSqlBackend* be,
                          E_DB_OPERATION op,
@@ -2682,7 +2529,7 @@ gnc_sql_do_db_operation( GncSqlBackend* be,
                          const GncSqlColumnTableEntry* table )
 {
     GncSqlStatement* stmt = NULL;
-    gboolean ok = FALSE;
+    gint result;
 
     g_return_val_if_fail( be != NULL, FALSE );
     g_return_val_if_fail( table_name != NULL, FALSE );
@@ -2692,7 +2539,8 @@ gnc_sql_do_db_operation( GncSqlBackend* be,
 
     if ( op == OP_DB_INSERT )
     {
-        stmt = build_insert_statement( be, table_name, obj_name, pObject, table );
+        stmt = build_insert_statement( be, table_name, obj_name, pObject, table,
+                                       INSERT_PLAIN );
     }
     else if ( op == OP_DB_UPDATE )
     {
@@ -2702,28 +2550,61 @@ gnc_sql_do_db_operation( GncSqlBackend* be,
     {
         stmt = build_delete_statement( be, table_name, obj_name, pObject, table );
     }
+    else if ( op == OP_DB_UPSERT )
+    {
+        if ( be->conn->upsertClause == NULL )
+        {
+            /* Most commits are of existing objects, so try the UPDATE first
+             * and only INSERT if it didn't find the row. */
+            stmt = build_update_statement( be, table_name, obj_name, pObject, table );
+            result = execute_object_statement( be, stmt );
+            if ( result != 0 ) return ( result > 0 );
+            stmt = build_insert_statement( be, table_name, obj_name, pObject, table,
+                                           INSERT_PLAIN );
+        }
+        else
+        {
+            stmt = build_insert_statement( be, table_name, obj_name, pObject, table,
+                                           INSERT_OR_UPDATE );
+        }
+    }
     else
     {
         g_assert( FALSE );
     }
-    if ( stmt != NULL )
-    {
-        gint result;
 
-        result = gnc_sql_connection_execute_nonselect_statement( be->conn, stmt );
-        if ( result == -1 )
-        {
-            PERR( "SQL error: %s\n", gnc_sql_statement_to_sql( stmt ) );
-            qof_backend_set_error( &be->be, ERR_BACKEND_SERVER_ERR );
-        }
-        else
+    return ( execute_object_statement( be, stmt ) != -1 );
+}
+
+gint
+gnc_sql_insert_if_absent( GncSqlBackend* be, const gchar* table_name,
+                          QofIdTypeConst obj_name, gpointer pObject,
+                          const GncSqlColumnTableEntry* table )
+{
+    GncSqlStatement* stmt;
+
+    g_return_val_if_fail( be != NULL, -1 );
+    g_return_val_if_fail( table_name != NULL, -1 );
+    g_return_val_if_fail( obj_name != NULL, -1 );
+    g_return_val_if_fail( pObject != NULL, -1 );
+    g_return_val_if_fail( table != NULL, -1 );
+
+    if ( be->conn->upsertClause == NULL )
+    {
+        if ( gnc_sql_object_is_it_in_db( be, table_name, obj_name, pObject, table ) )
         {
-            ok = TRUE;
+            return 0;
         }
-        gnc_sql_statement_dispose( stmt );
+        stmt = build_insert_statement( be, table_name, obj_name, pObject, table,
+                                       INSERT_PLAIN );
+    }
+    else
+    {
+        stmt = build_insert_statement( be, table_name, obj_name, pObject, table,
+                                       INSERT_OR_IGNORE );
     }
 
-    return ok;
+    return execute_object_statement( be, stmt );
 }
 
 static GSList*
@@ -2838,7 +2719,8 @@ free_gvalue_list( GSList* list )
 build_insert_statement( GncSqlBackend* be,
                         const gchar* table_name,
                         QofIdTypeConst obj_name, gpointer pObject,
-                        const GncSqlColumnTableEntry* table )
+                        const GncSqlColumnTableEntry* table,
+                        insert_conflict_t conflict )
 {
     GncSqlStatement* stmt;
     GString* sql;
@@ -2847,6 +2729,7 @@ build_insert_statement( GncSqlBackend* be,
     gchar* sqlbuf;
     GList* colnames = NULL;
     GList* colname;
+    gchar* conflict_clause = NULL;
     const GncSqlColumnTableEntry* table_row;
 
     g_return_val_if_fail( be != NULL, NULL );
@@ -2854,6 +2737,7 @@ build_insert_statement( GncSqlBackend* be,
     g_return_val_if_fail( obj_name != NULL, NULL );
     g_return_val_if_fail( pObject != NULL, NULL );
     g_return_val_if_fail( table != NULL, NULL );
+    g_return_val_if_fail( conflict == INSERT_PLAIN || be->conn->upsertClause != NULL, NULL );
 
     sqlbuf = g_strdup_printf( "INSERT INTO %s(", table_name );
     sql = g_string_new( sqlbuf );
@@ -2874,6 +2758,12 @@ build_insert_statement( GncSqlBackend* be,
     }
     g_assert( colnames != NULL );
 
+    if ( conflict != INSERT_PLAIN )
+    {
+        conflict_clause = gnc_sql_connection_upsert_clause( be->conn, table[0].col_name,
+                          colnames, conflict == INSERT_OR_UPDATE );
+    }
+
     for ( colname = colnames; colname != NULL; colname = colname->next )
     {
         if ( colname != colnames )
@@ -2902,6 +2792,11 @@ build_insert_statement( GncSqlBackend* be,
     }
     free_gvalue_list( values );
     (void)g_string_append( sql, ")" );
+    if ( conflict_clause != NULL )
+    {
+        (void)g_string_append( sql, conflict_clause );
+        g_free( conflict_clause );
+    }
 
     stmt = gnc_sql_connection_create_statement_from_sql( be->conn, sql->str );
     (void)g_string_free( sql, TRUE );
@@ -3034,13 +2929,13 @@ gnc_sql_commit_standard_item( GncSqlBackend* be, QofInstance* inst, const gchar*
     {
         op = OP_DB_DELETE;
     }
-    else if ( be->is_pristine_db || is_infant )
+    else if ( be->is_pristine_db )
     {
         op = OP_DB_INSERT;
     }
     else
     {
-        op = OP_DB_UPDATE;
+        op = OP_DB_UPSERT;
     }
     is_ok = gnc_sql_do_db_operation( be, op, tableName, obj_name, inst, col_table );
 
@@ -45,6 +45,21 @@
 
 struct GncSqlConnection;
 
+/** Access function for a column value.  Real getters are of the form
+ *
+ *        value_type getter (object_type *self);
+ *
+ *  and are cast to this type in the column tables.  The column type
+ *  handler casts them back to the form it needs.
+ */
+typedef gpointer (*QofAccessFunc)( gpointer object, /*@ null @*/ gpointer param );
+
+/** Setter function for a column value.  Real setters are of the form
+ *
+ *        void setter (object_type *self, value_type value);
+ */
+typedef void (*QofSetterFunc)( gpointer object, /*@ null @*/ gpointer value );
+
 /**
  * @struct GncSqlBackend
  *
@@ -63,6 +78,10 @@ struct GncSqlBackend
     int operations_done;			/**< Number of operations (save/load) done */
     GHashTable* versions;			/**< Version number for each table */
     const char* timespec_format;	/**< Format string for SQL for timespec values */
+    int tx_load_window;			/**< Days of transactions to load initially (0 = all) */
+    gboolean tx_partially_loaded;	/**< Older transactions are still in the db only */
+    Timespec tx_loaded_from;		/**< Transactions posted from here on are loaded */
+    GHashTable* stored_slots;		/**< Object guid -> digest of the slots last read from or written to the db */
 };
 
 /**
@@ -80,6 +99,17 @@ void gnc_sql_init( GncSqlBackend* be );
  */
 void gnc_sql_load( GncSqlBackend* be, /*@ dependent @*/ QofBook *book, QofBackendLoadType loadType );
 
+/**
+ * Makes sure that all transactions posted on or after a date are loaded.
+ * Only does any work after a partial initial load (tx_load_window != 0).
+ * The starting balances of the accounts are reduced by the splits which
+ * are brought in so that the ending balances don't change.
+ *
+ * @param be SQL backend
+ * @param since Earliest post date which needs to be in memory
+ */
+void gnc_sql_load_since( GncSqlBackend* be, Timespec since );
+
 /**
  * Save the contents of a book to an SQL database.
  *
@@ -115,6 +145,7 @@ void gnc_sql_commit_edit( GncSqlBackend* qbe, QofInstance *inst );
 /**
  */
 struct GncSqlColumnTableEntry;
+struct GncSqlColumnIndexMap;
 struct GncSqlStatement;
 struct GncSqlResult;
 struct GncSqlRow;
@@ -159,6 +190,14 @@ struct GncSqlConnection
     gboolean (*createIndex)( GncSqlConnection*, const char*, const char*, const GncSqlColumnTableEntry* ); /**< Returns TRUE if successful, FALSE if error */
     gboolean (*addColumnsToTable)( GncSqlConnection*, const char* table, GList* ); /**< Returns TRUE if successful, FALSE if error */
     char* (*quoteString)( const GncSqlConnection*, char* );
+    /* Optional.  Returns the clause which, appended to an INSERT, makes a
+     * row whose key column already exists either update the listed columns
+     * (update == TRUE) or leave the row alone (update == FALSE).  Backends
+     * whose engine has no such clause leave this NULL, and the generic code
+     * falls back to UPDATE-then-INSERT, relying on executeNonSelectStatement
+     * returning the number of rows matched. */
+    /*@ null @*/
+    char* (*upsertClause)( const GncSqlConnection*, const char* key_col, GList* col_names, gboolean update );
 };
 #define gnc_sql_connection_dispose(CONN) (CONN)->dispose(CONN)
 #define gnc_sql_connection_execute_select_statement(CONN,STMT) \
@@ -183,6 +222,8 @@ struct GncSqlConnection
 		(CONN)->addColumnsToTable(CONN,TABLENAME,COLLIST)
 #define gnc_sql_connection_quote_string(CONN,STR) \
 		(CONN)->quoteString(CONN,STR)
+#define gnc_sql_connection_upsert_clause(CONN,KEY,COLS,UPDATE) \
+		(CONN)->upsertClause(CONN,KEY,COLS,UPDATE)
 
 /**
  * @struct GncSqlRow
@@ -194,11 +235,28 @@ struct GncSqlRow
 {
     const GValue* (*getValueAtColName)( GncSqlRow*, const char* );
     void (*dispose)( /*@ only @*/ GncSqlRow* );
+    /* Index based accessors.  These are optional, but a backend which
+     * provides GncSqlResult::getColIndex must provide all of them.  Column
+     * indices are those returned by getColIndex for the row's result. */
+    /*@ null @*/
+    const GValue* (*getValueAtColIndex)( GncSqlRow*, int ); /**< Returns NULL if the value is NULL */
+    gboolean (*getInt64AtColIndex)( GncSqlRow*, int, gint64* ); /**< Returns FALSE if the value is NULL */
+    /*@ null @*//*@ dependent @*/
+    const char* (*getStringAtColIndex)( GncSqlRow*, int ); /**< Valid until the next row is fetched; NULL if the value is NULL */
+    gboolean (*getGuidAtColIndex)( GncSqlRow*, int, GncGUID* ); /**< Returns FALSE if the value is NULL or not a guid */
 };
 #define gnc_sql_row_get_value_at_col_name(ROW,N) \
 		(ROW)->getValueAtColName(ROW,N)
 #define gnc_sql_row_dispose(ROW) \
 		(ROW)->dispose(ROW)
+#define gnc_sql_row_get_value_at_col_index(ROW,I) \
+		(ROW)->getValueAtColIndex(ROW,I)
+#define gnc_sql_row_get_int64_at_col_index(ROW,I,PVAL) \
+		(ROW)->getInt64AtColIndex(ROW,I,PVAL)
+#define gnc_sql_row_get_string_at_col_index(ROW,I) \
+		(ROW)->getStringAtColIndex(ROW,I)
+#define gnc_sql_row_get_guid_at_col_index(ROW,I,PGUID) \
+		(ROW)->getGuidAtColIndex(ROW,I,PGUID)
 
 /**
  * @struct GncSqlResult
@@ -212,6 +270,8 @@ struct GncSqlResult
     GncSqlRow* (*getFirstRow)( GncSqlResult* );
     GncSqlRow* (*getNextRow)( GncSqlResult* );
     void (*dispose)( /*@ only @*/ GncSqlResult* );
+    /*@ null @*/
+    int (*getColIndex)( GncSqlResult*, const char* ); /**< Optional.  Returns -1 if there is no such column */
 };
 #define gnc_sql_result_get_num_rows(RESULT) \
 		(RESULT)->getNumRows(RESULT)
@@ -221,6 +281,8 @@ struct GncSqlResult
 		(RESULT)->getNextRow(RESULT)
 #define gnc_sql_result_dispose(RESULT) \
 		(RESULT)->dispose(RESULT)
+#define gnc_sql_result_get_col_index(RESULT,N) \
+		(RESULT)->getColIndex(RESULT,N)
 
 /**
  * @struct GncSqlObjectBackend
@@ -231,9 +293,6 @@ struct GncSqlResult
  * commit()			- commit an object to the db
  * initial_load()	- load stuff when new db opened
  * create_tables()  - create any db tables
- * compile_query()  - compile a backend object query
- * run_query()      - run a compiled query
- * free_query()     - free a compiled query
  * write()          - write all objects
  */
 struct GncSqlObjectBackend
@@ -251,15 +310,6 @@ struct GncSqlObjectBackend
     /** Create database tables for this object */
     /*@ null @*/
     void		(*create_tables)( GncSqlBackend* be );
-    /** Compile a query on these objects */
-    /*@ null @*/
-    void*	(*compile_query)( GncSqlBackend* be, QofQuery* pQuery );
-    /** Run a query on these objects */
-    /*@ null @*/
-    void		(*run_query)( GncSqlBackend* be, void* pQuery );
-    /** Free a query on these objects */
-    /*@ null @*/
-    void		(*free_query)( GncSqlBackend* be, void* pQuery );
     /** Write all objects of this type to the database
      * @return TRUE if successful, FALSE if error
      */
@@ -322,13 +372,9 @@ struct GncSqlColumnInfo
  * required to copy information between an object and the database for a
  * specific object property.
  *
- * If an entry contains a gobj_param_name value, this string is used as the
- * property name for a call to g_object_get() or g_object_set().  If the
- * gobj_param_name value is NULL but qof_param_name is not NULL, this value
- * is used as the parameter name for a call to
- * qof_class_get_parameter_getter().  If both of these values are NULL, getter
- * and setter are the addresses of routines to return or set the parameter
- * value, respectively.
+ * getter and setter are the addresses of routines to return or set the
+ * parameter value, respectively.  Either may be NULL if the column is
+ * only loaded or only saved.
  *
  * The database description for an object consists of an array of
  * GncSqlColumnTableEntry objects, with a final member having col_name == NULL.
@@ -344,10 +390,6 @@ struct GncSqlColumnTableEntry
 #define COL_AUTOINC	0x08	/**< The column is an auto-incrementing int */
     int flags;				/**< Column flags */
     /*@ null @*/
-    const char* gobj_param_name; /**< If non-null, g_object param name */
-    /*@ null @*/
-    const char* qof_param_name;  /**< If non-null, qof parameter name */
-    /*@ null @*/
     QofAccessFunc getter;	/**< General access function */
     /*@ null @*/
     QofSetterFunc setter;	/**< General setter function */
@@ -357,13 +399,19 @@ enum E_DB_OPERATION
 {
     OP_DB_INSERT,
     OP_DB_UPDATE,
-    OP_DB_DELETE
+    OP_DB_DELETE,
+    OP_DB_UPSERT    /**< Insert, or update the row with the same key */
 };
 
 typedef void (*GNC_SQL_LOAD_FN)( const GncSqlBackend* be,
                                  GncSqlRow* row,
                                  /*@ null @*/ QofSetterFunc setter, void* pObject,
                                  const GncSqlColumnTableEntry* table );
+typedef void (*GNC_SQL_LOAD_AT_INDEX_FN)( const GncSqlBackend* be,
+        GncSqlRow* row,
+        /*@ null @*/ QofSetterFunc setter, void* pObject,
+        const GncSqlColumnTableEntry* table,
+        const int* col_indices );
 typedef void (*GNC_SQL_ADD_COL_INFO_TO_LIST_FN)( const GncSqlBackend* be,
         const GncSqlColumnTableEntry* table_row,
         GList** pList );
@@ -402,6 +450,14 @@ struct GncSqlColumnTypeHandler
      * Routine to add a GValue for the property to a GSList.
      */
     GNC_SQL_ADD_GVALUE_TO_SLIST_FN	add_gvalue_to_slist_fn;
+
+    /**
+     * Optional routine to load a value into an object from the database row
+     * using pre-resolved column indices.  col_indices holds one index for
+     * each column name added by add_colname_to_list_fn, in the same order.
+     */
+    /*@ null @*/
+    GNC_SQL_LOAD_AT_INDEX_FN        load_at_index_fn;
 };
 
 /**
@@ -497,6 +553,65 @@ void gnc_sql_load_object( const GncSqlBackend* be, GncSqlRow* row,
                           /*@ null @*/ QofIdTypeConst obj_name, void * pObject,
                           const GncSqlColumnTableEntry* table );
 
+/**
+ * Resolves the columns of a DB table description to their indices in a
+ * result set, along with the setter and column type handler of each entry.
+ * This is done once per result set so that rows can be loaded without any
+ * per-column name lookups.
+ *
+ * @param be SQL backend struct
+ * @param result DB result
+ * @param obj_name QOF object type name
+ * @param table DB table description
+ * @return Column index map, or NULL if the backend doesn't support index
+ * access, in which case objects are loaded by column name.
+ */
+/*@ null @*/
+GncSqlColumnIndexMap* gnc_sql_result_map_columns( const GncSqlBackend* be,
+        GncSqlResult* result,
+        /*@ null @*/ QofIdTypeConst obj_name,
+        const GncSqlColumnTableEntry* table );
+
+/**
+ * Frees a column index map.
+ *
+ * @param map Column index map, may be NULL
+ */
+void gnc_sql_column_index_map_free( /*@ null @*//*@ only @*/ GncSqlColumnIndexMap* map );
+
+/**
+ * Loads a Gnucash object from the database using a column index map
+ * previously resolved for the row's result set.
+ *
+ * @param be SQL backend struct
+ * @param row DB result row
+ * @param obj_name QOF object type name
+ * @param pObject Object to be loaded
+ * @param table DB table description
+ * @param map Column index map for table, or NULL to load by column name
+ */
+void gnc_sql_load_object_mapped( const GncSqlBackend* be, GncSqlRow* row,
+                                 /*@ null @*/ QofIdTypeConst obj_name, void * pObject,
+                                 const GncSqlColumnTableEntry* table,
+                                 /*@ null @*/ const GncSqlColumnIndexMap* map );
+
+/**
+ * Inserts an object unless a row with the same key is already in the
+ * database.  With a connection which provides upsertClause this is a single
+ * statement, otherwise the row is looked up first.
+ *
+ * @param be SQL backend struct
+ * @param table_name DB table name
+ * @param obj_name QOF object type name
+ * @param pObject Object to be inserted
+ * @param table DB table description
+ * @return 1 if the object was inserted, 0 if it was already there, -1 on error
+ */
+gint gnc_sql_insert_if_absent( GncSqlBackend* be,
+                               const char* table_name,
+                               QofIdTypeConst obj_name, void * pObject,
+                               const GncSqlColumnTableEntry* table );
+
 /**
  * Checks whether an object is in the database or not.
  *
@@ -509,7 +624,7 @@ void gnc_sql_load_object( const GncSqlBackend* be, GncSqlRow* row,
  */
 gboolean gnc_sql_object_is_it_in_db( GncSqlBackend* be,
                                      const char* table_name,
-                                     QofIdTypeConst obj_name, const void * pObject,
+                                     QofIdTypeConst obj_name, gpointer pObject,
                                      const GncSqlColumnTableEntry* table );
 
 /**
@@ -575,6 +690,28 @@ gboolean gnc_sql_create_index( const GncSqlBackend* be, const char* index_name,
 /*@ dependent @*//*@ null @*/
 const GncGUID* gnc_sql_load_guid( const GncSqlBackend* be, GncSqlRow* row );
 
+/**
+ * Resolves the guid column of a result set, for gnc_sql_load_guid_mapped().
+ *
+ * @param be SQL backend struct
+ * @param result DB result
+ * @return Column index map, or NULL if the backend doesn't support index access
+ */
+/*@ null @*/
+GncSqlColumnIndexMap* gnc_sql_result_map_guid( const GncSqlBackend* be, GncSqlResult* result );
+
+/**
+ * Loads the object guid from a database row using a column index map
+ * returned by gnc_sql_result_map_guid().
+ *
+ * @param be SQL backend struct
+ * @param row Database row
+ * @param map Guid column index map, or NULL to load by column name
+ */
+/*@ dependent @*//*@ null @*/
+const GncGUID* gnc_sql_load_guid_mapped( const GncSqlBackend* be, GncSqlRow* row,
+        /*@ null @*/ const GncSqlColumnIndexMap* map );
+
 /**
  * Loads the transaction guid from a database row.  The table must have a column
  * named "tx_guid" with type CT_GUID.
@@ -740,11 +877,6 @@ void gnc_sql_set_load_order( const char** load_order );
 
 void _retrieve_guid_( void * pObject, /*@ null @*/ void * pValue );
 
-/*@ null @*/
-void * gnc_sql_compile_query( QofBackend* pBEnd, QofQuery* pQuery );
-void gnc_sql_free_query( QofBackend* pBEnd, void * pQuery );
-void gnc_sql_run_query( QofBackend* pBEnd, void * pQuery );
-
 struct write_objects_t
 {
     /*@ dependent @*/ GncSqlBackend* be;
@@ -51,7 +51,7 @@ static QofLogModule log_module = G_LOG_DOMAIN;
 #define MAX_DESCRIPTION_LEN 2048
 #define MAX_TYPE_LEN 2048
 
-static void set_invisible( gpointer data, gboolean value );
+static void set_invisible( gpointer data, bool value );
 static gpointer bt_get_parent( gpointer data );
 static void bt_set_parent( gpointer data, gpointer value );
 static void bt_set_parent_guid( gpointer data, gpointer value );
@@ -61,38 +61,62 @@ static void bt_set_parent_guid( gpointer data, gpointer value );
 
 static GncSqlColumnTableEntry col_table[] =
 {
-    { "guid",         CT_GUID,        0,                   COL_NNUL | COL_PKEY, "guid" },
-    { "name",         CT_STRING,      MAX_NAME_LEN,        COL_NNUL,          "name" },
-    { "description",  CT_STRING,      MAX_DESCRIPTION_LEN, COL_NNUL,          NULL, GNC_BILLTERM_DESC },
     {
-        "refcount",     CT_INT,         0,                   COL_NNUL,          NULL, NULL,
+        "guid", CT_GUID, 0, COL_NNUL | COL_PKEY,
+        (QofAccessFunc)qof_instance_get_guid, (QofSetterFunc)qof_instance_set_guid
+    },
+    {
+        "name", CT_STRING, MAX_NAME_LEN, COL_NNUL,
+        (QofAccessFunc)gncBillTermGetName, (QofSetterFunc)gncBillTermSetName
+    },
+    {
+        "description", CT_STRING, MAX_DESCRIPTION_LEN, COL_NNUL,
+        (QofAccessFunc)gncBillTermGetDescription, (QofSetterFunc)gncBillTermSetDescription
+    },
+    {
+        "refcount",     CT_INT,         0,                   COL_NNUL,
         (QofAccessFunc)gncBillTermGetRefcount,  (QofSetterFunc)gncBillTermSetRefcount
     },
     {
-        "invisible",    CT_BOOLEAN,     0,                   COL_NNUL,          NULL, NULL,
+        "invisible",    CT_BOOLEAN,     0,                   COL_NNUL,
         (QofAccessFunc)gncBillTermGetInvisible, (QofSetterFunc)set_invisible
     },
     {
-        "parent",       CT_GUID,       0,                   0,                 NULL, NULL,
+        "parent",       CT_GUID,       0,                   0,
         (QofAccessFunc)bt_get_parent,    (QofSetterFunc)bt_set_parent
     },
 #if 0
     {
-        "child",        CT_BILLTERMREF, 0,                   0,                 NULL, NULL,
+        "child",        CT_BILLTERMREF, 0,                   0,
         (QofAccessFunc)gncBillTermReturnChild,  (QofSetterFunc)gncBillTermSetChild
     },
 #endif
-    { "type",         CT_STRING,      MAX_TYPE_LEN,        COL_NNUL,          NULL, GNC_BILLTERM_TYPE },
-    { "duedays",      CT_INT,         0,                   0,                 0,    GNC_BILLTERM_DUEDAYS },
-    { "discountdays", CT_INT,         0,                   0,                 0,    GNC_BILLTERM_DISCDAYS },
-    { "discount",     CT_NUMERIC,     0,                   0,                 0,    GNC_BILLTERM_DISCOUNT },
-    { "cutoff",       CT_INT,         0,                   0,                 0,    GNC_BILLTERM_CUTOFF },
+    {
+        "type", CT_STRING, MAX_TYPE_LEN, COL_NNUL,
+        (QofAccessFunc)qofBillTermGetType, (QofSetterFunc)qofBillTermSetType
+    },
+    {
+        "duedays", CT_INT, 0, 0,
+        (QofAccessFunc)gncBillTermGetDueDays, (QofSetterFunc)gncBillTermSetDueDays
+    },
+    {
+        "discountdays", CT_INT, 0, 0,
+        (QofAccessFunc)gncBillTermGetDiscountDays, (QofSetterFunc)gncBillTermSetDiscountDays
+    },
+    {
+        "discount", CT_NUMERIC, 0, 0,
+        (QofAccessFunc)gncBillTermGetDiscount, (QofSetterFunc)gncBillTermSetDiscount
+    },
+    {
+        "cutoff", CT_INT, 0, 0,
+        (QofAccessFunc)gncBillTermGetCutoff, (QofSetterFunc)gncBillTermSetCutoff
+    },
     { NULL }
 };
 
 static GncSqlColumnTableEntry billterm_parent_col_table[] =
 {
-    { "parent", CT_GUID, 0, 0, NULL, NULL, NULL, (QofSetterFunc)bt_set_parent_guid },
+    { "parent", CT_GUID, 0, 0, NULL, (QofSetterFunc)bt_set_parent_guid },
     { NULL }
 };
 
@@ -104,7 +128,7 @@ typedef struct
 } billterm_parent_guid_struct;
 
 static void
-set_invisible( gpointer data, gboolean value )
+set_invisible( gpointer data, bool value )
 {
     GncBillTerm* term = reinterpret_cast<GncBillTerm*>(data);
 
@@ -117,7 +141,7 @@ set_invisible( gpointer data, gboolean value )
 }
 
 static /*@ null @*//*@ dependent @*/ gpointer
-bt_get_parent( QofInstance* pObject )
+bt_get_parent( gpointer pObject )
 {
     const GncBillTerm* billterm;
     const GncBillTerm* pParent;
@@ -126,8 +150,7 @@ bt_get_parent( QofInstance* pObject )
     g_return_val_if_fail( pObject != NULL, NULL );
 //    g_return_val_if_fail( GNC_IS_BILLTERM(pObject), NULL );
 
-    billterm = dynamic_cast<GncBillTerm*>(pObject);
-    g_return_val_if_fail( billterm, NULL );
+    billterm = (GncBillTerm*)(pObject);
     pParent = gncBillTermGetParent( billterm );
     if ( pParent == NULL )
     {
@@ -142,7 +165,7 @@ bt_get_parent( QofInstance* pObject )
 }
 
 static void
-bt_set_parent( QofInstance* data, gpointer value )
+bt_set_parent( gpointer data, gpointer value )
 {
     GncBillTerm* billterm;
     GncBillTerm* parent;
@@ -152,8 +175,7 @@ bt_set_parent( QofInstance* data, gpointer value )
     g_return_if_fail( data != NULL );
 //    g_return_if_fail( GNC_IS_BILLTERM(data) );
 
-    billterm = dynamic_cast<GncBillTerm*>(data);
-    g_return_if_fail( billterm );
+    billterm = (GncBillTerm*)(data);
     pBook = qof_instance_get_book( QOF_INSTANCE(billterm) );
     if ( guid != NULL )
     {
@@ -370,14 +392,7 @@ load_billterm_guid( const GncSqlBackend* be, GncSqlRow* row,
         term = gncBillTermLookup( be->book, &guid );
         if ( term != NULL )
         {
-            if ( table_row->gobj_param_name != NULL )
-            {
-                g_object_set( pObject, table_row->gobj_param_name, term, NULL );
-            }
-            else
-            {
-                (*setter)( pObject, (const gpointer)term );
-            }
+            (*setter)( pObject, (const gpointer)term );
         }
         else
         {
@@ -403,7 +418,6 @@ gnc_billterm_sql_initialize( void )
         gnc_sql_save_billterm,				/* commit */
         load_all_billterms,					/* initial_load */
         create_billterm_tables,				/* create_tables */
-        NULL, NULL, NULL,
         write_billterms						/* write */
     };
 
@@ -58,13 +58,16 @@ static void set_root_template_guid( gpointer pObject, /*@ null @*/ gpointer pVal
 static const GncSqlColumnTableEntry col_table[] =
 {
     /*@ -full_init_block @*/
-    { "guid",               CT_GUID, 0, COL_NNUL | COL_PKEY, "guid" },
     {
-        "root_account_guid",  CT_GUID, 0, COL_NNUL,          NULL, NULL,
+        "guid", CT_GUID, 0, COL_NNUL | COL_PKEY,
+        (QofAccessFunc)qof_instance_get_guid, (QofSetterFunc)qof_instance_set_guid
+    },
+    {
+        "root_account_guid",  CT_GUID, 0, COL_NNUL,
         (QofAccessFunc)get_root_account_guid,  set_root_account_guid
     },
     {
-        "root_template_guid", CT_GUID, 0, COL_NNUL,          NULL, NULL,
+        "root_template_guid", CT_GUID, 0, COL_NNUL,
         (QofAccessFunc)get_root_template_guid, set_root_template_guid
     },
     { NULL }
@@ -75,11 +78,10 @@ static const GncSqlColumnTableEntry col_table[] =
 static /*@ dependent @*//*@ null @*/ gpointer
 get_root_account_guid( gpointer pObject )
 {
-    QofBook* book = QOF_BOOK(pObject);
+    QofBook* book = (QofBook*)pObject;
     const Account* root;
 
     g_return_val_if_fail( pObject != NULL, NULL );
-    g_return_val_if_fail( QOF_IS_BOOK(pObject), NULL );
 
     root = gnc_book_get_root_account( book );
     return (gpointer)qof_instance_get_guid( QOF_INSTANCE(root) );
@@ -88,12 +90,11 @@ get_root_account_guid( gpointer pObject )
 static void
 set_root_account_guid( gpointer pObject, /*@ null @*/ gpointer pValue )
 {
-    QofBook* book = QOF_BOOK(pObject);
+    QofBook* book = (QofBook*)pObject;
     const Account* root;
     GncGUID* guid = (GncGUID*)pValue;
 
     g_return_if_fail( pObject != NULL );
-    g_return_if_fail( QOF_IS_BOOK(pObject) );
     g_return_if_fail( pValue != NULL );
 
     root = gnc_book_get_root_account( book );
@@ -103,11 +104,10 @@ set_root_account_guid( gpointer pObject, /*@ null @*/ gpointer pValue )
 static /*@ dependent @*//*@ null @*/ gpointer
 get_root_template_guid( gpointer pObject )
 {
-    const QofBook* book = QOF_BOOK(pObject);
+    const QofBook* book = (QofBook*)pObject;
     const Account* root;
 
     g_return_val_if_fail( pObject != NULL, NULL );
-    g_return_val_if_fail( QOF_IS_BOOK(pObject), NULL );
 
     root = gnc_book_get_template_root( book );
     return (gpointer)qof_instance_get_guid( QOF_INSTANCE(root) );
@@ -116,12 +116,11 @@ get_root_template_guid( gpointer pObject )
 static void
 set_root_template_guid( gpointer pObject, /*@ null @*/ gpointer pValue )
 {
-    QofBook* book = QOF_BOOK(pObject);
+    QofBook* book = (QofBook*)pObject;
     GncGUID* guid = (GncGUID*)pValue;
     Account* root;
 
     g_return_if_fail( pObject != NULL );
-    g_return_if_fail( QOF_IS_BOOK(pObject) );
     g_return_if_fail( pValue != NULL );
 
     root = gnc_book_get_template_root( book );
@@ -217,7 +216,7 @@ gnc_sql_save_book( GncSqlBackend* be, QofInstance* inst)
 
     g_return_val_if_fail( be != NULL, FALSE );
     g_return_val_if_fail( inst != NULL, FALSE );
-    g_return_val_if_fail( QOF_IS_BOOK(inst), FALSE );
+    g_return_val_if_fail( QOF_CHECK_TYPE(inst, GNC_ID_BOOK), FALSE );
 
     status = gnc_sql_commit_standard_item( be, inst, BOOK_TABLE, GNC_ID_BOOK, col_table );
 
@@ -235,9 +234,6 @@ gnc_sql_init_book_handler( void )
         gnc_sql_save_book,      /* commit */
         load_all_books,         /* initial_load */
         create_book_tables,		/* create_tables */
-        NULL,                   /* compile_query */
-        NULL,                   /* run_query */
-        NULL,                   /* free_query */
         NULL                    /* write */
     };
 
@@ -35,6 +35,7 @@
 #include "gnc-backend-sql.h"
 
 #include "Recurrence.h"
+#include "AccountP.h"
 
 #include "gnc-budget-sql.h"
 #include "gnc-slots-sql.h"
@@ -59,10 +60,22 @@
 static const GncSqlColumnTableEntry col_table[] =
 {
     /*@ -full_init_block @*/
-    { "guid",        CT_GUID,   0,                          COL_NNUL | COL_PKEY, "guid" },
-    { "name",        CT_STRING, BUDGET_MAX_NAME_LEN,        COL_NNUL,          "name" },
-    { "description", CT_STRING, BUDGET_MAX_DESCRIPTION_LEN, 0,                 "description" },
-    { "num_periods", CT_INT,    0,                          COL_NNUL,          "num_periods" },
+    {
+        "guid", CT_GUID, 0, COL_NNUL | COL_PKEY,
+        (QofAccessFunc)qof_instance_get_guid, (QofSetterFunc)qof_instance_set_guid
+    },
+    {
+        "name", CT_STRING, BUDGET_MAX_NAME_LEN, COL_NNUL,
+        (QofAccessFunc)gnc_budget_get_name, (QofSetterFunc)gnc_budget_set_name
+    },
+    {
+        "description", CT_STRING, BUDGET_MAX_DESCRIPTION_LEN, 0,
+        (QofAccessFunc)gnc_budget_get_description, (QofSetterFunc)gnc_budget_set_description
+    },
+    {
+        "num_periods", CT_INT, 0, COL_NNUL,
+        (QofAccessFunc)gnc_budget_get_num_periods, (QofSetterFunc)gnc_budget_set_num_periods
+    },
     { NULL }
     /*@ +full_init_block @*/
 };
@@ -88,19 +101,19 @@ static const GncSqlColumnTableEntry budget_amounts_col_table[] =
     /*@ -full_init_block @*/
     { "id",           CT_INT,        0, COL_NNUL | COL_PKEY | COL_AUTOINC },
     {
-        "budget_guid",  CT_BUDGETREF,  0, COL_NNUL,                     NULL, NULL,
+        "budget_guid",  CT_BUDGETREF,  0, COL_NNUL,
         (QofAccessFunc)get_budget, (QofSetterFunc)set_budget
     },
     {
-        "account_guid", CT_ACCOUNTREF, 0, COL_NNUL,                     NULL, NULL,
+        "account_guid", CT_ACCOUNTREF, 0, COL_NNUL,
         (QofAccessFunc)get_account, (QofSetterFunc)set_account
     },
     {
-        "period_num",   CT_INT,        0, COL_NNUL,                     NULL, NULL,
+        "period_num",   CT_INT,        0, COL_NNUL,
         (QofAccessFunc)get_period_num, (QofSetterFunc)set_period_num
     },
     {
-        "amount",       CT_NUMERIC,    0, COL_NNUL,                     NULL, NULL,
+        "amount",       CT_NUMERIC,    0, COL_NNUL,
         (QofAccessFunc)get_amount, (QofSetterFunc)set_amount
     },
     { NULL }
@@ -258,9 +271,8 @@ delete_budget_amounts( GncSqlBackend* be, GncBudget* budget )
 static gboolean
 save_budget_amounts( GncSqlBackend* be, GncBudget* budget )
 {
-    GList* descendants;
-    /*@ dependent @*/
-    GList* node;
+    AccountList_t descendants;
+    AccountList_t::iterator node;
     budget_amount_info_t info;
     guint num_periods;
     gboolean is_ok = TRUE;;
@@ -274,11 +286,11 @@ save_budget_amounts( GncSqlBackend* be, GncBudget* budget )
     info.budget = budget;
     num_periods = gnc_budget_get_num_periods( budget );
     descendants = gnc_account_get_descendants( gnc_book_get_root_account( be->book ) );
-    for ( node = descendants; node != NULL && is_ok; node = g_list_next(node) )
+    for ( node = descendants.begin(); node != descendants.end() && is_ok; node++ )
     {
         guint i;
 
-        info.account = (Account*)(node->data);
+        info.account = *node;
         for ( i = 0; i < num_periods && is_ok; i++ )
         {
             if ( gnc_budget_is_account_period_value_set( budget, info.account, i ) )
@@ -289,7 +301,6 @@ save_budget_amounts( GncSqlBackend* be, GncBudget* budget )
             }
         }
     }
-    g_list_free( descendants );
 
     return is_ok;
 }
@@ -392,7 +403,7 @@ create_budget_tables( GncSqlBackend* be )
 static gboolean
 save_budget( GncSqlBackend* be, QofInstance* inst )
 {
-    GncBudget* pBudget = GNC_BUDGET(inst);
+    GncBudget* pBudget = (GncBudget*)inst;
     const GncGUID* guid;
     gint op;
     gboolean is_infant;
@@ -400,20 +411,20 @@ save_budget( GncSqlBackend* be, QofInstance* inst )
 
     g_return_val_if_fail( be != NULL, FALSE );
     g_return_val_if_fail( inst != NULL, FALSE );
-    g_return_val_if_fail( GNC_IS_BUDGET(inst), FALSE );
+    g_return_val_if_fail( QOF_CHECK_TYPE(inst, GNC_ID_BUDGET), FALSE );
 
     is_infant = qof_instance_get_infant( inst );
     if ( qof_instance_get_destroying( inst ) )
     {
         op = OP_DB_DELETE;
     }
-    else if ( be->is_pristine_db || is_infant )
+    else if ( be->is_pristine_db )
     {
         op = OP_DB_INSERT;
     }
     else
     {
-        op = OP_DB_UPDATE;
+        op = OP_DB_UPSERT;
     }
     is_ok = gnc_sql_do_db_operation( be, op, BUDGET_TABLE, GNC_ID_BUDGET, pBudget, col_table );
 
@@ -498,15 +509,7 @@ load_budget_guid( const GncSqlBackend* be, GncSqlRow* row,
         budget = gnc_budget_lookup( &guid, be->book );
         if ( budget != NULL )
         {
-            if ( table_row->gobj_param_name != NULL )
-            {
-                g_object_set( pObject, table_row->gobj_param_name, budget, NULL );
-            }
-            else
-            {
-                g_return_if_fail( setter != NULL );
-                (*setter)( pObject, (const gpointer)budget );
-            }
+            (*setter)( pObject, (const gpointer)budget );
         }
         else
         {
@@ -532,9 +535,6 @@ gnc_sql_init_budget_handler( void )
         save_budget,    		        /* commit */
         load_all_budgets,               /* initial_load */
         create_budget_tables,	        /* create_tables */
-        NULL,                           /* compile_query */
-        NULL,                           /* run_query */
-        NULL,                           /* free_query */
         write_budgets					/* write */
     };
 
@@ -60,22 +60,43 @@ static void set_quote_source_name( gpointer pObject, /*@ null @*/ gpointer pValu
 static const GncSqlColumnTableEntry col_table[] =
 {
     /*@ -full_init_block @*/
-    { "guid",         CT_GUID,    0,                             COL_NNUL | COL_PKEY, "guid" },
     {
-        "namespace",    CT_STRING,  COMMODITY_MAX_NAMESPACE_LEN,   COL_NNUL,          NULL, NULL,
+        "guid", CT_GUID, 0, COL_NNUL | COL_PKEY,
+        (QofAccessFunc)qof_instance_get_guid, (QofSetterFunc)qof_instance_set_guid
+    },
+    {
+        "namespace",    CT_STRING,  COMMODITY_MAX_NAMESPACE_LEN,   COL_NNUL,
         (QofAccessFunc)gnc_commodity_get_namespace,
         (QofSetterFunc)gnc_commodity_set_namespace
     },
-    { "mnemonic",     CT_STRING,  COMMODITY_MAX_MNEMONIC_LEN,    COL_NNUL,          "mnemonic" },
-    { "fullname",     CT_STRING,  COMMODITY_MAX_FULLNAME_LEN,    0,                 "fullname" },
-    { "cusip",        CT_STRING,  COMMODITY_MAX_CUSIP_LEN,       0,                 "cusip" },
-    { "fraction",     CT_INT,     0,                             COL_NNUL,          "fraction" },
-    { "quote_flag",   CT_BOOLEAN, 0,                             COL_NNUL,          "quote_flag" },
     {
-        "quote_source", CT_STRING,  COMMODITY_MAX_QUOTESOURCE_LEN, 0,                 NULL, NULL,
+        "mnemonic", CT_STRING, COMMODITY_MAX_MNEMONIC_LEN, COL_NNUL,
+        (QofAccessFunc)gnc_commodity_get_mnemonic, (QofSetterFunc)gnc_commodity_set_mnemonic
+    },
+    {
+        "fullname", CT_STRING, COMMODITY_MAX_FULLNAME_LEN, 0,
+        (QofAccessFunc)gnc_commodity_get_fullname, (QofSetterFunc)gnc_commodity_set_fullname
+    },
+    {
+        "cusip", CT_STRING, COMMODITY_MAX_CUSIP_LEN, 0,
+        (QofAccessFunc)gnc_commodity_get_cusip, (QofSetterFunc)gnc_commodity_set_cusip
+    },
+    {
+        "fraction", CT_INT, 0, COL_NNUL,
+        (QofAccessFunc)gnc_commodity_get_fraction, (QofSetterFunc)gnc_commodity_set_fraction
+    },
+    {
+        "quote_flag", CT_BOOLEAN, 0, COL_NNUL,
+        (QofAccessFunc)gnc_commodity_get_quote_flag, (QofSetterFunc)gnc_commodity_set_quote_flag
+    },
+    {
+        "quote_source", CT_STRING,  COMMODITY_MAX_QUOTESOURCE_LEN, 0,
         (QofAccessFunc)get_quote_source_name, set_quote_source_name
     },
-    { "quote_tz",     CT_STRING,  COMMODITY_MAX_QUOTE_TZ_LEN,    0,                 "quote-tz" },
+    {
+        "quote_tz", CT_STRING, COMMODITY_MAX_QUOTE_TZ_LEN, 0,
+        (QofAccessFunc)gnc_commodity_get_quote_tz, (QofSetterFunc)gnc_commodity_set_quote_tz
+    },
     { NULL }
     /*@ +full_init_block @*/
 };
@@ -183,25 +204,29 @@ create_commodities_tables( GncSqlBackend* be )
 
 /* ================================================================= */
 static gboolean
-do_commit_commodity( GncSqlBackend* be, QofInstance* inst, gboolean force_insert )
+commit_commodity( GncSqlBackend* be, QofInstance* inst )
 {
     const GncGUID* guid;
     gboolean is_infant;
     gint op;
     gboolean is_ok;
 
+    g_return_val_if_fail( be != NULL, FALSE );
+    g_return_val_if_fail( inst != NULL, FALSE );
+//    g_return_val_if_fail( GNC_IS_COMMODITY(inst), FALSE );
+
     is_infant = qof_instance_get_infant( inst );
     if ( qof_instance_get_destroying( inst ) )
     {
         op = OP_DB_DELETE;
     }
-    else if ( be->is_pristine_db || is_infant || force_insert )
+    else if ( be->is_pristine_db )
     {
         op = OP_DB_INSERT;
     }
     else
     {
-        op = OP_DB_UPDATE;
+        op = OP_DB_UPSERT;
     }
     is_ok = gnc_sql_do_db_operation( be, op, COMMODITIES_TABLE, GNC_ID_COMMODITY, inst, col_table );
 
@@ -222,37 +247,27 @@ do_commit_commodity( GncSqlBackend* be, QofInstance* inst, gboolean force_insert
     return is_ok;
 }
 
-static gboolean
-commit_commodity( GncSqlBackend* be, QofInstance* inst )
-{
-    g_return_val_if_fail( be != NULL, FALSE );
-    g_return_val_if_fail( inst != NULL, FALSE );
-//    g_return_val_if_fail( GNC_IS_COMMODITY(inst), FALSE );
-
-    return do_commit_commodity( be, inst, FALSE );
-}
-
-static gboolean
-is_commodity_in_db( GncSqlBackend* be, gnc_commodity* pCommodity )
-{
-    g_return_val_if_fail( be != NULL, FALSE );
-    g_return_val_if_fail( pCommodity != NULL, FALSE );
-
-    return gnc_sql_object_is_it_in_db( be, COMMODITIES_TABLE, GNC_ID_COMMODITY,
-                                       pCommodity, col_table );
-}
-
 gboolean
 gnc_sql_save_commodity( GncSqlBackend* be, gnc_commodity* pCommodity )
 {
+    gint inserted;
     gboolean is_ok = TRUE;
 
     g_return_val_if_fail( be != NULL, FALSE );
     g_return_val_if_fail( pCommodity != NULL, FALSE );
 
-    if ( !is_commodity_in_db( be, pCommodity ) )
+    /* Called for every transaction and price commit, so an existing
+     * commodity must cost no more than one statement. */
+    inserted = gnc_sql_insert_if_absent( be, COMMODITIES_TABLE, GNC_ID_COMMODITY,
+                                         pCommodity, col_table );
+    if ( inserted < 0 )
     {
-        is_ok = do_commit_commodity( be, QOF_INSTANCE(pCommodity), TRUE );
+        is_ok = FALSE;
+    }
+    else if ( inserted > 0 )
+    {
+        is_ok = gnc_sql_slots_save( be, qof_instance_get_guid( QOF_INSTANCE(pCommodity) ),
+                                    TRUE, qof_instance_get_slots( QOF_INSTANCE(pCommodity) ) );
     }
 
     return is_ok;
@@ -281,11 +296,7 @@ load_commodity_guid( const GncSqlBackend* be, GncSqlRow* row,
         commodity = gnc_commodity_find_commodity_by_guid( &guid, be->book );
         if ( commodity != NULL )
         {
-            if ( table_row->gobj_param_name != NULL )
-            {
-                g_object_set( pObject, table_row->gobj_param_name, commodity, NULL );
-            }
-            else if ( setter != NULL )
+            if ( setter != NULL )
             {
                 (*setter)( pObject, (const gpointer)commodity );
             }
@@ -314,9 +325,6 @@ gnc_sql_init_commodity_handler( void )
         commit_commodity,            /* commit */
         load_all_commodities,        /* initial_load */
         create_commodities_tables,   /* create_tables */
-        NULL,                        /* compile_query */
-        NULL,                        /* run_query */
-        NULL,                        /* free_query */
         NULL                         /* write */
     };
 
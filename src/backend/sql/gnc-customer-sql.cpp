@@ -58,27 +58,60 @@ static QofLogModule log_module = G_LOG_DOMAIN;
 
 static GncSqlColumnTableEntry col_table[] =
 {
-    { "guid",         CT_GUID,          0,             COL_NNUL | COL_PKEY, "guid" },
-    { "name",         CT_STRING,        MAX_NAME_LEN,  COL_NNUL,          "name" },
-    { "id",           CT_STRING,        MAX_ID_LEN,    COL_NNUL,          NULL, CUSTOMER_ID },
-    { "notes",        CT_STRING,        MAX_NOTES_LEN, COL_NNUL,          NULL, CUSTOMER_NOTES },
-    { "active",       CT_BOOLEAN,       0,             COL_NNUL,          NULL, QOF_PARAM_ACTIVE },
-    { "discount",     CT_NUMERIC,       0,             COL_NNUL,          NULL, CUSTOMER_DISCOUNT },
-    { "credit",       CT_NUMERIC,       0,             COL_NNUL,          NULL, CUSTOMER_CREDIT },
-    {
-        "currency",     CT_COMMODITYREF,  0,             COL_NNUL,          NULL, NULL,
+    {
+        "guid", CT_GUID, 0, COL_NNUL | COL_PKEY,
+        (QofAccessFunc)qof_instance_get_guid, (QofSetterFunc)qof_instance_set_guid
+    },
+    {
+        "name", CT_STRING, MAX_NAME_LEN, COL_NNUL,
+        (QofAccessFunc)gncCustomerGetName, (QofSetterFunc)gncCustomerSetName
+    },
+    {
+        "id", CT_STRING, MAX_ID_LEN, COL_NNUL,
+        (QofAccessFunc)gncCustomerGetID, (QofSetterFunc)gncCustomerSetID
+    },
+    {
+        "notes", CT_STRING, MAX_NOTES_LEN, COL_NNUL,
+        (QofAccessFunc)gncCustomerGetNotes, (QofSetterFunc)gncCustomerSetNotes
+    },
+    {
+        "active", CT_BOOLEAN, 0, COL_NNUL,
+        (QofAccessFunc)gncCustomerGetActive, (QofSetterFunc)gncCustomerSetActive
+    },
+    {
+        "discount", CT_NUMERIC, 0, COL_NNUL,
+        (QofAccessFunc)gncCustomerGetDiscount, (QofSetterFunc)gncCustomerSetDiscount
+    },
+    {
+        "credit", CT_NUMERIC, 0, COL_NNUL,
+        (QofAccessFunc)gncCustomerGetCredit, (QofSetterFunc)gncCustomerSetCredit
+    },
+    {
+        "currency",     CT_COMMODITYREF,  0,             COL_NNUL,
         (QofAccessFunc)gncCustomerGetCurrency, (QofSetterFunc)gncCustomerSetCurrency
     },
-    { "tax_override", CT_BOOLEAN,       0,             COL_NNUL,          NULL, CUSTOMER_TT_OVER },
-    { "addr",         CT_ADDRESS,       0,             0,                 NULL, CUSTOMER_ADDR },
-    { "shipaddr",     CT_ADDRESS,       0,             0,                 NULL, CUSTOMER_SHIPADDR },
-    { "terms",        CT_BILLTERMREF,   0,             0,                 NULL, CUSTOMER_TERMS },
     {
-        "tax_included", CT_INT,           0,             0,                 NULL, NULL,
+        "tax_override", CT_BOOLEAN, 0, COL_NNUL,
+        (QofAccessFunc)gncCustomerGetTaxTableOverride, (QofSetterFunc)gncCustomerSetTaxTableOverride
+    },
+    {
+        "addr", CT_ADDRESS, 0, 0,
+        (QofAccessFunc)gncCustomerGetAddr, (QofSetterFunc)qofCustomerSetAddr
+    },
+    {
+        "shipaddr", CT_ADDRESS, 0, 0,
+        (QofAccessFunc)gncCustomerGetShipAddr, (QofSetterFunc)qofCustomerSetShipAddr
+    },
+    {
+        "terms", CT_BILLTERMREF, 0, 0,
+        (QofAccessFunc)gncCustomerGetTerms, (QofSetterFunc)gncCustomerSetTerms
+    },
+    {
+        "tax_included", CT_INT,           0,             0,
         (QofAccessFunc)gncCustomerGetTaxIncluded, (QofSetterFunc)gncCustomerSetTaxIncluded
     },
     {
-        "taxtable",     CT_TAXTABLEREF,   0,             0,                 NULL, NULL,
+        "taxtable",     CT_TAXTABLEREF,   0,             0,
         (QofAccessFunc)gncCustomerGetTaxTable, (QofSetterFunc)gncCustomerSetTaxTable
     },
     { NULL }
@@ -239,7 +272,6 @@ gnc_customer_sql_initialize( void )
         save_customer,						/* commit */
         load_all_customers,					/* initial_load */
         create_customer_tables,				/* create_tables */
-        NULL, NULL, NULL,
         write_customers						/* write */
     };
 
@@ -58,17 +58,50 @@ static QofLogModule log_module = G_LOG_DOMAIN;
 
 static GncSqlColumnTableEntry col_table[] =
 {
-    { "guid",       CT_GUID,          0,                COL_NNUL | COL_PKEY, "guid" },
-    { "username",   CT_STRING,        MAX_USERNAME_LEN, COL_NNUL,            "username" },
-    { "id",         CT_STRING,        MAX_ID_LEN,       COL_NNUL,            "id" },
-    { "language",   CT_STRING,        MAX_LANGUAGE_LEN, COL_NNUL,            "language" },
-    { "acl",        CT_STRING,        MAX_ACL_LEN,      COL_NNUL,            "acl" },
-    { "active",     CT_BOOLEAN,       0,                COL_NNUL,            "active" },
-    { "currency",   CT_COMMODITYREF,  0,                COL_NNUL,            "currency" },
-    { "ccard_guid", CT_ACCOUNTREF,    0,                0,                   "credit-card-account" },
-    { "workday",    CT_NUMERIC,       0,                COL_NNUL,            "workday" },
-    { "rate",       CT_NUMERIC,       0,                COL_NNUL,            "rate" },
-    { "addr",       CT_ADDRESS,       0,                0,                   "address" },
+    {
+        "guid", CT_GUID, 0, COL_NNUL | COL_PKEY,
+        (QofAccessFunc)qof_instance_get_guid, (QofSetterFunc)qof_instance_set_guid
+    },
+    {
+        "username", CT_STRING, MAX_USERNAME_LEN, COL_NNUL,
+        (QofAccessFunc)gncEmployeeGetUsername, (QofSetterFunc)gncEmployeeSetUsername
+    },
+    {
+        "id", CT_STRING, MAX_ID_LEN, COL_NNUL,
+        (QofAccessFunc)gncEmployeeGetID, (QofSetterFunc)gncEmployeeSetID
+    },
+    {
+        "language", CT_STRING, MAX_LANGUAGE_LEN, COL_NNUL,
+        (QofAccessFunc)gncEmployeeGetLanguage, (QofSetterFunc)gncEmployeeSetLanguage
+    },
+    {
+        "acl", CT_STRING, MAX_ACL_LEN, COL_NNUL,
+        (QofAccessFunc)gncEmployeeGetAcl, (QofSetterFunc)gncEmployeeSetAcl
+    },
+    {
+        "active", CT_BOOLEAN, 0, COL_NNUL,
+        (QofAccessFunc)gncEmployeeGetActive, (QofSetterFunc)gncEmployeeSetActive
+    },
+    {
+        "currency", CT_COMMODITYREF, 0, COL_NNUL,
+        (QofAccessFunc)gncEmployeeGetCurrency, (QofSetterFunc)gncEmployeeSetCurrency
+    },
+    {
+        "ccard_guid", CT_ACCOUNTREF, 0, 0,
+        (QofAccessFunc)gncEmployeeGetCCard, (QofSetterFunc)gncEmployeeSetCCard
+    },
+    {
+        "workday", CT_NUMERIC, 0, COL_NNUL,
+        (QofAccessFunc)gncEmployeeGetWorkday, (QofSetterFunc)gncEmployeeSetWorkday
+    },
+    {
+        "rate", CT_NUMERIC, 0, COL_NNUL,
+        (QofAccessFunc)gncEmployeeGetRate, (QofSetterFunc)gncEmployeeSetRate
+    },
+    {
+        "addr", CT_ADDRESS, 0, 0,
+        (QofAccessFunc)gncEmployeeGetAddr, (QofSetterFunc)qofEmployeeSetAddr
+    },
     { NULL }
 };
 
@@ -173,13 +206,13 @@ save_employee( GncSqlBackend* be, QofInstance* inst )
     {
         op = OP_DB_DELETE;
     }
-    else if ( be->is_pristine_db || is_infant )
+    else if ( be->is_pristine_db )
     {
         op = OP_DB_INSERT;
     }
     else
     {
-        op = OP_DB_UPDATE;
+        op = OP_DB_UPSERT;
     }
     if ( op != OP_DB_DELETE )
     {
@@ -267,7 +300,6 @@ gnc_employee_sql_initialize( void )
         save_employee,						/* commit */
         load_all_employees,					/* initial_load */
         create_employee_tables,				/* create_tables */
-        NULL, NULL, NULL,
         write_employees						/* write */
     };
 
@@ -65,51 +65,108 @@ static void entry_set_bill( gpointer pObject, gpointer val );
 
 static GncSqlColumnTableEntry col_table[] =
 {
-    { "guid",          CT_GUID,        0,                   COL_NNUL | COL_PKEY, "guid" },
-    { "date",          CT_TIMESPEC,    0,                   COL_NNUL,          NULL, ENTRY_DATE },
-    { "date_entered",  CT_TIMESPEC,    0,                   0,                 NULL, ENTRY_DATE_ENTERED },
-    { "description",   CT_STRING,      MAX_DESCRIPTION_LEN, 0,                 "description" },
-    { "action",        CT_STRING,      MAX_ACTION_LEN,      0,                 NULL, ENTRY_ACTION },
-    { "notes",         CT_STRING,      MAX_NOTES_LEN,       0,                 NULL, ENTRY_NOTES },
-    { "quantity",      CT_NUMERIC,     0,                   0,                 NULL, ENTRY_QTY },
-    { "i_acct",        CT_ACCOUNTREF,  0,                   0,                 NULL, ENTRY_IACCT },
-    { "i_price",       CT_NUMERIC,     0,                   0,                 NULL, ENTRY_IPRICE },
-    {
-        "i_discount",    CT_NUMERIC,     0,                   0,                 NULL, NULL,
+    {
+        "guid", CT_GUID, 0, COL_NNUL | COL_PKEY,
+        (QofAccessFunc)qof_instance_get_guid, (QofSetterFunc)qof_instance_set_guid
+    },
+    {
+        "date", CT_TIMESPEC, 0, COL_NNUL,
+        (QofAccessFunc)gncEntryGetDate, (QofSetterFunc)gncEntrySetDate
+    },
+    {
+        "date_entered", CT_TIMESPEC, 0, 0,
+        (QofAccessFunc)gncEntryGetDateEntered, (QofSetterFunc)gncEntrySetDateEntered
+    },
+    {
+        "description", CT_STRING, MAX_DESCRIPTION_LEN, 0,
+        (QofAccessFunc)gncEntryGetDescription, (QofSetterFunc)gncEntrySetDescription
+    },
+    {
+        "action", CT_STRING, MAX_ACTION_LEN, 0,
+        (QofAccessFunc)gncEntryGetAction, (QofSetterFunc)gncEntrySetAction
+    },
+    {
+        "notes", CT_STRING, MAX_NOTES_LEN, 0,
+        (QofAccessFunc)gncEntryGetNotes, (QofSetterFunc)gncEntrySetNotes
+    },
+    {
+        "quantity", CT_NUMERIC, 0, 0,
+        (QofAccessFunc)gncEntryGetQuantity, (QofSetterFunc)gncEntrySetQuantity
+    },
+    {
+        "i_acct", CT_ACCOUNTREF, 0, 0,
+        (QofAccessFunc)gncEntryGetInvAccount, (QofSetterFunc)gncEntrySetInvAccount
+    },
+    {
+        "i_price", CT_NUMERIC, 0, 0,
+        (QofAccessFunc)gncEntryGetInvPrice, (QofSetterFunc)gncEntrySetInvPrice
+    },
+    {
+        "i_discount",    CT_NUMERIC,     0,                   0,
         (QofAccessFunc)gncEntryGetInvDiscount, (QofSetterFunc)gncEntrySetInvDiscount
     },
     {
-        "invoice",       CT_INVOICEREF,  0,                   0,                 NULL, NULL,
+        "invoice",       CT_INVOICEREF,  0,                   0,
         (QofAccessFunc)gncEntryGetInvoice, (QofSetterFunc)entry_set_invoice
     },
-    { "i_disc_type",   CT_STRING,      MAX_DISCTYPE_LEN,    0,        			NULL, ENTRY_INV_DISC_TYPE },
-    { "i_disc_how",    CT_STRING,      MAX_DISCHOW_LEN,     0,        			NULL, ENTRY_INV_DISC_HOW },
-    { "i_taxable",     CT_BOOLEAN,     0,                   0,        			NULL, ENTRY_INV_TAXABLE },
-    { "i_taxincluded", CT_BOOLEAN,     0,                   0,        			NULL, ENTRY_INV_TAX_INC },
     {
-        "i_taxtable",    CT_TAXTABLEREF, 0,                   0,        			NULL, NULL,
+        "i_disc_type", CT_STRING, MAX_DISCTYPE_LEN, 0,
+        (QofAccessFunc)qofEntryGetInvDiscType, (QofSetterFunc)qofEntrySetInvDiscType
+    },
+    {
+        "i_disc_how", CT_STRING, MAX_DISCHOW_LEN, 0,
+        (QofAccessFunc)qofEntryGetInvDiscHow, (QofSetterFunc)qofEntrySetInvDiscHow
+    },
+    {
+        "i_taxable", CT_BOOLEAN, 0, 0,
+        (QofAccessFunc)gncEntryGetInvTaxable, (QofSetterFunc)gncEntrySetInvTaxable
+    },
+    {
+        "i_taxincluded", CT_BOOLEAN, 0, 0,
+        (QofAccessFunc)gncEntryGetInvTaxIncluded, (QofSetterFunc)gncEntrySetInvTaxIncluded
+    },
+    {
+        "i_taxtable",    CT_TAXTABLEREF, 0,                   0,
         (QofAccessFunc)gncEntryGetInvTaxTable, (QofSetterFunc)gncEntrySetInvTaxTable
     },
-    { "b_acct",        CT_ACCOUNTREF,  0,                   0,        			NULL, ENTRY_BACCT },
-    { "b_price",       CT_NUMERIC,     0,                   0,        			NULL, ENTRY_BPRICE },
     {
-        "bill",          CT_INVOICEREF,  0,                   0,        			NULL, NULL,
+        "b_acct", CT_ACCOUNTREF, 0, 0,
+        (QofAccessFunc)gncEntryGetBillAccount, (QofSetterFunc)gncEntrySetBillAccount
+    },
+    {
+        "b_price", CT_NUMERIC, 0, 0,
+        (QofAccessFunc)gncEntryGetBillPrice, (QofSetterFunc)gncEntrySetBillPrice
+    },
+    {
+        "bill",          CT_INVOICEREF,  0,                   0,
         (QofAccessFunc)gncEntryGetBill, (QofSetterFunc)entry_set_bill
     },
-    { "b_taxable",     CT_BOOLEAN,     0,                   0,        			NULL, ENTRY_BILL_TAXABLE },
-    { "b_taxincluded", CT_BOOLEAN,     0,                   0,        			NULL, ENTRY_BILL_TAX_INC },
     {
-        "b_taxtable",    CT_TAXTABLEREF, 0,                   0,        			NULL, NULL,
+        "b_taxable", CT_BOOLEAN, 0, 0,
+        (QofAccessFunc)gncEntryGetBillTaxable, (QofSetterFunc)gncEntrySetBillTaxable
+    },
+    {
+        "b_taxincluded", CT_BOOLEAN, 0, 0,
+        (QofAccessFunc)gncEntryGetBillTaxIncluded, (QofSetterFunc)gncEntrySetBillTaxIncluded
+    },
+    {
+        "b_taxtable",    CT_TAXTABLEREF, 0,                   0,
         (QofAccessFunc)gncEntryGetBillTaxTable, (QofSetterFunc)gncEntrySetBillTaxTable
     },
     {
-        "b_paytype",     CT_INT,         0,                   0,        			NULL, NULL,
+        "b_paytype",     CT_INT,         0,                   0,
         (QofAccessFunc)gncEntryGetBillPayment, (QofSetterFunc)gncEntrySetBillPayment
     },
-    { "billable",      CT_BOOLEAN,     0,                   0,        			NULL, ENTRY_BILLABLE },
-    { "billto",        CT_OWNERREF,    0,                   0,        			NULL, ENTRY_BILLTO },
     {
-        "order_guid",    CT_ORDERREF,    0,                   0,        			NULL, NULL,
+        "billable", CT_BOOLEAN, 0, 0,
+        (QofAccessFunc)gncEntryGetBillable, (QofSetterFunc)gncEntrySetBillable
+    },
+    {
+        "billto", CT_OWNERREF, 0, 0,
+        (QofAccessFunc)gncEntryGetBillTo, (QofSetterFunc)gncEntrySetBillTo
+    },
+    {
+        "order_guid",    CT_ORDERREF,    0,                   0,
         (QofAccessFunc)gncEntryGetOrder, (QofSetterFunc)gncEntrySetOrder
     },
     { NULL }
@@ -287,7 +344,6 @@ gnc_entry_sql_initialize( void )
         save_entry,							/* commit */
         load_all_entries,					/* initial_load */
         create_entry_tables,				/* create_tables */
-        NULL, NULL, NULL,
         write_entries						/* write */
     };
 
@@ -59,34 +59,64 @@ static QofLogModule log_module = G_LOG_DOMAIN;
 
 static GncSqlColumnTableEntry col_table[] =
 {
-    { "guid",         CT_GUID,         0,                  COL_NNUL | COL_PKEY, "guid" },
-    { "id",           CT_STRING,       MAX_ID_LEN,         COL_NNUL,          NULL, INVOICE_ID },
-    { "date_opened",  CT_TIMESPEC,     0,                  0,                 NULL, INVOICE_OPENED },
-    { "date_posted",  CT_TIMESPEC,     0,                  0,                 NULL, INVOICE_POSTED },
-    { "notes",        CT_STRING,       MAX_NOTES_LEN,      COL_NNUL,          "notes" },
-    { "active",       CT_BOOLEAN,      0,                  COL_NNUL,          NULL, QOF_PARAM_ACTIVE },
     {
-        "currency",     CT_COMMODITYREF, 0,                  COL_NNUL,          NULL, NULL,
+        "guid", CT_GUID, 0, COL_NNUL | COL_PKEY,
+        (QofAccessFunc)qof_instance_get_guid, (QofSetterFunc)qof_instance_set_guid
+    },
+    {
+        "id", CT_STRING, MAX_ID_LEN, COL_NNUL,
+        (QofAccessFunc)gncInvoiceGetID, (QofSetterFunc)gncInvoiceSetID
+    },
+    {
+        "date_opened", CT_TIMESPEC, 0, 0,
+        (QofAccessFunc)gncInvoiceGetDateOpened, (QofSetterFunc)gncInvoiceSetDateOpened
+    },
+    {
+        "date_posted", CT_TIMESPEC, 0, 0,
+        (QofAccessFunc)gncInvoiceGetDatePosted, (QofSetterFunc)gncInvoiceSetDatePosted
+    },
+    {
+        "notes", CT_STRING, MAX_NOTES_LEN, COL_NNUL,
+        (QofAccessFunc)gncInvoiceGetNotes, (QofSetterFunc)gncInvoiceSetNotes
+    },
+    {
+        "active", CT_BOOLEAN, 0, COL_NNUL,
+        (QofAccessFunc)gncInvoiceGetActive, (QofSetterFunc)gncInvoiceSetActive
+    },
+    {
+        "currency",     CT_COMMODITYREF, 0,                  COL_NNUL,
         (QofAccessFunc)gncInvoiceGetCurrency, (QofSetterFunc)gncInvoiceSetCurrency
     },
     {
-        "owner",        CT_OWNERREF,     0,                  0,                 NULL, NULL,
+        "owner",        CT_OWNERREF,     0,                  0,
         (QofAccessFunc)gncInvoiceGetOwner, (QofSetterFunc)gncInvoiceSetOwner
     },
-    { "terms",        CT_BILLTERMREF,  0,                  0,                 NULL, INVOICE_TERMS },
-    { "billing_id",   CT_STRING,       MAX_BILLING_ID_LEN, 0,                 NULL, INVOICE_BILLINGID },
-    { "post_txn",     CT_TXREF,        0,                  0,                 NULL, INVOICE_POST_TXN },
     {
-        "post_lot",     CT_LOTREF,       0,                  0,                 NULL, NULL,
+        "terms", CT_BILLTERMREF, 0, 0,
+        (QofAccessFunc)gncInvoiceGetTerms, (QofSetterFunc)gncInvoiceSetTerms
+    },
+    {
+        "billing_id", CT_STRING, MAX_BILLING_ID_LEN, 0,
+        (QofAccessFunc)gncInvoiceGetBillingID, (QofSetterFunc)gncInvoiceSetBillingID
+    },
+    {
+        "post_txn", CT_TXREF, 0, 0,
+        (QofAccessFunc)gncInvoiceGetPostedTxn, (QofSetterFunc)gncInvoiceSetPostedTxn
+    },
+    {
+        "post_lot",     CT_LOTREF,       0,                  0,
         (QofAccessFunc)gncInvoiceGetPostedLot, (QofSetterFunc)gncInvoiceSetPostedLot
     },
-    { "post_acc",     CT_ACCOUNTREF,   0,                  0,                 NULL, INVOICE_ACC },
     {
-        "billto",       CT_OWNERREF,     0,                  0,                 NULL, NULL,
+        "post_acc", CT_ACCOUNTREF, 0, 0,
+        (QofAccessFunc)gncInvoiceGetPostedAcc, (QofSetterFunc)gncInvoiceSetPostedAcc
+    },
+    {
+        "billto",       CT_OWNERREF,     0,                  0,
         (QofAccessFunc)gncInvoiceGetBillTo, (QofSetterFunc)gncInvoiceSetBillTo
     },
     {
-        "charge_amt",   CT_NUMERIC,      0,                  0,                 NULL, NULL,
+        "charge_amt",   CT_NUMERIC,      0,                  0,
         (QofAccessFunc)gncInvoiceGetToChargeAmount, (QofSetterFunc)gncInvoiceSetToChargeAmount
     },
     { NULL }
@@ -196,13 +226,13 @@ save_invoice( GncSqlBackend* be, QofInstance* inst )
     {
         op = OP_DB_DELETE;
     }
-    else if ( be->is_pristine_db || is_infant )
+    else if ( be->is_pristine_db )
     {
         op = OP_DB_INSERT;
     }
     else
     {
-        op = OP_DB_UPDATE;
+        op = OP_DB_UPSERT;
     }
     if ( op != OP_DB_DELETE )
     {
@@ -301,14 +331,7 @@ load_invoice_guid( const GncSqlBackend* be, GncSqlRow* row,
         invoice = gncInvoiceLookup( be->book, &guid );
         if ( invoice != NULL )
         {
-            if ( table_row->gobj_param_name != NULL )
-            {
-                g_object_set( pObject, table_row->gobj_param_name, invoice, NULL );
-            }
-            else
-            {
-                (*setter)( pObject, (const gpointer)invoice );
-            }
+            (*setter)( pObject, (const gpointer)invoice );
         }
         else
         {
@@ -334,7 +357,6 @@ gnc_invoice_sql_initialize( void )
         save_invoice,						/* commit */
         load_all_invoices,					/* initial_load */
         create_invoice_tables,				/* create_tables */
-        NULL, NULL, NULL,
         write_invoices						/* write */
     };
 
@@ -54,16 +54,28 @@ G_GNUC_UNUSED static QofLogModule log_module = G_LOG_DOMAIN;
 
 static GncSqlColumnTableEntry col_table[] =
 {
-    { "guid",      CT_GUID,     0,                 COL_NNUL | COL_PKEY, "guid" },
-    { "id",        CT_STRING,   MAX_ID_LEN,        COL_NNUL,          NULL, JOB_ID },
-    { "name",      CT_STRING,   MAX_NAME_LEN,      COL_NNUL,          "name" },
-    { "reference", CT_STRING,   MAX_REFERENCE_LEN, COL_NNUL,          NULL, JOB_REFERENCE },
     {
-        "active",    CT_BOOLEAN,  0,                 COL_NNUL,          NULL, NULL,
+        "guid", CT_GUID, 0, COL_NNUL | COL_PKEY,
+        (QofAccessFunc)qof_instance_get_guid, (QofSetterFunc)qof_instance_set_guid
+    },
+    {
+        "id", CT_STRING, MAX_ID_LEN, COL_NNUL,
+        (QofAccessFunc)gncJobGetID, (QofSetterFunc)gncJobSetID
+    },
+    {
+        "name", CT_STRING, MAX_NAME_LEN, COL_NNUL,
+        (QofAccessFunc)gncJobGetName, (QofSetterFunc)gncJobSetName
+    },
+    {
+        "reference", CT_STRING, MAX_REFERENCE_LEN, COL_NNUL,
+        (QofAccessFunc)gncJobGetReference, (QofSetterFunc)gncJobSetReference
+    },
+    {
+        "active",    CT_BOOLEAN,  0,                 COL_NNUL,
         (QofAccessFunc)gncJobGetActive, (QofSetterFunc)gncJobSetActive
     },
     {
-        "owner",     CT_OWNERREF, 0,                 0,                 NULL, NULL,
+        "owner",     CT_OWNERREF, 0,                 0,
         (QofAccessFunc)gncJobGetOwner, (QofSetterFunc)gncJobSetOwner
     },
     { NULL }
@@ -146,7 +158,7 @@ static gboolean
 save_job( GncSqlBackend* be, QofInstance* inst )
 {
     g_return_val_if_fail( inst != NULL, FALSE );
-    g_return_val_if_fail( GNC_IS_JOB(inst), FALSE );
+    g_return_val_if_fail( QOF_CHECK_TYPE(inst, GNC_ID_JOB), FALSE );
     g_return_val_if_fail( be != NULL, FALSE );
 
     return gnc_sql_commit_standard_item( be, inst, TABLE_NAME, GNC_ID_JOB, col_table );
@@ -176,10 +188,10 @@ write_single_job( QofInstance *term_p, gpointer data_p )
     write_objects_t* s = (write_objects_t*)data_p;
 
     g_return_if_fail( term_p != NULL );
-    g_return_if_fail( GNC_IS_JOB(term_p) );
+    g_return_if_fail( QOF_CHECK_TYPE(term_p, GNC_ID_JOB) );
     g_return_if_fail( data_p != NULL );
 
-    if ( s->is_ok && job_should_be_saved( GNC_JOB(term_p) ) )
+    if ( s->is_ok && job_should_be_saved( (GncJob*)term_p ) )
     {
         s->is_ok = save_job( s->be, term_p );
     }
@@ -210,7 +222,6 @@ gnc_job_sql_initialize( void )
         save_job,						/* commit */
         load_all_jobs,					/* initial_load */
         create_job_tables,				/* create_tables */
-        NULL, NULL, NULL,
         write_jobs						/* write */
     };
 
@@ -50,16 +50,23 @@
 
 static /*@ dependent @*//*@ null @*/ gpointer get_lot_account( gpointer pObject );
 static void set_lot_account( gpointer pObject, /*@ null @*/ gpointer pValue );
+static void set_lot_is_closed( gpointer pObject, bool closed );
 
 static const GncSqlColumnTableEntry col_table[] =
 {
     /*@ -full_init_block @*/
-    { "guid",         CT_GUID,       0, COL_NNUL | COL_PKEY, "guid" },
     {
-        "account_guid", CT_ACCOUNTREF, 0, 0,                 NULL, NULL,
+        "guid", CT_GUID, 0, COL_NNUL | COL_PKEY,
+        (QofAccessFunc)qof_instance_get_guid, (QofSetterFunc)qof_instance_set_guid
+    },
+    {
+        "account_guid", CT_ACCOUNTREF, 0, 0,
         (QofAccessFunc)get_lot_account,   set_lot_account
     },
-    { "is_closed",    CT_BOOLEAN,    0, COL_NNUL,          "is-closed" },
+    {
+        "is_closed", CT_BOOLEAN, 0, COL_NNUL,
+        (QofAccessFunc)gnc_lot_is_closed, (QofSetterFunc)set_lot_is_closed
+    },
     { NULL }
     /*@ +full_init_block @*/
 };
@@ -96,6 +103,16 @@ set_lot_account( gpointer pObject, /*@ null @*/ gpointer pValue )
     }
 }
 
+/* The engine derives is-closed from the lot's splits, which are loaded
+ * after the lot itself, so the stored flag only invalidates the cache. */
+static void
+set_lot_is_closed( gpointer pObject, bool closed )
+{
+    g_return_if_fail( pObject != NULL );
+
+    gnc_lot_set_closed_unknown( (GNCLot*)pObject );
+}
+
 static /*@ dependent @*//*@ null @*/ GNCLot*
 load_single_lot( GncSqlBackend* be, GncSqlRow* row )
 {
@@ -134,6 +151,7 @@ load_all_lots( GncSqlBackend* be )
             while ( row != NULL )
             {
                 load_single_lot( be, row );
+                qof_backend_load_yield( &be->be );
                 row = gnc_sql_result_get_next_row( result );
             }
             gnc_sql_result_dispose( result );
@@ -233,15 +251,7 @@ load_lot_guid( const GncSqlBackend* be, GncSqlRow* row,
         lot = gnc_lot_lookup( &guid, be->book );
         if ( lot != NULL )
         {
-            if ( table_row->gobj_param_name != NULL )
-            {
-                g_object_set( pObject, table_row->gobj_param_name, lot, NULL );
-            }
-            else
-            {
-                g_return_if_fail( setter != NULL );
-                (*setter)( pObject, (const gpointer)lot );
-            }
+            (*setter)( pObject, (const gpointer)lot );
         }
         else
         {
@@ -250,11 +260,40 @@ load_lot_guid( const GncSqlBackend* be, GncSqlRow* row,
     }
 }
 
+static void
+load_lot_guid_at_index( const GncSqlBackend* be, GncSqlRow* row,
+                        /*@ null @*/ QofSetterFunc setter, gpointer pObject,
+                        const GncSqlColumnTableEntry* table_row, const gint* col_indices )
+{
+    GncGUID guid;
+    GNCLot* lot;
+
+    g_return_if_fail( be != NULL );
+    g_return_if_fail( row != NULL );
+    g_return_if_fail( pObject != NULL );
+    g_return_if_fail( table_row != NULL );
+
+    if ( gnc_sql_row_get_guid_at_col_index( row, col_indices[0], &guid ) )
+    {
+        lot = gnc_lot_lookup( &guid, be->book );
+        if ( lot != NULL )
+        {
+            (*setter)( pObject, (const gpointer)lot );
+        }
+        else
+        {
+            PWARN( "Lot ref '%s' not found",
+                   gnc_sql_row_get_string_at_col_index( row, col_indices[0] ) );
+        }
+    }
+}
+
 static GncSqlColumnTypeHandler lot_guid_handler
 = { load_lot_guid,
     gnc_sql_add_objectref_guid_col_info_to_list,
     gnc_sql_add_colname_to_list,
-    gnc_sql_add_gvalue_objectref_guid_to_slist
+    gnc_sql_add_gvalue_objectref_guid_to_slist,
+    load_lot_guid_at_index
   };
 /* ================================================================= */
 void
@@ -267,7 +306,6 @@ gnc_sql_init_lot_handler( void )
         commit_lot,            /* commit */
         load_all_lots,         /* initial_load */
         create_lots_tables,    /* create tables */
-        NULL, NULL, NULL,
         write_lots             /* save all */
     };
 
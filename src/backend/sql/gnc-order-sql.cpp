@@ -55,14 +55,38 @@ static QofLogModule log_module = G_LOG_DOMAIN;
 
 static GncSqlColumnTableEntry col_table[] =
 {
-    { "guid",        CT_GUID,     0,                 COL_NNUL | COL_PKEY, "guid" },
-    { "id",          CT_STRING,   MAX_ID_LEN,        COL_NNUL,            "id" },
-    { "notes",       CT_STRING,   MAX_NOTES_LEN,     COL_NNUL,            "notes" },
-    { "reference",   CT_STRING,   MAX_REFERENCE_LEN, COL_NNUL,            "reference" },
-    { "active",      CT_BOOLEAN,  0,                 COL_NNUL,            "order" },
-    { "date_opened", CT_TIMESPEC, 0,                 COL_NNUL,            "date-opened" },
-    { "date_closed", CT_TIMESPEC, 0,                 COL_NNUL,            "date-closed" },
-    { "owner",       CT_OWNERREF, 0,                 COL_NNUL,            NULL, ORDER_OWNER },
+    {
+        "guid", CT_GUID, 0, COL_NNUL | COL_PKEY,
+        (QofAccessFunc)qof_instance_get_guid, (QofSetterFunc)qof_instance_set_guid
+    },
+    {
+        "id", CT_STRING, MAX_ID_LEN, COL_NNUL,
+        (QofAccessFunc)gncOrderGetID, (QofSetterFunc)gncOrderSetID
+    },
+    {
+        "notes", CT_STRING, MAX_NOTES_LEN, COL_NNUL,
+        (QofAccessFunc)gncOrderGetNotes, (QofSetterFunc)gncOrderSetNotes
+    },
+    {
+        "reference", CT_STRING, MAX_REFERENCE_LEN, COL_NNUL,
+        (QofAccessFunc)gncOrderGetReference, (QofSetterFunc)gncOrderSetReference
+    },
+    {
+        "active", CT_BOOLEAN, 0, COL_NNUL,
+        (QofAccessFunc)gncOrderGetActive, (QofSetterFunc)gncOrderSetActive
+    },
+    {
+        "date_opened", CT_TIMESPEC, 0, COL_NNUL,
+        (QofAccessFunc)gncOrderGetDateOpened, (QofSetterFunc)gncOrderSetDateOpened
+    },
+    {
+        "date_closed", CT_TIMESPEC, 0, COL_NNUL,
+        (QofAccessFunc)gncOrderGetDateClosed, (QofSetterFunc)gncOrderSetDateClosed
+    },
+    {
+        "owner", CT_OWNERREF, 0, COL_NNUL,
+        (QofAccessFunc)gncOrderGetOwner, (QofSetterFunc)gncOrderSetOwner
+    },
     { NULL },
 };
 
@@ -82,7 +106,7 @@ load_single_order( GncSqlBackend* be, GncSqlRow* row )
         pOrder = gncOrderCreate( be->book );
     }
     gnc_sql_load_object( be, row, GNC_ID_ORDER, pOrder, col_table );
-    qof_instance_mark_clean( QOF_INSTANCE(pOrder) );
+    qof_instance_mark_clean( (QofInstance*)pOrder );
 
     return pOrder;
 }
@@ -218,14 +242,7 @@ load_order_guid( const GncSqlBackend* be, GncSqlRow* row,
         order = gncOrderLookup( be->book, &guid );
         if ( order != NULL )
         {
-            if ( table_row->gobj_param_name != NULL )
-            {
-                g_object_set( pObject, table_row->gobj_param_name, order, NULL );
-            }
-            else
-            {
-                (*setter)( pObject, (const gpointer)order );
-            }
+            (*setter)( pObject, (const gpointer)order );
         }
         else
         {
@@ -251,7 +268,6 @@ gnc_order_sql_initialize( void )
         save_order,						/* commit */
         load_all_orders,				/* initial_load */
         create_order_tables,			/* create_tables */
-        NULL, NULL, NULL,
         write_orders					/* write */
     };
 
@@ -154,14 +154,7 @@ load_owner( const GncSqlBackend* be, GncSqlRow* row,
         PWARN("Invalid owner type: %d\n", type );
     }
 
-    if ( table_row->gobj_param_name != NULL )
-    {
-        g_object_set( pObject, table_row->gobj_param_name, &owner, NULL );
-    }
-    else
-    {
-        (*setter)( pObject, &owner );
-    }
+    (*setter)( pObject, &owner );
 }
 
 static void
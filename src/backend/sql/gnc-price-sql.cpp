@@ -32,6 +32,7 @@
 
 #include "qof.h"
 #include "gnc-pricedb.h"
+#include "gnc-pricedb-p.h"
 
 #include "gnc-backend-sql.h"
 
@@ -54,13 +55,34 @@
 static const GncSqlColumnTableEntry col_table[] =
 {
     /*@ -full_init_block @*/
-    { "guid",           CT_GUID,           0,                    COL_NNUL | COL_PKEY, "guid" },
-    { "commodity_guid", CT_COMMODITYREF,   0,                    COL_NNUL,          "commodity" },
-    { "currency_guid",  CT_COMMODITYREF,   0,                    COL_NNUL,          "currency" },
-    { "date",           CT_TIMESPEC,       0,                    COL_NNUL,          "date" },
-    { "source",         CT_STRING,         PRICE_MAX_SOURCE_LEN, 0,                 "source" },
-    { "type",           CT_STRING,         PRICE_MAX_TYPE_LEN,   0,                 "type" },
-    { "value",          CT_NUMERIC,        0,                    COL_NNUL,          "value" },
+    {
+        "guid", CT_GUID, 0, COL_NNUL | COL_PKEY,
+        (QofAccessFunc)qof_instance_get_guid, (QofSetterFunc)qof_instance_set_guid
+    },
+    {
+        "commodity_guid", CT_COMMODITYREF, 0, COL_NNUL,
+        (QofAccessFunc)gnc_price_get_commodity, (QofSetterFunc)gnc_price_set_commodity
+    },
+    {
+        "currency_guid", CT_COMMODITYREF, 0, COL_NNUL,
+        (QofAccessFunc)gnc_price_get_currency, (QofSetterFunc)gnc_price_set_currency
+    },
+    {
+        "date", CT_TIMESPEC, 0, COL_NNUL,
+        (QofAccessFunc)gnc_price_get_time, (QofSetterFunc)gnc_price_set_time
+    },
+    {
+        "source", CT_STRING, PRICE_MAX_SOURCE_LEN, 0,
+        (QofAccessFunc)gnc_price_get_source, (QofSetterFunc)gnc_price_set_source
+    },
+    {
+        "type", CT_STRING, PRICE_MAX_TYPE_LEN, 0,
+        (QofAccessFunc)gnc_price_get_typestr, (QofSetterFunc)gnc_price_set_typestr
+    },
+    {
+        "value", CT_NUMERIC, 0, COL_NNUL,
+        (QofAccessFunc)gnc_price_get_value, (QofSetterFunc)gnc_price_set_value
+    },
     { NULL }
     /*@ +full_init_block @*/
 };
@@ -117,6 +139,7 @@ load_all_prices( GncSqlBackend* be )
                     (void)gnc_pricedb_add_price( pPriceDB, pPrice );
                     gnc_price_unref( pPrice );
                 }
+                qof_backend_load_yield( &be->be );
                 row = gnc_sql_result_get_next_row( result );
             }
             gnc_sql_result_dispose( result );
@@ -159,25 +182,23 @@ save_price( GncSqlBackend* be, QofInstance* inst )
 {
     GNCPrice* pPrice = (GNCPrice*)(inst);
     gint op;
-    gboolean is_infant;
     gboolean is_ok = TRUE;
 
     g_return_val_if_fail( be != NULL, FALSE );
     g_return_val_if_fail( inst != NULL, FALSE );
 //    g_return_val_if_fail( GNC_IS_PRICE(inst), FALSE );
 
-    is_infant = qof_instance_get_infant( inst );
     if ( qof_instance_get_destroying( inst ) )
     {
         op = OP_DB_DELETE;
     }
-    else if ( be->is_pristine_db || is_infant )
+    else if ( be->is_pristine_db )
     {
         op = OP_DB_INSERT;
     }
     else
     {
-        op = OP_DB_UPDATE;
+        op = OP_DB_UPSERT;
     }
 
     if ( op != OP_DB_DELETE )
@@ -237,7 +258,6 @@ gnc_sql_init_price_handler( void )
         save_price,         		/* commit */
         load_all_prices,            /* initial_load */
         create_prices_tables,    	/* create tables */
-        NULL, NULL, NULL,
         write_prices				/* write */
     };
 
@@ -75,23 +75,23 @@ static const GncSqlColumnTableEntry col_table[] =
     /*@ -full_init_block @*/
     { "id",                      CT_INT,    0,                                     COL_PKEY | COL_NNUL | COL_AUTOINC },
     {
-        "obj_guid",                CT_GUID,   0,                                     COL_NNUL, NULL, NULL,
+        "obj_guid",                CT_GUID,   0,                                     COL_NNUL,
         (QofAccessFunc)get_obj_guid, (QofSetterFunc)set_obj_guid
     },
     {
-        "recurrence_mult",         CT_INT,    0,                                     COL_NNUL, NULL, NULL,
+        "recurrence_mult",         CT_INT,    0,                                     COL_NNUL,
         (QofAccessFunc)get_recurrence_mult, (QofSetterFunc)set_recurrence_mult
     },
     {
-        "recurrence_period_type",  CT_STRING, BUDGET_MAX_RECURRENCE_PERIOD_TYPE_LEN, COL_NNUL, NULL, NULL,
+        "recurrence_period_type",  CT_STRING, BUDGET_MAX_RECURRENCE_PERIOD_TYPE_LEN, COL_NNUL,
         (QofAccessFunc)get_recurrence_period_type, set_recurrence_period_type
     },
     {
-        "recurrence_period_start", CT_GDATE,  0,                                     COL_NNUL, NULL, NULL,
+        "recurrence_period_start", CT_GDATE,  0,                                     COL_NNUL,
         (QofAccessFunc)get_recurrence_period_start, set_recurrence_period_start
     },
     {
-        "recurrence_weekend_adjust",  CT_STRING, BUDGET_MAX_RECURRENCE_WEEKEND_ADJUST_LEN, COL_NNUL, NULL, NULL,
+        "recurrence_weekend_adjust",  CT_STRING, BUDGET_MAX_RECURRENCE_WEEKEND_ADJUST_LEN, COL_NNUL,
         (QofAccessFunc)get_recurrence_weekend_adjust, set_recurrence_weekend_adjust
     },
     { NULL }
@@ -104,7 +104,7 @@ static const GncSqlColumnTableEntry guid_col_table[] =
 {
     /*@ -full_init_block @*/
     {
-        "obj_guid", CT_GUID, 0, 0, NULL, NULL,
+        "obj_guid", CT_GUID, 0, 0,
         (QofAccessFunc)get_obj_guid, (QofSetterFunc)set_obj_guid
     },
     { NULL }
@@ -257,10 +257,10 @@ gnc_sql_recurrence_save( GncSqlBackend* be, const GncGUID* guid, const Recurrenc
 }
 
 void
-gnc_sql_recurrence_save_list( GncSqlBackend* be, const GncGUID* guid, GList* schedule )
+gnc_sql_recurrence_save_list( GncSqlBackend* be, const GncGUID* guid, const RecurrenceList_t& schedule )
 {
     recurrence_info_t recurrence_info;
-    GList* l;
+    RecurrenceList_t::const_iterator l;
 
     g_return_if_fail( be != NULL );
     g_return_if_fail( guid != NULL );
@@ -269,9 +269,9 @@ gnc_sql_recurrence_save_list( GncSqlBackend* be, const GncGUID* guid, GList* sch
 
     recurrence_info.be = be;
     recurrence_info.guid = guid;
-    for ( l = schedule; l != NULL; l = g_list_next( l ) )
+    for ( l = schedule.begin(); l != schedule.end(); l++ )
     {
-        recurrence_info.pRecurrence = (Recurrence*)l->data;
+        recurrence_info.pRecurrence = *l;
         (void)gnc_sql_do_db_operation( be, OP_DB_INSERT, TABLE_NAME,
                                        TABLE_NAME, &recurrence_info, col_table );
     }
@@ -360,14 +360,14 @@ gnc_sql_recurrence_load( GncSqlBackend* be, const GncGUID* guid )
     return r;
 }
 
-/*@ null @*/ GList*
+RecurrenceList_t
 gnc_sql_recurrence_load_list( GncSqlBackend* be, const GncGUID* guid )
 {
     GncSqlResult* result;
-    GList* list = NULL;
+    RecurrenceList_t list;
 
-    g_return_val_if_fail( be != NULL, NULL );
-    g_return_val_if_fail( guid != NULL, NULL );
+    g_return_val_if_fail( be != NULL, list );
+    g_return_val_if_fail( guid != NULL, list );
 
     result = gnc_sql_set_recurrences_from_db( be, guid );
     if ( result != NULL )
@@ -379,7 +379,7 @@ gnc_sql_recurrence_load_list( GncSqlBackend* be, const GncGUID* guid )
             Recurrence* pRecurrence = new Recurrence;//g_new0( Recurrence, 1 );
             g_assert( pRecurrence != NULL );
             load_recurrence( be, row, pRecurrence );
-            list = g_list_append( list, pRecurrence );
+            list.push_back( pRecurrence );
             row = gnc_sql_result_get_next_row( result );
         }
         gnc_sql_result_dispose( result );
@@ -455,9 +455,6 @@ gnc_sql_init_recurrence_handler( void )
         NULL,                           /* commit - cannot occur */
         NULL,                           /* initial_load - cannot occur */
         create_recurrence_tables,       /* create_tables */
-        NULL,                           /* compile_query */
-        NULL,                           /* run_query */
-        NULL,                           /* free_query */
         NULL                            /* write */
     };
 
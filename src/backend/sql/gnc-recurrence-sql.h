@@ -35,12 +35,11 @@
 #include "gnc-backend-sql.h"
 
 gboolean gnc_sql_recurrence_save( GncSqlBackend* be, const GncGUID* guid, const Recurrence* pRecurrence );
-void gnc_sql_recurrence_save_list( GncSqlBackend* be, const GncGUID* guid, GList* schedule );
+void gnc_sql_recurrence_save_list( GncSqlBackend* be, const GncGUID* guid, const RecurrenceList_t& schedule );
 gboolean gnc_sql_recurrence_delete( GncSqlBackend* be, const GncGUID* guid );
 /*@ null @*/
 Recurrence* gnc_sql_recurrence_load( GncSqlBackend* be, const GncGUID* guid );
-/*@ null @*/
-GList* gnc_sql_recurrence_load_list( GncSqlBackend* be, const GncGUID* guid );
+RecurrenceList_t gnc_sql_recurrence_load_list( GncSqlBackend* be, const GncGUID* guid );
 
 void gnc_sql_init_recurrence_handler( void );
 
@@ -55,35 +55,144 @@ G_GNUC_UNUSED static QofLogModule log_module = G_LOG_DOMAIN;
 
 #define SX_MAX_NAME_LEN 2048
 
+static bool sx_get_auto_create( gpointer pObject );
+static void sx_set_auto_create( gpointer pObject, bool auto_create );
+static bool sx_get_auto_notify( gpointer pObject );
+static void sx_set_auto_notify( gpointer pObject, bool notify );
+static gint sx_get_instance_count( gpointer pObject );
+static /*@ dependent @*//*@ null @*/ gpointer sx_get_template_account( gpointer pObject );
+
 static const GncSqlColumnTableEntry col_table[] =
 {
     /*@ -full_init_block @*/
-    { "guid",              CT_GUID,       0,               COL_NNUL | COL_PKEY, "guid" },
-    { "name",              CT_STRING,     SX_MAX_NAME_LEN, 0,                 "name" },
-    { "enabled",           CT_BOOLEAN,    0,               COL_NNUL,          "enabled" },
-    { "start_date",        CT_GDATE,      0,               0,                 "start-date" },
-    { "end_date",          CT_GDATE,      0,               0,                 "end-date" },
-    { "last_occur",        CT_GDATE,      0,               0,                 "last-occurance-date" },
-    { "num_occur",         CT_INT,        0,               COL_NNUL,          "num-occurance" },
-    { "rem_occur",         CT_INT,        0,               COL_NNUL,          "rem-occurance" },
-    { "auto_create",       CT_BOOLEAN,    0,               COL_NNUL,          "auto-create" },
-    { "auto_notify",       CT_BOOLEAN,    0,               COL_NNUL,          "auto-create-notify" },
-    { "adv_creation",      CT_INT,        0,               COL_NNUL,          "advance-creation-days" },
-    { "adv_notify",        CT_INT,        0,               COL_NNUL,          "advance-reminder-days" },
-    { "instance_count",    CT_INT,        0,               COL_NNUL,          "instance-count" },
-    { "template_act_guid", CT_ACCOUNTREF, 0,               COL_NNUL,          "template-account" },
+    {
+        "guid", CT_GUID, 0, COL_NNUL | COL_PKEY,
+        (QofAccessFunc)qof_instance_get_guid, (QofSetterFunc)qof_instance_set_guid
+    },
+    {
+        "name", CT_STRING, SX_MAX_NAME_LEN, 0,
+        (QofAccessFunc)xaccSchedXactionGetName, (QofSetterFunc)xaccSchedXactionSetName
+    },
+    {
+        "enabled", CT_BOOLEAN, 0, COL_NNUL,
+        (QofAccessFunc)xaccSchedXactionGetEnabled, (QofSetterFunc)xaccSchedXactionSetEnabled
+    },
+    {
+        "start_date", CT_GDATE, 0, 0,
+        (QofAccessFunc)xaccSchedXactionGetStartDate, (QofSetterFunc)xaccSchedXactionSetStartDate
+    },
+    {
+        "end_date", CT_GDATE, 0, 0,
+        (QofAccessFunc)xaccSchedXactionGetEndDate, (QofSetterFunc)xaccSchedXactionSetEndDate
+    },
+    {
+        "last_occur", CT_GDATE, 0, 0,
+        (QofAccessFunc)xaccSchedXactionGetLastOccurDate, (QofSetterFunc)xaccSchedXactionSetLastOccurDate
+    },
+    {
+        "num_occur", CT_INT, 0, COL_NNUL,
+        (QofAccessFunc)xaccSchedXactionGetNumOccur, (QofSetterFunc)xaccSchedXactionSetNumOccur
+    },
+    {
+        "rem_occur", CT_INT, 0, COL_NNUL,
+        (QofAccessFunc)xaccSchedXactionGetRemOccur, (QofSetterFunc)xaccSchedXactionSetRemOccur
+    },
+    {
+        "auto_create", CT_BOOLEAN, 0, COL_NNUL,
+        (QofAccessFunc)sx_get_auto_create, (QofSetterFunc)sx_set_auto_create
+    },
+    {
+        "auto_notify", CT_BOOLEAN, 0, COL_NNUL,
+        (QofAccessFunc)sx_get_auto_notify, (QofSetterFunc)sx_set_auto_notify
+    },
+    {
+        "adv_creation", CT_INT, 0, COL_NNUL,
+        (QofAccessFunc)xaccSchedXactionGetAdvanceCreation, (QofSetterFunc)xaccSchedXactionSetAdvanceCreation
+    },
+    {
+        "adv_notify", CT_INT, 0, COL_NNUL,
+        (QofAccessFunc)xaccSchedXactionGetAdvanceReminder, (QofSetterFunc)xaccSchedXactionSetAdvanceReminder
+    },
+    {
+        "instance_count", CT_INT, 0, COL_NNUL,
+        (QofAccessFunc)sx_get_instance_count, (QofSetterFunc)gnc_sx_set_instance_count
+    },
+    {
+        "template_act_guid", CT_ACCOUNTREF, 0, COL_NNUL,
+        (QofAccessFunc)sx_get_template_account, (QofSetterFunc)sx_set_template_account
+    },
     { NULL }
     /*@ +full_init_block @*/
 };
 
+/* ================================================================= */
+static bool
+sx_get_auto_create( gpointer pObject )
+{
+    bool auto_create;
+    bool notify;
+
+    g_return_val_if_fail( pObject != NULL, FALSE );
+
+    xaccSchedXactionGetAutoCreate( (SchedXaction*)pObject, &auto_create, &notify );
+    return auto_create;
+}
+
+static void
+sx_set_auto_create( gpointer pObject, bool auto_create )
+{
+    SchedXaction* pSx = (SchedXaction*)pObject;
+
+    g_return_if_fail( pObject != NULL );
+
+    xaccSchedXactionSetAutoCreate( pSx, auto_create, pSx->autoCreateNotify );
+}
+
+static bool
+sx_get_auto_notify( gpointer pObject )
+{
+    bool auto_create;
+    bool notify;
+
+    g_return_val_if_fail( pObject != NULL, FALSE );
+
+    xaccSchedXactionGetAutoCreate( (SchedXaction*)pObject, &auto_create, &notify );
+    return notify;
+}
+
+static void
+sx_set_auto_notify( gpointer pObject, bool notify )
+{
+    SchedXaction* pSx = (SchedXaction*)pObject;
+
+    g_return_if_fail( pObject != NULL );
+
+    xaccSchedXactionSetAutoCreate( pSx, pSx->autoCreateOption, notify );
+}
+
+static gint
+sx_get_instance_count( gpointer pObject )
+{
+    g_return_val_if_fail( pObject != NULL, 0 );
+
+    return gnc_sx_get_instance_count( (SchedXaction*)pObject, NULL );
+}
+
+static /*@ dependent @*//*@ null @*/ gpointer
+sx_get_template_account( gpointer pObject )
+{
+    g_return_val_if_fail( pObject != NULL, NULL );
+
+    return ((SchedXaction*)pObject)->template_acct;
+}
+
 /* ================================================================= */
 static /*@ null @*/ SchedXaction*
 load_single_sx( GncSqlBackend* be, GncSqlRow* row )
 {
     const GncGUID* guid;
     SchedXaction* pSx;
-    GList* schedule;
-    GDate start_date;
+    RecurrenceList_t schedule;
 
     g_return_val_if_fail( be != NULL, NULL );
     g_return_val_if_fail( row != NULL, NULL );
@@ -99,8 +208,6 @@ load_single_sx( GncSqlBackend* be, GncSqlRow* row )
     gnc_sx_commit_edit( pSx );
     gnc_sql_transaction_load_tx_for_account( be, pSx->template_acct );
 
-    g_object_get(pSx, "start-date", &start_date, NULL);
-
     return pSx;
 }
 
@@ -182,17 +289,17 @@ gnc_sql_save_schedxaction( GncSqlBackend* be, QofInstance* inst )
     {
         op = OP_DB_DELETE;
     }
-    else if ( be->is_pristine_db || is_infant )
+    else if ( be->is_pristine_db )
     {
         op = OP_DB_INSERT;
     }
     else
     {
-        op = OP_DB_UPDATE;
+        op = OP_DB_UPSERT;
     }
     is_ok = gnc_sql_do_db_operation( be, op, SCHEDXACTION_TABLE, GNC_SX_ID, pSx, col_table );
     guid = qof_instance_get_guid( inst );
-    if ( op == OP_DB_INSERT || op == OP_DB_UPDATE )
+    if ( op != OP_DB_DELETE )
     {
         gnc_sql_recurrence_save_list( be, guid, gnc_sx_get_schedule( pSx ) );
     }
@@ -204,7 +311,7 @@ gnc_sql_save_schedxaction( GncSqlBackend* be, QofInstance* inst )
     if ( is_ok )
     {
         // Now, commit any slots
-        if ( op == OP_DB_INSERT || op == OP_DB_UPDATE )
+        if ( op != OP_DB_DELETE )
         {
             is_ok = gnc_sql_slots_save( be, guid, is_infant, qof_instance_get_slots( inst ) );
         }
@@ -228,9 +335,6 @@ gnc_sql_init_schedxaction_handler( void )
         gnc_sql_save_schedxaction,    /* commit */
         load_all_sxes,                /* initial_load */
         create_sx_tables,             /* create_tables */
-        NULL,                         /* compile_query */
-        NULL,                         /* run_query */
-        NULL,                         /* free_query */
         NULL                          /* write */
     };
 
@@ -92,6 +92,8 @@ static GDate* get_gdate_val( gpointer pObject );
 static void set_gdate_val( gpointer pObject, GDate* value );
 static slot_info_t *slot_info_copy( slot_info_t *pInfo, GncGUID *guid );
 static void slots_load_info( slot_info_t *pInfo );
+static void remember_slots( GncSqlBackend* be, const GncGUID* guid, KvpFrame* pFrame );
+static void forget_slots( GncSqlBackend* be, const GncGUID* guid );
 
 #define SLOT_MAX_PATHNAME_LEN 4096
 #define SLOT_MAX_STRINGVAL_LEN 4096
@@ -116,43 +118,43 @@ static const GncSqlColumnTableEntry col_table[] =
     /*@ -full_init_block @*/
     { "id",             CT_INT,      0, COL_PKEY | COL_NNUL | COL_AUTOINC },
     {
-        "obj_guid",     CT_GUID,     0,                     COL_NNUL, NULL, NULL,
+        "obj_guid",     CT_GUID,     0,                     COL_NNUL,
         (QofAccessFunc)get_obj_guid,     (QofSetterFunc)set_obj_guid
     },
     {
-        "name",         CT_STRING,   SLOT_MAX_PATHNAME_LEN, COL_NNUL, NULL, NULL,
+        "name",         CT_STRING,   SLOT_MAX_PATHNAME_LEN, COL_NNUL,
         (QofAccessFunc)get_path,         set_path
     },
     {
-        "slot_type",    CT_INT,      0,                     COL_NNUL, NULL, NULL,
+        "slot_type",    CT_INT,      0,                     COL_NNUL,
         (QofAccessFunc)get_slot_type,    set_slot_type,
     },
     {
-        "int64_val",    CT_INT64,    0,                     0,        NULL, NULL,
+        "int64_val",    CT_INT64,    0,                     0,
         (QofAccessFunc)get_int64_val,    (QofSetterFunc)set_int64_val
     },
     {
-        "string_val",   CT_STRING,   SLOT_MAX_PATHNAME_LEN, 0,        NULL, NULL,
+        "string_val",   CT_STRING,   SLOT_MAX_PATHNAME_LEN, 0,
         (QofAccessFunc)get_string_val,   set_string_val
     },
     {
-        "double_val",   CT_DOUBLE,   0,                     0,        NULL, NULL,
+        "double_val",   CT_DOUBLE,   0,                     0,
         (QofAccessFunc)get_double_val,   set_double_val
     },
     {
-        "timespec_val", CT_TIMESPEC, 0,                     0,        NULL, NULL,
+        "timespec_val", CT_TIMESPEC, 0,                     0,
         (QofAccessFunc)get_timespec_val, (QofSetterFunc)set_timespec_val
     },
     {
-        "guid_val",     CT_GUID,     0,                     0,        NULL, NULL,
+        "guid_val",     CT_GUID,     0,                     0,
         (QofAccessFunc)get_guid_val,     set_guid_val
     },
     {
-        "numeric_val",  CT_NUMERIC,  0,                     0,        NULL, NULL,
+        "numeric_val",  CT_NUMERIC,  0,                     0,
         (QofAccessFunc)get_numeric_val, (QofSetterFunc)set_numeric_val
     },
     {
-        "gdate_val",    CT_GDATE,    0,                     0,        NULL, NULL,
+        "gdate_val",    CT_GDATE,    0,                     0,
         (QofAccessFunc)get_gdate_val, (QofSetterFunc)set_gdate_val
     },
     { NULL }
@@ -164,7 +166,7 @@ a column other than the primary key */
 static const GncSqlColumnTableEntry obj_guid_col_table[] =
 {
     /*@ -full_init_block @*/
-    { "obj_guid", CT_GUID, 0, 0, NULL, NULL, (QofAccessFunc)get_obj_guid, _retrieve_guid_ },
+    { "obj_guid", CT_GUID, 0, 0, (QofAccessFunc)get_obj_guid, _retrieve_guid_ },
     { NULL }
     /*@ +full_init_block @*/
 };
@@ -706,26 +708,489 @@ save_slot( const gchar* key, KvpValue* value, gpointer data )
     (void)g_string_truncate( pSlot_info->path, curlen );
 }
 
+/* ================================================================= */
+/* Stored slots.
+ *
+ * The backend keeps a 64-bit digest of each object's frame as it was last
+ * loaded from or written to the db.  A commit whose frame still has that
+ * digest has no slots to write, so it doesn't touch the db at all; only a
+ * commit whose slots really changed reads them back to diff against.  An
+ * entry costs about 60 bytes per object, where a copy of a four-slot frame
+ * cost nearly 1 KB.
+ */
+static guint64
+digest_mix( guint64 h )
+{
+    h ^= h >> 33;
+    h *= G_GUINT64_CONSTANT( 0xff51afd7ed558ccd );
+    h ^= h >> 33;
+    h *= G_GUINT64_CONSTANT( 0xc4ceb9fe1a85ec53 );
+    h ^= h >> 33;
+    return h;
+}
+
+static guint64
+digest_bytes( guint64 h, gconstpointer data, gsize len )
+{
+    const guchar* p = (const guchar*)data;
+    gsize i;
+
+    for ( i = 0; i < len; i++ )
+    {
+        h ^= p[i];
+        h *= G_GUINT64_CONSTANT( 0x100000001b3 );
+    }
+    return h;
+}
+
+static guint64
+digest_string( guint64 h, const gchar* str )
+{
+    if ( str == NULL )
+    {
+        return digest_mix( h );
+    }
+    do
+    {
+        h ^= (guchar) * str;
+        h *= G_GUINT64_CONSTANT( 0x100000001b3 );
+    }
+    while ( *str++ != '\0' );
+    return h;
+}
+
+static guint64 digest_frame( KvpFrame* pFrame );
+
+static guint64
+digest_value( const KvpValue* value )
+{
+    guint64 h = digest_mix( G_GUINT64_CONSTANT( 0xcbf29ce484222325 )
+                            + (guint64)kvp_value_get_type( value ) );
+
+    switch ( kvp_value_get_type( value ) )
+    {
+    case KVP_TYPE_GINT64:
+    {
+        gint64 i64 = kvp_value_get_gint64( value );
+        h = digest_bytes( h, &i64, sizeof(i64) );
+    }
+    break;
+    case KVP_TYPE_DOUBLE:
+    {
+        double d = kvp_value_get_double( value );
+        h = digest_bytes( h, &d, sizeof(d) );
+    }
+    break;
+    case KVP_TYPE_NUMERIC:
+    {
+        gnc_numeric n = kvp_value_get_numeric( value );
+        h = digest_bytes( h, &n.num, sizeof(n.num) );
+        h = digest_bytes( h, &n.denom, sizeof(n.denom) );
+    }
+    break;
+    case KVP_TYPE_STRING:
+        h = digest_string( h, kvp_value_get_string( value ) );
+        break;
+    case KVP_TYPE_GUID:
+    {
+        GncGUID* guid = kvp_value_get_guid( value );
+        if ( guid != NULL )
+        {
+            h = digest_bytes( h, guid, sizeof(GncGUID) );
+        }
+    }
+    break;
+    case KVP_TYPE_TIMESPEC:
+    {
+        Timespec ts = kvp_value_get_timespec( value );
+        h = digest_bytes( h, &ts.tv_sec, sizeof(ts.tv_sec) );
+        h = digest_bytes( h, &ts.tv_nsec, sizeof(ts.tv_nsec) );
+    }
+    break;
+    case KVP_TYPE_BINARY:
+    {
+        uint64_t size = 0;
+        void* data = kvp_value_get_binary( value, &size );
+        if ( data != NULL )
+        {
+            h = digest_bytes( h, data, (gsize)size );
+        }
+    }
+    break;
+    case KVP_TYPE_GLIST:
+    {
+        GList* node;
+        /* List members are ordered, so fold them in one after another */
+        for ( node = kvp_value_get_glist( value ); node != NULL; node = node->next )
+        {
+            h = digest_mix( h + digest_value( (const KvpValue*)node->data ) );
+        }
+    }
+    break;
+    case KVP_TYPE_FRAME:
+        h ^= digest_frame( kvp_value_get_frame( value ) );
+        break;
+    case KVP_TYPE_GDATE:
+    {
+        GDate date = kvp_value_get_gdate( value );
+        guint32 julian = g_date_valid( &date ) ? g_date_get_julian( &date ) : 0;
+        h = digest_bytes( h, &julian, sizeof(julian) );
+    }
+    break;
+    default:
+        break;
+    }
+
+    return digest_mix( h );
+}
+
+static void
+digest_slot( const gchar* key, KvpValue* value, gpointer data )
+{
+    guint64* pDigest = (guint64*)data;
+
+    /* A frame's slots come out in hash table order, so their digests are
+     * summed rather than chained. */
+    *pDigest += digest_mix( digest_string( G_GUINT64_CONSTANT( 0xcbf29ce484222325 ), key )
+                            ^ digest_value( value ) );
+}
+
+static guint64
+digest_frame( KvpFrame* pFrame )
+{
+    guint64 digest = 0;
+
+    if ( pFrame != NULL )
+    {
+        kvp_frame_for_each_slot( pFrame, digest_slot, &digest );
+    }
+    return digest;
+}
+
+static void
+remember_slots( GncSqlBackend* be, const GncGUID* guid, KvpFrame* pFrame )
+{
+    guint64* pDigest;
+
+    g_return_if_fail( be != NULL );
+    g_return_if_fail( guid != NULL );
+    g_return_if_fail( pFrame != NULL );
+
+    if ( be->stored_slots == NULL )
+    {
+        be->stored_slots = g_hash_table_new_full( guid_hash_to_guint,
+                           guid_g_hash_table_equal,
+                           (GDestroyNotify)guid_free,
+                           g_free );
+    }
+    pDigest = g_new( guint64, 1 );
+    *pDigest = digest_frame( pFrame );
+    g_hash_table_replace( be->stored_slots, guid_copy( guid ), pDigest );
+}
+
+static void
+forget_slots( GncSqlBackend* be, const GncGUID* guid )
+{
+    g_return_if_fail( be != NULL );
+    g_return_if_fail( guid != NULL );
+
+    if ( be->stored_slots != NULL )
+    {
+        (void)g_hash_table_remove( be->stored_slots, guid );
+    }
+}
+
+void
+gnc_sql_slots_forget_all( GncSqlBackend* be )
+{
+    g_return_if_fail( be != NULL );
+
+    if ( be->stored_slots != NULL )
+    {
+        g_hash_table_destroy( be->stored_slots );
+        be->stored_slots = NULL;
+    }
+}
+
+/* ================================================================= */
+/* Slot diffing.
+ *
+ * When an object which is already in the db is committed, the slots
+ * currently stored for it are compared with the object's frame.  Only the
+ * slots which were added, changed or removed are written.  Frames which exist on both sides are diffed recursively so
+ * that a change deep in a frame doesn't rewrite its siblings.  Lists have no
+ * stable identity for their members, so a changed list is replaced whole.
+ */
+typedef struct
+{
+    /*@ dependent @*/ GncSqlBackend* be;
+    /*@ dependent @*/ const GncGUID* guid;
+    /*@ dependent @*/ KvpFrame* pNewFrame;
+    /*@ dependent @*/ KvpFrame* pStoredFrame;
+    GString* path;
+    gboolean is_ok;
+} slot_diff_info_t;
+
+static gboolean diff_frame( GncSqlBackend* be, const GncGUID* guid, const gchar* path,
+                            KvpFrame* pNewFrame, KvpFrame* pStoredFrame );
+
+/* Looks up the guid of the frame or list a stored slot refers to. */
+static gboolean
+get_child_guid( GncSqlBackend* be, const gchar* guid_buf, const gchar* quoted_name,
+                GncGUID* child_guid )
+{
+    gchar* buf;
+    GncSqlResult* result;
+    gboolean found = FALSE;
+
+    buf = g_strdup_printf( "SELECT %s FROM %s WHERE obj_guid='%s' and name=%s and not guid_val is null",
+                           col_table[guid_val_col].col_name, TABLE_NAME, guid_buf, quoted_name );
+    result = gnc_sql_execute_select_sql( be, buf );
+    g_free( buf );
+    if ( result != NULL )
+    {
+        GncSqlRow* row = gnc_sql_result_get_first_row( result );
+        if ( row != NULL )
+        {
+            const GValue* val =
+                gnc_sql_row_get_value_at_col_name( row, col_table[guid_val_col].col_name );
+            if ( val != NULL && G_VALUE_HOLDS_STRING( val ) && g_value_get_string( val ) != NULL )
+            {
+                found = string_to_guid( g_value_get_string( val ), child_guid );
+            }
+        }
+        gnc_sql_result_dispose( result );
+    }
+
+    return found;
+}
+
+/* Deletes a single stored slot, and the frame or list it refers to. */
+static gboolean
+delete_slot_by_path( GncSqlBackend* be, const GncGUID* guid, const gchar* path,
+                     KvpValueType value_type )
+{
+    gchar guid_buf[GUID_ENCODING_LENGTH + 1];
+    gchar* quoted_name;
+    gchar* buf;
+    gboolean ok = TRUE;
+
+    (void)guid_to_string_buff( guid, guid_buf );
+    quoted_name = gnc_sql_connection_quote_string( be->conn, (gchar*)path );
+
+    if ( value_type == KVP_TYPE_FRAME || value_type == KVP_TYPE_GLIST )
+    {
+        GncGUID child_guid;
+        if ( get_child_guid( be, guid_buf, quoted_name, &child_guid ) )
+        {
+            ok = gnc_sql_slots_delete( be, &child_guid );
+        }
+    }
+
+    buf = g_strdup_printf( "DELETE FROM %s WHERE obj_guid='%s' and name=%s",
+                           TABLE_NAME, guid_buf, quoted_name );
+    if ( gnc_sql_execute_nonselect_sql( be, buf ) == -1 )
+    {
+        PERR( "SQL error: %s\n", buf );
+        qof_backend_set_error( &be->be, ERR_BACKEND_SERVER_ERR );
+        ok = FALSE;
+    }
+    g_free( buf );
+    g_free( quoted_name );
+
+    return ok;
+}
+
+/* Writes a slot which is new or changed relative to the stored frame */
+static void
+diff_new_slot( const gchar* key, KvpValue* value, gpointer data )
+{
+    slot_diff_info_t* pDiff = (slot_diff_info_t*)data;
+    KvpValue* stored;
+    gsize curlen;
+
+    g_return_if_fail( key != NULL );
+    g_return_if_fail( value != NULL );
+    g_return_if_fail( data != NULL );
+
+    if ( !pDiff->is_ok ) return;
+
+    stored = kvp_frame_get_slot( pDiff->pStoredFrame, key );
+    if ( stored != NULL && kvp_value_compare( stored, value ) == 0 )
+    {
+        return;
+    }
+
+    curlen = pDiff->path->len;
+    if ( stored != NULL
+            && kvp_value_get_type( stored ) == KVP_TYPE_FRAME
+            && kvp_value_get_type( value ) == KVP_TYPE_FRAME )
+    {
+        gchar guid_buf[GUID_ENCODING_LENGTH + 1];
+        gchar* quoted_name;
+        GncGUID child_guid;
+        gboolean found;
+
+        if ( curlen != 0 )
+        {
+            (void)g_string_append( pDiff->path, "/" );
+        }
+        (void)g_string_append( pDiff->path, key );
+
+        (void)guid_to_string_buff( pDiff->guid, guid_buf );
+        quoted_name = gnc_sql_connection_quote_string( pDiff->be->conn, pDiff->path->str );
+        found = get_child_guid( pDiff->be, guid_buf, quoted_name, &child_guid );
+        g_free( quoted_name );
+        if ( found )
+        {
+            pDiff->is_ok = diff_frame( pDiff->be, &child_guid, pDiff->path->str,
+                                       kvp_value_get_frame( value ),
+                                       kvp_value_get_frame( stored ) );
+            (void)g_string_truncate( pDiff->path, curlen );
+            return;
+        }
+        (void)g_string_truncate( pDiff->path, curlen );
+    }
+
+    if ( stored != NULL )
+    {
+        gchar* path;
+
+        if ( curlen != 0 )
+        {
+            path = g_strdup_printf( "%s/%s", pDiff->path->str, key );
+        }
+        else
+        {
+            path = g_strdup( key );
+        }
+        pDiff->is_ok = delete_slot_by_path( pDiff->be, pDiff->guid, path,
+                                            kvp_value_get_type( stored ) );
+        g_free( path );
+        if ( !pDiff->is_ok ) return;
+    }
+
+    {
+        slot_info_t slot_info = { NULL, NULL, TRUE, NULL, 0, NULL, FRAME, NULL, NULL };
+
+        slot_info.be = pDiff->be;
+        slot_info.guid = pDiff->guid;
+        slot_info.path = g_string_new( pDiff->path->str );
+        save_slot( key, value, &slot_info );
+        (void)g_string_free( slot_info.path, TRUE );
+        pDiff->is_ok = slot_info.is_ok;
+    }
+}
+
+/* Deletes a stored slot which no longer exists in the object's frame */
+static void
+diff_removed_slot( const gchar* key, KvpValue* value, gpointer data )
+{
+    slot_diff_info_t* pDiff = (slot_diff_info_t*)data;
+    gchar* path;
+
+    g_return_if_fail( key != NULL );
+    g_return_if_fail( value != NULL );
+    g_return_if_fail( data != NULL );
+
+    if ( !pDiff->is_ok ) return;
+    if ( kvp_frame_get_slot( pDiff->pNewFrame, key ) != NULL ) return;
+
+    if ( pDiff->path->len != 0 )
+    {
+        path = g_strdup_printf( "%s/%s", pDiff->path->str, key );
+    }
+    else
+    {
+        path = g_strdup( key );
+    }
+    pDiff->is_ok = delete_slot_by_path( pDiff->be, pDiff->guid, path,
+                                        kvp_value_get_type( value ) );
+    g_free( path );
+}
+
+static gboolean
+diff_frame( GncSqlBackend* be, const GncGUID* guid, const gchar* path,
+            KvpFrame* pNewFrame, KvpFrame* pStoredFrame )
+{
+    slot_diff_info_t diff_info;
+
+    diff_info.be = be;
+    diff_info.guid = guid;
+    diff_info.pNewFrame = pNewFrame;
+    diff_info.pStoredFrame = pStoredFrame;
+    diff_info.path = g_string_new( path );
+    diff_info.is_ok = TRUE;
+
+    kvp_frame_for_each_slot( pStoredFrame, diff_removed_slot, &diff_info );
+    kvp_frame_for_each_slot( pNewFrame, diff_new_slot, &diff_info );
+    (void)g_string_free( diff_info.path, TRUE );
+
+    return diff_info.is_ok;
+}
+
 gboolean
 gnc_sql_slots_save( GncSqlBackend* be, const GncGUID* guid, gboolean is_infant, KvpFrame* pFrame )
 {
-    slot_info_t slot_info = { NULL, NULL, TRUE, NULL, 0, NULL, FRAME, NULL, g_string_new('\0') };
+    slot_info_t slot_info = { NULL, NULL, TRUE, NULL, 0, NULL, FRAME, NULL, NULL };
 
     g_return_val_if_fail( be != NULL, FALSE );
     g_return_val_if_fail( guid != NULL, FALSE );
     g_return_val_if_fail( pFrame != NULL, FALSE );
 
-    // If this is not saving into a new db, clear out the old saved slots first
+    // If this is not saving into a new db, only write what differs from the
+    // slots already stored for the object.
     if ( !be->is_pristine_db && !is_infant )
     {
-        (void)gnc_sql_slots_delete( be, guid );
+        KvpFrame* pStoredFrame;
+        gboolean is_ok;
+
+        if ( be->stored_slots != NULL )
+        {
+            guint64* pDigest = (guint64*)g_hash_table_lookup( be->stored_slots, guid );
+            if ( pDigest != NULL && *pDigest == digest_frame( pFrame ) )
+            {
+                return TRUE;
+            }
+        }
+
+        pStoredFrame = kvp_frame_new();
+        slot_info.be = be;
+        slot_info.guid = guid;
+        slot_info.pKvpFrame = pStoredFrame;
+        slot_info.context = NONE;
+        slot_info.path = g_string_new( NULL );
+        slots_load_info( &slot_info );
+        (void)g_string_free( slot_info.path, TRUE );
+
+        is_ok = diff_frame( be, guid, "", pFrame, pStoredFrame );
+        kvp_frame_delete( pStoredFrame );
+
+        if ( is_ok )
+        {
+            remember_slots( be, guid, pFrame );
+        }
+        else
+        {
+            forget_slots( be, guid );
+        }
+        return is_ok;
     }
 
     slot_info.be = be;
     slot_info.guid = guid;
+    slot_info.path = g_string_new( NULL );
     kvp_frame_for_each_slot( pFrame, save_slot, &slot_info );
     (void)g_string_free( slot_info.path, TRUE );
 
+    if ( slot_info.is_ok )
+    {
+        remember_slots( be, guid, pFrame );
+    }
+    else
+    {
+        forget_slots( be, guid );
+    }
     return slot_info.is_ok;
 }
 
@@ -741,6 +1206,7 @@ gnc_sql_slots_delete( GncSqlBackend* be, const GncGUID* guid )
     g_return_val_if_fail( be != NULL, FALSE );
     g_return_val_if_fail( guid != NULL, FALSE );
 
+    forget_slots( be, guid );
     (void)guid_to_string_buff( guid, guid_buf );
 
     buf = g_strdup_printf( "SELECT * FROM %s WHERE obj_guid='%s' and slot_type in ('%d', '%d') and not guid_val is null",
@@ -782,7 +1248,7 @@ gnc_sql_slots_delete( GncSqlBackend* be, const GncGUID* guid )
 }
 
 static void
-load_slot( slot_info_t *pInfo, GncSqlRow* row )
+load_slot( slot_info_t *pInfo, GncSqlRow* row, /*@ null @*/ const GncSqlColumnIndexMap* map )
 {
     slot_info_t *slot_info;
 
@@ -795,7 +1261,7 @@ load_slot( slot_info_t *pInfo, GncSqlRow* row )
     g_string_free( slot_info->path, TRUE );
     slot_info->path = NULL;
 
-    gnc_sql_load_object( pInfo->be, row, TABLE_NAME, slot_info, col_table );
+    gnc_sql_load_object_mapped( pInfo->be, row, TABLE_NAME, slot_info, col_table, map );
 
     if ( slot_info->path != NULL )
     {
@@ -828,6 +1294,7 @@ gnc_sql_slots_load( GncSqlBackend* be, QofInstance* inst )
     info.context = NONE;
 
     slots_load_info( &info );
+    remember_slots( be, info.guid, info.pKvpFrame );
 }
 
 static void
@@ -855,33 +1322,39 @@ slots_load_info ( slot_info_t *pInfo )
         gnc_sql_statement_dispose( stmt );
         if ( result != NULL )
         {
+            GncSqlColumnIndexMap* map =
+                gnc_sql_result_map_columns( pInfo->be, result, TABLE_NAME, col_table );
             GncSqlRow* row = gnc_sql_result_get_first_row( result );
 
             while ( row != NULL )
             {
-                load_slot( pInfo, row );
+                load_slot( pInfo, row, map );
                 row = gnc_sql_result_get_next_row( result );
             }
+            gnc_sql_column_index_map_free( map );
             gnc_sql_result_dispose( result );
         }
     }
 }
 
 static /*@ dependent @*//*@ null @*/ const GncGUID*
-load_obj_guid( const GncSqlBackend* be, GncSqlRow* row )
+load_obj_guid( const GncSqlBackend* be, GncSqlRow* row,
+               /*@ null @*/ const GncSqlColumnIndexMap* map )
 {
     static GncGUID guid;
 
     g_return_val_if_fail( be != NULL, NULL );
     g_return_val_if_fail( row != NULL, NULL );
 
-    gnc_sql_load_object( be, row, NULL, &guid, obj_guid_col_table );
+    gnc_sql_load_object_mapped( be, row, NULL, &guid, obj_guid_col_table, map );
 
     return &guid;
 }
 
 static void
-load_slot_for_list_item( GncSqlBackend* be, GncSqlRow* row, QofCollection* coll )
+load_slot_for_list_item( GncSqlBackend* be, GncSqlRow* row, QofCollection* coll,
+                         /*@ null @*/ const GncSqlColumnIndexMap* guid_map,
+                         /*@ null @*/ const GncSqlColumnIndexMap* map )
 {
     slot_info_t slot_info = { NULL, NULL, TRUE, NULL, 0, NULL, FRAME, NULL, NULL };
     const GncGUID* guid;
@@ -891,7 +1364,7 @@ load_slot_for_list_item( GncSqlBackend* be, GncSqlRow* row, QofCollection* coll
     g_return_if_fail( row != NULL );
     g_return_if_fail( coll != NULL );
 
-    guid = load_obj_guid( be, row );
+    guid = load_obj_guid( be, row, guid_map );
     g_assert( guid != NULL );
     inst = qof_collection_lookup_entity( coll, guid );
 
@@ -899,7 +1372,7 @@ load_slot_for_list_item( GncSqlBackend* be, GncSqlRow* row, QofCollection* coll
     slot_info.pKvpFrame = qof_instance_get_slots( inst );
     slot_info.context = NONE;
 
-    gnc_sql_load_object( be, row, TABLE_NAME, &slot_info, col_table );
+    gnc_sql_load_object_mapped( be, row, TABLE_NAME, &slot_info, col_table, map );
 
     if ( slot_info.path != NULL )
     {
@@ -955,43 +1428,69 @@ gnc_sql_slots_load_for_list( GncSqlBackend* be, GList* list )
     gnc_sql_statement_dispose( stmt );
     if ( result != NULL )
     {
+        GncSqlColumnIndexMap* guid_map =
+            gnc_sql_result_map_columns( be, result, NULL, obj_guid_col_table );
+        GncSqlColumnIndexMap* map =
+            gnc_sql_result_map_columns( be, result, TABLE_NAME, col_table );
         GncSqlRow* row = gnc_sql_result_get_first_row( result );
 
         while ( row != NULL )
         {
-            load_slot_for_list_item( be, row, coll );
+            load_slot_for_list_item( be, row, coll, guid_map, map );
+            qof_backend_load_yield( &be->be );
             row = gnc_sql_result_get_next_row( result );
         }
+        gnc_sql_column_index_map_free( guid_map );
+        gnc_sql_column_index_map_free( map );
         gnc_sql_result_dispose( result );
+
+        for ( ; list != NULL; list = list->next )
+        {
+            QofInstance* inst = QOF_INSTANCE(list->data);
+            remember_slots( be, qof_instance_get_guid( inst ), qof_instance_get_slots( inst ) );
+        }
     }
 }
 
-static void
-load_slot_for_book_object( GncSqlBackend* be, GncSqlRow* row, BookLookupFn lookup_fn )
+/*@ dependent @*//*@ null @*/ static QofInstance*
+load_slot_for_book_object( GncSqlBackend* be, GncSqlRow* row, BookLookupFn lookup_fn,
+                           /*@ null @*/ const GncSqlColumnIndexMap* guid_map,
+                           /*@ null @*/ const GncSqlColumnIndexMap* map )
 {
     slot_info_t slot_info = { NULL, NULL, TRUE, NULL, 0, NULL, FRAME, NULL, NULL };
     const GncGUID* guid;
     QofInstance* inst;
 
-    g_return_if_fail( be != NULL );
-    g_return_if_fail( row != NULL );
-    g_return_if_fail( lookup_fn != NULL );
+    g_return_val_if_fail( be != NULL, NULL );
+    g_return_val_if_fail( row != NULL, NULL );
+    g_return_val_if_fail( lookup_fn != NULL, NULL );
 
-    guid = load_obj_guid( be, row );
-    g_return_if_fail( guid != NULL );
+    guid = load_obj_guid( be, row, guid_map );
+    g_return_val_if_fail( guid != NULL, NULL );
     inst = lookup_fn( guid, be->book );
-    g_return_if_fail( inst != NULL );
+    g_return_val_if_fail( inst != NULL, NULL );
 
     slot_info.be = be;
     slot_info.pKvpFrame = qof_instance_get_slots( inst );
     slot_info.path = NULL;
 
-    gnc_sql_load_object( be, row, TABLE_NAME, &slot_info, col_table );
+    gnc_sql_load_object_mapped( be, row, TABLE_NAME, &slot_info, col_table, map );
 
     if ( slot_info.path != NULL )
     {
         (void)g_string_free( slot_info.path, TRUE );
     }
+
+    return inst;
+}
+
+static void
+remember_instance_slots( gpointer key, /*@ unused @*/ gpointer value, gpointer be )
+{
+    QofInstance* inst = (QofInstance*)key;
+
+    remember_slots( (GncSqlBackend*)be, qof_instance_get_guid( inst ),
+                    qof_instance_get_slots( inst ) );
 }
 
 /**
@@ -1032,14 +1531,31 @@ void gnc_sql_slots_load_for_sql_subquery( GncSqlBackend* be, const gchar* subque
     gnc_sql_statement_dispose( stmt );
     if ( result != NULL )
     {
+        GncSqlColumnIndexMap* guid_map =
+            gnc_sql_result_map_columns( be, result, NULL, obj_guid_col_table );
+        GncSqlColumnIndexMap* map =
+            gnc_sql_result_map_columns( be, result, TABLE_NAME, col_table );
         GncSqlRow* row = gnc_sql_result_get_first_row( result );
+        /* Objects without any slots don't show up here; their first commit
+         * reads the (empty) stored slots from the db instead. */
+        GHashTable* loaded = g_hash_table_new( g_direct_hash, g_direct_equal );
 
         while ( row != NULL )
         {
-            load_slot_for_book_object( be, row, lookup_fn );
+            QofInstance* inst = load_slot_for_book_object( be, row, lookup_fn, guid_map, map );
+            if ( inst != NULL )
+            {
+                g_hash_table_insert( loaded, inst, inst );
+            }
+            qof_backend_load_yield( &be->be );
             row = gnc_sql_result_get_next_row( result );
         }
+        gnc_sql_column_index_map_free( guid_map );
+        gnc_sql_column_index_map_free( map );
         gnc_sql_result_dispose( result );
+
+        g_hash_table_foreach( loaded, remember_instance_slots, be );
+        g_hash_table_destroy( loaded );
     }
 }
 
@@ -1102,9 +1618,6 @@ gnc_sql_init_slots_handler( void )
         NULL,                    /* commit - cannot occur */
         NULL,                    /* initial_load - cannot occur */
         create_slots_tables,     /* create_tables */
-        NULL,                    /* compile_query */
-        NULL,                    /* run_query */
-        NULL,                    /* free_query */
         NULL                     /* write */
     };
 
@@ -36,7 +36,11 @@
 #include "gnc-backend-sql.h"
 
 /**
- * gnc_sql_slots_save - Saves slots for an object to the db.
+ * gnc_sql_slots_save - Saves slots for an object to the db.  If the object
+ * is already in the db, the stored slots are compared with pFrame and only
+ * the slots which were added, changed or removed are written.  If pFrame
+ * matches the digest kept when the object's slots were last loaded or
+ * saved, nothing is read or written.
  *
  * @param be SQL backend
  * @param guid Object guid
@@ -86,6 +90,16 @@ typedef QofInstance* (*BookLookupFn)( const GncGUID* guid, const QofBook* book )
 void gnc_sql_slots_load_for_sql_subquery( GncSqlBackend* be, const gchar* subquery,
         BookLookupFn lookup_fn );
 
+/**
+ * gnc_sql_slots_forget_all - Drops the digests of the stored slots which
+ * gnc_sql_slots_save checks commits against.  Must be called whenever the slots table
+ * may no longer match them, e.g. after a rolled back commit, and when the
+ * backend is closed.
+ *
+ * @param be SQL backend
+ */
+void gnc_sql_slots_forget_all( GncSqlBackend* be );
+
 void gnc_sql_init_slots_handler( void );
 
 #endif /* GNC_SLOTS_SQL_H */
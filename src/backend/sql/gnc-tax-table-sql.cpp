@@ -52,7 +52,8 @@ typedef struct
     const GncGUID* guid;
 } guid_info_t;
 
-static gpointer get_obj_guid( gpointer pObject, const QofParam* param );
+static gpointer get_obj_guid( gpointer pObject );
+static void tt_set_invisible( gpointer data, bool value );
 static void set_obj_guid( gpointer pObject, gpointer pValue );
 static gpointer bt_get_parent( gpointer pObject );
 static void tt_set_parent( gpointer pObject, gpointer pValue );
@@ -65,14 +66,26 @@ static void tt_set_parent_guid( gpointer pObject, gpointer pValue );
 
 static GncSqlColumnTableEntry tt_col_table[] =
 {
-    { "guid",      CT_GUID,        0,            COL_NNUL | COL_PKEY, "guid" },
-    { "name",      CT_STRING,      MAX_NAME_LEN, COL_NNUL,          "name" },
-    { "refcount",  CT_INT64,       0,            COL_NNUL,          "ref-count" },
-    { "invisible", CT_BOOLEAN,     0,            COL_NNUL,          "invisible" },
-    /*	{ "child",     CT_TAXTABLEREF, 0,			 0,                 NULL, NULL,
+    {
+        "guid", CT_GUID, 0, COL_NNUL | COL_PKEY,
+        (QofAccessFunc)qof_instance_get_guid, (QofSetterFunc)qof_instance_set_guid
+    },
+    {
+        "name", CT_STRING, MAX_NAME_LEN, COL_NNUL,
+        (QofAccessFunc)gncTaxTableGetName, (QofSetterFunc)gncTaxTableSetName
+    },
+    {
+        "refcount", CT_INT64, 0, COL_NNUL,
+        (QofAccessFunc)gncTaxTableGetRefcount, (QofSetterFunc)gncTaxTableSetRefcount
+    },
+    {
+        "invisible", CT_BOOLEAN, 0, COL_NNUL,
+        (QofAccessFunc)gncTaxTableGetInvisible, (QofSetterFunc)tt_set_invisible
+    },
+    /*	{ "child",     CT_TAXTABLEREF, 0,			 0,
     			get_child, (QofSetterFunc)gncTaxTableSetChild }, */
     {
-        "parent",    CT_GUID,        0,			 0,                 NULL, NULL,
+        "parent",    CT_GUID,        0,			 0,
         (QofAccessFunc)bt_get_parent, tt_set_parent
     },
     { NULL }
@@ -80,7 +93,7 @@ static GncSqlColumnTableEntry tt_col_table[] =
 
 static GncSqlColumnTableEntry tt_parent_col_table[] =
 {
-    { "parent", CT_GUID, 0, 0, NULL, NULL, NULL, tt_set_parent_guid },
+    { "parent", CT_GUID, 0, 0, NULL, tt_set_parent_guid },
     { NULL }
 };
 
@@ -91,19 +104,19 @@ static GncSqlColumnTableEntry ttentries_col_table[] =
 {
     { "id",       CT_INT,         0, COL_PKEY | COL_NNUL | COL_AUTOINC },
     {
-        "taxtable", CT_TAXTABLEREF, 0, COL_NNUL, NULL, NULL,
+        "taxtable", CT_TAXTABLEREF, 0, COL_NNUL,
         (QofAccessFunc)gncTaxTableEntryGetTable, set_obj_guid
     },
     {
-        "account",  CT_ACCOUNTREF,  0, COL_NNUL, NULL, NULL,
+        "account",  CT_ACCOUNTREF,  0, COL_NNUL,
         (QofAccessFunc)gncTaxTableEntryGetAccount, (QofSetterFunc)gncTaxTableEntrySetAccount
     },
     {
-        "amount",   CT_NUMERIC,     0, COL_NNUL, NULL, NULL,
+        "amount",   CT_NUMERIC,     0, COL_NNUL,
         (QofAccessFunc)gncTaxTableEntryGetAmount, (QofSetterFunc)gncTaxTableEntrySetAmount
     },
     {
-        "type",     CT_INT,         0, COL_NNUL, NULL, NULL,
+        "type",     CT_INT,         0, COL_NNUL,
         (QofAccessFunc)gncTaxTableEntryGetType, (QofSetterFunc)gncTaxTableEntrySetType
     },
     { NULL }
@@ -113,7 +126,7 @@ static GncSqlColumnTableEntry ttentries_col_table[] =
 a column other than the primary key */
 static GncSqlColumnTableEntry guid_col_table[] =
 {
-    { "taxtable", CT_GUID, 0, 0, NULL, NULL, get_obj_guid, set_obj_guid },
+    { "taxtable", CT_GUID, 0, 0, (QofAccessFunc)get_obj_guid, set_obj_guid },
     { NULL }
 };
 
@@ -125,7 +138,7 @@ typedef struct
 } taxtable_parent_guid_struct;
 
 static gpointer
-get_obj_guid( gpointer pObject, const QofParam* param )
+get_obj_guid( gpointer pObject )
 {
     guid_info_t* pInfo = (guid_info_t*)pObject;
 
@@ -139,9 +152,22 @@ set_obj_guid( gpointer pObject, gpointer pValue )
 {
     // Nowhere to put the GncGUID
 }
+
+static void
+tt_set_invisible( gpointer data, bool value )
+{
+    GncTaxTable* tt = (GncTaxTable*)data;
+
+    g_return_if_fail( tt != NULL );
+
+    if ( value )
+    {
+        gncTaxTableMakeInvisible( tt );
+    }
+}
 #if 0 /* Not Used */
 static gpointer
-get_child( gpointer pObject, const QofParam* param )
+get_child( gpointer pObject )
 {
     GncTaxTable* tt = (GncTaxTable*)(pObject);
 
@@ -450,13 +476,13 @@ save_taxtable( GncSqlBackend* be, QofInstance* inst )
     {
         op = OP_DB_DELETE;
     }
-    else if ( be->is_pristine_db || is_infant )
+    else if ( be->is_pristine_db )
     {
         op = OP_DB_INSERT;
     }
     else
     {
-        op = OP_DB_UPDATE;
+        op = OP_DB_UPSERT;
     }
     is_ok = gnc_sql_do_db_operation( be, op, TT_TABLE_NAME, GNC_ID_TAXTABLE, tt, tt_col_table );
 
@@ -533,14 +559,7 @@ load_taxtable_guid( const GncSqlBackend* be, GncSqlRow* row,
         taxtable = gncTaxTableLookup( be->book, &guid );
         if ( taxtable != NULL )
         {
-            if ( table_row->gobj_param_name != NULL )
-            {
-                g_object_set( pObject, table_row->gobj_param_name, taxtable, NULL );
-            }
-            else
-            {
-                (*setter)( pObject, (const gpointer)taxtable );
-            }
+            (*setter)( pObject, (const gpointer)taxtable );
         }
         else
         {
@@ -566,7 +585,6 @@ gnc_taxtable_sql_initialize( void )
         save_taxtable,						/* commit */
         load_all_taxtables,					/* initial_load */
         create_taxtable_tables,				/* create_tables */
-        NULL, NULL, NULL,
         write_taxtables						/* write */
     };
 
@@ -31,12 +31,13 @@
 #include <glib/gi18n.h>
 
 #include "qof.h"
-#include "qofquery-p.h"
-#include "qofquerycore-p.h"
 
 #include "Account.h"
 #include "Transaction.h"
+#include "TransactionP.h"
+#include "SplitP.h"
 #include "gnc-lot.h"
+#include "SX-book.h"
 #include "engine-helpers.h"
 
 #include "gnc-backend-sql.h"
@@ -53,9 +54,6 @@
 #include "splint-defs.h"
 #endif
 
-#define SIMPLE_QUERY_COMPILATION 1
-#define LOAD_TRANSACTIONS_AS_NEEDED 0
-
 static QofLogModule log_module = G_LOG_DOMAIN;
 
 #define TRANSACTION_TABLE "transactions"
@@ -74,15 +72,36 @@ typedef struct
 #define TX_MAX_NUM_LEN 2048
 #define TX_MAX_DESCRIPTION_LEN 2048
 
+static void set_tx_post_date( gpointer pObject, Timespec ts );
+static void set_tx_enter_date( gpointer pObject, Timespec ts );
+
 static const GncSqlColumnTableEntry tx_col_table[] =
 {
     /*@ -full_init_block @*/
-    { "guid",          CT_GUID,           0,                      COL_NNUL | COL_PKEY, "guid" },
-    { "currency_guid", CT_COMMODITYREF,   0,                      COL_NNUL,          "currency" },
-    { "num",           CT_STRING,         TX_MAX_NUM_LEN,         COL_NNUL,          "num" },
-    { "post_date",     CT_TIMESPEC,       0,                      0,                 "post-date" },
-    { "enter_date",    CT_TIMESPEC,       0,                      0,                 "enter-date" },
-    { "description",   CT_STRING,         TX_MAX_DESCRIPTION_LEN, 0,                 "description" },
+    {
+        "guid", CT_GUID, 0, COL_NNUL | COL_PKEY,
+        (QofAccessFunc)qof_instance_get_guid, (QofSetterFunc)qof_instance_set_guid
+    },
+    {
+        "currency_guid", CT_COMMODITYREF, 0, COL_NNUL,
+        (QofAccessFunc)xaccTransGetCurrency, (QofSetterFunc)xaccTransSetCurrency
+    },
+    {
+        "num", CT_STRING, TX_MAX_NUM_LEN, COL_NNUL,
+        (QofAccessFunc)xaccTransGetNum, (QofSetterFunc)xaccTransSetNum
+    },
+    {
+        "post_date", CT_TIMESPEC, 0, 0,
+        (QofAccessFunc)xaccTransRetDatePostedTS, (QofSetterFunc)set_tx_post_date
+    },
+    {
+        "enter_date", CT_TIMESPEC, 0, 0,
+        (QofAccessFunc)xaccTransRetDateEnteredTS, (QofSetterFunc)set_tx_enter_date
+    },
+    {
+        "description", CT_STRING, TX_MAX_DESCRIPTION_LEN, 0,
+        (QofAccessFunc)xaccTransGetDescription, (QofSetterFunc)xaccTransSetDescription
+    },
     { NULL }
     /*@ +full_init_block @*/
 };
@@ -90,6 +109,10 @@ static const GncSqlColumnTableEntry tx_col_table[] =
 static /*@ dependent @*//*@ null @*/ gpointer get_split_reconcile_state( gpointer pObject );
 static void set_split_reconcile_state( gpointer pObject, /*@ null @*/ gpointer pValue );
 static void set_split_lot( gpointer pObject, /*@ null @*/ gpointer pLot );
+static void set_split_reconcile_date( gpointer pObject, Timespec ts );
+static void load_older_tx( GncSqlBackend* be, /*@ null @*/ const Timespec* since );
+static void remove_from_start_balances( GncSqlBackend* be, Transaction* pTx,
+                                        GHashTable* accounts );
 
 #define SPLIT_MAX_MEMO_LEN 2048
 #define SPLIT_MAX_ACTION_LEN 2048
@@ -97,20 +120,44 @@ static void set_split_lot( gpointer pObject, /*@ null @*/ gpointer pLot );
 static const GncSqlColumnTableEntry split_col_table[] =
 {
     /*@ -full_init_block @*/
-    { "guid",            CT_GUID,         0,                    COL_NNUL | COL_PKEY, "guid" },
-    { "tx_guid",         CT_TXREF,        0,                    COL_NNUL,          "transaction" },
-    { "account_guid",    CT_ACCOUNTREF,   0,                    COL_NNUL,          "account" },
-    { "memo",            CT_STRING,       SPLIT_MAX_MEMO_LEN,   COL_NNUL,          "memo" },
-    { "action",          CT_STRING,       SPLIT_MAX_ACTION_LEN, COL_NNUL,          "action" },
     {
-        "reconcile_state", CT_STRING,       1,                    COL_NNUL,          NULL, NULL,
+        "guid", CT_GUID, 0, COL_NNUL | COL_PKEY,
+        (QofAccessFunc)qof_instance_get_guid, (QofSetterFunc)qof_instance_set_guid
+    },
+    {
+        "tx_guid", CT_TXREF, 0, COL_NNUL,
+        (QofAccessFunc)xaccSplitGetParent, (QofSetterFunc)xaccSplitSetParent
+    },
+    {
+        "account_guid", CT_ACCOUNTREF, 0, COL_NNUL,
+        (QofAccessFunc)xaccSplitGetAccount, (QofSetterFunc)xaccSplitSetAccount
+    },
+    {
+        "memo", CT_STRING, SPLIT_MAX_MEMO_LEN, COL_NNUL,
+        (QofAccessFunc)xaccSplitGetMemo, (QofSetterFunc)xaccSplitSetMemo
+    },
+    {
+        "action", CT_STRING, SPLIT_MAX_ACTION_LEN, COL_NNUL,
+        (QofAccessFunc)xaccSplitGetAction, (QofSetterFunc)xaccSplitSetAction
+    },
+    {
+        "reconcile_state", CT_STRING,       1,                    COL_NNUL,
         (QofAccessFunc)get_split_reconcile_state, set_split_reconcile_state
     },
-    { "reconcile_date",  CT_TIMESPEC,     0,                    0,                 "reconcile-date" },
-    { "value",           CT_NUMERIC,      0,                    COL_NNUL,          "value" },
-    { "quantity",        CT_NUMERIC,      0,                    COL_NNUL,          "amount" },
     {
-        "lot_guid",        CT_LOTREF,       0,                    0,                 NULL, NULL,
+        "reconcile_date", CT_TIMESPEC, 0, 0,
+        (QofAccessFunc)xaccSplitRetDateReconciledTS, (QofSetterFunc)set_split_reconcile_date
+    },
+    {
+        "value", CT_NUMERIC, 0, COL_NNUL,
+        (QofAccessFunc)xaccSplitGetValue, (QofSetterFunc)xaccSplitSetValue
+    },
+    {
+        "quantity", CT_NUMERIC, 0, COL_NNUL,
+        (QofAccessFunc)xaccSplitGetAmount, (QofSetterFunc)xaccSplitSetAmount
+    },
+    {
+        "lot_guid",        CT_LOTREF,       0,                    0,
         (QofAccessFunc)xaccSplitGetLot, set_split_lot
     },
     { NULL }
@@ -120,7 +167,10 @@ static const GncSqlColumnTableEntry split_col_table[] =
 static const GncSqlColumnTableEntry post_date_col_table[] =
 {
     /*@ -full_init_block @*/
-    { "post_date", CT_TIMESPEC, 0, 0, "post-date" },
+    {
+        "post_date", CT_TIMESPEC, 0, 0,
+        (QofAccessFunc)xaccTransRetDatePostedTS, (QofSetterFunc)set_tx_post_date
+    },
     { NULL }
     /*@ +full_init_block @*/
 };
@@ -128,7 +178,10 @@ static const GncSqlColumnTableEntry post_date_col_table[] =
 static const GncSqlColumnTableEntry account_guid_col_table[] =
 {
     /*@ -full_init_block @*/
-    { "account_guid", CT_ACCOUNTREF, 0, COL_NNUL, "account" },
+    {
+        "account_guid", CT_ACCOUNTREF, 0, COL_NNUL,
+        (QofAccessFunc)xaccSplitGetAccount, (QofSetterFunc)xaccSplitSetAccount
+    },
     { NULL }
     /*@ +full_init_block @*/
 };
@@ -136,7 +189,10 @@ static const GncSqlColumnTableEntry account_guid_col_table[] =
 static const GncSqlColumnTableEntry tx_guid_col_table[] =
 {
     /*@ -full_init_block @*/
-    { "tx_guid", CT_GUID, 0, 0, "guid" },
+    {
+        "tx_guid", CT_GUID, 0, 0,
+        (QofAccessFunc)qof_instance_get_guid, (QofSetterFunc)qof_instance_set_guid
+    },
     { NULL }
     /*@ +full_init_block @*/
 };
@@ -167,7 +223,7 @@ set_split_reconcile_state( gpointer pObject, /*@ null @*/ gpointer pValue )
 
     xaccSplitSetReconcile( (Split*)(pObject), s[0] );
 }
-#if 0 /* Not Used */
+
 static void
 set_split_reconcile_date( gpointer pObject, Timespec ts )
 {
@@ -176,7 +232,22 @@ set_split_reconcile_date( gpointer pObject, Timespec ts )
 
     xaccSplitSetDateReconciledTS( (Split*)(pObject), &ts );
 }
-#endif
+
+static void
+set_tx_post_date( gpointer pObject, Timespec ts )
+{
+    g_return_if_fail( pObject != NULL );
+
+    xaccTransSetDatePostedTS( (Transaction*)(pObject), &ts );
+}
+
+static void
+set_tx_enter_date( gpointer pObject, Timespec ts )
+{
+    g_return_if_fail( pObject != NULL );
+
+    xaccTransSetDateEnteredTS( (Transaction*)(pObject), &ts );
+}
 
 static void
 set_split_lot( gpointer pObject, /*@ null @*/ gpointer pLot )
@@ -197,7 +268,9 @@ set_split_lot( gpointer pObject, /*@ null @*/ gpointer pLot )
 }
 
 static /*@ null @*/ Split*
-load_single_split( GncSqlBackend* be, GncSqlRow* row )
+load_single_split( GncSqlBackend* be, GncSqlRow* row,
+                   /*@ null @*/ const GncSqlColumnIndexMap* guid_map,
+                   /*@ null @*/ const GncSqlColumnIndexMap* split_map )
 {
     const GncGUID* guid;
     GncGUID split_guid;
@@ -206,7 +279,7 @@ load_single_split( GncSqlBackend* be, GncSqlRow* row )
     g_return_val_if_fail( be != NULL, NULL );
     g_return_val_if_fail( row != NULL, NULL );
 
-    guid = gnc_sql_load_guid( be, row );
+    guid = gnc_sql_load_guid_mapped( be, row, guid_map );
     if ( guid == NULL ) return NULL;
     split_guid = *guid;
 
@@ -219,7 +292,7 @@ load_single_split( GncSqlBackend* be, GncSqlRow* row )
     /* If the split is dirty, don't overwrite it */
     if ( !qof_instance_is_dirty( QOF_INSTANCE(pSplit) ) )
     {
-        gnc_sql_load_object( be, row, GNC_ID_SPLIT, pSplit, split_col_table );
+        gnc_sql_load_object_mapped( be, row, GNC_ID_SPLIT, pSplit, split_col_table, split_map );
     }
 
     /*# -ifempty */g_assert( pSplit == xaccSplitLookup( &split_guid, be->book ) );
@@ -248,18 +321,24 @@ load_splits_for_tx_list( GncSqlBackend* be, GList* list )
     {
         GList* split_list = NULL;
         GncSqlRow* row;
+        GncSqlColumnIndexMap* guid_map = gnc_sql_result_map_guid( be, result );
+        GncSqlColumnIndexMap* split_map =
+            gnc_sql_result_map_columns( be, result, GNC_ID_SPLIT, split_col_table );
 
         row = gnc_sql_result_get_first_row( result );
         while ( row != NULL )
         {
             Split* s;
-            s = load_single_split( be, row );
+            s = load_single_split( be, row, guid_map, split_map );
             if ( s != NULL )
             {
                 split_list = g_list_prepend( split_list, s );
             }
+            qof_backend_load_yield( &be->be );
             row = gnc_sql_result_get_next_row( result );
         }
+        gnc_sql_column_index_map_free( guid_map );
+        gnc_sql_column_index_map_free( split_map );
 
         if ( split_list != NULL )
         {
@@ -273,7 +352,9 @@ load_splits_for_tx_list( GncSqlBackend* be, GList* list )
 }
 
 static /*@ null @*/ Transaction*
-load_single_tx( GncSqlBackend* be, GncSqlRow* row )
+load_single_tx( GncSqlBackend* be, GncSqlRow* row,
+                /*@ null @*/ const GncSqlColumnIndexMap* guid_map,
+                /*@ null @*/ const GncSqlColumnIndexMap* tx_map )
 {
     const GncGUID* guid;
     GncGUID tx_guid;
@@ -282,7 +363,7 @@ load_single_tx( GncSqlBackend* be, GncSqlRow* row )
     g_return_val_if_fail( be != NULL, NULL );
     g_return_val_if_fail( row != NULL, NULL );
 
-    guid = gnc_sql_load_guid( be, row );
+    guid = gnc_sql_load_guid_mapped( be, row, guid_map );
     if ( guid == NULL ) return NULL;
     tx_guid = *guid;
 
@@ -295,7 +376,7 @@ load_single_tx( GncSqlBackend* be, GncSqlRow* row )
 
     pTx = xaccMallocTransaction( be->book );
     xaccTransBeginEdit( pTx );
-    gnc_sql_load_object( be, row, GNC_ID_TRANS, pTx, tx_col_table );
+    gnc_sql_load_object_mapped( be, row, GNC_ID_TRANS, pTx, tx_col_table, tx_map );
 
     g_assert( pTx == xaccTransLookup( &tx_guid, be->book ) );
 
@@ -303,69 +384,64 @@ load_single_tx( GncSqlBackend* be, GncSqlRow* row )
 }
 
 /**
- * Structure to hold start/end balances for each account.  The values are
- * saved before splits are loaded, and then used to adjust the start balances
- * so that the end balances (which are calculated and correct on initial load)
- * are unchanged.
- */
-typedef struct
-{
-    /*@ dependent @*/ Account* acc;
-    gnc_numeric start_bal;
-    gnc_numeric end_bal;
-    gnc_numeric start_cleared_bal;
-    gnc_numeric end_cleared_bal;
-    gnc_numeric start_reconciled_bal;
-    gnc_numeric end_reconciled_bal;
-} full_acct_balances_t;
-
-#if 0 /* Not Used */
-/**
- * Saves the start/end balances for an account.
+ * Takes the splits of a transaction posted before the loaded window back out
+ * of the account starting balances, which were summed from the db and so
+ * already include them.  Template accounts have no starting balances.
  *
- * @param acc Account
- * @param pData Pointer to balances info list
+ * @param be SQL backend
+ * @param pTx Transaction which has just been loaded
+ * @param accounts Set to which the accounts whose balances changed are added
  */
 static void
-save_account_balances( Account* acc, gpointer pData )
+remove_from_start_balances( GncSqlBackend* be, Transaction* pTx, GHashTable* accounts )
 {
-    GSList** pBal_list = (GSList**)pData;
-    full_acct_balances_t* newbal;
-    gnc_numeric* pstart;
-    gnc_numeric* pend;
-    gnc_numeric* pstart_c;
-    gnc_numeric* pend_c;
-    gnc_numeric* pstart_r;
-    gnc_numeric* pend_r;
-
-    newbal = g_malloc( (gsize)sizeof( full_acct_balances_t ) );
-    g_assert( newbal != NULL );
-
-    newbal->acc = acc;
-    g_object_get( acc,
-                  "start-balance", &pstart,
-                  "end-balance", &pend,
-                  "start-cleared-balance", &pstart_c,
-                  "end-cleared-balance", &pend_c,
-                  "start-reconciled-balance", &pstart_r,
-                  "end-reconciled-balance", &pend_r,
-                  NULL );
-    newbal->start_bal = *pstart;
-    newbal->end_bal = *pend;
-    newbal->start_cleared_bal = *pstart_c;
-    newbal->end_cleared_bal = *pend_c;
-    newbal->start_reconciled_bal = *pstart_r;
-    newbal->end_reconciled_bal = *pend_r;
-    *pBal_list = g_slist_append( *pBal_list, newbal );
-
-    g_free( pstart );
-    g_free( pend );
-    g_free( pstart_c );
-    g_free( pend_c );
-    g_free( pstart_r );
-    g_free( pend_r );
+    Timespec post_date;
+    Account* root;
+    SplitList_t splits;
+    SplitList_t::iterator node;
+
+    g_return_if_fail( be != NULL );
+    g_return_if_fail( pTx != NULL );
+
+    post_date = xaccTransRetDatePostedTS( pTx );
+    if ( timespec_cmp( &post_date, &be->tx_loaded_from ) >= 0 ) return;
+
+    root = gnc_book_get_root_account( be->book );
+    splits = xaccTransGetSplitList( pTx );
+    for ( node = splits.begin(); node != splits.end(); node++ )
+    {
+        Split* pSplit = *node;
+        Account* acct = xaccSplitGetAccount( pSplit );
+        gnc_numeric amount = xaccSplitGetAmount( pSplit );
+        char state = xaccSplitGetReconcile( pSplit );
+
+        if ( acct == NULL || gnc_account_get_root( acct ) != root ) continue;
+
+        gnc_account_set_start_balance( acct,
+                                       gnc_numeric_sub( gnc_account_get_start_balance( acct ),
+                                               amount, GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD ) );
+        if ( state != NREC )
+        {
+            gnc_account_set_start_cleared_balance( acct,
+                                                   gnc_numeric_sub( gnc_account_get_start_cleared_balance( acct ),
+                                                           amount, GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD ) );
+        }
+        if ( state == YREC || state == FREC )
+        {
+            gnc_account_set_start_reconciled_balance( acct,
+                    gnc_numeric_sub( gnc_account_get_start_reconciled_balance( acct ),
+                                     amount, GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD ) );
+        }
+        g_hash_table_insert( accounts, acct, acct );
+    }
 }
-#endif
+
+static void
+recompute_balance_cb( gpointer key, /*@ unused @*/ gpointer value, /*@ unused @*/ gpointer data )
+{
+    xaccAccountRecomputeBalance( (Account*)key );
+}
+
 /**
  * Executes a transaction query statement and loads the transactions and all
  * of the splits.
@@ -388,32 +464,25 @@ query_transactions( GncSqlBackend* be, GncSqlStatement* stmt )
         GList* node;
         GncSqlRow* row;
         Transaction* tx;
-#if LOAD_TRANSACTIONS_AS_NEEDED
-        GSList* bal_list = NULL;
-        GSList* nextbal;
-        Account* root = gnc_book_get_root_account( be->book );
-
-        qof_event_suspend();
-        xaccAccountBeginEdit( root );
-
-        // Save the start/ending balances (balance, cleared and reconciled) for
-        // every account.
-        gnc_account_foreach_descendant( gnc_book_get_root_account( be->primary_book ),
-                                        save_account_balances,
-                                        &bal_list );
-#endif
+        GncSqlColumnIndexMap* guid_map;
+        GncSqlColumnIndexMap* tx_map;
 
         // Load the transactions
+        guid_map = gnc_sql_result_map_guid( be, result );
+        tx_map = gnc_sql_result_map_columns( be, result, GNC_ID_TRANS, tx_col_table );
         row = gnc_sql_result_get_first_row( result );
         while ( row != NULL )
         {
-            tx = load_single_tx( be, row );
+            tx = load_single_tx( be, row, guid_map, tx_map );
             if ( tx != NULL )
             {
                 tx_list = g_list_prepend( tx_list, tx );
             }
+            qof_backend_load_yield( &be->be );
             row = gnc_sql_result_get_next_row( result );
         }
+        gnc_sql_column_index_map_free( guid_map );
+        gnc_sql_column_index_map_free( tx_map );
         gnc_sql_result_dispose( result );
 
         // Load all splits and slots for the transactions
@@ -428,66 +497,23 @@ query_transactions( GncSqlBackend* be, GncSqlStatement* stmt )
         {
             Transaction* pTx = (Transaction*)(node->data);
             xaccTransCommitEdit( pTx );
+            qof_backend_load_yield( &be->be );
         }
-        g_list_free( tx_list );
 
-#if LOAD_TRANSACTIONS_AS_NEEDED
-        // Update the account balances based on the loaded splits.  If the end
-        // balance has changed, update the start balance so that the end
-        // balance is the same as it was before the splits were loaded.
-        // Repeat for cleared and reconciled balances.
-        for ( nextbal = bal_list; nextbal != NULL; nextbal = nextbal->next )
+        // Transactions from before the loaded window, whether faulted in
+        // by guid or by date, are already in the starting balances.
+        if ( be->tx_partially_loaded )
         {
-            full_acct_balances_t* balns = (full_acct_balances_t*)nextbal->data;
-            gnc_numeric* pnew_end_bal;
-            gnc_numeric* pnew_end_c_bal;
-            gnc_numeric* pnew_end_r_bal;
-            gnc_numeric adj;
-
-            g_object_get( balns->acc,
-                          "end-balance", &pnew_end_bal,
-                          "end-cleared-balance", &pnew_end_c_bal,
-                          "end-reconciled-balance", &pnew_end_r_bal,
-                          NULL );
-
-            if ( !gnc_numeric_eq( *pnew_end_bal, balns->end_bal ) )
-            {
-                adj = gnc_numeric_sub( balns->end_bal, *pnew_end_bal,
-                                       GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD );
-                balns->start_bal = gnc_numeric_add( balns->start_bal, adj,
-                                                    GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD );
-                g_object_set( balns->acc, "start-balance", &balns->start_bal, NULL );
-            }
-            if ( !gnc_numeric_eq( *pnew_end_c_bal, balns->end_cleared_bal ) )
-            {
-                adj = gnc_numeric_sub( balns->end_cleared_bal, *pnew_end_c_bal,
-                                       GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD );
-                balns->start_cleared_bal = gnc_numeric_add( balns->start_cleared_bal, adj,
-                                           GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD );
-                g_object_set( balns->acc, "start-cleared-balance", &balns->start_cleared_bal, NULL );
-            }
-            if ( !gnc_numeric_eq( *pnew_end_r_bal, balns->end_reconciled_bal ) )
+            GHashTable* accounts = g_hash_table_new( g_direct_hash, g_direct_equal );
+
+            for ( node = tx_list; node != NULL; node = node->next )
             {
-                adj = gnc_numeric_sub( balns->end_reconciled_bal, *pnew_end_r_bal,
-                                       GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD );
-                balns->start_reconciled_bal = gnc_numeric_add( balns->start_reconciled_bal, adj,
-                                              GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD );
-                g_object_set( balns->acc, "start-reconciled-balance", &balns->start_reconciled_bal, NULL );
+                remove_from_start_balances( be, (Transaction*)(node->data), accounts );
             }
-            xaccAccountRecomputeBalance( balns->acc );
-            g_free( pnew_end_bal );
-            g_free( pnew_end_c_bal );
-            g_free( pnew_end_r_bal );
-            g_free( balns );
-        }
-        if ( bal_list != NULL )
-        {
-            g_slist_free( bal_list );
+            g_hash_table_foreach( accounts, recompute_balance_cb, NULL );
+            g_hash_table_destroy( accounts );
         }
-
-        xaccAccountCommitEdit( root );
-        qof_event_resume();
-#endif
+        g_list_free( tx_list );
     }
 }
 
@@ -597,6 +623,8 @@ static gboolean
 delete_splits( GncSqlBackend* be, Transaction* pTx )
 {
     split_info_t split_info;
+    SplitList_t splits;
+    SplitList_t::iterator node;
 
     g_return_val_if_fail( be != NULL, FALSE );
     g_return_val_if_fail( pTx != NULL, FALSE );
@@ -609,7 +637,11 @@ delete_splits( GncSqlBackend* be, Transaction* pTx )
     split_info.be = be;
     split_info.is_ok = TRUE;
 
-    g_list_foreach( xaccTransGetSplitList( pTx ), delete_split_slots_cb, &split_info );
+    splits = xaccTransGetSplitList( pTx );
+    for ( node = splits.begin(); node != splits.end(); node++ )
+    {
+        delete_split_slots_cb( *node, &split_info );
+    }
 
     return split_info.is_ok;
 }
@@ -636,13 +668,13 @@ commit_split( GncSqlBackend* be, QofInstance* inst )
     {
         op = OP_DB_DELETE;
     }
-    else if ( be->is_pristine_db || is_infant )
+    else if ( be->is_pristine_db )
     {
         op = OP_DB_INSERT;
     }
     else
     {
-        op = OP_DB_UPDATE;
+        op = OP_DB_UPSERT;
     }
     is_ok = gnc_sql_do_db_operation( be, op, SPLIT_TABLE, GNC_ID_SPLIT, inst, split_col_table );
     if ( is_ok )
@@ -673,18 +705,21 @@ save_split_cb( gpointer data, gpointer user_data )
 }
 
 static gboolean
-save_splits( GncSqlBackend* be, const GncGUID* tx_guid, SplitList* pSplitList )
+save_splits( GncSqlBackend* be, const GncGUID* tx_guid, const SplitList_t& splits )
 {
     split_info_t split_info;
+    SplitList_t::const_iterator node;
 
     g_return_val_if_fail( be != NULL, FALSE );
     g_return_val_if_fail( tx_guid != NULL, FALSE );
-    g_return_val_if_fail( pSplitList != NULL, FALSE );
 
     split_info.be = be;
     split_info.guid = tx_guid;
     split_info.is_ok = TRUE;
-    g_list_foreach( pSplitList, save_split_cb, &split_info );
+    for ( node = splits.begin(); node != splits.end(); node++ )
+    {
+        save_split_cb( *node, &split_info );
+    }
 
     return split_info.is_ok;
 }
@@ -708,13 +743,13 @@ save_transaction( GncSqlBackend* be, Transaction* pTx, gboolean do_save_splits )
     {
         op = OP_DB_DELETE;
     }
-    else if ( be->is_pristine_db || is_infant )
+    else if ( be->is_pristine_db )
     {
         op = OP_DB_INSERT;
     }
     else
     {
-        op = OP_DB_UPDATE;
+        op = OP_DB_UPSERT;
     }
 
     if ( op != OP_DB_DELETE )
@@ -820,38 +855,6 @@ commit_transaction( GncSqlBackend* be, QofInstance* inst )
 }
 
 /* ================================================================= */
-#if 0 /* Not Used */
-static /*@ dependent @*//*@ null @*/ const GncGUID*
-get_guid_from_query( QofQuery* pQuery )
-{
-    GList* pOrTerms;
-    GList* pAndTerms;
-    GList* andTerm;
-    QofQueryTerm* pTerm;
-    QofQueryPredData* pPredData;
-    GSList* pParamPath;
-
-    g_return_val_if_fail( pQuery != NULL, NULL );
-
-    pOrTerms = qof_query_get_terms( pQuery );
-    pAndTerms = (GList*)pOrTerms->data;
-    andTerm = pAndTerms->next;
-    pTerm = (QofQueryTerm*)andTerm->data;
-
-    pPredData = qof_query_term_get_pred_data( pTerm );
-    pParamPath = qof_query_term_get_param_path( pTerm );
-
-    if ( strcmp( pPredData->type_name, "guid" ) == 0 )
-    {
-        query_guid_t pData = (query_guid_t)pPredData;
-        return pData->guids->data;
-    }
-    else
-    {
-        return NULL;
-    }
-}
-#endif
 /**
  * Loads all transactions for an account.
  *
@@ -884,7 +887,8 @@ void gnc_sql_transaction_load_tx_for_account( GncSqlBackend* be, Account* accoun
 
 /**
  * Loads all transactions.  This might be used during a save-as operation to ensure that
- * all data is in memory and ready to be saved.
+ * all data is in memory and ready to be saved.  After a partial load, only the
+ * transactions which are still missing are read.
  *
  * @param be SQL backend
  */
@@ -895,6 +899,12 @@ void gnc_sql_transaction_load_all_tx( GncSqlBackend* be )
 
     g_return_if_fail( be != NULL );
 
+    if ( be->tx_partially_loaded )
+    {
+        load_older_tx( be, NULL );
+        return;
+    }
+
     query_sql = g_strdup_printf( "SELECT * FROM %s", TRANSACTION_TABLE );
     stmt = gnc_sql_create_statement_from_sql( be, query_sql );
     g_free( query_sql );
@@ -905,417 +915,6 @@ void gnc_sql_transaction_load_all_tx( GncSqlBackend* be )
     }
 }
 
-static void
-convert_query_comparison_to_sql( QofQueryPredData* pPredData, gboolean isInverted, GString* sql )
-{
-    if ( pPredData->how == QOF_COMPARE_LT
-            || ( isInverted && pPredData->how == QOF_COMPARE_GTE ) )
-    {
-        g_string_append( sql, "<" );
-    }
-    else if ( pPredData->how == QOF_COMPARE_LTE
-              || ( isInverted && pPredData->how == QOF_COMPARE_GT ) )
-    {
-        g_string_append( sql, "<=" );
-    }
-    else if ( pPredData->how == QOF_COMPARE_EQUAL
-              || ( isInverted && pPredData->how == QOF_COMPARE_NEQ ) )
-    {
-        g_string_append( sql, "=" );
-    }
-    else if ( pPredData->how == QOF_COMPARE_GT
-              || ( isInverted && pPredData->how == QOF_COMPARE_LTE ) )
-    {
-        g_string_append( sql, ">" );
-    }
-    else if ( pPredData->how == QOF_COMPARE_GTE
-              || ( isInverted && pPredData->how == QOF_COMPARE_LT ) )
-    {
-        g_string_append( sql, ">=" );
-    }
-    else if ( pPredData->how == QOF_COMPARE_NEQ
-              || ( isInverted && pPredData->how == QOF_COMPARE_EQUAL ) )
-    {
-        g_string_append( sql, "~=" );
-    }
-    else
-    {
-        PERR( "Unknown comparison type\n" );
-        g_string_append( sql, "??" );
-    }
-}
-
-static void
-convert_query_term_to_sql( const GncSqlBackend* be, const gchar* fieldName, QofQueryTerm* pTerm, GString* sql )
-{
-    QofQueryPredData* pPredData;
-    gboolean isInverted;
-
-    g_return_if_fail( pTerm != NULL );
-    g_return_if_fail( sql != NULL );
-
-    pPredData = qof_query_term_get_pred_data( pTerm );
-    isInverted = qof_query_term_is_inverted( pTerm );
-
-    if ( g_strcmp0( pPredData->type_name, QOF_TYPE_GUID ) == 0 )
-    {
-        query_guid_t guid_data = (query_guid_t)pPredData;
-        GList* guid_entry;
-
-        g_string_append( sql, "(" );
-        g_string_append( sql, fieldName );
-
-        switch ( guid_data->options )
-        {
-        case QOF_GUID_MATCH_ANY:
-            if ( isInverted ) g_string_append( sql, " NOT IN (" );
-            else g_string_append( sql, " IN (" );
-            break;
-
-        case QOF_GUID_MATCH_NONE:
-            if ( isInverted ) g_string_append( sql, " IN (" );
-            else g_string_append( sql, " NOT IN (" );
-            break;
-
-        default:
-            PERR( "Unexpected GncGUID match type: %d\n", guid_data->options );
-        }
-
-        for ( guid_entry = guid_data->guids; guid_entry != NULL; guid_entry = guid_entry->next )
-        {
-            gchar guid_buf[GUID_ENCODING_LENGTH+1];
-
-            if ( guid_entry != guid_data->guids ) g_string_append( sql, "," );
-            (void)guid_to_string_buff( guid_entry->data, guid_buf );
-            g_string_append_printf( sql, "'%s'", guid_buf );
-        }
-        g_string_append( sql, "))" );
-
-    }
-    else if ( g_strcmp0( pPredData->type_name, QOF_TYPE_CHAR ) == 0 )
-    {
-        query_char_t char_data = (query_char_t)pPredData;
-        int i;
-
-        if ( isInverted )
-        {
-            g_string_append( sql, "NOT(" );
-        }
-        if ( char_data->options == QOF_CHAR_MATCH_NONE )
-        {
-            g_string_append( sql, "NOT " );
-        }
-        g_string_append( sql, "(" );
-        for ( i = 0; char_data->char_list[i] != '\0'; i++ )
-        {
-            if ( i != 0 )
-            {
-                g_string_append( sql, " OR " );
-            }
-            g_string_append( sql, fieldName );
-            g_string_append( sql, " = '" );
-            g_string_append_c( sql, char_data->char_list[i] );
-            g_string_append( sql, "'" );
-        }
-        g_string_append( sql, ") " );
-        if ( isInverted )
-        {
-            g_string_append( sql, ") " );
-        }
-
-    }
-    else if ( g_strcmp0( pPredData->type_name, QOF_TYPE_STRING ) == 0 )
-    {
-        query_string_t string_data = (query_string_t)pPredData;
-        sqlEscape* escape = sqlEscape_new();
-
-        if ( isInverted )
-        {
-            g_string_append( sql, "NOT(" );
-        }
-        if ( pPredData->how == QOF_COMPARE_NEQ )
-        {
-            g_string_append( sql, "NOT(" );
-        }
-        g_string_append( sql, fieldName );
-        if ( string_data->is_regex || string_data->options == QOF_STRING_MATCH_CASEINSENSITIVE )
-        {
-            PWARN( "String is_regex || option = QOF_STRING_MATCH_INSENSITIVE\n" );
-        }
-//			g_string_append( sql, " ~" );
-//		} else {
-        g_string_append( sql, " =" );
-//		}
-//		if( string_data->options == QOF_STRING_MATCH_CASEINSENSITIVE ) {
-//			g_string_append( sql, "*" );
-//		}
-        g_string_append( sql, "'" );
-        g_string_append( sql, sqlEscapeString( escape, string_data->matchstring ) );
-        g_string_append( sql, "'" );
-        if ( pPredData->how == QOF_COMPARE_NEQ )
-        {
-            g_string_append( sql, ")" );
-        }
-        if ( isInverted )
-        {
-            g_string_append( sql, ")" );
-        }
-        sqlEscape_destroy( escape );
-
-    }
-    else
-    {
-        g_string_append( sql, "(" );
-        g_string_append( sql, fieldName );
-        convert_query_comparison_to_sql( pPredData, isInverted, sql );
-
-        if ( strcmp( pPredData->type_name, QOF_TYPE_NUMERIC ) == 0 )
-        {
-            query_numeric_t pData = (query_numeric_t)pPredData;
-            double d = gnc_numeric_to_double( pData->amount );
-
-            g_string_append_printf( sql, "%f", d );
-
-        }
-        else if ( g_strcmp0( pPredData->type_name, QOF_TYPE_DATE ) == 0 )
-        {
-            query_date_t date_data = (query_date_t)pPredData;
-            gchar* datebuf;
-
-            datebuf = gnc_sql_convert_timespec_to_string( be, date_data->date );
-            g_string_append_printf( sql, "'%s'", datebuf );
-
-        }
-        else if ( strcmp( pPredData->type_name, QOF_TYPE_INT32 ) == 0 )
-        {
-            query_int32_t pData = (query_int32_t)pPredData;
-
-            g_string_append_printf( sql, "%d", pData->val );
-
-        }
-        else if ( strcmp( pPredData->type_name, QOF_TYPE_INT64 ) == 0 )
-        {
-            query_int64_t pData = (query_int64_t)pPredData;
-
-            g_string_append_printf( sql, "%" G_GINT64_FORMAT, pData->val );
-
-        }
-        else if ( strcmp( pPredData->type_name, QOF_TYPE_DOUBLE ) == 0 )
-        {
-            query_double_t pData = (query_double_t)pPredData;
-
-            g_string_append_printf( sql, "%f", pData->val );
-
-        }
-        else if ( strcmp( pPredData->type_name, QOF_TYPE_BOOLEAN ) == 0 )
-        {
-            query_boolean_t pData = (query_boolean_t)pPredData;
-
-            g_string_append_printf( sql, "%d", pData->val );
-
-        }
-        else
-        {
-            PERR( "Unknown query predicate type: %s\n", pPredData->type_name );
-        }
-
-        g_string_append( sql, ")" );
-    }
-}
-
-typedef struct
-{
-    GncSqlStatement* stmt;
-    gboolean has_been_run;
-} split_query_info_t;
-
-#define TX_GUID_CHECK 0
-
-G_GNUC_UNUSED static /*@ null @*/ gpointer
-compile_split_query( GncSqlBackend* be, QofQuery* query )
-{
-    split_query_info_t* query_info = NULL;
-    gchar* query_sql;
-
-    g_return_val_if_fail( be != NULL, NULL );
-    g_return_val_if_fail( query != NULL, NULL );
-
-    query_info = g_malloc( (gsize)sizeof(split_query_info_t) );
-    g_assert( query_info != NULL );
-    query_info->has_been_run = FALSE;
-
-    if ( qof_query_has_terms( query ) )
-    {
-        GList* orterms = qof_query_get_terms( query );
-        GList* orTerm;
-        GString* sql = g_string_new( "" );
-        gboolean need_OR = FALSE;
-
-        for ( orTerm = orterms; orTerm != NULL; orTerm = orTerm->next )
-        {
-            GList* andterms = (GList*)orTerm->data;
-            GList* andTerm;
-            gboolean need_AND = FALSE;
-#if TX_GUID_CHECK
-            gboolean has_tx_guid_check = FALSE;
-#endif
-            if ( need_OR )
-            {
-                g_string_append( sql, " OR " );
-            }
-            g_string_append( sql, "(" );
-            for ( andTerm = andterms; andTerm != NULL; andTerm = andTerm->next )
-            {
-                QofQueryTerm* term;
-                GSList* paramPath;
-                gboolean unknownPath = FALSE;
-
-                term = (QofQueryTerm*)andTerm->data;
-                paramPath = qof_query_term_get_param_path( term );
-
-                if ( strcmp( paramPath->data, QOF_PARAM_BOOK ) == 0 ) continue;
-
-#if SIMPLE_QUERY_COMPILATION
-                if ( strcmp( paramPath->data, SPLIT_ACCOUNT ) != 0
-                        || strcmp( paramPath->next->data, QOF_PARAM_GUID ) != 0 ) continue;
-#endif
-
-                if ( need_AND ) g_string_append( sql, " AND " );
-
-                if ( strcmp( paramPath->data, SPLIT_ACCOUNT ) == 0
-                        && strcmp( paramPath->next->data, QOF_PARAM_GUID ) == 0 )
-                {
-                    convert_query_term_to_sql( be, "s.account_guid", term, sql );
-#if SIMPLE_QUERY_COMPILATION
-                    goto done_compiling_query;
-#endif
-
-                }
-                else if ( strcmp( paramPath->data, SPLIT_RECONCILE ) == 0 )
-                {
-                    convert_query_term_to_sql( be, "s.reconcile_state", term, sql );
-
-                }
-                else if ( strcmp( paramPath->data, SPLIT_TRANS ) == 0 )
-                {
-#if TX_GUID_CHECK
-                    if ( !has_tx_guid_check )
-                    {
-                        g_string_append( sql, "(splits.tx_guid = transactions.guid) AND " );
-                        has_tx_guid_check = TRUE;
-                    }
-#endif
-                    if ( strcmp( paramPath->next->data, TRANS_DATE_POSTED ) == 0 )
-                    {
-                        convert_query_term_to_sql( be, "t.post_date", term, sql );
-                    }
-                    else if ( strcmp( paramPath->next->data, TRANS_DESCRIPTION ) == 0 )
-                    {
-                        convert_query_term_to_sql( be, "t.description", term, sql );
-                    }
-                    else
-                    {
-                        unknownPath = TRUE;
-                    }
-
-                }
-                else if ( strcmp( paramPath->data, SPLIT_VALUE ) == 0 )
-                {
-                    convert_query_term_to_sql( be, "s.value_num/s.value_denom", term, sql );
-
-                }
-                else
-                {
-                    unknownPath = TRUE;
-                }
-
-                if ( unknownPath )
-                {
-                    GString* name = g_string_new( (gchar*)paramPath->data );
-                    while ( paramPath->next != NULL )
-                    {
-                        g_string_append( name, "." );
-                        g_string_append( name, paramPath->next->data );
-                        paramPath = paramPath->next;
-                    }
-                    PERR( "Unknown SPLIT query field: %s\n", name->str );
-                    g_string_free( name, TRUE );
-                }
-                need_AND = TRUE;
-            }
-
-            /* If the last char in the string is a '(', then for some reason, there were
-               no terms added to the SQL.  If so, remove it and ignore the OR term. */
-            if ( sql->str[sql->len-1] == '(' )
-            {
-                g_string_truncate( sql, sql->len - 1 );
-                need_OR = FALSE;
-            }
-            else
-            {
-                g_string_append( sql, ")" );
-                need_OR = TRUE;
-            }
-        }
-
-#if SIMPLE_QUERY_COMPILATION
-done_compiling_query:
-#endif
-        if ( sql->len != 0 )
-        {
-#if SIMPLE_QUERY_COMPILATION
-            g_string_append( sql, ")" );
-#endif
-            query_sql = g_strdup_printf(
-                            "SELECT DISTINCT t.* FROM %s AS t, %s AS s WHERE s.tx_guid=t.guid AND %s",
-                            TRANSACTION_TABLE, SPLIT_TABLE, sql->str );
-        }
-        else
-        {
-            query_sql = g_strdup_printf( "SELECT * FROM %s", TRANSACTION_TABLE );
-        }
-        query_info->stmt = gnc_sql_create_statement_from_sql( be, query_sql );
-
-        g_string_free( sql, TRUE );
-        g_free( query_sql );
-
-    }
-    else
-    {
-        query_sql = g_strdup_printf( "SELECT * FROM %s", TRANSACTION_TABLE );
-        query_info->stmt = gnc_sql_create_statement_from_sql( be, query_sql );
-        g_free( query_sql );
-    }
-
-    return query_info;
-}
-
-G_GNUC_UNUSED static void
-run_split_query( GncSqlBackend* be, gpointer pQuery )
-{
-    split_query_info_t* query_info = (split_query_info_t*)pQuery;
-
-    g_return_if_fail( be != NULL );
-    g_return_if_fail( pQuery != NULL );
-
-    if ( !query_info->has_been_run )
-    {
-        query_transactions( be, query_info->stmt );
-        query_info->has_been_run = TRUE;
-        gnc_sql_statement_dispose( query_info->stmt );
-        query_info->stmt = NULL;
-    }
-}
-
-G_GNUC_UNUSED static void
-free_split_query( GncSqlBackend* be, gpointer pQuery )
-{
-    g_return_if_fail( be != NULL );
-    g_return_if_fail( pQuery != NULL );
-
-    g_free( pQuery );
-}
-
 /* ----------------------------------------------------------------- */
 typedef struct
 {
@@ -1363,14 +962,14 @@ set_acct_bal_balance( gpointer pObject, gnc_numeric value )
 static const GncSqlColumnTableEntry acct_balances_col_table[] =
 {
     /*@ -full_init_block @*/
-    { "account_guid",    CT_GUID,    0, 0, NULL, NULL, NULL, (QofSetterFunc)set_acct_bal_account_from_guid },
-    { "reconcile_state", CT_STRING,  1, 0, NULL, NULL, NULL, (QofSetterFunc)set_acct_bal_reconcile_state },
-    { "quantity",        CT_NUMERIC, 0, 0, NULL, NULL, NULL, (QofSetterFunc)set_acct_bal_balance },
+    { "account_guid",    CT_GUID,    0, 0, NULL, (QofSetterFunc)set_acct_bal_account_from_guid },
+    { "reconcile_state", CT_STRING,  1, 0, NULL, (QofSetterFunc)set_acct_bal_reconcile_state },
+    { "quantity",        CT_NUMERIC, 0, 0, NULL, (QofSetterFunc)set_acct_bal_balance },
     { NULL }
     /*@ +full_init_block @*/
 };
 
-G_GNUC_UNUSED static /*@ null @*/ single_acct_balance_t*
+static /*@ null @*/ single_acct_balance_t*
 load_single_acct_balances( const GncSqlBackend* be, GncSqlRow* row )
 {
     single_acct_balance_t* bal = NULL;
@@ -1378,7 +977,7 @@ load_single_acct_balances( const GncSqlBackend* be, GncSqlRow* row )
     g_return_val_if_fail( be != NULL, NULL );
     g_return_val_if_fail( row != NULL, NULL );
 
-    bal = g_malloc( (gsize)sizeof(single_acct_balance_t) );
+    bal = (single_acct_balance_t*)g_malloc( (gsize)sizeof(single_acct_balance_t) );
     g_assert( bal != NULL );
 
     bal->be = be;
@@ -1387,19 +986,56 @@ load_single_acct_balances( const GncSqlBackend* be, GncSqlRow* row )
     return bal;
 }
 
-/*@ null @*/ GSList*
-gnc_sql_get_account_balances_slist( GncSqlBackend* be )
+/**
+ * Rolls the reconciled balance into the cleared balance and the cleared
+ * balance into the total, then prepends the balances to a list.  Template
+ * accounts are dropped because their transactions are always loaded.
+ *
+ * @param be SQL backend
+ * @param bal_slist List of acct_balances_t structures
+ * @param bal Balances for one account
+ * @return The new start of the list
+ */
+static GSList*
+prepend_acct_balances( GncSqlBackend* be, GSList* bal_slist, acct_balances_t* bal )
+{
+    if ( bal->acct == NULL
+            || gnc_account_get_root( bal->acct ) != gnc_book_get_root_account( be->book ) )
+    {
+        g_free( bal );
+        return bal_slist;
+    }
+
+    bal->cleared_balance = gnc_numeric_add( bal->cleared_balance, bal->reconciled_balance,
+                                            GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD );
+    bal->balance = gnc_numeric_add( bal->balance, bal->cleared_balance,
+                                    GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD );
+    return g_slist_prepend( bal_slist, bal );
+}
+
+/**
+ * Sums the splits of each account over the transactions posted before a
+ * date.
+ *
+ * @param be SQL backend
+ * @param until End of the range (exclusive)
+ * @return GSList of acct_balances_t structures
+ */
+static /*@ null @*/ GSList*
+get_account_balances_before( GncSqlBackend* be, Timespec until )
 {
-#if LOAD_TRANSACTIONS_AS_NEEDED
     GncSqlResult* result;
     GncSqlStatement* stmt;
     gchar* buf;
+    gchar* until_str;
     GSList* bal_slist = NULL;
 
     g_return_val_if_fail( be != NULL, NULL );
 
-    buf = g_strdup_printf( "SELECT account_guid, reconcile_state, sum(quantity_num) as quantity_num, quantity_denom FROM %s GROUP BY account_guid, reconcile_state, quantity_denom ORDER BY account_guid, reconcile_state",
-                           SPLIT_TABLE );
+    until_str = gnc_sql_convert_timespec_to_string( be, until );
+    buf = g_strdup_printf( "SELECT s.account_guid AS account_guid, s.reconcile_state AS reconcile_state, sum(s.quantity_num) AS quantity_num, s.quantity_denom AS quantity_denom FROM %s AS s, %s AS t WHERE s.tx_guid=t.guid AND t.post_date < '%s' GROUP BY s.account_guid, s.reconcile_state, s.quantity_denom ORDER BY s.account_guid, s.reconcile_state",
+                           SPLIT_TABLE, TRANSACTION_TABLE, until_str );
+    g_free( until_str );
     stmt = gnc_sql_create_statement_from_sql( be, buf );
     g_assert( stmt != NULL );
     g_free( buf );
@@ -1421,16 +1057,12 @@ gnc_sql_get_account_balances_slist( GncSqlBackend* be )
             {
                 if ( bal != NULL && bal->acct != single_bal->acct )
                 {
-                    bal->cleared_balance = gnc_numeric_add( bal->cleared_balance, bal->reconciled_balance,
-                                                            GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD );
-                    bal->balance = gnc_numeric_add( bal->balance, bal->cleared_balance,
-                                                    GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD );
-                    bal_slist = g_slist_append( bal_slist, bal );
+                    bal_slist = prepend_acct_balances( be, bal_slist, bal );
                     bal = NULL;
                 }
                 if ( bal == NULL )
                 {
-                    bal = g_malloc( (gsize)sizeof(acct_balances_t) );
+                    bal = (acct_balances_t*)g_malloc( (gsize)sizeof(acct_balances_t) );
                     g_assert( bal != NULL );
 
                     bal->acct = single_bal->acct;
@@ -1438,21 +1070,22 @@ gnc_sql_get_account_balances_slist( GncSqlBackend* be )
                     bal->cleared_balance = gnc_numeric_zero();
                     bal->reconciled_balance = gnc_numeric_zero();
                 }
-                if ( single_bal->reconcile_state == 'n' )
+                if ( single_bal->reconcile_state == NREC )
                 {
                     bal->balance = gnc_numeric_add( bal->balance, single_bal->balance,
                                                     GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD );
                 }
-                else if ( single_bal->reconcile_state == 'c' )
-                {
-                    bal->cleared_balance = gnc_numeric_add( bal->cleared_balance, single_bal->balance,
-                                                            GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD );
-                }
-                else if ( single_bal->reconcile_state == 'y' )
+                else if ( single_bal->reconcile_state == YREC
+                          || single_bal->reconcile_state == FREC )
                 {
                     bal->reconciled_balance = gnc_numeric_add( bal->reconciled_balance, single_bal->balance,
                                               GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD );
                 }
+                else
+                {
+                    bal->cleared_balance = gnc_numeric_add( bal->cleared_balance, single_bal->balance,
+                                                            GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD );
+                }
                 g_free( single_bal );
             }
             row = gnc_sql_result_get_next_row( result );
@@ -1461,30 +1094,169 @@ gnc_sql_get_account_balances_slist( GncSqlBackend* be )
         // Add the final balance
         if ( bal != NULL )
         {
-            bal->cleared_balance = gnc_numeric_add( bal->cleared_balance, bal->reconciled_balance,
-                                                    GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD );
-            bal->balance = gnc_numeric_add( bal->balance, bal->cleared_balance,
-                                            GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD );
-            bal_slist = g_slist_append( bal_slist, bal );
+            bal_slist = prepend_acct_balances( be, bal_slist, bal );
         }
         gnc_sql_result_dispose( result );
     }
 
-    return bal_slist;
-#else
-    return NULL;
-#endif
+    return g_slist_reverse( bal_slist );
+}
+
+/*@ null @*/ GSList*
+gnc_sql_get_account_balances_slist( GncSqlBackend* be )
+{
+    g_return_val_if_fail( be != NULL, NULL );
+
+    if ( !be->tx_partially_loaded ) return NULL;
+
+    return get_account_balances_before( be, be->tx_loaded_from );
+}
+
+/**
+ * Loads the transactions posted from 'since' up to the start of the loaded
+ * window.  query_transactions() takes their splits back out of the account
+ * starting balances so that the ending balances are unchanged.
+ *
+ * @param be SQL backend
+ * @param since New start of the loaded window, or NULL to load everything
+ */
+static void
+load_older_tx( GncSqlBackend* be, /*@ null @*/ const Timespec* since )
+{
+    gchar* until_str;
+    gchar* query_sql;
+    GncSqlStatement* stmt;
+
+    g_return_if_fail( be != NULL );
+    g_return_if_fail( be->tx_partially_loaded );
+
+    until_str = gnc_sql_convert_timespec_to_string( be, be->tx_loaded_from );
+    if ( since != NULL )
+    {
+        gchar* since_str = gnc_sql_convert_timespec_to_string( be, *since );
+        query_sql = g_strdup_printf( "SELECT * FROM %s WHERE post_date >= '%s' AND post_date < '%s'",
+                                     TRANSACTION_TABLE, since_str, until_str );
+        g_free( since_str );
+    }
+    else
+    {
+        query_sql = g_strdup_printf( "SELECT * FROM %s WHERE post_date < '%s'",
+                                     TRANSACTION_TABLE, until_str );
+    }
+    g_free( until_str );
+    stmt = gnc_sql_create_statement_from_sql( be, query_sql );
+    g_free( query_sql );
+    if ( stmt != NULL )
+    {
+        query_transactions( be, stmt );
+        gnc_sql_statement_dispose( stmt );
+    }
+
+    if ( since != NULL )
+    {
+        be->tx_loaded_from = *since;
+    }
+    else
+    {
+        be->tx_partially_loaded = FALSE;
+    }
+}
+
+void
+gnc_sql_transaction_load_tx_since( GncSqlBackend* be, Timespec since )
+{
+    g_return_if_fail( be != NULL );
+
+    if ( !be->tx_partially_loaded ) return;
+    if ( timespec_cmp( &since, &be->tx_loaded_from ) >= 0 ) return;
+
+    load_older_tx( be, &since );
+}
+
+static void
+load_template_tx_cb( Account* acct, gpointer data )
+{
+    gnc_sql_transaction_load_tx_for_account( (GncSqlBackend*)data, acct );
+}
+
+/**
+ * Initial load of the transactions.  Without a load window, all transactions
+ * are loaded.  Otherwise only the transactions in the window are loaded; the
+ * older ones are summarized in the account starting balances, which the
+ * account handler has already set.  Template transactions are always loaded.
+ *
+ * @param be SQL backend
+ */
+static void
+initial_load_tx( GncSqlBackend* be )
+{
+    gchar* from_str;
+    gchar* query_sql;
+    GncSqlStatement* stmt;
+
+    g_return_if_fail( be != NULL );
+
+    if ( !be->tx_partially_loaded )
+    {
+        gnc_sql_transaction_load_all_tx( be );
+        return;
+    }
+
+    from_str = gnc_sql_convert_timespec_to_string( be, be->tx_loaded_from );
+    query_sql = g_strdup_printf( "SELECT * FROM %s WHERE post_date >= '%s'",
+                                 TRANSACTION_TABLE, from_str );
+    g_free( from_str );
+    stmt = gnc_sql_create_statement_from_sql( be, query_sql );
+    g_free( query_sql );
+    if ( stmt != NULL )
+    {
+        query_transactions( be, stmt );
+        gnc_sql_statement_dispose( stmt );
+    }
+
+    /* Scheduled transaction templates are needed whatever their date */
+    gnc_account_foreach_descendant( gnc_book_get_template_root( be->book ),
+                                    load_template_tx_cb, be );
 }
 
 /* ----------------------------------------------------------------- */
+static void
+set_tx_from_guid_string( const GncSqlBackend* be, /*@ null @*/ QofSetterFunc setter,
+                         gpointer pObject, const GncSqlColumnTableEntry* table_row,
+                         const gchar* guid_str )
+{
+    GncGUID guid;
+    Transaction* tx;
+
+    (void)string_to_guid( guid_str, &guid );
+    tx = xaccTransLookup( &guid, be->book );
+
+    // If the transaction is not found, try loading it
+    if ( tx == NULL )
+    {
+        gchar* buf;
+        GncSqlStatement* stmt;
+
+        buf = g_strdup_printf( "SELECT * FROM %s WHERE guid='%s'",
+                               TRANSACTION_TABLE, guid_str );
+        stmt = gnc_sql_create_statement_from_sql( (GncSqlBackend*)be, buf );
+        g_free( buf );
+        query_transactions( (GncSqlBackend*)be, stmt );
+        tx = xaccTransLookup( &guid, be->book );
+    }
+
+    if ( tx != NULL )
+    {
+        (*setter)( pObject, (const gpointer)tx );
+    }
+}
+
 static void
 load_tx_guid( const GncSqlBackend* be, GncSqlRow* row,
               /*@ null @*/ QofSetterFunc setter, gpointer pObject,
               const GncSqlColumnTableEntry* table_row )
 {
     const GValue* val;
-    GncGUID guid;
-    Transaction* tx;
     const gchar* guid_str;
 
     g_return_if_fail( be != NULL );
@@ -1497,35 +1269,26 @@ load_tx_guid( const GncSqlBackend* be, GncSqlRow* row,
     guid_str = g_value_get_string(val);
     if ( guid_str != NULL )
     {
-        (void)string_to_guid( guid_str, &guid );
-        tx = xaccTransLookup( &guid, be->book );
+        set_tx_from_guid_string( be, setter, pObject, table_row, guid_str );
+    }
+}
 
-        // If the transaction is not found, try loading it
-        if ( tx == NULL )
-        {
-            gchar* buf;
-            GncSqlStatement* stmt;
-
-            buf = g_strdup_printf( "SELECT * FROM %s WHERE guid='%s'",
-                                   TRANSACTION_TABLE, guid_str );
-            stmt = gnc_sql_create_statement_from_sql( (GncSqlBackend*)be, buf );
-            g_free( buf );
-            query_transactions( (GncSqlBackend*)be, stmt );
-            tx = xaccTransLookup( &guid, be->book );
-        }
+static void
+load_tx_guid_at_index( const GncSqlBackend* be, GncSqlRow* row,
+                       /*@ null @*/ QofSetterFunc setter, gpointer pObject,
+                       const GncSqlColumnTableEntry* table_row, const gint* col_indices )
+{
+    const gchar* guid_str;
 
-        if ( tx != NULL )
-        {
-            if ( table_row->gobj_param_name != NULL )
-            {
-                g_object_set( pObject, table_row->gobj_param_name, tx, NULL );
-            }
-            else
-            {
-                g_return_if_fail( setter != NULL );
-                (*setter)( pObject, (const gpointer)tx );
-            }
-        }
+    g_return_if_fail( be != NULL );
+    g_return_if_fail( row != NULL );
+    g_return_if_fail( pObject != NULL );
+    g_return_if_fail( table_row != NULL );
+
+    guid_str = gnc_sql_row_get_string_at_col_index( row, col_indices[0] );
+    if ( guid_str != NULL )
+    {
+        set_tx_from_guid_string( be, setter, pObject, table_row, guid_str );
     }
 }
 
@@ -1533,7 +1296,8 @@ static GncSqlColumnTypeHandler tx_guid_handler
 = { load_tx_guid,
     gnc_sql_add_objectref_guid_col_info_to_list,
     gnc_sql_add_colname_to_list,
-    gnc_sql_add_gvalue_objectref_guid_to_slist
+    gnc_sql_add_gvalue_objectref_guid_to_slist,
+    load_tx_guid_at_index
   };
 /* ================================================================= */
 void
@@ -1544,15 +1308,8 @@ gnc_sql_init_transaction_handler( void )
         GNC_SQL_BACKEND_VERSION,
         GNC_ID_TRANS,
         commit_transaction,          /* commit */
-#if LOAD_TRANSACTIONS_AS_NEEDED
-        NULL,                        /* initial load */
-#else
-        gnc_sql_transaction_load_all_tx,
-#endif
+        initial_load_tx,             /* initial load */
         create_transaction_tables,   /* create tables */
-        NULL,                        /* compile_query */
-        NULL,                        /* run_query */
-        NULL,                        /* free_query */
         NULL                         /* write */
     };
     static GncSqlObjectBackend be_data_split =
@@ -1562,15 +1319,6 @@ gnc_sql_init_transaction_handler( void )
         commit_split,                /* commit */
         NULL,                        /* initial_load */
         NULL,                        /* create tables */
-#if LOAD_TRANSACTIONS_AS_NEEDED
-        compile_split_query,
-        run_split_query,
-        free_split_query,
-#else
-        NULL,                        /* compile_query */
-        NULL,                        /* run_query */
-        NULL,                        /* free_query */
-#endif
         NULL                         /* write */
     };
 
@@ -68,6 +68,16 @@ void gnc_sql_transaction_load_tx_for_account( GncSqlBackend* be, Account* accoun
  */
 void gnc_sql_transaction_load_all_tx( GncSqlBackend* be );
 
+/**
+ * After a partial load, loads the transactions posted between 'since' and
+ * the start of the loaded window, and moves their splits out of the account
+ * starting balances.
+ *
+ * @param be SQL backend
+ * @param since Earliest post date which needs to be loaded
+ */
+void gnc_sql_transaction_load_tx_since( GncSqlBackend* be, Timespec since );
+
 typedef struct
 {
     Account* acct;
@@ -78,7 +88,9 @@ typedef struct
 
 /**
  * Returns a list of acct_balances_t structures, one for each account which
- * has splits.
+ * has splits in transactions posted before the loaded window.  These are the
+ * starting balances of the accounts after a partial load.  Returns NULL if
+ * all transactions are loaded.
  *
  * @param be SQL backend
  * @return GSList of acct_balances_t structures
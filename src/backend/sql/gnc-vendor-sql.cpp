@@ -63,17 +63,50 @@ G_GNUC_UNUSED static QofLogModule log_module = G_LOG_DOMAIN;
 
 static GncSqlColumnTableEntry col_table[] =
 {
-    { "guid",         CT_GUID,          0,               COL_NNUL | COL_PKEY, "guid" },
-    { "name",         CT_STRING,        MAX_NAME_LEN,    COL_NNUL,            "name" },
-    { "id",           CT_STRING,        MAX_ID_LEN,      COL_NNUL,            "id" },
-    { "notes",        CT_STRING,        MAX_NOTES_LEN,   COL_NNUL,            "notes" },
-    { "currency",     CT_COMMODITYREF,  0,               COL_NNUL,            "currency" },
-    { "active",       CT_BOOLEAN,       0,               COL_NNUL,            "active" },
-    { "tax_override", CT_BOOLEAN,       0,               COL_NNUL,            "tax-table-override" },
-    { "addr",         CT_ADDRESS,       0,               0,                   "address" },
-    { "terms",        CT_BILLTERMREF,   0,               0,                   "terms" },
-    { "tax_inc",      CT_STRING,        MAX_TAX_INC_LEN, 0,                   "tax-included-string" },
-    { "tax_table",    CT_TAXTABLEREF,   0,               0,                   "tax-table" },
+    {
+        "guid", CT_GUID, 0, COL_NNUL | COL_PKEY,
+        (QofAccessFunc)qof_instance_get_guid, (QofSetterFunc)qof_instance_set_guid
+    },
+    {
+        "name", CT_STRING, MAX_NAME_LEN, COL_NNUL,
+        (QofAccessFunc)gncVendorGetName, (QofSetterFunc)gncVendorSetName
+    },
+    {
+        "id", CT_STRING, MAX_ID_LEN, COL_NNUL,
+        (QofAccessFunc)gncVendorGetID, (QofSetterFunc)gncVendorSetID
+    },
+    {
+        "notes", CT_STRING, MAX_NOTES_LEN, COL_NNUL,
+        (QofAccessFunc)gncVendorGetNotes, (QofSetterFunc)gncVendorSetNotes
+    },
+    {
+        "currency", CT_COMMODITYREF, 0, COL_NNUL,
+        (QofAccessFunc)gncVendorGetCurrency, (QofSetterFunc)gncVendorSetCurrency
+    },
+    {
+        "active", CT_BOOLEAN, 0, COL_NNUL,
+        (QofAccessFunc)gncVendorGetActive, (QofSetterFunc)gncVendorSetActive
+    },
+    {
+        "tax_override", CT_BOOLEAN, 0, COL_NNUL,
+        (QofAccessFunc)gncVendorGetTaxTableOverride, (QofSetterFunc)gncVendorSetTaxTableOverride
+    },
+    {
+        "addr", CT_ADDRESS, 0, 0,
+        (QofAccessFunc)gncVendorGetAddr, (QofSetterFunc)qofVendorSetAddr
+    },
+    {
+        "terms", CT_BILLTERMREF, 0, 0,
+        (QofAccessFunc)gncVendorGetTerms, (QofSetterFunc)gncVendorSetTerms
+    },
+    {
+        "tax_inc", CT_STRING, MAX_TAX_INC_LEN, 0,
+        (QofAccessFunc)qofVendorGetTaxIncluded, (QofSetterFunc)qofVendorSetTaxIncluded
+    },
+    {
+        "tax_table", CT_TAXTABLEREF, 0, 0,
+        (QofAccessFunc)gncVendorGetTaxTable, (QofSetterFunc)gncVendorSetTaxTable
+    },
     { NULL }
 };
 
@@ -170,13 +203,13 @@ save_vendor( GncSqlBackend* be, QofInstance* inst )
     {
         op = OP_DB_DELETE;
     }
-    else if ( be->is_pristine_db || is_infant )
+    else if ( be->is_pristine_db )
     {
         op = OP_DB_INSERT;
     }
     else
     {
-        op = OP_DB_UPDATE;
+        op = OP_DB_UPSERT;
     }
     if ( op != OP_DB_DELETE )
     {
@@ -263,7 +296,6 @@ gnc_vendor_sql_initialize( void )
         save_vendor,						/* commit */
         load_all_vendors,					/* initial_load */
         create_vendor_tables,				/* create_tables */
-        NULL, NULL, NULL,
         write_vendors						/* write */
     };
 
@@ -24,8 +24,11 @@
 #include "config.h"
 #include <glib.h>
 #include "qof.h"
+#include "cashobjects.h"
 
 extern void test_suite_gnc_backend_sql ();
+extern void test_suite_gnc_sqlite3_connection ();
+extern void test_suite_gnc_slots_sql ();
 
 int
 main (int   argc,
@@ -33,10 +36,14 @@ main (int   argc,
 {
     g_type_init(); 			/* Initialize the GObject system */
     g_test_init ( &argc, &argv, NULL ); 	/* initialize test program */
+    qof_init();
+    cashobjects_register();
     qof_log_init_filename_special("stderr"); /* Init the log system */
     g_test_bug_base("https://bugzilla.gnome.org/show_bug.cgi?id="); /* init the bugzilla URL */
 
     test_suite_gnc_backend_sql ();
+    test_suite_gnc_sqlite3_connection ();
+    test_suite_gnc_slots_sql ();
 
     return g_test_run( );
 }
@@ -0,0 +1,474 @@
+/********************************************************************
+ * utest-gnc-slots-sql.cpp:                                         *
+ *      GLib g_test test suite for saving slots to an SQL db.       *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+********************************************************************/
+#include "config.h"
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <unittest-support.h>
+#include "qofinstance-p.h"
+/* Add specific headers for this class */
+#include "../gnc-backend-sql.h"
+#include "../gnc-slots-sql.h"
+#include "gnc-sqlite3-connection.h"
+
+static const gchar *suitename = "/backend/sql/gnc-slots-sql";
+void test_suite_gnc_slots_sql (void);
+
+/* A connection which hands everything to an SQLite3 connection and keeps
+ * the SQL of the statements it executes. */
+typedef struct
+{
+    GncSqlConnection base;
+    GncSqlConnection *real;
+    GList *sql;
+} RecordingConnection;
+
+typedef struct
+{
+    gchar *path;
+    RecordingConnection *conn;
+    GncSqlBackend be;
+    QofBook *book;
+    QofInstance *inst;
+} Fixture;
+
+static void
+record_sql (RecordingConnection *conn, GncSqlStatement *stmt)
+{
+    conn->sql = g_list_append (conn->sql,
+                               g_strdup (gnc_sql_statement_to_sql (stmt)));
+}
+
+static GncSqlResult*
+recording_execute_select (GncSqlConnection *conn, GncSqlStatement *stmt)
+{
+    RecordingConnection *rconn = (RecordingConnection*)conn;
+    record_sql (rconn, stmt);
+    return gnc_sql_connection_execute_select_statement (rconn->real, stmt);
+}
+
+static gint
+recording_execute_nonselect (GncSqlConnection *conn, GncSqlStatement *stmt)
+{
+    RecordingConnection *rconn = (RecordingConnection*)conn;
+    record_sql (rconn, stmt);
+    return gnc_sql_connection_execute_nonselect_statement (rconn->real, stmt);
+}
+
+/* The rest only unwrap the connection */
+#define REAL(CONN) (((RecordingConnection*)(CONN))->real)
+
+static GncSqlStatement*
+recording_create_statement (GncSqlConnection *conn, const char *sql)
+{
+    return gnc_sql_connection_create_statement_from_sql (REAL (conn), sql);
+}
+
+static gboolean
+recording_does_table_exist (GncSqlConnection *conn, const char *name)
+{
+    return gnc_sql_connection_does_table_exist (REAL (conn), name);
+}
+
+static gboolean
+recording_begin (GncSqlConnection *conn)
+{
+    return gnc_sql_connection_begin_transaction (REAL (conn));
+}
+
+static gboolean
+recording_rollback (GncSqlConnection *conn)
+{
+    return gnc_sql_connection_rollback_transaction (REAL (conn));
+}
+
+static gboolean
+recording_commit (GncSqlConnection *conn)
+{
+    return gnc_sql_connection_commit_transaction (REAL (conn));
+}
+
+static gboolean
+recording_create_table (GncSqlConnection *conn, const char *name, GList *cols)
+{
+    return gnc_sql_connection_create_table (REAL (conn), name, cols);
+}
+
+static gboolean
+recording_create_index (GncSqlConnection *conn, const char *index,
+                        const char *table, const GncSqlColumnTableEntry *col_table)
+{
+    return gnc_sql_connection_create_index (REAL (conn), index, table, col_table);
+}
+
+static gboolean
+recording_add_columns (GncSqlConnection *conn, const char *table, GList *cols)
+{
+    return gnc_sql_connection_add_columns_to_table (REAL (conn), table, cols);
+}
+
+static char*
+recording_quote_string (const GncSqlConnection *conn, char *str)
+{
+    return gnc_sql_connection_quote_string (REAL (conn), str);
+}
+
+static char*
+recording_upsert_clause (const GncSqlConnection *conn, const char *key_col,
+                         GList *col_names, gboolean update)
+{
+    return gnc_sql_connection_upsert_clause (REAL (conn), key_col, col_names, update);
+}
+
+static void
+recording_clear (RecordingConnection *conn)
+{
+    g_list_foreach (conn->sql, (GFunc)g_free, NULL);
+    g_list_free (conn->sql);
+    conn->sql = NULL;
+}
+
+static void
+recording_dispose (GncSqlConnection *conn)
+{
+    RecordingConnection *rconn = (RecordingConnection*)conn;
+    recording_clear (rconn);
+    gnc_sql_connection_dispose (rconn->real);
+    g_free (rconn);
+}
+
+static RecordingConnection*
+recording_connection_new (GncSqlConnection *real)
+{
+    RecordingConnection *conn = g_new0 (RecordingConnection, 1);
+    conn->base.dispose = recording_dispose;
+    conn->base.executeSelectStatement = recording_execute_select;
+    conn->base.executeNonSelectStatement = recording_execute_nonselect;
+    conn->base.createStatementFromSql = recording_create_statement;
+    conn->base.doesTableExist = recording_does_table_exist;
+    conn->base.beginTransaction = recording_begin;
+    conn->base.rollbackTransaction = recording_rollback;
+    conn->base.commitTransaction = recording_commit;
+    conn->base.createTable = recording_create_table;
+    conn->base.createIndex = recording_create_index;
+    conn->base.addColumnsToTable = recording_add_columns;
+    conn->base.quoteString = recording_quote_string;
+    conn->base.upsertClause = real->upsertClause != NULL ? recording_upsert_clause : NULL;
+    conn->real = real;
+    return conn;
+}
+
+/* Number of recorded statements which start with verb */
+static gint
+count_sql (RecordingConnection *conn, const gchar *verb)
+{
+    GList *node;
+    gint count = 0;
+    for (node = conn->sql; node != NULL; node = node->next)
+        if (g_str_has_prefix ((gchar*)node->data, verb))
+            count++;
+    return count;
+}
+
+/* Whether any recorded statement names the slot path */
+static gboolean
+sql_mentions (RecordingConnection *conn, const gchar *path)
+{
+    gchar *quoted = g_strdup_printf ("'%s'", path);
+    GList *node;
+    gboolean found = FALSE;
+    for (node = conn->sql; node != NULL && !found; node = node->next)
+        found = (strstr ((gchar*)node->data, quoted) != NULL);
+    g_free (quoted);
+    return found;
+}
+
+static void
+init_backend (GncSqlBackend *be, GncSqlConnection *conn)
+{
+    memset (be, 0, sizeof (GncSqlBackend));
+    be->conn = conn;
+    be->timespec_format = SQLITE3_TIMESPEC_STR_FORMAT;
+    gnc_sql_init (be);
+}
+
+static void
+setup (Fixture *fixture, gconstpointer pData)
+{
+    GncSqlObjectBackend *slots_be;
+    gint fd = g_file_open_tmp ("test-sqlbe-XXXXXX", &fixture->path, NULL);
+    g_assert (fd >= 0);
+    close (fd);
+    fixture->conn = recording_connection_new (
+                        gnc_sqlite3_connection_open (NULL, fixture->path));
+
+    init_backend (&fixture->be, (GncSqlConnection*)fixture->conn);
+    gnc_sql_init_version_info (&fixture->be);
+    slots_be = (GncSqlObjectBackend*)qof_object_lookup_backend ("slots", GNC_SQL_BACKEND);
+    g_assert (slots_be != NULL);
+    (slots_be->create_tables) (&fixture->be);
+
+    fixture->book = qof_book_new ();
+    fixture->inst = new QofInstance;
+    qof_instance_init_data (fixture->inst, QOF_ID_NULL, fixture->book);
+}
+
+static void
+teardown (Fixture *fixture, gconstpointer pData)
+{
+    gchar *wal = g_strconcat (fixture->path, "-wal", NULL);
+    gchar *shm = g_strconcat (fixture->path, "-shm", NULL);
+
+    delete fixture->inst;
+    qof_book_destroy (fixture->book);
+    gnc_sql_slots_forget_all (&fixture->be);
+    gnc_sql_finalize_version_info (&fixture->be);
+    gnc_sql_connection_dispose ((GncSqlConnection*)fixture->conn);
+    g_unlink (fixture->path);
+    g_unlink (wal);
+    g_unlink (shm);
+    g_free (wal);
+    g_free (shm);
+    g_free (fixture->path);
+}
+
+static gboolean
+save_slots (Fixture *fixture, gboolean is_infant)
+{
+    recording_clear (fixture->conn);
+    return gnc_sql_slots_save (&fixture->be, qof_instance_get_guid (fixture->inst),
+                               is_infant, qof_instance_get_slots (fixture->inst));
+}
+
+/* Reads the slots back with a backend which has nothing cached and checks
+ * that they are what the instance has. */
+static void
+check_round_trip (Fixture *fixture)
+{
+    GncSqlBackend be;
+    QofBook *book = qof_book_new ();
+    QofInstance *inst = new QofInstance;
+
+    qof_instance_init_data (inst, QOF_ID_NULL, book);
+    qof_instance_set_guid (inst, qof_instance_get_guid (fixture->inst));
+    init_backend (&be, fixture->conn->real);
+    gnc_sql_slots_load (&be, inst);
+    g_assert_cmpint (kvp_frame_compare (qof_instance_get_slots (inst),
+                                        qof_instance_get_slots (fixture->inst)), == , 0);
+
+    gnc_sql_slots_forget_all (&be);
+    delete inst;
+    qof_book_destroy (book);
+}
+
+static void
+test_slots_save_scalars (Fixture *fixture, gconstpointer pData)
+{
+    KvpFrame *frame = qof_instance_get_slots (fixture->inst);
+
+    kvp_frame_set_gint64 (frame, "int", 1);
+    kvp_frame_set_string (frame, "string", "old");
+    kvp_frame_set_double (frame, "double", 2.5);
+    g_assert (save_slots (fixture, TRUE));
+    g_assert_cmpint (count_sql (fixture->conn, "INSERT"), == , 3);
+    check_round_trip (fixture);
+
+    /* Saving an unchanged frame writes nothing and reads nothing */
+    g_assert (save_slots (fixture, FALSE));
+    g_assert (fixture->conn->sql == NULL);
+
+    kvp_frame_set_string (frame, "string", "new");
+    kvp_frame_set_slot (frame, "double", NULL);
+    kvp_frame_set_numeric (frame, "numeric", gnc_numeric_create (1, 3));
+    g_assert (save_slots (fixture, FALSE));
+    g_assert_cmpint (count_sql (fixture->conn, "SELECT"), == , 1);
+    g_assert_cmpint (count_sql (fixture->conn, "DELETE"), == , 2);
+    g_assert_cmpint (count_sql (fixture->conn, "INSERT"), == , 2);
+    g_assert (!sql_mentions (fixture->conn, "int"));
+    g_assert (sql_mentions (fixture->conn, "string"));
+    g_assert (sql_mentions (fixture->conn, "double"));
+    g_assert (sql_mentions (fixture->conn, "numeric"));
+    check_round_trip (fixture);
+}
+
+static void
+test_slots_save_nested_frames (Fixture *fixture, gconstpointer pData)
+{
+    KvpFrame *frame = qof_instance_get_slots (fixture->inst);
+
+    kvp_frame_set_gint64 (frame, "outer/inner/changed", 1);
+    kvp_frame_set_gint64 (frame, "outer/inner/kept", 2);
+    kvp_frame_set_string (frame, "outer/sibling", "kept");
+    g_assert (save_slots (fixture, TRUE));
+    check_round_trip (fixture);
+
+    /* Only the changed leaf is rewritten.  Reading the stored slots back
+     * takes one select per frame and finding the frames the leaf lives in
+     * one lookup per level. */
+    kvp_frame_set_gint64 (frame, "outer/inner/changed", 3);
+    g_assert (save_slots (fixture, FALSE));
+    g_assert_cmpint (count_sql (fixture->conn, "SELECT"), == , 5);
+    g_assert_cmpint (count_sql (fixture->conn, "DELETE"), == , 1);
+    g_assert_cmpint (count_sql (fixture->conn, "INSERT"), == , 1);
+    g_assert (sql_mentions (fixture->conn, "outer/inner/changed"));
+    g_assert (!sql_mentions (fixture->conn, "outer/inner/kept"));
+    g_assert (!sql_mentions (fixture->conn, "outer/sibling"));
+    check_round_trip (fixture);
+
+    /* Adding and removing whole frames */
+    kvp_frame_set_gint64 (frame, "added/leaf", 4);
+    kvp_frame_set_value (frame, "outer/inner", NULL);
+    g_assert (save_slots (fixture, FALSE));
+    g_assert (sql_mentions (fixture->conn, "added"));
+    g_assert (sql_mentions (fixture->conn, "added/leaf"));
+    g_assert (sql_mentions (fixture->conn, "outer/inner"));
+    g_assert (!sql_mentions (fixture->conn, "outer/sibling"));
+    check_round_trip (fixture);
+}
+
+static void
+test_slots_save_lists (Fixture *fixture, gconstpointer pData)
+{
+    KvpFrame *frame = qof_instance_get_slots (fixture->inst);
+    GList *list = NULL;
+
+    list = g_list_append (list, kvp_value_new_gint64 (1));
+    list = g_list_append (list, kvp_value_new_string ("two"));
+    kvp_frame_set_slot_nc (frame, "list", kvp_value_new_glist_nc (list));
+    kvp_frame_set_gint64 (frame, "other", 5);
+    g_assert (save_slots (fixture, TRUE));
+    check_round_trip (fixture);
+
+    /* A changed list is replaced whole */
+    list = g_list_append (NULL, kvp_value_new_gint64 (1));
+    list = g_list_append (list, kvp_value_new_string ("two"));
+    list = g_list_append (list, kvp_value_new_double (3.0));
+    kvp_frame_set_slot_nc (frame, "list", kvp_value_new_glist_nc (list));
+    g_assert (save_slots (fixture, FALSE));
+    g_assert_cmpint (count_sql (fixture->conn, "INSERT"), == , 4);
+    g_assert (!sql_mentions (fixture->conn, "other"));
+    check_round_trip (fixture);
+
+    kvp_frame_set_slot (frame, "list", NULL);
+    g_assert (save_slots (fixture, FALSE));
+    g_assert_cmpint (count_sql (fixture->conn, "INSERT"), == , 0);
+    g_assert (!sql_mentions (fixture->conn, "other"));
+    check_round_trip (fixture);
+}
+
+/* A changed frame is diffed against the slots read back from the db; an
+ * unchanged one, with the digest kept by the last load or save, isn't. */
+static void
+test_slots_save_uncached (Fixture *fixture, gconstpointer pData)
+{
+    KvpFrame *frame = qof_instance_get_slots (fixture->inst);
+
+    kvp_frame_set_gint64 (frame, "a", 1);
+    kvp_frame_set_gint64 (frame, "b", 2);
+    g_assert (save_slots (fixture, TRUE));
+
+    /* Without a digest even an unchanged frame is read back and diffed */
+    gnc_sql_slots_forget_all (&fixture->be);
+    g_assert (save_slots (fixture, FALSE));
+    g_assert_cmpint (count_sql (fixture->conn, "SELECT"), == , 1);
+    g_assert_cmpint (count_sql (fixture->conn, "INSERT"), == , 0);
+    g_assert_cmpint (count_sql (fixture->conn, "DELETE"), == , 0);
+
+    kvp_frame_set_gint64 (frame, "a", 3);
+    g_assert (save_slots (fixture, FALSE));
+    g_assert_cmpint (count_sql (fixture->conn, "SELECT"), == , 1);
+    g_assert (!sql_mentions (fixture->conn, "b"));
+    check_round_trip (fixture);
+
+    /* Loading the slots keeps a digest too */
+    gnc_sql_slots_forget_all (&fixture->be);
+    qof_instance_set_slots (fixture->inst, kvp_frame_new ());
+    gnc_sql_slots_load (&fixture->be, fixture->inst);
+    g_assert (save_slots (fixture, FALSE));
+    g_assert (fixture->conn->sql == NULL);
+    frame = qof_instance_get_slots (fixture->inst);
+    kvp_frame_set_gint64 (frame, "b", 5);
+    g_assert (save_slots (fixture, FALSE));
+    g_assert_cmpint (count_sql (fixture->conn, "SELECT"), == , 1);
+    g_assert (!sql_mentions (fixture->conn, "a"));
+    check_round_trip (fixture);
+
+    /* Deleting the slots drops the digest */
+    g_assert (gnc_sql_slots_delete (&fixture->be, qof_instance_get_guid (fixture->inst)));
+    recording_clear (fixture->conn);
+    g_assert (save_slots (fixture, FALSE));
+    g_assert_cmpint (count_sql (fixture->conn, "SELECT"), == , 1);
+    g_assert_cmpint (count_sql (fixture->conn, "INSERT"), == , 2);
+    check_round_trip (fixture);
+}
+
+/* Frames with the same slots have the same digest whatever order the
+ * slots were set in, and any change to a nested value is noticed. */
+static void
+test_slots_save_digest (Fixture *fixture, gconstpointer pData)
+{
+    KvpFrame *frame = qof_instance_get_slots (fixture->inst);
+    KvpFrame *other = kvp_frame_new ();
+    GList *list = NULL;
+
+    kvp_frame_set_gint64 (frame, "one", 1);
+    kvp_frame_set_string (frame, "deep/two", "2");
+    kvp_frame_set_gint64 (frame, "deep/er/three", 3);
+    list = g_list_append (list, kvp_value_new_gint64 (1));
+    list = g_list_append (list, kvp_value_new_gint64 (2));
+    kvp_frame_set_slot_nc (frame, "list", kvp_value_new_glist_nc (list));
+    g_assert (save_slots (fixture, TRUE));
+
+    kvp_frame_set_gint64 (other, "deep/er/three", 3);
+    list = g_list_append (NULL, kvp_value_new_gint64 (1));
+    list = g_list_append (list, kvp_value_new_gint64 (2));
+    kvp_frame_set_slot_nc (other, "list", kvp_value_new_glist_nc (list));
+    kvp_frame_set_string (other, "deep/two", "2");
+    kvp_frame_set_gint64 (other, "one", 1);
+    qof_instance_set_slots (fixture->inst, other);
+    g_assert (save_slots (fixture, FALSE));
+    g_assert (fixture->conn->sql == NULL);
+
+    kvp_frame_set_gint64 (other, "deep/er/three", 4);
+    g_assert (save_slots (fixture, FALSE));
+    g_assert_cmpint (count_sql (fixture->conn, "INSERT"), == , 1);
+    check_round_trip (fixture);
+
+    /* Reordering a list is a change */
+    list = g_list_append (NULL, kvp_value_new_gint64 (2));
+    list = g_list_append (list, kvp_value_new_gint64 (1));
+    kvp_frame_set_slot_nc (other, "list", kvp_value_new_glist_nc (list));
+    g_assert (save_slots (fixture, FALSE));
+    g_assert_cmpint (count_sql (fixture->conn, "INSERT"), == , 3);
+    check_round_trip (fixture);
+}
+
+void
+test_suite_gnc_slots_sql (void)
+{
+    GNC_TEST_ADD (suitename, "slots save scalars", Fixture, NULL, setup, test_slots_save_scalars, teardown);
+    GNC_TEST_ADD (suitename, "slots save nested frames", Fixture, NULL, setup, test_slots_save_nested_frames, teardown);
+    GNC_TEST_ADD (suitename, "slots save lists", Fixture, NULL, setup, test_slots_save_lists, teardown);
+    GNC_TEST_ADD (suitename, "slots save uncached", Fixture, NULL, setup, test_slots_save_uncached, teardown);
+    GNC_TEST_ADD (suitename, "slots save digest", Fixture, NULL, setup, test_slots_save_digest, teardown);
+}
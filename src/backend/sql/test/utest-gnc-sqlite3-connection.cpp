@@ -0,0 +1,694 @@
+/********************************************************************
+ * utest-gnc-sqlite3-connection.cpp:                                *
+ *      GLib g_test test suite for the native SQLite3 connection.   *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+********************************************************************/
+#include "config.h"
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <unittest-support.h>
+/* Add specific headers for this class */
+#include "../gnc-backend-sql.h"
+#include "gnc-sqlite3-connection.h"
+#include "Account.h"
+#include "Transaction.h"
+#include "gnc-commodity.h"
+
+static const gchar *suitename = "/backend/sql/gnc-sqlite3-connection";
+void test_suite_gnc_sqlite3_connection (void);
+
+#define TEST_TABLE "test_table"
+#define BENCH_ROWS 1000
+#define BENCH_ROWS_PERF 100000
+#define BENCH_ACCOUNTS 20
+#define BENCH_TXNS 1000
+#define BENCH_TXNS_PERF 50000
+#define WINDOW_TXNS 100
+#define WINDOW_DAYS 30
+
+typedef struct
+{
+    gchar *path;
+    GncSqlConnection *conn;
+} Fixture;
+
+static void
+setup (Fixture *fixture, gconstpointer pData)
+{
+    gint fd = g_file_open_tmp ("test-sqlbe-XXXXXX", &fixture->path, NULL);
+    g_assert (fd >= 0);
+    close (fd);
+    fixture->conn = gnc_sqlite3_connection_open (NULL, fixture->path);
+    g_assert (fixture->conn != NULL);
+}
+
+static void
+teardown (Fixture *fixture, gconstpointer pData)
+{
+    gchar *wal = g_strconcat (fixture->path, "-wal", NULL);
+    gchar *shm = g_strconcat (fixture->path, "-shm", NULL);
+
+    gnc_sql_connection_dispose (fixture->conn);
+    g_unlink (fixture->path);
+    g_unlink (wal);
+    g_unlink (shm);
+    g_free (wal);
+    g_free (shm);
+    g_free (fixture->path);
+}
+
+static GncSqlColumnInfo*
+make_col_info (const gchar *name, GncSqlBasicColumnType type, gint size,
+               gboolean pkey, gboolean null_allowed)
+{
+    GncSqlColumnInfo *info = g_new0 (GncSqlColumnInfo, 1);
+    info->name = g_strdup (name);
+    info->type = type;
+    info->size = size;
+    info->is_primary_key = pkey;
+    info->null_allowed = null_allowed;
+    return info;
+}
+
+static gboolean
+create_test_table (GncSqlConnection *conn)
+{
+    GList *cols = NULL;
+    cols = g_list_append (cols, make_col_info ("guid", BCT_STRING, 32, TRUE, FALSE));
+    cols = g_list_append (cols, make_col_info ("name", BCT_STRING, 50, FALSE, TRUE));
+    cols = g_list_append (cols, make_col_info ("num", BCT_INT64, 0, FALSE, TRUE));
+    cols = g_list_append (cols, make_col_info ("post_date", BCT_DATETIME, 0, FALSE, TRUE));
+    return gnc_sql_connection_create_table (conn, TEST_TABLE, cols);
+}
+
+static gint
+execute_nonselect (GncSqlConnection *conn, const gchar *sql)
+{
+    GncSqlStatement *stmt = gnc_sql_connection_create_statement_from_sql (conn, sql);
+    gint result = gnc_sql_connection_execute_nonselect_statement (conn, stmt);
+    gnc_sql_statement_dispose (stmt);
+    return result;
+}
+
+static GncSqlResult*
+execute_select (GncSqlConnection *conn, const gchar *sql)
+{
+    GncSqlStatement *stmt = gnc_sql_connection_create_statement_from_sql (conn, sql);
+    GncSqlResult *result = gnc_sql_connection_execute_select_statement (conn, stmt);
+    gnc_sql_statement_dispose (stmt);
+    return result;
+}
+
+static gint
+count_rows (GncSqlConnection *conn)
+{
+    GncSqlResult *result = execute_select (conn, "SELECT * FROM " TEST_TABLE);
+    gint count = (gint)gnc_sql_result_get_num_rows (result);
+    gnc_sql_result_dispose (result);
+    return count;
+}
+
+/* gnc_sqlite3_connection_open
+GncSqlConnection*
+gnc_sqlite3_connection_open (QofBackend* qbe, const char* path)// C: 1 */
+static void
+test_gnc_sqlite3_connection_open (Fixture *fixture, gconstpointer pData)
+{
+    GncSqlResult *result;
+    GncSqlRow *row;
+
+    result = execute_select (fixture->conn, "PRAGMA journal_mode");
+    g_assert (result != NULL);
+    row = gnc_sql_result_get_first_row (result);
+    g_assert (row != NULL);
+    g_assert_cmpstr (gnc_sql_row_get_string_at_col_index (row, 0), == , "wal");
+    gnc_sql_result_dispose (result);
+
+    result = execute_select (fixture->conn, "PRAGMA synchronous");
+    row = gnc_sql_result_get_first_row (result);
+    /* NORMAL */
+    g_assert_cmpint (g_value_get_int64 (gnc_sql_row_get_value_at_col_index (row, 0)), == , 1);
+    gnc_sql_result_dispose (result);
+
+    g_assert (gnc_sqlite3_is_sqlite3_file (fixture->path));
+}
+/* conn_create_table
+static gboolean
+conn_create_table (GncSqlConnection* conn, const gchar* table_name, GList* col_info_list)// 1
+*/
+static void
+test_conn_create_table (Fixture *fixture, gconstpointer pData)
+{
+    GList *cols = NULL;
+    GncSqlColumnTableEntry index_cols[] =
+    {
+        { "name", CT_STRING, 50, 0 },
+        { NULL }
+    };
+    GncSqlResult *result;
+    GncSqlRow *row;
+    guint loglevel = G_LOG_LEVEL_CRITICAL | G_LOG_FLAG_FATAL;
+    gchar *msg = "[exec_sql()] SQL error: table " TEST_TABLE " already exists "
+                 "(CREATE TABLE " TEST_TABLE " (guid text(32) PRIMARY KEY NOT NULL, "
+                 "name text(50), num bigint, post_date text(14)))";
+    TestErrorStruct check = { loglevel, "gnc.backend.sqlite3", msg, 0 };
+    GLogFunc oldlogger;
+
+    g_assert (!gnc_sql_connection_does_table_exist (fixture->conn, TEST_TABLE));
+    g_assert (create_test_table (fixture->conn));
+    g_assert (gnc_sql_connection_does_table_exist (fixture->conn, TEST_TABLE));
+    /* Creating it twice is an error */
+    oldlogger = g_log_set_default_handler ((GLogFunc)test_null_handler, &check);
+    g_test_log_set_fatal_handler ((GTestLogFatalFunc)test_checked_handler, &check);
+    g_assert (!create_test_table (fixture->conn));
+    g_assert_cmpint (check.hits, ==, 1);
+    g_log_set_default_handler (oldlogger, NULL);
+
+    cols = g_list_append (cols, make_col_info ("extra", BCT_INT, 0, FALSE, TRUE));
+    cols = g_list_append (cols, make_col_info ("amount", BCT_DOUBLE, 0, FALSE, TRUE));
+    g_assert (gnc_sql_connection_add_columns_to_table (fixture->conn, TEST_TABLE, cols));
+    g_assert (gnc_sql_connection_create_index (fixture->conn, "test_name_index",
+              TEST_TABLE, index_cols));
+
+    result = execute_select (fixture->conn, "SELECT * FROM " TEST_TABLE);
+    g_assert (result != NULL);
+    g_assert_cmpint (gnc_sql_result_get_col_index (result, "guid"), == , 0);
+    g_assert_cmpint (gnc_sql_result_get_col_index (result, "amount"), == , 5);
+    g_assert_cmpint (gnc_sql_result_get_col_index (result, "nonesuch"), == , -1);
+    row = gnc_sql_result_get_first_row (result);
+    g_assert (row == NULL);
+    gnc_sql_result_dispose (result);
+}
+/* conn_quote_string
+static gchar*
+conn_quote_string (const GncSqlConnection* conn, gchar* unquoted_str)// 1
+*/
+static void
+test_conn_quote_string (Fixture *fixture, gconstpointer pData)
+{
+    gchar *quoted;
+
+    quoted = gnc_sql_connection_quote_string (fixture->conn, (gchar*)"Joe's Bar");
+    g_assert_cmpstr (quoted, == , "'Joe''s Bar'");
+    g_free (quoted);
+}
+/* conn_upsert_clause
+static gchar*
+conn_upsert_clause (const GncSqlConnection* conn, const gchar* key_col, GList* col_names, gboolean update)// 1
+*/
+static void
+test_conn_upsert_clause (Fixture *fixture, gconstpointer pData)
+{
+    GList *cols = NULL;
+    GncSqlResult *result;
+    GncSqlRow *row;
+    gchar *clause;
+    gchar *sql;
+
+    if (fixture->conn->upsertClause == NULL)
+    {
+        g_test_message ("SQLite is older than 3.24, no upsert clause");
+        return;
+    }
+
+    g_assert (create_test_table (fixture->conn));
+    cols = g_list_append (cols, (gpointer)"guid");
+    cols = g_list_append (cols, (gpointer)"name");
+    cols = g_list_append (cols, (gpointer)"num");
+
+    clause = gnc_sql_connection_upsert_clause (fixture->conn, "guid", cols, TRUE);
+    g_assert_cmpstr (clause, == ,
+                     " ON CONFLICT(guid) DO UPDATE SET name=excluded.name,num=excluded.num");
+    sql = g_strdup_printf ("INSERT INTO " TEST_TABLE "(guid,name,num) VALUES('a','first',1)%s", clause);
+    g_assert_cmpint (execute_nonselect (fixture->conn, sql), == , 1);
+    g_free (sql);
+    sql = g_strdup_printf ("INSERT INTO " TEST_TABLE "(guid,name,num) VALUES('a','second',2)%s", clause);
+    g_assert_cmpint (execute_nonselect (fixture->conn, sql), == , 1);
+    g_free (sql);
+    g_free (clause);
+
+    clause = gnc_sql_connection_upsert_clause (fixture->conn, "guid", cols, FALSE);
+    g_assert_cmpstr (clause, == , " ON CONFLICT(guid) DO NOTHING");
+    sql = g_strdup_printf ("INSERT INTO " TEST_TABLE "(guid,name,num) VALUES('a','third',3)%s", clause);
+    /* The row is already there, so nothing changes */
+    g_assert_cmpint (execute_nonselect (fixture->conn, sql), == , 0);
+    g_free (sql);
+    g_free (clause);
+    g_list_free (cols);
+
+    g_assert_cmpint (count_rows (fixture->conn), == , 1);
+    result = execute_select (fixture->conn, "SELECT * FROM " TEST_TABLE);
+    row = gnc_sql_result_get_first_row (result);
+    g_assert_cmpstr (gnc_sql_row_get_string_at_col_index (row, 1), == , "second");
+    gnc_sql_result_dispose (result);
+}
+/* result_get_first_row
+static GncSqlRow*
+result_get_first_row (GncSqlResult* result)// 1
+*/
+static void
+test_result_rows (Fixture *fixture, gconstpointer pData)
+{
+    const gchar *guid_str = "0123456789abcdef0123456789abcdef";
+    GncGUID guid, expected_guid;
+    GncSqlResult *result;
+    GncSqlRow *row;
+    const GValue *value;
+    gint64 num;
+    gchar *sql;
+
+    g_assert (create_test_table (fixture->conn));
+    sql = g_strdup_printf ("INSERT INTO " TEST_TABLE " VALUES ('%s', 'first', 42, '20120521103000')",
+                           guid_str);
+    g_assert_cmpint (execute_nonselect (fixture->conn, sql), == , 1);
+    g_free (sql);
+    g_assert_cmpint (execute_nonselect (fixture->conn,
+                     "INSERT INTO " TEST_TABLE " VALUES ('fedcba9876543210fedcba9876543210', NULL, NULL, NULL)"),
+                     == , 1);
+    g_assert_cmpint (execute_nonselect (fixture->conn,
+                     "UPDATE " TEST_TABLE " SET num = 7 WHERE num = 42"), == , 1);
+
+    result = execute_select (fixture->conn,
+                             "SELECT * FROM " TEST_TABLE " ORDER BY guid");
+    row = gnc_sql_result_get_first_row (result);
+    g_assert (row != NULL);
+
+    /* Values by name */
+    value = gnc_sql_row_get_value_at_col_name (row, "name");
+    g_assert (G_VALUE_HOLDS_STRING (value));
+    g_assert_cmpstr (g_value_get_string (value), == , "first");
+    value = gnc_sql_row_get_value_at_col_name (row, "num");
+    g_assert (G_VALUE_HOLDS_INT64 (value));
+    g_assert_cmpint (g_value_get_int64 (value), == , 7);
+    /* Dates are kept as text, not converted by column affinity */
+    value = gnc_sql_row_get_value_at_col_name (row, "post_date");
+    g_assert (G_VALUE_HOLDS_STRING (value));
+    g_assert_cmpstr (g_value_get_string (value), == , "20120521103000");
+
+    /* Values by index */
+    g_assert (gnc_sql_row_get_guid_at_col_index (row, 0, &guid));
+    g_assert (string_to_guid (guid_str, &expected_guid));
+    g_assert (guid_equal (&guid, &expected_guid));
+    g_assert_cmpstr (gnc_sql_row_get_string_at_col_index (row, 1), == , "first");
+    g_assert (gnc_sql_row_get_int64_at_col_index (row, 2, &num));
+    g_assert_cmpint (num, == , 7);
+
+    /* Counting the rows doesn't move the cursor */
+    g_assert_cmpint (gnc_sql_result_get_num_rows (result), == , 2);
+    g_assert_cmpstr (gnc_sql_row_get_string_at_col_index (row, 1), == , "first");
+
+    row = gnc_sql_result_get_next_row (result);
+    g_assert (row != NULL);
+    /* NULL text is a string value holding NULL, other NULLs are no value */
+    value = gnc_sql_row_get_value_at_col_name (row, "name");
+    g_assert (G_VALUE_HOLDS_STRING (value));
+    g_assert (g_value_get_string (value) == NULL);
+    g_assert (gnc_sql_row_get_string_at_col_index (row, 1) == NULL);
+    g_assert (gnc_sql_row_get_value_at_col_name (row, "post_date") != NULL);
+    g_assert (gnc_sql_row_get_value_at_col_name (row, "num") == NULL);
+    g_assert (!gnc_sql_row_get_int64_at_col_index (row, 2, &num));
+
+    g_assert (gnc_sql_result_get_next_row (result) == NULL);
+    g_assert (gnc_sql_result_get_next_row (result) == NULL);
+
+    /* And the result can be read again from the start */
+    row = gnc_sql_result_get_first_row (result);
+    g_assert (row != NULL);
+    g_assert_cmpstr (gnc_sql_row_get_string_at_col_index (row, 1), == , "first");
+    gnc_sql_result_dispose (result);
+}
+/* conn_begin_transaction
+static gboolean
+conn_begin_transaction (GncSqlConnection* conn)// 1
+*/
+static void
+test_conn_transactions (Fixture *fixture, gconstpointer pData)
+{
+    g_assert (create_test_table (fixture->conn));
+
+    g_assert (gnc_sql_connection_begin_transaction (fixture->conn));
+    g_assert_cmpint (execute_nonselect (fixture->conn,
+                     "INSERT INTO " TEST_TABLE " (guid) VALUES ('a')"), == , 1);
+    g_assert (gnc_sql_connection_rollback_transaction (fixture->conn));
+    g_assert_cmpint (count_rows (fixture->conn), == , 0);
+
+    g_assert (gnc_sql_connection_begin_transaction (fixture->conn));
+    g_assert_cmpint (execute_nonselect (fixture->conn,
+                     "INSERT INTO " TEST_TABLE " (guid) VALUES ('a')"), == , 1);
+    g_assert (gnc_sql_connection_commit_transaction (fixture->conn));
+    g_assert_cmpint (count_rows (fixture->conn), == , 1);
+
+    /* Rolling back with no transaction open is harmless */
+    g_assert (gnc_sql_connection_rollback_transaction (fixture->conn));
+}
+/* Insert and read back a block of rows the way a save and a load do.  Run
+ * with -m perf for a larger data set and timings. */
+static void
+test_conn_bulk_insert_select (Fixture *fixture, gconstpointer pData)
+{
+    gint n_rows = g_test_perf () ? BENCH_ROWS_PERF : BENCH_ROWS;
+    GncSqlResult *result;
+    GncSqlRow *row;
+    GncGUID guid;
+    gint64 total = 0, expected = 0;
+    gint guid_col, num_col, i, count = 0;
+    gdouble elapsed;
+
+    g_assert (create_test_table (fixture->conn));
+
+    g_test_timer_start ();
+    g_assert (gnc_sql_connection_begin_transaction (fixture->conn));
+    for (i = 0; i < n_rows; i++)
+    {
+        gchar *sql;
+        gchar guid_str[GUID_ENCODING_LENGTH + 1];
+
+        guid_new (&guid);
+        guid_to_string_buff (&guid, guid_str);
+        sql = g_strdup_printf ("INSERT INTO " TEST_TABLE
+                               " VALUES ('%s', 'row %d', %d, '20120101000000')",
+                               guid_str, i, i);
+        g_assert_cmpint (execute_nonselect (fixture->conn, sql), == , 1);
+        g_free (sql);
+        expected += i;
+    }
+    g_assert (gnc_sql_connection_commit_transaction (fixture->conn));
+    elapsed = g_test_timer_elapsed ();
+    if (g_test_perf ())
+        g_test_minimized_result (elapsed, "Inserted %d rows in %g seconds",
+                                 n_rows, elapsed);
+
+    g_test_timer_start ();
+    result = execute_select (fixture->conn, "SELECT * FROM " TEST_TABLE);
+    guid_col = gnc_sql_result_get_col_index (result, "guid");
+    num_col = gnc_sql_result_get_col_index (result, "num");
+    for (row = gnc_sql_result_get_first_row (result); row != NULL;
+            row = gnc_sql_result_get_next_row (result))
+    {
+        gint64 num;
+        g_assert (gnc_sql_row_get_guid_at_col_index (row, guid_col, &guid));
+        g_assert (gnc_sql_row_get_int64_at_col_index (row, num_col, &num));
+        total += num;
+        count++;
+    }
+    gnc_sql_result_dispose (result);
+    elapsed = g_test_timer_elapsed ();
+    if (g_test_perf ())
+        g_test_minimized_result (elapsed, "Read %d rows in %g seconds",
+                                 n_rows, elapsed);
+
+    g_assert_cmpint (count, == , n_rows);
+    g_assert_cmpint (total, == , expected);
+}
+
+/* Results own their statements; disposing of the connection first must
+ * neither fail with SQLITE_BUSY nor invalidate the result. */
+static void
+test_conn_dispose_open_result (Fixture *fixture, gconstpointer pData)
+{
+    GncSqlResult *result;
+    GncSqlRow *row;
+
+    g_assert (create_test_table (fixture->conn));
+    g_assert_cmpint (execute_nonselect (fixture->conn,
+                     "INSERT INTO " TEST_TABLE " (guid, num) VALUES ('a', 1)"), == , 1);
+    g_assert_cmpint (execute_nonselect (fixture->conn,
+                     "INSERT INTO " TEST_TABLE " (guid, num) VALUES ('b', 2)"), == , 1);
+
+    result = execute_select (fixture->conn, "SELECT * FROM " TEST_TABLE);
+    row = gnc_sql_result_get_first_row (result);
+    g_assert (row != NULL);
+
+    gnc_sql_connection_dispose (fixture->conn);
+    row = gnc_sql_result_get_next_row (result);
+    g_assert (row != NULL);
+    gnc_sql_result_dispose (result);
+
+    /* teardown disposes of the fixture's connection */
+    fixture->conn = gnc_sqlite3_connection_open (NULL, fixture->path);
+    g_assert (fixture->conn != NULL);
+}
+
+static void
+init_sql_backend (GncSqlBackend *be, GncSqlConnection *conn)
+{
+    memset (be, 0, sizeof (GncSqlBackend));
+    be->conn = conn;
+    be->timespec_format = SQLITE3_TIMESPEC_STR_FORMAT;
+    gnc_sql_init (be);
+}
+
+/* A book of BENCH_ACCOUNTS bank accounts with n_txns two split
+ * transactions spread over them, one day apart and ending today.  Some of
+ * the splits are cleared or reconciled. */
+static void
+populate_book (QofBook *book, gint n_txns)
+{
+    gnc_commodity_table *table = gnc_commodity_table_get_table (book);
+    gnc_commodity *usd;
+    Account *root = gnc_book_get_root_account (book);
+    Account *accounts[BENCH_ACCOUNTS];
+    time64 start = gnc_time (NULL) - (time64)n_txns * 24 * 60 * 60;
+    gint i;
+
+    usd = gnc_commodity_new (book, "US Dollar", "ISO4217", "USD", "840", 100);
+    usd = gnc_commodity_table_insert (table, usd);
+
+    for (i = 0; i < BENCH_ACCOUNTS; i++)
+    {
+        gchar *name = g_strdup_printf ("Account %d", i);
+        accounts[i] = xaccMallocAccount (book);
+        xaccAccountBeginEdit (accounts[i]);
+        xaccAccountSetName (accounts[i], name);
+        xaccAccountSetType (accounts[i], ACCT_TYPE_BANK);
+        xaccAccountSetCommodity (accounts[i], usd);
+        gnc_account_append_child (root, accounts[i]);
+        xaccAccountCommitEdit (accounts[i]);
+        g_free (name);
+    }
+
+    for (i = 0; i < n_txns; i++)
+    {
+        Transaction *txn = xaccMallocTransaction (book);
+        Split *from = xaccMallocSplit (book);
+        Split *to = xaccMallocSplit (book);
+        gnc_numeric amount = gnc_numeric_create (100 + i, 100);
+
+        xaccTransBeginEdit (txn);
+        xaccTransSetCurrency (txn, usd);
+        xaccTransSetDatePostedSecs (txn, start + (time64)i * 24 * 60 * 60);
+        xaccTransSetDescription (txn, "Transfer");
+        xaccSplitSetParent (from, txn);
+        xaccSplitSetAccount (from, accounts[i % BENCH_ACCOUNTS]);
+        xaccSplitSetAmount (from, gnc_numeric_neg (amount));
+        xaccSplitSetValue (from, gnc_numeric_neg (amount));
+        xaccSplitSetReconcile (from, i % 3 == 0 ? YREC : CREC);
+        xaccSplitSetParent (to, txn);
+        xaccSplitSetAccount (to, accounts[(i + 1) % BENCH_ACCOUNTS]);
+        xaccSplitSetAmount (to, amount);
+        xaccSplitSetValue (to, amount);
+        if (i % 4 == 0)
+            xaccSplitSetReconcile (to, CREC);
+        xaccTransCommitEdit (txn);
+    }
+}
+
+/* Save a book through the SQL backend and load it back into a fresh one,
+ * the way a session does.  Run with -m perf for a larger book and
+ * timings. */
+static void
+test_sql_backend_save_load (Fixture *fixture, gconstpointer pData)
+{
+    gint n_txns = g_test_perf () ? BENCH_TXNS_PERF : BENCH_TXNS;
+    GncSqlBackend save_be, load_be;
+    QofBook *book = qof_book_new ();
+    QofBook *loaded;
+    Account *acc, *loaded_acc;
+    gdouble elapsed;
+
+    populate_book (book, n_txns);
+
+    /* gnc_sql_sync_all() creates the tables, so the file has to be empty */
+    init_sql_backend (&save_be, fixture->conn);
+    g_test_timer_start ();
+    gnc_sql_sync_all (&save_be, book);
+    elapsed = g_test_timer_elapsed ();
+    if (g_test_perf ())
+        g_test_minimized_result (elapsed, "Saved %d transactions in %g seconds",
+                                 n_txns, elapsed);
+    g_assert (!qof_book_session_not_saved (book));
+
+    loaded = qof_book_new ();
+    init_sql_backend (&load_be, fixture->conn);
+    g_test_timer_start ();
+    gnc_sql_init_version_info (&load_be);
+    gnc_sql_load (&load_be, loaded, LOAD_TYPE_INITIAL_LOAD);
+    elapsed = g_test_timer_elapsed ();
+    if (g_test_perf ())
+        g_test_minimized_result (elapsed, "Loaded %d transactions in %g seconds",
+                                 n_txns, elapsed);
+
+    g_assert_cmpint (gnc_account_n_descendants (gnc_book_get_root_account (loaded)),
+                     == , BENCH_ACCOUNTS);
+    g_assert_cmpint (gnc_book_count_transactions (loaded), == , n_txns);
+    acc = gnc_account_nth_child (gnc_book_get_root_account (book), 0);
+    loaded_acc = xaccAccountLookup (qof_instance_get_guid (acc), loaded);
+    g_assert (loaded_acc != NULL);
+    g_assert (gnc_numeric_equal (xaccAccountGetBalance (loaded_acc),
+                                 xaccAccountGetBalance (acc)));
+
+    gnc_sql_finalize_version_info (&save_be);
+    gnc_sql_finalize_version_info (&load_be);
+    qof_book_destroy (loaded);
+    qof_book_destroy (book);
+}
+
+typedef struct
+{
+    time64 since;
+    gint count;
+} CountData;
+
+static void
+count_since_cb (QofInstance *inst, gpointer data)
+{
+    CountData *count = (CountData*)data;
+    if (xaccTransGetDate ((Transaction*)inst) >= count->since)
+        count->count++;
+}
+
+static gint
+count_tx_since (QofBook *book, time64 since)
+{
+    CountData count = { since, 0 };
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_TRANS),
+                            count_since_cb, &count);
+    return count.count;
+}
+
+static void
+check_balances (QofBook *book, QofBook *loaded)
+{
+    Account *root = gnc_book_get_root_account (book);
+    gint i;
+
+    for (i = 0; i < gnc_account_n_children (root); i++)
+    {
+        Account *acc = gnc_account_nth_child (root, i);
+        Account *loaded_acc = xaccAccountLookup (qof_instance_get_guid (acc), loaded);
+
+        g_assert (loaded_acc != NULL);
+        g_assert (gnc_numeric_equal (xaccAccountGetBalance (loaded_acc),
+                                     xaccAccountGetBalance (acc)));
+        g_assert (gnc_numeric_equal (xaccAccountGetClearedBalance (loaded_acc),
+                                     xaccAccountGetClearedBalance (acc)));
+        g_assert (gnc_numeric_equal (xaccAccountGetReconciledBalance (loaded_acc),
+                                     xaccAccountGetReconciledBalance (acc)));
+    }
+}
+
+static void
+set_faulted_tx (gpointer pObject, gpointer pValue)
+{
+    *(Transaction**)pObject = (Transaction*)pValue;
+}
+
+/* Load only the last WINDOW_DAYS of transactions, then bring in older ones
+ * by reference, by date and all at once.  The account balances must match
+ * the saved book's at every step. */
+static void
+test_sql_backend_load_window (Fixture *fixture, gconstpointer pData)
+{
+    GncSqlColumnTableEntry tx_ref_table[] =
+    {
+        { "tx", CT_TXREF, 0, 0, NULL, (QofSetterFunc)set_faulted_tx },
+        { NULL }
+    };
+    GncSqlBackend save_be, load_be;
+    QofBook *book = qof_book_new ();
+    QofBook *loaded = qof_book_new ();
+    GncSqlResult *result;
+    GncSqlRow *row;
+    Transaction *tx = NULL;
+    Timespec since;
+    gint n_loaded;
+
+    populate_book (book, WINDOW_TXNS);
+    init_sql_backend (&save_be, fixture->conn);
+    gnc_sql_sync_all (&save_be, book);
+
+    init_sql_backend (&load_be, fixture->conn);
+    load_be.tx_load_window = WINDOW_DAYS;
+    gnc_sql_init_version_info (&load_be);
+    gnc_sql_load (&load_be, loaded, LOAD_TYPE_INITIAL_LOAD);
+
+    g_assert (load_be.tx_partially_loaded);
+    n_loaded = gnc_book_count_transactions (loaded);
+    g_assert_cmpint (n_loaded, == , count_tx_since (book, load_be.tx_loaded_from.tv_sec));
+    g_assert_cmpint (n_loaded, < , WINDOW_TXNS);
+    check_balances (book, loaded);
+
+    /* A reference to a transaction from before the window faults it in,
+     * the way an invoice's posted transaction does. */
+    result = gnc_sql_execute_select_sql (&load_be,
+                                         "SELECT guid AS tx FROM transactions ORDER BY post_date LIMIT 1");
+    row = gnc_sql_result_get_first_row (result);
+    g_assert (row != NULL);
+    gnc_sql_load_object (&load_be, row, NULL, &tx, tx_ref_table);
+    gnc_sql_result_dispose (result);
+    g_assert (tx != NULL);
+    g_assert_cmpint (xaccTransGetDate (tx), < , load_be.tx_loaded_from.tv_sec);
+    g_assert_cmpint (gnc_book_count_transactions (loaded), == , n_loaded + 1);
+    check_balances (book, loaded);
+
+    since = load_be.tx_loaded_from;
+    since.tv_sec -= (time64)WINDOW_DAYS * 24 * 60 * 60;
+    gnc_sql_load_since (&load_be, since);
+    g_assert (load_be.tx_partially_loaded);
+    g_assert_cmpint (gnc_book_count_transactions (loaded), == ,
+                     count_tx_since (book, since.tv_sec) + 1);
+    check_balances (book, loaded);
+
+    gnc_sql_load (&load_be, loaded, LOAD_TYPE_LOAD_ALL);
+    g_assert (!load_be.tx_partially_loaded);
+    g_assert_cmpint (gnc_book_count_transactions (loaded), == , WINDOW_TXNS);
+    check_balances (book, loaded);
+
+    gnc_sql_finalize_version_info (&save_be);
+    gnc_sql_finalize_version_info (&load_be);
+    qof_book_destroy (loaded);
+    qof_book_destroy (book);
+}
+
+void
+test_suite_gnc_sqlite3_connection (void)
+{
+    GNC_TEST_ADD (suitename, "gnc sqlite3 connection open", Fixture, NULL, setup, test_gnc_sqlite3_connection_open, teardown);
+    GNC_TEST_ADD (suitename, "conn create table", Fixture, NULL, setup, test_conn_create_table, teardown);
+    GNC_TEST_ADD (suitename, "conn quote string", Fixture, NULL, setup, test_conn_quote_string, teardown);
+    GNC_TEST_ADD (suitename, "conn upsert clause", Fixture, NULL, setup, test_conn_upsert_clause, teardown);
+    GNC_TEST_ADD (suitename, "result rows", Fixture, NULL, setup, test_result_rows, teardown);
+    GNC_TEST_ADD (suitename, "conn transactions", Fixture, NULL, setup, test_conn_transactions, teardown);
+    GNC_TEST_ADD (suitename, "conn bulk insert select", Fixture, NULL, setup, test_conn_bulk_insert_select, teardown);
+    GNC_TEST_ADD (suitename, "conn dispose open result", Fixture, NULL, setup, test_conn_dispose_open_result, teardown);
+    GNC_TEST_ADD (suitename, "sql backend save load", Fixture, NULL, setup, test_sql_backend_save_load, teardown);
+    GNC_TEST_ADD (suitename, "sql backend load window", Fixture, NULL, setup, test_sql_backend_load_window, teardown);
+}
@@ -0,0 +1,515 @@
+/********************************************************************
+ * gnc-backend-sqlite3.cpp: load and save data to SQLite3 files     *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+/** @file gnc-backend-sqlite3.cpp
+ *  @brief load and save data to SQLite3 files
+ *
+ * This file implements the top-level QofBackend API for saving/
+ * restoring data to/from an SQLite3 file.  All of the object handling
+ * is done by the generic SQL backend core; this file only manages the
+ * file, the lock and the session.
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "qof.h"
+#include "gnc-uri-utils.h"
+#include "gnc-gconf-utils.h"
+
+#include "gnc-backend-sql.h"
+#include "gnc-slots-sql.h"
+#include "gnc-sqlite3-connection.h"
+#include "gnc-backend-sqlite3.h"
+
+#if defined( S_SPLINT_S )
+#include "splint-defs.h"
+#endif
+
+static QofLogModule log_module = G_LOG_DOMAIN;
+
+#define GNC_LOCK_TABLE "gnclock"
+#define GNC_HOST_NAME_MAX 255
+#define KEY_SQL_LOAD_WINDOW "sql_load_window_days"
+
+typedef struct
+{
+    GncSqlBackend sql_be;
+
+    /*@ only @*//*@ null @*/
+    gchar* fullpath;        /* Path of the database file */
+} GncSqlite3Backend;
+
+/* ================================================================= */
+
+/* The lock table holds the host and pid of the session which has the file
+ * open.  SQLite's own locks only last for a transaction, so they can't
+ * stop two sessions from editing the same book. */
+static gboolean
+gnc_sqlite3_lock_database( GncSqlite3Backend* be, gboolean ignore_lock )
+{
+    GncSqlBackend* sql_be = &be->sql_be;
+    gchar* hostname;
+    gchar* sql;
+    gboolean ok;
+
+    if ( !gnc_sql_connection_does_table_exist( sql_be->conn, GNC_LOCK_TABLE ) )
+    {
+        sql = g_strdup_printf( "CREATE TABLE %s ( Hostname varchar(%d), PID int )",
+                               GNC_LOCK_TABLE, GNC_HOST_NAME_MAX );
+        ok = ( gnc_sql_execute_nonselect_sql( sql_be, sql ) >= 0 );
+        g_free( sql );
+        if ( !ok )
+        {
+            qof_backend_set_error( (QofBackend*)be, ERR_BACKEND_SERVER_ERR );
+            return FALSE;
+        }
+    }
+
+    if ( !gnc_sql_connection_begin_transaction( sql_be->conn ) )
+    {
+        qof_backend_set_error( (QofBackend*)be, ERR_BACKEND_LOCKED );
+        return FALSE;
+    }
+
+    if ( !ignore_lock )
+    {
+        GncSqlResult* result;
+        gboolean locked = FALSE;
+
+        result = gnc_sql_execute_select_sql( sql_be, "SELECT * FROM " GNC_LOCK_TABLE );
+        if ( result != NULL )
+        {
+            locked = ( gnc_sql_result_get_first_row( result ) != NULL );
+            gnc_sql_result_dispose( result );
+        }
+        if ( locked )
+        {
+            (void)gnc_sql_connection_rollback_transaction( sql_be->conn );
+            qof_backend_set_error( (QofBackend*)be, ERR_BACKEND_LOCKED );
+            return FALSE;
+        }
+    }
+
+    hostname = gnc_sql_connection_quote_string( sql_be->conn, (gchar*)g_get_host_name() );
+    sql = g_strdup_printf( "DELETE FROM %s", GNC_LOCK_TABLE );
+    ok = ( gnc_sql_execute_nonselect_sql( sql_be, sql ) >= 0 );
+    g_free( sql );
+    if ( ok )
+    {
+        sql = g_strdup_printf( "INSERT INTO %s VALUES (%s, %d)",
+                               GNC_LOCK_TABLE, hostname, (gint)getpid() );
+        ok = ( gnc_sql_execute_nonselect_sql( sql_be, sql ) == 1 );
+        g_free( sql );
+    }
+    g_free( hostname );
+
+    if ( ok )
+    {
+        ok = gnc_sql_connection_commit_transaction( sql_be->conn );
+    }
+    else
+    {
+        (void)gnc_sql_connection_rollback_transaction( sql_be->conn );
+    }
+    if ( !ok )
+    {
+        qof_backend_set_error( (QofBackend*)be, ERR_BACKEND_SERVER_ERR );
+    }
+    return ok;
+}
+
+static void
+gnc_sqlite3_unlock_database( GncSqlite3Backend* be )
+{
+    (void)gnc_sql_execute_nonselect_sql( &be->sql_be, "DELETE FROM " GNC_LOCK_TABLE );
+}
+
+/* Drops every table except the lock table, so that a save starts from an
+ * empty, pristine database. */
+static gboolean
+gnc_sqlite3_drop_tables( GncSqlite3Backend* be )
+{
+    GncSqlBackend* sql_be = &be->sql_be;
+    GncSqlResult* result;
+    GncSqlRow* row;
+    GSList* table_names = NULL;
+    GSList* node;
+    gboolean ok = TRUE;
+
+    result = gnc_sql_execute_select_sql( sql_be,
+                                         "SELECT name FROM sqlite_master WHERE type='table'"
+                                         " AND name NOT LIKE 'sqlite_%'"
+                                         " AND name <> '" GNC_LOCK_TABLE "'" );
+    if ( result == NULL )
+    {
+        return FALSE;
+    }
+    for ( row = gnc_sql_result_get_first_row( result ); row != NULL;
+            row = gnc_sql_result_get_next_row( result ) )
+    {
+        const GValue* name = gnc_sql_row_get_value_at_col_name( row, "name" );
+        table_names = g_slist_prepend( table_names, g_value_dup_string( name ) );
+    }
+    gnc_sql_result_dispose( result );
+
+    for ( node = table_names; node != NULL; node = node->next )
+    {
+        gchar* sql = g_strdup_printf( "DROP TABLE %s", (gchar*)node->data );
+        if ( gnc_sql_execute_nonselect_sql( sql_be, sql ) < 0 )
+        {
+            ok = FALSE;
+        }
+        g_free( sql );
+        g_free( node->data );
+    }
+    g_slist_free( table_names );
+
+    return ok;
+}
+
+/* ================================================================= */
+
+static void
+gnc_sqlite3_session_begin( QofBackend* qbe, QofSession* session,
+                           const gchar* book_id, bool ignore_lock,
+                           bool create, bool force )
+{
+    GncSqlite3Backend* be = (GncSqlite3Backend*)qbe;
+    gboolean file_exists;
+
+    g_return_if_fail( qbe != NULL );
+    g_return_if_fail( session != NULL );
+    g_return_if_fail( book_id != NULL );
+
+    ENTER( " " );
+
+    be->fullpath = gnc_uri_get_path( book_id );
+    if ( be->fullpath == NULL )
+    {
+        qof_backend_set_error( qbe, ERR_FILEIO_FILE_NOT_FOUND );
+        qof_backend_set_message( qbe, "No path specified" );
+        LEAVE( "" );
+        return;
+    }
+
+    file_exists = g_file_test( be->fullpath, G_FILE_TEST_IS_REGULAR );
+    if ( !create && !file_exists )
+    {
+        qof_backend_set_error( qbe, ERR_FILEIO_FILE_NOT_FOUND );
+        qof_backend_set_message( qbe, "Sqlite3 file %s not found", be->fullpath );
+        PWARN( "Sqlite3 file %s not found", be->fullpath );
+        LEAVE( "" );
+        return;
+    }
+    if ( create && !force && file_exists )
+    {
+        qof_backend_set_error( qbe, ERR_BACKEND_STORE_EXISTS );
+        LEAVE( "Might clobber, no force" );
+        return;
+    }
+    if ( create && file_exists && !gnc_sqlite3_is_sqlite3_file( be->fullpath ) )
+    {
+        /* Overwriting some other kind of file; sqlite can't open it. */
+        (void)g_unlink( be->fullpath );
+    }
+
+    be->sql_be.conn = gnc_sqlite3_connection_open( qbe, be->fullpath );
+    if ( be->sql_be.conn == NULL )
+    {
+        qof_backend_set_error( qbe, ERR_BACKEND_CANT_CONNECT );
+        LEAVE( "Unable to open %s", be->fullpath );
+        return;
+    }
+
+    if ( !gnc_sqlite3_lock_database( be, ignore_lock ) )
+    {
+        gnc_sql_connection_dispose( be->sql_be.conn );
+        be->sql_be.conn = NULL;
+        LEAVE( "Locked" );
+        return;
+    }
+
+    be->sql_be.timespec_format = SQLITE3_TIMESPEC_STR_FORMAT;
+    qbe->fullpath = be->fullpath;
+
+    LEAVE( " " );
+}
+
+static void
+gnc_sqlite3_session_end( QofBackend* qbe )
+{
+    GncSqlite3Backend* be = (GncSqlite3Backend*)qbe;
+
+    g_return_if_fail( qbe != NULL );
+
+    ENTER( " " );
+
+    if ( be->sql_be.conn != NULL )
+    {
+        gnc_sqlite3_unlock_database( be );
+        gnc_sql_connection_dispose( be->sql_be.conn );
+        be->sql_be.conn = NULL;
+    }
+    gnc_sql_finalize_version_info( &be->sql_be );
+    gnc_sql_slots_forget_all( &be->sql_be );
+    qbe->fullpath = NULL;
+    g_free( be->fullpath );
+    be->fullpath = NULL;
+
+    LEAVE( " " );
+}
+
+static void
+gnc_sqlite3_destroy_backend( /*@ only @*/ QofBackend* qbe )
+{
+    g_return_if_fail( qbe != NULL );
+
+    qof_backend_destroy( qbe );
+    g_free( qbe );
+}
+
+static void
+create_tables_cb( const gchar* type, gpointer data_p, gpointer be_p )
+{
+    GncSqlObjectBackend* pData = (GncSqlObjectBackend*)data_p;
+    GncSqlBackend* be = (GncSqlBackend*)be_p;
+
+    g_return_if_fail( type != NULL && data_p != NULL && be_p != NULL );
+    g_return_if_fail( pData->version == GNC_SQL_BACKEND_VERSION );
+
+    if ( pData->create_tables != NULL )
+    {
+        (pData->create_tables)( be );
+    }
+}
+
+static void
+gnc_sqlite3_load( QofBackend* qbe, /*@ dependent @*/ QofBook* book,
+                  QofBackendLoadType loadType )
+{
+    GncSqlite3Backend* be = (GncSqlite3Backend*)qbe;
+    gint version;
+
+    g_return_if_fail( qbe != NULL );
+    g_return_if_fail( book != NULL );
+
+    ENTER( "be=%p, book=%p", be, book );
+
+    if ( loadType == LOAD_TYPE_INITIAL_LOAD )
+    {
+        /* Set up table version information, and have every object backend
+         * create or upgrade its tables before anything is read. */
+        gnc_sql_init_version_info( &be->sql_be );
+        qof_object_foreach_backend( GNC_SQL_BACKEND, create_tables_cb, be );
+    }
+
+    gnc_sql_load( &be->sql_be, book, loadType );
+
+    version = gnc_sql_get_table_version( &be->sql_be, "Gnucash" );
+    if ( version != 0 && GNUCASH_RESAVE_VERSION > version )
+    {
+        /* The database was written with an older schema or data semantics;
+         * it has to be saved anew to be consistent. */
+        qof_backend_set_error( qbe, ERR_SQL_DB_TOO_OLD );
+    }
+    else if ( GNUCASH_RESAVE_VERSION < gnc_sql_get_table_version( &be->sql_be, "Gnucash-Resave" ) )
+    {
+        /* Written by a newer version whose changes we can't represent */
+        qof_backend_set_error( qbe, ERR_SQL_DB_TOO_NEW );
+    }
+
+    LEAVE( "" );
+}
+
+static void
+gnc_sqlite3_sync_all( QofBackend* qbe, /*@ dependent @*/ QofBook* book )
+{
+    GncSqlite3Backend* be = (GncSqlite3Backend*)qbe;
+
+    g_return_if_fail( qbe != NULL );
+    g_return_if_fail( book != NULL );
+
+    ENTER( "book=%p, primary=%p", book, be->sql_be.book );
+
+    if ( qof_book_is_readonly( book ) )
+    {
+        qof_backend_set_error( qbe, ERR_BACKEND_READONLY );
+        LEAVE( "Book is read only" );
+        return;
+    }
+
+    /* The tables are rewritten from the book, so anything which was left
+     * in the file by a partial load has to be brought in first. */
+    if ( be->sql_be.book == book && be->sql_be.tx_partially_loaded )
+    {
+        gnc_sql_load( &be->sql_be, book, LOAD_TYPE_LOAD_ALL );
+    }
+
+    if ( !gnc_sqlite3_drop_tables( be ) )
+    {
+        qof_backend_set_error( qbe, ERR_BACKEND_SERVER_ERR );
+        LEAVE( "Unable to clear the database" );
+        return;
+    }
+    gnc_sql_sync_all( &be->sql_be, book );
+
+    LEAVE( "book=%p", book );
+}
+
+static void
+gnc_sqlite3_load_since( QofBackend* qbe, /*@ unused @*/ QofBook* book,
+                        Timespec since )
+{
+    gnc_sql_load_since( (GncSqlBackend*)qbe, since );
+}
+
+static void
+gnc_sqlite3_begin_edit( QofBackend* qbe, QofInstance* inst )
+{
+    gnc_sql_begin_edit( (GncSqlBackend*)qbe, inst );
+}
+
+static void
+gnc_sqlite3_commit_edit( QofBackend* qbe, QofInstance* inst )
+{
+    gnc_sql_commit_edit( (GncSqlBackend*)qbe, inst );
+}
+
+static void
+gnc_sqlite3_rollback_edit( QofBackend* qbe, QofInstance* inst )
+{
+    gnc_sql_rollback_edit( (GncSqlBackend*)qbe, inst );
+}
+
+/* ================================================================= */
+
+/*@ only @*/ static QofBackend*
+gnc_sqlite3_backend_new( void )
+{
+    GncSqlite3Backend* gnc_be;
+    QofBackend* be;
+
+    gnc_be = g_new0( GncSqlite3Backend, 1 );
+    g_assert( gnc_be != NULL );
+
+    be = (QofBackend*)gnc_be;
+    qof_backend_init( be );
+
+    be->session_begin = gnc_sqlite3_session_begin;
+    be->session_end = gnc_sqlite3_session_end;
+    be->destroy_backend = gnc_sqlite3_destroy_backend;
+
+    be->load = gnc_sqlite3_load;
+
+    /* The SQL backends write each object as it is committed */
+    be->begin = gnc_sqlite3_begin_edit;
+    be->commit = gnc_sqlite3_commit_edit;
+    be->rollback = gnc_sqlite3_rollback_edit;
+
+    /* A file can only be open in one session at a time */
+    be->events_pending = NULL;
+    be->process_events = NULL;
+
+    be->sync = gnc_sqlite3_sync_all;
+    be->safe_sync = NULL;
+    be->load_config = NULL;
+    be->get_config = NULL;
+
+    be->export_fn = NULL;
+    be->load_since = gnc_sqlite3_load_since;
+
+    gnc_sql_init( &gnc_be->sql_be );
+
+    gnc_be->sql_be.conn = NULL;
+    gnc_be->sql_be.book = NULL;
+    gnc_be->sql_be.tx_load_window = gnc_gconf_get_int( GCONF_GENERAL,
+                                    KEY_SQL_LOAD_WINDOW, NULL );
+    gnc_be->fullpath = NULL;
+
+    return be;
+}
+
+static bool
+gnc_sqlite3_check_sqlite3_file( const gchar* uri )
+{
+    gchar* path;
+    gboolean is_sqlite3;
+
+    path = gnc_uri_get_path( uri );
+    if ( path == NULL )
+    {
+        return FALSE;
+    }
+    is_sqlite3 = gnc_sqlite3_is_sqlite3_file( path );
+    g_free( path );
+
+    return is_sqlite3;
+}
+
+static void
+gnc_sqlite3_provider_free( /*@ only @*/ QofBackendProvider* prov )
+{
+    prov->provider_name = NULL;
+    prov->access_method = NULL;
+    g_free( prov );
+}
+
+#ifndef GNC_NO_LOADABLE_MODULES
+extern "C" {
+G_MODULE_EXPORT void
+qof_backend_module_init(void)
+{
+    gnc_module_init_backend_sqlite3();
+}
+}
+#endif
+
+void
+gnc_module_init_backend_sqlite3(void)
+{
+    QofBackendProvider *prov;
+
+    prov = g_new0 (QofBackendProvider, 1);
+    prov->provider_name = "GnuCash SQLite3 Backend";
+    prov->access_method = "sqlite3";
+    prov->partial_book_supported = FALSE;
+    prov->backend_new = gnc_sqlite3_backend_new;
+    prov->provider_free = gnc_sqlite3_provider_free;
+    prov->check_data_type = NULL;
+    qof_backend_register_provider (prov);
+
+    /* Plain file URIs are ours only if the file is an sqlite3 database;
+     * the XML backend claims the rest. */
+    prov = g_new0 (QofBackendProvider, 1);
+    prov->provider_name = "GnuCash SQLite3 Backend";
+    prov->access_method = "file";
+    prov->partial_book_supported = FALSE;
+    prov->backend_new = gnc_sqlite3_backend_new;
+    prov->provider_free = gnc_sqlite3_provider_free;
+    prov->check_data_type = gnc_sqlite3_check_sqlite3_file;
+    qof_backend_register_provider (prov);
+}
+
+/* ========================== END OF FILE ===================== */
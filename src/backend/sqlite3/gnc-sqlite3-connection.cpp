@@ -0,0 +1,916 @@
+/********************************************************************
+ * gnc-sqlite3-connection.cpp: native SQLite3 GncSqlConnection       *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+/** @file gnc-sqlite3-connection.cpp
+ *  @brief GncSqlConnection implemented directly on sqlite3 statement handles
+ *
+ * Results wrap a prepared sqlite3_stmt and are stepped in place, so rows
+ * are never copied.  Column values are converted to GValues lazily, only
+ * for the columns a loader actually asks for; the index based accessors
+ * bypass GValues completely.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <sqlite3.h>
+
+#include "qof.h"
+#include "gnc-backend-sql.h"
+#include "gnc-sqlite3-connection.h"
+
+#if defined( S_SPLINT_S )
+#include "splint-defs.h"
+#endif
+
+static QofLogModule log_module = G_LOG_DOMAIN;
+
+/* Page cache size in KiB (negative values are KiB for the cache_size pragma) */
+#define SQLITE3_CACHE_SIZE_KB 16384
+/* Maximum amount of the file to memory map */
+#define SQLITE3_MMAP_SIZE (256 * 1024 * 1024)
+/* How long to wait for another connection to release a lock, in ms */
+#define SQLITE3_BUSY_TIMEOUT_MS 5000
+/* SQLite 3.24 added the PostgreSQL style ON CONFLICT clause to INSERT */
+#define SQLITE3_UPSERT_VERSION 3024000
+
+#define SQLITE3_MAGIC "SQLite format 3"
+
+typedef struct
+{
+    GncSqlConnection base;
+
+    /*@ dependent @*//*@ null @*/
+    QofBackend* qbe;
+    /*@ owned @*/
+    sqlite3* db;
+} GncSqlite3Connection;
+
+typedef struct
+{
+    GncSqlStatement base;
+
+    GString* sql;
+    /*@ observer @*/
+    GncSqlConnection* conn;
+} GncSqlite3Statement;
+
+struct GncSqlite3Result;
+
+typedef struct
+{
+    GncSqlRow base;
+
+    /*@ dependent @*/
+    struct GncSqlite3Result* result;
+    /* Lazily converted column values, one per column.  A value which has
+     * not been converted for the current row is not G_IS_VALUE(). */
+    GValue* values;
+} GncSqlite3Row;
+
+struct GncSqlite3Result
+{
+    GncSqlResult base;
+
+    /*@ dependent @*/
+    GncSqlite3Connection* conn;
+    /*@ owned @*/
+    sqlite3_stmt* stmt;
+    GncSqlite3Row row;
+    int num_cols;
+    int num_rows;           /* -1 until counted */
+    int cur_row;            /* -1 before the first row */
+    gboolean at_end;
+    GHashTable* col_names;  /* column name -> column index + 1 */
+};
+typedef struct GncSqlite3Result GncSqlite3Result;
+
+/* ================================================================= */
+
+static void
+report_error( GncSqlite3Connection* conn, const gchar* what, const gchar* sql )
+{
+    PERR( "%s: %s (%s)", what, sqlite3_errmsg( conn->db ), sql != NULL ? sql : "" );
+    if ( conn->qbe != NULL )
+    {
+        qof_backend_set_error( conn->qbe, ERR_BACKEND_SERVER_ERR );
+    }
+}
+
+/*@ null @*/ static sqlite3_stmt*
+prepare_stmt( GncSqlite3Connection* conn, const gchar* sql )
+{
+    sqlite3_stmt* stmt = NULL;
+
+    if ( sqlite3_prepare_v2( conn->db, sql, -1, &stmt, NULL ) != SQLITE_OK )
+    {
+        report_error( conn, "Unable to prepare statement", sql );
+        (void)sqlite3_finalize( stmt );
+        return NULL;
+    }
+    return stmt;
+}
+
+static gboolean
+exec_sql( GncSqlite3Connection* conn, const gchar* sql )
+{
+    char* errmsg = NULL;
+
+    if ( sqlite3_exec( conn->db, sql, NULL, NULL, &errmsg ) != SQLITE_OK )
+    {
+        PERR( "SQL error: %s (%s)", errmsg != NULL ? errmsg : "", sql );
+        sqlite3_free( errmsg );
+        if ( conn->qbe != NULL )
+        {
+            qof_backend_set_error( conn->qbe, ERR_BACKEND_SERVER_ERR );
+        }
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/* ================================================================= */
+/* Rows */
+
+static void
+row_clear_values( GncSqlite3Row* row )
+{
+    int i;
+
+    for ( i = 0; i < row->result->num_cols; i++ )
+    {
+        if ( G_IS_VALUE( &row->values[i] ) )
+        {
+            g_value_unset( &row->values[i] );
+        }
+    }
+}
+
+/*@ null @*/ static const GValue*
+row_get_value_at_col_index( GncSqlRow* row, int col )
+{
+    GncSqlite3Row* sqlite3_row = (GncSqlite3Row*)row;
+    sqlite3_stmt* stmt = sqlite3_row->result->stmt;
+    GValue* value;
+
+    g_return_val_if_fail( col >= 0 && col < sqlite3_row->result->num_cols, NULL );
+
+    value = &sqlite3_row->values[col];
+    if ( G_IS_VALUE( value ) )
+    {
+        return value;
+    }
+
+    switch ( sqlite3_column_type( stmt, col ) )
+    {
+    case SQLITE_NULL:
+    {
+        /* The string loaders expect a string value holding NULL rather
+         * than no value at all for NULL text columns. */
+        const char* decl_type = sqlite3_column_decltype( stmt, col );
+        if ( decl_type == NULL || g_ascii_strncasecmp( decl_type, "text", 4 ) != 0 )
+        {
+            return NULL;
+        }
+        (void)g_value_init( value, G_TYPE_STRING );
+        break;
+    }
+
+    case SQLITE_INTEGER:
+        (void)g_value_init( value, G_TYPE_INT64 );
+        g_value_set_int64( value, sqlite3_column_int64( stmt, col ) );
+        break;
+
+    case SQLITE_FLOAT:
+        (void)g_value_init( value, G_TYPE_DOUBLE );
+        g_value_set_double( value, sqlite3_column_double( stmt, col ) );
+        break;
+
+    default:
+        (void)g_value_init( value, G_TYPE_STRING );
+        g_value_set_string( value, (const gchar*)sqlite3_column_text( stmt, col ) );
+        break;
+    }
+
+    return value;
+}
+
+static int
+result_get_col_index( GncSqlResult* result, const char* col_name )
+{
+    GncSqlite3Result* sqlite3_result = (GncSqlite3Result*)result;
+
+    return GPOINTER_TO_INT(g_hash_table_lookup( sqlite3_result->col_names, col_name )) - 1;
+}
+
+/*@ null @*/ static const GValue*
+row_get_value_at_col_name( GncSqlRow* row, const gchar* col_name )
+{
+    GncSqlite3Row* sqlite3_row = (GncSqlite3Row*)row;
+    int col;
+
+    col = result_get_col_index( (GncSqlResult*)sqlite3_row->result, col_name );
+    if ( col < 0 )
+    {
+        PWARN( "No such column: %s", col_name );
+        return NULL;
+    }
+    return row_get_value_at_col_index( row, col );
+}
+
+static gboolean
+row_get_int64_at_col_index( GncSqlRow* row, int col, gint64* pValue )
+{
+    GncSqlite3Row* sqlite3_row = (GncSqlite3Row*)row;
+    sqlite3_stmt* stmt = sqlite3_row->result->stmt;
+
+    g_return_val_if_fail( col >= 0 && col < sqlite3_row->result->num_cols, FALSE );
+
+    if ( sqlite3_column_type( stmt, col ) == SQLITE_NULL )
+    {
+        return FALSE;
+    }
+    *pValue = sqlite3_column_int64( stmt, col );
+    return TRUE;
+}
+
+/*@ null @*//*@ dependent @*/ static const char*
+row_get_string_at_col_index( GncSqlRow* row, int col )
+{
+    GncSqlite3Row* sqlite3_row = (GncSqlite3Row*)row;
+
+    g_return_val_if_fail( col >= 0 && col < sqlite3_row->result->num_cols, NULL );
+
+    return (const char*)sqlite3_column_text( sqlite3_row->result->stmt, col );
+}
+
+static gboolean
+row_get_guid_at_col_index( GncSqlRow* row, int col, GncGUID* guid )
+{
+    const char* s = row_get_string_at_col_index( row, col );
+
+    if ( s == NULL )
+    {
+        return FALSE;
+    }
+    return string_to_guid( s, guid ) ? TRUE : FALSE;
+}
+
+static void
+row_dispose( /*@ only @*/ GncSqlRow* row )
+{
+    /* Rows are owned by their result and are released with it */
+}
+
+/* ================================================================= */
+/* Results */
+
+/*@ null @*/ static GncSqlRow*
+result_step( GncSqlite3Result* result )
+{
+    int rc;
+
+    row_clear_values( &result->row );
+    if ( result->at_end )
+    {
+        return NULL;
+    }
+
+    rc = sqlite3_step( result->stmt );
+    if ( rc == SQLITE_ROW )
+    {
+        result->cur_row++;
+        return (GncSqlRow*)&result->row;
+    }
+
+    result->at_end = TRUE;
+    if ( rc != SQLITE_DONE )
+    {
+        report_error( result->conn, "Error fetching row", sqlite3_sql( result->stmt ) );
+    }
+    return NULL;
+}
+
+static void
+result_rewind( GncSqlite3Result* result )
+{
+    row_clear_values( &result->row );
+    (void)sqlite3_reset( result->stmt );
+    result->cur_row = -1;
+    result->at_end = FALSE;
+}
+
+/*@ null @*/ static GncSqlRow*
+result_get_first_row( GncSqlResult* result )
+{
+    GncSqlite3Result* sqlite3_result = (GncSqlite3Result*)result;
+
+    if ( sqlite3_result->cur_row != -1 || sqlite3_result->at_end )
+    {
+        result_rewind( sqlite3_result );
+    }
+    return result_step( sqlite3_result );
+}
+
+/*@ null @*/ static GncSqlRow*
+result_get_next_row( GncSqlResult* result )
+{
+    return result_step( (GncSqlite3Result*)result );
+}
+
+static guint
+result_get_num_rows( GncSqlResult* result )
+{
+    GncSqlite3Result* sqlite3_result = (GncSqlite3Result*)result;
+
+    /* SQLite doesn't know how many rows a statement will produce until it
+     * has been stepped to the end, so count once and then put the cursor
+     * back where the caller left it. */
+    if ( sqlite3_result->num_rows < 0 )
+    {
+        int cur_row = sqlite3_result->cur_row;
+        gboolean at_end = sqlite3_result->at_end;
+        int count = 0;
+
+        result_rewind( sqlite3_result );
+        while ( result_step( sqlite3_result ) != NULL )
+        {
+            count++;
+        }
+        sqlite3_result->num_rows = count;
+
+        result_rewind( sqlite3_result );
+        while ( sqlite3_result->cur_row < cur_row
+                && result_step( sqlite3_result ) != NULL )
+        {
+            /* Skip back to the current row */
+        }
+        sqlite3_result->at_end = at_end;
+    }
+
+    return (guint)sqlite3_result->num_rows;
+}
+
+static void
+result_dispose( /*@ only @*/ GncSqlResult* result )
+{
+    GncSqlite3Result* sqlite3_result = (GncSqlite3Result*)result;
+
+    row_clear_values( &sqlite3_result->row );
+    g_free( sqlite3_result->row.values );
+    (void)sqlite3_finalize( sqlite3_result->stmt );
+    g_hash_table_destroy( sqlite3_result->col_names );
+    g_free( sqlite3_result );
+}
+
+/*@ only @*/ static GncSqlResult*
+create_sqlite3_result( GncSqlite3Connection* conn, /*@ only @*/ sqlite3_stmt* stmt )
+{
+    GncSqlite3Result* result;
+    int col;
+
+    result = g_new0( GncSqlite3Result, 1 );
+    g_assert( result != NULL );
+
+    result->base.dispose = result_dispose;
+    result->base.getNumRows = result_get_num_rows;
+    result->base.getFirstRow = result_get_first_row;
+    result->base.getNextRow = result_get_next_row;
+    result->base.getColIndex = result_get_col_index;
+
+    result->row.base.getValueAtColName = row_get_value_at_col_name;
+    result->row.base.dispose = row_dispose;
+    result->row.base.getValueAtColIndex = row_get_value_at_col_index;
+    result->row.base.getInt64AtColIndex = row_get_int64_at_col_index;
+    result->row.base.getStringAtColIndex = row_get_string_at_col_index;
+    result->row.base.getGuidAtColIndex = row_get_guid_at_col_index;
+    result->row.result = result;
+
+    result->conn = conn;
+    result->stmt = stmt;
+    result->num_cols = sqlite3_column_count( stmt );
+    result->num_rows = -1;
+    result->cur_row = -1;
+    result->at_end = FALSE;
+    result->row.values = g_new0( GValue, result->num_cols > 0 ? result->num_cols : 1 );
+
+    /* Column names are resolved once per result set, not once per value */
+    result->col_names = g_hash_table_new( g_str_hash, g_str_equal );
+    for ( col = result->num_cols - 1; col >= 0; col-- )
+    {
+        g_hash_table_insert( result->col_names,
+                             (gpointer)sqlite3_column_name( stmt, col ),
+                             GINT_TO_POINTER(col + 1) );
+    }
+
+    return (GncSqlResult*)result;
+}
+
+/* ================================================================= */
+/* Statements */
+
+static void
+stmt_dispose( /*@ only @*/ GncSqlStatement* stmt )
+{
+    GncSqlite3Statement* sql_stmt = (GncSqlite3Statement*)stmt;
+
+    if ( sql_stmt->sql != NULL )
+    {
+        (void)g_string_free( sql_stmt->sql, TRUE );
+    }
+    g_free( stmt );
+}
+
+static gchar*
+stmt_to_sql( GncSqlStatement* stmt )
+{
+    GncSqlite3Statement* sql_stmt = (GncSqlite3Statement*)stmt;
+
+    return sql_stmt->sql->str;
+}
+
+static void
+stmt_add_where_cond( GncSqlStatement* stmt, /*@ unused @*/ QofIdTypeConst type_name,
+                     /*@ unused @*/ gpointer obj, const GncSqlColumnTableEntry* table_row,
+                     GValue* value )
+{
+    GncSqlite3Statement* sql_stmt = (GncSqlite3Statement*)stmt;
+    gchar* value_str;
+
+    value_str = gnc_sql_get_sql_value( sql_stmt->conn, value );
+    g_string_append_printf( sql_stmt->sql, " WHERE %s = %s",
+                            table_row->col_name, value_str );
+    g_free( value_str );
+}
+
+/*@ only @*/ static GncSqlStatement*
+create_sqlite3_statement( /*@ observer @*/ GncSqlConnection* conn, const gchar* sql )
+{
+    GncSqlite3Statement* stmt;
+
+    stmt = g_new0( GncSqlite3Statement, 1 );
+    g_assert( stmt != NULL );
+
+    stmt->base.dispose = stmt_dispose;
+    stmt->base.toSql = stmt_to_sql;
+    stmt->base.addWhereCond = stmt_add_where_cond;
+    stmt->sql = g_string_new( sql );
+    stmt->conn = conn;
+
+    return (GncSqlStatement*)stmt;
+}
+
+/* ================================================================= */
+/* Connection */
+
+static void
+conn_dispose( /*@ only @*/ GncSqlConnection* conn )
+{
+    GncSqlite3Connection* sqlite3_conn = (GncSqlite3Connection*)conn;
+
+    /* Results own their prepared statements and may outlive the
+     * connection; sqlite3_close_v2() keeps the handle open until the last
+     * of them is finalized instead of failing with SQLITE_BUSY. */
+    if ( sqlite3_close_v2( sqlite3_conn->db ) != SQLITE_OK )
+    {
+        PERR( "Unable to close database: %s", sqlite3_errmsg( sqlite3_conn->db ) );
+    }
+    g_free( conn );
+}
+
+/*@ null @*/ static GncSqlResult*
+conn_execute_select_statement( GncSqlConnection* conn, GncSqlStatement* stmt )
+{
+    GncSqlite3Connection* sqlite3_conn = (GncSqlite3Connection*)conn;
+    sqlite3_stmt* handle;
+
+    DEBUG( "SQL: %s\n", gnc_sql_statement_to_sql( stmt ) );
+    handle = prepare_stmt( sqlite3_conn, gnc_sql_statement_to_sql( stmt ) );
+    if ( handle == NULL )
+    {
+        return NULL;
+    }
+    return create_sqlite3_result( sqlite3_conn, handle );
+}
+
+static gint
+conn_execute_nonselect_statement( GncSqlConnection* conn, GncSqlStatement* stmt )
+{
+    GncSqlite3Connection* sqlite3_conn = (GncSqlite3Connection*)conn;
+    sqlite3_stmt* handle;
+    int rc;
+
+    DEBUG( "SQL: %s\n", gnc_sql_statement_to_sql( stmt ) );
+    handle = prepare_stmt( sqlite3_conn, gnc_sql_statement_to_sql( stmt ) );
+    if ( handle == NULL )
+    {
+        return -1;
+    }
+    do
+    {
+        rc = sqlite3_step( handle );
+    }
+    while ( rc == SQLITE_ROW );
+    (void)sqlite3_finalize( handle );
+
+    if ( rc != SQLITE_DONE )
+    {
+        report_error( sqlite3_conn, "Error executing statement",
+                      gnc_sql_statement_to_sql( stmt ) );
+        return -1;
+    }
+    return sqlite3_changes( sqlite3_conn->db );
+}
+
+/*@ null @*/ static GncSqlStatement*
+conn_create_statement_from_sql( /*@ observer @*/ GncSqlConnection* conn, const gchar* sql )
+{
+    return create_sqlite3_statement( conn, sql );
+}
+
+static gboolean
+conn_does_table_exist( GncSqlConnection* conn, const gchar* table_name )
+{
+    GncSqlite3Connection* sqlite3_conn = (GncSqlite3Connection*)conn;
+    sqlite3_stmt* handle;
+    gboolean exists;
+
+    g_return_val_if_fail( table_name != NULL, FALSE );
+
+    handle = prepare_stmt( sqlite3_conn,
+                           "SELECT name FROM sqlite_master WHERE type='table' AND name=?1" );
+    if ( handle == NULL )
+    {
+        return FALSE;
+    }
+    (void)sqlite3_bind_text( handle, 1, table_name, -1, SQLITE_STATIC );
+    exists = ( sqlite3_step( handle ) == SQLITE_ROW );
+    (void)sqlite3_finalize( handle );
+
+    return exists;
+}
+
+static gboolean
+conn_begin_transaction( GncSqlConnection* conn )
+{
+    /* Take the write lock up front so that a concurrent writer makes us
+     * wait for the busy timeout instead of failing half way through. */
+    DEBUG( "BEGIN\n" );
+    return exec_sql( (GncSqlite3Connection*)conn, "BEGIN IMMEDIATE" );
+}
+
+static gboolean
+conn_rollback_transaction( GncSqlConnection* conn )
+{
+    GncSqlite3Connection* sqlite3_conn = (GncSqlite3Connection*)conn;
+
+    DEBUG( "ROLLBACK\n" );
+    if ( sqlite3_get_autocommit( sqlite3_conn->db ) )
+    {
+        /* Nothing to roll back; sqlite already did it after the error */
+        return TRUE;
+    }
+    return exec_sql( sqlite3_conn, "ROLLBACK" );
+}
+
+static gboolean
+conn_commit_transaction( GncSqlConnection* conn )
+{
+    DEBUG( "COMMIT\n" );
+    return exec_sql( (GncSqlite3Connection*)conn, "COMMIT" );
+}
+
+static void
+append_col_def( GString* ddl, const GncSqlColumnInfo* info )
+{
+    const gchar* type_name;
+
+    switch ( info->type )
+    {
+    case BCT_INT:
+        type_name = "integer";
+        break;
+    case BCT_INT64:
+        type_name = "bigint";
+        break;
+    case BCT_DOUBLE:
+        type_name = "float8";
+        break;
+    /* Dates are stored as text so that column affinity doesn't turn
+     * "YYYYMMDDHHMMSS" into an integer. */
+    case BCT_DATE:
+        type_name = "text(8)";
+        break;
+    case BCT_DATETIME:
+        type_name = "text(14)";
+        break;
+    case BCT_STRING:
+    default:
+        type_name = "text";
+        break;
+    }
+
+    g_string_append_printf( ddl, "%s %s", info->name, type_name );
+    if ( info->type == BCT_STRING && info->size != 0 )
+    {
+        g_string_append_printf( ddl, "(%d)", info->size );
+    }
+    if ( info->is_primary_key )
+    {
+        g_string_append( ddl, " PRIMARY KEY" );
+    }
+    if ( info->is_autoinc )
+    {
+        g_string_append( ddl, " AUTOINCREMENT" );
+    }
+    if ( !info->null_allowed )
+    {
+        g_string_append( ddl, " NOT NULL" );
+    }
+}
+
+static void
+free_col_info_list( /*@ only @*/ GList* col_info_list )
+{
+    GList* node;
+
+    for ( node = col_info_list; node != NULL; node = node->next )
+    {
+        GncSqlColumnInfo* info = (GncSqlColumnInfo*)node->data;
+        g_free( info->name );
+        g_free( info );
+    }
+    g_list_free( col_info_list );
+}
+
+static gboolean
+conn_create_table( GncSqlConnection* conn, const gchar* table_name,
+                   /*@ only @*/ GList* col_info_list )
+{
+    GString* ddl;
+    GList* node;
+    gboolean ok;
+
+    g_return_val_if_fail( table_name != NULL, FALSE );
+    g_return_val_if_fail( col_info_list != NULL, FALSE );
+
+    ddl = g_string_new( "" );
+    g_string_printf( ddl, "CREATE TABLE %s (", table_name );
+    for ( node = col_info_list; node != NULL; node = node->next )
+    {
+        if ( node != col_info_list )
+        {
+            g_string_append( ddl, ", " );
+        }
+        append_col_def( ddl, (const GncSqlColumnInfo*)node->data );
+    }
+    g_string_append( ddl, ")" );
+
+    DEBUG( "SQL: %s\n", ddl->str );
+    ok = exec_sql( (GncSqlite3Connection*)conn, ddl->str );
+    (void)g_string_free( ddl, TRUE );
+    free_col_info_list( col_info_list );
+
+    return ok;
+}
+
+static gboolean
+conn_create_index( GncSqlConnection* conn, const gchar* index_name,
+                   const gchar* table_name, const GncSqlColumnTableEntry* col_table )
+{
+    GString* ddl;
+    const GncSqlColumnTableEntry* table_row;
+    gboolean ok;
+
+    g_return_val_if_fail( index_name != NULL, FALSE );
+    g_return_val_if_fail( table_name != NULL, FALSE );
+    g_return_val_if_fail( col_table != NULL, FALSE );
+
+    ddl = g_string_new( "" );
+    g_string_printf( ddl, "CREATE INDEX %s ON %s (", index_name, table_name );
+    for ( table_row = col_table; table_row->col_name != NULL; table_row++ )
+    {
+        if ( table_row != col_table )
+        {
+            g_string_append( ddl, ", " );
+        }
+        g_string_append( ddl, table_row->col_name );
+    }
+    g_string_append( ddl, ")" );
+
+    DEBUG( "SQL: %s\n", ddl->str );
+    ok = exec_sql( (GncSqlite3Connection*)conn, ddl->str );
+    (void)g_string_free( ddl, TRUE );
+
+    return ok;
+}
+
+static gboolean
+conn_add_columns_to_table( GncSqlConnection* conn, const gchar* table_name,
+                           /*@ only @*/ GList* col_info_list )
+{
+    GString* ddl;
+    GList* node;
+    gboolean ok = TRUE;
+
+    g_return_val_if_fail( table_name != NULL, FALSE );
+    g_return_val_if_fail( col_info_list != NULL, FALSE );
+
+    /* SQLite only allows one column per ALTER TABLE */
+    ddl = g_string_new( "" );
+    for ( node = col_info_list; node != NULL && ok; node = node->next )
+    {
+        g_string_printf( ddl, "ALTER TABLE %s ADD COLUMN ", table_name );
+        append_col_def( ddl, (const GncSqlColumnInfo*)node->data );
+        DEBUG( "SQL: %s\n", ddl->str );
+        ok = exec_sql( (GncSqlite3Connection*)conn, ddl->str );
+    }
+    (void)g_string_free( ddl, TRUE );
+    free_col_info_list( col_info_list );
+
+    return ok;
+}
+
+static gchar*
+conn_quote_string( const GncSqlConnection* conn, gchar* unquoted_str )
+{
+    char* quoted;
+    gchar* result;
+
+    g_return_val_if_fail( unquoted_str != NULL, NULL );
+
+    quoted = sqlite3_mprintf( "%Q", unquoted_str );
+    result = g_strdup( quoted );
+    sqlite3_free( quoted );
+
+    return result;
+}
+
+static gchar*
+conn_upsert_clause( const GncSqlConnection* conn, const gchar* key_col,
+                    GList* col_names, gboolean update )
+{
+    GString* clause;
+    GList* node;
+    gboolean first = TRUE;
+
+    g_return_val_if_fail( key_col != NULL, NULL );
+
+    clause = g_string_new( " ON CONFLICT(" );
+    g_string_append( clause, key_col );
+    if ( !update )
+    {
+        g_string_append( clause, ") DO NOTHING" );
+        return g_string_free( clause, FALSE );
+    }
+
+    g_string_append( clause, ") DO UPDATE SET " );
+    for ( node = col_names; node != NULL; node = node->next )
+    {
+        const gchar* col_name = (const gchar*)node->data;
+
+        if ( g_ascii_strcasecmp( col_name, key_col ) == 0 ) continue;
+        if ( !first )
+        {
+            g_string_append( clause, "," );
+        }
+        g_string_append_printf( clause, "%s=excluded.%s", col_name, col_name );
+        first = FALSE;
+    }
+    if ( first )
+    {
+        /* Nothing but the key, so there is nothing to update */
+        g_string_truncate( clause, 0 );
+        g_string_append_printf( clause, " ON CONFLICT(%s) DO NOTHING", key_col );
+    }
+
+    return g_string_free( clause, FALSE );
+}
+
+/* ================================================================= */
+
+static void
+set_pragmas( GncSqlite3Connection* conn )
+{
+    sqlite3_stmt* handle;
+    gchar* sql;
+
+    /* WAL lets readers proceed while a commit is being written, and makes
+     * each commit a single append instead of a rollback journal rewrite.
+     * It needs shared memory, so it isn't available on network file
+     * systems; fall back quietly to the default journal there. */
+    handle = prepare_stmt( conn, "PRAGMA journal_mode=WAL" );
+    if ( handle != NULL )
+    {
+        if ( sqlite3_step( handle ) != SQLITE_ROW
+                || g_ascii_strcasecmp( (const char*)sqlite3_column_text( handle, 0 ), "wal" ) != 0 )
+        {
+            PWARN( "Unable to switch to WAL journal mode" );
+        }
+        (void)sqlite3_finalize( handle );
+    }
+
+    /* In WAL mode NORMAL only syncs at checkpoints, and can't corrupt the
+     * database; a power failure may lose the most recent commits. */
+    (void)exec_sql( conn, "PRAGMA synchronous=NORMAL" );
+    (void)exec_sql( conn, "PRAGMA temp_store=MEMORY" );
+
+    sql = g_strdup_printf( "PRAGMA cache_size=-%d", SQLITE3_CACHE_SIZE_KB );
+    (void)exec_sql( conn, sql );
+    g_free( sql );
+
+    sql = g_strdup_printf( "PRAGMA mmap_size=%d", SQLITE3_MMAP_SIZE );
+    (void)exec_sql( conn, sql );
+    g_free( sql );
+
+    (void)sqlite3_busy_timeout( conn->db, SQLITE3_BUSY_TIMEOUT_MS );
+}
+
+/*@ null @*/ GncSqlConnection*
+gnc_sqlite3_connection_open( /*@ null @*/ QofBackend* qbe, const char* path )
+{
+    GncSqlite3Connection* conn;
+    sqlite3* db = NULL;
+
+    g_return_val_if_fail( path != NULL, NULL );
+
+    if ( sqlite3_open_v2( path, &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE,
+                          NULL ) != SQLITE_OK )
+    {
+        PERR( "Unable to open %s: %s", path,
+              db != NULL ? sqlite3_errmsg( db ) : "out of memory" );
+        (void)sqlite3_close( db );
+        return NULL;
+    }
+
+    conn = g_new0( GncSqlite3Connection, 1 );
+    g_assert( conn != NULL );
+
+    conn->base.dispose = conn_dispose;
+    conn->base.executeSelectStatement = conn_execute_select_statement;
+    conn->base.executeNonSelectStatement = conn_execute_nonselect_statement;
+    conn->base.createStatementFromSql = conn_create_statement_from_sql;
+    conn->base.doesTableExist = conn_does_table_exist;
+    conn->base.beginTransaction = conn_begin_transaction;
+    conn->base.rollbackTransaction = conn_rollback_transaction;
+    conn->base.commitTransaction = conn_commit_transaction;
+    conn->base.createTable = conn_create_table;
+    conn->base.createIndex = conn_create_index;
+    conn->base.addColumnsToTable = conn_add_columns_to_table;
+    conn->base.quoteString = conn_quote_string;
+    if ( sqlite3_libversion_number() >= SQLITE3_UPSERT_VERSION )
+    {
+        conn->base.upsertClause = conn_upsert_clause;
+    }
+    conn->qbe = qbe;
+    conn->db = db;
+
+    set_pragmas( conn );
+
+    return (GncSqlConnection*)conn;
+}
+
+gboolean
+gnc_sqlite3_is_sqlite3_file( const char* path )
+{
+    gchar buf[sizeof(SQLITE3_MAGIC)];
+    FILE* f;
+    gboolean is_sqlite3 = FALSE;
+
+    g_return_val_if_fail( path != NULL, FALSE );
+
+    f = g_fopen( path, "rb" );
+    if ( f == NULL )
+    {
+        return FALSE;
+    }
+    if ( fread( buf, sizeof(buf), 1, f ) == 1 )
+    {
+        is_sqlite3 = ( memcmp( buf, SQLITE3_MAGIC, sizeof(buf) ) == 0 );
+    }
+    fclose( f );
+
+    return is_sqlite3;
+}
+
+/* ========================== END OF FILE ===================== */
@@ -0,0 +1,61 @@
+/********************************************************************
+ * gnc-sqlite3-connection.h: native SQLite3 GncSqlConnection         *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+/** @file gnc-sqlite3-connection.h
+ *  @brief GncSqlConnection implemented directly on sqlite3 statement handles
+ *
+ * This is the driver half of the SQLite3 backend.  It implements the
+ * GncSqlConnection, GncSqlStatement, GncSqlResult and GncSqlRow vtables
+ * from gnc-backend-sql.h, including the index based row accessors, so that
+ * the generic SQL layer can be run and profiled against a local file.
+ */
+
+#ifndef GNC_SQLITE3_CONNECTION_H
+#define GNC_SQLITE3_CONNECTION_H
+
+#include "gnc-backend-sql.h"
+
+/** Format of timespec values stored in a SQLite3 database (YYYYMMDDHHMMSS) */
+#define SQLITE3_TIMESPEC_STR_FORMAT "%04d%02d%02d%02d%02d%02d"
+
+/**
+ * Opens (creating if necessary) an SQLite3 database file and wraps it in a
+ * GncSqlConnection.  The connection is switched to WAL journalling and the
+ * page cache, temp store, mmap and synchronous pragmas are set for a single
+ * writer desktop workload.
+ *
+ * @param qbe Backend on which errors are reported.  May be NULL.
+ * @param path File name of the database
+ * @return New connection, or NULL if the file could not be opened
+ */
+/*@ null @*/ /*@ only @*/
+GncSqlConnection* gnc_sqlite3_connection_open( /*@ null @*/ QofBackend* qbe,
+        const char* path );
+
+/**
+ * Checks whether a file is an SQLite3 database by looking at its header.
+ *
+ * @param path File name
+ * @return TRUE if the file exists and starts with the SQLite3 magic string
+ */
+gboolean gnc_sqlite3_is_sqlite3_file( const char* path );
+
+#endif /* GNC_SQLITE3_CONNECTION_H */
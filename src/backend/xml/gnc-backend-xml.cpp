@@ -66,6 +66,8 @@
 
 #include "io-gncxml.h"
 #include "io-gncxml-v2.h"
+#include "io-snapshot.h"
+#include "io-journal.h"
 #include "gnc-backend-xml.h"
 #include "gnc-gconf-utils.h"
 
@@ -88,6 +90,8 @@
 static QofLogModule log_module = GNC_MOD_BACKEND;
 
 static bool save_may_clobber_data (QofBackend *bend);
+static bool gnc_xml_be_write_to_file(FileBackend *fbe, QofBook *book,
+                                     const gchar *datafile, bool make_backup);
 
 /* ================================================================= */
 
@@ -357,6 +361,8 @@ xml_session_begin(QofBackend *be_start, QofSession *session,
         return;
     }
 
+    be->journal = gnc_xml_journal_new (be->fullpath);
+
     LEAVE (" ");
     return;
 }
@@ -375,6 +381,13 @@ xml_session_end(QofBackend *be_start)
         return;
     }
 
+    /* Fold a journal the book was saved to back into the data file
+     * while we still hold the lock. */
+    if (be->journal && be->book && be->lockfd > 0 &&
+            gnc_xml_journal_has_entries (be->journal) &&
+            !qof_book_session_not_saved (be->book))
+        gnc_xml_be_write_to_file (be, be->book, be->fullpath, TRUE);
+
     if (be->linkfile)
         g_unlink (be->linkfile);
 
@@ -408,6 +421,9 @@ xml_session_end(QofBackend *be_start)
 
     g_free (be->linkfile);
     be->linkfile = NULL;
+
+    gnc_xml_journal_destroy (be->journal);
+    be->journal = NULL;
     LEAVE (" ");
 }
 
@@ -417,6 +433,8 @@ xml_destroy_backend(QofBackend *be)
     /* Stop transaction logging */
     xaccLogSetBaseName (NULL);
 
+    gnc_xml_journal_destroy (((FileBackend*)be)->journal);
+
     qof_backend_destroy(be);
     g_free(be);
 }
@@ -783,6 +801,13 @@ gnc_xml_be_write_to_file(FileBackend *fbe,
         }
         g_free(tmp_name);
 
+        /* The file now holds everything the journal did */
+        if (fbe->journal && g_strcmp0 (datafile, fbe->fullpath) == 0)
+            gnc_xml_journal_reset (fbe->journal);
+
+        /* Failing to write the snapshot only costs the next load time */
+        gnc_xml_snapshot_write (book, datafile);
+
         /* Since we successfully saved the book,
          * we should mark it clean. */
         qof_book_mark_session_saved (book);
@@ -983,6 +1008,17 @@ xml_sync_all(QofBackend* be, QofBook *book)
         return;
     }
 
+    /* When only transactions and prices changed since the file was
+     * last written, appending them to the journal will do. */
+    if (fbe->journal && !gnc_xml_journal_wants_compaction (fbe->journal) &&
+            gnc_xml_journal_has_pending (fbe->journal) &&
+            gnc_xml_journal_flush (fbe->journal, book))
+    {
+        qof_book_mark_session_saved (book);
+        LEAVE ("book=%p saved to journal", book);
+        return;
+    }
+
     gnc_xml_be_write_to_file (fbe, book, fbe->fullpath, TRUE);
     gnc_xml_be_remove_old_files (fbe);
     LEAVE ("book=%p", book);
@@ -1063,14 +1099,18 @@ xml_rollback_edit (QofBackend *be, QofInstance *inst)
 static void
 xml_commit_edit (QofBackend *be, QofInstance *inst)
 {
+    FileBackend *fbe = (FileBackend *) be;
+
     if (qof_instance_get_dirty(inst) && qof_get_alt_dirty_mode() &&
             !(qof_instance_get_infant(inst) && qof_instance_get_destroying(inst)))
     {
         qof_collection_mark_dirty(qof_instance_get_collection(inst));
         qof_book_mark_session_dirty(qof_instance_get_book(inst));
     }
+
+    if (fbe->journal)
+        gnc_xml_journal_record (fbe->journal, inst);
 #if BORKEN_FOR_NOW
-    FileBackend *fbe = (FileBackend *) be;
     QofBook *book = gp;
     const char * filepath;
 
@@ -1111,12 +1151,19 @@ gnc_xml_be_load_from_file (QofBackend *bend, QofBook *book, QofBackendLoadType l
     switch (gnc_xml_be_determine_file_type(be->fullpath))
     {
     case GNC_BOOK_XML2_FILE:
-        rc = qof_session_load_from_xml_file_v2 (be, book, GNC_BOOK_XML2_FILE);
+        /* An up to date snapshot saves parsing the whole file */
+        rc = gnc_xml_snapshot_load (book, be->fullpath, bend->percentage)
+             || qof_session_load_from_xml_file_v2 (be, book, GNC_BOOK_XML2_FILE);
         if (FALSE == rc)
         {
             PWARN( "Syntax error in Xml File %s", be->fullpath );
             error = ERR_FILEIO_PARSE_ERROR;
         }
+        else if (be->journal)
+        {
+            /* Apply the saves made since the file was written */
+            error = gnc_xml_journal_replay (be->journal, book);
+        }
         break;
 
     case GNC_BOOK_XML2_FILE_NO_ENCODING:
@@ -1291,6 +1338,7 @@ gnc_backend_new(void)
     gnc_be->lockfd = -1;
 
     gnc_be->book = NULL;
+    gnc_be->journal = NULL;
 
     gnc_be->file_retention_days = (int)gnc_gconf_get_float(GCONF_GENERAL, KEY_RETAIN_DAYS, NULL);
     gnc_be->file_compression = gnc_gconf_get_bool(GCONF_GENERAL, KEY_FILE_COMPRESSION, NULL);
@@ -64,6 +64,7 @@ struct FileBackend_struct
     int lockfd;
 
     QofBook *book;  /* The primary, main open book */
+    struct GncXmlJournal *journal;  /* Saves since the file was written */
 
     XMLFileRetentionType file_retention_type;
     int file_retention_days;
@@ -151,7 +151,6 @@ price_parse_xml_end_handler(gpointer data_for_children,
 {
     gboolean ok = TRUE;
     xmlNodePtr price_xml = (xmlNodePtr) data_for_children;
-    xmlNodePtr child;
     GNCPrice *p = NULL;
     gxpf_data *gdata = global_data;
     QofBook *book = gdata->bookdata;
@@ -178,14 +177,31 @@ price_parse_xml_end_handler(gpointer data_for_children,
         goto cleanup_and_exit;
     }
 
-    p = gnc_price_create(book);
+    p = dom_tree_to_price(price_xml, book);
     if (!p)
     {
         ok = FALSE;
-        goto cleanup_and_exit;
     }
 
-    for (child = price_xml->xmlChildrenNode; child; child = child->next)
+cleanup_and_exit:
+    *result = ok ? p : NULL;
+    xmlFreeNode(price_xml);
+    return ok;
+}
+
+GNCPrice *
+dom_tree_to_price(xmlNodePtr node, QofBook *book)
+{
+    GNCPrice *p;
+    xmlNodePtr child;
+
+    g_return_val_if_fail(node, NULL);
+    g_return_val_if_fail(book, NULL);
+
+    p = gnc_price_create(book);
+    if (!p) return NULL;
+
+    for (child = node->xmlChildrenNode; child; child = child->next)
     {
         switch (child->type)
         {
@@ -195,31 +211,17 @@ price_parse_xml_end_handler(gpointer data_for_children,
         case XML_ELEMENT_NODE:
             if (!price_parse_xml_sub_node(p, child, book))
             {
-                ok = FALSE;
-                goto cleanup_and_exit;
+                gnc_price_unref(p);
+                return NULL;
             }
             break;
         default:
             PERR("Unknown node type (%d) while parsing gnc-price xml.", child->type);
-            child = NULL;
-            ok = FALSE;
-            goto cleanup_and_exit;
-            break;
+            gnc_price_unref(p);
+            return NULL;
         }
     }
-
-cleanup_and_exit:
-    if (ok)
-    {
-        *result = p;
-    }
-    else
-    {
-        *result = NULL;
-        gnc_price_unref(p);
-    }
-    xmlFreeNode(price_xml);
-    return ok;
+    return p;
 }
 
 static void
@@ -404,7 +406,7 @@ add_child_or_kill_parent(xmlNodePtr parent, xmlNodePtr child)
     return TRUE;
 }
 
-static xmlNodePtr
+xmlNodePtr
 gnc_price_to_dom_tree(const xmlChar *tag, GNCPrice *price)
 {
     xmlNodePtr price_xml;
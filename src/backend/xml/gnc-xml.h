@@ -50,6 +50,7 @@ xmlNodePtr gnc_lot_dom_tree_create(GNCLot *);
 sixtp* gnc_lot_sixtp_parser_create(void);
 
 xmlNodePtr gnc_pricedb_dom_tree_create(GNCPriceDB *db);
+xmlNodePtr gnc_price_to_dom_tree(const xmlChar *tag, GNCPrice *price);
 sixtp* gnc_pricedb_sixtp_parser_create(void);
 
 xmlNodePtr gnc_schedXaction_dom_tree_create( SchedXaction *sx );
@@ -186,6 +186,18 @@ clear_up_transaction_commodity(
     }
 }
 
+/* Tell the session the account tree is complete, so that it can be
+ * shown while the transactions are read. */
+static void
+report_accounts_loaded(sixtp_gdv2 *data)
+{
+    if (data->accounts_reported)
+        return;
+    data->accounts_reported = TRUE;
+    qof_backend_report_load_stage (qof_book_get_backend (data->book),
+                                   data->book, QOF_LOAD_STAGE_ACCOUNTS);
+}
+
 static bool
 add_account_local(sixtp_gdv2 *data, Account *act)
 {
@@ -230,6 +242,10 @@ add_account_local(sixtp_gdv2 *data, Account *act)
     data->counter.accounts_loaded++;
     run_callback(data, "account");
 
+    /* Files with count data say how many accounts to expect */
+    if (data->counter.accounts_loaded == data->counter.accounts_total)
+        report_accounts_loaded(data);
+
     return FALSE;
 }
 
@@ -262,6 +278,9 @@ add_transaction_local(sixtp_gdv2 *data, Transaction *trn)
 {
     gnc_commodity_table *table;
 
+    /* Accounts are written before transactions */
+    report_accounts_loaded(data);
+
     table = gnc_commodity_table_get_table (data->book);
 
     xaccTransBeginEdit (trn);
@@ -784,6 +803,7 @@ qof_session_load_from_xml_file_v2_full(
         goto bail;
     }
     debug_print_counter_data(&gd->counter);
+    report_accounts_loaded(gd);
 
     /* destroy the parser */
     sixtp_destroy (top_parser);
@@ -72,6 +72,7 @@ struct sixtp_gdv2
     countCallbackFn countCallback;
     QofBePercentageFunc gui_display_fn;
     bool exporting;
+    bool accounts_reported;     /* QOF_LOAD_STAGE_ACCOUNTS has been sent */
 };
 
 /**
@@ -0,0 +1,571 @@
+/********************************************************************\
+ * io-journal.cpp -- append-only change journal for xml data files  *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include "config.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "qof.h"
+#include "Split.h"
+#include "Transaction.h"
+#include "TransactionP.h"
+#include "gnc-pricedb.h"
+#include "gnc-pricedb-p.h"
+#include "TransLog.h"
+
+#include "gnc-xml.h"
+#include "sixtp.h"
+#include "sixtp-parsers.h"
+#include "sixtp-dom-parsers.h"
+#include "sixtp-dom-generators.h"
+#include "io-journal.h"
+#include "io-snapshot.h"
+
+static QofLogModule log_module = GNC_MOD_IO;
+
+/* ================================================================= */
+/* File layout.
+ *
+ * One header line naming the version of the data file the journal
+ * applies to, by the SHA-1 checksum of its contents (the one its
+ * snapshot records), followed by a record per changed object in the
+ * order the saves were made:
+ *
+ *   GNCJOURNAL 2 <sha1>
+ *   <gnc:transaction version="2.0.0">...</gnc:transaction>
+ *   <price>...</price>
+ *   <journal:trn-destroy type="guid">...</journal:trn-destroy>
+ *   <journal:price-destroy type="guid">...</journal:price-destroy>
+ *
+ * A record holds the whole object as the data file would, so a later
+ * record for the same object replaces an earlier one.  The records
+ * alone aren't a well formed document; they are wrapped in a
+ * JOURNAL_TAG element when read back.
+ */
+
+#define JOURNAL_SUFFIX ".journal"
+#define JOURNAL_MAGIC "GNCJOURNAL"
+#define JOURNAL_VERSION 2
+
+/* A journal no bigger than this is never worth a rewrite on its own */
+#define JOURNAL_COMPACT_MIN_SIZE (1024 * 1024)
+
+static const char *JOURNAL_TAG = "gnc-journal";
+static const char *TRANSACTION_TAG = "gnc:transaction";
+static const char *PRICE_TAG = "price";
+static const char *TRN_DESTROY_TAG = "journal:trn-destroy";
+static const char *PRICE_DESTROY_TAG = "journal:price-destroy";
+
+struct GncXmlJournal
+{
+    gchar *datafile;
+    gchar *filename;
+
+    /* GncGUID -> QofIdTypeConst of the objects changed since the
+     * last flush.  Only transactions and prices are recorded. */
+    GHashTable *pending;
+
+    /* The data file plus the journal file hold the book as of the
+     * last save. */
+    bool base_valid;
+
+    /* Something the journal can't describe has changed. */
+    bool needs_full;
+
+    /* The checksum of the data file the journal extends, once it has
+     * been worked out. */
+    gchar *base_checksum;
+
+    gint64 base_size;
+    gint64 size;
+};
+
+GncXmlJournal *
+gnc_xml_journal_new (const char *datafile)
+{
+    GncXmlJournal *journal;
+
+    g_return_val_if_fail (datafile, NULL);
+
+    journal = g_new0 (GncXmlJournal, 1);
+    journal->datafile = g_strdup (datafile);
+    journal->filename = g_strconcat (datafile, JOURNAL_SUFFIX, NULL);
+    journal->pending = g_hash_table_new_full (guid_hash_to_guint,
+                       guid_g_hash_table_equal,
+                       (GDestroyNotify) guid_free, NULL);
+    return journal;
+}
+
+void
+gnc_xml_journal_destroy (GncXmlJournal *journal)
+{
+    if (!journal) return;
+
+    g_hash_table_destroy (journal->pending);
+    g_free (journal->base_checksum);
+    g_free (journal->filename);
+    g_free (journal->datafile);
+    g_free (journal);
+}
+
+/* ================================================================= */
+
+void
+gnc_xml_journal_record (GncXmlJournal *journal, QofInstance *inst)
+{
+    QofIdTypeConst type;
+    const GncGUID *guid;
+
+    g_return_if_fail (journal && inst);
+
+    if (!journal->base_valid || journal->needs_full)
+        return;
+    if (!qof_instance_get_dirty_flag (inst) &&
+            !qof_instance_get_destroying (inst))
+        return;
+    if (qof_instance_get_infant (inst) && qof_instance_get_destroying (inst))
+        return;
+
+    type = inst->e_type;
+    if (!g_strcmp0 (type, GNC_ID_SPLIT))
+    {
+        /* Splits are written as part of their transaction */
+        Transaction *trn = xaccSplitGetParent ((Split *) inst);
+        if (!trn) return;
+        inst = QOF_INSTANCE (trn);
+        type = GNC_ID_TRANS;
+    }
+    else if (!g_strcmp0 (type, GNC_ID_PRICEDB))
+    {
+        /* Prices added to or removed from the db are committed too */
+        return;
+    }
+    else if (g_strcmp0 (type, GNC_ID_TRANS) && g_strcmp0 (type, GNC_ID_PRICE))
+    {
+        PINFO ("%s changed, the next save rewrites %s",
+               type, journal->datafile);
+        journal->needs_full = TRUE;
+        g_hash_table_remove_all (journal->pending);
+        return;
+    }
+
+    guid = qof_instance_get_guid (inst);
+    if (!g_hash_table_lookup (journal->pending, guid))
+        g_hash_table_insert (journal->pending, guid_copy (guid),
+                             (gpointer) type);
+}
+
+bool
+gnc_xml_journal_wants_compaction (const GncXmlJournal *journal)
+{
+    g_return_val_if_fail (journal, TRUE);
+
+    return !journal->base_valid || journal->needs_full ||
+           journal->size >= MAX (JOURNAL_COMPACT_MIN_SIZE, journal->base_size);
+}
+
+bool
+gnc_xml_journal_has_pending (const GncXmlJournal *journal)
+{
+    g_return_val_if_fail (journal, FALSE);
+    return g_hash_table_size (journal->pending) > 0;
+}
+
+bool
+gnc_xml_journal_has_entries (const GncXmlJournal *journal)
+{
+    g_return_val_if_fail (journal, FALSE);
+    return journal->base_valid && journal->size > 0;
+}
+
+/* ================================================================= */
+
+static bool
+journal_write_record (FILE *out, QofBook *book, const GncGUID *guid,
+                      QofIdTypeConst type)
+{
+    xmlNodePtr node;
+
+    if (!g_strcmp0 (type, GNC_ID_TRANS))
+    {
+        Transaction *trn = xaccTransLookup (guid, book);
+        if (trn && !qof_instance_get_destroying (trn))
+            node = gnc_transaction_dom_tree_create (trn);
+        else
+            node = guid_to_dom_tree (TRN_DESTROY_TAG, guid);
+    }
+    else
+    {
+        GNCPrice *p = gnc_price_lookup (guid, book);
+        if (p && p->db && !qof_instance_get_destroying (p))
+            node = gnc_price_to_dom_tree (BAD_CAST PRICE_TAG, p);
+        else
+            node = guid_to_dom_tree (PRICE_DESTROY_TAG, guid);
+    }
+    if (!node)
+        return FALSE;
+
+    xmlElemDump (out, NULL, node);
+    xmlFreeNode (node);
+
+    return !ferror (out) && fprintf (out, "\n") >= 0;
+}
+
+bool
+gnc_xml_journal_flush (GncXmlJournal *journal, QofBook *book)
+{
+    GHashTableIter iter;
+    gpointer key, value;
+    struct stat statbuf;
+    FILE *out;
+    bool ok = TRUE;
+
+    g_return_val_if_fail (journal && book, FALSE);
+
+    if (!journal->base_valid || journal->needs_full)
+        return FALSE;
+    if (g_hash_table_size (journal->pending) == 0)
+        return TRUE;
+
+    ENTER ("journal=%s changes=%u", journal->filename,
+           g_hash_table_size (journal->pending));
+
+    if (journal->size == 0)
+    {
+        /* Start a new journal, replacing any stale one */
+        if (!journal->base_checksum)
+            journal->base_checksum = gnc_xml_file_checksum (journal->datafile);
+        if (!journal->base_checksum)
+        {
+            LEAVE ("can't read %s", journal->datafile);
+            return FALSE;
+        }
+        out = g_fopen (journal->filename, "wb");
+        if (out &&
+                fprintf (out, "%s %d %s\n", JOURNAL_MAGIC, JOURNAL_VERSION,
+                         journal->base_checksum) < 0)
+            ok = FALSE;
+    }
+    else
+    {
+        out = g_fopen (journal->filename, "ab");
+    }
+    if (!out)
+    {
+        PWARN ("unable to open %s: %s", journal->filename,
+               g_strerror (errno) ? g_strerror (errno) : "");
+        LEAVE ("");
+        return FALSE;
+    }
+
+    g_hash_table_iter_init (&iter, journal->pending);
+    while (ok && g_hash_table_iter_next (&iter, &key, &value))
+        ok = journal_write_record (out, book, (const GncGUID *) key,
+                                   (QofIdTypeConst) value);
+
+    if (fclose (out) != 0)
+        ok = FALSE;
+
+    if (!ok || g_stat (journal->filename, &statbuf) != 0)
+    {
+        /* The file may end in a partial record now; don't append
+         * anything after it. */
+        PWARN ("unable to write %s", journal->filename);
+        journal->needs_full = TRUE;
+        LEAVE ("");
+        return FALSE;
+    }
+
+    journal->size = statbuf.st_size;
+    g_hash_table_remove_all (journal->pending);
+    LEAVE ("journal=%s size=%" G_GINT64_FORMAT, journal->filename,
+           journal->size);
+    return TRUE;
+}
+
+void
+gnc_xml_journal_reset (GncXmlJournal *journal)
+{
+    struct stat statbuf;
+
+    g_return_if_fail (journal);
+
+    g_hash_table_remove_all (journal->pending);
+    if (g_unlink (journal->filename) != 0 && errno != ENOENT)
+    {
+        /* Harmless: it no longer matches the data file */
+        PWARN ("unable to unlink %s: %s", journal->filename,
+               g_strerror (errno) ? g_strerror (errno) : "");
+    }
+    journal->size = 0;
+    journal->needs_full = FALSE;
+    /* Worked out when the next journal is started */
+    g_free (journal->base_checksum);
+    journal->base_checksum = NULL;
+    journal->base_valid = (g_stat (journal->datafile, &statbuf) == 0);
+    journal->base_size = journal->base_valid ? statbuf.st_size : 0;
+}
+
+/* ================================================================= */
+
+typedef struct
+{
+    QofBook *book;
+    guint applied;
+} JournalReplayData;
+
+static GncGUID *
+journal_node_guid (xmlNodePtr node, const char *id_tag)
+{
+    xmlNodePtr child;
+
+    for (child = node->xmlChildrenNode; child; child = child->next)
+    {
+        if (child->type == XML_ELEMENT_NODE &&
+                g_strcmp0 ((char*) child->name, id_tag) == 0)
+            return dom_tree_to_guid (child);
+    }
+    return NULL;
+}
+
+static void
+journal_destroy_transaction (QofBook *book, const GncGUID *guid)
+{
+    Transaction *trn = xaccTransLookup (guid, book);
+
+    if (!trn) return;
+    xaccTransBeginEdit (trn);
+    xaccTransDestroy (trn);
+    xaccTransCommitEdit (trn);
+}
+
+static void
+journal_destroy_price (QofBook *book, const GncGUID *guid)
+{
+    GNCPrice *p = gnc_price_lookup (guid, book);
+
+    if (p && p->db)
+        gnc_pricedb_remove_price (p->db, p);
+}
+
+static bool
+journal_apply_record (QofBook *book, xmlNodePtr node)
+{
+    const char *tag = (const char *) node->name;
+    GncGUID *guid;
+
+    if (g_strcmp0 (tag, TRANSACTION_TAG) == 0)
+    {
+        guid = journal_node_guid (node, "trn:id");
+        if (!guid) return FALSE;
+        journal_destroy_transaction (book, guid);
+        g_free (guid);
+        return dom_tree_to_transaction (node, book) != NULL;
+    }
+    if (g_strcmp0 (tag, PRICE_TAG) == 0)
+    {
+        GNCPrice *p;
+
+        guid = journal_node_guid (node, "price:id");
+        if (!guid) return FALSE;
+        journal_destroy_price (book, guid);
+        g_free (guid);
+        p = dom_tree_to_price (node, book);
+        if (!p) return FALSE;
+        gnc_pricedb_add_price (gnc_pricedb_get_db (book), p);
+        gnc_price_unref (p);
+        return TRUE;
+    }
+
+    guid = dom_tree_to_guid (node);
+    if (!guid) return FALSE;
+    if (g_strcmp0 (tag, TRN_DESTROY_TAG) == 0)
+        journal_destroy_transaction (book, guid);
+    else
+        journal_destroy_price (book, guid);
+    g_free (guid);
+    return TRUE;
+}
+
+static bool
+journal_record_end_handler (gpointer data_for_children,
+                            GSList* data_from_children, GSList* sibling_data,
+                            gpointer parent_data, gpointer global_data,
+                            gpointer *result, const gchar *tag)
+{
+    xmlNodePtr tree = (xmlNodePtr) data_for_children;
+    JournalReplayData *jdata = (JournalReplayData *) global_data;
+    bool ok;
+
+    if (parent_data)
+        return TRUE;
+    if (!tag)
+        return TRUE;
+
+    g_return_val_if_fail (tree, FALSE);
+
+    ok = journal_apply_record (jdata->book, tree);
+    if (ok)
+        jdata->applied++;
+    else
+        PWARN ("unable to replay a %s record", tag);
+
+    xmlFreeNode (tree);
+    return ok;
+}
+
+/* Check the header line, returning the records after it or NULL.
+ * The checksum it names is put in base_checksum. */
+static gchar *
+journal_parse_header (gchar *contents, gchar **base_checksum)
+{
+    gchar *p, *end;
+
+    if (!g_str_has_prefix (contents, JOURNAL_MAGIC " "))
+        return NULL;
+    p = contents + strlen (JOURNAL_MAGIC " ");
+
+    if (g_ascii_strtoll (p, &end, 10) != JOURNAL_VERSION || *end != ' ')
+        return NULL;
+    p = end + 1;
+    end = strchr (p, '\n');
+    if (!end || end == p)
+        return NULL;
+    *base_checksum = g_strndup (p, end - p);
+    return end + 1;
+}
+
+QofBackendError
+gnc_xml_journal_replay (GncXmlJournal *journal, QofBook *book)
+{
+    JournalReplayData jdata;
+    sixtp *top_parser, *journal_parser;
+    struct stat statbuf;
+    gchar *contents = NULL, *body, *buf;
+    gchar *base_checksum = NULL, *checksum;
+    gsize length;
+    bool ok;
+
+    g_return_val_if_fail (journal && book, ERR_BACKEND_MISC);
+    ENTER ("journal=%s", journal->filename);
+
+    /* Nothing committed while replaying is recorded */
+    g_hash_table_remove_all (journal->pending);
+    g_free (journal->base_checksum);
+    journal->base_checksum = NULL;
+    journal->base_valid = FALSE;
+    journal->needs_full = FALSE;
+    journal->size = 0;
+
+    if (g_stat (journal->datafile, &statbuf) != 0)
+    {
+        LEAVE ("can't stat %s", journal->datafile);
+        return ERR_FILEIO_FILE_NOT_FOUND;
+    }
+    journal->base_size = statbuf.st_size;
+
+    if (!g_file_get_contents (journal->filename, &contents, &length, NULL))
+    {
+        journal->base_valid = TRUE;
+        LEAVE ("no journal");
+        return ERR_BACKEND_NO_ERR;
+    }
+
+    /* A journal can't be applied to any other version of the data
+     * file, and dropping it would lose the changes it holds.  Leave
+     * both alone for the user to sort out. */
+    body = journal_parse_header (contents, &base_checksum);
+    checksum = body ? gnc_xml_file_checksum (journal->datafile) : NULL;
+    if (!body || g_strcmp0 (base_checksum, checksum) != 0)
+    {
+        PERR ("journal %s doesn't match %s", journal->filename,
+              journal->datafile);
+        g_free (checksum);
+        g_free (base_checksum);
+        g_free (contents);
+        LEAVE ("");
+        return ERR_FILEIO_JOURNAL_MISMATCH;
+    }
+    g_free (base_checksum);
+    journal->base_checksum = checksum;
+    journal->size = length;
+
+    buf = g_strconcat ("<?xml version=\"1.0\" encoding=\"utf-8\" ?>\n<",
+                       JOURNAL_TAG, ">\n", body, "</", JOURNAL_TAG, ">\n",
+                       NULL);
+    g_free (contents);
+
+    top_parser = sixtp_new ();
+    journal_parser = sixtp_new ();
+    if (!sixtp_add_some_sub_parsers (
+                top_parser, TRUE,
+                JOURNAL_TAG, journal_parser,
+                NULL, NULL)
+            || !sixtp_add_some_sub_parsers (
+                journal_parser, TRUE,
+                TRANSACTION_TAG,
+                sixtp_dom_parser_new (journal_record_end_handler, NULL, NULL),
+                PRICE_TAG,
+                sixtp_dom_parser_new (journal_record_end_handler, NULL, NULL),
+                TRN_DESTROY_TAG,
+                sixtp_dom_parser_new (journal_record_end_handler, NULL, NULL),
+                PRICE_DESTROY_TAG,
+                sixtp_dom_parser_new (journal_record_end_handler, NULL, NULL),
+                NULL, NULL))
+    {
+        sixtp_destroy (top_parser);
+        g_free (buf);
+        LEAVE ("unable to create the parser");
+        return ERR_BACKEND_MISC;
+    }
+
+    jdata.book = book;
+    jdata.applied = 0;
+
+    /* The changes were logged when they were first made */
+    xaccLogDisable ();
+    ok = sixtp_parse_buffer (top_parser, buf, strlen (buf), NULL, &jdata,
+                             NULL);
+    xaccLogEnable ();
+
+    sixtp_destroy (top_parser);
+    g_free (buf);
+
+    journal->base_valid = TRUE;
+    if (!ok)
+    {
+        /* Most likely a save was cut short; whatever came before it
+         * has been applied.  Don't append after the damage. */
+        PWARN ("journal %s is damaged, replayed %u changes",
+               journal->filename, jdata.applied);
+        journal->needs_full = TRUE;
+    }
+    LEAVE ("journal=%s replayed=%u", journal->filename, jdata.applied);
+    return ERR_BACKEND_NO_ERR;
+}
@@ -0,0 +1,95 @@
+/********************************************************************\
+ * io-journal.h -- append-only change journal for xml data files    *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+/**
+ * @file io-journal.h
+ * @brief change journal kept next to an xml data file
+ *
+ * Rewriting the whole data file on every save costs time in
+ * proportion to the size of the book, however little changed.  The
+ * journal lets a save append just the transactions and prices
+ * committed since the previous save to a sidecar file (the data file
+ * name with ".journal" appended), in the same xml the data file uses.
+ * Loading the data file replays the journal over it.  The journal
+ * names the data file it extends by the SHA-1 checksum of its
+ * contents; a data file which no longer matches its journal isn't
+ * opened.
+ *
+ * Changes to any other kind of object can't be journalled; once one
+ * is committed the next save rewrites the data file, which empties
+ * the journal.  So does a save once the journal has grown as large
+ * as the data file, and the end of a session whose book was saved
+ * through the journal.
+ */
+
+#ifndef IO_JOURNAL_H
+#define IO_JOURNAL_H
+
+#include <glib.h>
+
+#include "qof.h"
+
+typedef struct GncXmlJournal GncXmlJournal;
+
+/** Create the journal state for datafile.  Nothing is read or
+ *  written until the journal is replayed or flushed. */
+GncXmlJournal *gnc_xml_journal_new (const char *datafile);
+
+void gnc_xml_journal_destroy (GncXmlJournal *journal);
+
+/** Note that inst was committed.  Called from the backend's commit
+ *  hook; does nothing until the data file has been loaded or
+ *  written. */
+void gnc_xml_journal_record (GncXmlJournal *journal, QofInstance *inst);
+
+/** Return TRUE if the next save must rewrite the data file: it hasn't
+ *  been written or loaded yet, an object the journal can't describe
+ *  was committed, or the journal has grown too large. */
+bool gnc_xml_journal_wants_compaction (const GncXmlJournal *journal);
+
+/** Return TRUE if changes have been recorded since the last flush. */
+bool gnc_xml_journal_has_pending (const GncXmlJournal *journal);
+
+/** Return TRUE if the journal file holds changes which are not yet in
+ *  the data file. */
+bool gnc_xml_journal_has_entries (const GncXmlJournal *journal);
+
+/** Append the changes recorded since the last flush to the journal
+ *  file.  Returns FALSE if the write failed, in which case the
+ *  changes are still pending and the data file should be rewritten
+ *  instead. */
+bool gnc_xml_journal_flush (GncXmlJournal *journal, QofBook *book);
+
+/** Forget the pending changes and remove the journal file.  Call
+ *  after the whole book has been written to the data file. */
+void gnc_xml_journal_reset (GncXmlJournal *journal);
+
+/** Apply the journal file to book, which has just been loaded from
+ *  the data file.  A journal written against some other version of
+ *  the data file, as told by the SHA-1 checksum of its contents, is
+ *  not applied and not removed; ERR_FILEIO_JOURNAL_MISMATCH is
+ *  returned and the file should not be opened.  A journal which can't
+ *  be read to the end is applied up to the damage, and the next save
+ *  rewrites the data file. */
+QofBackendError gnc_xml_journal_replay (GncXmlJournal *journal, QofBook *book);
+
+#endif /* IO_JOURNAL_H */
@@ -0,0 +1,1781 @@
+/********************************************************************\
+ * io-snapshot.cpp -- binary snapshot cache for xml data files      *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include "config.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "qof.h"
+#include "Account.h"
+#include "AccountP.h"
+#include "Transaction.h"
+#include "TransactionP.h"
+#include "Split.h"
+#include "SplitP.h"
+#include "gnc-lot.h"
+#include "gnc-lot-p.h"
+#include "gnc-commodity.h"
+#include "gnc-pricedb.h"
+#include "gnc-pricedb-p.h"
+#include "SX-book.h"
+#include "SX-book-p.h"
+#include "SchedXaction.h"
+#include "Recurrence.h"
+#include "TransLog.h"
+
+#include "io-gncxml-v2.h"
+#include "io-snapshot.h"
+
+static QofLogModule log_module = GNC_MOD_IO;
+
+/* ================================================================= */
+/* File layout.
+ *
+ * A SnapHeader is followed by the sections it lists, each starting on
+ * an eight byte boundary.  Every section is an array of fixed size
+ * records, except the string table which is a run of nul terminated
+ * strings (and the raw bytes of binary kvp values) addressed by byte
+ * offset.  Records refer to strings by offset, to objects by record
+ * number within the object's section and to their own GUID by an
+ * index into the GUID section.  SNAP_NONE stands for a NULL string
+ * or a missing reference.
+ *
+ * The file is written in native byte order and is only ever read
+ * back on the machine that wrote it; the header records enough to
+ * reject anything else.
+ */
+
+#define SNAP_MAGIC "GNCSNAP"
+#define SNAP_VERSION 3
+#define SNAP_BYTE_ORDER 0x01020304
+#define SNAP_NONE G_MAXUINT32
+#define SNAP_ALIGN(x) (((x) + 7) & ~((guint64) 7))
+
+typedef enum
+{
+    SNAP_STRINGS,
+    SNAP_GUIDS,
+    SNAP_KVP,
+    SNAP_BOOK,
+    SNAP_COMMODITIES,
+    SNAP_ACCOUNTS,
+    SNAP_LOTS,
+    SNAP_TRANSACTIONS,
+    SNAP_SPLITS,
+    SNAP_PRICES,
+    SNAP_SCHEDXACTIONS,
+    SNAP_RECURRENCES,
+    SNAP_SX_DEFERRED,
+    SNAP_N_SECTIONS
+} SnapSectionId;
+
+typedef struct
+{
+    guint64 offset;
+    guint64 count;
+    guint32 record_size;
+    guint32 reserved;
+} SnapSection;
+
+/* What identifies the data file a snapshot was made from.  Size and
+ * times are a quick check; an edit which keeps the size within the
+ * clock's resolution is caught by the checksum of the contents. */
+#define SNAP_CHECKSUM_LEN 20        /* SHA-1 */
+
+typedef struct
+{
+    gint64 size;
+    gint64 mtime;
+    gint64 mtime_nsec;
+    gint64 ctime;
+    gint64 ctime_nsec;
+    guint64 inode;
+    guint8 checksum[SNAP_CHECKSUM_LEN];
+    guint32 reserved;
+} SnapSource;
+
+typedef struct
+{
+    char magic[8];
+    guint32 version;
+    guint32 byte_order;
+    SnapSource source;      /* the data file the snapshot was made for */
+    SnapSection sections[SNAP_N_SECTIONS];
+} SnapHeader;
+
+/* The GUID index: one entry for every object in the snapshot, giving
+ * the section (kind) and record number holding it. */
+typedef struct
+{
+    GncGUID guid;
+    guint32 kind;
+    guint32 record;
+} SnapGuid;
+
+/* A kvp slot.  The slots of a frame, and the values of a list, are
+ * consecutive entries which always follow the entry holding them. */
+typedef struct
+{
+    guint32 key;            /* SNAP_NONE for list values */
+    guint32 type;           /* KvpValueType */
+    guint32 first;          /* string, blob or first child */
+    guint32 count;          /* blob size or number of children */
+    gint64 v[2];            /* scalar payload */
+} SnapKvp;
+
+typedef struct
+{
+    guint32 guid;
+    guint32 kvp_first;
+    guint32 kvp_count;
+    guint32 template_root;  /* account record, SNAP_NONE if no templates */
+} SnapBook;
+
+typedef struct
+{
+    guint32 name_space;
+    guint32 mnemonic;
+    guint32 fullname;
+    guint32 cusip;
+    guint32 quote_source;
+    guint32 quote_tz;
+    gint32 fraction;
+    guint32 quote_flag;
+    guint32 kvp_first;
+    guint32 kvp_count;
+} SnapCommodity;
+
+/* Accounts are stored parents first, the root account as record 0.
+ * The template accounts follow the account tree, their root being the
+ * only other account without a parent. */
+typedef struct
+{
+    guint32 guid;
+    guint32 parent;
+    guint32 type;
+    guint32 name;
+    guint32 code;
+    guint32 description;
+    guint32 commodity;
+    gint32 commodity_scu;
+    guint32 non_std_scu;
+    guint32 kvp_first;
+    guint32 kvp_count;
+    guint32 reserved;
+} SnapAccount;
+
+typedef struct
+{
+    guint32 guid;
+    guint32 account;
+    guint32 kvp_first;
+    guint32 kvp_count;
+} SnapLot;
+
+typedef struct
+{
+    gint64 posted_sec;
+    gint64 posted_nsec;
+    gint64 entered_sec;
+    gint64 entered_nsec;
+    guint32 guid;
+    guint32 currency;
+    guint32 num;
+    guint32 description;
+    guint32 kvp_first;
+    guint32 kvp_count;
+    guint32 first_split;
+    guint32 n_splits;
+} SnapTransaction;
+
+typedef struct
+{
+    gint64 amount_num;
+    gint64 amount_denom;
+    gint64 value_num;
+    gint64 value_denom;
+    gint64 reconciled_sec;
+    gint64 reconciled_nsec;
+    guint32 guid;
+    guint32 account;
+    guint32 lot;
+    guint32 memo;
+    guint32 action;
+    guint32 reconcile;
+    guint32 kvp_first;
+    guint32 kvp_count;
+} SnapSplit;
+
+typedef struct
+{
+    gint64 time_sec;
+    gint64 time_nsec;
+    gint64 value_num;
+    gint64 value_denom;
+    guint32 guid;
+    guint32 commodity;
+    guint32 currency;
+    guint32 source;
+    guint32 type;
+    guint32 reserved;
+} SnapPrice;
+
+/* Dates are stored as julian days, 0 standing for an invalid date. */
+typedef struct
+{
+    guint32 guid;
+    guint32 name;
+    guint32 template_acct;
+    guint32 enabled;
+    guint32 auto_create;
+    guint32 auto_notify;
+    gint32 advance_create;
+    gint32 advance_remind;
+    guint32 start_date;
+    guint32 last_date;
+    guint32 end_date;
+    gint32 num_occur_total;
+    gint32 num_occur_remain;
+    gint32 instance_num;
+    guint32 first_recurrence;
+    guint32 n_recurrences;
+    guint32 first_deferred;
+    guint32 n_deferred;
+    guint32 kvp_first;
+    guint32 kvp_count;
+} SnapSchedXaction;
+
+typedef struct
+{
+    guint32 start;
+    guint32 period_type;
+    guint32 mult;
+    guint32 weekend_adjust;
+} SnapRecurrence;
+
+typedef struct
+{
+    guint32 last_date;
+    gint32 num_occur_rem;
+    gint32 num_inst;
+    guint32 reserved;
+} SnapSxDeferred;
+
+static const guint32 snap_record_size[SNAP_N_SECTIONS] =
+{
+    1,
+    sizeof (SnapGuid),
+    sizeof (SnapKvp),
+    sizeof (SnapBook),
+    sizeof (SnapCommodity),
+    sizeof (SnapAccount),
+    sizeof (SnapLot),
+    sizeof (SnapTransaction),
+    sizeof (SnapSplit),
+    sizeof (SnapPrice),
+    sizeof (SnapSchedXaction),
+    sizeof (SnapRecurrence),
+    sizeof (SnapSxDeferred),
+};
+
+gchar *
+gnc_xml_snapshot_filename (const char *datafile)
+{
+    g_return_val_if_fail (datafile, NULL);
+    return g_strconcat (datafile, ".snap", NULL);
+}
+
+/* ================================================================= */
+/* Recognizing the data file */
+
+#if defined(G_OS_WIN32)
+#define SNAP_STAT_NSEC(st, field) 0
+#elif defined(__APPLE__)
+#define SNAP_STAT_NSEC(st, field) ((st).st_##field##timespec.tv_nsec)
+#else
+#define SNAP_STAT_NSEC(st, field) ((st).st_##field##tim.tv_nsec)
+#endif
+
+/* Work out the SHA-1 checksum of filename's contents.  Returns NULL
+ * if the file can't be read; the caller must g_checksum_free the
+ * result. */
+static GChecksum *
+snap_file_checksum (const char *filename)
+{
+    GChecksum *checksum;
+    guchar buffer[65536];
+    size_t n;
+    FILE *in;
+
+    in = g_fopen (filename, "rb");
+    if (!in) return NULL;
+    checksum = g_checksum_new (G_CHECKSUM_SHA1);
+    while ((n = fread (buffer, 1, sizeof (buffer), in)) > 0)
+        g_checksum_update (checksum, buffer, n);
+    if (ferror (in))
+    {
+        g_checksum_free (checksum);
+        fclose (in);
+        return NULL;
+    }
+    fclose (in);
+    return checksum;
+}
+
+gchar *
+gnc_xml_file_checksum (const char *filename)
+{
+    GChecksum *checksum;
+    gchar *hex;
+
+    g_return_val_if_fail (filename, NULL);
+
+    checksum = snap_file_checksum (filename);
+    if (!checksum) return NULL;
+    hex = g_strdup (g_checksum_get_string (checksum));
+    g_checksum_free (checksum);
+    return hex;
+}
+
+/* Fill in source for datafile.  Returns FALSE if the file can't be
+ * read. */
+static bool
+snap_source_read (const char *datafile, SnapSource *source)
+{
+    GChecksum *checksum;
+    struct stat st;
+    gsize len = SNAP_CHECKSUM_LEN;
+
+    memset (source, 0, sizeof (*source));
+    if (g_stat (datafile, &st) != 0) return FALSE;
+
+    source->size = st.st_size;
+    source->mtime = st.st_mtime;
+    source->mtime_nsec = SNAP_STAT_NSEC (st, m);
+    source->ctime = st.st_ctime;
+    source->ctime_nsec = SNAP_STAT_NSEC (st, c);
+    source->inode = st.st_ino;
+
+    checksum = snap_file_checksum (datafile);
+    if (!checksum) return FALSE;
+    g_checksum_get_digest (checksum, source->checksum, &len);
+    g_checksum_free (checksum);
+    return TRUE;
+}
+
+/* Whether the snapshot recorded for stored still describes datafile.
+ * The checksum is only worked out when everything stat() says agrees. */
+static bool
+snap_source_matches (const SnapSource *stored, const char *datafile)
+{
+    SnapSource current;
+    struct stat st;
+
+    if (g_stat (datafile, &st) != 0) return FALSE;
+    if (stored->size != (gint64) st.st_size ||
+            stored->mtime != (gint64) st.st_mtime ||
+            stored->mtime_nsec != (gint64) SNAP_STAT_NSEC (st, m) ||
+            stored->ctime != (gint64) st.st_ctime ||
+            stored->ctime_nsec != (gint64) SNAP_STAT_NSEC (st, c) ||
+            stored->inode != (guint64) st.st_ino)
+        return FALSE;
+
+    if (!snap_source_read (datafile, &current)) return FALSE;
+    return memcmp (stored->checksum, current.checksum, SNAP_CHECKSUM_LEN) == 0;
+}
+
+/* ================================================================= */
+/* Writing */
+
+typedef struct
+{
+    GByteArray *strings;
+    GHashTable *string_index;   /* string -> offset + 1 */
+    GArray *sections[SNAP_N_SECTIONS];
+    GHashTable *commodity_index;  /* gnc_commodity* -> record + 1 */
+    GHashTable *account_index;
+    GHashTable *lot_index;
+    bool ok;
+} SnapWriter;
+
+static guint32
+snap_lookup (GHashTable *index, gconstpointer obj)
+{
+    guint record = GPOINTER_TO_UINT (g_hash_table_lookup (index, obj));
+    return record ? record - 1 : SNAP_NONE;
+}
+
+static guint32
+snap_add_record (SnapWriter *w, SnapSectionId id, gconstpointer record)
+{
+    GArray *array = w->sections[id];
+    g_array_append_vals (array, record, 1);
+    return array->len - 1;
+}
+
+static guint32
+snap_add_string (SnapWriter *w, const char *str)
+{
+    guint32 offset;
+
+    if (!str) return SNAP_NONE;
+
+    offset = GPOINTER_TO_UINT (g_hash_table_lookup (w->string_index, str));
+    if (offset) return offset - 1;
+
+    offset = w->strings->len;
+    g_byte_array_append (w->strings, (const guint8 *) str, strlen (str) + 1);
+    g_hash_table_insert (w->string_index, (gpointer) str,
+                         GUINT_TO_POINTER (offset + 1));
+    return offset;
+}
+
+static guint32
+snap_add_guid (SnapWriter *w, const GncGUID *guid, SnapSectionId kind,
+               guint32 record)
+{
+    SnapGuid entry;
+
+    entry.guid = *guid;
+    entry.kind = kind;
+    entry.record = record;
+    return snap_add_record (w, SNAP_GUIDS, &entry);
+}
+
+static void snap_add_frame (SnapWriter *w, KvpFrame *frame,
+                            guint32 *first, guint32 *count);
+
+/* Fill in the kvp entry at slot, which has already been reserved. */
+static void
+snap_add_value (SnapWriter *w, guint32 slot, guint32 key, KvpValue *value)
+{
+    GArray *kvp = w->sections[SNAP_KVP];
+    SnapKvp entry;
+
+    memset (&entry, 0, sizeof (entry));
+    entry.key = key;
+    entry.type = kvp_value_get_type (value);
+    entry.first = SNAP_NONE;
+
+    switch (kvp_value_get_type (value))
+    {
+    case KVP_TYPE_GINT64:
+        entry.v[0] = kvp_value_get_gint64 (value);
+        break;
+    case KVP_TYPE_DOUBLE:
+    {
+        double d = kvp_value_get_double (value);
+        memcpy (entry.v, &d, sizeof (d));
+        break;
+    }
+    case KVP_TYPE_NUMERIC:
+    {
+        gnc_numeric n = kvp_value_get_numeric (value);
+        entry.v[0] = n.num;
+        entry.v[1] = n.denom;
+        break;
+    }
+    case KVP_TYPE_STRING:
+        entry.first = snap_add_string (w, kvp_value_get_string (value));
+        break;
+    case KVP_TYPE_GUID:
+    {
+        const GncGUID *guid = kvp_value_get_guid (value);
+        memcpy (entry.v, guid ? guid : guid_null (), sizeof (GncGUID));
+        break;
+    }
+    case KVP_TYPE_TIMESPEC:
+    {
+        Timespec ts = kvp_value_get_timespec (value);
+        entry.v[0] = ts.tv_sec;
+        entry.v[1] = ts.tv_nsec;
+        break;
+    }
+    case KVP_TYPE_BINARY:
+    {
+        uint64_t size;
+        void *data = kvp_value_get_binary (value, &size);
+
+        if (size >= G_MAXUINT32)
+        {
+            w->ok = FALSE;
+            break;
+        }
+        entry.first = w->strings->len;
+        entry.count = (guint32) size;
+        if (size)
+            g_byte_array_append (w->strings, (const guint8 *) data, size);
+        break;
+    }
+    case KVP_TYPE_GLIST:
+    {
+        GList *node = kvp_value_get_glist (value);
+        guint32 i;
+
+        entry.count = g_list_length (node);
+        entry.first = kvp->len;
+        g_array_set_size (kvp, kvp->len + entry.count);
+        for (i = 0; node; node = node->next, i++)
+            snap_add_value (w, entry.first + i, SNAP_NONE,
+                            (KvpValue *) node->data);
+        break;
+    }
+    case KVP_TYPE_FRAME:
+        snap_add_frame (w, kvp_value_get_frame (value),
+                        &entry.first, &entry.count);
+        break;
+    case KVP_TYPE_GDATE:
+    {
+        GDate date = kvp_value_get_gdate (value);
+        entry.v[0] = g_date_valid (&date) ? g_date_get_julian (&date) : 0;
+        break;
+    }
+    default:
+        PWARN ("unknown kvp value type %d", entry.type);
+        w->ok = FALSE;
+        break;
+    }
+
+    /* kvp may have been reallocated by the nested additions */
+    g_array_index (w->sections[SNAP_KVP], SnapKvp, slot) = entry;
+}
+
+typedef struct
+{
+    SnapWriter *w;
+    guint32 next;
+} SnapFrameFill;
+
+static void
+snap_count_slot (const char *key, KvpValue *value, gpointer data)
+{
+    (*(guint32 *) data)++;
+}
+
+static void
+snap_fill_slot (const char *key, KvpValue *value, gpointer data)
+{
+    SnapFrameFill *fill = (SnapFrameFill *) data;
+    guint32 slot = fill->next++;
+
+    snap_add_value (fill->w, slot, snap_add_string (fill->w, key), value);
+}
+
+static void
+snap_add_frame (SnapWriter *w, KvpFrame *frame, guint32 *first, guint32 *count)
+{
+    GArray *kvp = w->sections[SNAP_KVP];
+    SnapFrameFill fill;
+
+    *first = SNAP_NONE;
+    *count = 0;
+    if (!frame || kvp_frame_is_empty (frame)) return;
+
+    kvp_frame_for_each_slot (frame, snap_count_slot, count);
+    *first = kvp->len;
+    g_array_set_size (kvp, kvp->len + *count);
+
+    fill.w = w;
+    fill.next = *first;
+    kvp_frame_for_each_slot (frame, snap_fill_slot, &fill);
+}
+
+static void
+snap_add_commodities (SnapWriter *w, QofBook *book)
+{
+    gnc_commodity_table *tbl = gnc_commodity_table_get_table (book);
+    std::list<gnc_commodity_namespace*> namespaces =
+        gnc_commodity_table_get_namespaces (tbl);
+
+    for (std::list<gnc_commodity_namespace*>::iterator ns = namespaces.begin();
+            ns != namespaces.end(); ns++)
+    {
+        CommodityList_t comms =
+            gnc_commodity_table_get_commodities (tbl, (*ns)->name);
+
+        for (CommodityList_t::iterator it = comms.begin(); it != comms.end(); it++)
+        {
+            gnc_commodity *com = *it;
+            gnc_quote_source *source = gnc_commodity_get_quote_source (com);
+            SnapCommodity rec;
+            guint32 record;
+
+            rec.name_space = snap_add_string (w, gnc_commodity_get_namespace (com));
+            rec.mnemonic = snap_add_string (w, gnc_commodity_get_mnemonic (com));
+            rec.fullname = snap_add_string (w, gnc_commodity_get_fullname (com));
+            rec.cusip = snap_add_string (w, gnc_commodity_get_cusip (com));
+            rec.quote_source = snap_add_string (w,
+                                                source ? gnc_quote_source_get_internal_name (source) : NULL);
+            rec.quote_tz = snap_add_string (w, gnc_commodity_get_quote_tz (com));
+            rec.fraction = gnc_commodity_get_fraction (com);
+            rec.quote_flag = gnc_commodity_get_quote_flag (com);
+            snap_add_frame (w, qof_instance_get_slots (QOF_INSTANCE (com)),
+                            &rec.kvp_first, &rec.kvp_count);
+
+            record = snap_add_record (w, SNAP_COMMODITIES, &rec);
+            g_hash_table_insert (w->commodity_index, com,
+                                 GUINT_TO_POINTER (record + 1));
+        }
+    }
+}
+
+static void
+snap_add_account (Account *acc, gpointer data)
+{
+    SnapWriter *w = (SnapWriter *) data;
+    Account *parent = gnc_account_get_parent (acc);
+    gnc_commodity *com = xaccAccountGetCommodity (acc);
+    SnapAccount rec;
+    guint32 record;
+
+    memset (&rec, 0, sizeof (rec));
+    record = w->sections[SNAP_ACCOUNTS]->len;
+    rec.guid = snap_add_guid (w, xaccAccountGetGUID (acc), SNAP_ACCOUNTS, record);
+    rec.parent = parent ? snap_lookup (w->account_index, parent) : SNAP_NONE;
+    rec.type = xaccAccountGetType (acc);
+    rec.name = snap_add_string (w, xaccAccountGetName (acc));
+    rec.code = snap_add_string (w, xaccAccountGetCode (acc));
+    rec.description = snap_add_string (w, xaccAccountGetDescription (acc));
+    rec.commodity = com ? snap_lookup (w->commodity_index, com) : SNAP_NONE;
+    rec.commodity_scu = xaccAccountGetCommoditySCUi (acc);
+    rec.non_std_scu = xaccAccountGetNonStdSCU (acc);
+    snap_add_frame (w, qof_instance_get_slots (QOF_INSTANCE (acc)),
+                    &rec.kvp_first, &rec.kvp_count);
+
+    if ((parent && rec.parent == SNAP_NONE) ||
+            (com && rec.commodity == SNAP_NONE))
+        w->ok = FALSE;
+
+    snap_add_record (w, SNAP_ACCOUNTS, &rec);
+    g_hash_table_insert (w->account_index, acc, GUINT_TO_POINTER (record + 1));
+
+    LotList_t lots = xaccAccountGetLotList (acc);
+    for (LotList_t::const_iterator it = lots.begin(); it != lots.end(); it++)
+    {
+        SnapLot lot_rec;
+        guint32 lot_record = w->sections[SNAP_LOTS]->len;
+
+        lot_rec.guid = snap_add_guid (w, gnc_lot_get_guid (*it), SNAP_LOTS,
+                                      lot_record);
+        lot_rec.account = record;
+        snap_add_frame (w, qof_instance_get_slots (QOF_INSTANCE (*it)),
+                        &lot_rec.kvp_first, &lot_rec.kvp_count);
+        snap_add_record (w, SNAP_LOTS, &lot_rec);
+        g_hash_table_insert (w->lot_index, *it,
+                             GUINT_TO_POINTER (lot_record + 1));
+    }
+}
+
+static int
+snap_add_transaction (Transaction *trans, gpointer data)
+{
+    SnapWriter *w = (SnapWriter *) data;
+    SnapTransaction rec;
+    Timespec ts;
+    guint32 record;
+    int i;
+
+    record = w->sections[SNAP_TRANSACTIONS]->len;
+    rec.guid = snap_add_guid (w, xaccTransGetGUID (trans), SNAP_TRANSACTIONS,
+                              record);
+    rec.currency = snap_lookup (w->commodity_index, xaccTransGetCurrency (trans));
+    rec.num = snap_add_string (w, xaccTransGetNum (trans));
+    rec.description = snap_add_string (w, xaccTransGetDescription (trans));
+    ts = xaccTransRetDatePostedTS (trans);
+    rec.posted_sec = ts.tv_sec;
+    rec.posted_nsec = ts.tv_nsec;
+    ts = xaccTransRetDateEnteredTS (trans);
+    rec.entered_sec = ts.tv_sec;
+    rec.entered_nsec = ts.tv_nsec;
+    snap_add_frame (w, qof_instance_get_slots (QOF_INSTANCE (trans)),
+                    &rec.kvp_first, &rec.kvp_count);
+    rec.first_split = w->sections[SNAP_SPLITS]->len;
+    rec.n_splits = xaccTransCountSplits (trans);
+
+    for (i = 0; i < (int) rec.n_splits; i++)
+    {
+        Split *split = xaccTransGetSplit (trans, i);
+        GNCLot *lot = xaccSplitGetLot (split);
+        SnapSplit srec;
+        gnc_numeric n;
+
+        srec.guid = snap_add_guid (w, xaccSplitGetGUID (split), SNAP_SPLITS,
+                                   w->sections[SNAP_SPLITS]->len);
+        srec.memo = snap_add_string (w, xaccSplitGetMemo (split));
+        srec.action = snap_add_string (w, xaccSplitGetAction (split));
+        srec.reconcile = (guint32) xaccSplitGetReconcile (split);
+        ts = xaccSplitRetDateReconciledTS (split);
+        srec.reconciled_sec = ts.tv_sec;
+        srec.reconciled_nsec = ts.tv_nsec;
+        n = xaccSplitGetValue (split);
+        srec.value_num = n.num;
+        srec.value_denom = n.denom;
+        n = xaccSplitGetAmount (split);
+        srec.amount_num = n.num;
+        srec.amount_denom = n.denom;
+        srec.account = snap_lookup (w->account_index, xaccSplitGetAccount (split));
+        srec.lot = lot ? snap_lookup (w->lot_index, lot) : SNAP_NONE;
+        snap_add_frame (w, qof_instance_get_slots (QOF_INSTANCE (split)),
+                        &srec.kvp_first, &srec.kvp_count);
+
+        if (srec.account == SNAP_NONE || (lot && srec.lot == SNAP_NONE))
+            w->ok = FALSE;
+        snap_add_record (w, SNAP_SPLITS, &srec);
+    }
+
+    if (rec.currency == SNAP_NONE)
+        w->ok = FALSE;
+    snap_add_record (w, SNAP_TRANSACTIONS, &rec);
+    return w->ok ? 0 : -1;
+}
+
+static bool
+snap_add_price (GNCPrice *p, gpointer data)
+{
+    SnapWriter *w = (SnapWriter *) data;
+    SnapPrice rec;
+    Timespec ts = gnc_price_get_time (p);
+    gnc_numeric value = gnc_price_get_value (p);
+
+    memset (&rec, 0, sizeof (rec));
+    rec.guid = snap_add_guid (w, gnc_price_get_guid (p), SNAP_PRICES,
+                              w->sections[SNAP_PRICES]->len);
+    rec.commodity = snap_lookup (w->commodity_index, gnc_price_get_commodity (p));
+    rec.currency = snap_lookup (w->commodity_index, gnc_price_get_currency (p));
+    rec.time_sec = ts.tv_sec;
+    rec.time_nsec = ts.tv_nsec;
+    rec.value_num = value.num;
+    rec.value_denom = value.denom;
+    rec.source = snap_add_string (w, gnc_price_get_source (p));
+    rec.type = snap_add_string (w, gnc_price_get_typestr (p));
+
+    if (rec.commodity == SNAP_NONE || rec.currency == SNAP_NONE)
+        w->ok = FALSE;
+    snap_add_record (w, SNAP_PRICES, &rec);
+    return w->ok;
+}
+
+static guint32
+snap_julian (const GDate *date)
+{
+    return date && g_date_valid (date) ? g_date_get_julian (date) : 0;
+}
+
+static void
+snap_add_schedxactions (SnapWriter *w, QofBook *book)
+{
+    std::list<SchedXaction*> sxes = gnc_book_get_schedxactions (book)->sx_list;
+
+    for (std::list<SchedXaction*>::iterator it = sxes.begin();
+            it != sxes.end(); it++)
+    {
+        SchedXaction *sx = *it;
+        RecurrenceList_t schedule = gnc_sx_get_schedule (sx);
+        std::list<SXTmpStateData*> defers = gnc_sx_get_defer_instances (sx);
+        SnapSchedXaction rec;
+        bool auto_create, auto_notify;
+
+        memset (&rec, 0, sizeof (rec));
+        rec.guid = snap_add_guid (w, xaccSchedXactionGetGUID (sx),
+                                  SNAP_SCHEDXACTIONS,
+                                  w->sections[SNAP_SCHEDXACTIONS]->len);
+        rec.name = snap_add_string (w, xaccSchedXactionGetName (sx));
+        rec.template_acct = snap_lookup (w->account_index, sx->template_acct);
+        xaccSchedXactionGetAutoCreate (sx, &auto_create, &auto_notify);
+        rec.enabled = xaccSchedXactionGetEnabled (sx);
+        rec.auto_create = auto_create;
+        rec.auto_notify = auto_notify;
+        rec.advance_create = xaccSchedXactionGetAdvanceCreation (sx);
+        rec.advance_remind = xaccSchedXactionGetAdvanceReminder (sx);
+        rec.start_date = snap_julian (xaccSchedXactionGetStartDate (sx));
+        rec.last_date = snap_julian (xaccSchedXactionGetLastOccurDate (sx));
+        rec.end_date = snap_julian (xaccSchedXactionGetEndDate (sx));
+        rec.num_occur_total = xaccSchedXactionGetNumOccur (sx);
+        rec.num_occur_remain = xaccSchedXactionGetRemOccur (sx);
+        rec.instance_num = gnc_sx_get_instance_count (sx, NULL);
+        snap_add_frame (w, xaccSchedXactionGetSlots (sx),
+                        &rec.kvp_first, &rec.kvp_count);
+
+        rec.first_recurrence = w->sections[SNAP_RECURRENCES]->len;
+        rec.n_recurrences = schedule.size ();
+        for (RecurrenceList_t::const_iterator r = schedule.begin();
+                r != schedule.end(); r++)
+        {
+            SnapRecurrence rrec;
+            GDate start = recurrenceGetDate (*r);
+
+            rrec.start = snap_julian (&start);
+            rrec.period_type = recurrenceGetPeriodType (*r);
+            rrec.mult = recurrenceGetMultiplier (*r);
+            rrec.weekend_adjust = recurrenceGetWeekendAdjust (*r);
+            snap_add_record (w, SNAP_RECURRENCES, &rrec);
+        }
+
+        rec.first_deferred = w->sections[SNAP_SX_DEFERRED]->len;
+        rec.n_deferred = defers.size ();
+        for (std::list<SXTmpStateData*>::const_iterator d = defers.begin();
+                d != defers.end(); d++)
+        {
+            SnapSxDeferred drec;
+
+            drec.last_date = snap_julian (&(*d)->last_date);
+            drec.num_occur_rem = (*d)->num_occur_rem;
+            drec.num_inst = (*d)->num_inst;
+            drec.reserved = 0;
+            snap_add_record (w, SNAP_SX_DEFERRED, &drec);
+        }
+
+        if (rec.template_acct == SNAP_NONE)
+            w->ok = FALSE;
+        snap_add_record (w, SNAP_SCHEDXACTIONS, &rec);
+    }
+}
+
+typedef struct
+{
+    QofBook *book;
+    bool supported;
+} SnapSupportCheck;
+
+static void
+snap_check_collection (QofCollection *col, gpointer data)
+{
+    SnapSupportCheck *check = (SnapSupportCheck *) data;
+    QofIdTypeConst type = qof_collection_get_type (col);
+
+    /* Anything with its own section in the xml file is out of reach */
+    if (qof_collection_count (col) == 0) return;
+    if (qof_object_lookup_backend (type, GNC_FILE_BACKEND) ||
+            g_strcmp0 (type, GNC_ID_BUDGET) == 0)
+        check->supported = FALSE;
+}
+
+bool
+gnc_xml_snapshot_supported (QofBook *book)
+{
+    SnapSupportCheck check;
+
+    check.book = book;
+    check.supported = TRUE;
+    qof_book_foreach_collection (book, snap_check_collection, &check);
+    return check.supported;
+}
+
+static bool
+snap_write_file (SnapWriter *w, const char *filename, const SnapSource *source)
+{
+    static const char zero[8] = { 0 };
+    SnapHeader header;
+    guint64 offset;
+    gchar *tmp_name;
+    FILE *out;
+    bool ok = TRUE;
+    int fd, i;
+
+    memset (&header, 0, sizeof (header));
+    memcpy (header.magic, SNAP_MAGIC, sizeof (SNAP_MAGIC));
+    header.version = SNAP_VERSION;
+    header.byte_order = SNAP_BYTE_ORDER;
+    header.source = *source;
+
+    offset = SNAP_ALIGN (sizeof (header));
+    for (i = 0; i < SNAP_N_SECTIONS; i++)
+    {
+        guint64 count = (i == SNAP_STRINGS) ? w->strings->len
+                        : w->sections[i]->len;
+
+        header.sections[i].offset = offset;
+        header.sections[i].count = count;
+        header.sections[i].record_size = snap_record_size[i];
+        offset += SNAP_ALIGN (count * snap_record_size[i]);
+    }
+
+    tmp_name = g_strconcat (filename, ".tmp-XXXXXX", NULL);
+    fd = g_mkstemp (tmp_name);
+    if (fd < 0 || !(out = fdopen (fd, "wb")))
+    {
+        PWARN ("unable to create %s: %s", tmp_name, g_strerror (errno));
+        if (fd >= 0) close (fd);
+        g_free (tmp_name);
+        return FALSE;
+    }
+
+    ok = fwrite (&header, sizeof (header), 1, out) == 1;
+    offset = SNAP_ALIGN (sizeof (header)) - sizeof (header);
+    if (ok && offset && fwrite (zero, offset, 1, out) != 1)
+        ok = FALSE;
+    for (i = 0; ok && i < SNAP_N_SECTIONS; i++)
+    {
+        const void *data;
+        guint64 size = header.sections[i].count * snap_record_size[i];
+        guint64 pad = SNAP_ALIGN (size) - size;
+
+        if (i == SNAP_STRINGS)
+            data = w->strings->data;
+        else
+            data = w->sections[i]->data;
+
+        if (size && fwrite (data, size, 1, out) != 1)
+            ok = FALSE;
+        if (ok && pad && fwrite (zero, pad, 1, out) != 1)
+            ok = FALSE;
+    }
+    if (fclose (out) != 0)
+        ok = FALSE;
+
+    if (ok && g_rename (tmp_name, filename) != 0)
+    {
+        PWARN ("unable to rename %s: %s", tmp_name, g_strerror (errno));
+        ok = FALSE;
+    }
+    if (!ok)
+        g_unlink (tmp_name);
+    g_free (tmp_name);
+    return ok;
+}
+
+bool
+gnc_xml_snapshot_write (QofBook *book, const char *datafile)
+{
+    SnapWriter w;
+    SnapBook book_rec;
+    SnapSource source;
+    gchar *filename;
+    Account *root, *template_root;
+    bool ok = FALSE;
+    int i;
+
+    g_return_val_if_fail (book && datafile, FALSE);
+
+    ENTER ("book=%p file=%s", book, datafile);
+    filename = gnc_xml_snapshot_filename (datafile);
+    if (g_unlink (filename) != 0 && errno != ENOENT)
+    {
+        PWARN ("unable to remove stale snapshot %s: %s",
+               filename, g_strerror (errno));
+        g_free (filename);
+        LEAVE ("");
+        return FALSE;
+    }
+
+    root = gnc_book_get_root_account (book);
+    if (!root || !gnc_xml_snapshot_supported (book) ||
+            !snap_source_read (datafile, &source))
+    {
+        g_free (filename);
+        LEAVE ("book not suitable for a snapshot");
+        return FALSE;
+    }
+
+    w.ok = TRUE;
+    w.strings = g_byte_array_new ();
+    w.string_index = g_hash_table_new (g_str_hash, g_str_equal);
+    for (i = 0; i < SNAP_N_SECTIONS; i++)
+        w.sections[i] = (i == SNAP_STRINGS) ? NULL
+                        : g_array_new (FALSE, TRUE, snap_record_size[i]);
+    w.commodity_index = g_hash_table_new (NULL, NULL);
+    w.account_index = g_hash_table_new (NULL, NULL);
+    w.lot_index = g_hash_table_new (NULL, NULL);
+
+    /* Start the string table with "", so that it is never empty */
+    snap_add_string (&w, "");
+
+    book_rec.guid = snap_add_guid (&w, qof_book_get_guid (book), SNAP_BOOK, 0);
+    snap_add_frame (&w, qof_book_get_slots (book),
+                    &book_rec.kvp_first, &book_rec.kvp_count);
+    book_rec.template_root = SNAP_NONE;
+
+    snap_add_commodities (&w, book);
+    snap_add_account (root, &w);
+    gnc_account_foreach_descendant (root, snap_add_account, &w);
+
+    /* As in the xml file, the template tree is only kept when it holds
+     * something. */
+    template_root = gnc_book_get_template_root (book);
+    if (template_root && gnc_account_n_descendants (template_root) > 0)
+    {
+        book_rec.template_root = w.sections[SNAP_ACCOUNTS]->len;
+        snap_add_account (template_root, &w);
+        gnc_account_foreach_descendant (template_root, snap_add_account, &w);
+    }
+    snap_add_record (&w, SNAP_BOOK, &book_rec);
+
+    if (w.ok)
+        xaccAccountTreeForEachTransaction (root, snap_add_transaction, &w);
+    if (w.ok && book_rec.template_root != SNAP_NONE)
+        xaccAccountTreeForEachTransaction (template_root, snap_add_transaction,
+                                           &w);
+    if (w.ok)
+        gnc_pricedb_foreach_price (gnc_pricedb_get_db (book), snap_add_price,
+                                   &w, FALSE);
+    if (w.ok)
+        snap_add_schedxactions (&w, book);
+
+    if (w.ok)
+        ok = snap_write_file (&w, filename, &source);
+
+    g_hash_table_destroy (w.lot_index);
+    g_hash_table_destroy (w.account_index);
+    g_hash_table_destroy (w.commodity_index);
+    for (i = 0; i < SNAP_N_SECTIONS; i++)
+        if (w.sections[i])
+            g_array_free (w.sections[i], TRUE);
+    g_hash_table_destroy (w.string_index);
+    g_byte_array_free (w.strings, TRUE);
+    g_free (filename);
+
+    LEAVE ("ok=%d", ok);
+    return ok;
+}
+
+/* ================================================================= */
+/* Reading */
+
+typedef struct
+{
+    GMappedFile *file;
+    const char *strings;
+    guint64 n_strings;
+    const SnapGuid *guids;
+    guint64 n_guids;
+    const SnapKvp *kvp;
+    guint64 n_kvp;
+    const SnapBook *book;
+    guint64 n_book;
+    const SnapCommodity *commodities;
+    guint64 n_commodities;
+    const SnapAccount *accounts;
+    guint64 n_accounts;
+    const SnapLot *lots;
+    guint64 n_lots;
+    const SnapTransaction *transactions;
+    guint64 n_transactions;
+    const SnapSplit *splits;
+    guint64 n_splits;
+    const SnapPrice *prices;
+    guint64 n_prices;
+    const SnapSchedXaction *schedxactions;
+    guint64 n_schedxactions;
+    const SnapRecurrence *recurrences;
+    guint64 n_recurrences;
+    const SnapSxDeferred *deferred;
+    guint64 n_deferred;
+} SnapReader;
+
+static const void *
+snap_section (const SnapHeader *header, gsize length, SnapSectionId id,
+              guint64 *count)
+{
+    const SnapSection *section = &header->sections[id];
+
+    *count = 0;
+    if (section->record_size != snap_record_size[id]) return NULL;
+    if (section->offset % 8 != 0 || section->offset > length) return NULL;
+    if (section->count > (length - section->offset) / section->record_size)
+        return NULL;
+
+    *count = section->count;
+    return (const char *) header + section->offset;
+}
+
+static bool
+snap_map (SnapReader *r, const char *filename, const char *datafile)
+{
+    const SnapHeader *header;
+    gsize length;
+
+    memset (r, 0, sizeof (*r));
+    r->file = g_mapped_file_new (filename, FALSE, NULL);
+    if (!r->file) return FALSE;
+
+    length = g_mapped_file_get_length (r->file);
+    header = (const SnapHeader *) g_mapped_file_get_contents (r->file);
+    if (length < sizeof (*header) ||
+            memcmp (header->magic, SNAP_MAGIC, sizeof (SNAP_MAGIC)) != 0 ||
+            header->version != SNAP_VERSION ||
+            header->byte_order != SNAP_BYTE_ORDER)
+    {
+        PWARN ("%s is not a usable snapshot", filename);
+        return FALSE;
+    }
+    if (!snap_source_matches (&header->source, datafile))
+    {
+        PINFO ("%s is older than %s", filename, datafile);
+        return FALSE;
+    }
+
+#define SNAP_SECTION(field, type, id) \
+    r->field = (const type *) snap_section (header, length, id, &r->n_##field); \
+    if (!r->field) return FALSE;
+
+    SNAP_SECTION (strings, char, SNAP_STRINGS);
+    SNAP_SECTION (guids, SnapGuid, SNAP_GUIDS);
+    SNAP_SECTION (kvp, SnapKvp, SNAP_KVP);
+    SNAP_SECTION (book, SnapBook, SNAP_BOOK);
+    SNAP_SECTION (commodities, SnapCommodity, SNAP_COMMODITIES);
+    SNAP_SECTION (accounts, SnapAccount, SNAP_ACCOUNTS);
+    SNAP_SECTION (lots, SnapLot, SNAP_LOTS);
+    SNAP_SECTION (transactions, SnapTransaction, SNAP_TRANSACTIONS);
+    SNAP_SECTION (splits, SnapSplit, SNAP_SPLITS);
+    SNAP_SECTION (prices, SnapPrice, SNAP_PRICES);
+    SNAP_SECTION (schedxactions, SnapSchedXaction, SNAP_SCHEDXACTIONS);
+    SNAP_SECTION (recurrences, SnapRecurrence, SNAP_RECURRENCES);
+    SNAP_SECTION (deferred, SnapSxDeferred, SNAP_SX_DEFERRED);
+#undef SNAP_SECTION
+
+    return TRUE;
+}
+
+static void
+snap_unmap (SnapReader *r)
+{
+    if (r->file)
+        g_mapped_file_unref (r->file);
+    r->file = NULL;
+}
+
+static inline const char *
+snap_string (const SnapReader *r, guint32 offset)
+{
+    return offset == SNAP_NONE ? NULL : r->strings + offset;
+}
+
+static inline const GncGUID *
+snap_guid (const SnapReader *r, guint32 index)
+{
+    return &r->guids[index].guid;
+}
+
+/* Validation.  Everything the loader dereferences is range checked
+ * here first, so a damaged snapshot is rejected before any object is
+ * created. */
+
+static inline bool
+snap_string_ok (const SnapReader *r, guint32 offset)
+{
+    return offset == SNAP_NONE || offset < r->n_strings;
+}
+
+static inline bool
+snap_ref_ok (guint32 ref, guint64 count, bool optional)
+{
+    return ref < count || (optional && ref == SNAP_NONE);
+}
+
+static inline bool
+snap_guid_ok (const SnapReader *r, guint32 index, SnapSectionId kind,
+              guint64 record)
+{
+    return index < r->n_guids && r->guids[index].kind == (guint32) kind &&
+           r->guids[index].record == record;
+}
+
+/* Children must come after their parent entry, which is what keeps
+ * the recursion in snap_kvp_value finite. */
+static inline bool
+snap_kvp_range_ok (const SnapReader *r, guint32 first, guint32 count,
+                   guint64 after)
+{
+    if (count == 0) return TRUE;
+    return first != SNAP_NONE && first >= after &&
+           (guint64) first + count <= r->n_kvp;
+}
+
+static bool
+snap_validate (const SnapReader *r)
+{
+    guint32 template_root;
+    guint64 i;
+
+    if (r->n_strings == 0 || r->strings[r->n_strings - 1] != '\0')
+        return FALSE;
+    if (r->n_book != 1 || r->n_accounts == 0)
+        return FALSE;
+
+    for (i = 0; i < r->n_kvp; i++)
+    {
+        const SnapKvp *e = &r->kvp[i];
+
+        if (!snap_string_ok (r, e->key))
+            return FALSE;
+        switch (e->type)
+        {
+        case KVP_TYPE_STRING:
+            if (!snap_string_ok (r, e->first)) return FALSE;
+            break;
+        case KVP_TYPE_BINARY:
+            if (e->count && (guint64) e->first + e->count > r->n_strings)
+                return FALSE;
+            break;
+        case KVP_TYPE_GLIST:
+        case KVP_TYPE_FRAME:
+            if (!snap_kvp_range_ok (r, e->first, e->count, i + 1))
+                return FALSE;
+            break;
+        case KVP_TYPE_GINT64:
+        case KVP_TYPE_DOUBLE:
+        case KVP_TYPE_NUMERIC:
+        case KVP_TYPE_GUID:
+        case KVP_TYPE_TIMESPEC:
+        case KVP_TYPE_GDATE:
+            break;
+        default:
+            return FALSE;
+        }
+        if (e->type == KVP_TYPE_FRAME && e->count)
+        {
+            guint32 j;
+            for (j = 0; j < e->count; j++)
+            {
+                guint32 key = r->kvp[e->first + j].key;
+                if (key == SNAP_NONE || r->strings[key] == '\0')
+                    return FALSE;
+            }
+        }
+    }
+
+#define KVP_OK(rec) snap_kvp_range_ok (r, (rec)->kvp_first, (rec)->kvp_count, 0)
+
+    if (!snap_guid_ok (r, r->book->guid, SNAP_BOOK, 0) || !KVP_OK (r->book))
+        return FALSE;
+
+    for (i = 0; i < r->n_commodities; i++)
+    {
+        const SnapCommodity *c = &r->commodities[i];
+        if (c->name_space == SNAP_NONE || c->mnemonic == SNAP_NONE ||
+                !snap_string_ok (r, c->name_space) ||
+                !snap_string_ok (r, c->mnemonic) ||
+                !snap_string_ok (r, c->fullname) ||
+                !snap_string_ok (r, c->cusip) ||
+                !snap_string_ok (r, c->quote_source) ||
+                !snap_string_ok (r, c->quote_tz) || !KVP_OK (c))
+            return FALSE;
+    }
+
+    /* The template tree, if there is one, comes after the account tree */
+    template_root = r->book->template_root;
+    if (template_root != SNAP_NONE &&
+            (template_root == 0 || template_root >= r->n_accounts ||
+             r->accounts[template_root].type != ACCT_TYPE_ROOT))
+        return FALSE;
+
+    for (i = 0; i < r->n_accounts; i++)
+    {
+        const SnapAccount *a = &r->accounts[i];
+        bool is_root = (i == 0 || i == template_root);
+        guint64 tree_start = (template_root != SNAP_NONE && i > template_root)
+                             ? template_root : 0;
+
+        /* Parents come first, within the same tree; only the roots
+         * have none */
+        if (is_root != (a->parent == SNAP_NONE) ||
+                (!is_root && (a->parent >= i || a->parent < tree_start)) ||
+                !snap_guid_ok (r, a->guid, SNAP_ACCOUNTS, i) ||
+                !snap_string_ok (r, a->name) ||
+                !snap_string_ok (r, a->code) ||
+                !snap_string_ok (r, a->description) ||
+                !snap_ref_ok (a->commodity, r->n_commodities, TRUE) ||
+                !KVP_OK (a))
+            return FALSE;
+    }
+    if (r->accounts[0].type != ACCT_TYPE_ROOT)
+        return FALSE;
+
+    for (i = 0; i < r->n_lots; i++)
+    {
+        const SnapLot *l = &r->lots[i];
+        if (!snap_guid_ok (r, l->guid, SNAP_LOTS, i) ||
+                !snap_ref_ok (l->account, r->n_accounts, FALSE) || !KVP_OK (l))
+            return FALSE;
+    }
+
+    for (i = 0; i < r->n_transactions; i++)
+    {
+        const SnapTransaction *t = &r->transactions[i];
+        if (!snap_guid_ok (r, t->guid, SNAP_TRANSACTIONS, i) ||
+                !snap_ref_ok (t->currency, r->n_commodities, FALSE) ||
+                !snap_string_ok (r, t->num) ||
+                !snap_string_ok (r, t->description) ||
+                (guint64) t->first_split + t->n_splits > r->n_splits ||
+                !KVP_OK (t))
+            return FALSE;
+    }
+
+    for (i = 0; i < r->n_splits; i++)
+    {
+        const SnapSplit *s = &r->splits[i];
+        if (!snap_guid_ok (r, s->guid, SNAP_SPLITS, i) ||
+                !snap_ref_ok (s->account, r->n_accounts, FALSE) ||
+                !snap_ref_ok (s->lot, r->n_lots, TRUE) ||
+                !snap_string_ok (r, s->memo) ||
+                !snap_string_ok (r, s->action) || !KVP_OK (s))
+            return FALSE;
+    }
+
+    for (i = 0; i < r->n_prices; i++)
+    {
+        const SnapPrice *p = &r->prices[i];
+        if (!snap_guid_ok (r, p->guid, SNAP_PRICES, i) ||
+                !snap_ref_ok (p->commodity, r->n_commodities, FALSE) ||
+                !snap_ref_ok (p->currency, r->n_commodities, FALSE) ||
+                !snap_string_ok (r, p->source) ||
+                !snap_string_ok (r, p->type))
+            return FALSE;
+    }
+
+    for (i = 0; i < r->n_recurrences; i++)
+    {
+        const SnapRecurrence *rec = &r->recurrences[i];
+        if (rec->period_type >= NUM_PERIOD_TYPES ||
+                rec->weekend_adjust >= NUM_WEEKEND_ADJS ||
+                rec->mult > G_MAXUINT16)
+            return FALSE;
+    }
+
+    for (i = 0; i < r->n_schedxactions; i++)
+    {
+        const SnapSchedXaction *sx = &r->schedxactions[i];
+        if (!snap_guid_ok (r, sx->guid, SNAP_SCHEDXACTIONS, i) ||
+                !snap_string_ok (r, sx->name) ||
+                template_root == SNAP_NONE ||
+                sx->template_acct <= template_root ||
+                sx->template_acct >= r->n_accounts ||
+                (guint64) sx->first_recurrence + sx->n_recurrences >
+                r->n_recurrences ||
+                (guint64) sx->first_deferred + sx->n_deferred > r->n_deferred ||
+                !KVP_OK (sx))
+            return FALSE;
+    }
+#undef KVP_OK
+
+    return TRUE;
+}
+
+static void snap_fill_frame (const SnapReader *r, KvpFrame *frame,
+                             guint32 first, guint32 count);
+
+static KvpValue *
+snap_kvp_value (const SnapReader *r, const SnapKvp *e)
+{
+    switch (e->type)
+    {
+    case KVP_TYPE_GINT64:
+        return kvp_value_new_gint64 (e->v[0]);
+    case KVP_TYPE_DOUBLE:
+    {
+        double d;
+        memcpy (&d, e->v, sizeof (d));
+        return kvp_value_new_double (d);
+    }
+    case KVP_TYPE_NUMERIC:
+        return kvp_value_new_numeric (gnc_numeric_create (e->v[0], e->v[1]));
+    case KVP_TYPE_STRING:
+        return kvp_value_new_string (snap_string (r, e->first));
+    case KVP_TYPE_GUID:
+    {
+        GncGUID guid;
+        memcpy (&guid, e->v, sizeof (guid));
+        return kvp_value_new_guid (&guid);
+    }
+    case KVP_TYPE_TIMESPEC:
+    {
+        Timespec ts;
+        ts.tv_sec = e->v[0];
+        ts.tv_nsec = e->v[1];
+        return kvp_value_new_timespec (ts);
+    }
+    case KVP_TYPE_BINARY:
+        return kvp_value_new_binary (e->count ? r->strings + e->first : NULL,
+                                     e->count);
+    case KVP_TYPE_GLIST:
+    {
+        GList *list = NULL;
+        guint32 i;
+
+        for (i = 0; i < e->count; i++)
+            list = g_list_prepend (list, snap_kvp_value (r, &r->kvp[e->first + i]));
+        return kvp_value_new_glist_nc (g_list_reverse (list));
+    }
+    case KVP_TYPE_FRAME:
+    {
+        KvpFrame *frame = kvp_frame_new ();
+        snap_fill_frame (r, frame, e->first, e->count);
+        return kvp_value_new_frame_nc (frame);
+    }
+    case KVP_TYPE_GDATE:
+    {
+        GDate date;
+        g_date_clear (&date, 1);
+        if (e->v[0] > 0 && e->v[0] <= G_MAXUINT32)
+            g_date_set_julian (&date, (guint32) e->v[0]);
+        return kvp_value_new_gdate (date);
+    }
+    default:
+        return NULL;
+    }
+}
+
+static void
+snap_fill_frame (const SnapReader *r, KvpFrame *frame, guint32 first,
+                 guint32 count)
+{
+    guint32 i;
+
+    for (i = 0; i < count; i++)
+    {
+        const SnapKvp *e = &r->kvp[first + i];
+        kvp_frame_set_slot_nc (frame, snap_string (r, e->key),
+                               snap_kvp_value (r, e));
+    }
+}
+
+#define SNAP_FILL_SLOTS(r, inst, rec) \
+    snap_fill_frame ((r), qof_instance_get_slots (QOF_INSTANCE (inst)), \
+                     (rec)->kvp_first, (rec)->kvp_count)
+
+static gnc_commodity **
+snap_load_commodities (const SnapReader *r, QofBook *book)
+{
+    gnc_commodity_table *table = gnc_commodity_table_get_table (book);
+    gnc_commodity **coms = g_new0 (gnc_commodity *, r->n_commodities + 1);
+    guint64 i;
+
+    for (i = 0; i < r->n_commodities; i++)
+    {
+        const SnapCommodity *c = &r->commodities[i];
+        gnc_commodity *com;
+        const char *source_name = snap_string (r, c->quote_source);
+
+        com = gnc_commodity_new (book, snap_string (r, c->fullname),
+                                 snap_string (r, c->name_space),
+                                 snap_string (r, c->mnemonic),
+                                 snap_string (r, c->cusip), c->fraction);
+        gnc_commodity_set_quote_flag (com, c->quote_flag);
+        if (source_name)
+        {
+            gnc_quote_source *source =
+                gnc_quote_source_lookup_by_internal (source_name);
+            if (!source)
+                source = gnc_quote_source_add_new (source_name, FALSE);
+            gnc_commodity_set_quote_source (com, source);
+        }
+        gnc_commodity_set_quote_tz (com, snap_string (r, c->quote_tz));
+        SNAP_FILL_SLOTS (r, com, c);
+
+        /* Returns the table's own copy when there already is one */
+        coms[i] = gnc_commodity_table_insert (table, com);
+    }
+    return coms;
+}
+
+static Account **
+snap_load_accounts (const SnapReader *r, QofBook *book, gnc_commodity **coms)
+{
+    Account **accounts = g_new0 (Account *, r->n_accounts);
+    guint64 i;
+
+    for (i = 0; i < r->n_accounts; i++)
+    {
+        const SnapAccount *a = &r->accounts[i];
+        Account *acc = xaccMallocAccount (book);
+
+        /* Left open until the transactions are in, as the xml load does */
+        xaccAccountBeginEdit (acc);
+        xaccAccountSetGUID (acc, snap_guid (r, a->guid));
+        xaccAccountSetName (acc, snap_string (r, a->name));
+        xaccAccountSetType (acc, (GNCAccountType) a->type);
+        if (a->commodity != SNAP_NONE)
+        {
+            xaccAccountSetCommodity (acc, coms[a->commodity]);
+            xaccAccountSetCommoditySCU (acc, a->commodity_scu);
+            if (a->non_std_scu)
+                xaccAccountSetNonStdSCU (acc, TRUE);
+        }
+        xaccAccountSetCode (acc, snap_string (r, a->code));
+        xaccAccountSetDescription (acc, snap_string (r, a->description));
+        SNAP_FILL_SLOTS (r, acc, a);
+
+        if (i == 0)
+            gnc_book_set_root_account (book, acc);
+        else if (i == r->book->template_root)
+            gnc_book_set_template_root (book, acc);
+        else
+            gnc_account_append_child (accounts[a->parent], acc);
+        accounts[i] = acc;
+    }
+    return accounts;
+}
+
+static GNCLot **
+snap_load_lots (const SnapReader *r, QofBook *book, Account **accounts)
+{
+    GNCLot **lots = g_new0 (GNCLot *, r->n_lots + 1);
+    guint64 i;
+
+    for (i = 0; i < r->n_lots; i++)
+    {
+        const SnapLot *l = &r->lots[i];
+        GNCLot *lot = gnc_lot_new (book);
+
+        gnc_lot_set_guid (lot, *snap_guid (r, l->guid));
+        SNAP_FILL_SLOTS (r, lot, l);
+        xaccAccountInsertLot (accounts[l->account], lot);
+        lots[i] = lot;
+    }
+    return lots;
+}
+
+static void
+snap_load_transactions (const SnapReader *r, QofBook *book,
+                        gnc_commodity **coms, Account **accounts,
+                        GNCLot **lots, QofBePercentageFunc percentage)
+{
+    guint64 i;
+    guint32 j;
+
+    for (i = 0; i < r->n_transactions; i++)
+    {
+        const SnapTransaction *t = &r->transactions[i];
+        Transaction *trans = xaccMallocTransaction (book);
+        Timespec ts;
+
+        xaccTransBeginEdit (trans);
+        xaccTransSetGUID (trans, snap_guid (r, t->guid));
+        xaccTransSetCurrency (trans, coms[t->currency]);
+        xaccTransSetNum (trans, snap_string (r, t->num));
+        ts.tv_sec = t->posted_sec;
+        ts.tv_nsec = t->posted_nsec;
+        xaccTransSetDatePostedTS (trans, &ts);
+        ts.tv_sec = t->entered_sec;
+        ts.tv_nsec = t->entered_nsec;
+        xaccTransSetDateEnteredTS (trans, &ts);
+        xaccTransSetDescription (trans, snap_string (r, t->description));
+        SNAP_FILL_SLOTS (r, trans, t);
+
+        for (j = 0; j < t->n_splits; j++)
+        {
+            const SnapSplit *s = &r->splits[t->first_split + j];
+            Split *split = xaccMallocSplit (book);
+
+            xaccSplitSetGUID (split, snap_guid (r, s->guid));
+            /* With the transaction and account in place the value and
+             * amount already have the denominators they are rounded
+             * to, which spares converting them there and back. */
+            xaccTransAppendSplit (trans, split);
+            xaccAccountInsertSplit (accounts[s->account], split);
+            xaccSplitSetMemo (split, snap_string (r, s->memo));
+            xaccSplitSetAction (split, snap_string (r, s->action));
+            xaccSplitSetReconcile (split, (char) s->reconcile);
+            ts.tv_sec = s->reconciled_sec;
+            ts.tv_nsec = s->reconciled_nsec;
+            xaccSplitSetDateReconciledTS (split, &ts);
+            xaccSplitSetValue (split, gnc_numeric_create (s->value_num,
+                               s->value_denom));
+            xaccSplitSetAmount (split, gnc_numeric_create (s->amount_num,
+                                s->amount_denom));
+            if (s->lot != SNAP_NONE)
+                gnc_lot_add_split (lots[s->lot], split);
+            SNAP_FILL_SLOTS (r, split, s);
+        }
+        xaccTransCommitEdit (trans);
+
+        if (i % 10000 == 0)
+        {
+            if (percentage)
+                percentage (NULL, (100.0 * i) / r->n_transactions);
+            qof_backend_load_yield (qof_book_get_backend (book));
+        }
+    }
+}
+
+static void
+snap_load_prices (const SnapReader *r, QofBook *book, gnc_commodity **coms)
+{
+    GNCPriceDB *db = gnc_pricedb_get_db (book);
+    guint64 i;
+
+    gnc_pricedb_set_bulk_update (db, TRUE);
+    for (i = 0; i < r->n_prices; i++)
+    {
+        const SnapPrice *sp = &r->prices[i];
+        GNCPrice *p = gnc_price_create (book);
+        Timespec ts;
+
+        ts.tv_sec = sp->time_sec;
+        ts.tv_nsec = sp->time_nsec;
+        gnc_price_begin_edit (p);
+        gnc_price_set_guid (p, snap_guid (r, sp->guid));
+        gnc_price_set_commodity (p, coms[sp->commodity]);
+        gnc_price_set_currency (p, coms[sp->currency]);
+        gnc_price_set_time (p, ts);
+        gnc_price_set_source (p, snap_string (r, sp->source));
+        gnc_price_set_typestr (p, snap_string (r, sp->type));
+        gnc_price_set_value (p, gnc_numeric_create (sp->value_num,
+                             sp->value_denom));
+        gnc_price_commit_edit (p);
+        gnc_pricedb_add_price (db, p);
+        gnc_price_unref (p);
+    }
+    gnc_pricedb_set_bulk_update (db, FALSE);
+}
+
+static void
+snap_gdate (guint32 julian, GDate *date)
+{
+    g_date_clear (date, 1);
+    if (julian > 0)
+        g_date_set_julian (date, julian);
+}
+
+static void
+snap_load_schedxactions (const SnapReader *r, QofBook *book, Account **accounts)
+{
+    SchedXactions *sxes = gnc_book_get_schedxactions (book);
+    guint64 i;
+    guint32 j;
+
+    for (i = 0; i < r->n_schedxactions; i++)
+    {
+        const SnapSchedXaction *rec = &r->schedxactions[i];
+        SchedXaction *sx = xaccSchedXactionMalloc (book);
+        RecurrenceList_t schedule;
+        GDate date;
+
+        /* Set up as the xml parser does, replacing the template account
+         * xaccSchedXactionMalloc made with the one from the file */
+        xaccSchedXactionSetGUID (sx, snap_guid (r, rec->guid));
+        xaccSchedXactionSetName (sx, snap_string (r, rec->name));
+        xaccSchedXactionSetEnabled (sx, rec->enabled);
+        xaccSchedXactionSetAutoCreate (sx, rec->auto_create, rec->auto_notify);
+        xaccSchedXactionSetAdvanceCreation (sx, rec->advance_create);
+        xaccSchedXactionSetAdvanceReminder (sx, rec->advance_remind);
+        gnc_sx_set_instance_count (sx, rec->instance_num);
+        snap_gdate (rec->start_date, &date);
+        if (g_date_valid (&date))
+            xaccSchedXactionSetStartDate (sx, &date);
+        snap_gdate (rec->last_date, &date);
+        if (g_date_valid (&date))
+            xaccSchedXactionSetLastOccurDate (sx, &date);
+        xaccSchedXactionSetNumOccur (sx, rec->num_occur_total);
+        xaccSchedXactionSetRemOccur (sx, rec->num_occur_remain);
+        snap_gdate (rec->end_date, &date);
+        if (g_date_valid (&date))
+            xaccSchedXactionSetEndDate (sx, &date);
+        sx_set_template_account (sx, accounts[rec->template_acct]);
+
+        for (j = 0; j < rec->n_recurrences; j++)
+        {
+            const SnapRecurrence *sr = &r->recurrences[rec->first_recurrence + j];
+            Recurrence *recurrence = new Recurrence;
+
+            snap_gdate (sr->start, &date);
+            recurrenceSet (recurrence, sr->mult, (PeriodType) sr->period_type,
+                           &date, (WeekendAdjust) sr->weekend_adjust);
+            schedule.push_back (recurrence);
+        }
+        gnc_sx_set_schedule (sx, schedule);
+
+        /* Written in the sorted order the list keeps */
+        for (j = 0; j < rec->n_deferred; j++)
+        {
+            const SnapSxDeferred *sd = &r->deferred[rec->first_deferred + j];
+            SXTmpStateData *tsd = g_new0 (SXTmpStateData, 1);
+
+            snap_gdate (sd->last_date, &tsd->last_date);
+            tsd->num_occur_rem = sd->num_occur_rem;
+            tsd->num_inst = sd->num_inst;
+            sx->deferredList.push_back (tsd);
+        }
+        SNAP_FILL_SLOTS (r, sx, rec);
+
+        gnc_sxes_add_sx (sxes, sx);
+    }
+}
+
+bool
+gnc_xml_snapshot_load (QofBook *book, const char *datafile,
+                       QofBePercentageFunc percentage)
+{
+    SnapReader r;
+    gnc_commodity **coms;
+    Account **accounts;
+    GNCLot **lots;
+    gchar *filename;
+    guint64 i;
+
+    g_return_val_if_fail (book && datafile, FALSE);
+
+    ENTER ("book=%p file=%s", book, datafile);
+    filename = gnc_xml_snapshot_filename (datafile);
+    if (!snap_map (&r, filename, datafile) || !snap_validate (&r))
+    {
+        snap_unmap (&r);
+        g_free (filename);
+        LEAVE ("no usable snapshot");
+        return FALSE;
+    }
+    g_free (filename);
+
+    /* stop logging while we load */
+    xaccLogDisable ();
+    xaccDisableDataScrubbing ();
+
+    qof_instance_set_guid (QOF_INSTANCE (book), snap_guid (&r, r.book->guid));
+    snap_fill_frame (&r, qof_book_get_slots (book),
+                     r.book->kvp_first, r.book->kvp_count);
+
+    coms = snap_load_commodities (&r, book);
+    accounts = snap_load_accounts (&r, book, coms);
+    qof_backend_report_load_stage (qof_book_get_backend (book), book,
+                                   QOF_LOAD_STAGE_ACCOUNTS);
+    lots = snap_load_lots (&r, book, accounts);
+    snap_load_transactions (&r, book, coms, accounts, lots, percentage);
+    snap_load_prices (&r, book, coms);
+    snap_load_schedxactions (&r, book, accounts);
+
+    xaccEnableDataScrubbing ();
+
+    /* The snapshot was written from a book which had already been
+     * through the xml load scrubs, so they are not repeated here. */
+    for (i = r.n_accounts; i > 0; i--)
+        xaccAccountCommitEdit (accounts[i - 1]);
+
+    xaccLogEnable ();
+    if (percentage)
+        percentage (NULL, -1.0);
+
+    g_free (lots);
+    g_free (accounts);
+    g_free (coms);
+    snap_unmap (&r);
+
+    qof_book_mark_session_saved (book);
+    LEAVE ("loaded %" G_GUINT64_FORMAT " transactions", r.n_transactions);
+    return TRUE;
+}
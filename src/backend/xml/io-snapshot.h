@@ -0,0 +1,77 @@
+/********************************************************************\
+ * io-snapshot.h -- binary snapshot cache for xml data files        *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+/**
+ * @file io-snapshot.h
+ * @brief binary snapshot cache kept next to an xml data file
+ *
+ * After a successful save the xml backend writes a snapshot of the
+ * book to a sidecar file (the data file name with ".snap" appended).
+ * The snapshot holds the commodities, accounts, lots, transactions,
+ * splits, prices, scheduled transactions with their template accounts
+ * and transactions, and their kvp slots in fixed-layout sections which
+ * refer to each other by record number, along with a string table
+ * and a GUID index.  When the data file is opened again and its size,
+ * times, inode and SHA-1 checksum still match those recorded in the
+ * snapshot, the book is built straight from the mapped file instead
+ * of parsing the xml.
+ *
+ * Books holding objects the snapshot does not describe (budgets and
+ * the business objects) get no snapshot and are always read from the
+ * xml.
+ */
+
+#ifndef IO_SNAPSHOT_H
+#define IO_SNAPSHOT_H
+
+#include <glib.h>
+
+#include "qof.h"
+
+/** Return the name of the snapshot file for datafile.  The caller
+ *  must g_free the result. */
+gchar *gnc_xml_snapshot_filename (const char *datafile);
+
+/** Return the SHA-1 checksum of the contents of filename as a hex
+ *  string, the checksum a snapshot records for its data file, or NULL
+ *  if the file can't be read.  The caller must g_free the result. */
+gchar *gnc_xml_file_checksum (const char *filename);
+
+/** Whether book holds only objects a snapshot can describe. */
+bool gnc_xml_snapshot_supported (QofBook *book);
+
+/** Write a snapshot of book for the just-saved datafile.  Any older
+ *  snapshot is removed first, so a FALSE return (the book cannot be
+ *  described by a snapshot, or the write failed) never leaves a stale
+ *  one behind. */
+bool gnc_xml_snapshot_write (QofBook *book, const char *datafile);
+
+/** Build book from the snapshot of datafile.  Returns FALSE, having
+ *  created nothing in the book, when there is no snapshot, when it
+ *  does not match the current datafile or when it fails validation;
+ *  the caller should then parse the xml.
+ *
+ *  @param percentage If not NULL, called with the load progress. */
+bool gnc_xml_snapshot_load (QofBook *book, const char *datafile,
+                            QofBePercentageFunc percentage);
+
+#endif /* IO_SNAPSHOT_H */
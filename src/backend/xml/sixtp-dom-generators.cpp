@@ -121,21 +121,16 @@ commodity_ref_to_dom_tree(const char *tag, const gnc_commodity *c)
     return ret;
 }
 
-/* gnc_g_date_time_new_from_timespec_local normalizes the timespec,
- * but we want to serialize it un-normalized, so we make a partial
- * copy.
+/* Only the seconds are written here; the nanoseconds, un-normalized,
+ * go in their own element.
  */
 gchar *
 timespec_sec_to_string(const Timespec *ts)
 {
-     gchar *time_string;
-     GDateTime *gdt;
-     Timespec sts = { ts->tv_sec, 0};
-     gdt = gnc_g_date_time_new_from_timespec_local (sts);
-     g_return_val_if_fail (gdt != NULL, NULL);
-     time_string = g_date_time_format (gdt, "%Y-%m-%d %H:%M:%S %z");
-     g_date_time_unref (gdt);
-     return time_string;
+     gchar time_string[MAX_DATE_LENGTH];
+     if (gnc_time64_to_iso8601_buff (ts->tv_sec, time_string) == NULL)
+          return NULL;
+     return g_strdup (time_string);
 }
 
 gchar *
@@ -364,9 +364,20 @@ string_to_timespec_secs(const gchar *str, Timespec *ts)
     const gchar *strpos;
     time64 parsed_secs;
     long int gmtoff;
+    Timespec parsed_ts;
+    gboolean has_zone = FALSE;
 
     if (!str || !ts) return FALSE;
 
+    /* Files written by us are all in the fixed form, which is parsed
+       without strptime or a GDateTime. */
+    strpos = gnc_iso8601_scan_fixed(str, &parsed_ts, &has_zone);
+    if (strpos && has_zone && parsed_ts.tv_nsec == 0 && isspace_str(strpos, -1))
+    {
+        ts->tv_sec = parsed_ts.tv_sec;
+        return(TRUE);
+    }
+
     memset(&parsed_time, 0, sizeof(struct tm));
 
     /* If you change this, make sure you also change the output code, if
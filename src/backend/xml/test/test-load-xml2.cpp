@@ -33,6 +33,7 @@
 #include <unistd.h>
 #include <dirent.h>
 #include <string.h>
+#include <utime.h>
 #include <glib.h>
 #include <glib-object.h>
 #include <glib/gstdio.h>
@@ -40,8 +41,12 @@
 #include <cashobjects.h>
 #include <TransLog.h>
 #include <gnc-engine.h>
+#include <gnc-pricedb.h>
+#include <SchedXaction.h>
+#include <SX-book.h>
 #include "../gnc-backend-xml.h"
 #include "../io-gncxml-v2.h"
+#include "../io-snapshot.h"
 
 #include <test-stuff.h>
 #include <unittest-support.h>
@@ -53,6 +58,25 @@
 static void
 remove_files_pattern(const char *begining, const char *ending)
 {
+    gchar *dirname = g_path_get_dirname(begining);
+    gchar *basename = g_path_get_basename(begining);
+    GDir *dir = g_dir_open(dirname, 0, NULL);
+    const gchar *entry;
+
+    while (dir && (entry = g_dir_read_name(dir)) != NULL)
+    {
+        if (g_str_has_prefix(entry, basename) &&
+                g_str_has_suffix(entry, ending))
+        {
+            gchar *to_remove = g_build_filename(dirname, entry, (gchar*)NULL);
+            g_unlink(to_remove);
+            g_free(to_remove);
+        }
+    }
+    if (dir)
+        g_dir_close(dir);
+    g_free(basename);
+    g_free(dirname);
 }
 
 static void
@@ -73,6 +97,473 @@ remove_locks(const char *filename)
     remove_files_pattern(filename, ".LCK");
 }
 
+static gboolean
+collect_price_cb(GNCPrice *price, gpointer data)
+{
+    GList **prices = (GList **)data;
+    *prices = g_list_prepend(*prices, price);
+    return TRUE;
+}
+
+/* gnc_pricedb_equal keys the second database by the first one's
+ * commodities, so it only works within a book.  Walk both databases
+ * in their stable order and compare the prices field by field. */
+static gboolean
+pricedbs_match(QofBook *book1, QofBook *book2)
+{
+    GList *prices1 = NULL, *prices2 = NULL, *n1, *n2;
+    gboolean match;
+
+    gnc_pricedb_foreach_price(gnc_pricedb_get_db(book1), collect_price_cb,
+                              &prices1, TRUE);
+    gnc_pricedb_foreach_price(gnc_pricedb_get_db(book2), collect_price_cb,
+                              &prices2, TRUE);
+    match = g_list_length(prices1) == g_list_length(prices2);
+
+    for (n1 = prices1, n2 = prices2; match && n1; n1 = n1->next, n2 = n2->next)
+    {
+        GNCPrice *p1 = (GNCPrice *)n1->data, *p2 = (GNCPrice *)n2->data;
+        Timespec ts1 = gnc_price_get_time(p1), ts2 = gnc_price_get_time(p2);
+
+        match = guid_equal(gnc_price_get_guid(p1), gnc_price_get_guid(p2)) &&
+                g_strcmp0(gnc_commodity_get_unique_name(gnc_price_get_commodity(p1)),
+                          gnc_commodity_get_unique_name(gnc_price_get_commodity(p2))) == 0 &&
+                g_strcmp0(gnc_commodity_get_unique_name(gnc_price_get_currency(p1)),
+                          gnc_commodity_get_unique_name(gnc_price_get_currency(p2))) == 0 &&
+                timespec_equal(&ts1, &ts2) &&
+                g_strcmp0(gnc_price_get_source(p1), gnc_price_get_source(p2)) == 0 &&
+                g_strcmp0(gnc_price_get_typestr(p1), gnc_price_get_typestr(p2)) == 0 &&
+                gnc_numeric_eq(gnc_price_get_value(p1), gnc_price_get_value(p2));
+    }
+
+    g_list_free(prices1);
+    g_list_free(prices2);
+    return match;
+}
+
+static gboolean
+gdates_match(const GDate *d1, const GDate *d2)
+{
+    if (!g_date_valid(d1) || !g_date_valid(d2))
+        return g_date_valid(d1) == g_date_valid(d2);
+    return g_date_compare(d1, d2) == 0;
+}
+
+/* The scheduled transactions of the two books, which must come in the
+ * same order, and their template accounts and transactions. */
+static gboolean
+schedxactions_match(QofBook *book1, QofBook *book2)
+{
+    std::list<SchedXaction*> sxes1 = gnc_book_get_schedxactions(book1)->sx_list;
+    std::list<SchedXaction*> sxes2 = gnc_book_get_schedxactions(book2)->sx_list;
+    std::list<SchedXaction*>::iterator n1, n2;
+    Account *templates1 = gnc_book_get_template_root(book1);
+    Account *templates2 = gnc_book_get_template_root(book2);
+    gboolean match;
+
+    /* Every book has a template root, which is only saved once it has
+     * accounts below it. */
+    match = sxes1.size() == sxes2.size();
+    if (match && (gnc_account_n_descendants(templates1) > 0 ||
+                  gnc_account_n_descendants(templates2) > 0))
+        match = xaccAccountEqual(templates1, templates2, TRUE);
+
+    for (n1 = sxes1.begin(), n2 = sxes2.begin();
+            match && n1 != sxes1.end(); n1++, n2++)
+    {
+        SchedXaction *sx1 = *n1, *sx2 = *n2;
+
+        match = guid_equal(xaccSchedXactionGetGUID(sx1),
+                           xaccSchedXactionGetGUID(sx2)) &&
+                g_strcmp0(xaccSchedXactionGetName(sx1),
+                          xaccSchedXactionGetName(sx2)) == 0 &&
+                xaccSchedXactionGetEnabled(sx1) == xaccSchedXactionGetEnabled(sx2) &&
+                gdates_match(xaccSchedXactionGetStartDate(sx1),
+                             xaccSchedXactionGetStartDate(sx2)) &&
+                gdates_match(xaccSchedXactionGetLastOccurDate(sx1),
+                             xaccSchedXactionGetLastOccurDate(sx2)) &&
+                gdates_match(xaccSchedXactionGetEndDate(sx1),
+                             xaccSchedXactionGetEndDate(sx2)) &&
+                xaccSchedXactionGetNumOccur(sx1) == xaccSchedXactionGetNumOccur(sx2) &&
+                xaccSchedXactionGetRemOccur(sx1) == xaccSchedXactionGetRemOccur(sx2) &&
+                gnc_sx_get_instance_count(sx1, NULL) ==
+                gnc_sx_get_instance_count(sx2, NULL) &&
+                xaccSchedXactionGetAdvanceCreation(sx1) ==
+                xaccSchedXactionGetAdvanceCreation(sx2) &&
+                xaccSchedXactionGetAdvanceReminder(sx1) ==
+                xaccSchedXactionGetAdvanceReminder(sx2) &&
+                recurrenceListCmp(gnc_sx_get_schedule(sx1),
+                                  gnc_sx_get_schedule(sx2)) == 0 &&
+                gnc_sx_get_defer_instances(sx1).size() ==
+                gnc_sx_get_defer_instances(sx2).size() &&
+                guid_equal(xaccAccountGetGUID(sx1->template_acct),
+                           xaccAccountGetGUID(sx2->template_acct)) &&
+                kvp_frame_compare(xaccSchedXactionGetSlots(sx1),
+                                  xaccSchedXactionGetSlots(sx2)) == 0;
+    }
+    return match;
+}
+
+/* Saving wrote a snapshot next to the file unless the book holds
+ * objects the snapshot can't describe.  Open the file again, which
+ * now builds the book from the snapshot, and check it matches. */
+static void
+test_load_snapshot(const char *filename, QofBook *saved_book)
+{
+    QofSession *session;
+    QofBook *book;
+    gchar *snapshot = g_strdup_printf("%s.snap", filename);
+
+    if (!gnc_xml_snapshot_supported(saved_book))
+    {
+        g_free(snapshot);
+        return;
+    }
+    if (!g_file_test(snapshot, G_FILE_TEST_EXISTS))
+    {
+        failure_args("snapshot written", __FILE__, __LINE__,
+                     "no snapshot for file [%s]", filename);
+        g_free(snapshot);
+        return;
+    }
+
+    session = qof_session_new();
+    remove_locks(filename);
+    qof_session_begin(session, filename, TRUE, FALSE, TRUE);
+    qof_session_load(session, NULL);
+    book = qof_session_get_book (session);
+
+    do_test_args(qof_session_get_error(session) == ERR_BACKEND_NO_ERR,
+                 "session load snapshot", __FILE__, __LINE__,
+                 "qof error=%d for file [%s]",
+                 qof_session_get_error(session), filename);
+    do_test_args(guid_equal(qof_book_get_guid(book),
+                            qof_book_get_guid(saved_book)),
+                 "snapshot book guid", __FILE__, __LINE__,
+                 "for file [%s]", filename);
+    do_test_args(xaccAccountEqual(gnc_book_get_root_account(book),
+                                  gnc_book_get_root_account(saved_book),
+                                  TRUE),
+                 "snapshot accounts and transactions", __FILE__, __LINE__,
+                 "for file [%s]", filename);
+    do_test_args(pricedbs_match(book, saved_book),
+                 "snapshot prices", __FILE__, __LINE__,
+                 "for file [%s]", filename);
+    do_test_args(schedxactions_match(book, saved_book),
+                 "snapshot scheduled transactions", __FILE__, __LINE__,
+                 "for file [%s]", filename);
+
+    qof_session_end(session);
+    qof_session_destroy(session);
+    g_unlink(snapshot);
+    g_free(snapshot);
+}
+
+/* A snapshot must not be used once the data file has been rewritten,
+ * even when the size is the same and the modification time has been
+ * put back, as happens when an edit lands within the same second. */
+static void
+test_stale_snapshot(const char *filename, QofBook *saved_book)
+{
+    gchar *copy = g_strdup_printf("%s.stale-test", filename);
+    gchar *snapshot = gnc_xml_snapshot_filename(copy);
+    gchar *contents = NULL;
+    gsize length = 0;
+    struct stat st;
+    struct utimbuf times;
+    QofBook *book;
+
+    if (!gnc_xml_snapshot_supported(saved_book) ||
+        !g_file_get_contents(filename, &contents, &length, NULL) ||
+        length == 0 ||
+        !g_file_set_contents(copy, contents, length, NULL))
+    {
+        g_free(contents);
+        g_free(snapshot);
+        g_free(copy);
+        return;
+    }
+
+    do_test_args(gnc_xml_snapshot_write(saved_book, copy),
+                 "stale test snapshot written", __FILE__, __LINE__,
+                 "for file [%s]", filename);
+
+    book = qof_book_new();
+    do_test_args(gnc_xml_snapshot_load(book, copy, NULL),
+                 "fresh snapshot used", __FILE__, __LINE__,
+                 "for file [%s]", filename);
+    qof_book_destroy(book);
+
+    g_stat(copy, &st);
+    contents[length - 1] ^= 1;
+    g_file_set_contents(copy, contents, length, NULL);
+    times.actime = st.st_atime;
+    times.modtime = st.st_mtime;
+    g_utime(copy, &times);
+
+    book = qof_book_new();
+    do_test_args(!gnc_xml_snapshot_load(book, copy, NULL),
+                 "stale snapshot ignored", __FILE__, __LINE__,
+                 "for file [%s]", filename);
+    qof_book_destroy(book);
+
+    g_unlink(snapshot);
+    g_unlink(copy);
+    g_free(contents);
+    g_free(snapshot);
+    g_free(copy);
+}
+
+static int
+first_transaction_cb(Transaction *trn, void *data)
+{
+    *(Transaction **)data = trn;
+    return 1;
+}
+
+/* Saving a changed transaction appends it to the journal and leaves
+ * the file alone; opening the file again replays the change.  Once
+ * the file has been changed behind the journal's back it must not
+ * open.  All on a copy of the test file, in the temporary directory. */
+static void
+test_load_journal(const char *filename)
+{
+    QofSession *session;
+    QofBook *book;
+    Transaction *trn = NULL;
+    GncGUID guid;
+    struct stat before, after;
+    struct utimbuf times;
+    gchar *copy = NULL, *journal, *contents = NULL;
+    gsize length = 0;
+    int fd;
+    const char *desc = "Replayed from the journal";
+
+    if (!g_file_get_contents(filename, &contents, &length, NULL))
+        return;
+    fd = g_file_open_tmp("test-load-xml2-journal-XXXXXX", &copy, NULL);
+    if (fd < 0)
+    {
+        failure("unable to create a scratch file");
+        g_free(contents);
+        return;
+    }
+    close(fd);
+    if (!g_file_set_contents(copy, contents, length, NULL))
+    {
+        failure_args("copy test file", __FILE__, __LINE__,
+                     "for file [%s]", filename);
+        g_unlink(copy);
+        g_free(copy);
+        g_free(contents);
+        return;
+    }
+    g_free(contents);
+    journal = g_strdup_printf("%s.journal", copy);
+
+    session = qof_session_new();
+    qof_session_begin(session, copy, TRUE, FALSE, TRUE);
+    qof_session_load(session, NULL);
+    book = qof_session_get_book (session);
+
+    xaccAccountTreeForEachTransaction(gnc_book_get_root_account(book),
+                                      first_transaction_cb, &trn);
+    if (!trn || qof_session_get_error(session) != ERR_BACKEND_NO_ERR)
+    {
+        qof_session_end(session);
+        qof_session_destroy(session);
+        remove_files_pattern(copy, "");
+        g_free(journal);
+        g_free(copy);
+        return;
+    }
+    guid = *qof_instance_get_guid(trn);
+
+    /* Committing an unbalanced transaction scrubs it into an Imbalance
+     * account, which only a full save can write.  Let that happen
+     * first so the change checked below is the transaction alone.
+     * Backups are named to the second, so clear the one the earlier
+     * save made or this save can't make its own. */
+    xaccTransBeginEdit(trn);
+    xaccTransSetDescription(trn, "");
+    xaccTransCommitEdit(trn);
+    qof_session_save(session, NULL);
+    remove_files_pattern(copy, ".gnucash");
+
+    xaccTransBeginEdit(trn);
+    xaccTransSetDescription(trn, desc);
+    xaccTransCommitEdit(trn);
+
+    g_stat(copy, &before);
+    qof_session_save(session, NULL);
+    g_stat(copy, &after);
+
+    do_test_args(g_file_test(journal, G_FILE_TEST_EXISTS),
+                 "journal written", __FILE__, __LINE__,
+                 "for file [%s]", filename);
+    do_test_args(before.st_size == after.st_size &&
+                 before.st_mtime == after.st_mtime,
+                 "data file untouched by journal save", __FILE__, __LINE__,
+                 "for file [%s]", filename);
+
+    qof_session_end(session);
+    qof_session_destroy(session);
+
+    session = qof_session_new();
+    qof_session_begin(session, copy, TRUE, FALSE, TRUE);
+    qof_session_load(session, NULL);
+    book = qof_session_get_book (session);
+    trn = xaccTransLookup(&guid, book);
+
+    do_test_args(trn && g_strcmp0(xaccTransGetDescription(trn), desc) == 0,
+                 "journal replayed", __FILE__, __LINE__,
+                 "for file [%s]", filename);
+
+    qof_session_end(session);
+    qof_session_destroy(session);
+
+    /* Change the file without changing its size or times: the final
+     * newline becomes a space, which the xml doesn't mind. */
+    g_stat(copy, &before);
+    if (g_file_get_contents(copy, &contents, &length, NULL) && length > 0 &&
+            contents[length - 1] == '\n')
+    {
+        TestErrorStruct check = { G_LOG_LEVEL_CRITICAL, "gnc.io", NULL };
+        guint hdlr;
+
+        contents[length - 1] = ' ';
+        g_file_set_contents(copy, contents, length, NULL);
+        times.actime = before.st_atime;
+        times.modtime = before.st_mtime;
+        g_utime(copy, &times);
+
+        hdlr = g_log_set_handler("gnc.io", G_LOG_LEVEL_CRITICAL,
+                                 (GLogFunc)test_checked_handler, &check);
+        session = qof_session_new();
+        qof_session_begin(session, copy, TRUE, FALSE, TRUE);
+        qof_session_load(session, NULL);
+        g_log_remove_handler("gnc.io", hdlr);
+
+        do_test_args(qof_session_get_error(session) == ERR_FILEIO_JOURNAL_MISMATCH,
+                     "file not opened with a mismatched journal",
+                     __FILE__, __LINE__, "qof error=%d for file [%s]",
+                     qof_session_get_error(session), filename);
+
+        qof_session_end(session);
+        qof_session_destroy(session);
+
+        do_test_args(g_file_test(journal, G_FILE_TEST_EXISTS),
+                     "mismatched journal kept", __FILE__, __LINE__,
+                     "for file [%s]", filename);
+    }
+    g_free(contents);
+
+    /* The copy, its journal, snapshot, lock, backups and logs */
+    remove_files_pattern(copy, "");
+    g_free(journal);
+    g_free(copy);
+}
+
+/* None of the test files has scheduled transactions, so build a book
+ * with one, and a template transaction for it, and check that the
+ * snapshot written when it is saved brings them back. */
+static void
+test_snapshot_schedxactions(void)
+{
+    QofSession *session;
+    QofBook *book, *loaded;
+    Account *acc;
+    Transaction *trans;
+    SchedXaction *sx;
+    gnc_commodity *usd;
+    RecurrenceList_t schedule;
+    Recurrence *recurrence;
+    GDate start, last;
+    gchar *filename = NULL;
+    int i, fd;
+
+    fd = g_file_open_tmp("test-load-xml2-sx-XXXXXX", &filename, NULL);
+    if (fd < 0)
+    {
+        failure("unable to create a scratch file");
+        return;
+    }
+    close(fd);
+    g_unlink(filename);
+
+    session = qof_session_new();
+    qof_session_begin(session, filename, TRUE, TRUE, TRUE);
+    book = qof_session_get_book(session);
+    usd = gnc_commodity_table_lookup(gnc_commodity_table_get_table(book),
+                                     GNC_COMMODITY_NS_CURRENCY, "USD");
+
+    acc = xaccMallocAccount(book);
+    xaccAccountBeginEdit(acc);
+    xaccAccountSetName(acc, "Checking");
+    xaccAccountSetType(acc, ACCT_TYPE_BANK);
+    xaccAccountSetCommodity(acc, usd);
+    xaccAccountCommitEdit(acc);
+    gnc_account_append_child(gnc_book_get_root_account(book), acc);
+
+    g_date_clear(&start, 1);
+    g_date_set_dmy(&start, 15, G_DATE_JANUARY, 2010);
+    last = start;
+    g_date_add_months(&last, 3);
+
+    sx = xaccSchedXactionMalloc(book);
+    xaccSchedXactionSetName(sx, "Rent");
+    xaccSchedXactionSetStartDate(sx, &start);
+    xaccSchedXactionSetLastOccurDate(sx, &last);
+    xaccSchedXactionSetNumOccur(sx, 24);
+    xaccSchedXactionSetRemOccur(sx, 20);
+    xaccSchedXactionSetAutoCreate(sx, TRUE, FALSE);
+    xaccSchedXactionSetAdvanceReminder(sx, 5);
+    gnc_sx_set_instance_count(sx, 4);
+    recurrence = new Recurrence;
+    recurrenceSet(recurrence, 1, PERIOD_MONTH, &start, WEEKEND_ADJ_BACK);
+    schedule.push_back(recurrence);
+    gnc_sx_set_schedule(sx, schedule);
+    gnc_sx_add_defer_instance(sx, gnc_sx_create_temporal_state(sx));
+    gnc_sxes_add_sx(gnc_book_get_schedxactions(book), sx);
+
+    trans = xaccMallocTransaction(book);
+    xaccTransBeginEdit(trans);
+    xaccTransSetCurrency(trans, usd);
+    xaccTransSetDescription(trans, "Rent");
+    for (i = 0; i < 2; i++)
+    {
+        Split *split = xaccMallocSplit(book);
+        KvpFrame *slots = xaccSplitGetSlots(split);
+
+        xaccSplitSetAccount(split, sx->template_acct);
+        xaccSplitSetParent(split, trans);
+        kvp_frame_set_guid(slots, "sched-xaction/account",
+                           xaccAccountGetGUID(acc));
+        kvp_frame_set_string(slots, i ? "sched-xaction/credit-formula"
+                             : "sched-xaction/debit-formula", "1200");
+    }
+    xaccTransCommitEdit(trans);
+
+    qof_session_save(session, NULL);
+    do_test_args(qof_session_get_error(session) == ERR_BACKEND_NO_ERR,
+                 "save scheduled transactions", __FILE__, __LINE__,
+                 "qof error=%d", qof_session_get_error(session));
+
+    loaded = qof_book_new();
+    do_test(gnc_xml_snapshot_supported(book) &&
+            gnc_xml_snapshot_load(loaded, filename, NULL),
+            "snapshot of scheduled transactions used");
+    do_test(schedxactions_match(book, loaded),
+            "snapshot scheduled transactions and templates");
+    qof_book_destroy(loaded);
+
+    qof_session_end(session);
+    qof_session_destroy(session);
+    /* The data file, its snapshot, lock, backups and logs */
+    remove_files_pattern(filename, "");
+    g_free(filename);
+}
+
 static void
 test_load_file(const char *filename)
 {
@@ -107,6 +598,10 @@ test_load_file(const char *filename)
     /* Uncomment the line below to generate corrected files */
     qof_session_save( session, NULL );
     qof_session_end(session);
+
+    test_load_snapshot(filename, book);
+    test_stale_snapshot(filename, book);
+    test_load_journal(filename);
 }
 
 int
@@ -152,6 +647,8 @@ main (int argc, char ** argv)
 
     g_dir_close(xml2_dir);
 
+    test_snapshot_schedxactions();
+
     print_test_results();
     qof_close();
     exit(get_rv());
@@ -46,6 +46,13 @@ static QofLogModule log_module = GNC_MOD_ACCOUNT;
 static char account_separator[8] = ".";
 static wchar_t account_uc_separator = ':';
 
+/* Moves on whenever full names other than that of a single childless
+ * account may have changed: an account with children was renamed or
+ * moved, or the separator changed.  Cached full names and name
+ * tables built under an older generation are rebuilt when next
+ * used. */
+static guint64 account_names_generation = 1;
+
 #define GET_PRIVATE(o)  \
    (o->priv)
 
@@ -57,6 +64,10 @@ static wchar_t account_uc_separator = ':';
 \********************************************************************/
 
 static void xaccAccountBringUpToDate (Account *acc);
+static void account_tree_index_free (AccountTreeIndex *index);
+static void account_tree_index_remove (Account *acc);
+static void account_tree_index_add (Account *acc);
+static void split_node_free (gpointer node);
 
 
 /********************************************************************\
@@ -89,12 +100,14 @@ gnc_set_account_separator (const char *separator)
     {
         account_uc_separator = ':';
         strcpy(account_separator, ":");
+        account_names_generation++;
         return;
     }
 
     account_uc_separator = uc;
     count = g_unichar_to_utf8(uc, account_separator);
     account_separator[count] = '\0';
+    account_names_generation++;
 }
 
 char *gnc_account_name_violations_errmsg (const char *separator, const std::list<std::string> & invalid_account_names)
@@ -209,6 +222,8 @@ Account::Account()
 Account::~Account()
 {
     // TODO
+    if (priv->splits_hash)
+        g_hash_table_destroy (priv->splits_hash);
     delete priv;
 }
 
@@ -464,6 +479,13 @@ xaccFreeAccount (Account *acc)
     CACHE_REPLACE(priv->accountName, NULL);
     CACHE_REPLACE(priv->accountCode, NULL);
     CACHE_REPLACE(priv->description, NULL);
+    CACHE_REPLACE(priv->full_name, NULL);
+
+    if (priv->tree_index)
+    {
+        account_tree_index_free (priv->tree_index);
+        priv->tree_index = NULL;
+    }
 
     /* zero out values, just in case stray
      * pointers are pointing here. */
@@ -473,6 +495,7 @@ xaccFreeAccount (Account *acc)
     priv->balance  = gnc_numeric_zero();
     priv->cleared_balance = gnc_numeric_zero();
     priv->reconciled_balance = gnc_numeric_zero();
+    priv->subtree_balances.clear();
 
     priv->type = ACCT_TYPE_NONE;
     gnc_commodity_decrement_usage_count(priv->commodity);
@@ -571,6 +594,8 @@ xaccAccountCommitEdit (Account *acc)
         else
         {
             priv->splits.clear();
+            if (priv->splits_hash)
+                g_hash_table_remove_all (priv->splits_hash);
         }
 
         /* It turns out there's a case where this assertion does not hold:
@@ -907,6 +932,32 @@ gnc_account_set_balance_dirty (Account *acc)
 /********************************************************************\
 \********************************************************************/
 
+/* Strict weak ordering for sorting an account's splits.  The book's
+ * use-split-action-for-num option is looked up once per sort rather than
+ * once per comparison, and the comparisons themselves run on the cached
+ * sort keys of the splits and their transactions. */
+struct SplitOrderLess
+{
+    bool action_for_num;
+
+    explicit SplitOrderLess (const Account *acc)
+        : action_for_num (qof_book_use_split_action_for_num_field
+                          (gnc_account_get_book (acc))) {}
+
+    bool operator() (const Split *sa, const Split *sb) const
+    {
+        return xaccSplitOrderNumSource (sa, sb, action_for_num) < 0;
+    }
+};
+
+/* Frees a splits_hash value, the node of a split in the account's
+ * list of splits. */
+static void
+split_node_free (gpointer node)
+{
+    delete (SplitList_t::iterator *) node;
+}
+
 bool
 gnc_account_insert_split (Account *acc, Split *s)
 {
@@ -918,19 +969,26 @@ gnc_account_insert_split (Account *acc, Split *s)
     if(!s) return false;
 
     priv = GET_PRIVATE(acc);
-    SplitList_t::iterator node = std::find(priv->splits.begin(), priv->splits.end(), s);
-    if (node != priv->splits.end())
+    /* Searching the list would make loading and closing a book
+     * quadratic in the number of splits per account */
+    if (!priv->splits_hash)
+        priv->splits_hash = g_hash_table_new_full (NULL, NULL, NULL,
+                            split_node_free);
+    if (g_hash_table_lookup (priv->splits_hash, s))
         return FALSE;
 
+    /* Sorting the list relinks its nodes, so the node stays valid */
+    priv->splits.push_front(s);
+    g_hash_table_insert (priv->splits_hash, s,
+                         new SplitList_t::iterator (priv->splits.begin()));
+
     if (qof_instance_get_editlevel(acc) == 0)
     {
-        priv->splits.push_front(s);
-        priv->splits.sort(xaccSplitOrderStrictWeak);
+        priv->splits.sort(SplitOrderLess(acc));
         // TODO: Should be something like insertSorted.
     }
     else
     {
-        priv->splits.push_front(s);
         priv->sort_dirty = true;
     }
 
@@ -949,6 +1007,7 @@ bool
 gnc_account_remove_split (Account *acc, Split *s)
 {
     AccountPrivate *priv;
+    SplitList_t::iterator *node;
 
 //    g_return_val_if_fail(GNC_IS_ACCOUNT(acc), FALSE);
 //    g_return_val_if_fail(GNC_IS_SPLIT(s), FALSE);
@@ -956,11 +1015,13 @@ gnc_account_remove_split (Account *acc, Split *s)
     if(!s) return false;
 
     priv = GET_PRIVATE(acc);
-    SplitList_t::iterator node = std::find(priv->splits.begin(), priv->splits.end(), s);
-    if (node == priv->splits.end())
+    node = priv->splits_hash ? (SplitList_t::iterator *)
+           g_hash_table_lookup (priv->splits_hash, s) : NULL;
+    if (!node)
         return false;
 
-    priv->splits.erase(node);
+    priv->splits.erase(*node);
+    g_hash_table_remove (priv->splits_hash, s);
     //FIXME: find better event type
     qof_event_gen(acc, QOF_EVENT_MODIFY, NULL);
     // And send the account-based event, too
@@ -982,7 +1043,7 @@ xaccAccountSortSplits (Account *acc, bool force)
     priv = GET_PRIVATE(acc);
     if (!priv->sort_dirty || (!force && qof_instance_get_editlevel(acc) > 0))
         return;
-    priv->splits.sort(xaccSplitOrderStrictWeak);
+    priv->splits.sort(SplitOrderLess(acc));
     priv->sort_dirty = false;
     priv->balance_dirty = true;
 }
@@ -1242,6 +1303,19 @@ xaccAccountMoveAllSplits (Account *accfrom, Account *accto)
 }
 
 
+/* Drops the cached subtree totals of an account and of all its
+ * ancestors, whose totals include it. */
+static void
+gnc_account_invalidate_subtree_balances (Account *acc)
+{
+    while (acc)
+    {
+        AccountPrivate *priv = GET_PRIVATE(acc);
+        priv->subtree_balances.clear();
+        acc = priv->parent;
+    }
+}
+
 /********************************************************************\
  * xaccAccountRecomputeBalance                                      *
  *   recomputes the partial balances and the current balance for    *
@@ -1318,6 +1392,11 @@ xaccAccountRecomputeBalance (Account * acc)
 
     }
 
+    if (!gnc_numeric_equal (priv->balance, balance) ||
+            !gnc_numeric_equal (priv->cleared_balance, cleared_balance) ||
+            !gnc_numeric_equal (priv->reconciled_balance, reconciled_balance))
+        gnc_account_invalidate_subtree_balances (acc);
+
     priv->balance = balance;
     priv->cleared_balance = cleared_balance;
     priv->reconciled_balance = reconciled_balance;
@@ -1464,7 +1543,13 @@ xaccAccountSetName (Account *acc, const char *str)
         return;
 
     xaccAccountBeginEdit(acc);
+    if (priv->parent && !priv->children.empty())
+        account_names_generation++;
+    else
+        account_tree_index_remove (acc);
     CACHE_REPLACE(priv->accountName, str);
+    priv->full_name_generation = 0;
+    account_tree_index_add (acc);
     mark_account (acc);
     xaccAccountCommitEdit(acc);
 }
@@ -1484,7 +1569,9 @@ xaccAccountSetCode (Account *acc, const char *str)
         return;
 
     xaccAccountBeginEdit(acc);
+    account_tree_index_remove (acc);
     CACHE_REPLACE(priv->accountCode, str ? str : "");
+    account_tree_index_add (acc);
     mark_account (acc);
     xaccAccountCommitEdit(acc);
 }
@@ -1639,6 +1726,7 @@ xaccAccountSetCommodity (Account * acc, gnc_commodity * com)
     gnc_commodity_decrement_usage_count(priv->commodity);
     priv->commodity = com;
     gnc_commodity_increment_usage_count(com);
+    gnc_account_invalidate_subtree_balances(acc);
     priv->commodity_scu = gnc_commodity_get_fraction(com);
     priv->non_standard_scu = FALSE;
 
@@ -1759,6 +1847,327 @@ DxaccAccountSetCurrency (Account * acc, gnc_commodity * currency)
     }
 }
 
+/********************************************************************\
+ * Account tree index                                               *
+\********************************************************************/
+
+/* The lookup tables map a name, code or full name to an
+ * AccountList_t* of every account in the tree carrying it; the
+ * topmost account itself is never entered, since lookups only ever
+ * return descendants.  The tables are built on the first lookup, kept
+ * up to date as childless accounts are renamed, added and removed,
+ * and thrown away whenever the name generation moves on.  The
+ * pre-order array holds every account below the topmost one and is
+ * rebuilt on demand after any change to the shape of the tree. */
+struct AccountTreeIndex
+{
+    guint64 names_generation;
+    GHashTable *by_name;
+    GHashTable *by_code;
+    GHashTable *by_full_name;
+    GPtrArray *preorder;
+};
+
+static void
+account_list_free (gpointer data)
+{
+    delete (AccountList_t *) data;
+}
+
+static void
+account_tree_index_drop_tables (AccountTreeIndex *index)
+{
+    if (!index->by_name)
+        return;
+
+    g_hash_table_destroy (index->by_name);
+    g_hash_table_destroy (index->by_code);
+    g_hash_table_destroy (index->by_full_name);
+    index->by_name = NULL;
+    index->by_code = NULL;
+    index->by_full_name = NULL;
+}
+
+static void
+account_tree_index_free (AccountTreeIndex *index)
+{
+    if (!index) return;
+
+    account_tree_index_drop_tables (index);
+    if (index->preorder)
+        g_ptr_array_free (index->preorder, TRUE);
+    g_free (index);
+}
+
+static Account *
+account_tree_top (const Account *acc)
+{
+    while (GET_PRIVATE(acc)->parent)
+        acc = GET_PRIVATE(acc)->parent;
+    return (Account *) acc;
+}
+
+static AccountTreeIndex *
+account_tree_get_index (const Account *acc)
+{
+    AccountPrivate *tpriv = GET_PRIVATE(account_tree_top (acc));
+
+    if (!tpriv->tree_index)
+        tpriv->tree_index = g_new0 (AccountTreeIndex, 1);
+    return tpriv->tree_index;
+}
+
+/* Called after an account has been added to or removed from the tree
+ * holding acc. */
+static void
+account_tree_shape_changed (const Account *acc)
+{
+    AccountTreeIndex *index = GET_PRIVATE(account_tree_top (acc))->tree_index;
+
+    if (index && index->preorder)
+    {
+        g_ptr_array_free (index->preorder, TRUE);
+        index->preorder = NULL;
+    }
+}
+
+static void
+account_tree_fill_preorder (GPtrArray *preorder, Account *acc)
+{
+    AccountPrivate *priv = GET_PRIVATE(acc);
+
+    for (AccountList_t::iterator node = priv->children.begin();
+            node != priv->children.end(); node++)
+    {
+        AccountPrivate *cpriv = GET_PRIVATE((*node));
+
+        cpriv->tree_pos = preorder->len;
+        g_ptr_array_add (preorder, *node);
+        account_tree_fill_preorder (preorder, *node);
+        cpriv->tree_size = preorder->len - cpriv->tree_pos - 1;
+    }
+}
+
+/* Return the pre-order array of the tree holding acc, rebuilding it
+ * if the tree has changed shape since it was last used. */
+static GPtrArray *
+account_tree_get_preorder (const Account *acc)
+{
+    Account *top = account_tree_top (acc);
+    AccountPrivate *tpriv = GET_PRIVATE(top);
+    AccountTreeIndex *index = account_tree_get_index (top);
+
+    if (!index->preorder)
+    {
+        index->preorder = g_ptr_array_new ();
+        account_tree_fill_preorder (index->preorder, top);
+        tpriv->tree_pos = -1;
+        tpriv->tree_size = index->preorder->len;
+    }
+    return index->preorder;
+}
+
+/* Return TRUE if splitting acc's full name at the separator gives back
+ * the names on its path, i.e. if none of them contains the separator.
+ * Accounts for which this does not hold can't be found by full
+ * name. */
+static bool
+account_full_name_is_exact (const Account *acc)
+{
+    const AccountPrivate *priv;
+
+    for (priv = GET_PRIVATE(acc); priv->parent; priv = GET_PRIVATE(priv->parent))
+    {
+        if (strstr (priv->accountName, account_separator))
+            return false;
+    }
+    return true;
+}
+
+static void
+account_table_insert (GHashTable *table, const char *key, Account *acc)
+{
+    AccountList_t *accounts;
+
+    accounts = (AccountList_t *) g_hash_table_lookup (table, key);
+    if (!accounts)
+    {
+        accounts = new AccountList_t;
+        g_hash_table_insert (table, g_strdup (key), accounts);
+    }
+    accounts->push_back (acc);
+}
+
+static void
+account_table_remove (GHashTable *table, const char *key, Account *acc)
+{
+    AccountList_t *accounts;
+
+    accounts = (AccountList_t *) g_hash_table_lookup (table, key);
+    if (!accounts) return;
+
+    accounts->remove (acc);
+    if (accounts->empty ())
+        g_hash_table_remove (table, key);
+}
+
+static void
+account_tree_index_enter (AccountTreeIndex *index, Account *acc)
+{
+    AccountPrivate *priv = GET_PRIVATE(acc);
+
+    account_table_insert (index->by_name, priv->accountName, acc);
+    if (priv->accountCode)
+        account_table_insert (index->by_code, priv->accountCode, acc);
+    if (account_full_name_is_exact (acc))
+        account_table_insert (index->by_full_name,
+                              gnc_account_get_full_name_const (acc), acc);
+}
+
+/* Return the index of the tree holding acc, with lookup tables built
+ * under the current name generation. */
+static AccountTreeIndex *
+account_tree_get_tables (const Account *acc)
+{
+    AccountTreeIndex *index = account_tree_get_index (acc);
+    GPtrArray *preorder;
+    guint i;
+
+    if (index->by_name && index->names_generation == account_names_generation)
+        return index;
+
+    account_tree_index_drop_tables (index);
+    index->by_name = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                            g_free, account_list_free);
+    index->by_code = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                            g_free, account_list_free);
+    index->by_full_name = g_hash_table_new_full (g_str_hash, g_str_equal,
+                          g_free, account_list_free);
+    index->names_generation = account_names_generation;
+
+    preorder = account_tree_get_preorder (acc);
+    for (i = 0; i < preorder->len; i++)
+        account_tree_index_enter (index, (Account *) g_ptr_array_index (preorder, i));
+    return index;
+}
+
+/* Return the index of the tree holding acc if its lookup tables are
+ * current.  Stale tables are dropped rather than patched. */
+static AccountTreeIndex *
+account_tree_find_tables (const Account *acc)
+{
+    AccountTreeIndex *index = GET_PRIVATE(account_tree_top (acc))->tree_index;
+
+    if (!index || !index->by_name)
+        return NULL;
+    if (index->names_generation != account_names_generation)
+    {
+        account_tree_index_drop_tables (index);
+        return NULL;
+    }
+    return index;
+}
+
+/* Take acc out of the lookup tables of its tree before a change to
+ * its name, code or place in the tree.  If the change alters any other
+ * account's full name, move the name generation on instead. */
+static void
+account_tree_index_remove (Account *acc)
+{
+    AccountPrivate *priv = GET_PRIVATE(acc);
+    AccountTreeIndex *index;
+
+    if (!priv->parent) return;
+    index = account_tree_find_tables (acc);
+    if (!index) return;
+
+    account_table_remove (index->by_name, priv->accountName, acc);
+    if (priv->accountCode)
+        account_table_remove (index->by_code, priv->accountCode, acc);
+    if (account_full_name_is_exact (acc))
+        account_table_remove (index->by_full_name,
+                              gnc_account_get_full_name_const (acc), acc);
+}
+
+/* Put acc back into the lookup tables of its tree after the change. */
+static void
+account_tree_index_add (Account *acc)
+{
+    AccountTreeIndex *index;
+
+    if (!GET_PRIVATE(acc)->parent) return;
+    index = account_tree_find_tables (acc);
+    if (!index) return;
+
+    account_tree_index_enter (index, acc);
+}
+
+/* Return the accounts on the way down from ancestor (exclusive) to acc
+ * (inclusive). */
+static AccountList_t
+account_path_from (const Account *ancestor, Account *acc)
+{
+    AccountList_t path;
+
+    for (; acc != ancestor; acc = GET_PRIVATE(acc)->parent)
+        path.push_front (acc);
+    return path;
+}
+
+/* Return TRUE if a search below parent reaches a before b.  The search
+ * looks at all of an account's children before it searches below any
+ * of them, taking the children in order; for accounts at the same
+ * depth that is plain depth-first order. */
+static bool
+account_search_precedes (const Account *parent, Account *a, Account *b)
+{
+    AccountList_t apath = account_path_from (parent, a);
+    AccountList_t bpath = account_path_from (parent, b);
+    AccountList_t::iterator anode = apath.begin();
+    AccountList_t::iterator bnode = bpath.begin();
+    const Account *node = parent;
+
+    for (;;)
+    {
+        bool a_here = (*anode == a);
+        bool b_here = (*bnode == b);
+
+        if (a_here != b_here)
+            return a_here;
+        if (*anode != *bnode)
+            return (gnc_account_child_index (node, *anode) <
+                    gnc_account_child_index (node, *bnode));
+        node = *anode;
+        anode++;
+        bnode++;
+    }
+}
+
+/* Return the account filed under key in table which a search below
+ * parent would find first. */
+static Account *
+account_table_lookup (GHashTable *table, const Account *parent,
+                      const char *key)
+{
+    AccountList_t *accounts;
+    Account *found = NULL;
+
+    accounts = (AccountList_t *) g_hash_table_lookup (table, key);
+    if (!accounts) return NULL;
+
+    for (AccountList_t::iterator node = accounts->begin();
+            node != accounts->end(); node++)
+    {
+        Account *acc = *node;
+
+        if (acc == parent || !xaccAccountHasAncestor (acc, parent))
+            continue;
+        if (!found || account_search_precedes (parent, acc, found))
+            found = acc;
+    }
+    return found;
+}
+
 /********************************************************************\
 \********************************************************************/
 
@@ -1808,8 +2217,20 @@ gnc_account_append_child (Account *new_parent, Account *child)
             qof_event_gen (child, QOF_EVENT_CREATE, NULL);
         }
     }
+    if (cpriv->tree_index)
+    {
+        /* The child no longer heads a tree of its own. */
+        account_tree_index_free (cpriv->tree_index);
+        cpriv->tree_index = NULL;
+    }
     cpriv->parent = new_parent;
     ppriv->children.push_back(child);
+    if (!cpriv->children.empty())
+        account_names_generation++;
+    cpriv->full_name_generation = 0;
+    account_tree_shape_changed (new_parent);
+    account_tree_index_add (child);
+    gnc_account_invalidate_subtree_balances(new_parent);
     qof_instance_set_dirty(new_parent);
     qof_instance_set_dirty(child);
 
@@ -1849,13 +2270,20 @@ gnc_account_remove_child (Account *parent, Account *child)
     ed.node = parent;
     ed.idx = list_index_of(ppriv->children, child);
 
+    if (!cpriv->children.empty())
+        account_names_generation++;
+    else
+        account_tree_index_remove (child);
     ppriv->children.remove(child);
+    account_tree_shape_changed (parent);
+    gnc_account_invalidate_subtree_balances(parent);
 
     /* Now send the event. */
     qof_event_gen(child, QOF_EVENT_REMOVE, &ed);
 
     /* clear the account's parent pointer after REMOVE event generation. */
     cpriv->parent = NULL;
+    cpriv->full_name_generation = 0;
 
     qof_event_gen (parent, QOF_EVENT_MODIFY, NULL);
 }
@@ -1951,18 +2379,16 @@ int
 gnc_account_n_descendants (const Account *account)
 {
     AccountPrivate *priv;
-    gint count = 0;
 
 //    g_return_val_if_fail(GNC_IS_ACCOUNT(account), 0);
     if(!account) return 0;
 
     priv = GET_PRIVATE(account);
-    for (AccountList_t::const_iterator node = priv->children.begin(); 
-            node != priv->children.end(); node++)
-    {
-        count += gnc_account_n_descendants(*node) + 1;
-    }
-    return count;
+    if (priv->children.empty())
+        return 0;
+
+    account_tree_get_preorder (account);
+    return priv->tree_size;
 }
 
 gint
@@ -2012,18 +2438,20 @@ gnc_account_get_descendants (const Account *account)
 {
     AccountPrivate *priv;
     AccountList_t descendants;
-    
+    GPtrArray *preorder;
+    int i;
+
 //    g_return_val_if_fail(GNC_IS_ACCOUNT(account), NULL);
     if(!account) return descendants; // empty list
 
     priv = GET_PRIVATE(account);
-    for (AccountList_t::const_iterator child = priv->children.begin();
-            child != priv->children.end(); child++)
-    {
-        descendants.push_back(*child);
-        AccountList_t subdescs = gnc_account_get_descendants(*child);
-        descendants.insert( descendants.end(), subdescs.begin(), subdescs.end() );
-    }
+    if (priv->children.empty())
+        return descendants;
+
+    /* The descendants are the next tree_size accounts in pre-order. */
+    preorder = account_tree_get_preorder (account);
+    for (i = priv->tree_pos + 1; i <= priv->tree_pos + priv->tree_size; i++)
+        descendants.push_back ((Account *) g_ptr_array_index (preorder, i));
     return descendants;
 }
 
@@ -2054,73 +2482,29 @@ gnc_account_get_descendants_sorted (const Account *account)
 Account *
 gnc_account_lookup_by_name (const Account *parent, const char * name)
 {
-    AccountPrivate *cpriv, *ppriv;
-    Account *child, *result;
+    AccountTreeIndex *index;
 
 //    g_return_val_if_fail(GNC_IS_ACCOUNT(parent), NULL);
 //    g_return_val_if_fail(name, NULL);
     if(!parent) return NULL;
     if(!name) return NULL;
 
-    /* first, look for accounts hanging off the current node */
-    ppriv = GET_PRIVATE(parent);
-    for (AccountList_t::iterator node = ppriv->children.begin();
-            node != ppriv->children.end(); node++)
-    {
-        child = *node;
-        cpriv = GET_PRIVATE(child);
-        if (g_strcmp0(cpriv->accountName, name) == 0)
-            return child;
-    }
-
-    /* if we are still here, then we haven't found the account yet.
-     * Recursively search each of the child accounts next */
-    for (node = ppriv->children.begin();
-            node != ppriv->children.end(); node++)
-    {
-        child = *node;
-        result = gnc_account_lookup_by_name (child, name);
-        if (result)
-            return result;
-    }
-
-    return NULL;
+    index = account_tree_get_tables (parent);
+    return account_table_lookup (index->by_name, parent, name);
 }
 
 Account *
 gnc_account_lookup_by_code (const Account *parent, const char * code)
 {
-    AccountPrivate *cpriv, *ppriv;
-    Account *child, *result;
+    AccountTreeIndex *index;
 
 //    g_return_val_if_fail(GNC_IS_ACCOUNT(parent), NULL);
 //    g_return_val_if_fail(code, NULL);
     if(!parent) return NULL;
     if(!code) return NULL;
 
-    /* first, look for accounts hanging off the current node */
-    ppriv = GET_PRIVATE(parent);
-    for (AccountList_t::iterator node = ppriv->children.begin();
-            node != ppriv->children.end(); node++)
-    {
-        child = *node;
-        cpriv = GET_PRIVATE(child);
-        if (g_strcmp0(cpriv->accountCode, code) == 0)
-            return child;
-    }
-
-    /* if we are still here, then we haven't found the account yet.
-     * Recursively search each of the child accounts next */
-    for (node = ppriv->children.begin();
-            node != ppriv->children.end(); node++)
-    {
-        child = *node;
-        result = gnc_account_lookup_by_code (child, code);
-        if (result)
-            return result;
-    }
-
-    return NULL;
+    index = account_tree_get_tables (parent);
+    return account_table_lookup (index->by_code, parent, code);
 }
 
 /********************************************************************\
@@ -2175,27 +2559,21 @@ Account *
 gnc_account_lookup_by_full_name (const Account *any_acc,
                                  const char *name)
 {
-    const AccountPrivate *rpriv;
     const Account *root;
-    Account *found;
-    char **names;
+    AccountTreeIndex *index;
 
 //    g_return_val_if_fail(GNC_IS_ACCOUNT(any_acc), NULL);
 //    g_return_val_if_fail(name, NULL);
     if(!any_acc) return NULL;
     if(!name) return NULL;
 
-    root = any_acc;
-    rpriv = GET_PRIVATE(root);
-    while (rpriv->parent)
-    {
-        root = rpriv->parent;
-        rpriv = GET_PRIVATE(root);
-    }
-    names = g_strsplit(name, gnc_get_account_separator_string(), -1);
-    found = gnc_account_lookup_by_full_name_helper(root, names);
-    g_strfreev(names);
-    return found;
+    /* An empty string names no account, not even a top level account
+     * with an empty name. */
+    if (*name == '\0') return NULL;
+
+    root = account_tree_top (any_acc);
+    index = account_tree_get_tables (root);
+    return account_table_lookup (index->by_full_name, root, name);
 }
 
 void
@@ -2307,53 +2685,45 @@ xaccAccountGetName (const Account *acc)
     return GET_PRIVATE(acc)->accountName;
 }
 
-gchar *
-gnc_account_get_full_name(const Account *account)
+const char *
+gnc_account_get_full_name_const (const Account *account)
 {
     AccountPrivate *priv;
-    const Account *a;
     char *fullname;
-    gchar **names;
-    int level;
 
-    /* So much for hardening the API. Too many callers to this function don't
-     * bother to check if they have a non-NULL pointer before calling. */
     if (NULL == account)
-        return g_strdup("");
+        return "";
 
-    /* errors */
-//    g_return_val_if_fail(GNC_IS_ACCOUNT(account), g_strdup(""));
-    if(!account) return g_strdup("");
-
-    /* optimizations */
     priv = GET_PRIVATE(account);
     if (!priv->parent)
-        return g_strdup("");
+        return "";
 
-    /* Figure out how much space is needed by counting the nodes up to
-     * the root. */
-    level = 0;
-    for (a = account; a; a = priv->parent)
+    if (priv->full_name && priv->full_name_generation == account_names_generation)
+        return priv->full_name;
+
+    /* The topmost account's name is not part of the full name. */
+    if (!GET_PRIVATE(priv->parent)->parent)
     {
-        priv = GET_PRIVATE(a);
-        level++;
+        CACHE_REPLACE(priv->full_name, priv->accountName);
     }
-
-    /* Get all the pointers in the right order. The root node "entry"
-     * becomes the terminating NULL pointer for the array of strings. */
-    names = g_malloc(level * sizeof(gchar *));
-    names[--level] = NULL;
-    for (a = account; level > 0; a = priv->parent)
+    else
     {
-        priv = GET_PRIVATE(a);
-        names[--level] = priv->accountName;
+        fullname = g_strconcat (gnc_account_get_full_name_const (priv->parent),
+                                account_separator, priv->accountName, NULL);
+        CACHE_REPLACE(priv->full_name, fullname);
+        g_free (fullname);
     }
+    priv->full_name_generation = account_names_generation;
 
-    /* Build the full name */
-    fullname =  g_strjoinv(account_separator, names);
-    g_free(names);
+    return priv->full_name;
+}
 
-    return fullname;
+char *
+gnc_account_get_full_name(const Account *account)
+{
+    /* So much for hardening the API. Too many callers to this function don't
+     * bother to check if they have a non-NULL pointer before calling. */
+    return g_strdup (gnc_account_get_full_name_const (account));
 }
 
 const char *
@@ -2440,6 +2810,16 @@ gnc_numeric gnc_account_get_start_balance(const Account * acc)
     return GET_PRIVATE(acc)->starting_balance;
 }
 
+gnc_numeric gnc_account_get_start_cleared_balance(const Account * acc)
+{
+    return GET_PRIVATE(acc)->starting_cleared_balance;
+}
+
+gnc_numeric gnc_account_get_start_reconciled_balance(const Account * acc)
+{
+    return GET_PRIVATE(acc)->starting_reconciled_balance;
+}
+
 void
 gnc_account_set_start_balance (Account *acc, const gnc_numeric start_baln)
 {
@@ -2608,8 +2988,9 @@ xaccAccountGetBalanceAsOfDate (Account *acc, time64 date)
         }
         else
         {
-            /* AsOf date must be before any entries, return zero. */
-            balance = gnc_numeric_zero();
+            /* AsOf date must be before any loaded entries, return the
+             * balance carried in from any splits the backend left out. */
+            balance = priv->starting_balance;
         }
     }
 
@@ -2810,6 +3191,58 @@ xaccAccountBalanceAsOfDateHelper (Account *acc, gpointer data)
 
 
 
+/*
+ * Returns the total of 'fn' over an account and all of its descendants,
+ * converted to 'report_commodity', using and filling in the accounts'
+ * subtree_balances caches.  Only balances that change solely through
+ * xaccAccountRecomputeBalance may be cached this way; the present and
+ * projected-minimum balances depend on the current time and are not.
+ */
+static gnc_numeric
+xaccAccountGetSubtreeBalanceInCurrency (const Account *acc,
+                                        xaccGetBalanceFn fn,
+                                        const gnc_commodity *report_commodity,
+                                        guint64 price_generation)
+{
+    AccountPrivate *priv = GET_PRIVATE(acc);
+    SubtreeBalanceList_t::iterator node;
+    gnc_numeric balance;
+
+    for (node = priv->subtree_balances.begin();
+            node != priv->subtree_balances.end(); node++)
+    {
+        if (node->fn == fn && node->currency == report_commodity)
+            break;
+    }
+    if (node != priv->subtree_balances.end() &&
+            node->price_generation == price_generation)
+        return node->balance;
+
+    balance = xaccAccountGetXxxBalanceInCurrency (acc, fn, report_commodity);
+    for (AccountList_t::iterator child = priv->children.begin();
+            child != priv->children.end(); child++)
+    {
+        gnc_numeric child_balance =
+            xaccAccountGetSubtreeBalanceInCurrency (*child, fn,
+                    report_commodity, price_generation);
+        balance = gnc_numeric_add (balance, child_balance,
+                                   gnc_commodity_get_fraction (report_commodity),
+                                   GNC_HOW_RND_ROUND_HALF_UP);
+    }
+
+    if (node == priv->subtree_balances.end())
+    {
+        AccountSubtreeBalance entry;
+        entry.fn = fn;
+        entry.currency = report_commodity;
+        priv->subtree_balances.push_front(entry);
+        node = priv->subtree_balances.begin();
+    }
+    node->price_generation = price_generation;
+    node->balance = balance;
+    return balance;
+}
+
 /*
  * Common function that iterates recursively over all accounts below
  * the specified account.  It uses xaccAccountBalanceHelper to sum up
@@ -2834,6 +3267,18 @@ xaccAccountGetXxxBalanceInCurrencyRecursive (const Account *acc,
     if (!report_commodity)
         return gnc_numeric_zero();
 
+    /* The totals of the plain, cleared and reconciled balances are
+       cached on the account tree. */
+    if (include_children &&
+            (fn == xaccAccountGetBalance ||
+             fn == xaccAccountGetClearedBalance ||
+             fn == xaccAccountGetReconciledBalance))
+    {
+        GNCPriceDB *pdb = gnc_pricedb_get_db (gnc_account_get_book (acc));
+        return xaccAccountGetSubtreeBalanceInCurrency (acc, fn,
+                report_commodity, gnc_pricedb_get_generation (pdb));
+    }
+
     balance = xaccAccountGetXxxBalanceInCurrency (acc, fn, report_commodity);
 
     /* If needed, sum up the children converting to the *requested*
@@ -2994,6 +3439,15 @@ xaccAccountGetSplitList (const Account *acc)
     return GET_PRIVATE(acc)->splits;
 }
 
+const SplitList_t &
+xaccAccountGetSplitListRef (const Account *acc)
+{
+    static const SplitList_t no_splits;
+    if(!acc) return no_splits;
+    xaccAccountSortSplits((Account*)acc, FALSE);  // normally a noop
+    return GET_PRIVATE(acc)->splits;
+}
+
 LotList_t
 xaccAccountGetLotList (const Account *acc)
 {
@@ -298,6 +298,14 @@ bool xaccAccountIsPriced(const Account *acc);
 
 gnc_numeric gnc_account_get_start_balance(const Account * acc);
 
+/** Returns the starting cleared commodity balance set with
+ *  gnc_account_set_start_cleared_balance(). */
+gnc_numeric gnc_account_get_start_cleared_balance(const Account * acc);
+
+/** Returns the starting reconciled commodity balance set with
+ *  gnc_account_set_start_reconciled_balance(). */
+gnc_numeric gnc_account_get_start_reconciled_balance(const Account * acc);
+
 /** This function will set the starting commodity balance for this
  *  account.  This routine is intended for use with backends that do
  *  not return the complete list of splits for an account, but rather
@@ -407,6 +415,15 @@ void xaccAccountSortSplits (Account *acc, bool force);
  */
 char * gnc_account_get_full_name (const Account *account);
 
+/** Return the same string as gnc_account_get_full_name(), but without
+ *  copying it.  The full name is cached with the account, so this
+ *  only builds a string the first time it is asked for after the
+ *  account, one of its ancestors or the separator has changed.  The
+ *  returned string belongs to the account and is only valid until
+ *  then; copy it to keep it longer.
+ */
+const char * gnc_account_get_full_name_const (const Account *account);
+
 /** Set a string that identifies the Finance::Quote backend that
  *  should be used to retrieve online prices.  See price-quotes.scm
  *  for more information
@@ -512,7 +529,12 @@ gnc_numeric xaccAccountGetClearedBalance (const Account *account);
 gnc_numeric xaccAccountGetReconciledBalance (const Account *account);
 gnc_numeric xaccAccountGetPresentBalance (const Account *account);
 gnc_numeric xaccAccountGetProjectedMinimumBalance (const Account *account);
-/** Get the balance of the account as of the date specified */
+/** Get the balance of the account as of the date specified.
+ *
+ *  Only the splits in the book are walked; nothing is loaded.  If the
+ *  backend loaded only the recent transactions, a date before them gets
+ *  the balance at the start of what was loaded.  Callers that need an
+ *  older date call qof_backend_run_load_since() first. */
 gnc_numeric xaccAccountGetBalanceAsOfDate (Account *account,
         time64 date);
 
@@ -697,11 +719,13 @@ Account *gnc_account_nth_child (const Account *parent, int num);
  *  descendants of the specified account.  This includes not only the
  *  the children, but the children of the children, etc. For a list of
  *  only the immediate child accounts, use the
- *  gnc_account_get_children() function.  Within each set of child
- *  accounts, the accounts returned by this function are unordered.
- *  For a list of descendants where each set of children is sorted via
- *  the standard account sort function, use the
- *  gnc_account_get_descendants_sorted() function.
+ *  gnc_account_get_children() function.  The accounts are returned in
+ *  pre-order, each followed by its own descendants, and children in
+ *  the order they were added; they are copied from a flat array kept
+ *  for the whole tree, so the cost is in proportion to the number of
+ *  descendants returned.  For a list of descendants where each set
+ *  of children is sorted via the standard account sort function, use
+ *  the gnc_account_get_descendants_sorted() function.
  *
  *  @param account The account whose descendants should be returned.
  *
@@ -731,7 +755,8 @@ AccountList_t gnc_account_get_descendants (const Account *account);
 AccountList_t gnc_account_get_descendants_sorted (const Account *account);
 
 /** Return the number of descendants of the specified account.  The
- *  returned number does not include the account itself.
+ *  returned number does not include the account itself.  Unless the
+ *  tree has changed since the last call it is not counted again.
  *
  *  @param account The account to query.
  *
@@ -858,6 +883,11 @@ bool xaccAccountHasAncestor(const Account *acc, const Account *ancestor);
  *  recursive search of all descendants is performed looking for a
  *  match.
  *
+ *  The search is answered from name, code and full name tables kept
+ *  on the topmost account of the tree, so only accounts carrying the
+ *  name are looked at.  The tables are built by the first lookup in a
+ *  tree and kept up to date as accounts are renamed and moved.
+ *
  *  @return A pointer to the account with the specified name, or NULL
  *  if the account was not found.
  */
@@ -865,7 +895,9 @@ Account *gnc_account_lookup_by_name (const Account *parent, const char *name);
 
 /** The gnc_account_lookup_full_name() subroutine works like
  *  gnc_account_lookup_by_name, but uses fully-qualified names using the
- *  given separator.
+ *  given separator.  The name is always looked up from the topmost
+ *  account of any_account's tree.  Accounts whose name or whose
+ *  ancestors' names contain the separator can't be found this way.
  */
 Account *gnc_account_lookup_by_full_name (const Account *any_account,
         const gchar *name);
@@ -946,6 +978,11 @@ uint32_t xaccAccountTypesValid(void);
  */
 SplitList_t xaccAccountGetSplitList (const Account *account);
 
+/** Same as xaccAccountGetSplitList(), but returns the account's own
+ *  list, sorted by xaccSplitOrder(), instead of a copy.  The reference
+ *  is only good until the account's splits next change. */
+const SplitList_t & xaccAccountGetSplitListRef (const Account *account);
+
 /** The xaccAccountMoveAllSplits() routine reassigns each of the splits
  *  in accfrom to accto. */
 void xaccAccountMoveAllSplits (Account *accfrom, Account *accto);
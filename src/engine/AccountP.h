@@ -51,6 +51,21 @@
  * No one outside of the engine should ever include this file.
 */
 
+/* One cached subtree total; see AccountPrivate::subtree_balances. */
+typedef struct
+{
+    xaccGetBalanceFn fn;
+    const gnc_commodity *currency;
+    guint64 price_generation;
+    gnc_numeric balance;
+} AccountSubtreeBalance;
+
+typedef std::list<AccountSubtreeBalance> SubtreeBalanceList_t;
+
+/* Name, code and full name lookup tables and the pre-order account
+ * array of one account tree; see AccountPrivate::tree_index. */
+typedef struct AccountTreeIndex AccountTreeIndex;
+
 /** \struct Account */
 struct AccountPrivate
 {
@@ -98,6 +113,24 @@ struct AccountPrivate
     Account *parent;    /* back-pointer to parent */
     AccountList_t children;    /* list of sub-accounts */
 
+    /* The full name, interned in the string cache, as last built by
+     * gnc_account_get_full_name_const().  It is current while
+     * full_name_generation matches the engine's account name
+     * generation, which moves on whenever an account with children is
+     * renamed or moved or the separator changes; renaming or moving
+     * this account itself clears full_name_generation. */
+    char *full_name;
+    guint64 full_name_generation;
+
+    /* Only set on the topmost account of a tree, and only once
+     * something has been looked up in it.  tree_pos and tree_size give
+     * the account's place in the index's pre-order array: its
+     * descendants are the tree_size entries following tree_pos.  They
+     * are only meaningful while that array is current. */
+    AccountTreeIndex *tree_index;
+    int tree_pos;
+    int tree_size;
+
     /* protected data - should only be set by backends */
     gnc_numeric starting_balance;
     gnc_numeric starting_cleared_balance;
@@ -110,7 +143,16 @@ struct AccountPrivate
 
     bool balance_dirty;     /* balances in splits incorrect */
 
+    /* Totals of this account and all its descendants, converted to a
+     * report commodity, one entry per (balance function, commodity)
+     * pair asked for.  An account's entries are dropped along with those
+     * of all its ancestors whenever its balance, commodity or children
+     * change; an entry is also stale once the price db generation it
+     * was computed under has moved on. */
+    SubtreeBalanceList_t subtree_balances;
+
     SplitList_t splits;              /* list of split pointers */
+    GHashTable *splits_hash;  /* split -> its node in splits */
     bool sort_dirty;        /* sort order of splits is bad */
 
     LotList_t   lots;		/* list of lot pointers */
@@ -131,6 +173,11 @@ struct AccountPrivate
         commodity_scu = 0;
         non_standard_scu = false;
         parent = NULL;
+        full_name = NULL;
+        full_name_generation = 0;
+        tree_index = NULL;
+        tree_pos = -1;
+        tree_size = 0;
         starting_balance = gnc_numeric_zero();
         starting_cleared_balance = gnc_numeric_zero();
         starting_reconciled_balance = gnc_numeric_zero();
@@ -138,6 +185,7 @@ struct AccountPrivate
         cleared_balance = gnc_numeric_zero();
         reconciled_balance = gnc_numeric_zero();
         balance_dirty = false;
+        splits_hash = NULL;
         sort_dirty = false;
         policy = NULL;
         mark = 0;
@@ -21,687 +21,561 @@
  * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
 \********************************************************************/
 
-//#include "config.h"
-//
-//#include <ctype.h>
-//#include <glib.h>
-//#include <math.h>
-//#include <string.h>
-//#include <sys/types.h>
-//
-//#include <regex.h>
-//#include <unistd.h>
-//
-//#include "gnc-lot.h"
-//#include "Account.h"
-//#include "Query.h"
-//#include "Transaction.h"
-//#include "TransactionP.h"
-//
-//static QofLogModule log_module = GNC_MOD_QUERY;
-//
-//static GSList *
-//build_param_list_internal (const char *first, va_list rest)
-//{
-//    GSList *list = NULL;
-//    char const *param;
-//
-//    for (param = first; param; param = va_arg (rest, const char *))
-//        list = g_slist_prepend (list, (gpointer)param);
-//
-//    return (g_slist_reverse (list));
-//}
-//
-///********************************************************************
-// * xaccQueryGetSplitsUniqueTrans
-// * Get splits but no more than one from a given transaction.
-// ********************************************************************/
-//
-//SplitList_t
-//xaccQueryGetSplitsUniqueTrans(QofQuery *q)
-//{
-//    GList       * splits = qof_query_run(q);
-//    GList       * current;
-//    SplitList_t   result;
-//    GHashTable  * trans_hash = g_hash_table_new(g_direct_hash, g_direct_equal);
-//
-//    for (current = splits; current; current = current->next)
-//    {
-//        Split *split = current->data;
-//        Transaction *trans = xaccSplitGetParent (split);
-//
-//        if (!g_hash_table_lookup (trans_hash, trans))
-//        {
-//            g_hash_table_insert (trans_hash, trans, trans);
-//            result.push_back(split);
-//        }
-//    }
-//
-//    g_hash_table_destroy (trans_hash);
-//
-//    return result;
-//}
-//
-///********************************************************************
-// * xaccQueryGetTransactions
-// * Get transactions matching the query terms, specifying whether
-// * we require some or all splits to match
-// ********************************************************************/
-//
-//static void
-//query_match_all_filter_func(gpointer key, gpointer value, gpointer user_data)
-//{
-//    Transaction * t = key;
-//    int         num_matches = GPOINTER_TO_INT(value);
-//    GList       ** matches = user_data;
-//
-//    if (num_matches == xaccTransCountSplits(t))
-//    {
-//        *matches = g_list_prepend(*matches, t);
-//    }
-//}
-//
-//static void
-//query_match_any_filter_func(gpointer key, gpointer value, gpointer user_data)
-//{
-//    Transaction * t = key;
-//    GList       ** matches = user_data;
-//    *matches = g_list_prepend(*matches, t);
-//}
-//
-//TransList *
-//xaccQueryGetTransactions (QofQuery * q, query_txn_match_t runtype)
-//{
-//    GList       * splits = qof_query_run(q);
-//    GList       * current = NULL;
-//    GList       * retval = NULL;
-//    GHashTable  * trans_hash = g_hash_table_new(g_direct_hash, g_direct_equal);
-//    Transaction * trans = NULL;
-//    gpointer    val = NULL;
-//    int         count = 0;
-//
-//    /* iterate over matching splits, incrementing a match-count in
-//     * the hash table */
-//    for (current = splits; current; current = current->next)
-//    {
-//        trans = xaccSplitGetParent((Split *)(current->data));
-//
-//        /* don't waste time looking up unless we need the count
-//         * information */
-//        if (runtype == QUERY_TXN_MATCH_ALL)
-//        {
-//            val   = g_hash_table_lookup(trans_hash, trans);
-//            count = GPOINTER_TO_INT(val);
-//        }
-//        g_hash_table_insert(trans_hash, trans, GINT_TO_POINTER(count + 1));
-//    }
-//
-//    /* now pick out the transactions that match */
-//    if (runtype == QUERY_TXN_MATCH_ALL)
-//    {
-//        g_hash_table_foreach(trans_hash, query_match_all_filter_func,
-//                             &retval);
-//    }
-//    else
-//    {
-//        g_hash_table_foreach(trans_hash, query_match_any_filter_func,
-//                             &retval);
-//    }
-//
-//    g_hash_table_destroy(trans_hash);
-//
-//    return retval;
-//}
-//
-///********************************************************************
-// * xaccQueryGetLots
-// * Get lots matching the query terms, specifying whether
-// * we require some or all splits to match
-// ********************************************************************/
-//
-//static void
-//query_match_all_lot_filter_func(gpointer key, gpointer value, gpointer user_data)
-//{
-//    GNCLot *	l = key;
-//    int		num_matches = GPOINTER_TO_INT(value);
-//    GList **	matches = user_data;
-//
-//    if (num_matches == gnc_lot_count_splits(l))
-//    {
-//        *matches = g_list_prepend(*matches, l);
-//    }
-//}
-//
-//static void
-//query_match_any_lot_filter_func(gpointer key, gpointer value, gpointer user_data)
-//{
-//    GNCLot *	t = key;
-//    GList **	matches = user_data;
-//    *matches = g_list_prepend(*matches, t);
-//}
-//
-//LotList *
-//xaccQueryGetLots (QofQuery * q, query_txn_match_t runtype)
-//{
-//    GList       * splits = qof_query_run(q);
-//    GList       * current = NULL;
-//    GList       * retval = NULL;
-//    GHashTable  * lot_hash = g_hash_table_new(g_direct_hash, g_direct_equal);
-//    GNCLot      * lot = NULL;
-//    gpointer    val = NULL;
-//    int         count = 0;
-//
-//    /* iterate over matching splits, incrementing a match-count in
-//     * the hash table */
-//    for (current = splits; current; current = current->next)
-//    {
-//        lot = xaccSplitGetLot((Split *)(current->data));
-//
-//        /* don't waste time looking up unless we need the count
-//         * information */
-//        if (runtype == QUERY_TXN_MATCH_ALL)
-//        {
-//            val   = g_hash_table_lookup(lot_hash, lot);
-//            count = GPOINTER_TO_INT(val);
-//        }
-//        g_hash_table_insert(lot_hash, lot, GINT_TO_POINTER(count + 1));
-//    }
-//
-//    /* now pick out the transactions that match */
-//    if (runtype == QUERY_TXN_MATCH_ALL)
-//    {
-//        g_hash_table_foreach(lot_hash, query_match_all_lot_filter_func,
-//                             &retval);
-//    }
-//    else
-//    {
-//        g_hash_table_foreach(lot_hash, query_match_any_lot_filter_func,
-//                             &retval);
-//    }
-//
-//    g_hash_table_destroy(lot_hash);
-//
-//    return retval;
-//}
-//
-///*******************************************************************
-// *  match-adding API
-// *******************************************************************/
-//
-//void
-//xaccQueryAddAccountMatch(QofQuery *q, const AccountList_t & acct_list,
-//                         QofGuidMatch how, QofQueryOp op)
-//{
-//    GList *list = NULL;
-//
-//    if (!q) return;
-//    for (AccountList_t::const_iterator it = acct_list.begin(); it != acct_list.end(); it++)
-//    {
-//        Account *acc = *it;
-//        const GncGUID *guid;
-//
-//        if (!acc)
-//        {
-//            PWARN ("acct_list has NULL account");
-//            continue;
-//        }
-//
-//        guid = qof_entity_get_guid (QOF_INSTANCE(acc));
-//        if (!guid)
-//        {
-//            PWARN ("acct returns NULL GncGUID");
-//            continue;
-//        }
-//
-//        list = g_list_prepend (list, (gpointer)guid);
-//    }
-//    xaccQueryAddAccountGUIDMatch (q, list, how, op);
-//    g_list_free (list);
-//}
-//
-//void
-//xaccQueryAddAccountGUIDMatch(QofQuery *q, AccountGUIDList *guid_list,
-//                             QofGuidMatch how, QofQueryOp op)
-//{
-//    QofQueryPredData *pred_data;
-//    GSList *param_list = NULL;
-//
-//    if (!q) return;
-//
-//    if (!guid_list && how != QOF_GUID_MATCH_NULL)
-//    {
-//        g_warning("Got a NULL guid_list but the QofGuidMatch is not MATCH_NULL (but instead %d). In other words, the list of GUID matches is empty but it must contain something non-empty.", how);
-//        /* qof_query_guid_predicate() would trigger a g_warning as well */
-//        return;
-//    }
-//    pred_data = qof_query_guid_predicate (how, guid_list);
-//    if (!pred_data)
-//        return;
-//
-//    switch (how)
-//    {
-//    case QOF_GUID_MATCH_ANY:
-//    case QOF_GUID_MATCH_NONE:
-//        param_list = qof_query_build_param_list (SPLIT_ACCOUNT, QOF_PARAM_GUID, NULL);
-//        break;
-//    case QOF_GUID_MATCH_ALL:
-//        param_list = qof_query_build_param_list (SPLIT_TRANS, TRANS_SPLITLIST,
-//                     SPLIT_ACCOUNT_GUID, NULL);
-//        break;
-//    default:
-//        PERR ("Invalid match type: %d", how);
-//        break;
-//    }
-//
-//    qof_query_add_term (q, param_list, pred_data, op);
-//}
-//
-//void
-//xaccQueryAddSingleAccountMatch(QofQuery *q, Account *acc, QofQueryOp op)
-//{
-//    GList *list;
-//    const GncGUID *guid;
-//
-//    if (!q || !acc)
-//        return;
-//
-//    guid = qof_entity_get_guid (QOF_INSTANCE(acc));
-//    g_return_if_fail (guid);
-//
-//    list = g_list_prepend (NULL, (gpointer)guid);
-//    xaccQueryAddAccountGUIDMatch (q, list, QOF_GUID_MATCH_ANY, op);
-//    g_list_free (list);
-//}
-//
-//void
-//xaccQueryAddStringMatch (QofQuery* q, const char *matchstring,
-//                         bool case_sens, bool use_regexp,
-//                         QofQueryOp op,
-//                         const char * path, ...)
-//{
-//    QofQueryPredData *pred_data;
-//    GSList *param_list;
-//    va_list ap;
-//
-//    if (!path || !q)
-//        return;
-//
-//    pred_data = qof_query_string_predicate (QOF_COMPARE_EQUAL, (char *)matchstring,
-//                                            (case_sens ? QOF_STRING_MATCH_NORMAL :
-//                                                    QOF_STRING_MATCH_CASEINSENSITIVE),
-//                                            use_regexp);
-//    if (!pred_data)
-//        return;
-//
-//    va_start (ap, path);
-//    param_list = build_param_list_internal (path, ap);
-//    va_end (ap);
-//
-//    qof_query_add_term (q, param_list, pred_data, op);
-//}
-//
-//void
-//xaccQueryAddNumericMatch (QofQuery *q, gnc_numeric amount, QofNumericMatch sign,
-//                          QofQueryCompare how, QofQueryOp op,
-//                          const char * path, ...)
-//{
-//    QofQueryPredData *pred_data;
-//    GSList *param_list;
-//    va_list ap;
-//
-//    if (!q || !path)
-//        return;
-//
-//    pred_data = qof_query_numeric_predicate (how, sign, amount);
-//    if (!pred_data)
-//        return;
-//
-//    va_start (ap, path);
-//    param_list = build_param_list_internal (path, ap);
-//    va_end (ap);
-//
-//    qof_query_add_term (q, param_list, pred_data, op);
-//}
-//
-///* The DateMatch queries match transactions whose posted date
-// *    is in a date range.  If use_start is TRUE, then a matching
-// *    posted date will be greater than the start date.   If
-// *    use_end is TRUE, then a match occurs for posted dates earlier
-// *    than the end date.  If both flags are set, then *both*
-// *    conditions must hold ('and').  If neither flag is set, then
-// *    all transactions are matched.
-// */
-//
-//void
-//xaccQueryAddDateMatchTS (QofQuery * q,
-//                         bool use_start, Timespec sts,
-//                         bool use_end, Timespec ets,
-//                         QofQueryOp op)
-//{
-//    QofQuery *tmp_q = NULL;
-//    QofQueryPredData *pred_data;
-//    GSList *param_list;
-//
-//    if (!q || (!use_start && !use_end))
-//        return;
-//
-//    tmp_q = qof_query_create ();
-//
-//    if (use_start)
-//    {
-//        pred_data = qof_query_date_predicate (QOF_COMPARE_GTE, QOF_DATE_MATCH_NORMAL, sts);
-//        if (!pred_data)
-//        {
-//            qof_query_destroy (tmp_q);
-//            return;
-//        }
-//
-//        param_list = qof_query_build_param_list (SPLIT_TRANS, TRANS_DATE_POSTED, NULL);
-//        qof_query_add_term (tmp_q, param_list, pred_data, QOF_QUERY_AND);
-//    }
-//
-//    if (use_end)
-//    {
-//        pred_data = qof_query_date_predicate (QOF_COMPARE_LTE, QOF_DATE_MATCH_NORMAL, ets);
-//        if (!pred_data)
-//        {
-//            qof_query_destroy (tmp_q);
-//            return;
-//        }
-//
-//        param_list = qof_query_build_param_list (SPLIT_TRANS, TRANS_DATE_POSTED, NULL);
-//        qof_query_add_term (tmp_q, param_list, pred_data, QOF_QUERY_AND);
-//    }
-//
-//    qof_query_merge_in_place (q, tmp_q, op);
-//    qof_query_destroy (tmp_q);
-//}
-//
-//void
-//xaccQueryGetDateMatchTS (QofQuery * q,
-//                         Timespec * sts,
-//                         Timespec * ets)
-//{
-//    QofQueryPredData *term_data;
-//    GSList *param_list;
-//    GSList *terms, *tmp;
-//
-//    sts->tv_sec = sts->tv_nsec = 0;
-//    ets->tv_sec = ets->tv_nsec = 0;
-//
-//    param_list = qof_query_build_param_list (SPLIT_TRANS, TRANS_DATE_POSTED, NULL);
-//    terms = qof_query_get_term_type (q, param_list);
-//    g_slist_free(param_list);
-//
-//    for (tmp = terms; tmp; tmp = g_slist_next(tmp))
-//    {
-//        term_data = tmp->data;
-//        if (term_data->how == QOF_COMPARE_GTE)
-//            qof_query_date_predicate_get_date(term_data, sts);
-//        if (term_data->how == QOF_COMPARE_LTE)
-//            qof_query_date_predicate_get_date(term_data, ets);
-//    }
-//    g_slist_free(terms);
-//}
-//
-///********************************************************************
-// * xaccQueryAddDateMatch
-// * Add a date filter to an existing query.
-// ********************************************************************/
-//
-//void
-//xaccQueryAddDateMatch(QofQuery * q,
-//                      bool use_start, int sday, int smonth, int syear,
-//                      bool use_end, int eday, int emonth, int eyear,
-//                      QofQueryOp op)
-//{
-//    /* gcc -O3 will auto-inline this function, avoiding a call overhead */
-//    xaccQueryAddDateMatchTS (q, use_start,
-//                             gnc_dmy2timespec(sday, smonth, syear),
-//                             use_end,
-//                             gnc_dmy2timespec_end(eday, emonth, eyear),
-//                             op);
-//}
-//
-///********************************************************************
-// * xaccQueryAddDateMatchTT
-// * Add a date filter to an existing query.
-// ********************************************************************/
-//
-//void
-//xaccQueryAddDateMatchTT(QofQuery * q,
-//                        bool use_start,
-//                        time64 stt,
-//                        bool use_end,
-//                        time64 ett,
-//                        QofQueryOp op)
-//{
-//    Timespec   sts;
-//    Timespec   ets;
-//
-//    sts.tv_sec  = stt;
-//    sts.tv_nsec = 0;
-//
-//    ets.tv_sec  = ett;
-//    ets.tv_nsec = 0;
-//
-//    /* gcc -O3 will auto-inline this function, avoiding a call overhead */
-//    xaccQueryAddDateMatchTS (q, use_start, sts,
-//                             use_end, ets, op);
-//
-//}
-//
-//void
-//xaccQueryGetDateMatchTT (QofQuery * q,
-//                         time64 * stt,
-//                         time64 * ett)
-//{
-//    Timespec   sts;
-//    Timespec   ets;
-//
-//    xaccQueryGetDateMatchTS (q, &sts, &ets);
-//
-//    *stt = sts.tv_sec;
-//    *ett = ets.tv_sec;
-//}
-//
-//void
-//xaccQueryAddClearedMatch(QofQuery * q, cleared_match_t how, QofQueryOp op)
-//{
-//    QofQueryPredData *pred_data;
-//    GSList *param_list;
-//    char chars[6];
-//    int i = 0;
-//
-//    if (!q)
-//        return;
-//
-//    if (how & CLEARED_CLEARED)
-//        chars[i++] = CREC;
-//    if (how & CLEARED_RECONCILED)
-//        chars[i++] = YREC;
-//    if (how & CLEARED_FROZEN)
-//        chars[i++] = FREC;
-//    if (how & CLEARED_NO)
-//        chars[i++] = NREC;
-//    if (how & CLEARED_VOIDED)
-//        chars[i++] = VREC;
-//    chars[i] = '\0';
-//
-//    pred_data = qof_query_char_predicate (QOF_CHAR_MATCH_ANY, chars);
-//    if (!pred_data)
-//        return;
-//
-//    param_list = qof_query_build_param_list (SPLIT_RECONCILE, NULL);
-//
-//    qof_query_add_term (q, param_list, pred_data, op);
-//}
-//
-//void
-//xaccQueryAddGUIDMatch(QofQuery * q, const GncGUID *guid,
-//                      QofIdType id_type, QofQueryOp op)
-//{
-//    GSList *param_list = NULL;
-//
-//    if (!q || !guid || !id_type)
-//        return;
-//
-//    if (!g_strcmp0 (id_type, GNC_ID_SPLIT))
-//        param_list = qof_query_build_param_list (QOF_PARAM_GUID, NULL);
-//    else if (!g_strcmp0 (id_type, GNC_ID_TRANS))
-//        param_list = qof_query_build_param_list (SPLIT_TRANS, QOF_PARAM_GUID, NULL);
-//    else if (!g_strcmp0 (id_type, GNC_ID_ACCOUNT))
-//        param_list = qof_query_build_param_list (SPLIT_ACCOUNT, QOF_PARAM_GUID, NULL);
-//    else
-//        PERR ("Invalid match type: %s", id_type);
-//
-//    qof_query_add_guid_match (q, param_list, guid, op);
-//}
-//
-//void
-//xaccQueryAddKVPMatch(QofQuery *q, GSList *path, const KvpValue *value,
-//                     QofQueryCompare how, QofIdType id_type,
-//                     QofQueryOp op)
-//{
-//    GSList *param_list = NULL;
-//    QofQueryPredData *pred_data;
-//
-//    if (!q || !path || !value || !id_type)
-//        return;
-//
-//    pred_data = qof_query_kvp_predicate (how, path, value);
-//    if (!pred_data)
-//        return;
-//
-//    if (!g_strcmp0 (id_type, GNC_ID_SPLIT))
-//        param_list = qof_query_build_param_list (SPLIT_KVP, NULL);
-//    else if (!g_strcmp0 (id_type, GNC_ID_TRANS))
-//        param_list = qof_query_build_param_list (SPLIT_TRANS, TRANS_KVP, NULL);
-//    else if (!g_strcmp0 (id_type, GNC_ID_ACCOUNT))
-//        param_list = qof_query_build_param_list (SPLIT_ACCOUNT, ACCOUNT_KVP, NULL);
-//    else
-//        PERR ("Invalid match type: %s", id_type);
-//
-//    qof_query_add_term (q, param_list, pred_data, op);
-//}
-//
-///*******************************************************************
-// *  xaccQueryGetEarliestDateFound
-// *******************************************************************/
-//
-//time64
-//xaccQueryGetEarliestDateFound(QofQuery * q)
-//{
-//    GList * spl;
-//    Split * sp;
-//    time64 earliest;
-//
-//    if (!q) return 0;
-//    spl = qof_query_last_run (q);
-//    if (!spl) return 0;
-//
-//    /* Safe until 2038 on archs where time64 is 32bit */
-//    sp = spl->data;
-//    earliest = sp->parent->date_posted.tv_sec;
-//    for (; spl; spl = spl->next)
-//    {
-//        sp = spl->data;
-//        if (sp->parent->date_posted.tv_sec < earliest)
-//        {
-//            earliest = sp->parent->date_posted.tv_sec;
-//        }
-//    }
-//    return earliest;
-//}
-//
-///*******************************************************************
-// *  xaccQueryGetLatestDateFound
-// *******************************************************************/
-//
-//time64
-//xaccQueryGetLatestDateFound(QofQuery * q)
-//{
-//    Split  * sp;
-//    GList  * spl;
-//    time64 latest = 0;
-//
-//    if (!q) return 0;
-//    spl = qof_query_last_run (q);
-//    if (!spl) return 0;
-//
-//    for (; spl; spl = spl->next)
-//    {
-//        sp = spl->data;
-//        if (sp->parent->date_posted.tv_sec > latest)
-//        {
-//            latest = sp->parent->date_posted.tv_sec;
-//        }
-//    }
-//    return latest;
-//}
-//
-//void
-//xaccQueryAddDescriptionMatch(QofQuery *q, const char *m, bool c, bool r,
-//                             QofQueryOp o)
-//{
-//    xaccQueryAddStringMatch ((q), (m), (c), (r), (o), SPLIT_TRANS,
-//                             TRANS_DESCRIPTION, NULL);
-//}
-//
-//void
-//xaccQueryAddNumberMatch(QofQuery *q, const char *m, bool c, bool r,
-//                        QofQueryOp o)
-//{
-//    xaccQueryAddStringMatch ((q), (m), (c), (r), (o), SPLIT_TRANS,
-//                             TRANS_NUM, NULL);
-//}
-//
-//void
-//xaccQueryAddActionMatch(QofQuery *q, const char *m, bool c, bool r,
-//                        QofQueryOp o)
-//{
-//    xaccQueryAddStringMatch ((q), (m), (c), (r), (o), SPLIT_ACTION, NULL);
-//}
-//
-//void
-//xaccQueryAddMemoMatch(QofQuery *q, const char *m, bool c, bool r,
-//                      QofQueryOp o)
-//{
-//    xaccQueryAddStringMatch ((q), (m), (c), (r), (o), SPLIT_MEMO, NULL);
-//}
-//
-//void
-//xaccQueryAddValueMatch(QofQuery *q, gnc_numeric amt, QofNumericMatch sgn,
-//                       QofQueryCompare how, QofQueryOp op)
-//{
-//    xaccQueryAddNumericMatch ((q), (amt), (sgn), (how), (op),
-//                              SPLIT_VALUE, NULL);
-//}
-//
-//void
-//xaccQueryAddSharePriceMatch(QofQuery *q, gnc_numeric amt, QofQueryCompare how,
-//                            QofQueryOp op)
-//{
-//    xaccQueryAddNumericMatch ((q), (amt), QOF_NUMERIC_MATCH_ANY, (how), (op),
-//                              SPLIT_SHARE_PRICE, NULL);
-//}
-//
-//void
-//xaccQueryAddSharesMatch(QofQuery *q, gnc_numeric amt, QofQueryCompare how,
-//                        QofQueryOp op)
-//{
-//    xaccQueryAddNumericMatch ((q), (amt), QOF_NUMERIC_MATCH_ANY, (how), (op),
-//                              SPLIT_AMOUNT, NULL);
-//}
-//
-//void
-//xaccQueryAddBalanceMatch(QofQuery *q, QofQueryCompare bal, QofQueryOp op)
-//{
-//    xaccQueryAddNumericMatch(
-//        (q), gnc_numeric_zero(), QOF_NUMERIC_MATCH_ANY,
-//        ((bal) ? QOF_COMPARE_EQUAL : QOF_COMPARE_NEQ), (op),
-//        SPLIT_TRANS, TRANS_IMBALANCE, NULL);
-//}
-//
-//
-///* ======================== END OF FILE ======================= */
+#include "config.h"
+
+#include <glib.h>
+#include <string.h>
+
+#include "Account.h"
+#include "Query.h"
+#include "Split.h"
+#include "Transaction.h"
+
+static QofLogModule log_module = GNC_MOD_QUERY;
+
+/********************************************************************
+ * xaccQueryGetSplitsUniqueTrans
+ * Get splits but no more than one from a given transaction.
+ ********************************************************************/
+
+SplitList_t
+xaccQueryGetSplitsUniqueTrans(QofQuery *q)
+{
+    GList       * splits = qof_query_run(q);
+    GList       * current;
+    SplitList_t   result;
+    GHashTable  * trans_hash = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+    for (current = splits; current; current = current->next)
+    {
+        Split *split = (Split *) current->data;
+        Transaction *trans = xaccSplitGetParent (split);
+
+        if (!g_hash_table_lookup (trans_hash, trans))
+        {
+            g_hash_table_insert (trans_hash, trans, trans);
+            result.push_back(split);
+        }
+    }
+
+    g_hash_table_destroy (trans_hash);
+
+    return result;
+}
+
+gint
+xaccQuerySplitOrder (gconstpointer a, gconstpointer b)
+{
+    return xaccSplitOrder ((const Split *) a, (const Split *) b);
+}
+
+static time64
+split_date (const Split *split)
+{
+    return xaccTransGetDate (xaccSplitGetParent (split));
+}
+
+/********************************************************************
+ * Date matches
+ ********************************************************************/
+
+typedef struct
+{
+    gboolean use_start;
+    time64   start;
+    gboolean use_end;
+    time64   end;
+} DateMatchData;
+
+static gboolean
+date_match (gconstpointer object, gconstpointer data)
+{
+    const DateMatchData *dmd = (const DateMatchData *) data;
+    time64 date = split_date ((const Split *) object);
+
+    if (dmd->use_start && date < dmd->start)
+        return FALSE;
+    if (dmd->use_end && date > dmd->end)
+        return FALSE;
+    return TRUE;
+}
+
+/* Narrow the range [*start, *end] to the date matches among and_terms,
+ * so that an index scanning splits in date order can skip the rest. */
+static void
+date_match_bounds (const GList *and_terms, gboolean *use_start, time64 *start,
+                   gboolean *use_end, time64 *end)
+{
+    const GList *node;
+
+    *use_start = FALSE;
+    *use_end = FALSE;
+    for (node = and_terms; node; node = node->next)
+    {
+        const QofQueryPredicate *pred = (const QofQueryPredicate *) node->data;
+        const DateMatchData *dmd;
+
+        /* Inverted date matches have no match function of their own. */
+        if (qof_query_predicate_get_match (pred) != date_match)
+            continue;
+
+        dmd = (const DateMatchData *) qof_query_predicate_get_data (pred);
+        if (dmd->use_start && (!*use_start || dmd->start > *start))
+        {
+            *use_start = TRUE;
+            *start = dmd->start;
+        }
+        if (dmd->use_end && (!*use_end || dmd->end < *end))
+        {
+            *use_end = TRUE;
+            *end = dmd->end;
+        }
+    }
+}
+
+void
+xaccQueryAddDateMatchTT (QofQuery * q,
+                         bool use_start, time64 stt,
+                         bool use_end, time64 ett,
+                         QofQueryOp op)
+{
+    DateMatchData *dmd;
+
+    g_return_if_fail (q);
+
+    dmd = g_new0 (DateMatchData, 1);
+    dmd->use_start = use_start;
+    dmd->start = stt;
+    dmd->use_end = use_end;
+    dmd->end = ett;
+    qof_query_add_term (q, qof_query_predicate_new (date_match, dmd, g_free, NULL),
+                        op);
+}
+
+/********************************************************************
+ * Walking account splits in order
+ ********************************************************************/
+
+/* Visit the splits of n accounts in the order xaccSplitOrder gives
+ * them, merging the accounts' lists, within the date range.  cur and
+ * end run forward or backward over each account's splits; direction
+ * is 1 or -1 to match. */
+template<typename Iter>
+static void
+scan_account_splits (Iter *cur, Iter *end, guint n, gint direction,
+                     gboolean use_start, time64 start,
+                     gboolean use_end, time64 stop,
+                     QofQueryVisitFunc visit, gpointer user_data)
+{
+    while (TRUE)
+    {
+        Split *next = NULL;
+        guint which = 0;
+        guint i;
+        time64 date;
+
+        for (i = 0; i < n; i++)
+        {
+            if (cur[i] == end[i])
+                continue;
+            if (!next || direction * xaccSplitOrder (*cur[i], next) < 0)
+            {
+                next = *cur[i];
+                which = i;
+            }
+        }
+        if (!next)
+            return;
+        cur[which]++;
+
+        date = split_date (next);
+        if (direction > 0)
+        {
+            if (use_end && date > stop)
+                return;
+            if (use_start && date < start)
+                continue;
+        }
+        else
+        {
+            if (use_start && date < start)
+                return;
+            if (use_end && date > stop)
+                continue;
+        }
+
+        if (!visit (next, user_data))
+            return;
+    }
+}
+
+static void
+scan_accounts (Account **accounts, guint n, const GList *and_terms,
+               gboolean reverse, QofQueryVisitFunc visit, gpointer user_data)
+{
+    gboolean use_start, use_end;
+    time64 start = 0, stop = 0;
+    guint i;
+
+    date_match_bounds (and_terms, &use_start, &start, &use_end, &stop);
+
+    if (reverse)
+    {
+        SplitList_t::const_reverse_iterator *cur =
+            new SplitList_t::const_reverse_iterator[n];
+        SplitList_t::const_reverse_iterator *end =
+            new SplitList_t::const_reverse_iterator[n];
+
+        for (i = 0; i < n; i++)
+        {
+            const SplitList_t &splits = xaccAccountGetSplitListRef (accounts[i]);
+            cur[i] = splits.rbegin ();
+            end[i] = splits.rend ();
+        }
+        scan_account_splits (cur, end, n, -1, use_start, start, use_end, stop,
+                             visit, user_data);
+        delete [] cur;
+        delete [] end;
+    }
+    else
+    {
+        SplitList_t::const_iterator *cur = new SplitList_t::const_iterator[n];
+        SplitList_t::const_iterator *end = new SplitList_t::const_iterator[n];
+
+        for (i = 0; i < n; i++)
+        {
+            const SplitList_t &splits = xaccAccountGetSplitListRef (accounts[i]);
+            cur[i] = splits.begin ();
+            end[i] = splits.end ();
+        }
+        scan_account_splits (cur, end, n, 1, use_start, start, use_end, stop,
+                             visit, user_data);
+        delete [] cur;
+        delete [] end;
+    }
+}
+
+/********************************************************************
+ * Account matches
+ ********************************************************************/
+
+typedef struct
+{
+    GHashTable *set;        /* Account* -> Account* */
+    Account   **accounts;   /* the same accounts, once each */
+    guint       n_accounts;
+} AccountMatchData;
+
+static void
+account_match_free (gpointer data)
+{
+    AccountMatchData *amd = (AccountMatchData *) data;
+
+    g_hash_table_destroy (amd->set);
+    g_free (amd->accounts);
+    g_free (amd);
+}
+
+static gboolean
+account_match_any (gconstpointer object, gconstpointer data)
+{
+    const AccountMatchData *amd = (const AccountMatchData *) data;
+
+    return g_hash_table_lookup (amd->set,
+                                xaccSplitGetAccount ((const Split *) object))
+           != NULL;
+}
+
+static gboolean
+account_match_none (gconstpointer object, gconstpointer data)
+{
+    return !account_match_any (object, data);
+}
+
+static gsize
+account_index_estimate (QofBook *book, gconstpointer data)
+{
+    const AccountMatchData *amd = (const AccountMatchData *) data;
+    gsize n = 0;
+    guint i;
+
+    for (i = 0; i < amd->n_accounts; i++)
+        n += xaccAccountGetSplitListRef (amd->accounts[i]).size ();
+    return n;
+}
+
+static void
+account_index_scan (QofBook *book, gconstpointer data, const GList *and_terms,
+                    gboolean reverse, QofQueryVisitFunc visit,
+                    gpointer user_data)
+{
+    const AccountMatchData *amd = (const AccountMatchData *) data;
+
+    scan_accounts (amd->accounts, amd->n_accounts, and_terms, reverse,
+                   visit, user_data);
+}
+
+static const QofQueryIndex account_index =
+{
+    account_index_estimate,
+    account_index_scan,
+    xaccQuerySplitOrder
+};
+
+void
+xaccQueryAddAccountMatch (QofQuery *q, const AccountList_t & acct_list,
+                          QofGuidMatch how, QofQueryOp op)
+{
+    AccountMatchData *amd;
+    QofQueryPredicate *pred;
+
+    g_return_if_fail (q);
+
+    amd = g_new0 (AccountMatchData, 1);
+    amd->set = g_hash_table_new (g_direct_hash, g_direct_equal);
+    amd->accounts = g_new0 (Account *, acct_list.size () + 1);
+    for (AccountList_t::const_iterator it = acct_list.begin();
+            it != acct_list.end(); it++)
+    {
+        Account *acc = *it;
+
+        if (!acc)
+        {
+            PWARN ("acct_list has NULL account");
+            continue;
+        }
+        if (g_hash_table_lookup (amd->set, acc))
+            continue;
+        g_hash_table_insert (amd->set, acc, acc);
+        amd->accounts[amd->n_accounts++] = acc;
+    }
+
+    switch (how)
+    {
+    case QOF_GUID_MATCH_ANY:
+        pred = qof_query_predicate_new (account_match_any, amd,
+                                        account_match_free, &account_index);
+        break;
+    case QOF_GUID_MATCH_NONE:
+        pred = qof_query_predicate_new (account_match_none, amd,
+                                        account_match_free, NULL);
+        break;
+    default:
+        PERR ("invalid match type: %d", how);
+        account_match_free (amd);
+        return;
+    }
+
+    qof_query_add_term (q, pred, op);
+}
+
+void
+xaccQueryAddSingleAccountMatch (QofQuery *q, Account *acc, QofQueryOp op)
+{
+    AccountList_t acct_list;
+
+    if (!q || !acc)
+        return;
+
+    acct_list.push_back (acc);
+    xaccQueryAddAccountMatch (q, acct_list, QOF_GUID_MATCH_ANY, op);
+}
+
+/********************************************************************
+ * GUID matches
+ ********************************************************************/
+
+static gboolean
+trans_guid_match (gconstpointer object, gconstpointer data)
+{
+    Transaction *trans = xaccSplitGetParent ((const Split *) object);
+
+    return trans && guid_equal (qof_instance_get_guid (trans),
+                                (const GncGUID *) data);
+}
+
+static gsize
+trans_index_estimate (QofBook *book, gconstpointer data)
+{
+    Transaction *trans = xaccTransLookup ((const GncGUID *) data, book);
+
+    return trans ? xaccTransCountSplits (trans) : 0;
+}
+
+static void
+trans_index_scan (QofBook *book, gconstpointer data, const GList *and_terms,
+                  gboolean reverse, QofQueryVisitFunc visit, gpointer user_data)
+{
+    Transaction *trans = xaccTransLookup ((const GncGUID *) data, book);
+    SplitList_t splits;
+
+    if (!trans)
+        return;
+
+    splits = xaccTransGetSplitList (trans);
+    for (SplitList_t::const_iterator it = splits.begin();
+            it != splits.end(); it++)
+    {
+        if (!visit (*it, user_data))
+            return;
+    }
+}
+
+static const QofQueryIndex trans_index =
+{
+    trans_index_estimate,
+    trans_index_scan,
+    NULL
+};
+
+static gboolean
+account_guid_match (gconstpointer object, gconstpointer data)
+{
+    Account *acc = xaccSplitGetAccount ((const Split *) object);
+
+    return acc && guid_equal (qof_instance_get_guid (acc),
+                              (const GncGUID *) data);
+}
+
+static gsize
+account_guid_index_estimate (QofBook *book, gconstpointer data)
+{
+    Account *acc = xaccAccountLookup ((const GncGUID *) data, book);
+
+    return xaccAccountGetSplitListRef (acc).size ();
+}
+
+static void
+account_guid_index_scan (QofBook *book, gconstpointer data,
+                         const GList *and_terms, gboolean reverse,
+                         QofQueryVisitFunc visit, gpointer user_data)
+{
+    Account *acc = xaccAccountLookup ((const GncGUID *) data, book);
+
+    if (acc)
+        scan_accounts (&acc, 1, and_terms, reverse, visit, user_data);
+}
+
+static const QofQueryIndex account_guid_index =
+{
+    account_guid_index_estimate,
+    account_guid_index_scan,
+    xaccQuerySplitOrder
+};
+
+void
+xaccQueryAddGUIDMatch (QofQuery * q, const GncGUID *guid,
+                       QofIdType id_type, QofQueryOp op)
+{
+    QofQueryPredicate *pred;
+
+    if (!q || !guid || !id_type)
+        return;
+
+    if (!g_strcmp0 (id_type, GNC_ID_SPLIT))
+        pred = qof_query_guid_predicate_new (GNC_ID_SPLIT, guid);
+    else if (!g_strcmp0 (id_type, GNC_ID_TRANS))
+        pred = qof_query_predicate_new (trans_guid_match, guid_copy (guid),
+                                        (GDestroyNotify) guid_free,
+                                        &trans_index);
+    else if (!g_strcmp0 (id_type, GNC_ID_ACCOUNT))
+        pred = qof_query_predicate_new (account_guid_match, guid_copy (guid),
+                                        (GDestroyNotify) guid_free,
+                                        &account_guid_index);
+    else
+    {
+        PERR ("Invalid match type: %s", id_type);
+        return;
+    }
+
+    qof_query_add_term (q, pred, op);
+}
+
+/********************************************************************
+ * Cleared and description matches
+ ********************************************************************/
+
+static gboolean
+cleared_match (gconstpointer object, gconstpointer data)
+{
+    cleared_match_t how = (cleared_match_t) GPOINTER_TO_INT (data);
+
+    switch (xaccSplitGetReconcile ((const Split *) object))
+    {
+    case NREC:
+        return (how & CLEARED_NO) != 0;
+    case CREC:
+        return (how & CLEARED_CLEARED) != 0;
+    case YREC:
+        return (how & CLEARED_RECONCILED) != 0;
+    case FREC:
+        return (how & CLEARED_FROZEN) != 0;
+    case VREC:
+        return (how & CLEARED_VOIDED) != 0;
+    default:
+        return FALSE;
+    }
+}
+
+void
+xaccQueryAddClearedMatch (QofQuery * q, cleared_match_t how, QofQueryOp op)
+{
+    if (!q)
+        return;
+
+    qof_query_add_term (q, qof_query_predicate_new (cleared_match,
+                        GINT_TO_POINTER (how), NULL, NULL), op);
+}
+
+typedef struct
+{
+    char     *match;       /* casefolded unless case_sens */
+    gboolean  case_sens;
+} StringMatchData;
+
+static void
+string_match_free (gpointer data)
+{
+    StringMatchData *smd = (StringMatchData *) data;
+
+    g_free (smd->match);
+    g_free (smd);
+}
+
+static gboolean
+description_match (gconstpointer object, gconstpointer data)
+{
+    const StringMatchData *smd = (const StringMatchData *) data;
+    const char *desc = xaccTransGetDescription (
+                           xaccSplitGetParent ((const Split *) object));
+    gboolean found;
+    char *folded;
+
+    if (!desc)
+        return FALSE;
+    if (smd->case_sens)
+        return strstr (desc, smd->match) != NULL;
+
+    folded = g_utf8_casefold (desc, -1);
+    found = strstr (folded, smd->match) != NULL;
+    g_free (folded);
+    return found;
+}
+
+void
+xaccQueryAddDescriptionMatch (QofQuery *q, const char *m, bool c,
+                              QofQueryOp o)
+{
+    StringMatchData *smd;
+
+    if (!q || !m)
+        return;
+
+    smd = g_new0 (StringMatchData, 1);
+    smd->case_sens = c;
+    smd->match = c ? g_strdup (m) : g_utf8_casefold (m, -1);
+    qof_query_add_term (q, qof_query_predicate_new (description_match, smd,
+                        string_match_free, NULL), o);
+}
+
+/* ======================== END OF FILE ======================== */
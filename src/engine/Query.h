@@ -36,8 +36,8 @@
  * others do not.
  */
 
-//typedef QofQuery Query;
-//
+typedef QofQuery Query;
+
 //typedef enum
 //{
 //    QUERY_TXN_MATCH_ALL = 1, /* match all accounts */
@@ -54,14 +54,13 @@
 // *    The caller MUST NOT change the GList.
 // */
 //
-///**
-// * The xaccQueryGetSplitsUniqueTrans() routine returns splits matching
-// *    the query, but only one matching split per transaction will be
-// *    returned.  In other words, any given transaction will be
-// *    represented at most once in the returned list.  The caller must
-// *    free the GList.
-// */
-//SplitList_t xaccQueryGetSplitsUniqueTrans(QofQuery *q);
+/**
+ * The xaccQueryGetSplitsUniqueTrans() routine returns splits matching
+ *    the query, but only one matching split per transaction will be
+ *    returned.  In other words, any given transaction will be
+ *    represented at most once in the returned list.
+ */
+SplitList_t xaccQueryGetSplitsUniqueTrans(QofQuery *q);
 //
 ///**
 // * The xaccQueryGetTransactions() routine returns a list of
@@ -97,21 +96,32 @@
 // *  match-adding API
 // *******************************************************************/
 //
-//void xaccQueryAddAccountMatch(QofQuery *, const AccountList_t &,
-//                              QofGuidMatch how, QofQueryOp op);
-//
+/** Splits sort in the order xaccSplitOrder() gives them, which is
+ *  the order each account keeps its splits in.  A split query sorted
+ *  with this function and limited with qof_query_set_max_results()
+ *  stops as soon as it has found the last splits of the account
+ *  match, instead of examining every split in the book. */
+gint xaccQuerySplitOrder (gconstpointer a, gconstpointer b);
+
+/** Match the splits in any (QOF_GUID_MATCH_ANY) or none
+ *  (QOF_GUID_MATCH_NONE) of the accounts.  Matching any of them, the
+ *  query only visits the splits of those accounts. */
+void xaccQueryAddAccountMatch(QofQuery *, const AccountList_t &,
+                              QofGuidMatch how, QofQueryOp op);
+
 //void xaccQueryAddAccountGUIDMatch(QofQuery *, AccountGUIDList *,
 //                                  QofGuidMatch, QofQueryOp);
 //
-//void xaccQueryAddSingleAccountMatch(QofQuery *, Account *, QofQueryOp);
+void xaccQueryAddSingleAccountMatch(QofQuery *, Account *, QofQueryOp);
 //
 //void xaccQueryAddStringMatch (QofQuery* q, const char *matchstring,
 //                              bool case_sens, bool use_regexp,
 //                              QofQueryOp op,
 //                              const char * path, ...);
-//void
-//xaccQueryAddDescriptionMatch(QofQuery *q, const char *m, bool c, bool r,
-//                             QofQueryOp o);
+/** Match the splits whose transaction's description contains m,
+ *  ignoring case unless c is TRUE. */
+void
+xaccQueryAddDescriptionMatch(QofQuery *q, const char *m, bool c, QofQueryOp o);
 //void
 //xaccQueryAddNumberMatch(QofQuery *q, const char *m, bool c, bool r,
 //                        QofQueryOp o);
@@ -137,15 +147,17 @@
 //                               QofNumericMatch sign, QofQueryCompare how,
 //                               QofQueryOp op, const char * path, ...);
 //
-///** The DateMatch queries match transactions whose posted date
-// *    is in a date range.  If use_start is TRUE, then a matching
-// *    posted date will be greater than the start date.   If
-// *    use_end is TRUE, then a match occurs for posted dates earlier
-// *    than the end date.  If both flags are set, then *both*
-// *    conditions must hold ('and').  If neither flag is set, then
-// *    all transactions are matched.
-// */
-//
+/** The DateMatch queries match transactions whose posted date
+ *    is in a date range.  If use_start is TRUE, then a matching
+ *    posted date will be greater than the start date.   If
+ *    use_end is TRUE, then a match occurs for posted dates earlier
+ *    than the end date.  If both flags are set, then *both*
+ *    conditions must hold ('and').  If neither flag is set, then
+ *    all transactions are matched.  Both ends of the range are
+ *    included.  An account match in the same term only visits the
+ *    account's splits in the range.
+ */
+
 //void xaccQueryAddDateMatch(QofQuery * q, bool use_start,
 //                           int sday, int smonth, int syear,
 //                           bool use_end, int eday, int emonth, int eyear,
@@ -154,10 +166,10 @@
 //                             bool use_start, Timespec sts,
 //                             bool use_end, Timespec ets,
 //                             QofQueryOp op);
-//void xaccQueryAddDateMatchTT(QofQuery * q,
-//                             bool use_start, time64 stt,
-//                             bool use_end, time64 ett,
-//                             QofQueryOp op);
+void xaccQueryAddDateMatchTT(QofQuery * q,
+                             bool use_start, time64 stt,
+                             bool use_end, time64 ett,
+                             QofQueryOp op);
 //void xaccQueryGetDateMatchTS (QofQuery * q,
 //                              Timespec * sts,
 //                              Timespec * ets);
@@ -176,9 +188,12 @@ typedef enum
     CLEARED_ALL        = 0x001F
 } cleared_match_t;
 //
-//void xaccQueryAddClearedMatch(QofQuery * q, cleared_match_t how, QofQueryOp op);
-//void xaccQueryAddGUIDMatch(QofQuery * q, const GncGUID *guid,
-//                           QofIdType id_type, QofQueryOp op);
+void xaccQueryAddClearedMatch(QofQuery * q, cleared_match_t how, QofQueryOp op);
+
+/** Match the split with the given guid, or the splits of the
+ *  transaction or account with it, according to id_type. */
+void xaccQueryAddGUIDMatch(QofQuery * q, const GncGUID *guid,
+                           QofIdType id_type, QofQueryOp op);
 //
 ///** given kvp value is on right side of comparison */
 //void xaccQueryAddKVPMatch(QofQuery *q, GSList *path, const KvpValue *value,
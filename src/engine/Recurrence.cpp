@@ -173,6 +173,54 @@ nth_weekday_compare(const GDate *start, const GDate *next, PeriodType pt)
 }
 
 
+/* Move 'date', which is in the right month, to the day of that month
+   on which the recurrence falls, and then off the weekend if the
+   recurrence asks for that. */
+static void
+align_in_month(const Recurrence *r, GDate *date)
+{
+    PeriodType pt = r->ptype;
+    guint dim;
+
+    dim = g_date_get_days_in_month(g_date_get_month(date),
+                                   g_date_get_year(date));
+    if (pt == PERIOD_LAST_WEEKDAY || pt == PERIOD_NTH_WEEKDAY)
+    {
+        gint wdresult = nth_weekday_compare(&r->start, date, pt);
+        if (wdresult < 0)
+        {
+            wdresult = -wdresult;
+            g_date_subtract_days(date, wdresult);
+        }
+        else
+            g_date_add_days(date, wdresult);
+    }
+    else if (pt == PERIOD_END_OF_MONTH || g_date_get_day(&r->start) >= dim)
+        g_date_set_day(date, dim);  /* last day in the month */
+    else
+        g_date_set_day(date, g_date_get_day(&r->start)); /*same day as start*/
+
+    /* Adjust for dates on the weekend. */
+    if (pt == PERIOD_YEAR || pt == PERIOD_MONTH || pt == PERIOD_END_OF_MONTH)
+    {
+        if (g_date_get_weekday(date) == G_DATE_SATURDAY || g_date_get_weekday(date) == G_DATE_SUNDAY)
+        {
+            switch (r->wadj)
+            {
+            case WEEKEND_ADJ_BACK:
+                g_date_subtract_days(date, g_date_get_weekday(date) == G_DATE_SATURDAY ? 1 : 2);
+                break;
+            case WEEKEND_ADJ_FORWARD:
+                g_date_add_days(date, g_date_get_weekday(date) == G_DATE_SATURDAY ? 2 : 1);
+                break;
+            case WEEKEND_ADJ_NONE:
+            default:
+                break;
+            }
+        }
+    }
+}
+
 /* This is the only real algorithm related to recurrences.  It goes:
    Step 1) Go forward one period from the reference date.
    Step 2) Back up to align to the phase of the start date.
@@ -183,7 +231,6 @@ recurrenceNextInstance(const Recurrence *r, const GDate *ref, GDate *next)
     PeriodType pt;
     const GDate *start;
     guint mult;
-    WeekendAdjust wadj;
 
     g_return_if_fail(r);
     g_return_if_fail(ref);
@@ -203,7 +250,6 @@ recurrenceNextInstance(const Recurrence *r, const GDate *ref, GDate *next)
     /* Step 1: move FORWARD one period, passing exactly one occurrence. */
     mult = r->mult;
     pt = r->ptype;
-    wadj = r->wadj;
     switch (pt)
     {
     case PERIOD_YEAR:
@@ -314,52 +360,14 @@ recurrenceNextInstance(const Recurrence *r, const GDate *ref, GDate *next)
     case PERIOD_LAST_WEEKDAY:
     case PERIOD_END_OF_MONTH:
     {
-        guint dim, n_months;
+        guint n_months;
 
         n_months = 12 * (g_date_get_year(next) - g_date_get_year(start)) +
                    (g_date_get_month(next) - g_date_get_month(start));
         g_date_subtract_months(next, n_months % mult);
 
-        /* Ok, now we're in the right month, so we just have to align
-           the day in one of the three possible ways. */
-        dim = g_date_get_days_in_month(g_date_get_month(next),
-                                       g_date_get_year(next));
-        if (pt == PERIOD_LAST_WEEKDAY || pt == PERIOD_NTH_WEEKDAY)
-        {
-            gint wdresult = nth_weekday_compare(start, next, pt);
-            if (wdresult < 0)
-            {
-                wdresult = -wdresult;
-                g_date_subtract_days(next, wdresult);
-            }
-            else
-                g_date_add_days(next, wdresult);
-        }
-        else if (pt == PERIOD_END_OF_MONTH || g_date_get_day(start) >= dim)
-            g_date_set_day(next, dim);  /* last day in the month */
-        else
-            g_date_set_day(next, g_date_get_day(start)); /*same day as start*/
-
-        /* Adjust for dates on the weekend. */
-        if (pt == PERIOD_YEAR || pt == PERIOD_MONTH || pt == PERIOD_END_OF_MONTH)
-        {
-            if (g_date_get_weekday(next) == G_DATE_SATURDAY || g_date_get_weekday(next) == G_DATE_SUNDAY)
-            {
-                switch (wadj)
-                {
-                case WEEKEND_ADJ_BACK:
-                    g_date_subtract_days(next, g_date_get_weekday(next) == G_DATE_SATURDAY ? 1 : 2);
-                    break;
-                case WEEKEND_ADJ_FORWARD:
-                    g_date_add_days(next, g_date_get_weekday(next) == G_DATE_SATURDAY ? 2 : 1);
-                    break;
-                case WEEKEND_ADJ_NONE:
-                default:
-                    break;
-                }
-            }
-        }
-
+        /* Ok, now we're in the right month. */
+        align_in_month(r, next);
     }
     break;
     case PERIOD_WEEK:
@@ -372,18 +380,146 @@ recurrenceNextInstance(const Recurrence *r, const GDate *ref, GDate *next)
     }
 }
 
+/* Closed form of the sequence recurrenceNextInstance() steps through
+   when it is fed its own results, starting from the start date: the
+   month-based types have their nth occurrence in the (n * mult)th
+   month after the start, the others n * mult days or weeks after it. */
+static void
+nth_instance_date(const Recurrence *r, guint n, GDate *date)
+{
+    *date = r->start;
+    if (n == 0)
+        return;
+
+    switch (r->ptype)
+    {
+    case PERIOD_YEAR:
+    case PERIOD_MONTH:
+    case PERIOD_NTH_WEEKDAY:
+    case PERIOD_LAST_WEEKDAY:
+    case PERIOD_END_OF_MONTH:
+        g_date_set_day(date, 1);
+        g_date_add_months(date, n * r->mult * (r->ptype == PERIOD_YEAR ? 12 : 1));
+        align_in_month(r, date);
+        break;
+    case PERIOD_WEEK:
+        g_date_add_days(date, n * r->mult * 7);
+        break;
+    case PERIOD_DAY:
+        g_date_add_days(date, n * r->mult);
+        break;
+    case PERIOD_ONCE:
+        g_date_clear(date, 1);
+        break;
+    default:
+        PERR("Invalid period type");
+        break;
+    }
+}
+
 /* Zero-based index */
 void
 recurrenceNthInstance(const Recurrence *r, guint n, GDate *date)
 {
-    GDate ref;
-    guint i;
+    g_return_if_fail(r);
+    g_return_if_fail(date);
+
+    nth_instance_date(r, n, date);
+}
+
+guint
+recurrenceCountInstances(const Recurrence *r, const GDate *date)
+{
+    GDate occ;
+    guint n, period;
+    gint months;
 
-    for (*date = ref = r->start, i = 0; i < n; i++)
+    g_return_val_if_fail(r, 0);
+    g_return_val_if_fail(date && g_date_valid(date), 0);
+
+    if (g_date_compare(date, &r->start) < 0)
+        return 0;
+
+    switch (r->ptype)
     {
-        recurrenceNextInstance(r, &ref, date);
-        ref = *date;
+    case PERIOD_ONCE:
+        return 1;
+    case PERIOD_WEEK:
+    case PERIOD_DAY:
+        period = r->mult * (r->ptype == PERIOD_WEEK ? 7 : 1);
+        return g_date_days_between(&r->start, date) / period + 1;
+    case PERIOD_YEAR:
+    case PERIOD_MONTH:
+    case PERIOD_NTH_WEEKDAY:
+    case PERIOD_LAST_WEEKDAY:
+    case PERIOD_END_OF_MONTH:
+        period = r->mult * (r->ptype == PERIOD_YEAR ? 12 : 1);
+        months = 12 * (g_date_get_year(date) - g_date_get_year(&r->start)) +
+                 (g_date_get_month(date) - g_date_get_month(&r->start));
+        n = months / period;
+
+        /* n is the occurrence in date's month or the last one before
+           it.  A weekend adjustment moves an occurrence by at most two
+           days, possibly across the end of a month, so correct by
+           checking the neighbours. */
+        nth_instance_date(r, n + 1, &occ);
+        while (g_date_compare(&occ, date) <= 0)
+            nth_instance_date(r, ++n + 1, &occ);
+        nth_instance_date(r, n, &occ);
+        while (n > 0 && g_date_compare(&occ, date) > 0)
+            nth_instance_date(r, --n, &occ);
+        return n + 1;
+    default:
+        PERR("Invalid period type");
+        return 0;
+    }
+}
+
+static bool
+gdate_less(const GDate &a, const GDate &b)
+{
+    return g_date_compare(&a, &b) < 0;
+}
+
+static bool
+gdate_equal(const GDate &a, const GDate &b)
+{
+    return g_date_compare(&a, &b) == 0;
+}
+
+void
+recurrenceListGetInstancesInRange(const RecurrenceList_t &rlist,
+                                  const GDate *start, const GDate *end,
+                                  std::list<GDate> &dates)
+{
+    std::list<GDate> found;
+    GDate before, occ;
+
+    g_return_if_fail(start && g_date_valid(start));
+    g_return_if_fail(end && g_date_valid(end));
+
+    if (g_date_compare(start, end) > 0)
+        return;
+
+    before = *start;
+    g_date_subtract_days(&before, 1);
+
+    for (RecurrenceList_t::const_iterator iter = rlist.begin(); iter != rlist.end(); iter++)
+    {
+        const Recurrence *r = *iter;
+        guint n = recurrenceCountInstances(r, &before);
+
+        for (nth_instance_date(r, n, &occ);
+                g_date_valid(&occ) && g_date_compare(&occ, end) <= 0;
+                nth_instance_date(r, ++n, &occ))
+        {
+            found.push_back(occ);
+        }
     }
+
+    found.sort(gdate_less);
+    found.unique(gdate_equal);
+    dates.splice(dates.end(), found);
 }
 
 time64
@@ -134,9 +134,26 @@ WeekendAdjust recurrenceGetWeekendAdjust(const Recurrence *r);
 void recurrenceNextInstance(const Recurrence *r, const GDate *refDate,
                             GDate *nextDate);
 
-/* Zero-based.  n == 1 gets the instance after the start date. */
+/* Zero-based.  n == 1 gets the instance after the start date.  The
+   date is computed directly, without stepping through the earlier
+   instances. */
 void recurrenceNthInstance(const Recurrence *r, unsigned int n, GDate *date);
 
+/* Get the number of instances on or before 'date', i.e. the
+   zero-based index of the first instance after it.  Computed
+   directly, so it costs the same whatever the distance from the start
+   date. */
+unsigned int recurrenceCountInstances(const Recurrence *r, const GDate *date);
+
+/* Append to 'dates', in order, every date between 'start' and 'end'
+   (inclusive) on which one of the recurrences falls; a date several
+   of them fall on is added once.  The work done is proportional to
+   the number of dates found, not to the distance from the start dates
+   of the recurrences. */
+void recurrenceListGetInstancesInRange(const RecurrenceList_t &rlist,
+                                       const GDate *start, const GDate *end,
+                                       std::list<GDate> &dates);
+
 /* Get a time coresponding to the beginning (or end if 'end' is true)
    of the nth instance of the recurrence. Also zero-based. */
 time64 recurrenceGetPeriodTime(const Recurrence *r, unsigned int n, bool end);
@@ -49,8 +49,11 @@ SchedXaction::SchedXaction()
     g_date_clear( &this->start_date, 1 );
     g_date_clear( &this->end_date, 1 );
 
+    this->name = NULL;
     this->enabled = 1;
     this->num_occurances_total = 0;
+    this->num_occurances_remain = 0;
+    this->template_acct = NULL;
     this->autoCreateOption = false;
     this->autoCreateNotify = false;
     this->advanceCreateDays = 0;
@@ -394,21 +397,15 @@ xaccSchedXactionSetRemOccur(SchedXaction *sx, int num_remain)
     }
 }
 
-int gnc_sx_get_num_occur_daterange(const SchedXaction *sx, const GDate* start_date, const GDate* end_date)
+/* Count the occurrences by stepping through them one at a time from
+ * the last one, as gnc_sx_incr_temporal_state would. */
+static int
+num_occur_daterange_stepwise(const SchedXaction *sx, const GDate* start_date, const GDate* end_date)
 {
     int result = 0;
     SXTmpStateData *tmpState;
     bool countFirstDate;
 
-    /* SX still active? If not, return now. */
-    if ((xaccSchedXactionHasOccurDef(sx)
-            && xaccSchedXactionGetRemOccur(sx) <= 0)
-            || (xaccSchedXactionHasEndDate(sx)
-                && g_date_compare(xaccSchedXactionGetEndDate(sx), start_date) < 0))
-    {
-        return result;
-    }
-
     tmpState = gnc_sx_create_temporal_state (sx);
 
     /* Should we count the first valid date we encounter? Only if the
@@ -469,6 +466,76 @@ int gnc_sx_get_num_occur_daterange(const SchedXaction *sx, const GDate* start_da
     return result;
 }
 
+int gnc_sx_get_num_occur_daterange(const SchedXaction *sx, const GDate* start_date, const GDate* end_date)
+{
+    const Recurrence *r;
+    GDate ref, first, before, last;
+    guint first_n, before_n, from_n, last_n, skipped, count;
+
+    /* SX still active? If not, return now. */
+    if ((xaccSchedXactionHasOccurDef(sx)
+            && xaccSchedXactionGetRemOccur(sx) <= 0)
+            || (xaccSchedXactionHasEndDate(sx)
+                && g_date_compare(xaccSchedXactionGetEndDate(sx), start_date) < 0))
+    {
+        return 0;
+    }
+
+    /* Several recurrences can fall on the same day, which only counts
+     * once; leave those schedules to the step by step count. */
+    if (sx->schedule.size() != 1)
+        return num_occur_daterange_stepwise(sx, start_date, end_date);
+    r = sx->schedule.front();
+
+    /* The first occurrence after the last one, found as
+     * xaccSchedXactionGetInstanceAfter does. */
+    if (g_date_valid(&sx->last_date))
+    {
+        ref = sx->last_date;
+    }
+    else
+    {
+        ref = sx->start_date;
+        g_date_subtract_days(&ref, 1);
+    }
+    recurrenceListNextInstance(sx->schedule, &ref, &first);
+    if (!g_date_valid(&first))
+        return 0;
+
+    last = *end_date;
+    if (xaccSchedXactionHasEndDate(sx)
+            && g_date_compare(xaccSchedXactionGetEndDate(sx), &last) < 0)
+        last = *xaccSchedXactionGetEndDate(sx);
+    if (g_date_compare(&first, &last) > 0)
+        return 0;
+
+    /* Every later occurrence follows the recurrence's own sequence, so
+     * the rest is counted by index: first_n is the index of the first
+     * occurrence, before_n of the first one in the range and last_n of
+     * the first one after it. */
+    before = *start_date;
+    g_date_subtract_days(&before, 1);
+    first_n = recurrenceCountInstances(r, &first) - 1;
+    before_n = recurrenceCountInstances(r, &before);
+    last_n = recurrenceCountInstances(r, &last);
+
+    from_n = MAX(first_n, before_n);
+    count = last_n > from_n ? last_n - from_n : 0;
+
+    /* Occurrences before the range use up the remaining ones too. */
+    if (xaccSchedXactionHasOccurDef(sx))
+    {
+        guint remaining = xaccSchedXactionGetRemOccur(sx);
+
+        skipped = before_n > first_n ? before_n - first_n : 0;
+        if (remaining <= skipped)
+            return 0;
+        count = MIN(count, remaining - skipped);
+    }
+
+    return count;
+}
+
 bool
 xaccSchedXactionGetEnabled( const SchedXaction *sx )
 {
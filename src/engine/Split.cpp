@@ -81,11 +81,17 @@ Split::Split()
 
     this->gains = GAINS_STATUS_UNKNOWN;
     this->gains_split = NULL;
+
+    this->sort_key        = NULL;
+    this->sort_key_memo   = NULL;
+    this->sort_key_action = NULL;
+    this->sort_action_num = 0;
 }
 
 Split::~Split()
 {
     //TODO
+    g_free(this->sort_key);
 }
 
 /********************************************************************\
@@ -110,6 +116,7 @@ xaccSplitReinit(Split * split)
 
     CACHE_REPLACE(split->action, "");
     CACHE_REPLACE(split->memo, "");
+    xaccSplitInvalidateSortKey(split);
     split->reconciled  = NREC;
     split->amount      = gnc_numeric_zero();
     split->value       = gnc_numeric_zero();
@@ -303,6 +310,7 @@ xaccFreeSplit (Split *split)
     }
     CACHE_REMOVE(split->memo);
     CACHE_REMOVE(split->action);
+    xaccSplitInvalidateSortKey(split);
 
     /* Just in case someone looks up freed memory ... */
     split->memo        = (char *) 1;
@@ -1085,41 +1093,105 @@ xaccSplitDestroy (Split *split)
 /********************************************************************\
 \********************************************************************/
 
+void
+xaccSplitInvalidateSortKey (Split *split)
+{
+    if (!split) return;
+    g_free (split->sort_key);
+    split->sort_key = NULL;
+    split->sort_key_memo = NULL;
+    split->sort_key_action = NULL;
+}
+
+/* Returns the packed memo and action collation keys of the split,
+ * rebuilding them if the memo or action changed since they were made.
+ * The action key starts just past the NUL terminating the memo key. */
+static const char *
+split_get_sort_key (const Split *s)
+{
+    Split *split = (Split *) s;
+    const char *memo, *action;
+    char *mkey, *akey;
+    size_t mlen, alen;
+
+    if (split->sort_key && split->sort_key_memo == split->memo &&
+            split->sort_key_action == split->action)
+        return split->sort_key;
+
+    g_free (split->sort_key);
+    memo = split->memo ? split->memo : "";
+    action = split->action ? split->action : "";
+    mkey = g_utf8_collate_key (memo, -1);
+    akey = g_utf8_collate_key (action, -1);
+    mlen = strlen (mkey);
+    alen = strlen (akey);
+
+    split->sort_key = g_new (char, mlen + alen + 2);
+    memcpy (split->sort_key, mkey, mlen + 1);
+    memcpy (split->sort_key + mlen + 1, akey, alen + 1);
+    g_free (mkey);
+    g_free (akey);
+
+    split->sort_key_memo = split->memo;
+    split->sort_key_action = split->action;
+    split->sort_action_num = split->action ? atoi (split->action) : 0;
+    return split->sort_key;
+}
+
 gint
 xaccSplitOrder (const Split *sa, const Split *sb)
+{
+    if (sa == sb) return 0;
+    /* nothing is always less than something */
+    if (!sa) return -1;
+    if (!sb) return +1;
+
+    /* sort in transaction order, but use split action rather than trans num
+     * according to book option */
+    return xaccSplitOrderNumSource (sa, sb,
+                                    qof_book_use_split_action_for_num_field
+                                    (xaccSplitGetBook (sa)));
+}
+
+int
+xaccSplitOrderNumSource (const Split *sa, const Split *sb,
+                         bool action_for_num)
 {
     int retval;
     int comp;
-    char *da, *db;
-    bool action_for_num;
+    int na, nb;
+    const char *ka, *kb;
 
     if (sa == sb) return 0;
     /* nothing is always less than something */
     if (!sa) return -1;
     if (!sb) return +1;
 
-    /* sort in transaction order, but use split action rather than trans num
-     * according to book option */
-    action_for_num = qof_book_use_split_action_for_num_field
-                                                        (xaccSplitGetBook (sa));
-    if (action_for_num)
-        retval = xaccTransOrder_num_action (sa->parent, sa->action,
-                                            sb->parent, sb->action);
+    ka = split_get_sort_key (sa);
+    kb = split_get_sort_key (sb);
+
+    /* sort in transaction order, taking the number from the split actions
+     * when asked to and both are set, as xaccTransOrder_num_action does */
+    if (action_for_num && sa->action && sb->action)
+    {
+        na = sa->sort_action_num;
+        nb = sb->sort_action_num;
+    }
     else
-        retval = xaccTransOrder (sa->parent, sb->parent);
+    {
+        na = xaccTransGetSortNum (sa->parent);
+        nb = xaccTransGetSortNum (sb->parent);
+    }
+    retval = xaccTransOrderNumbers (sa->parent, na, sb->parent, nb);
     if (retval) return retval;
 
     /* otherwise, sort on memo strings */
-    da = sa->memo ? sa->memo : "";
-    db = sb->memo ? sb->memo : "";
-    retval = g_utf8_collate (da, db);
+    retval = strcmp (ka, kb);
     if (retval)
         return retval;
 
     /* otherwise, sort on action strings */
-    da = sa->action ? sa->action : "";
-    db = sb->action ? sb->action : "";
-    retval = g_utf8_collate (da, db);
+    retval = strcmp (ka + strlen (ka) + 1, kb + strlen (kb) + 1);
     if (retval != 0)
         return retval;
 
@@ -1346,6 +1418,7 @@ qofSplitSetMemo (Split *split, const char* memo)
 {
     g_return_if_fail(split);
     CACHE_REPLACE(split->memo, memo);
+    xaccSplitInvalidateSortKey(split);
 }
 
 void
@@ -1355,6 +1428,7 @@ xaccSplitSetMemo (Split *split, const char *memo)
     xaccTransBeginEdit (split->parent);
 
     CACHE_REPLACE(split->memo, memo);
+    xaccSplitInvalidateSortKey(split);
     qof_instance_set_dirty(QOF_INSTANCE(split));
     xaccTransCommitEdit(split->parent);
 
@@ -1365,6 +1439,7 @@ qofSplitSetAction (Split *split, const char *actn)
 {
     g_return_if_fail(split);
     CACHE_REPLACE(split->action, actn);
+    xaccSplitInvalidateSortKey(split);
 }
 
 void
@@ -1374,6 +1449,7 @@ xaccSplitSetAction (Split *split, const char *actn)
     xaccTransBeginEdit (split->parent);
 
     CACHE_REPLACE(split->action, actn);
+    xaccSplitInvalidateSortKey(split);
     qof_instance_set_dirty(QOF_INSTANCE(split));
     xaccTransCommitEdit(split->parent);
 
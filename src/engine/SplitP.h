@@ -124,7 +124,18 @@ public:
     gnc_numeric  balance;
     gnc_numeric  cleared_balance;
     gnc_numeric  reconciled_balance;
-    
+
+    /* Cached keys for xaccSplitOrder(), built the first time the split is
+     * compared.  sort_key packs the g_utf8_collate_key() of the memo and of
+     * the action, each NUL terminated, so that strcmp() orders them like
+     * g_utf8_collate().  sort_key_memo and sort_key_action remember which
+     * strings the key was built from; the key is rebuilt when they differ
+     * or when the setters free it. */
+    char        *sort_key;
+    const char  *sort_key_memo;
+    const char  *sort_key_action;
+    int          sort_action_num;    /* atoi() of the action */
+
     Split();
     virtual ~Split();
 };
@@ -147,6 +158,15 @@ Split * xaccSplitClone (const Split *s);
 Split *xaccDupeSplit (const Split *s);
 void mark_split (Split *s);
 
+/* Drops the cached sort keys; called whenever the memo or action change. */
+void xaccSplitInvalidateSortKey (Split *split);
+
+/* The xaccSplitOrderNumSource() routine is xaccSplitOrder() with the
+ * book's use-split-action-for-num option passed in, so that a sort can
+ * look the option up once rather than on every comparison. */
+int xaccSplitOrderNumSource (const Split *sa, const Split *sb,
+                             bool action_for_num);
+
 void xaccSplitVoid(Split *split);
 void xaccSplitUnvoid(Split *split);
 void xaccSplitCommitEdit(Split *s);
@@ -252,12 +252,18 @@ Transaction::Transaction()
 
     this->marker = 0;
     this->orig = NULL;
+
+    this->sort_key      = NULL;
+    this->sort_key_num  = NULL;
+    this->sort_key_desc = NULL;
+    this->sort_num      = 0;
     LEAVE (" ");
 }
 
 Transaction::~Transaction()
 {
     // TODO
+    g_free(this->sort_key);
 }
 
 /********************************************************************\
@@ -554,6 +560,7 @@ xaccFreeTransaction (Transaction *trans)
     /* free up transaction strings */
     CACHE_REMOVE(trans->num);
     CACHE_REMOVE(trans->description);
+    xaccTransInvalidateSortKey(trans);
 
     /* Just in case someone looks up freed memory ... */
     trans->num         = (char *) 1;
@@ -1220,6 +1227,7 @@ do_destroy (Transaction *trans)
             xaccSplitCommitEdit(s);
         }
     }
+    trans->splits.clear();
     xaccFreeTransaction (trans);
 }
 
@@ -1411,6 +1419,7 @@ xaccTransRollbackEdit (Transaction *trans)
     orig = trans->orig;
     SWAP(trans->num, orig->num);
     SWAP(trans->description, orig->description);
+    xaccTransInvalidateSortKey(trans);
     trans->date_entered = orig->date_entered;
     trans->date_posted = orig->date_posted;
     SWAP(trans->common_currency, orig->common_currency);
@@ -1439,6 +1448,7 @@ xaccTransRollbackEdit (Transaction *trans)
             xaccSplitRollbackEdit(s);
             SWAP(s->action, so->action);
             SWAP(s->memo, so->memo);
+            xaccSplitInvalidateSortKey(s);
             SWAP(s->kvp_data, so->kvp_data);
             s->reconciled = so->reconciled;
             s->amount = so->amount;
@@ -1549,41 +1559,92 @@ xaccTransOrder (const Transaction *ta, const Transaction *tb)
     return xaccTransOrder_num_action (ta, NULL, tb, NULL);
 }
 
+void
+xaccTransInvalidateSortKey (Transaction *trans)
+{
+    if (!trans) return;
+    g_free (trans->sort_key);
+    trans->sort_key = NULL;
+    trans->sort_key_num = NULL;
+    trans->sort_key_desc = NULL;
+}
+
+/* Rebuilds the cached description collation key and parsed num of the
+ * transaction if either string changed since they were made. */
+static void
+trans_update_sort_key (const Transaction *t)
+{
+    Transaction *trans = (Transaction *) t;
+
+    if (trans->sort_key && trans->sort_key_num == trans->num &&
+            trans->sort_key_desc == trans->description)
+        return;
+
+    g_free (trans->sort_key);
+    trans->sort_key = g_utf8_collate_key (trans->description ?
+                                          trans->description : "", -1);
+    trans->sort_num = trans->num ? atoi (trans->num) : 0;
+    trans->sort_key_num = trans->num;
+    trans->sort_key_desc = trans->description;
+}
+
+int
+xaccTransGetSortNum (const Transaction *trans)
+{
+    if (!trans) return 0;
+    trans_update_sort_key (trans);
+    return trans->sort_num;
+}
+
 int
 xaccTransOrder_num_action (const Transaction *ta, const char *actna,
                             const Transaction *tb, const char *actnb)
 {
-    char *da, *db;
-    int na, nb, retval;
+    int na, nb;
 
     if ( ta && !tb ) return -1;
     if ( !ta && tb ) return +1;
     if ( !ta && !tb ) return 0;
 
-    /* if dates differ, return */
-    DATE_CMP(ta, tb, date_posted);
-
-    /* otherwise, sort on number string */
-    if (actna && actnb) /* split action string, if not NULL */
+    /* sort on number string: the split action string, if not NULL, else
+     * the transaction num string */
+    if (actna && actnb)
     {
         na = atoi(actna);
         nb = atoi(actnb);
     }
-    else                /* else transaction num string */
+    else
     {
-        na = atoi(ta->num);
-        nb = atoi(tb->num);
+        na = xaccTransGetSortNum (ta);
+        nb = xaccTransGetSortNum (tb);
     }
+    return xaccTransOrderNumbers (ta, na, tb, nb);
+}
+
+int
+xaccTransOrderNumbers (const Transaction *ta, int na,
+                       const Transaction *tb, int nb)
+{
+    int retval;
+
+    if ( ta && !tb ) return -1;
+    if ( !ta && tb ) return +1;
+    if ( !ta && !tb ) return 0;
+
+    /* if dates differ, return */
+    DATE_CMP(ta, tb, date_posted);
+
+    /* otherwise, sort on number */
     if (na < nb) return -1;
     if (na > nb) return +1;
 
     /* if dates differ, return */
     DATE_CMP(ta, tb, date_entered);
 
-    /* otherwise, sort on description string */
-    da = ta->description ? ta->description : "";
-    db = tb->description ? tb->description : "";
-    retval = g_utf8_collate (da, db);
+    /* otherwise, sort on description string, by its collation key */
+    trans_update_sort_key (ta);
+    trans_update_sort_key (tb);
+    retval = strcmp (ta->sort_key, tb->sort_key);
     if (retval)
         return retval;
 
@@ -1599,11 +1660,15 @@ xaccTransSetDateInternal(Transaction *trans, Timespec *dadate, Timespec val)
 {
     xaccTransBeginEdit(trans);
 
+    /* Formatting the date goes through the time zone, which is too
+     * slow to do for every transaction loaded just for a log line */
+    if (qof_log_check (log_module, QOF_LOG_INFO))
     {
         time64 secs = (time64) val.tv_sec;
         gchar *tstr = gnc_ctime (&secs);
         PINFO ("addr=%p set date to %" G_GUINT64_FORMAT ".%09ld %s",
                trans, val.tv_sec, val.tv_nsec, tstr ? tstr : "(null)");
+        g_free (tstr);
     }
 
     *dadate = val;
@@ -1778,6 +1843,7 @@ xaccTransSetNum (Transaction *trans, const char *xnum)
     xaccTransBeginEdit(trans);
 
     CACHE_REPLACE(trans->num, xnum);
+    xaccTransInvalidateSortKey(trans);
     qof_instance_set_dirty(QOF_INSTANCE(trans));
     mark_trans(trans);  /* Dirty balance of every account in trans */
     xaccTransCommitEdit(trans);
@@ -1798,6 +1864,7 @@ xaccTransSetDescription (Transaction *trans, const char *desc)
     xaccTransBeginEdit(trans);
 
     CACHE_REPLACE(trans->description, desc);
+    xaccTransInvalidateSortKey(trans);
     qof_instance_set_dirty(QOF_INSTANCE(trans));
     xaccTransCommitEdit(trans);
 }
@@ -109,7 +109,16 @@ public:
      * any changes made if/when the edit is abandoned.
      */
     Transaction *orig;
-    
+
+    /* Cached keys for xaccTransOrder(): the g_utf8_collate_key() of the
+     * description and atoi() of the num, built the first time the
+     * transaction is compared.  sort_key_num and sort_key_desc remember
+     * which strings they were built from. */
+    char        *sort_key;
+    const char  *sort_key_num;
+    const char  *sort_key_desc;
+    int          sort_num;
+
     Transaction();
     virtual ~Transaction();
 };
@@ -135,6 +144,19 @@ public:
  */
 Transaction * xaccDupeTransaction (const Transaction *t);
 
+/* Drops the cached sort keys; called whenever the num or description
+ * change. */
+void xaccTransInvalidateSortKey (Transaction *trans);
+
+/* Returns atoi() of the transaction's num, from the sort key cache. */
+int xaccTransGetSortNum (const Transaction *trans);
+
+/* The xaccTransOrderNumbers() routine orders two transactions the same
+ * way as xaccTransOrder_num_action(), but with the numbers to compare
+ * already parsed by the caller. */
+int xaccTransOrderNumbers (const Transaction *ta, int na,
+                           const Transaction *tb, int nb);
+
 /* The xaccTransSet/GetVersion() routines set & get the version
  *    numbers on this transaction.  The version number is used to manage
  *    multi-user updates.  These routines are private because we don't
@@ -676,6 +676,261 @@ xaccSplitGetGainsSourceSplit (const Split *split)
 
 /* ============================================================== */
 
+/* Computes the gains for split given the lot's amount and value just
+ * before it.  Returns an error numeric, after logging it, for a malformed
+ * lot or an overflow. */
+static gnc_numeric
+compute_split_gains (Split *split, GNCLot *lot, gnc_numeric lot_amount,
+                     gnc_numeric lot_value, gnc_numeric opening_value)
+{
+    gnc_numeric frac, value;
+
+    /* Opening amount should be larger (or equal) to current split,
+     * and it should be of the opposite sign.
+     * XXX This should really be a part of a scrub routine that
+     * cleans up the lot, before we get at it!
+     */
+    if (0 > gnc_numeric_compare (gnc_numeric_abs(lot_amount),
+                                 gnc_numeric_abs(split->amount)))
+    {
+        SplitList_t splits = gnc_lot_get_split_list(lot);
+        for (SplitList_t::iterator n = splits.begin(); n != splits.end(); n++)
+        {
+            Split *s = *n;
+            PINFO ("split amt=%s", gnc_num_dbg_to_string(s->amount));
+        }
+        PERR ("Malformed Lot \"%s\"! (too thin!) "
+              "opening amt=%s split amt=%s baln=%s",
+              gnc_lot_get_title (lot),
+              gnc_num_dbg_to_string (lot_amount),
+              gnc_num_dbg_to_string (split->amount),
+              gnc_num_dbg_to_string (gnc_lot_get_balance(lot)));
+        return gnc_numeric_error (GNC_ERROR_ARG);
+    }
+    if ( (gnc_numeric_negative_p(lot_amount) ||
+            gnc_numeric_positive_p(split->amount)) &&
+            (gnc_numeric_positive_p(lot_amount) ||
+             gnc_numeric_negative_p(split->amount)))
+    {
+        SplitList_t splits = gnc_lot_get_split_list(lot);
+        for (SplitList_t::iterator n = splits.begin(); n != splits.end(); n++)
+        {
+            Split *s = *n;
+            PINFO ("split amt=%s", gnc_num_dbg_to_string(s->amount));
+        }
+        PERR ("Malformed Lot \"%s\"! (too fat!) "
+              "opening amt=%s split amt=%s baln=%s",
+              gnc_lot_get_title (lot),
+              gnc_num_dbg_to_string (lot_amount),
+              gnc_num_dbg_to_string (split->amount),
+              gnc_num_dbg_to_string (gnc_lot_get_balance(lot)));
+        return gnc_numeric_error (GNC_ERROR_ARG);
+    }
+
+    /* The cap gains is the difference between the basis prior to the
+     * current split, and the current split, pro-rated for an equal
+     * amount of shares.
+     * i.e. purchase_price = lot_value / lot_amount
+     * cost_basis = purchase_price * current_split_amount
+     * cap_gain = current_split_value - cost_basis
+     */
+    /* Fraction of the lot that this split represents: */
+    frac = gnc_numeric_div (split->amount, lot_amount,
+                            GNC_DENOM_AUTO,
+                            GNC_HOW_DENOM_REDUCE);
+    /* Basis for this split: */
+    value = gnc_numeric_mul (frac, lot_value,
+                             gnc_numeric_denom(opening_value),
+                             GNC_HOW_DENOM_EXACT | GNC_HOW_RND_ROUND_HALF_UP);
+    /* Capital gain for this split: */
+    value = gnc_numeric_sub (value, split->value,
+                             GNC_DENOM_AUTO, GNC_HOW_DENOM_FIXED);
+    PINFO ("Open amt=%s val=%s;  split amt=%s val=%s; gains=%s\n",
+           gnc_num_dbg_to_string (lot_amount),
+           gnc_num_dbg_to_string (lot_value),
+           gnc_num_dbg_to_string (split->amount),
+           gnc_num_dbg_to_string (split->value),
+           gnc_num_dbg_to_string (value));
+    if (gnc_numeric_check (value))
+    {
+        PERR ("Numeric overflow during gains calculation\n"
+              "Acct=%s Txn=%s\n"
+              "\tOpen amt=%s val=%s\n\tsplit amt=%s val=%s\n\tgains=%s\n",
+              xaccAccountGetName(split->acc),
+              xaccTransGetDescription(split->parent),
+              gnc_num_dbg_to_string (lot_amount),
+              gnc_num_dbg_to_string (lot_value),
+              gnc_num_dbg_to_string (split->amount),
+              gnc_num_dbg_to_string (split->value),
+              gnc_num_dbg_to_string (value));
+    }
+    return value;
+}
+
+/* True if lot_split and gain_split already record value as split's
+ * gains. */
+static bool
+gains_recorded (const Split *split, const Split *lot_split,
+                const Split *gain_split, gnc_numeric value)
+{
+    gnc_numeric negvalue = gnc_numeric_neg (value);
+    return (split->gains_split == lot_split &&
+            lot_split->gains_split == split &&
+            gain_split->gains_split == split &&
+            gnc_numeric_equal (xaccSplitGetValue (lot_split), value) &&
+            gnc_numeric_zero_p (xaccSplitGetAmount (lot_split)) &&
+            gnc_numeric_equal (xaccSplitGetValue (gain_split), negvalue) &&
+            gnc_numeric_equal (xaccSplitGetAmount (gain_split), negvalue));
+}
+
+/* Records gains for split, as per design doc lots.txt: the gains
+ * transaction has two splits, with equal & opposite values.  The amt of
+ * one iz zero (so as not to upset the lot balance), the amt of the other
+ * is the same as its value (its the realized gain/loss).
+ *
+ * If pending is not NULL, an edited gains transaction is left open and
+ * appended to it, and its lot split is appended to lot_splits.  The
+ * caller adds those to the lot, as is done here otherwise, once every
+ * gains transaction is open, then commits them.
+ */
+static void
+record_split_gains (Split *split, GNCLot *lot, Account *gain_acc,
+                    gnc_commodity *currency, gnc_numeric value,
+                    TransList_t *pending, SplitList_t *lot_splits)
+{
+    Transaction *trans;
+    Split *lot_split, *gain_split;
+    Timespec ts;
+    bool new_gain_split;
+    gnc_numeric zero = gnc_numeric_zero();
+    gnc_numeric negvalue = gnc_numeric_neg (value);
+
+    /* See if there already is an associated gains transaction.
+     * If there is, adjust its value as appropriate. Else, create
+     * a new gains transaction.
+     */
+    /* lot_split = xaccSplitGetCapGainsSplit (split);  */
+    lot_split = split->gains_split;
+
+    if (NULL == lot_split)
+    {
+        Account *lot_acc = gnc_lot_get_account(lot);
+        QofBook *book = qof_instance_get_book(lot_acc);
+
+        new_gain_split = TRUE;
+
+        lot_split = xaccMallocSplit (book);
+        gain_split = xaccMallocSplit (book);
+
+        /* Check to make sure the gains account currency matches. */
+        if ((NULL == gain_acc) ||
+                (FALSE == gnc_commodity_equiv (currency,
+                                               xaccAccountGetCommodity(gain_acc))))
+        {
+            gain_acc = GetOrMakeGainAcct (lot_acc, currency);
+        }
+
+        xaccAccountBeginEdit (gain_acc);
+        xaccAccountInsertSplit (gain_acc, gain_split);
+        xaccAccountCommitEdit (gain_acc);
+
+        xaccAccountBeginEdit (lot_acc);
+        xaccAccountInsertSplit (lot_acc, lot_split);
+        xaccAccountCommitEdit (lot_acc);
+
+        trans = xaccMallocTransaction (book);
+
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, currency);
+        xaccTransSetDescription (trans, _("Realized Gain/Loss"));
+
+        xaccTransAppendSplit (trans, lot_split);
+        xaccTransAppendSplit (trans, gain_split);
+
+        xaccSplitSetMemo (lot_split, _("Realized Gain/Loss"));
+        xaccSplitSetMemo (gain_split, _("Realized Gain/Loss"));
+
+        /* For the new transaction, install KVP markup indicating
+         * that this is the gains transaction that corresponds
+         * to the gains source.
+         */
+        kvp_frame_set_guid (split->kvp_data, "gains-split",
+                            xaccSplitGetGUID (lot_split));
+        kvp_frame_set_guid (lot_split->kvp_data, "gains-source",
+                            xaccSplitGetGUID (split));
+
+    }
+    else
+    {
+        trans = lot_split->parent;
+        gain_split = xaccSplitGetOtherSplit (lot_split);
+
+        /* If the gains transaction has been edited so that it no longer has
+           just two splits, ignore it and assume it's still correct. */
+        if (!gain_split)
+        {
+            new_gain_split = FALSE;
+        }
+        /* If the gain is already recorded corectly do nothing.  This is
+         * more than just an optimization since this may be called during
+         * gnc_book_partition_txn and depending on the order in which things
+         * happen some splits may be in the wrong book at that time. */
+        else if (gains_recorded (split, lot_split, gain_split, value))
+        {
+            new_gain_split = FALSE;
+        }
+        else
+        {
+            new_gain_split = TRUE;
+            xaccTransBeginEdit (trans);
+
+            /* Make sure the existing gains trans has the correct currency,
+             * just in case someone screwed with it! */
+            if (FALSE == gnc_commodity_equiv(currency, trans->common_currency))
+            {
+                PWARN ("Resetting the transaction currency!");
+                xaccTransSetCurrency (trans, currency);
+            }
+        }
+    }
+
+    if (new_gain_split)
+    {
+        /* Common to both */
+        ts = xaccTransRetDatePostedTS (split->parent);
+        xaccTransSetDatePostedTS (trans, &ts);
+        xaccTransSetDateEnteredSecs (trans, gnc_time (NULL));
+
+        xaccSplitSetAmount (lot_split, zero);
+        xaccSplitSetValue (lot_split, value);
+
+        xaccSplitSetAmount (gain_split, negvalue);
+        xaccSplitSetValue (gain_split, negvalue);
+
+        /* Some short-cuts to help avoid the above kvp lookup. */
+        split->gains = GAINS_STATUS_CLEAN;
+        split->gains_split = lot_split;
+        lot_split->gains = GAINS_STATUS_GAINS;
+        lot_split->gains_split = split;
+        gain_split->gains = GAINS_STATUS_GAINS;
+        gain_split->gains_split = split;
+
+        if (pending)
+        {
+            /* The caller adds the split to the lot and commits. */
+            lot_splits->push_back (lot_split);
+            pending->push_back (trans);
+            return;
+        }
+
+        /* Do this last since it may generate an event that will call us
+           recursively. */
+        gnc_lot_add_split (lot, lot_split);
+
+        xaccTransCommitEdit (trans);
+    }
+}
+
 void
 xaccSplitComputeCapGains(Split *split, Account *gain_acc)
 {
@@ -684,7 +939,6 @@ xaccSplitComputeCapGains(Split *split, Account *gain_acc)
     gnc_commodity *currency = NULL;
     gnc_numeric zero = gnc_numeric_zero();
     gnc_numeric value = zero;
-    gnc_numeric frac;
     gnc_numeric opening_amount, opening_value;
     gnc_numeric lot_amount, lot_value;
     gnc_commodity *opening_currency;
@@ -825,224 +1079,14 @@ xaccSplitComputeCapGains(Split *split, Account *gain_acc)
         return;
     }
 
-    /* Opening amount should be larger (or equal) to current split,
-     * and it should be of the opposite sign.
-     * XXX This should really be a part of a scrub routine that
-     * cleans up the lot, before we get at it!
-     */
-    if (0 > gnc_numeric_compare (gnc_numeric_abs(lot_amount),
-                                 gnc_numeric_abs(split->amount)))
-    {
-        SplitList_t splits = gnc_lot_get_split_list(lot);
-        for (SplitList_t::iterator n = splits.begin(); n != splits.end(); n++)
-        {
-            Split *s = *n;
-            PINFO ("split amt=%s", gnc_num_dbg_to_string(s->amount));
-        }
-        PERR ("Malformed Lot \"%s\"! (too thin!) "
-              "opening amt=%s split amt=%s baln=%s",
-              gnc_lot_get_title (lot),
-              gnc_num_dbg_to_string (lot_amount),
-              gnc_num_dbg_to_string (split->amount),
-              gnc_num_dbg_to_string (gnc_lot_get_balance(lot)));
-        return;
-    }
-    if ( (gnc_numeric_negative_p(lot_amount) ||
-            gnc_numeric_positive_p(split->amount)) &&
-            (gnc_numeric_positive_p(lot_amount) ||
-             gnc_numeric_negative_p(split->amount)))
-    {
-        SplitList_t splits = gnc_lot_get_split_list(lot);
-        for (SplitList_t::iterator n = splits.begin(); n != splits.end(); n++)
-        {
-            Split *s = *n;
-            PINFO ("split amt=%s", gnc_num_dbg_to_string(s->amount));
-        }
-        PERR ("Malformed Lot \"%s\"! (too fat!) "
-              "opening amt=%s split amt=%s baln=%s",
-              gnc_lot_get_title (lot),
-              gnc_num_dbg_to_string (lot_amount),
-              gnc_num_dbg_to_string (split->amount),
-              gnc_num_dbg_to_string (gnc_lot_get_balance(lot)));
-        return;
-    }
-
-    /* The cap gains is the difference between the basis prior to the
-     * current split, and the current split, pro-rated for an equal
-     * amount of shares.
-     * i.e. purchase_price = lot_value / lot_amount
-     * cost_basis = purchase_price * current_split_amount
-     * cap_gain = current_split_value - cost_basis
-     */
-    /* Fraction of the lot that this split represents: */
-    frac = gnc_numeric_div (split->amount, lot_amount,
-                            GNC_DENOM_AUTO,
-                            GNC_HOW_DENOM_REDUCE);
-    /* Basis for this split: */
-    value = gnc_numeric_mul (frac, lot_value,
-                             gnc_numeric_denom(opening_value),
-                             GNC_HOW_DENOM_EXACT | GNC_HOW_RND_ROUND_HALF_UP);
-    /* Capital gain for this split: */
-    value = gnc_numeric_sub (value, split->value,
-                             GNC_DENOM_AUTO, GNC_HOW_DENOM_FIXED);
-    PINFO ("Open amt=%s val=%s;  split amt=%s val=%s; gains=%s\n",
-           gnc_num_dbg_to_string (lot_amount),
-           gnc_num_dbg_to_string (lot_value),
-           gnc_num_dbg_to_string (split->amount),
-           gnc_num_dbg_to_string (split->value),
-           gnc_num_dbg_to_string (value));
+    value = compute_split_gains (split, lot, lot_amount, lot_value,
+                                 opening_value);
     if (gnc_numeric_check (value))
-    {
-        PERR ("Numeric overflow during gains calculation\n"
-              "Acct=%s Txn=%s\n"
-              "\tOpen amt=%s val=%s\n\tsplit amt=%s val=%s\n\tgains=%s\n",
-              xaccAccountGetName(split->acc),
-              xaccTransGetDescription(split->parent),
-              gnc_num_dbg_to_string (lot_amount),
-              gnc_num_dbg_to_string (lot_value),
-              gnc_num_dbg_to_string (split->amount),
-              gnc_num_dbg_to_string (split->value),
-              gnc_num_dbg_to_string (value));
         return;
-    }
 
-    /* Are the cap gains zero?  If not, add a balancing transaction.
-     * As per design doc lots.txt: the transaction has two splits,
-     * with equal & opposite values.  The amt of one iz zero (so as
-     * not to upset the lot balance), the amt of the other is the same
-     * as its value (its the realized gain/loss).
-     */
+    /* Are the cap gains zero?  If not, add a balancing transaction. */
     if (FALSE == gnc_numeric_zero_p (value))
-    {
-        Transaction *trans;
-        Split *lot_split, *gain_split;
-        Timespec ts;
-        bool new_gain_split;
-        gnc_numeric negvalue = gnc_numeric_neg (value);
-
-        /* See if there already is an associated gains transaction.
-         * If there is, adjust its value as appropriate. Else, create
-         * a new gains transaction.
-         */
-        /* lot_split = xaccSplitGetCapGainsSplit (split);  */
-        lot_split = split->gains_split;
-
-        if (NULL == lot_split)
-        {
-            Account *lot_acc = gnc_lot_get_account(lot);
-            QofBook *book = qof_instance_get_book(lot_acc);
-
-            new_gain_split = TRUE;
-
-            lot_split = xaccMallocSplit (book);
-            gain_split = xaccMallocSplit (book);
-
-            /* Check to make sure the gains account currency matches. */
-            if ((NULL == gain_acc) ||
-                    (FALSE == gnc_commodity_equiv (currency,
-                                                   xaccAccountGetCommodity(gain_acc))))
-            {
-                gain_acc = GetOrMakeGainAcct (lot_acc, currency);
-            }
-
-            xaccAccountBeginEdit (gain_acc);
-            xaccAccountInsertSplit (gain_acc, gain_split);
-            xaccAccountCommitEdit (gain_acc);
-
-            xaccAccountBeginEdit (lot_acc);
-            xaccAccountInsertSplit (lot_acc, lot_split);
-            xaccAccountCommitEdit (lot_acc);
-
-            trans = xaccMallocTransaction (book);
-
-            xaccTransBeginEdit (trans);
-            xaccTransSetCurrency (trans, currency);
-            xaccTransSetDescription (trans, _("Realized Gain/Loss"));
-
-            xaccTransAppendSplit (trans, lot_split);
-            xaccTransAppendSplit (trans, gain_split);
-
-            xaccSplitSetMemo (lot_split, _("Realized Gain/Loss"));
-            xaccSplitSetMemo (gain_split, _("Realized Gain/Loss"));
-
-            /* For the new transaction, install KVP markup indicating
-             * that this is the gains transaction that corresponds
-             * to the gains source.
-             */
-            kvp_frame_set_guid (split->kvp_data, "gains-split",
-                                xaccSplitGetGUID (lot_split));
-            kvp_frame_set_guid (lot_split->kvp_data, "gains-source",
-                                xaccSplitGetGUID (split));
-
-        }
-        else
-        {
-            trans = lot_split->parent;
-            gain_split = xaccSplitGetOtherSplit (lot_split);
-
-            /* If the gains transaction has been edited so that it no longer has
-               just two splits, ignore it and assume it's still correct. */
-            if (!gain_split)
-            {
-                new_gain_split = FALSE;
-            }
-            /* If the gain is already recorded corectly do nothing.  This is
-             * more than just an optimization since this may be called during
-             * gnc_book_partition_txn and depending on the order in which things
-             * happen some splits may be in the wrong book at that time. */
-            else if (split->gains_split == lot_split &&
-                     lot_split->gains_split == split &&
-                     gain_split->gains_split == split &&
-                     gnc_numeric_equal (xaccSplitGetValue (lot_split), value) &&
-                     gnc_numeric_zero_p (xaccSplitGetAmount (lot_split)) &&
-                     gnc_numeric_equal (xaccSplitGetValue (gain_split), negvalue) &&
-                     gnc_numeric_equal (xaccSplitGetAmount (gain_split), negvalue))
-            {
-                new_gain_split = FALSE;
-            }
-            else
-            {
-                new_gain_split = TRUE;
-                xaccTransBeginEdit (trans);
-
-                /* Make sure the existing gains trans has the correct currency,
-                 * just in case someone screwed with it! */
-                if (FALSE == gnc_commodity_equiv(currency, trans->common_currency))
-                {
-                    PWARN ("Resetting the transaction currency!");
-                    xaccTransSetCurrency (trans, currency);
-                }
-            }
-        }
-
-        if (new_gain_split)
-        {
-            /* Common to both */
-            ts = xaccTransRetDatePostedTS (split->parent);
-            xaccTransSetDatePostedTS (trans, &ts);
-            xaccTransSetDateEnteredSecs (trans, gnc_time (NULL));
-
-            xaccSplitSetAmount (lot_split, zero);
-            xaccSplitSetValue (lot_split, value);
-
-            xaccSplitSetAmount (gain_split, negvalue);
-            xaccSplitSetValue (gain_split, negvalue);
-
-            /* Some short-cuts to help avoid the above kvp lookup. */
-            split->gains = GAINS_STATUS_CLEAN;
-            split->gains_split = lot_split;
-            lot_split->gains = GAINS_STATUS_GAINS;
-            lot_split->gains_split = split;
-            gain_split->gains = GAINS_STATUS_GAINS;
-            gain_split->gains_split = split;
-
-            /* Do this last since it may generate an event that will call us
-               recursively. */
-            gnc_lot_add_split (lot, lot_split);
-
-            xaccTransCommitEdit (trans);
-        }
-    }
+        record_split_gains (split, lot, gain_acc, currency, value, NULL, NULL);
     LEAVE ("(lot=%s)", gnc_lot_get_title(lot));
 }
 
@@ -1080,50 +1124,198 @@ xaccSplitGetCapGains(Split * split)
 
 /* ============================================================== */
 
-void
-xaccLotComputeCapGains (GNCLot *lot, Account *gain_acc)
+/* A lot split in the sweep, filed under the transaction of the split
+ * that generates it: its own, unless it records gains. */
+struct SweepEntry
+{
+    Split *split;
+    Split *source;
+    Transaction *trans;
+    /* The split's value, or the planned gains for a gains split */
+    gnc_numeric value;
+    /* Planned gains of a source split whose gains split doesn't exist yet */
+    gnc_numeric new_gains;
+};
+typedef std::list<SweepEntry> SweepList_t;
+
+struct SweepEntryLess
 {
+    bool operator() (const SweepEntry &a, const SweepEntry &b) const
+    {
+        return a.trans != b.trans && xaccTransOrder (a.trans, b.trans) < 0;
+    }
+};
+
+CapGainsChangeList_t
+xaccLotComputeCapGainsSweep (GNCLot *lot, Account *gain_acc, gboolean dry_run)
+{
+    CapGainsChangeList_t changes;
+    SweepList_t entries;
     GNCPolicy *pcy;
-    bool is_dirty = FALSE;
+    Account *lot_acc;
+    gnc_numeric zero = gnc_numeric_zero();
+    gnc_numeric run_amount = zero, run_value = zero;
+    gnc_numeric opening_amount, opening_value;
+    gnc_commodity *opening_currency;
+    bool lot_dirty = FALSE;
 
-    /* Note: if the value of the 'opening' split(s) has changed,
-     * then the cap gains are changed. To capture this, we need
-     * to mark all splits dirty if the opening splits are dirty. */
+    g_return_val_if_fail (lot != NULL, changes);
+    ENTER("(lot=%p dry_run=%d)", lot, dry_run);
+    lot_acc = gnc_lot_get_account(lot);
+    pcy = gnc_account_get_policy(lot_acc);
 
-    ENTER("(lot=%p)", lot);
-    pcy = gnc_account_get_policy(gnc_lot_get_account(lot));
+    /* Note: if the value of the 'opening' split(s) has changed,
+     * then the cap gains are changed. To capture this, all splits
+     * count as dirty if the opening splits are dirty. */
     SplitList_t splits = gnc_lot_get_split_list(lot);
     for (SplitList_t::iterator n = splits.begin(); n != splits.end(); n++)
     {
         Split *s = *n;
-        if (pcy->PolicyIsOpeningSplit(pcy, lot, s))
+        SweepEntry entry;
+
+        if (GAINS_STATUS_UNKNOWN == s->gains)
+            xaccSplitDetermineGainStatus(s);
+        if (pcy->PolicyIsOpeningSplit(pcy, lot, s) &&
+                (s->gains & GAINS_STATUS_VDIRTY))
         {
-            if (GAINS_STATUS_UNKNOWN == s->gains)
-                xaccSplitDetermineGainStatus(s);
-            if (s->gains & GAINS_STATUS_VDIRTY)
-            {
-                is_dirty = TRUE;
+            lot_dirty = TRUE;
+            if (!dry_run)
                 s->gains &= ~GAINS_STATUS_VDIRTY;
-            }
         }
+        entry.split = s;
+        entry.source = s;
+        if ((GAINS_STATUS_GAINS & s->gains) && s->gains_split)
+            entry.source = s->gains_split;
+        entry.trans = entry.source->parent;
+        entry.value = xaccSplitGetValue (s);
+        entry.new_gains = zero;
+        entries.push_back (entry);
     }
-
-    if (is_dirty)
+    if (lot_dirty && !dry_run)
     {
-        SplitList_t splits = gnc_lot_get_split_list(lot);
         for (SplitList_t::iterator n = splits.begin(); n != splits.end(); n++)
+            (*n)->gains |= GAINS_STATUS_VDIRTY;
+    }
+
+    entries.sort (SweepEntryLess ());
+    pcy->PolicyGetLotOpening (pcy, lot, &opening_amount, &opening_value,
+                              &opening_currency);
+
+    /* The lot balance before a split is everything in earlier
+     * transactions plus everything else in its own transaction, as in
+     * gnc_lot_get_balance_before(). */
+    SweepList_t::iterator group = entries.begin();
+    while (group != entries.end())
+    {
+        SweepList_t::iterator group_end = group;
+        while (group_end != entries.end() && group_end->trans == group->trans)
+            group_end++;
+
+        for (SweepList_t::iterator t = group; t != group_end; t++)
         {
-            Split *s = *n;
-            s->gains |= GAINS_STATUS_VDIRTY;
+            Split *split = t->split;
+            gnc_commodity *currency = split->parent->common_currency;
+            gnc_numeric lot_amount = run_amount, lot_value = run_value;
+            gnc_numeric gains;
+            GNCCapGainsChange change;
+
+            /* Gains splits are handled along with their source. The
+             * rest are skipped for the same reasons as in
+             * xaccSplitComputeCapGains(). */
+            if (t->source != split ||
+                    gnc_commodity_equal (currency,
+                                         xaccAccountGetCommodity(split->acc)) ||
+                    pcy->PolicyIsOpeningSplit (pcy, lot, split) ||
+                    g_strcmp0 ("stock-split", xaccSplitGetType (split)) == 0 ||
+                    gnc_numeric_zero_p (split->amount) ||
+                    FALSE == gnc_commodity_equiv (currency, opening_currency))
+                continue;
+            if (!lot_dirty && !(split->gains & GAINS_STATUS_A_VDIRTY) &&
+                    split->gains_split &&
+                    !(split->gains_split->gains & GAINS_STATUS_A_VDIRTY))
+                continue;
+
+            for (SweepList_t::iterator e = group; e != group_end; e++)
+            {
+                if (e->source == split)
+                    continue;
+                lot_amount = gnc_numeric_add_fixed (lot_amount,
+                                                    xaccSplitGetAmount (e->split));
+                lot_value = gnc_numeric_add_fixed (lot_value, e->value);
+                lot_value = gnc_numeric_add_fixed (lot_value, e->new_gains);
+            }
+
+            gains = compute_split_gains (split, lot, lot_amount, lot_value,
+                                         opening_value);
+            if (gnc_numeric_check (gains) || gnc_numeric_zero_p (gains))
+                continue;
+            if (split->gains_split)
+            {
+                Split *gain_split = xaccSplitGetOtherSplit (split->gains_split);
+                /* Gains transactions edited to have more than two splits
+                 * are left alone. */
+                if (!gain_split ||
+                        gains_recorded (split, split->gains_split, gain_split, gains))
+                    continue;
+            }
+
+            change.split = split;
+            change.old_gains = split->gains_split ?
+                               xaccSplitGetValue (split->gains_split) : zero;
+            change.new_gains = gains;
+            changes.push_back (change);
+
+            /* Later splits see the new gains in the lot's value. */
+            if (split->gains_split == NULL)
+                t->new_gains = gains;
+            for (SweepList_t::iterator e = group; e != group_end; e++)
+            {
+                if (e->split == split->gains_split)
+                    e->value = gains;
+            }
+        }
+
+        for (; group != group_end; group++)
+        {
+            run_amount = gnc_numeric_add_fixed (run_amount,
+                                                xaccSplitGetAmount (group->split));
+            run_value = gnc_numeric_add_fixed (run_value, group->value);
+            run_value = gnc_numeric_add_fixed (run_value, group->new_gains);
         }
     }
 
-    splits = gnc_lot_get_split_list(lot);
-    for (SplitList_t::iterator n = splits.begin(); n != splits.end(); n++)
+    if (!dry_run && !changes.empty ())
     {
-        Split *s = *n;
-        xaccSplitComputeCapGains (s, gain_acc);
+        TransList_t pending;
+        SplitList_t lot_splits;
+
+        /* Edit every gains transaction before committing any, so that the
+         * lot and its account are only committed once. */
+        xaccAccountBeginEdit (lot_acc);
+        gnc_lot_begin_edit (lot);
+        for (CapGainsChangeList_t::iterator c = changes.begin();
+                c != changes.end(); c++)
+            record_split_gains (c->split, lot, gain_acc,
+                                c->split->parent->common_currency,
+                                c->new_gains, &pending, &lot_splits);
+        for (SplitList_t::iterator n = lot_splits.begin();
+                n != lot_splits.end(); n++)
+            gnc_lot_add_split (lot, *n);
+        gnc_lot_commit_edit (lot);
+        for (TransList_t::iterator n = pending.begin(); n != pending.end(); n++)
+            xaccTransCommitEdit (*n);
+        xaccAccountCommitEdit (lot_acc);
     }
+
+    LEAVE("(lot=%p) %d changes", lot, (int)changes.size ());
+    return changes;
+}
+
+void
+xaccLotComputeCapGains (GNCLot *lot, Account *gain_acc)
+{
+    ENTER("(lot=%p)", lot);
+    xaccLotComputeCapGainsSweep (lot, gain_acc, FALSE);
     LEAVE("(lot=%p)", lot);
 }
 
@@ -217,13 +217,37 @@ Split * xaccSplitAssignToLot (Split *split, GNCLot *lot);
  *  split; its an error otherwise.  If the 'amount' of the split is
  *  less than the opening amount, the gains are pro-rated.
  *
- *  The xaccLotComputeCapGains() routine merely invokes the above on
- *    each split in the lot.
+ *  The xaccLotComputeCapGains() routine does the same for each split
+ *    in the lot, using xaccLotComputeCapGainsSweep().
  */
 
 void xaccSplitComputeCapGains(Split *split, Account *gain_acc);
 void xaccLotComputeCapGains (GNCLot *lot, Account *gain_acc);
 
+/** A change to the recorded gains of one split, as found by
+ *  xaccLotComputeCapGainsSweep(). */
+typedef struct
+{
+    Split *split;             /**< The split that realizes the gains */
+    gnc_numeric old_gains;    /**< Currently recorded, zero if none */
+    gnc_numeric new_gains;
+} GNCCapGainsChange;
+typedef std::list<GNCCapGainsChange> CapGainsChangeList_t;
+
+/** The xaccLotComputeCapGainsSweep() routine computes the gains of
+ *  every split in the lot in a single pass in posting order, keeping a
+ *  running lot amount and value rather than summing the lot again for
+ *  each split.  The gains transactions that need changing are then
+ *  edited together and committed once.
+ *
+ *  With dry_run set, nothing is modified; the result just says what
+ *  would change, so whole portfolios can be checked safely.
+ *
+ *  @return The changes made, or that would be made.
+ */
+CapGainsChangeList_t xaccLotComputeCapGainsSweep (GNCLot *lot,
+        Account *gain_acc, gboolean dry_run);
+
 #endif /* XACC_CAP_GAINS_H */
 /** @} */
 /** @} */
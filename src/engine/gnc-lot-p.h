@@ -42,4 +42,11 @@
 /* Register with the Query engine */
 bool gnc_lot_register (void);
 
+/* A function called whenever a lot may have changed: when it is created
+ * or committed, when the amount of one of its splits changes, and, with
+ * destroyed set, just before it is freed.  Used to keep indexes over lots
+ * (such as the owner lot index in gncOwner.cpp) up to date. */
+typedef void (*GNCLotChangedHook) (GNCLot *lot, bool destroyed);
+void gnc_lot_set_changed_hook (GNCLotChangedHook hook);
+
 #endif /* GNC_LOT_P_H */
@@ -80,6 +80,21 @@ struct LotPrivate
 
 #define gnc_lot_set_guid(L,G)  qof_instance_set_guid(QOF_INSTANCE(L),&(G))
 
+static GNCLotChangedHook lot_changed_hook = NULL;
+
+void
+gnc_lot_set_changed_hook (GNCLotChangedHook hook)
+{
+    lot_changed_hook = hook;
+}
+
+static inline void
+lot_changed (GNCLot *lot, bool destroyed)
+{
+    if (lot_changed_hook)
+        (lot_changed_hook) (lot, destroyed);
+}
+
 /* ============================================================= */
 
 /* GObject Initialization */
@@ -109,6 +124,7 @@ gnc_lot_new (QofBook *book)
 
     lot = new GNCLot; //g_object_new (GNC_TYPE_LOT, NULL);
     qof_instance_init_data(QOF_INSTANCE(lot), GNC_ID_LOT, book);
+    lot_changed (lot, FALSE);
     qof_event_gen (QOF_INSTANCE(lot), QOF_EVENT_CREATE, NULL);
     return lot;
 }
@@ -121,6 +137,7 @@ gnc_lot_free(GNCLot* lot)
 
     ENTER ("(lot=%p)", lot);
     qof_event_gen (QOF_INSTANCE(lot), QOF_EVENT_DESTROY, NULL);
+    lot_changed (lot, TRUE);
 
     priv = GET_PRIVATE(lot);
     for (SplitList_t::iterator node = priv->splits.begin();
@@ -174,6 +191,7 @@ void
 gnc_lot_commit_edit (GNCLot *lot)
 {
     if (!qof_commit_edit (QOF_INSTANCE(lot))) return;
+    lot_changed (lot, FALSE);
     qof_commit_edit_part2 (QOF_INSTANCE(lot), commit_err, noop, lot_free);
 }
 
@@ -234,6 +252,7 @@ gnc_lot_set_closed_unknown(GNCLot* lot)
     {
         priv = GET_PRIVATE(lot);
         priv->is_closed = LOT_CLOSED_UNKNOWN;
+        lot_changed (lot, FALSE);
     }
 }
 
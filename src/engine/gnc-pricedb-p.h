@@ -55,6 +55,7 @@ class GNCPriceDB : public QofInstance
 public:
     GHashTable *commodity_hash;
     bool bulk_update;		 /* TRUE while reading XML file, etc. */
+    guint64 generation;		 /* bumped whenever a price changes */
     
     GNCPriceDB();
     virtual ~GNCPriceDB();
@@ -25,6 +25,7 @@
 #include "config.h"
 
 #include <glib.h>
+#include <stdlib.h>
 #include <string.h>
 #include "gnc-pricedb-p.h"
 #include "qofbackend-p.h"
@@ -311,6 +312,7 @@ gnc_price_set_value(GNCPrice *p, gnc_numeric value)
     {
         gnc_price_begin_edit (p);
         p->value = value;
+        if (p->db) p->db->generation++;
         gnc_price_set_dirty(p);
         gnc_price_commit_edit (p);
     }
@@ -575,6 +577,7 @@ GNCPriceDB::GNCPriceDB()
 {
     commodity_hash = NULL;
     bulk_update = false;
+    generation = 0;
 }
 
 GNCPriceDB::~GNCPriceDB()
@@ -671,6 +674,13 @@ gnc_pricedb_set_bulk_update(GNCPriceDB *db, bool bulk_update)
     db->bulk_update = bulk_update;
 }
 
+guint64
+gnc_pricedb_get_generation(const GNCPriceDB *db)
+{
+    if (!db) return 0;
+    return db->generation;
+}
+
 /* ==================================================================== */
 /* This is kind of weird, the way its done.  Each collection of prices
  * for a given commodity should get its own guid, be its own entity, etc.
@@ -859,6 +869,7 @@ add_price(GNCPriceDB *db, GNCPrice *p)
     }
     g_hash_table_insert(currency_hash, currency, price_list);
     p->db = db;
+    db->generation++;
     qof_event_gen (p, QOF_EVENT_ADD, NULL);
 
     LEAVE ("db=%p, pr=%p dirty=%d dextroying=%d commodity=%s/%s currency_hash=%p",
@@ -898,6 +909,299 @@ gnc_pricedb_add_price(GNCPriceDB *db, GNCPrice *p)
     return TRUE;
 }
 
+/* ==================================================================== */
+/* Bulk quote ingestion.
+ *
+ * The batch is partitioned by commodity and each partition is sorted
+ * and deduplicated on a worker thread.  The workers only read the
+ * quote tuples, never engine objects, so creating the prices and
+ * merging them into the price lists is left to the calling thread.
+ */
+
+/* Below this many quotes per shard a thread costs more than it saves */
+#define QUOTE_SHARD_MIN_SIZE 4096
+#define QUOTE_SHARD_MAX 4
+
+typedef struct
+{
+    const GNCPriceQuote *quote;
+    Timespec day;
+    guint index;
+} QuoteEntry;
+
+typedef struct
+{
+    QuoteEntry *entries;
+    guint n_entries;
+    guint n_unique;
+} QuoteShard;
+
+/* Commodities are heap objects, so the low bits of their addresses are
+ * all zero and g_direct_hash () % n_shards sent every quote to shard 0.
+ * Fold the whole address into 32 bits, spread it with a golden-ratio
+ * multiply and scale the result down to the shard range instead. */
+static guint
+quote_shard_of (const gnc_commodity *commodity, guint n_shards)
+{
+    guint64 addr = (guint64) GPOINTER_TO_SIZE (commodity);
+    guint32 mixed = (guint32) ((addr >> 4) ^ (addr >> 32)) * 0x9E3779B1u;
+
+    return (guint) (((guint64) mixed * n_shards) >> 32);
+}
+
+static int
+quote_entry_compare (const void *a, const void *b)
+{
+    const QuoteEntry *ea = (const QuoteEntry *) a;
+    const QuoteEntry *eb = (const QuoteEntry *) b;
+    int result;
+
+    if (ea->quote->commodity != eb->quote->commodity)
+        return ea->quote->commodity < eb->quote->commodity ? -1 : 1;
+    if (ea->quote->currency != eb->quote->currency)
+        return ea->quote->currency < eb->quote->currency ? -1 : 1;
+
+    /* Newest first, as in compare_prices_by_date */
+    result = -timespec_cmp (&ea->quote->time, &eb->quote->time);
+    if (result) return result;
+
+    return ea->index < eb->index ? -1 : (ea->index > eb->index ? 1 : 0);
+}
+
+static bool
+quote_entry_same_day (const QuoteEntry *a, const QuoteEntry *b)
+{
+    return a->quote->commodity == b->quote->commodity &&
+           a->quote->currency == b->quote->currency &&
+           timespec_equal (&a->day, &b->day);
+}
+
+/* Sort a shard and squeeze out the quotes which duplicate an earlier
+ * one, keeping the newest of each run of duplicates. */
+static gpointer
+quote_shard_sort (gpointer data)
+{
+    QuoteShard *shard = (QuoteShard *) data;
+    QuoteEntry *entries = shard->entries;
+    guint i, j, group = 0, n = 0;
+
+    for (i = 0; i < shard->n_entries; i++)
+        entries[i].day = timespecCanonicalDayTime (entries[i].quote->time);
+    qsort (entries, shard->n_entries, sizeof (QuoteEntry),
+           quote_entry_compare);
+
+    for (i = 0; i < shard->n_entries; i++)
+    {
+        bool isDupl = FALSE;
+
+        if (n == 0 || !quote_entry_same_day (&entries[i], &entries[group]))
+            group = n;
+        else
+            for (j = group; j < n && !isDupl; j++)
+                isDupl = gnc_numeric_equal (entries[i].quote->value,
+                                            entries[j].quote->value);
+        if (!isDupl)
+            entries[n++] = entries[i];
+    }
+    shard->n_unique = n;
+    return NULL;
+}
+
+/* Is there a price for the quote's day with the quote's value among
+ * the prices either side of the merge point?  Both lists are sorted by
+ * date, so only the same-day prices at their heads need looking at. */
+static bool
+quote_matches_prices (const QuoteEntry *e, GList *before, GList *after)
+{
+    GList *node;
+    Timespec day;
+
+    for (node = before; node; node = node->next)
+    {
+        day = timespecCanonicalDayTime (gnc_price_get_time (node->data));
+        if (!timespec_equal (&day, &e->day)) break;
+        if (gnc_numeric_equal (gnc_price_get_value (node->data),
+                               e->quote->value))
+            return TRUE;
+    }
+    for (node = after; node; node = node->next)
+    {
+        day = timespecCanonicalDayTime (gnc_price_get_time (node->data));
+        if (!timespec_equal (&day, &e->day)) break;
+        if (gnc_numeric_equal (gnc_price_get_value (node->data),
+                               e->quote->value))
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/* Merge a sorted, deduplicated run of quotes for one commodity and
+ * currency into that pair's price list in a single pass. */
+static guint
+pricedb_merge_quotes (GNCPriceDB *db, QofBook *book,
+                      const QuoteEntry *run, guint n_run)
+{
+    gnc_commodity *commodity = run->quote->commodity;
+    gnc_commodity *currency = run->quote->currency;
+    GHashTable *currency_hash;
+    GList *old_list, *node, *merged = NULL;
+    guint i, n_added = 0;
+
+    currency_hash = g_hash_table_lookup (db->commodity_hash, commodity);
+    if (!currency_hash)
+    {
+        currency_hash = g_hash_table_new (NULL, NULL);
+        g_hash_table_insert (db->commodity_hash, commodity, currency_hash);
+    }
+    old_list = g_hash_table_lookup (currency_hash, currency);
+
+    node = old_list;
+    for (i = 0; i < n_run; i++)
+    {
+        const QuoteEntry *e = &run[i];
+        GNCPrice *p;
+
+        while (node && timespec_cmp (&((GNCPrice *) node->data)->tmspec,
+                                     &e->quote->time) > 0)
+        {
+            merged = g_list_prepend (merged, node->data);
+            node = node->next;
+        }
+
+        if (!db->bulk_update && quote_matches_prices (e, merged, node))
+            continue;
+
+        /* The list keeps the creation reference. */
+        p = gnc_price_create (book);
+        gnc_price_begin_edit (p);
+        p->commodity = commodity;
+        p->currency = currency;
+        p->tmspec = e->quote->time;
+        p->value = e->quote->value;
+        p->source = CACHE_INSERT (e->quote->source);
+        p->type = CACHE_INSERT (e->quote->type);
+        qof_instance_set_dirty (p);
+        gnc_price_commit_edit (p);
+
+        while (node && compare_prices_by_date (node->data, p) < 0)
+        {
+            merged = g_list_prepend (merged, node->data);
+            node = node->next;
+        }
+        merged = g_list_prepend (merged, p);
+        p->db = db;
+        n_added++;
+    }
+    for (; node; node = node->next)
+        merged = g_list_prepend (merged, node->data);
+
+    g_list_free (old_list);
+    g_hash_table_insert (currency_hash, currency, g_list_reverse (merged));
+    return n_added;
+}
+
+guint
+gnc_pricedb_add_quotes (GNCPriceDB *db, const GNCPriceQuote *quotes,
+                        guint n_quotes)
+{
+    QuoteShard shards[QUOTE_SHARD_MAX];
+    GThread *threads[QUOTE_SHARD_MAX];
+    guint offsets[QUOTE_SHARD_MAX];
+    QuoteEntry *entries;
+    QofBook *book;
+    guint n_shards, n_valid = 0, n_added = 0;
+    guint i, s;
+
+    g_return_val_if_fail (db, 0);
+    g_return_val_if_fail (db->commodity_hash, 0);
+    if (!quotes || n_quotes == 0) return 0;
+
+    ENTER ("db=%p, n_quotes=%u bulk_update=%d", db, n_quotes, db->bulk_update);
+    book = qof_instance_get_book (db);
+
+    /* Partition by commodity, so that no series spans two shards. */
+    n_shards = CLAMP (n_quotes / QUOTE_SHARD_MIN_SIZE, 1, QUOTE_SHARD_MAX);
+    memset (shards, 0, sizeof (shards));
+    for (i = 0; i < n_quotes; i++)
+    {
+        if (!quotes[i].commodity || !quotes[i].currency)
+        {
+            PWARN ("quote %u has no commodity or currency", i);
+            continue;
+        }
+        s = quote_shard_of (quotes[i].commodity, n_shards);
+        shards[s].n_entries++;
+        n_valid++;
+    }
+
+    entries = g_new (QuoteEntry, n_valid ? n_valid : 1);
+    for (s = 0, i = 0; s < n_shards; s++)
+    {
+        shards[s].entries = entries + i;
+        offsets[s] = 0;
+        i += shards[s].n_entries;
+    }
+    for (i = 0; i < n_quotes; i++)
+    {
+        QuoteEntry *e;
+
+        if (!quotes[i].commodity || !quotes[i].currency) continue;
+        s = quote_shard_of (quotes[i].commodity, n_shards);
+        e = &shards[s].entries[offsets[s]++];
+        e->quote = &quotes[i];
+        e->index = i;
+    }
+
+    /* A batch too small to split is sorted in place rather than handed
+     * to a single worker that would just be waited for. */
+    for (s = 0; s < n_shards; s++)
+    {
+        threads[s] = NULL;
+        if (n_shards > 1)
+            threads[s] = g_thread_try_new ("price_quote_thread",
+                                           quote_shard_sort, &shards[s], NULL);
+        if (!threads[s])
+            quote_shard_sort (&shards[s]);
+    }
+    for (s = 0; s < n_shards; s++)
+        if (threads[s])
+            g_thread_join (threads[s]);
+
+    qof_event_suspend ();
+    gnc_pricedb_begin_edit (db);
+    for (s = 0; s < n_shards; s++)
+    {
+        QuoteEntry *run = shards[s].entries;
+        QuoteEntry *end = run + shards[s].n_unique;
+
+        while (run < end)
+        {
+            QuoteEntry *next = run + 1;
+
+            while (next < end &&
+                    next->quote->commodity == run->quote->commodity &&
+                    next->quote->currency == run->quote->currency)
+                next++;
+            n_added += pricedb_merge_quotes (db, book, run, (guint)(next - run));
+            run = next;
+        }
+    }
+    if (n_added)
+    {
+        db->generation++;
+        qof_instance_set_dirty (db);
+    }
+    gnc_pricedb_commit_edit (db);
+    qof_event_resume ();
+    g_free (entries);
+
+    if (n_added)
+        qof_event_gen (db, QOF_EVENT_MODIFY, NULL);
+
+    LEAVE ("db=%p, added %u of %u quotes", db, n_added, n_quotes);
+    return n_added;
+}
+
 /* remove_price() is a utility; its only function is to remove the price
  * from the double-hash tables.
  */
@@ -949,6 +1253,7 @@ remove_price(GNCPriceDB *db, GNCPrice *p, bool cleanup)
         LEAVE (" cannot remove price list");
         return FALSE;
     }
+    db->generation++;
 
     /* if the price list is empty, then remove this currency from the
        commodity hash */
@@ -268,11 +268,40 @@ void gnc_pricedb_commit_edit (GNCPriceDB *);
  *  entries. */
 void gnc_pricedb_set_bulk_update(GNCPriceDB *db, bool bulk_update);
 
+/** gnc_pricedb_get_generation - return a counter that changes every
+     time a price is added to, removed from or revalued in the pricedb.
+     Callers caching values converted through the pricedb compare it
+     to tell whether those values are still good. */
+guint64  gnc_pricedb_get_generation(const GNCPriceDB *db);
+
 /** gnc_pricedb_add_price - add a price to the pricedb, you may drop
      your reference to the price (i.e. call unref) after this
      succeeds, whenever you're finished with the price. */
 bool     gnc_pricedb_add_price(GNCPriceDB *db, GNCPrice *p);
 
+/** One entry of a batch handed to gnc_pricedb_add_quotes.  The source
+    and type strings are copied, so they need only live for the call. */
+typedef struct
+{
+    gnc_commodity *commodity;
+    gnc_commodity *currency;
+    Timespec time;
+    gnc_numeric value;
+    const char *source;
+    const char *type;
+} GNCPriceQuote;
+
+/** gnc_pricedb_add_quotes - create and add a price for each quote in
+     the batch.  Quotes for the same commodity, currency and day with
+     equal values are only added once, and unless the bulk update flag
+     is set a quote matching a price already in the database is
+     skipped, just as gnc_pricedb_add_price would skip it.  Each
+     commodity/currency series is merged into the database in a single
+     pass and one QOF_EVENT_MODIFY is generated on the pricedb instead
+     of an event per price.  Returns the number of prices added. */
+guint    gnc_pricedb_add_quotes(GNCPriceDB *db, const GNCPriceQuote *quotes,
+                                guint n_quotes);
+
 /** gnc_pricedb_remove_price - removes the given price, p, from the
      pricedb.   Returns TRUE if successful, FALSE otherwise. */
 bool     gnc_pricedb_remove_price(GNCPriceDB *db, GNCPrice *p);
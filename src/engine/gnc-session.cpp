@@ -52,7 +52,7 @@ gnc_current_session_exist(void)
 void
 gnc_set_current_session (QofSession *session)
 {
-    if (current_session)
+    if (current_session && current_session != session)
         PINFO("Leak of current session.");
     current_session = session;
 }
@@ -232,7 +232,6 @@ void gncBillTermSetType (GncBillTerm *term, GncBillTermType type)
 /** \brief Convert bill term types from text. */
 FROM_STRING_FUNC(GncBillTermType, ENUM_TERMS_TYPE)
 
-static
 void qofBillTermSetType (GncBillTerm *term, const char *type_label)
 {
     GncBillTermType type;
@@ -422,7 +421,6 @@ GncBillTermType gncBillTermGetType (const GncBillTerm *term)
 /** \brief Convert bill term types to text. */
 AS_STRING_FUNC(GncBillTermType, ENUM_TERMS_TYPE)
 
-static
 const char* qofBillTermGetType (const GncBillTerm *term)
 {
     if (!term)
@@ -85,6 +85,7 @@ void gncBillTermSetDueDays (GncBillTerm *term, gint days);
 void gncBillTermSetDiscountDays (GncBillTerm *term, gint days);
 void gncBillTermSetDiscount (GncBillTerm *term, gnc_numeric discount);
 void gncBillTermSetCutoff (GncBillTerm *term, gint cutoff);
+void qofBillTermSetType (GncBillTerm *term, const char *type_label);
 
 /** @} */
 
@@ -111,6 +112,7 @@ gint gncBillTermGetDueDays (const GncBillTerm *term);
 gint gncBillTermGetDiscountDays (const GncBillTerm *term);
 gnc_numeric gncBillTermGetDiscount (const GncBillTerm *term);
 gint gncBillTermGetCutoff (const GncBillTerm *term);
+const char *qofBillTermGetType (const GncBillTerm *term);
 
 bool gncBillTermIsDirty (const GncBillTerm *term);
 
@@ -29,6 +29,187 @@
 /* The initialization of the business objects is done in
  * cashobjects_register() of <engine/cashobjects.h>. */
 
+/* Book data key of the ID index.  The index maps each type name to a
+ * table mapping an ID to the GList of objects carrying it. */
+#define GNC_BUSINESS_ID_INDEX "gncBusinessIDIndex"
+
+static void
+id_list_free (gpointer data)
+{
+    g_list_free ((GList *) data);
+}
+
+static void
+id_table_free (gpointer data)
+{
+    g_hash_table_destroy ((GHashTable *) data);
+}
+
+static void
+id_index_final (QofBook *book, gpointer key, gpointer user_data)
+{
+    g_hash_table_destroy ((GHashTable *) user_data);
+    qof_book_set_data (book, GNC_BUSINESS_ID_INDEX, NULL);
+}
+
+static GHashTable *
+id_index_get_table (QofBook *book, QofIdTypeConst type_name, bool create)
+{
+    GHashTable *index, *table;
+
+    index = (GHashTable *) qof_book_get_data (book, GNC_BUSINESS_ID_INDEX);
+    if (!index)
+    {
+        /* The index is dropped first thing when the book is destroyed;
+         * objects freed after that have nothing to leave. */
+        if (!create || qof_book_shutting_down (book))
+            return NULL;
+        index = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                       g_free, id_table_free);
+        qof_book_set_data_fin (book, GNC_BUSINESS_ID_INDEX, index,
+                               id_index_final);
+    }
+
+    table = (GHashTable *) g_hash_table_lookup (index, type_name);
+    if (!table && create)
+    {
+        table = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                       g_free, id_list_free);
+        g_hash_table_insert (index, g_strdup (type_name), table);
+    }
+    return table;
+}
+
+void
+gncBusinessIDIndexUpdate (QofInstance *inst, const char *old_id,
+                          const char *new_id)
+{
+    QofBook *book;
+    GHashTable *table;
+    GList *list;
+    gpointer key, value;
+
+    g_return_if_fail (inst);
+    if (!g_strcmp0 (old_id, new_id)) return;
+
+    book = qof_instance_get_book (inst);
+    if (!book) return;
+
+    if (old_id && *old_id)
+    {
+        table = id_index_get_table (book, inst->e_type, FALSE);
+        if (table && g_hash_table_lookup_extended (table, old_id, &key, &value))
+        {
+            /* Removing the first object moves the head of the list, so
+             * take the entry out rather than have the table free it. */
+            g_hash_table_steal (table, old_id);
+            list = g_list_remove ((GList *) value, inst);
+            if (list)
+                g_hash_table_insert (table, key, list);
+            else
+                g_free (key);
+        }
+    }
+
+    if (new_id && *new_id)
+    {
+        table = id_index_get_table (book, inst->e_type, TRUE);
+        if (!table) return;
+        list = (GList *) g_hash_table_lookup (table, new_id);
+        if (list)
+            list = g_list_append (list, inst);
+        else
+            g_hash_table_insert (table, g_strdup (new_id),
+                                 g_list_append (NULL, inst));
+    }
+}
+
+GList *
+gncBusinessIDIndexLookup (QofBook *book, QofIdTypeConst type_name,
+                          const char *id)
+{
+    GHashTable *table;
+
+    g_return_val_if_fail (book, NULL);
+    g_return_val_if_fail (type_name, NULL);
+    if (!id || !*id) return NULL;
+
+    table = id_index_get_table (book, type_name, FALSE);
+    if (!table) return NULL;
+    return (GList *) g_hash_table_lookup (table, id);
+}
+
+typedef struct
+{
+    QofIdTypeConst type_name;
+    char *id;
+} IDMatchData;
+
+static void
+id_match_free (gpointer data)
+{
+    IDMatchData *imd = (IDMatchData *) data;
+
+    g_free (imd->id);
+    g_free (imd);
+}
+
+/* The index knows each object's ID, so there is no need for a getter
+ * per object type. */
+static gboolean
+id_match (gconstpointer object, gconstpointer data)
+{
+    const IDMatchData *imd = (const IDMatchData *) data;
+    QofBook *book = qof_instance_get_book (object);
+
+    return g_list_find (gncBusinessIDIndexLookup (book, imd->type_name, imd->id),
+                        object) != NULL;
+}
+
+static gsize
+id_index_estimate (QofBook *book, gconstpointer data)
+{
+    const IDMatchData *imd = (const IDMatchData *) data;
+
+    return g_list_length (gncBusinessIDIndexLookup (book, imd->type_name,
+                          imd->id));
+}
+
+static void
+id_index_scan (QofBook *book, gconstpointer data, const GList *and_terms,
+               gboolean reverse, QofQueryVisitFunc visit, gpointer user_data)
+{
+    const IDMatchData *imd = (const IDMatchData *) data;
+    GList *node;
+
+    for (node = gncBusinessIDIndexLookup (book, imd->type_name, imd->id);
+            node; node = node->next)
+    {
+        if (!visit (node->data, user_data))
+            return;
+    }
+}
+
+static const QofQueryIndex id_index =
+{
+    id_index_estimate,
+    id_index_scan,
+    NULL
+};
+
+QofQueryPredicate *
+gncBusinessIDPredicateNew (QofIdTypeConst type_name, const char *id)
+{
+    IDMatchData *imd;
+
+    g_return_val_if_fail (type_name, NULL);
+
+    imd = g_new0 (IDMatchData, 1);
+    imd->type_name = type_name;
+    imd->id = g_strdup (id);
+    return qof_query_predicate_new (id_match, imd, id_match_free, &id_index);
+}
+
 //struct _get_list_userdata
 //{
 //    GList *result;
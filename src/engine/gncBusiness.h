@@ -76,5 +76,34 @@ typedef GList OwnerList;
 //OwnerList * gncBusinessGetOwnerList (QofBook *book, QofIdTypeConst type_name,
 //                                     bool all_including_inactive);
 
+/** @name ID indexes
+ *  Every book keeps, for each business object type, a table from the
+ *  user-visible ID string to the objects of that type carrying it.
+ *  The gncXxxSetID() setters keep it up to date, and objects leave it
+ *  when they are freed, so looking an object up by ID does not have to
+ *  search the book.  IDs are not required to be unique, which is why a
+ *  lookup returns a list.  Empty IDs are not indexed.
+ @{ */
+
+/** Move inst from old_id to new_id in its book's index.  Call before
+ *  the object's id member is changed; either ID may be NULL or empty.
+ *  Nothing is done if they are equal. */
+void gncBusinessIDIndexUpdate (QofInstance *inst, const char *old_id,
+                               const char *new_id);
+
+/** Return the objects of the given type in book whose ID is id, in the
+ *  order they were given it.  The list belongs to the index and is only
+ *  valid until the next ID change in the book; do not modify or free
+ *  it. */
+GList * gncBusinessIDIndexLookup (QofBook *book, QofIdTypeConst type_name,
+                                  const char *id);
+
+/** Return a query predicate matching the objects of the given type
+ *  whose ID is id.  A query for type_name containing it only visits
+ *  the objects in the index under id. */
+QofQueryPredicate * gncBusinessIDPredicateNew (QofIdTypeConst type_name,
+        const char *id);
+
+/** @} */
 
 #endif /* GNC_BUSINESS_H_ */
@@ -193,6 +193,7 @@ static void gncCustomerFree (GncCustomer *cust)
 
     qof_event_gen (cust, QOF_EVENT_DESTROY, NULL);
 
+    gncBusinessIDIndexUpdate (QOF_INSTANCE(cust), cust->id, NULL);
     CACHE_REMOVE (cust->id);
     CACHE_REMOVE (cust->name);
     CACHE_REMOVE (cust->notes);
@@ -231,6 +232,7 @@ void gncCustomerSetID (GncCustomer *cust, const char *id)
 {
     if (!cust) return;
     if (!id) return;
+    gncBusinessIDIndexUpdate (QOF_INSTANCE(cust), cust->id, id);
     SET_STR(cust, cust->id, id);
     mark_customer (cust);
     gncCustomerCommitEdit (cust);
@@ -429,7 +431,7 @@ GncAddress * gncCustomerGetAddr (const GncCustomer *cust)
     return cust->addr;
 }
 
-static void
+void
 qofCustomerSetAddr (GncCustomer *cust, QofInstance *addr_ent)
 {
     GncAddress *addr;
@@ -453,7 +455,7 @@ qofCustomerSetAddr (GncCustomer *cust, QofInstance *addr_ent)
     gncCustomerCommitEdit(cust);
 }
 
-static void
+void
 qofCustomerSetShipAddr (GncCustomer *cust, QofInstance *ship_addr_ent)
 {
     GncAddress *ship_addr;
@@ -87,6 +87,8 @@ void gncCustomerSetCurrency (GncCustomer *customer, gnc_commodity *currency);
 
 void gncCustomerSetTaxTableOverride (GncCustomer *customer, bool override);
 void gncCustomerSetTaxTable (GncCustomer *customer, GncTaxTable *table);
+void qofCustomerSetAddr (GncCustomer *cust, QofInstance *addr_ent);
+void qofCustomerSetShipAddr (GncCustomer *cust, QofInstance *ship_addr_ent);
 
 void gncCustomerAddJob (GncCustomer *customer, GncJob *job);
 void gncCustomerRemoveJob (GncCustomer *customer, GncJob *job);
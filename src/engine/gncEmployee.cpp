@@ -35,6 +35,7 @@
 #include "Account.h"
 #include "gnc-commodity.h"
 #include "gncAddressP.h"
+#include "gncBusiness.h"
 #include "gncEmployee.h"
 #include "gncEmployeeP.h"
 
@@ -157,6 +158,7 @@ static void gncEmployeeFree (GncEmployee *employee)
 
     qof_event_gen (employee, QOF_EVENT_DESTROY, NULL);
 
+    gncBusinessIDIndexUpdate (QOF_INSTANCE(employee), employee->id, NULL);
     CACHE_REMOVE (employee->id);
     CACHE_REMOVE (employee->username);
     CACHE_REMOVE (employee->language);
@@ -186,6 +188,7 @@ void gncEmployeeSetID (GncEmployee *employee, const char *id)
 {
     if (!employee) return;
     if (!id) return;
+    gncBusinessIDIndexUpdate (QOF_INSTANCE(employee), employee->id, id);
     SET_STR(employee, employee->id, id);
     mark_employee (employee);
     gncEmployeeCommitEdit (employee);
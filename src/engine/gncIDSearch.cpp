@@ -23,7 +23,25 @@
 
 #include "gncIDSearch.h"
 
-static void * search(QofBook * book, const gchar *id, void * object, QofIdType type);
+typedef bool (*IDSearchFilter) (gpointer object);
+static void * search(QofBook * book, const gchar *id, QofIdType type,
+                     IDSearchFilter filter);
+
+/* Bills are the invoices of vendors; expense vouchers, the invoices of
+ * employees, are neither bills nor invoices. */
+static bool
+is_bill (gpointer object)
+{
+    return gncInvoiceGetOwnerType ((GncInvoice *) object) == GNC_OWNER_VENDOR;
+}
+
+static bool
+is_invoice (gpointer object)
+{
+    GncOwnerType type = gncInvoiceGetOwnerType ((GncInvoice *) object);
+    return type != GNC_OWNER_VENDOR && type != GNC_OWNER_EMPLOYEE;
+}
+
 /***********************************************************************
  * Search the book for a Customer/Invoice/Bill with the same ID.
  * If it exists return a valid object, if not then returns NULL.
@@ -34,107 +52,62 @@ static void * search(QofBook * book, const gchar *id, void * object, QofIdType t
 GncCustomer *
 gnc_search_customer_on_id (QofBook * book, const gchar *id)
 {
-    GncCustomer *customer = NULL;
-    QofIdType type = GNC_CUSTOMER_MODULE_NAME;
-    customer = (GncCustomer*)search(book, id, customer, type);
-    return customer;
+    return (GncCustomer*)search(book, id, GNC_CUSTOMER_MODULE_NAME, NULL);
 }
 
 GncInvoice *
 gnc_search_invoice_on_id (QofBook * book, const gchar *id)
 {
-    GncInvoice *invoice = NULL;
-    QofIdType type = GNC_INVOICE_MODULE_NAME;
-    invoice = (GncInvoice*)search(book, id, invoice, type);
-    return invoice;
+    return (GncInvoice*)search(book, id, GNC_INVOICE_MODULE_NAME, is_invoice);
 }
 
-/* Essentially identical to above.*/
+/* Invoices and bills are numbered separately, so an invoice and a bill
+ * may share an ID; only bills are returned here. */
 GncInvoice *
 gnc_search_bill_on_id (QofBook * book, const gchar *id)
 {
-    GncInvoice *bill =  NULL;
-    QofIdType type = GNC_INVOICE_MODULE_NAME;
-    bill = (GncInvoice*)search(book, id, bill, type);
-    return bill;
+    return (GncInvoice*)search(book, id, GNC_INVOICE_MODULE_NAME, is_bill);
 }
 
 GncVendor *
 gnc_search_vendor_on_id (QofBook * book, const gchar *id)
 {
-    GncVendor *vendor =  NULL;
-    QofIdType type = GNC_VENDOR_MODULE_NAME;
-    vendor = (GncVendor*)search(book, id, vendor, type);
-    return vendor;
+    return (GncVendor*)search(book, id, GNC_VENDOR_MODULE_NAME, NULL);
+}
+
+GncEmployee *
+gnc_search_employee_on_id (QofBook * book, const gchar *id)
+{
+    return (GncEmployee*)search(book, id, GNC_EMPLOYEE_MODULE_NAME, NULL);
+}
+
+GncJob *
+gnc_search_job_on_id (QofBook * book, const gchar *id)
+{
+    return (GncJob*)search(book, id, GNC_JOB_MODULE_NAME, NULL);
 }
 
 
 /******************************************************************
  * Generic search called after setting up stuff
  * DO NOT call directly but type tests should fail anyway
+ *
+ * Looks the ID up in the book's ID index (see gncBusiness.h) and
+ * returns the first object given that ID which passes the filter.
  ****************************************************************/
-static void * search(QofBook * book, const gchar *id, void * object, QofIdType type)
+static void * search(QofBook * book, const gchar *id, QofIdType type,
+                     IDSearchFilter filter)
 {
-//    void *c;
-//    GList *result;
-//    QofQuery *q;
-//    gint len;
-//    QofQueryPredData* string_pred_data;
-//    g_return_val_if_fail (type, NULL);
-//    g_return_val_if_fail (id, NULL);
-//    g_return_val_if_fail (book, NULL);
-//
-//    // Build the query
-//    q = qof_query_create_for (type);
-//    qof_query_set_book (q, book);
-//    // Search only the id field
-//    string_pred_data = qof_query_string_predicate (QOF_COMPARE_EQUAL, id, QOF_STRING_MATCH_NORMAL, FALSE);
-//
-//    if (strcmp(type, GNC_CUSTOMER_MODULE_NAME))
-//    {
-//        qof_query_add_term (q, qof_query_build_param_list("CUSTOMER_ID"), string_pred_data, QOF_QUERY_AND);
-//    }
-//    else if (strcmp(type, GNC_INVOICE_MODULE_NAME))
-//    {
-//        qof_query_add_term (q, qof_query_build_param_list("INVOICE_ID"), string_pred_data, QOF_QUERY_AND);
-//    }
-//    else if (strcmp(type, GNC_VENDOR_MODULE_NAME))
-//    {
-//        qof_query_add_term (q, qof_query_build_param_list("VENDOR_ID"), string_pred_data, QOF_QUERY_AND);
-//    }
-//
-//
-//    // Run the query
-//    result = qof_query_run (q);
-//
-//    // now compare _exactly_
-//    len = g_list_length (result);
-//    if (result && (len > 0))
-//    {
-//        result = g_list_first (result);
-//
-//        while (result)
-//        {
-//            c = result->data;
-//            if (strcmp(type, GNC_CUSTOMER_MODULE_NAME) && strcmp(id, gncCustomerGetID(c)) == 0)
-//            {
-//                // correct id found
-//                object = c;
-//                break;
-//            }
-//            else if (strcmp(type, GNC_INVOICE_MODULE_NAME) && strcmp(id, gncInvoiceGetID(c)) == 0)
-//            {
-//                object = c;
-//                break;
-//            }
-//            else if (strcmp(type, GNC_VENDOR_MODULE_NAME) && strcmp(id, gncVendorGetID(c)) == 0)
-//            {
-//                object = c;
-//                break;
-//            }
-//            result = g_list_next (result);
-//        }
-//    }
-//    qof_query_destroy (q);
-    return object;
+    GList *node;
+
+    g_return_val_if_fail (type, NULL);
+    g_return_val_if_fail (id, NULL);
+    g_return_val_if_fail (book, NULL);
+
+    for (node = gncBusinessIDIndexLookup (book, type, id); node; node = node->next)
+    {
+        if (!filter || filter (node->data))
+            return node->data;
+    }
+    return NULL;
 }
@@ -35,6 +35,7 @@
 #include "Transaction.h"
 #include "Account.h"
 #include "gncBillTermP.h"
+#include "gncBusiness.h"
 #include "gncEntry.h"
 #include "gncEntryP.h"
 #include "gnc-features.h"
@@ -207,6 +208,7 @@ GncInvoice *gncInvoiceCopy (const GncInvoice *from)
     gncInvoiceBeginEdit(invoice);
 
     invoice->id = CACHE_INSERT (from->id);
+    gncBusinessIDIndexUpdate (QOF_INSTANCE(invoice), NULL, invoice->id);
     invoice->notes = CACHE_INSERT (from->notes);
     invoice->billing_id = CACHE_INSERT (from->billing_id);
     invoice->active = from->active;
@@ -272,6 +274,7 @@ static void gncInvoiceFree (GncInvoice *invoice)
 
     qof_event_gen (invoice, QOF_EVENT_DESTROY, NULL);
 
+    gncBusinessIDIndexUpdate (QOF_INSTANCE(invoice), invoice->id, NULL);
     CACHE_REMOVE (invoice->id);
     CACHE_REMOVE (invoice->notes);
     CACHE_REMOVE (invoice->billing_id);
@@ -294,6 +297,7 @@ static void gncInvoiceFree (GncInvoice *invoice)
 void gncInvoiceSetID (GncInvoice *invoice, const char *id)
 {
     if (!invoice || !id) return;
+    gncBusinessIDIndexUpdate (QOF_INSTANCE(invoice), invoice->id, id);
     SET_STR (invoice, invoice->id, id);
     mark_invoice (invoice);
     gncInvoiceCommitEdit (invoice);
@@ -307,6 +311,7 @@ void gncInvoiceSetOwner (GncInvoice *invoice, GncOwner *owner)
     gncOwnerCopy (owner, &invoice->owner);
     mark_invoice (invoice);
     gncInvoiceCommitEdit (invoice);
+    gncOwnerLotIndexNoteLot (invoice->posted_lot);
 }
 
 static void
@@ -470,6 +475,7 @@ void gncInvoiceSetPostedLot (GncInvoice *invoice, GNCLot *lot)
     invoice->posted_lot = lot;
     mark_invoice (invoice);
     gncInvoiceCommitEdit (invoice);
+    gncOwnerLotIndexNoteLot (lot);
 }
 
 void gncInvoiceSetPostedAcc (GncInvoice *invoice, Account *acc)
@@ -31,6 +31,7 @@
 #include <glib.h>
 #include <string.h>
 
+#include "gncBusiness.h"
 #include "gncInvoice.h"
 #include "gncJob.h"
 #include "gncJobP.h"
@@ -113,6 +114,7 @@ static void gncJobFree (GncJob *job)
 
     qof_event_gen (job, QOF_EVENT_DESTROY, NULL);
 
+    gncBusinessIDIndexUpdate (QOF_INSTANCE(job), job->id, NULL);
     CACHE_REMOVE (job->id);
     CACHE_REMOVE (job->name);
     CACHE_REMOVE (job->desc);
@@ -152,6 +154,7 @@ void gncJobSetID (GncJob *job, const char *id)
 {
     if (!job) return;
     if (!id) return;
+    gncBusinessIDIndexUpdate (QOF_INSTANCE(job), job->id, id);
     SET_STR(job, job->id, id);
     mark_job (job);
     gncJobCommitEdit (job);
@@ -221,6 +224,8 @@ void gncJobSetOwner (GncJob *job, GncOwner *owner)
 
     mark_job (job);
     gncJobCommitEdit (job);
+    /* The job's lots now belong to another end owner */
+    gncOwnerLotIndexInvalidate (qof_instance_get_book (job));
 }
 
 void gncJobSetActive (GncJob *job, bool active)
@@ -45,6 +45,7 @@
 #include "gnc-commodity.h"
 #include "Transaction.h"
 #include "Split.h"
+#include "gnc-lot-p.h"
 #include "engine-helpers.h"
 
 #define _GNC_MOD_NAME   GNC_ID_OWNER
@@ -665,28 +666,297 @@ KvpFrame* gncOwnerGetSlots(GncOwner* owner)
     }
 }
 
+/* Determine the end owner associated to the lot, either through the
+ * invoice posted to it or, for pre-payment lots, from its own slots. */
+static const GncOwner *
+gncOwnerGetEndOwnerFromLot (GNCLot *lot, GncOwner *lot_owner)
+{
+    GncInvoice *invoice = gncInvoiceGetInvoiceFromLot (lot);
+
+    if (invoice)
+        /* Invoice lots */
+        return gncOwnerGetEndOwner (gncInvoiceGetOwner (invoice));
+    else if (gncOwnerGetOwnerFromLot (lot, lot_owner))
+        /* Pre-payment lots */
+        return gncOwnerGetEndOwner (lot_owner);
+    return NULL;
+}
+
 bool
 gncOwnerLotMatchOwnerFunc (GNCLot *lot, gpointer user_data)
 {
     const GncOwner *req_owner = user_data;
     GncOwner lot_owner;
     const GncOwner *end_owner;
-    GncInvoice *invoice = gncInvoiceGetInvoiceFromLot (lot);
 
     /* Determine the owner associated to the lot */
-    if (invoice)
-        /* Invoice lots */
-        end_owner = gncOwnerGetEndOwner (gncInvoiceGetOwner (invoice));
-    else if (gncOwnerGetOwnerFromLot (lot, &lot_owner))
-        /* Pre-payment lots */
-        end_owner = gncOwnerGetEndOwner (&lot_owner);
-    else
+    end_owner = gncOwnerGetEndOwnerFromLot (lot, &lot_owner);
+    if (!end_owner)
         return FALSE;
 
     /* Is this a lot for the requested owner ? */
     return gncOwnerEqual (end_owner, req_owner);
 }
 
+/*********************************************************************/
+/* Owner lot index
+ *
+ * Finding an owner's open lots used to mean running
+ * gncOwnerLotMatchOwnerFunc over every lot of every AR/AP account, once
+ * per owner.  Instead each book keeps an index from end owner to its open
+ * lots, along with the sum of those lots' balances per account.
+ *
+ * The lot code reports every lot that may have changed through
+ * gnc_lot_set_changed_hook; the reports are only queued, and are worked
+ * off the next time the index is consulted.  That keeps the cost off the
+ * paths that load or edit many lots at once, and means a lot is resolved
+ * once the invoice or owner it refers to has been loaded too.
+ */
+
+#define GNC_OWNER_LOT_INDEX "gncOwnerLotIndex"
+
+typedef struct
+{
+    Account *account;
+    gnc_numeric balance;
+} OwnerAccountBalance;
+
+/* The open lots of one end owner */
+struct OwnerLots
+{
+    LotList_t lots;
+    std::list<OwnerAccountBalance> balances;
+};
+
+/* What an open owner lot contributed to the index when it was added */
+typedef struct
+{
+    gconstpointer owner;
+    Account *account;
+    gnc_numeric balance;
+} IndexedLot;
+
+typedef struct
+{
+    GHashTable *owners;     /* end owner entity -> OwnerLots */
+    GHashTable *lots;       /* GNCLot -> IndexedLot, open owner lots only */
+    GHashTable *pending;    /* lots reported changed since the last refresh */
+    bool built;
+} OwnerLotIndex;
+
+static void owner_lot_changed (GNCLot *lot, bool destroyed);
+
+static void
+owner_lots_free (gpointer data)
+{
+    delete (OwnerLots *) data;
+}
+
+static void
+owner_lot_index_destroy (QofBook *book, gpointer key, gpointer data)
+{
+    OwnerLotIndex *idx = (OwnerLotIndex *) data;
+
+    g_hash_table_destroy (idx->owners);
+    g_hash_table_destroy (idx->lots);
+    g_hash_table_destroy (idx->pending);
+    g_free (idx);
+    /* The lots are destroyed after the book's finalizers have run */
+    qof_book_set_data (book, GNC_OWNER_LOT_INDEX, NULL);
+}
+
+static OwnerLotIndex *
+owner_lot_index_get (QofBook *book, bool create)
+{
+    OwnerLotIndex *idx;
+
+    if (!book) return NULL;
+    idx = (OwnerLotIndex *) qof_book_get_data (book, GNC_OWNER_LOT_INDEX);
+    if (idx || !create || qof_book_shutting_down (book))
+        return idx;
+
+    idx = g_new0 (OwnerLotIndex, 1);
+    idx->owners = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                         NULL, owner_lots_free);
+    idx->lots = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                       NULL, g_free);
+    idx->pending = g_hash_table_new (g_direct_hash, g_direct_equal);
+    idx->built = FALSE;
+    qof_book_set_data_fin (book, GNC_OWNER_LOT_INDEX, idx,
+                           owner_lot_index_destroy);
+    gnc_lot_set_changed_hook (owner_lot_changed);
+    return idx;
+}
+
+static void
+owner_lots_add_balance (OwnerLots *ol, Account *account, gnc_numeric amount)
+{
+    std::list<OwnerAccountBalance>::iterator it;
+
+    for (it = ol->balances.begin(); it != ol->balances.end(); it++)
+    {
+        if (it->account == account)
+        {
+            it->balance = gnc_numeric_add_fixed (it->balance, amount);
+            return;
+        }
+    }
+
+    OwnerAccountBalance entry;
+    entry.account = account;
+    entry.balance = amount;
+    ol->balances.push_back (entry);
+}
+
+static void
+owner_lot_index_remove_lot (OwnerLotIndex *idx, GNCLot *lot)
+{
+    IndexedLot *il = (IndexedLot *) g_hash_table_lookup (idx->lots, lot);
+    OwnerLots *ol;
+
+    if (!il) return;
+
+    ol = (OwnerLots *) g_hash_table_lookup (idx->owners, il->owner);
+    if (ol)
+    {
+        ol->lots.remove (lot);
+        owner_lots_add_balance (ol, il->account, gnc_numeric_neg (il->balance));
+    }
+    g_hash_table_remove (idx->lots, lot);
+}
+
+static void
+owner_lot_index_add_lot (OwnerLotIndex *idx, GNCLot *lot)
+{
+    GncOwner lot_owner;
+    const GncOwner *end_owner;
+    IndexedLot *il;
+    OwnerLots *ol;
+
+    if (gnc_lot_is_closed (lot))
+        return;
+
+    end_owner = gncOwnerGetEndOwnerFromLot (lot, &lot_owner);
+    if (!end_owner || !end_owner->owner.undefined)
+        return;
+
+    il = g_new0 (IndexedLot, 1);
+    il->owner = end_owner->owner.undefined;
+    il->account = gnc_lot_get_account (lot);
+    il->balance = gnc_lot_get_balance (lot);
+    g_hash_table_insert (idx->lots, lot, il);
+
+    ol = (OwnerLots *) g_hash_table_lookup (idx->owners, il->owner);
+    if (!ol)
+    {
+        ol = new OwnerLots;
+        g_hash_table_insert (idx->owners, (gpointer) il->owner, ol);
+    }
+    ol->lots.push_back (lot);
+    owner_lots_add_balance (ol, il->account, il->balance);
+}
+
+static void
+owner_lot_index_build_cb (QofInstance *inst, gpointer data)
+{
+    owner_lot_index_add_lot ((OwnerLotIndex *) data, (GNCLot *) inst);
+}
+
+/* Brings the index up to date and returns it */
+static OwnerLotIndex *
+owner_lot_index_refresh (QofBook *book)
+{
+    OwnerLotIndex *idx = owner_lot_index_get (book, TRUE);
+    GHashTableIter iter;
+    gpointer lot;
+
+    if (!idx) return NULL;
+
+    if (!idx->built)
+    {
+        g_hash_table_remove_all (idx->owners);
+        g_hash_table_remove_all (idx->lots);
+        qof_collection_foreach (qof_book_get_collection (book, GNC_ID_LOT),
+                                owner_lot_index_build_cb, idx);
+        idx->built = TRUE;
+    }
+    else
+    {
+        g_hash_table_iter_init (&iter, idx->pending);
+        while (g_hash_table_iter_next (&iter, &lot, NULL))
+        {
+            owner_lot_index_remove_lot (idx, (GNCLot *) lot);
+            owner_lot_index_add_lot (idx, (GNCLot *) lot);
+        }
+    }
+    g_hash_table_remove_all (idx->pending);
+    return idx;
+}
+
+static void
+owner_lot_changed (GNCLot *lot, bool destroyed)
+{
+    QofBook *book = gnc_lot_get_book (lot);
+    OwnerLotIndex *idx;
+
+    /* The index is gone, or about to go, with the book. */
+    if (!book || qof_book_shutting_down (book))
+        return;
+
+    /* Nothing to keep up to date before the first lookup. */
+    idx = owner_lot_index_get (book, FALSE);
+    if (!idx || !idx->built)
+        return;
+
+    if (destroyed)
+    {
+        owner_lot_index_remove_lot (idx, lot);
+        g_hash_table_remove (idx->pending, lot);
+    }
+    else
+        g_hash_table_insert (idx->pending, lot, lot);
+}
+
+void
+gncOwnerLotIndexNoteLot (GNCLot *lot)
+{
+    if (lot)
+        owner_lot_changed (lot, FALSE);
+}
+
+void
+gncOwnerLotIndexInvalidate (QofBook *book)
+{
+    OwnerLotIndex *idx = owner_lot_index_get (book, FALSE);
+
+    if (idx)
+        idx->built = FALSE;
+}
+
+LotList_t
+gncOwnerGetOpenLots (const GncOwner *owner, const Account *account)
+{
+    OwnerLotIndex *idx;
+    OwnerLots *ol;
+    LotList_t retval;
+
+    if (!owner || !owner->owner.undefined) return retval;
+
+    idx = owner_lot_index_refresh (qof_instance_get_book (qofOwnerGetOwner (owner)));
+    if (!idx) return retval;
+
+    ol = (OwnerLots *) g_hash_table_lookup (idx->owners, owner->owner.undefined);
+    if (!ol) return retval;
+
+    for (LotList_t::iterator it = ol->lots.begin(); it != ol->lots.end(); it++)
+    {
+        if (!account || gnc_lot_get_account (*it) == account)
+            retval.push_back (*it);
+    }
+    retval.sort (gncOwnerLotsSortWeakOrder);
+    return retval;
+}
+
 gint
 gncOwnerLotsSortFunc (GNCLot *lotA, GNCLot *lotB)
 {
@@ -1054,8 +1324,7 @@ gncOwnerApplyPayment (const GncOwner *owner, Transaction *txn, LotList_t lots,
     if (!lots.empty())
         selected_lots = lots;
     else
-        selected_lots = xaccAccountFindOpenLots (posted_acc, gncOwnerLotMatchOwnerFunc,
-                                                 (gpointer)owner);
+        selected_lots = gncOwnerGetOpenLots (owner, posted_acc);
 
     /* And link the selected lots and the payment lot together as well as possible.
      * If the payment was bigger than the selected documents/overpayments, only
@@ -1107,43 +1376,48 @@ gncOwnerGetBalanceInCurrency (const GncOwner *owner,
     gnc_numeric balance = gnc_numeric_zero ();
     GList  *acct_types;
     QofBook *book;
+    Account *root;
     gnc_commodity *owner_currency;
     GNCPriceDB *pdb;
+    OwnerLotIndex *idx;
+    OwnerLots *ol;
 
     g_return_val_if_fail (owner, gnc_numeric_zero ());
 
-    /* Get account list */
     book       = qof_instance_get_book (qofOwnerGetOwner (owner));
-    std::list<Account*> acct_list  = gnc_account_get_descendants (gnc_book_get_root_account (book));
+    root       = gnc_book_get_root_account (book);
     acct_types = gncOwnerGetAccountTypesList (owner);
     owner_currency = gncOwnerGetCurrency (owner);
 
-    /* For each account */
-    for (std::list<Account*>::iterator acct_node = acct_list.begin();
-            acct_node != acct_list.end(); acct_node++)
+    /* Sum the open lot balances the index keeps for this owner, per
+       account, over the accounts that can hold lots for the owner */
+    idx = owner_lot_index_refresh (book);
+    ol = idx ? (OwnerLots *) g_hash_table_lookup (idx->owners,
+            owner->owner.undefined) : NULL;
+    if (ol)
     {
-        Account *account = *acct_node;
+        std::list<OwnerAccountBalance>::iterator it;
 
-        /* Check if this account can have lots for the owner, otherwise skip to next */
-        if (g_list_index (acct_types, (gpointer)xaccAccountGetType (account))
-                == -1)
-            continue;
+        for (it = ol->balances.begin(); it != ol->balances.end(); it++)
+        {
+            Account *account = it->account;
 
+            /* Check if this account can have lots for the owner, otherwise skip to next */
+            if (g_list_index (acct_types, (gpointer)xaccAccountGetType (account))
+                    == -1)
+                continue;
 
-        if (!gnc_commodity_equal (owner_currency, xaccAccountGetCommodity (account)))
-            continue;
+            if (!gnc_commodity_equal (owner_currency, xaccAccountGetCommodity (account)))
+                continue;
 
-        /* Get a list of open lots for this owner and account */
-        LotList_t lot_list = xaccAccountFindOpenLots (account, gncOwnerLotMatchOwnerFunc,
-                                            (gpointer)owner);
-        for (LotList_t::iterator it = lot_list.begin(); it != lot_list.end(); it++)
-        {
-            GNCLot *lot = *it;
-            gnc_numeric lot_balance = gnc_lot_get_balance (lot);
-            balance = gnc_numeric_add (balance, lot_balance,
+            if (gnc_account_get_root (account) != root)
+                continue;
+
+            balance = gnc_numeric_add (balance, it->balance,
                                        gnc_commodity_get_fraction (owner_currency), GNC_HOW_RND_ROUND_HALF_UP);
         }
     }
+    g_list_free (acct_types);
 
     pdb = gnc_pricedb_get_db (book);
 
@@ -195,6 +195,14 @@ bool gncOwnerLotsSortWeakOrder(GNCLot *lotA, GNCLot *lotB);
  */
 bool gncOwnerGetOwnerFromLot (GNCLot *lot, GncOwner *owner);
 
+/** Get the open lots of the owner, as gncOwnerLotMatchOwnerFunc would
+ * select them, sorted with gncOwnerLotsSortFunc.  If account is not NULL
+ * only the lots in that account are returned.  The lots are found
+ * through an index the book keeps of each owner's open lots, rather than
+ * by scanning all lots.
+ */
+LotList_t gncOwnerGetOpenLots (const GncOwner *owner, const Account *account);
+
 bool gncOwnerGetOwnerFromTypeGuid (QofBook *book, GncOwner *owner, QofIdType type, GncGUID *guid);
 
 /** Get the kvp-frame from the underlying owner object */
@@ -32,5 +32,14 @@
 
 bool gncOwnerRegister (void);
 
+/** Tells the owner lot index that the owner of a lot may have changed,
+ *  for changes the lot itself does not see, such as an invoice being
+ *  given its posted lot or a new owner. */
+void gncOwnerLotIndexNoteLot (GNCLot *lot);
+
+/** Has the owner lot index of the book rebuilt on its next use, for
+ *  changes that move many lots at once, such as a job changing owner. */
+void gncOwnerLotIndexInvalidate (QofBook *book);
+
 
 #endif /* GNC_OWNERP_H_ */
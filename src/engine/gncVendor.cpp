@@ -35,6 +35,7 @@
 #include "gnc-commodity.h"
 #include "gncAddressP.h"
 #include "gncBillTermP.h"
+#include "gncBusiness.h"
 #include "gncInvoice.h"
 #include "gncJobP.h"
 #include "gncTaxTableP.h"
@@ -44,9 +45,6 @@
 static gint gs_address_event_handler_id = 0;
 static void listen_for_address_events(QofInstance *entity, QofEventId event_type,
                                       gpointer user_data, gpointer event_data);
-static void qofVendorSetAddr (GncVendor *vendor, QofInstance *addr_ent);
-static const char* qofVendorGetTaxIncluded(const GncVendor *vendor);
-static void qofVendorSetTaxIncluded(GncVendor *vendor, const char* type_string);
 
 static QofLogModule log_module = GNC_MOD_BUSINESS;
 
@@ -168,6 +166,7 @@ static void gncVendorFree (GncVendor *vendor)
 
     qof_event_gen (vendor, QOF_EVENT_DESTROY, NULL);
 
+    gncBusinessIDIndexUpdate (QOF_INSTANCE(vendor), vendor->id, NULL);
     CACHE_REMOVE (vendor->id);
     CACHE_REMOVE (vendor->name);
     CACHE_REMOVE (vendor->notes);
@@ -202,6 +201,7 @@ void gncVendorSetID (GncVendor *vendor, const char *id)
 {
     if (!vendor) return;
     if (!id) return;
+    gncBusinessIDIndexUpdate (QOF_INSTANCE(vendor), vendor->id, id);
     SET_STR(vendor, vendor->id, id);
     mark_vendor (vendor);
     gncVendorCommitEdit (vendor);
@@ -296,7 +296,7 @@ void gncVendorSetTaxTable (GncVendor *vendor, GncTaxTable *table)
     gncVendorCommitEdit (vendor);
 }
 
-static void
+void
 qofVendorSetAddr (GncVendor *vendor, QofInstance *addr_ent)
 {
     GncAddress *addr;
@@ -320,7 +320,7 @@ qofVendorSetAddr (GncVendor *vendor, QofInstance *addr_ent)
     gncVendorCommitEdit(vendor);
 }
 
-static void
+void
 qofVendorSetTaxIncluded(GncVendor *vendor, const char* type_string)
 {
     GncTaxIncluded inc;
@@ -397,7 +397,7 @@ GncTaxTable* gncVendorGetTaxTable (const GncVendor *vendor)
     return vendor->taxtable;
 }
 
-static const char*
+const char*
 qofVendorGetTaxIncluded(const GncVendor *vendor)
 {
     return gncTaxIncludedTypeToString(vendor->taxincluded);
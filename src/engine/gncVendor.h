@@ -58,6 +58,8 @@ void gncVendorSetCurrency (GncVendor *vendor, gnc_commodity *currency);
 void gncVendorSetActive (GncVendor *vendor, bool active);
 void gncVendorSetTaxTableOverride (GncVendor *vendor, bool override);
 void gncVendorSetTaxTable (GncVendor *vendor, GncTaxTable *table);
+void qofVendorSetAddr (GncVendor *vendor, QofInstance *addr_ent);
+void qofVendorSetTaxIncluded (GncVendor *vendor, const char* type_string);
 
 /** @} */
 
@@ -78,6 +80,7 @@ const char * gncVendorGetNotes (const GncVendor *vendor);
 GncBillTerm * gncVendorGetTerms (const GncVendor *vendor);
 GncTaxIncluded gncVendorGetTaxIncluded (const GncVendor *vendor);
 gnc_commodity * gncVendorGetCurrency (const GncVendor *vendor);
+const char * qofVendorGetTaxIncluded (const GncVendor *vendor);
 bool gncVendorGetActive (const GncVendor *vendor);
 
 bool gncVendorGetTaxTableOverride (const GncVendor *vendor);
@@ -27,6 +27,7 @@
 #include <glib.h>
 
 #include "gnc-commodity.h"
+#include "gnc-pricedb-p.h"
 #include "qof.h"
 #include "test-engine-stuff.h"
 #include "test-stuff.h"
@@ -181,6 +182,130 @@ test_commodity(void)
 
 }
 
+static void
+test_pricedb_add_quotes(void)
+{
+    QofBook *book;
+    GNCPriceDB *db;
+    gnc_commodity *com, *cur;
+    GNCPriceQuote quotes[5];
+    PriceList *prices;
+    guint64 generation;
+    guint i;
+
+    book = qof_book_new ();
+    db = gnc_pricedb_get_db (book);
+    com = gnc_commodity_new (book, "Stock", "NASDAQ", "STK", NULL, 100);
+    cur = gnc_commodity_new (book, "Dollar", "ISO4217", "USD", NULL, 100);
+
+    for (i = 0; i < 5; i++)
+    {
+        quotes[i].commodity = com;
+        quotes[i].currency = cur;
+        quotes[i].time = timespecCanonicalDayTime (
+                             gnc_dmy2timespec (1 + i, 3, 2014));
+        quotes[i].value = gnc_numeric_create (1000 + i, 100);
+        quotes[i].source = "Finance::Quote";
+        quotes[i].type = "last";
+    }
+    /* An exact repeat and a repeat later the same day */
+    quotes[3] = quotes[1];
+    quotes[4] = quotes[2];
+    quotes[4].time.tv_sec += 3600;
+
+    generation = gnc_pricedb_get_generation (db);
+    do_test (gnc_pricedb_add_quotes (db, quotes, 5) == 3,
+             "duplicate quotes in a batch added once");
+    do_test (gnc_pricedb_get_generation (db) == generation + 1,
+             "one generation bump per batch");
+
+    prices = gnc_pricedb_get_prices (db, com, cur);
+    do_test (g_list_length (prices) == 3, "batch prices in the db");
+    for (i = 0; prices && prices->next && i < 2; i++, prices = prices->next)
+    {
+        Timespec t1 = gnc_price_get_time (prices->data);
+        Timespec t2 = gnc_price_get_time (prices->next->data);
+        do_test (timespec_cmp (&t1, &t2) > 0, "prices sorted newest first");
+    }
+
+    quotes[0].time = timespecCanonicalDayTime (gnc_dmy2timespec (10, 3, 2014));
+    do_test (gnc_pricedb_add_quotes (db, quotes, 3) == 1,
+             "quotes already in the db skipped");
+    do_test (gnc_pricedb_get_num_prices (db) == 4, "merged price count");
+    do_test (gnc_price_get_value (gnc_pricedb_lookup_latest (db, com, cur)).num
+             == 1000, "merged quote is the latest price");
+
+    gnc_pricedb_set_bulk_update (db, TRUE);
+    do_test (gnc_pricedb_add_quotes (db, quotes, 3) == 3,
+             "bulk update skips the db duplicate check");
+    gnc_pricedb_set_bulk_update (db, FALSE);
+
+    qof_book_destroy (book);
+}
+
+/* A batch big enough to be split across all the worker shards */
+#define SHARDED_COMMODITIES 8
+#define SHARDED_DAYS 2048
+
+static void
+test_pricedb_add_quotes_sharded(void)
+{
+    QofBook *book;
+    GNCPriceDB *db;
+    gnc_commodity *coms[SHARDED_COMMODITIES], *cur;
+    GNCPriceQuote *quotes;
+    guint n_quotes = SHARDED_COMMODITIES * SHARDED_DAYS;
+    guint c, d, n_sorted;
+
+    book = qof_book_new ();
+    db = gnc_pricedb_get_db (book);
+    cur = gnc_commodity_new (book, "Dollar", "ISO4217", "USD", NULL, 100);
+    for (c = 0; c < SHARDED_COMMODITIES; c++)
+    {
+        gchar *mnemonic = g_strdup_printf ("STK%u", c);
+        coms[c] = gnc_commodity_new (book, mnemonic, "NASDAQ", mnemonic, NULL, 100);
+        g_free (mnemonic);
+    }
+
+    quotes = g_new (GNCPriceQuote, n_quotes);
+    for (d = 0; d < SHARDED_DAYS; d++)
+        for (c = 0; c < SHARDED_COMMODITIES; c++)
+        {
+            GNCPriceQuote *q = &quotes[d * SHARDED_COMMODITIES + c];
+            q->commodity = coms[c];
+            q->currency = cur;
+            q->time = timespecCanonicalDayTime (gnc_dmy2timespec (1, 1, 2000));
+            q->time.tv_sec += (time64) d * 24 * 60 * 60;
+            q->value = gnc_numeric_create (1000 + d, 100);
+            q->source = "Finance::Quote";
+            q->type = "last";
+        }
+
+    do_test (gnc_pricedb_add_quotes (db, quotes, n_quotes) == n_quotes,
+             "every quote of a sharded batch added");
+    for (c = 0; c < SHARDED_COMMODITIES; c++)
+    {
+        PriceList *prices = gnc_pricedb_get_prices (db, coms[c], cur);
+        PriceList *node;
+
+        do_test (g_list_length (prices) == SHARDED_DAYS,
+                 "each commodity has all of its prices");
+        n_sorted = 0;
+        for (node = prices; node && node->next; node = node->next)
+        {
+            Timespec t1 = gnc_price_get_time (node->data);
+            Timespec t2 = gnc_price_get_time (node->next->data);
+            if (timespec_cmp (&t1, &t2) > 0)
+                n_sorted++;
+        }
+        do_test (n_sorted == SHARDED_DAYS - 1, "sharded prices sorted newest first");
+        gnc_price_list_destroy (prices);
+    }
+
+    g_free (quotes);
+    qof_book_destroy (book);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -188,8 +313,11 @@ main (int argc, char **argv)
 
     qof_book_register ();
     gnc_commodity_table_register();
+    gnc_pricedb_register();
 
     test_commodity();
+    test_pricedb_add_quotes();
+    test_pricedb_add_quotes_sharded();
 
     print_test_results();
 
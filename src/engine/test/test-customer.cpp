@@ -28,7 +28,9 @@
 #include <glib.h>
 #include "qof.h"
 #include "cashobjects.h"
+#include "gncBusiness.h"
 #include "gncCustomerP.h"
+#include "gncIDSearch.h"
 #include "gncInvoiceP.h"
 #include "gncJobP.h"
 #include "test-stuff.h"
@@ -131,6 +133,46 @@ test_customer (void)
         do_test (gncCustomerLookup (book, guid) == customer, "Entity Table");
     }
 
+    /* Test the ID index */
+    {
+        GncCustomer *other = gncCustomerCreate (book);
+
+        gncCustomerSetID (customer, "C-0001");
+        gncCustomerSetID (other, "C-0002");
+        do_test (gnc_search_customer_on_id (book, "C-0001") == customer,
+                 "search on id");
+        do_test (gnc_search_customer_on_id (book, "C-0002") == other,
+                 "search on other id");
+        do_test (gnc_search_vendor_on_id (book, "C-0001") == NULL,
+                 "search on id of another type");
+
+        gncCustomerSetID (other, "C-0003");
+        do_test (gnc_search_customer_on_id (book, "C-0002") == NULL,
+                 "search on changed id");
+        do_test (gnc_search_customer_on_id (book, "C-0003") == other,
+                 "search on new id");
+
+        {
+            QofQuery *q = qof_query_create_for (GNC_ID_CUSTOMER);
+            GList *results;
+
+            qof_query_set_book (q, book);
+            qof_query_add_term (q, gncBusinessIDPredicateNew (GNC_ID_CUSTOMER,
+                                "C-0003"), QOF_QUERY_AND);
+            results = qof_query_run (q);
+            do_test (g_list_length (results) == 1 && results->data == other,
+                     "query on id");
+            qof_query_destroy (q);
+        }
+
+        gncCustomerBeginEdit (other);
+        gncCustomerDestroy (other);
+        do_test (gnc_search_customer_on_id (book, "C-0003") == NULL,
+                 "search on id of destroyed customer");
+        do_test (gnc_search_customer_on_id (book, "C-0001") == customer,
+                 "search on id after destroy");
+    }
+
     /* Note: JobList is tested from the Job tests */
     qof_book_destroy (book);
 }
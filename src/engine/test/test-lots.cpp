@@ -31,6 +31,8 @@
 #include "qof.h"
 #include "Account.h"
 #include "Scrub3.h"
+#include "cap-gains.h"
+#include "gnc-lot.h"
 #include "cashobjects.h"
 #include "test-stuff.h"
 #include "test-engine-stuff.h"
@@ -39,6 +41,163 @@
 static gint transaction_num = 320;
 static gint	max_iterate = 10;
 
+static Split *
+make_trade (QofBook *book, Account *stock, Account *cash,
+            gnc_commodity *currency, int day, gint64 shares, gint64 cost)
+{
+    Transaction *trans = xaccMallocTransaction (book);
+    Split *stock_split = xaccMallocSplit (book);
+    Split *cash_split = xaccMallocSplit (book);
+
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, currency);
+    xaccTransSetDatePostedSecs (trans, 1262304000 + day * 86400);
+    xaccSplitSetAccount (stock_split, stock);
+    xaccSplitSetAmount (stock_split, gnc_numeric_create (shares, 1));
+    xaccSplitSetValue (stock_split, gnc_numeric_create (cost, 1));
+    xaccTransAppendSplit (trans, stock_split);
+    xaccSplitSetAccount (cash_split, cash);
+    xaccSplitSetAmount (cash_split, gnc_numeric_create (-cost, 1));
+    xaccSplitSetValue (cash_split, gnc_numeric_create (-cost, 1));
+    xaccTransAppendSplit (trans, cash_split);
+    xaccTransCommitEdit (trans);
+    return stock_split;
+}
+
+static Account *
+make_account (QofBook *book, const char *name, GNCAccountType type,
+              gnc_commodity *commodity)
+{
+    Account *acc = xaccMallocAccount (book);
+
+    xaccAccountBeginEdit (acc);
+    xaccAccountSetName (acc, name);
+    xaccAccountSetType (acc, type);
+    xaccAccountSetCommodity (acc, commodity);
+    gnc_account_append_child (gnc_book_get_root_account (book), acc);
+    xaccAccountCommitEdit (acc);
+    return acc;
+}
+
+static guint
+count_transactions (QofBook *book)
+{
+    return qof_collection_count (qof_book_get_collection (book, GNC_ID_TRANS));
+}
+
+/* Ten shares bought for 100, then sold in three lots whose gains are
+ * known: 3 for 45 (gain 15), 4 for 32 (loss 8) and 3 for 60 (gain 30).
+ * A dry run must report exactly those and change nothing; the real
+ * sweep must record them; a changed sale must show up as the one
+ * change, again without a dry run touching the recorded gains. */
+static void
+test_gains_sweep (void)
+{
+    QofBook *book = qof_book_new ();
+    gnc_commodity_table *table = gnc_commodity_table_get_table (book);
+    gnc_commodity *usd = gnc_commodity_new (book, "US Dollar",
+                                            GNC_COMMODITY_NS_CURRENCY,
+                                            "USD", "840", 100);
+    gnc_commodity *foo = gnc_commodity_new (book, "Foo Corp", "NASDAQ",
+                                            "FOO", NULL, 1);
+    Account *stock, *cash;
+    GNCLot *lot;
+    Split *sales[3];
+    gint64 gains[3] = { 15, -8, 30 };
+    CapGainsChangeList_t changes;
+    CapGainsChangeList_t::iterator c;
+    guint n_trans;
+    int i;
+
+    /* The book may already have its own USD */
+    usd = gnc_commodity_table_insert (table, usd);
+    foo = gnc_commodity_table_insert (table, foo);
+    stock = make_account (book, "Foo", ACCT_TYPE_STOCK, foo);
+    cash = make_account (book, "Cash", ACCT_TYPE_BANK, usd);
+
+    lot = gnc_lot_new (book);
+    gnc_lot_add_split (lot, make_trade (book, stock, cash, usd, 0, 10, 100));
+    sales[0] = make_trade (book, stock, cash, usd, 1, -3, -45);
+    sales[1] = make_trade (book, stock, cash, usd, 2, -4, -32);
+    sales[2] = make_trade (book, stock, cash, usd, 3, -3, -60);
+    for (i = 0; i < 3; i++)
+        gnc_lot_add_split (lot, sales[i]);
+
+    n_trans = count_transactions (book);
+    changes = xaccLotComputeCapGainsSweep (lot, NULL, TRUE);
+    do_test_args (changes.size () == 3, "dry run change count",
+                  __FILE__, __LINE__, "%d changes", (int)changes.size ());
+    for (c = changes.begin(), i = 0; c != changes.end() && i < 3; c++, i++)
+    {
+        do_test_args (c->split == sales[i] &&
+                      gnc_numeric_equal (c->new_gains,
+                                         gnc_numeric_create (gains[i], 1)) &&
+                      gnc_numeric_zero_p (c->old_gains),
+                      "dry run gains", __FILE__, __LINE__,
+                      "sale %d: gains %s", i,
+                      gnc_num_dbg_to_string (c->new_gains));
+    }
+    do_test (count_transactions (book) == n_trans &&
+             gnc_lot_get_split_list (lot).size () == 4,
+             "dry run leaves the book alone");
+    for (i = 0; i < 3; i++)
+        do_test (xaccSplitGetCapGainsSplit (sales[i]) == NULL &&
+                 gnc_numeric_equal (xaccSplitGetValue (sales[i]),
+                                    gnc_numeric_create (i == 0 ? -45 :
+                                            i == 1 ? -32 : -60, 1)),
+                 "dry run leaves the sales alone");
+
+    changes = xaccLotComputeCapGainsSweep (lot, NULL, FALSE);
+    do_test (changes.size () == 3, "sweep change count");
+    do_test (count_transactions (book) == n_trans + 3,
+             "sweep made the gains transactions");
+    for (i = 0; i < 3; i++)
+        do_test_args (gnc_numeric_equal (xaccSplitGetCapGains (sales[i]),
+                                         gnc_numeric_create (gains[i], 1)) &&
+                      xaccSplitGetCapGainsSplit (sales[i]) &&
+                      xaccSplitGetLot (xaccSplitGetCapGainsSplit (sales[i])) == lot,
+                      "sweep gains", __FILE__, __LINE__, "sale %d: gains %s", i,
+                      gnc_num_dbg_to_string (xaccSplitGetCapGains (sales[i])));
+    do_test (xaccLotComputeCapGainsSweep (lot, NULL, TRUE).empty (),
+             "nothing left to change after the sweep");
+
+    /* Selling the four shares for 36 instead makes it a loss of 4 */
+    {
+        Transaction *trans = xaccSplitGetParent (sales[1]);
+        Split *gains_split = xaccSplitGetCapGainsSplit (sales[1]);
+
+        xaccTransBeginEdit (trans);
+        xaccSplitSetValue (sales[1], gnc_numeric_create (-36, 1));
+        xaccSplitSetAmount (xaccSplitGetOtherSplit (sales[1]),
+                            gnc_numeric_create (36, 1));
+        xaccSplitSetValue (xaccSplitGetOtherSplit (sales[1]),
+                           gnc_numeric_create (36, 1));
+        xaccTransCommitEdit (trans);
+
+        n_trans = count_transactions (book);
+        changes = xaccLotComputeCapGainsSweep (lot, NULL, TRUE);
+        do_test_args (changes.size () == 1 &&
+                      changes.front ().split == sales[1] &&
+                      gnc_numeric_equal (changes.front ().old_gains,
+                                         gnc_numeric_create (-8, 1)) &&
+                      gnc_numeric_equal (changes.front ().new_gains,
+                                         gnc_numeric_create (-4, 1)),
+                      "dry run after a change", __FILE__, __LINE__,
+                      "%d changes", (int)changes.size ());
+        do_test (count_transactions (book) == n_trans &&
+                 xaccSplitGetCapGainsSplit (sales[1]) == gains_split &&
+                 gnc_numeric_equal (xaccSplitGetValue (gains_split),
+                                    gnc_numeric_create (-8, 1)) &&
+                 !xaccTransIsOpen (xaccSplitGetParent (gains_split)),
+                 "dry run leaves the recorded gains alone");
+
+        xaccLotComputeCapGainsSweep (lot, NULL, FALSE);
+        do_test (gnc_numeric_equal (xaccSplitGetValue (gains_split),
+                                    gnc_numeric_create (-4, 1)),
+                 "sweep records the changed gains");
+    }
+}
+
 static void
 run_test (void)
 {
@@ -58,6 +217,21 @@ run_test (void)
     root = gnc_book_get_root_account (book);
     xaccAccountTreeScrubLots (root);
 
+    /* Scrubbing computed the gains, so a dry run over every lot must
+     * find nothing left to change. */
+    {
+        AccountList_t accounts = gnc_account_get_descendants (root);
+        int changes = 0;
+        for (AccountList_t::iterator a = accounts.begin(); a != accounts.end(); a++)
+        {
+            LotList_t lots = xaccAccountGetLotList (*a);
+            for (LotList_t::iterator l = lots.begin(); l != lots.end(); l++)
+                changes += xaccLotComputeCapGainsSweep (*l, NULL, TRUE).size ();
+        }
+        do_test_args (changes == 0, "gains sweep after scrub", __FILE__, __LINE__,
+                      "%d gains would still change", changes);
+    }
+
     /* --------------------------------------------------------- */
     /* In the second test, we create an account with unrealized gains,
      * and see if that gets fixed correctly, with the correct balances,
@@ -81,6 +255,8 @@ main (int argc, char **argv)
     /* Any tests that cause an error or warning to be printed
      * automatically fail! */
     g_log_set_always_fatal( G_LOG_LEVEL_CRITICAL | G_LOG_LEVEL_WARNING );
+    test_gains_sweep ();
+
     /* Set up a reproducible test-case */
     srand(0);
     /* Iterate the test a number of times */
@@ -23,48 +23,210 @@
 
 #include "config.h"
 #include <glib.h>
+#include <stdio.h>
 #include "qof.h"
 #include "cashobjects.h"
+#include "Query.h"
 #include "Transaction.h"
 #include "TransLog.h"
 #include "gnc-engine.h"
 #include "test-engine-stuff.h"
 #include "test-stuff.h"
 
+/* The number of most recent splits a register shows by default. */
+#define LIMIT 50
+
+static gboolean
+same_results (GList *a, GList *b)
+{
+    for (; a && b; a = a->next, b = b->next)
+        if (a->data != b->data)
+            return FALSE;
+    return a == NULL && b == NULL;
+}
+
+/* A query for the splits of acc which can only be answered by
+ * examining every split in the book. */
+static QofQuery *
+make_scan_query (QofBook *book, Account *acc, const AccountList_t &all)
+{
+    QofQuery *q = qof_query_create_for (GNC_ID_SPLIT);
+    AccountList_t others;
+
+    for (AccountList_t::const_iterator it = all.begin(); it != all.end(); it++)
+        if (*it != acc)
+            others.push_back (*it);
+
+    qof_query_set_book (q, book);
+    qof_query_set_sort (q, xaccQuerySplitOrder, TRUE);
+    xaccQueryAddAccountMatch (q, others, QOF_GUID_MATCH_NONE, QOF_QUERY_AND);
+    return q;
+}
+
+static QofQuery *
+make_account_query (QofBook *book, Account *acc)
+{
+    QofQuery *q = qof_query_create_for (GNC_ID_SPLIT);
+
+    qof_query_set_book (q, book);
+    qof_query_set_sort (q, xaccQuerySplitOrder, TRUE);
+    xaccQueryAddSingleAccountMatch (q, acc, QOF_QUERY_AND);
+    return q;
+}
+
 static int
 test_trans_query (Transaction *trans, gpointer data)
 {
-//    QofBook *book = data;
-//    GList *list;
-//    QofQuery *q;
-//
-//    q = make_trans_query (trans, ALL_QT);
-//    qof_query_set_book (q, book);
-//
-//    list = xaccQueryGetTransactions (q, QUERY_TXN_MATCH_ANY);
-//    if (g_list_length (list) != 1)
-//    {
-//        failure_args ("test number returned", __FILE__, __LINE__,
-//                      "number of matching transactions %d not 1",
-//                      g_list_length (list));
-//        g_list_free (list);
-//        return 13;
-//    }
-//
-//    if (list->data != trans)
-//    {
-//        failure ("matching transaction is wrong");
-//        g_list_free (list);
-//        return 13;
-//    }
-//
-//    success ("found right transaction");
-//    qof_query_destroy (q);
-//    g_list_free (list);
+    QofBook *book = (QofBook *) data;
+    GList *list, *node;
+    QofQuery *q;
+
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    xaccQueryAddGUIDMatch (q, xaccTransGetGUID (trans), GNC_ID_TRANS,
+                           QOF_QUERY_AND);
+
+    list = qof_query_run (q);
+    if ((int) g_list_length (list) != xaccTransCountSplits (trans))
+    {
+        failure_args ("test number returned", __FILE__, __LINE__,
+                      "number of matching splits %d not %d",
+                      g_list_length (list), xaccTransCountSplits (trans));
+        qof_query_destroy (q);
+        return 13;
+    }
+
+    for (node = list; node; node = node->next)
+    {
+        if (xaccSplitGetParent ((Split *) node->data) != trans)
+        {
+            failure ("matching split is wrong");
+            qof_query_destroy (q);
+            return 13;
+        }
+    }
+
+    if (xaccQueryGetSplitsUniqueTrans (q).size () != 1)
+    {
+        failure ("splits of one transaction not unique");
+        qof_query_destroy (q);
+        return 13;
+    }
+
+    success ("found right transaction");
+    qof_query_destroy (q);
 
     return 0;
 }
 
+/* An unsorted query with max_results stops at the first matches;
+ * check it returns that many splits of acc, through the account's
+ * index and through a scan of the book. */
+static void
+test_unsorted_limit (QofBook *book, Account *acc, const AccountList_t &all)
+{
+    gsize expected = MIN ((gsize) 5, xaccAccountGetSplitListRef (acc).size ());
+    QofQuery *queries[2];
+    int i;
+
+    queries[0] = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (queries[0], book);
+    xaccQueryAddSingleAccountMatch (queries[0], acc, QOF_QUERY_AND);
+    queries[1] = make_scan_query (book, acc, all);
+    qof_query_set_sort (queries[1], NULL, TRUE);
+
+    for (i = 0; i < 2; i++)
+    {
+        GList *node, *found;
+        gboolean ok;
+
+        qof_query_set_max_results (queries[i], 5);
+        found = qof_query_run (queries[i]);
+        ok = ((gsize) g_list_length (found) == expected);
+        for (node = found; node; node = node->next)
+            ok = ok && xaccSplitGetAccount ((Split *) node->data) == acc;
+        do_test (ok, "unsorted limited query stops at the limit");
+        qof_query_destroy (queries[i]);
+    }
+}
+
+/* The limited account query walks back from the end of the account;
+ * it must find what a full scan of the book finds. */
+static void
+test_account_query (QofBook *book, Account *root)
+{
+    AccountList_t all = gnc_account_get_descendants (root);
+
+    for (AccountList_t::const_iterator it = all.begin(); it != all.end(); it++)
+    {
+        Account *acc = *it;
+        const SplitList_t &splits = xaccAccountGetSplitListRef (acc);
+        QofQuery *indexed = make_account_query (book, acc);
+        QofQuery *scan = make_scan_query (book, acc, all);
+
+        do_test ((gsize) g_list_length (qof_query_run (indexed)) == splits.size (),
+                 "account query finds all splits");
+        do_test (same_results (qof_query_run (indexed), qof_query_run (scan)),
+                 "account query agrees with scan");
+
+        qof_query_set_max_results (indexed, 5);
+        qof_query_set_max_results (scan, 5);
+        do_test (same_results (qof_query_run (indexed), qof_query_run (scan)),
+                 "limited account query agrees with scan");
+
+        qof_query_set_sort (indexed, xaccQuerySplitOrder, FALSE);
+        qof_query_set_sort (scan, xaccQuerySplitOrder, FALSE);
+        do_test (same_results (qof_query_run (indexed), qof_query_run (scan)),
+                 "decreasing limited query agrees with scan");
+
+        if (!splits.empty ())
+        {
+            SplitList_t::const_iterator mid = splits.begin ();
+            time64 date;
+
+            std::advance (mid, splits.size () / 2);
+            date = xaccTransGetDate (xaccSplitGetParent (*mid));
+            xaccQueryAddDateMatchTT (indexed, FALSE, 0, TRUE, date, QOF_QUERY_AND);
+            xaccQueryAddDateMatchTT (scan, FALSE, 0, TRUE, date, QOF_QUERY_AND);
+            do_test (same_results (qof_query_run (indexed), qof_query_run (scan)),
+                     "dated account query agrees with scan");
+        }
+
+        qof_query_destroy (indexed);
+        qof_query_destroy (scan);
+
+        test_unsorted_limit (book, acc, all);
+    }
+
+    /* Two accounts merged in split order */
+    if (all.size () >= 2)
+    {
+        Account *a = all.front ();
+        Account *b = all.back ();
+        QofQuery *qa = make_account_query (book, a);
+        QofQuery *qb = make_account_query (book, b);
+        QofQuery *q = qof_query_merge (qa, qb, QOF_QUERY_OR);
+        AccountList_t pair;
+        QofQuery *both = qof_query_create_for (GNC_ID_SPLIT);
+
+        pair.push_back (a);
+        pair.push_back (b);
+        qof_query_set_book (both, book);
+        qof_query_set_sort (both, xaccQuerySplitOrder, TRUE);
+        qof_query_set_max_results (both, 7);
+        xaccQueryAddAccountMatch (both, pair, QOF_GUID_MATCH_ANY, QOF_QUERY_AND);
+        qof_query_set_max_results (q, 7);
+
+        do_test (same_results (qof_query_run (q), qof_query_run (both)),
+                 "merged account queries agree");
+
+        qof_query_destroy (both);
+        qof_query_destroy (q);
+        qof_query_destroy (qb);
+        qof_query_destroy (qa);
+    }
+}
+
 static void
 run_test (void)
 {
@@ -79,7 +241,69 @@ run_test (void)
     add_random_transactions_to_book (book, 20);
 
     xaccAccountTreeForEachTransaction (root, test_trans_query, book);
+    test_account_query (book, root);
+
+    qof_session_end (session);
+}
+
+/* Opening a register asks for the most recent splits of an account.
+ * Time answering that from the account's split list against scanning
+ * every split in the book. */
+static void
+test_query_benchmark (void)
+{
+    QofSession *session = get_random_session ();
+    QofBook *book = qof_session_get_book (session);
+    Account *root = gnc_book_get_root_account (book);
+    AccountList_t all;
+    Account *busiest = NULL;
+    QofQuery *indexed, *scan;
+    GTimer *timer;
+    double indexed_secs, scan_secs;
+    const int runs = 20;
+    int i;
+
+    add_random_transactions_to_book (book, 2000);
+
+    all = gnc_account_get_descendants (root);
+    for (AccountList_t::const_iterator it = all.begin(); it != all.end(); it++)
+    {
+        if (!busiest || xaccAccountGetSplitListRef (*it).size ()
+                > xaccAccountGetSplitListRef (busiest).size ())
+            busiest = *it;
+    }
+    if (!busiest)
+    {
+        qof_session_end (session);
+        return;
+    }
+
+    indexed = make_account_query (book, busiest);
+    scan = make_scan_query (book, busiest, all);
+    qof_query_set_max_results (indexed, LIMIT);
+    qof_query_set_max_results (scan, LIMIT);
+
+    timer = g_timer_new ();
+    for (i = 0; i < runs; i++)
+        qof_query_run (scan);
+    scan_secs = g_timer_elapsed (timer, NULL);
+
+    g_timer_start (timer);
+    for (i = 0; i < runs; i++)
+        qof_query_run (indexed);
+    indexed_secs = g_timer_elapsed (timer, NULL);
+    g_timer_destroy (timer);
+
+    printf ("Last %d of %d splits in a book of %d: scanned %.4fs, indexed %.4fs\n",
+            LIMIT, (int) xaccAccountGetSplitListRef (busiest).size (),
+            qof_collection_count (qof_book_get_collection (book, GNC_ID_SPLIT)),
+            scan_secs / runs, indexed_secs / runs);
+    do_test (same_results (qof_query_last_run (indexed),
+                           qof_query_last_run (scan)),
+             "benchmark queries agree");
 
+    qof_query_destroy (indexed);
+    qof_query_destroy (scan);
     qof_session_end (session);
 }
 
@@ -106,6 +330,7 @@ main (int argc, char **argv)
     {
         run_test ();
     }
+    test_query_benchmark ();
     success("queries seem to work");
 
 cleanup:
@@ -325,6 +325,78 @@ static void test_some()
     test_specific(PERIOD_DAY, 7,    4, 1, 2000,    4, 8, 2000,  4, 15, 2000);
 }
 
+#define NUM_INSTANCES_TO_TEST 60
+
+/* The directly computed instances must be the ones found by stepping
+   through recurrenceNextInstance from the start date. */
+static void test_closed_form()
+{
+    Recurrence r;
+    GDate d_start, d_step, d_nth, d_before;
+    guint16 mult;
+    PeriodType pt;
+    WeekendAdjust wadj;
+    gint32 j1;
+    guint n;
+
+    for (pt = PERIOD_ONCE; pt < NUM_PERIOD_TYPES; pt = static_cast<int>(pt) + 1)
+    {
+        for (wadj = WEEKEND_ADJ_NONE; wadj < NUM_WEEKEND_ADJS; wadj = static_cast<int>(wadj)+1)
+        {
+            for (j1 = JULIAN_START; j1 < JULIAN_START + 400; j1 += 3)
+            {
+                g_date_set_julian(&d_start, j1);
+                for (mult = 1; mult < 4; mult++)
+                {
+                    RecurrenceList_t rlist;
+                    std::list<GDate> dates;
+                    GDate d_range_start, d_range_end;
+
+                    g_date_clear(&d_range_start, 1);
+                    g_date_clear(&d_range_end, 1);
+
+                    recurrenceSet(&r, mult, pt, &d_start, wadj);
+                    d_step = recurrenceGetDate(&r);
+                    for (n = 0; n < NUM_INSTANCES_TO_TEST && g_date_valid(&d_step); n++)
+                    {
+                        recurrenceNthInstance(&r, n, &d_nth);
+                        if (!test_equal(&d_nth, &d_step))
+                            printf("pt = %d; mult = %d; wadj = %d; n = %u\n",
+                                   pt, mult, wadj, n);
+                        do_test(recurrenceCountInstances(&r, &d_step) == n + 1,
+                                "instance count on an instance");
+                        d_before = d_step;
+                        g_date_subtract_days(&d_before, 1);
+                        do_test(recurrenceCountInstances(&r, &d_before) == n,
+                                "instance count before an instance");
+
+                        if (n == 5)
+                            d_range_start = d_step;
+                        if (n == 20)
+                            d_range_end = d_step;
+                        d_nth = d_step;
+                        recurrenceNextInstance(&r, &d_nth, &d_step);
+                    }
+
+                    if (pt == PERIOD_ONCE)
+                        continue;
+
+                    rlist.push_back(&r);
+                    rlist.push_back(&r);
+                    recurrenceListGetInstancesInRange(rlist, &d_range_start,
+                                                      &d_range_end, dates);
+                    do_test(dates.size() == 16, "instances in range");
+                    for (n = 5; !dates.empty(); n++, dates.pop_front())
+                    {
+                        recurrenceNthInstance(&r, n, &d_nth);
+                        test_equal(&dates.front(), &d_nth);
+                    }
+                }
+            }
+        }
+    }
+}
+
 static void test_use()
 {
     Recurrence *r = new Recurrence;
@@ -342,6 +414,8 @@ static void test_main()
 
     test_some();
 
+    test_closed_form();
+
     test_all();
 
     qof_book_destroy (book);
@@ -1729,6 +1729,66 @@ test_gnc_account_lookup_by_full_name (Fixture *fixture, gconstpointer pData)
     g_free (code);
 }
 
+/* The lookup tables and cached full names have to follow renames and
+ * moves made after they were built. */
+static void
+test_gnc_account_lookup_index (Fixture *fixture, gconstpointer pData)
+{
+    Account *root, *income, *taxable, *exempt, *div1, *gift, *target;
+    AccountList_t list;
+
+    root = gnc_account_get_root (fixture->acct);
+    income = gnc_account_lookup_by_name (root, "income");
+    taxable = gnc_account_lookup_by_full_name (root, "income:taxable");
+    exempt = gnc_account_lookup_by_full_name (root, "income:exempt");
+    div1 = gnc_account_lookup_by_name (root, "div1");
+    gift = gnc_account_lookup_by_code (root, "4220");
+    g_assert (taxable != NULL && exempt != NULL && div1 != NULL);
+    g_assert (gnc_account_lookup_by_name (root, "gift") == gift);
+    /* The children of taxable are searched before those of exempt. */
+    target = gnc_account_lookup_by_name (income, "int");
+    g_assert_cmpstr (xaccAccountGetCode (target), == , "4160");
+    g_assert (gnc_account_lookup_by_full_name (root, "") == NULL);
+
+    /* Rename an account without children. */
+    xaccAccountSetName (gift, "present");
+    g_assert (gnc_account_lookup_by_name (root, "gift") == NULL);
+    g_assert (gnc_account_lookup_by_name (exempt, "present") == gift);
+    g_assert (gnc_account_lookup_by_full_name (root, "income:exempt:present")
+              == gift);
+    g_assert_cmpstr (gnc_account_get_full_name_const (gift), == ,
+                     "income:exempt:present");
+    xaccAccountSetCode (gift, "4225");
+    g_assert (gnc_account_lookup_by_code (root, "4220") == NULL);
+    g_assert (gnc_account_lookup_by_code (root, "4225") == gift);
+
+    /* Rename one with children. */
+    xaccAccountSetName (taxable, "earned");
+    g_assert (gnc_account_lookup_by_full_name (root, "income:taxable:int")
+              == NULL);
+    target = gnc_account_lookup_by_full_name (root, "income:earned:int");
+    g_assert (target != NULL);
+    g_assert_cmpstr (xaccAccountGetCode (target), == , "4160");
+    g_assert_cmpstr (gnc_account_get_full_name_const (target), == ,
+                     "income:earned:int");
+
+    /* Move a subtree. */
+    g_assert_cmpint (gnc_account_n_descendants (exempt), == , 3);
+    gnc_account_append_child (exempt, div1);
+    g_assert (gnc_account_lookup_by_name (taxable, "qdiv") == NULL);
+    target = gnc_account_lookup_by_full_name (root, "income:exempt:div1:qdiv");
+    g_assert (target != NULL);
+    g_assert (gnc_account_lookup_by_name (exempt, "qdiv") == target);
+    g_assert_cmpstr (xaccAccountGetCode (target), == , "4141");
+    g_assert (gnc_account_lookup_by_code (exempt, "4142") != NULL);
+    g_assert_cmpint (gnc_account_n_descendants (exempt), == , 6);
+    g_assert_cmpint (gnc_account_n_descendants (root), == , 34);
+    list = gnc_account_get_descendants (exempt);
+    g_assert_cmpuint (list.size(), == , 6);
+    g_assert (list.back() == gnc_account_lookup_by_name (div1, "odiv"));
+    g_assert_cmpint (list_index_of (list, div1), == , 3);
+}
+
 static void
 thunk (Account *s, gpointer data)
 {
@@ -1944,6 +2004,66 @@ test_xaccAccountGetPresentBalance (Fixture *fixture, gconstpointer pData)
     dval = gnc_numeric_to_double (val);
     g_assert_cmpfloat (dval, == , dbal);
 }
+/* xaccAccountGetBalanceInCurrency
+gnc_numeric
+xaccAccountGetBalanceInCurrency (const Account *acc,
+                                 const gnc_commodity *report_commodity,
+                                 bool include_children)
+The subtree totals are cached; check that the cache follows changes to
+balances and to the tree below the account asked about.
+*/
+static void
+test_xaccAccountGetBalanceInCurrency (void)
+{
+    QofBook *book = qof_book_new ();
+    gnc_commodity *commodity = gnc_commodity_new (book, "US Dollar", "CURRENCY", "USD", "0", 100);
+    Account *parent = xaccMallocAccount (book);
+    Account *child = xaccMallocAccount (book);
+    Account *grandchild = xaccMallocAccount (book);
+    Account *other = xaccMallocAccount (book);
+    Account *accts[] = { parent, child, grandchild, other };
+    gnc_numeric bal;
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (accts); i++)
+    {
+        xaccAccountBeginEdit (accts[i]);
+        xaccAccountSetCommodity (accts[i], commodity);
+        xaccAccountCommitEdit (accts[i]);
+        gnc_account_set_start_balance (accts[i], gnc_numeric_create (100 * (i + 1), 100));
+        xaccAccountRecomputeBalance (accts[i]);
+    }
+    gnc_account_append_child (parent, child);
+    gnc_account_append_child (child, grandchild);
+
+    bal = xaccAccountGetBalanceInCurrency (parent, NULL, TRUE);
+    g_assert (gnc_numeric_equal (bal, gnc_numeric_create (600, 100)));
+    /* Asking again comes from the cache and must not change. */
+    bal = xaccAccountGetBalanceInCurrency (parent, NULL, TRUE);
+    g_assert (gnc_numeric_equal (bal, gnc_numeric_create (600, 100)));
+    bal = xaccAccountGetBalanceInCurrency (parent, NULL, FALSE);
+    g_assert (gnc_numeric_equal (bal, gnc_numeric_create (100, 100)));
+
+    /* A balance change deep in the tree reaches every ancestor. */
+    gnc_account_set_start_balance (grandchild, gnc_numeric_create (1000, 100));
+    xaccAccountRecomputeBalance (grandchild);
+    bal = xaccAccountGetBalanceInCurrency (parent, NULL, TRUE);
+    g_assert (gnc_numeric_equal (bal, gnc_numeric_create (1300, 100)));
+    bal = xaccAccountGetBalanceInCurrency (child, NULL, TRUE);
+    g_assert (gnc_numeric_equal (bal, gnc_numeric_create (1200, 100)));
+
+    /* So do accounts moving in and out of the tree. */
+    gnc_account_append_child (grandchild, other);
+    bal = xaccAccountGetBalanceInCurrency (parent, NULL, TRUE);
+    g_assert (gnc_numeric_equal (bal, gnc_numeric_create (1700, 100)));
+    gnc_account_remove_child (child, grandchild);
+    bal = xaccAccountGetBalanceInCurrency (parent, NULL, TRUE);
+    g_assert (gnc_numeric_equal (bal, gnc_numeric_create (300, 100)));
+    bal = xaccAccountGetBalanceInCurrency (grandchild, NULL, TRUE);
+    g_assert (gnc_numeric_equal (bal, gnc_numeric_create (1400, 100)));
+
+    qof_book_destroy (book);
+}
 /*
  * xaccAccountConvertBalanceToCurrency
  * xaccAccountConvertBalanceToCurrencyAsOfDate are wrappers around
@@ -2502,6 +2622,7 @@ test_suite_account (void)
     GNC_TEST_ADD (suitename, "gnc account lookup by code", Fixture, &complex, setup, test_gnc_account_lookup_by_code,  teardown );
     GNC_TEST_ADD (suitename, "gnc account lookup by full name helper", Fixture, &complex, setup, test_gnc_account_lookup_by_full_name_helper,  teardown );
     GNC_TEST_ADD (suitename, "gnc account lookup by full name", Fixture, &complex, setup, test_gnc_account_lookup_by_full_name,  teardown );
+    GNC_TEST_ADD (suitename, "gnc account lookup index", Fixture, &complex, setup, test_gnc_account_lookup_index,  teardown );
     GNC_TEST_ADD (suitename, "gnc account foreach child", Fixture, &complex, setup, test_gnc_account_foreach_child,  teardown );
     GNC_TEST_ADD (suitename, "gnc account foreach descendant", Fixture, &complex, setup, test_gnc_account_foreach_descendant,  teardown );
     GNC_TEST_ADD (suitename, "gnc account foreach descendant until", Fixture, &complex, setup, test_gnc_account_foreach_descendant_until,  teardown );
@@ -2509,6 +2630,7 @@ test_suite_account (void)
     GNC_TEST_ADD (suitename, "xaccAccountGetProjectedMinimumBalance", Fixture, &some_data, setup, test_xaccAccountGetProjectedMinimumBalance,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetBalanceAsOfDate", Fixture, &some_data, setup, test_xaccAccountGetBalanceAsOfDate,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetPresentBalance", Fixture, &some_data, setup, test_xaccAccountGetPresentBalance,  teardown );
+    GNC_TEST_ADD_FUNC (suitename, "xaccAccountGetBalanceInCurrency", test_xaccAccountGetBalanceInCurrency);
     GNC_TEST_ADD (suitename, "xaccAccountFindOpenLots", Fixture, &complex_data, setup, test_xaccAccountFindOpenLots,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountForEachLot", Fixture, &complex_data, setup, test_xaccAccountForEachLot,  teardown );
 
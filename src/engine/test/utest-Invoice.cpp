@@ -25,6 +25,9 @@
 #include <qof.h>
 #include <unittest-support.h>
 #include "../gncInvoice.h"
+#include "../gnc-lot-p.h"
+#include "../Split.h"
+#include "../Transaction.h"
 
 static const gchar *suitename = "/engine/gncInvoice";
 void test_suite_gncInvoice ( void );
@@ -88,8 +91,146 @@ test_invoice_post ( Fixture *fixture, gconstpointer pData )
     g_assert(!gncInvoiceIsPosted(invoice));
 }
 
+static void
+test_owner_open_lots ( Fixture *fixture, gconstpointer pData )
+{
+    Account *root = gnc_book_get_root_account(fixture->book);
+    Account *other = xaccMallocAccount(fixture->book);
+    Transaction *txn = xaccMallocTransaction(fixture->book);
+    Split *split = xaccMallocSplit(fixture->book);
+    Split *o_split = xaccMallocSplit(fixture->book);
+    GNCLot *lot = gnc_lot_new(fixture->book);
+    gnc_numeric amount = gnc_numeric_create(1000, 100);
+    LotList_t lots;
+
+    xaccAccountBeginEdit(fixture->account);
+    xaccAccountSetType(fixture->account, ACCT_TYPE_RECEIVABLE);
+    xaccAccountCommitEdit(fixture->account);
+    gnc_account_append_child(root, fixture->account);
+    xaccAccountSetCommodity(other, fixture->commodity);
+    gnc_account_append_child(root, other);
+    gncCustomerSetCurrency(fixture->customer, fixture->commodity);
+
+    /* No lots yet */
+    g_assert(gncOwnerGetOpenLots(&fixture->owner, NULL).empty());
+    g_assert(gnc_numeric_zero_p(gncOwnerGetBalanceInCurrency(&fixture->owner, NULL)));
+
+    xaccTransBeginEdit(txn);
+    xaccTransSetCurrency(txn, fixture->commodity);
+    xaccSplitSetAccount(split, fixture->account);
+    xaccSplitSetParent(split, txn);
+    xaccSplitSetAmount(split, amount);
+    xaccSplitSetValue(split, amount);
+    xaccSplitSetAccount(o_split, other);
+    xaccSplitSetParent(o_split, txn);
+    xaccSplitSetAmount(o_split, gnc_numeric_neg(amount));
+    xaccSplitSetValue(o_split, gnc_numeric_neg(amount));
+    xaccTransCommitEdit(txn);
+    gnc_lot_add_split(lot, split);
+
+    /* The lot isn't the owner's until it is attached to it */
+    g_assert(gncOwnerGetOpenLots(&fixture->owner, NULL).empty());
+    gncOwnerAttachToLot(&fixture->owner, lot);
+    lots = gncOwnerGetOpenLots(&fixture->owner, NULL);
+    g_assert_cmpint(lots.size(), ==, 1);
+    g_assert(lots.front() == lot);
+    g_assert(gncOwnerGetOpenLots(&fixture->owner, other).empty());
+    g_assert(gnc_numeric_equal(gncOwnerGetBalanceInCurrency(&fixture->owner, NULL),
+                               amount));
+
+    /* Split amount changes reach the cached balance */
+    xaccTransBeginEdit(txn);
+    xaccSplitSetAmount(split, gnc_numeric_create(400, 100));
+    xaccSplitSetValue(split, gnc_numeric_create(400, 100));
+    xaccSplitSetAmount(o_split, gnc_numeric_create(-400, 100));
+    xaccSplitSetValue(o_split, gnc_numeric_create(-400, 100));
+    xaccTransCommitEdit(txn);
+    g_assert(gnc_numeric_equal(gncOwnerGetBalanceInCurrency(&fixture->owner, NULL),
+                               gnc_numeric_create(400, 100)));
+
+    /* and a lot that closes leaves the index */
+    xaccTransBeginEdit(txn);
+    xaccSplitSetAmount(split, gnc_numeric_zero());
+    xaccSplitSetValue(split, gnc_numeric_zero());
+    xaccSplitSetAmount(o_split, gnc_numeric_zero());
+    xaccSplitSetValue(o_split, gnc_numeric_zero());
+    xaccTransCommitEdit(txn);
+    g_assert(gncOwnerGetOpenLots(&fixture->owner, NULL).empty());
+    g_assert(gnc_numeric_zero_p(gncOwnerGetBalanceInCurrency(&fixture->owner, NULL)));
+
+    xaccTransBeginEdit(txn);
+    xaccTransDestroy(txn);
+    xaccTransCommitEdit(txn);
+}
+
+/* Destroying a book whose owner lot index was built must not reach the
+ * index from the lots destroyed after the book's finalizers have run. */
+static void
+test_owner_open_lots_book_destroy ( void )
+{
+    QofBook *book;
+    Account *root;
+    Account *account;
+    Account *other;
+    gnc_commodity *commodity;
+    GncCustomer *customer;
+    Transaction *txn;
+    Split *split;
+    Split *o_split;
+    GNCLot *lot;
+    gnc_numeric amount = gnc_numeric_create(1000, 100);
+    GncOwner owner;
+
+    /* Lots are only destroyed with the book once their object is known */
+    qof_init();
+    gnc_lot_register();
+
+    book = qof_book_new();
+    root = gnc_book_get_root_account(book);
+    account = xaccMallocAccount(book);
+    other = xaccMallocAccount(book);
+    commodity = gnc_commodity_new(book, "foo", "bar", "xy", "xy", 100);
+    customer = gncCustomerCreate(book);
+    txn = xaccMallocTransaction(book);
+    split = xaccMallocSplit(book);
+    o_split = xaccMallocSplit(book);
+    lot = gnc_lot_new(book);
+
+    xaccAccountBeginEdit(account);
+    xaccAccountSetType(account, ACCT_TYPE_RECEIVABLE);
+    xaccAccountSetCommodity(account, commodity);
+    xaccAccountCommitEdit(account);
+    gnc_account_append_child(root, account);
+    xaccAccountSetCommodity(other, commodity);
+    gnc_account_append_child(root, other);
+    gncCustomerSetCurrency(customer, commodity);
+    gncOwnerInitCustomer(&owner, customer);
+
+    xaccTransBeginEdit(txn);
+    xaccTransSetCurrency(txn, commodity);
+    xaccSplitSetAccount(split, account);
+    xaccSplitSetParent(split, txn);
+    xaccSplitSetAmount(split, amount);
+    xaccSplitSetValue(split, amount);
+    xaccSplitSetAccount(o_split, other);
+    xaccSplitSetParent(o_split, txn);
+    xaccSplitSetAmount(o_split, gnc_numeric_neg(amount));
+    xaccSplitSetValue(o_split, gnc_numeric_neg(amount));
+    xaccTransCommitEdit(txn);
+    gnc_lot_add_split(lot, split);
+    gncOwnerAttachToLot(&owner, lot);
+
+    /* Build the index */
+    g_assert_cmpint(gncOwnerGetOpenLots(&owner, NULL).size(), ==, 1);
+    g_assert(qof_book_get_data(book, "gncOwnerLotIndex") != NULL);
+
+    qof_book_destroy(book);
+}
+
 void
 test_suite_gncInvoice ( void )
 {
     GNC_TEST_ADD( suitename, "post", Fixture, NULL, setup, test_invoice_post, teardown );
+    GNC_TEST_ADD( suitename, "owner open lots", Fixture, NULL, setup, test_owner_open_lots, teardown );
+    GNC_TEST_ADD_FUNC( suitename, "owner open lots book destroy", test_owner_open_lots_book_destroy );
 }
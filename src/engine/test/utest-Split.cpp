@@ -1250,6 +1250,62 @@ test_xaccSplitOrder (Fixture *fixture, gconstpointer pData)
     delete o_split;
     delete o_txn;
 }
+/* xaccSplitOrderNumSource
+int
+xaccSplitOrderNumSource (const Split *sa, const Split *sb, bool action_for_num)
+*/
+static void
+test_xaccSplitOrderNumSource (Fixture *fixture, gconstpointer pData)
+{
+    Split *split = fixture->split;
+    Split *o_split = xaccMallocSplit (xaccSplitGetBook (split));
+    Transaction *txn = split->parent;
+    Transaction *o_txn = xaccMallocTransaction (xaccSplitGetBook (split));
+
+    o_split->parent = o_txn;
+    txn->date_posted = timespec_now ();
+    o_txn->date_posted = txn->date_posted;
+/* Non-zero, so that committing the edits doesn't stamp them */
+    txn->date_entered = txn->date_posted;
+    o_txn->date_entered = txn->date_posted;
+    xaccTransSetNum (txn, "10");
+    xaccTransSetNum (o_txn, "9");
+    xaccSplitSetAction (split, "1");
+    xaccSplitSetAction (o_split, "2");
+
+/* The number comes from the transactions or from the split actions */
+    g_assert_cmpint (xaccSplitOrderNumSource (split, o_split, FALSE), >, 0);
+    g_assert_cmpint (xaccSplitOrderNumSource (split, o_split, TRUE), <, 0);
+
+/* The cached numbers follow the setters */
+    xaccTransSetNum (o_txn, "11");
+    g_assert_cmpint (xaccSplitOrderNumSource (split, o_split, FALSE), <, 0);
+    xaccSplitSetAction (o_split, "0");
+    g_assert_cmpint (xaccSplitOrderNumSource (split, o_split, TRUE), >, 0);
+
+/* and so do the cached description, memo and action keys */
+    xaccTransSetNum (o_txn, "10");
+    xaccTransSetDescription (txn, "b");
+    xaccTransSetDescription (o_txn, "a");
+    g_assert_cmpint (xaccSplitOrderNumSource (split, o_split, FALSE), >, 0);
+    xaccTransSetDescription (o_txn, "c");
+    g_assert_cmpint (xaccSplitOrderNumSource (split, o_split, FALSE), <, 0);
+
+    xaccTransSetDescription (o_txn, "b");
+    xaccSplitSetMemo (o_split, "zzz");
+    g_assert_cmpint (xaccSplitOrderNumSource (split, o_split, FALSE), <, 0);
+    xaccSplitSetMemo (o_split, "aaa");
+    g_assert_cmpint (xaccSplitOrderNumSource (split, o_split, FALSE), >, 0);
+
+    xaccSplitSetMemo (o_split, xaccSplitGetMemo (split));
+    xaccSplitSetAction (o_split, "a");
+    g_assert_cmpint (xaccSplitOrderNumSource (split, o_split, FALSE), <, 0);
+    g_assert_cmpint (xaccSplitOrderNumSource (split, o_split, FALSE), ==,
+                     xaccSplitOrder (split, o_split));
+
+    delete o_split;
+    delete o_txn;
+}
 /* xaccSplitOrderDateOnly
 gint
 xaccSplitOrderDateOnly (const Split *sa, const Split *sb)// C: 2 in 1 
@@ -1952,6 +2008,7 @@ test_suite_split (void)
     GNC_TEST_ADD_FUNC (suitename, "xaccSplitConvertAmount", test_xaccSplitConvertAmount);
     GNC_TEST_ADD_FUNC (suitename, "xaccSplitDestroy", test_xaccSplitDestroy);
     GNC_TEST_ADD (suitename, "xaccSplitOrder", Fixture, NULL, setup, test_xaccSplitOrder, teardown);
+    GNC_TEST_ADD (suitename, "xaccSplitOrderNumSource", Fixture, NULL, setup, test_xaccSplitOrderNumSource, teardown);
     GNC_TEST_ADD (suitename, "xaccSplitOrderDateOnly", Fixture, NULL, setup, test_xaccSplitOrderDateOnly, teardown);
     GNC_TEST_ADD (suitename, "get corr account split", Fixture, NULL, setup, test_get_corr_account_split, teardown);
     GNC_TEST_ADD (suitename, "xaccSplitGetCorrAccountFullName", Fixture, NULL, setup, test_xaccSplitGetCorrAccountFullName, teardown);
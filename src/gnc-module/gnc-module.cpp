@@ -9,10 +9,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include <gmodule.h>
+#include <glib/gstdio.h>
 #include <sys/types.h>
 #include <dirent.h>
 
 #include "gnc-module.h"
+#include "gnc-filepath-utils.h"
 #include "libqof/qof/qof.h"
 
 /* This static indicates the debugging module that this .o belongs to.  */
@@ -42,6 +44,13 @@ typedef struct
 
 static GNCModuleInfo * gnc_module_get_info(const char * lib_path);
 
+/* The manifest remembers what gnc_module_get_info found in each
+ * library, so that a library which hasn't changed since needn't be
+ * dlopened again until it is actually loaded.  It is a key file with
+ * a group per library, named by its full path. */
+#define MANIFEST_GROUP   "Manifest"
+#define MANIFEST_VERSION 1
+
 /*************************************************************
  * gnc_module_system_search_dirs
  * return a list of dirs to look in for gnc_module libraries
@@ -116,6 +125,146 @@ gnc_module_system_search_dirs(void)
     return list;
 }
 
+/*************************************************************
+ * gnc_module_manifest_*
+ * the cache of module information kept between runs
+ *************************************************************/
+
+static gchar *
+gnc_module_manifest_filename(void)
+{
+    const char *path = g_getenv("GNC_MODULE_MANIFEST");
+
+    /* an empty GNC_MODULE_MANIFEST turns the manifest off */
+    if (path)
+        return *path ? g_strdup(path) : NULL;
+
+    return gnc_build_dotgnucash_path("module-manifest");
+}
+
+static GKeyFile *
+gnc_module_manifest_load(const gchar * filename)
+{
+    GKeyFile *manifest = g_key_file_new();
+
+    if (!filename)
+        return manifest;
+
+    if (!g_key_file_load_from_file(manifest, filename, G_KEY_FILE_NONE, NULL)
+            || (g_key_file_get_integer(manifest, MANIFEST_GROUP, "version", NULL)
+                != MANIFEST_VERSION))
+    {
+        g_key_file_free(manifest);
+        manifest = g_key_file_new();
+    }
+    return manifest;
+}
+
+/* Look fullpath up in the manifest.  Returns TRUE if the entry is
+ * still valid for the file, in which case *info is its module
+ * information, or NULL if it isn't a gnc_module. */
+static gboolean
+gnc_module_manifest_lookup(GKeyFile * manifest, const char * fullpath,
+                           const GStatBuf * st, GNCModuleInfo ** info)
+{
+    GError *error = NULL;
+    GNCModuleInfo *mi;
+    gint64 mtime, size;
+
+    *info = NULL;
+    if (!g_key_file_has_group(manifest, fullpath))
+        return FALSE;
+
+    mtime = g_key_file_get_int64(manifest, fullpath, "mtime", &error);
+    if (!error)
+        size = g_key_file_get_int64(manifest, fullpath, "size", &error);
+    if (error)
+    {
+        g_error_free(error);
+        return FALSE;
+    }
+    if (mtime != (gint64) st->st_mtime || size != (gint64) st->st_size)
+        return FALSE;
+
+    if (!g_key_file_get_boolean(manifest, fullpath, "module", NULL))
+        return TRUE;
+
+    mi = g_new0(GNCModuleInfo, 1);
+    mi->module_path = g_key_file_get_string(manifest, fullpath, "path", NULL);
+    mi->module_description = g_key_file_get_string(manifest, fullpath,
+                             "description", NULL);
+    mi->module_interface = g_key_file_get_integer(manifest, fullpath,
+                           "interface", &error);
+    if (!error)
+        mi->module_age = g_key_file_get_integer(manifest, fullpath, "age", &error);
+    if (!error)
+        mi->module_revision = g_key_file_get_integer(manifest, fullpath,
+                              "revision", &error);
+
+    if (error || !mi->module_path)
+    {
+        if (error)
+            g_error_free(error);
+        g_free(mi->module_path);
+        g_free(mi->module_description);
+        g_free(mi);
+        return FALSE;
+    }
+
+    mi->module_filepath = g_strdup(fullpath);
+    *info = mi;
+    return TRUE;
+}
+
+static void
+gnc_module_manifest_record(GKeyFile * manifest, const char * fullpath,
+                           const GStatBuf * st, const GNCModuleInfo * info)
+{
+    g_key_file_set_int64(manifest, fullpath, "mtime", (gint64) st->st_mtime);
+    g_key_file_set_int64(manifest, fullpath, "size", (gint64) st->st_size);
+    g_key_file_set_boolean(manifest, fullpath, "module", info != NULL);
+    if (!info)
+        return;
+
+    g_key_file_set_string(manifest, fullpath, "path", info->module_path);
+    if (info->module_description)
+        g_key_file_set_string(manifest, fullpath, "description",
+                              info->module_description);
+    g_key_file_set_integer(manifest, fullpath, "interface",
+                           info->module_interface);
+    g_key_file_set_integer(manifest, fullpath, "age", info->module_age);
+    g_key_file_set_integer(manifest, fullpath, "revision",
+                           info->module_revision);
+}
+
+static void
+gnc_module_manifest_save(GKeyFile * manifest, const gchar * filename)
+{
+    GError *error = NULL;
+    gchar *contents;
+    gsize length;
+
+    contents = g_key_file_to_data(manifest, &length, NULL);
+    if (!g_file_set_contents(filename, contents, length, &error))
+    {
+        g_message("Could not write module manifest '%s': %s",
+                  filename, error->message);
+        g_error_free(error);
+    }
+    g_free(contents);
+}
+
+static void
+gnc_module_info_free(gpointer data)
+{
+    GNCModuleInfo *info = (GNCModuleInfo *) data;
+
+    g_free(info->module_path);
+    g_free(info->module_description);
+    g_free(info->module_filepath);
+    g_free(info);
+}
+
 /*************************************************************
  * gnc_module_system_init
  * initialize the module system
@@ -137,7 +286,8 @@ gnc_module_system_init(void)
 /*************************************************************
  * gnc_module_system_refresh
  * build the database of modules by looking through the
- * GNC_MODULE_PATH
+ * GNC_MODULE_PATH.  Libraries listed in the manifest with the
+ * same modification time and size are not opened.
  *************************************************************/
 
 void
@@ -145,12 +295,28 @@ gnc_module_system_refresh(void)
 {
     GList * search_dirs;
     GList * current;
+    gchar * manifest_file;
+    GKeyFile * old_manifest;
+    GKeyFile * manifest;
+    gsize n_old, n_reused = 0;
+    gboolean changed = FALSE;
 
     if (!loaded_modules)
     {
         gnc_module_system_init();
     }
 
+    /* start the database afresh; loaded modules keep their own copy
+     * of the file name */
+    g_list_free_full(module_info, gnc_module_info_free);
+    module_info = NULL;
+
+    manifest_file = gnc_module_manifest_filename();
+    old_manifest = gnc_module_manifest_load(manifest_file);
+    g_strfreev(g_key_file_get_groups(old_manifest, &n_old));
+    manifest = g_key_file_new();
+    g_key_file_set_integer(manifest, MANIFEST_GROUP, "version", MANIFEST_VERSION);
+
     /* get the GNC_MODULE_PATH and split it into directories */
     search_dirs = gnc_module_system_search_dirs();
 
@@ -181,11 +347,29 @@ gnc_module_system_refresh(void)
                     || g_str_has_suffix(dent, ".dylib"))
                     && g_str_has_prefix(dent, GNC_MODULE_PREFIX))
             {
+                GStatBuf st;
+
                 /* get the full path name, then dlopen the library and see
-                 * if it has the appropriate symbols to be a gnc_module */
+                 * if it has the appropriate symbols to be a gnc_module,
+                 * unless the manifest already says */
                 fullpath = g_build_filename((const gchar *)(current->data),
                                             dent, (char*)NULL);
-                info     = gnc_module_get_info(fullpath);
+                if (g_stat(fullpath, &st) != 0)
+                {
+                    g_free(fullpath);
+                    continue;
+                }
+
+                if (gnc_module_manifest_lookup(old_manifest, fullpath, &st, &info))
+                {
+                    n_reused++;
+                }
+                else
+                {
+                    info = gnc_module_get_info(fullpath);
+                    changed = TRUE;
+                }
+                gnc_module_manifest_record(manifest, fullpath, &st, info);
 
                 if (info)
                 {
@@ -197,12 +381,22 @@ gnc_module_system_refresh(void)
         g_dir_close(d);
 
     }
+
+    /* Rewrite the manifest if a library was added or changed, or if
+     * one of those it lists (besides the version group) is gone. */
+    if (manifest_file && (changed || n_reused + 1 != n_old))
+        gnc_module_manifest_save(manifest, manifest_file);
+
+    g_key_file_free(manifest);
+    g_key_file_free(old_manifest);
+    g_free(manifest_file);
+
     /* free the search dir strings */
     for (current = search_dirs; current; current = current->next)
     {
         g_free(current->data);
     }
-    g_list_free(current);
+    g_list_free(search_dirs);
 }
 
 
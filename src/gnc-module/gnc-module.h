@@ -14,7 +14,13 @@ typedef void * GNCModule;
 #define GNC_MODULE_PREFIX "libgncmod"
 
 /* the basics: initialize the module system, refresh its module
- * database, and get a list of all known modules */
+ * database, and get a list of all known modules.
+ *
+ * What the refresh learns about each library is kept in a manifest
+ * (module-manifest in the user's .gnucash directory, or the file
+ * named by GNC_MODULE_MANIFEST; set that to the empty string to do
+ * without).  A library whose modification time and size match its
+ * manifest entry isn't opened until it is loaded. */
 void            gnc_module_system_init(void);
 void            gnc_module_system_refresh(void);
 GList         * gnc_module_system_modinfo(void);
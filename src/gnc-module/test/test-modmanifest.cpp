@@ -0,0 +1,109 @@
+/*********************************************************************
+ * test-modmanifest.cpp
+ * check that the module manifest gives the same module database as
+ * opening every library, and time both ways of building it
+ *********************************************************************/
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+#include <unittest-support.h>
+
+#include "gnc-module.h"
+
+#define REFRESH_ROUNDS 20
+
+static gdouble
+time_refresh(int rounds)
+{
+    GTimer *timer = g_timer_new();
+    gdouble elapsed;
+    int i;
+
+    for (i = 0; i < rounds; i++)
+        gnc_module_system_refresh();
+    elapsed = g_timer_elapsed(timer, NULL);
+    g_timer_destroy(timer);
+    return elapsed / rounds;
+}
+
+int
+main(int argc, char ** argv)
+{
+    gchar *msg = "Module '../../../src/gnc-module/test/misc-mods/.libs/libgncmod_futuremodsys.so' requires newer module system\n";
+    gchar *logdomain = "gnc.module";
+    guint loglevel = G_LOG_LEVEL_WARNING;
+    TestErrorStruct check = { loglevel, logdomain, msg };
+    gchar *manifest;
+    gdouble cold, warm;
+    guint n_scanned, n_cached;
+    guint warnings;
+    GNCModule agedver;
+    int fd;
+
+    test_add_error (&check);
+    g_log_set_handler (logdomain, loglevel,
+                       (GLogFunc)test_list_handler, NULL);
+
+    g_test_message("  test-modmanifest.cpp: building the module database from a manifest ...\n");
+
+    fd = g_file_open_tmp("test-modmanifest-XXXXXX", &manifest, NULL);
+    if (fd < 0)
+    {
+        printf("  could not create a temporary file\n");
+        exit(-1);
+    }
+    close(fd);
+    g_unlink(manifest);
+
+    /* Without a manifest every library is opened. */
+    g_setenv("GNC_MODULE_MANIFEST", "", TRUE);
+    gnc_module_system_init();
+    cold = time_refresh(REFRESH_ROUNDS);
+    n_scanned = g_list_length(gnc_module_system_modinfo());
+
+    g_setenv("GNC_MODULE_MANIFEST", manifest, TRUE);
+    gnc_module_system_refresh();
+    if (!g_file_test(manifest, G_FILE_TEST_EXISTS))
+    {
+        printf("  oops! no manifest was written\n");
+        exit(-1);
+    }
+
+    /* From here on nothing should need opening, so the futuremodsys
+     * warning must not come again. */
+    warnings = check.hits;
+    warm = time_refresh(REFRESH_ROUNDS);
+    n_cached = g_list_length(gnc_module_system_modinfo());
+    if (check.hits != warnings)
+    {
+        printf("  oops! a library listed in the manifest was opened\n");
+        exit(-1);
+    }
+
+    printf("  module database: %.3f ms scanning, %.3f ms from the manifest\n",
+           cold * 1000, warm * 1000);
+
+    if (n_cached != n_scanned || n_cached == 0)
+    {
+        printf("  oops! %u modules from the manifest, %u scanned\n",
+               n_cached, n_scanned);
+        exit(-1);
+    }
+
+    agedver = gnc_module_load("gnucash/agedver", 5);
+    if (!agedver)
+    {
+        printf("  oops! could not load a module found through the manifest\n");
+        exit(-1);
+    }
+    gnc_module_unload(agedver);
+
+    test_clear_error_list ();
+    g_unlink(manifest);
+    g_free(manifest);
+    printf("  ok\n");
+    return 0;
+}
@@ -42,6 +42,7 @@
 #include "gnc-component-manager.h"
 #include "gnc-date-edit.h"
 #include "gnc-session.h"
+#include "gnc-ui-balances.h"
 
 #define DIALOG_BOOK_CLOSE_CM_CLASS "dialog-book-close"
 
@@ -303,6 +304,7 @@ gnc_book_close_response_cb(GtkDialog *dialog, gint response, GtkDialog *unused)
             break;
         }
 
+        gnc_ui_book_load_history_since(cbw->book, cbw->close_date + 1);
         gnc_suspend_gui_refresh();
         close_accounts_of_type(cbw, income_acct, ACCT_TYPE_INCOME);
         close_accounts_of_type(cbw, expense_acct, ACCT_TYPE_EXPENSE);
@@ -399,6 +399,15 @@ show_session_error (QofBackendError io_error,
         gnc_error_dialog (parent, fmt, displayname);
         break;
 
+    case ERR_FILEIO_JOURNAL_MISMATCH:
+        fmt = _("The changes saved to %s since it was last written in full "
+                "are kept in a journal next to it, with \".journal\" "
+                "added to its name.  The file has been changed since, so "
+                "the journal can't be applied.  GnuCash won't open the file "
+                "until the journal is moved out of the way.");
+        gnc_error_dialog (parent, fmt, displayname);
+        break;
+
     case ERR_FILEIO_RESERVED_WRITE:
         /* Translators: the first %s is a path in the filesystem,
          * the second %s is PACKAGE_NAME, which by default is "GnuCash"
@@ -619,6 +628,55 @@ gnc_file_query_save (gboolean can_cancel)
 }
 
 
+/* Loading the file on a worker thread, with the main loop running so
+ * the window keeps redrawing while the data is read. */
+
+static double load_percentage = 0.0;
+
+static void
+gnc_file_load_progress (const char *message, double percentage)
+{
+    if (percentage >= 0)
+        load_percentage = percentage;
+    gnc_window_show_progress (message, percentage);
+}
+
+static void
+gnc_file_load_accounts_ready (QofSession *session, QofBook *book,
+                              gpointer user_data)
+{
+    /* The book isn't the session's until it is loaded, so there is
+     * nothing to show yet but the progress. */
+    gnc_window_show_progress (_("Loading transactions..."), load_percentage);
+}
+
+static void
+gnc_file_load_done (QofSession *session, QofBook *book, gpointer user_data)
+{
+    *(gboolean *) user_data = TRUE;
+}
+
+static void
+gnc_file_load_session (QofSession *session)
+{
+    gboolean done = FALSE;
+
+    load_percentage = 0.0;
+    gnc_window_show_progress (_("Loading user data..."), 0.0);
+    if (qof_session_load_async (session, gnc_file_load_progress,
+                                gnc_file_load_accounts_ready,
+                                gnc_file_load_done, &done))
+    {
+        while (!done)
+            gtk_main_iteration ();
+    }
+    else
+    {
+        qof_session_load (session, gnc_window_show_progress);
+    }
+    gnc_window_show_progress (NULL, -1.0);
+}
+
 /* private utilities for file open; done in two stages */
 
 #define RESPONSE_NEW  1
@@ -852,10 +910,12 @@ RESTART:
             gnc_keyring_set_password ( protocol, hostname, port,
                                        path, username, password );
 
+        /* Whatever the main loop runs during the load has to find the
+         * new session, not make another one. */
+        gnc_set_current_session (new_session);
+
         xaccLogDisable();
-        gnc_window_show_progress(_("Loading user data..."), 0.0);
-        qof_session_load (new_session, gnc_window_show_progress);
-        gnc_window_show_progress(NULL, -1.0);
+        gnc_file_load_session (new_session);
         xaccLogEnable();
 
         if (is_readonly)
@@ -873,9 +933,7 @@ RESTART:
             if (gnc_xml_convert_single_file (newfile))
             {
                 /* try to load once again */
-                gnc_window_show_progress(_("Loading user data..."), 0.0);
-                qof_session_load (new_session, gnc_window_show_progress);
-                gnc_window_show_progress(NULL, -1.0);
+                gnc_file_load_session (new_session);
                 xaccLogEnable();
                 io_err = qof_session_get_error (new_session);
             }
@@ -942,9 +1000,17 @@ RESTART:
     /* going down -- abandon ship */
     if (uh_oh)
     {
-        xaccLogDisable();
-        qof_session_destroy (new_session);
-        xaccLogEnable();
+        if (gnc_current_session_exist ()
+                && gnc_get_current_session () == new_session)
+        {
+            gnc_clear_current_session ();
+        }
+        else
+        {
+            xaccLogDisable();
+            qof_session_destroy (new_session);
+            xaccLogEnable();
+        }
 
         /* well, no matter what, I think it's a good idea to have a root
          * account around.  For example, early in the gnucash startup
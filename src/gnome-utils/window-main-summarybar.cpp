@@ -35,6 +35,7 @@
 #include "gnc-event.h"
 #include "gnc-gconf-utils.h"
 #include "gnc-locale-utils.h"
+#include "gnc-ui-balances.h"
 #include "gnc-ui-util.h"
 #include "window-main-summarybar.h"
 
@@ -399,6 +400,10 @@ gnc_main_window_summary_refresh (GNCMainSummary * summary)
     options.start_date = gnc_accounting_period_fiscal_start();
     options.end_date = gnc_accounting_period_fiscal_end();
 
+    /* The period may start before the transactions the backend loaded */
+    gnc_ui_book_load_history_since (gnc_account_get_book (root),
+                                    options.start_date);
+
     currency_list = NULL;
 
     /* grand total should be first in the list */
@@ -552,6 +552,7 @@ gnc_reconcile_interest_xfer_run(startRecnWindowData *data)
     recnInterestXferWindow( data );
 
     /* recompute the ending balance */
+    gnc_ui_book_load_history_since(gnc_account_get_book(data->account), data->date);
     after = xaccAccountGetBalanceAsOfDate(data->account, data->date);
 
     /* update the ending balance in the startRecnWindow if it has changed. */
@@ -172,6 +172,278 @@ _gnc_date_time_init (_GncDateTime *gncdt)
 }
 
 /****************** Posix Replacement Functions ***************************/
+/* Timezone transition cache
+ *
+ * Building a GDateTime for each conversion dominates loading, register
+ * sorting and report bucketing, so the local timezone's UTC offsets are
+ * cached as spans between transitions, one UTC year at a time as they are
+ * first needed.  Conversions inside the cached range are then plain
+ * calendar arithmetic.  Local times within a day of a transition, which
+ * may be skipped or repeated, and times outside the range still go
+ * through GLib.  The cache is dropped when $TZ changes.
+ */
+#define SECS_PER_DAY 86400
+#define TZ_CACHE_MIN_YEAR 1800
+#define TZ_CACHE_MAX_YEAR 2199
+#define TZ_CACHE_NUM_YEARS (TZ_CACHE_MAX_YEAR - TZ_CACHE_MIN_YEAR + 1)
+#define TZ_DAY_CACHE_SIZE 64
+
+typedef struct
+{
+    time64 start;
+    time64 end;
+    gint32 offset;
+    gboolean isdst;
+    /* start and end are year boundaries rather than transitions */
+    gboolean start_is_cut;
+    gboolean end_is_cut;
+} GncTzSpan;
+
+typedef struct
+{
+    guint n_spans;
+    GncTzSpan *spans;
+} GncTzYear;
+
+typedef struct
+{
+    gint64 local_day;
+    time64 noon;
+} GncTzDay;
+
+static GTimeZone *tz_cache_zone = NULL;
+static gchar *tz_cache_name = NULL;
+static GncTzYear *tz_cache_years[TZ_CACHE_NUM_YEARS];
+static GncTzSpan tz_cache_last;
+static gboolean tz_cache_last_valid = FALSE;
+static GncTzDay tz_day_cache[TZ_DAY_CACHE_SIZE];
+G_LOCK_DEFINE_STATIC (tz_cache);
+
+static inline gint64
+tz_floordiv (gint64 a, gint64 b)
+{
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+/* Days since 1970-01-01 in the proleptic Gregorian calendar, the one
+ * GDateTime uses. */
+static gint64
+tz_days_from_civil (gint64 year, int month, int day)
+{
+    gint64 era;
+    int yoe, doy, doe;
+    year -= month <= 2;
+    era = (year >= 0 ? year : year - 399) / 400;
+    yoe = (int)(year - era * 400);
+    doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+static void
+tz_civil_from_days (gint64 days, int *year, int *month, int *day)
+{
+    gint64 era;
+    int doe, yoe, doy, mp;
+    days += 719468;
+    era = (days >= 0 ? days : days - 146096) / 146097;
+    doe = (int)(days - era * 146097);
+    yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    mp = (5 * doy + 2) / 153;
+    *day = doy - (153 * mp + 2) / 5 + 1;
+    *month = mp < 10 ? mp + 3 : mp - 9;
+    *year = (int)(yoe + era * 400 + (*month <= 2));
+}
+
+static void
+tz_cache_probe (time64 t, gint32 *offset, gboolean *isdst)
+{
+    gint interval = g_time_zone_find_interval (tz_cache_zone,
+                                               G_TIME_TYPE_UNIVERSAL, t);
+    *offset = g_time_zone_get_offset (tz_cache_zone, interval);
+    *isdst = g_time_zone_is_dst (tz_cache_zone, interval);
+}
+
+/* Finds the transitions in a UTC year by probing once a day and bisecting
+ * down to the second wherever the offset or DST flag changed. */
+static GncTzYear*
+tz_cache_build_year (int year)
+{
+    time64 year_start = tz_days_from_civil (year, 1, 1) * SECS_PER_DAY;
+    time64 year_end = tz_days_from_civil (year + 1, 1, 1) * SECS_PER_DAY;
+    GArray *spans = g_array_new (FALSE, FALSE, sizeof (GncTzSpan));
+    GncTzYear *result = g_new0 (GncTzYear, 1);
+    GncTzSpan span;
+    time64 prev = year_start, t;
+
+    span.start = year_start;
+    span.start_is_cut = TRUE;
+    tz_cache_probe (year_start, &span.offset, &span.isdst);
+    for (t = year_start + SECS_PER_DAY; prev < year_end - 1; t += SECS_PER_DAY)
+    {
+        time64 probe = MIN (t, year_end - 1), lo = prev, hi = probe;
+        gint32 offset;
+        gboolean isdst;
+
+        tz_cache_probe (probe, &offset, &isdst);
+        prev = probe;
+        if (offset == span.offset && isdst == span.isdst)
+            continue;
+        while (hi - lo > 1)
+        {
+            time64 mid = lo + (hi - lo) / 2;
+            tz_cache_probe (mid, &offset, &isdst);
+            if (offset == span.offset && isdst == span.isdst)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        span.end = hi;
+        span.end_is_cut = FALSE;
+        g_array_append_val (spans, span);
+        span.start = hi;
+        span.start_is_cut = FALSE;
+        tz_cache_probe (hi, &span.offset, &span.isdst);
+    }
+    span.end = year_end;
+    span.end_is_cut = TRUE;
+    g_array_append_val (spans, span);
+
+    result->n_spans = spans->len;
+    result->spans = (GncTzSpan*)g_array_free (spans, FALSE);
+    return result;
+}
+
+static void
+tz_cache_check_zone (void)
+{
+    const gchar *name = g_getenv ("TZ");
+    guint i;
+
+    if (tz_cache_zone != NULL && g_strcmp0 (name, tz_cache_name) == 0)
+        return;
+    for (i = 0; i < TZ_CACHE_NUM_YEARS; i++)
+    {
+        if (tz_cache_years[i] == NULL)
+            continue;
+        g_free (tz_cache_years[i]->spans);
+        g_free (tz_cache_years[i]);
+        tz_cache_years[i] = NULL;
+    }
+    for (i = 0; i < TZ_DAY_CACHE_SIZE; i++)
+        tz_day_cache[i].local_day = G_MININT64;
+    tz_cache_last_valid = FALSE;
+    if (tz_cache_zone != NULL)
+        g_time_zone_unref (tz_cache_zone);
+    g_free (tz_cache_name);
+    tz_cache_name = g_strdup (name);
+    tz_cache_zone = gnc_g_time_zone_new_local ();
+}
+
+/* Call with the tz_cache lock held. */
+static gboolean
+tz_cache_span_at (time64 t, GncTzSpan *span)
+{
+    GncTzYear *year_spans;
+    int year, month, day;
+    guint i;
+
+    if (tz_cache_last_valid && t >= tz_cache_last.start && t < tz_cache_last.end)
+    {
+        *span = tz_cache_last;
+        return TRUE;
+    }
+    tz_civil_from_days (tz_floordiv (t, SECS_PER_DAY), &year, &month, &day);
+    if (year < TZ_CACHE_MIN_YEAR || year > TZ_CACHE_MAX_YEAR)
+        return FALSE;
+    year_spans = tz_cache_years[year - TZ_CACHE_MIN_YEAR];
+    if (year_spans == NULL)
+    {
+        year_spans = tz_cache_build_year (year);
+        tz_cache_years[year - TZ_CACHE_MIN_YEAR] = year_spans;
+    }
+    for (i = 0; i < year_spans->n_spans; i++)
+    {
+        if (t < year_spans->spans[i].end)
+            break;
+    }
+    g_assert (i < year_spans->n_spans);
+    tz_cache_last = year_spans->spans[i];
+    tz_cache_last_valid = TRUE;
+    *span = tz_cache_last;
+    return TRUE;
+}
+
+static inline gboolean
+tz_span_continues (const GncTzSpan *a, const GncTzSpan *b)
+{
+    if (a->start == b->start)
+        return TRUE;
+    return a->end == b->start && a->end_is_cut &&
+           a->offset == b->offset && a->isdst == b->isdst;
+}
+
+/* Call with the tz_cache lock held.  Fails for local times that are not
+ * at least a day away from a transition. */
+static gboolean
+tz_cache_local_to_utc (time64 local, time64 *utc, GncTzSpan *span)
+{
+    GncTzSpan before, after;
+    time64 guess;
+
+    if (!tz_cache_span_at (local, span))
+        return FALSE;
+    guess = local - span->offset;
+    if (!tz_cache_span_at (guess, span))
+        return FALSE;
+    if (local - span->offset != guess)
+    {
+        guess = local - span->offset;
+        if (!tz_cache_span_at (guess, span) || local - span->offset != guess)
+            return FALSE;
+    }
+    if (!tz_cache_span_at (guess - SECS_PER_DAY, &before) ||
+        !tz_cache_span_at (guess + SECS_PER_DAY, &after))
+        return FALSE;
+    if (!tz_span_continues (&before, span) || !tz_span_continues (span, &after))
+        return FALSE;
+    *utc = guess;
+    return TRUE;
+}
+
+static gboolean
+tz_cache_lookup (time64 t, GncTzSpan *span)
+{
+    gboolean found;
+    G_LOCK (tz_cache);
+    tz_cache_check_zone ();
+    found = tz_cache_span_at (t, span);
+    G_UNLOCK (tz_cache);
+    return found;
+}
+
+/* Fills in a struct tm the way gnc_g_date_time_fill_struct_tm does, so
+ * tm_wday is 1 (Monday) to 7 and tm_yday starts at 1. */
+static void
+tz_fill_struct_tm (time64 local, gboolean isdst, struct tm* time)
+{
+    gint64 days = tz_floordiv (local, SECS_PER_DAY);
+    int secs = (int)(local - days * SECS_PER_DAY);
+    int year, month, day;
+
+    tz_civil_from_days (days, &year, &month, &day);
+    time->tm_year = year - 1900;
+    time->tm_mon = month - 1;
+    time->tm_mday = day;
+    time->tm_hour = secs / 3600;
+    time->tm_min = secs / 60 % 60;
+    time->tm_sec = secs % 60;
+    time->tm_wday = (int)((days % 7 + 10) % 7) + 1;
+    time->tm_yday = (int)(days - tz_days_from_civil (year, 1, 1)) + 1;
+    time->tm_isdst = isdst ? 1 : 0;
+}
+
 void
 gnc_tm_free (struct tm* time)
 {
@@ -209,7 +481,20 @@ struct tm*
 gnc_localtime_r (const time64 *secs, struct tm* time)
 {
      guint index = 0;
-     GDateTime *gdt = gnc_g_date_time_new_from_unix_local (*secs);
+     GDateTime *gdt;
+     GncTzSpan span;
+
+     if (tz_cache_lookup (*secs, &span))
+     {
+	  tz_fill_struct_tm (*secs + span.offset, span.isdst, time);
+	  timezone = - span.offset;
+	  if (span.isdst)
+	       daylight = 1;
+	  time->tm_gmtoff = span.offset;
+	  return time;
+     }
+
+     gdt = gnc_g_date_time_new_from_unix_local (*secs);
      g_return_val_if_fail (gdt != NULL, NULL);
 
      gnc_g_date_time_fill_struct_tm (gdt, time);
@@ -297,6 +582,30 @@ gnc_mktime (struct tm* time)
      GDateTime *gdt;
      time64 secs;
      normalize_struct_tm (time);
+     if (time->tm_sec < 60)
+     {
+	  gint64 days = tz_days_from_civil (time->tm_year + 1900, time->tm_mon,
+					    time->tm_mday);
+	  time64 local = days * SECS_PER_DAY + time->tm_hour * 3600 +
+			 time->tm_min * 60 + time->tm_sec;
+	  int year, month, day;
+	  GncTzSpan span;
+	  gboolean found;
+
+	  /* Reject days that normalize_struct_tm lets through but that
+	   * don't exist, e.g. 29 February 2100. */
+	  tz_civil_from_days (days, &year, &month, &day);
+	  G_LOCK (tz_cache);
+	  tz_cache_check_zone ();
+	  found = day == time->tm_mday && tz_cache_local_to_utc (local, &secs, &span);
+	  G_UNLOCK (tz_cache);
+	  if (found)
+	  {
+	       tz_fill_struct_tm (local, span.isdst, time);
+	       time->tm_gmtoff = span.offset;
+	       return secs;
+	  }
+     }
      gdt = gnc_g_date_time_new_local (time->tm_year + 1900, time->tm_mon,
 				      time->tm_mday, time->tm_hour,
 				      time->tm_min, (gdouble)(time->tm_sec));
@@ -571,9 +880,37 @@ timespecCanonicalDayTime(Timespec t)
     struct tm tm;
     Timespec retval;
     time64 t_secs = t.tv_sec + (t.tv_nsec / NANOS_PER_SECOND);
-    gnc_localtime_r(&t_secs, &tm);
-    gnc_tm_set_day_middle(&tm);
-    retval.tv_sec = gnc_mktime(&tm);
+    GncTzSpan span;
+    gboolean found = FALSE;
+
+    /* Callers canonicalize many times on the same few days, so remember
+     * each local day's midday. */
+    G_LOCK (tz_cache);
+    tz_cache_check_zone ();
+    if (tz_cache_span_at (t_secs, &span))
+    {
+        gint64 day = tz_floordiv (t_secs + span.offset, SECS_PER_DAY);
+        GncTzDay *slot = &tz_day_cache[(guint64)day % TZ_DAY_CACHE_SIZE];
+        if (slot->local_day == day)
+        {
+            retval.tv_sec = slot->noon;
+            found = TRUE;
+        }
+        else if (tz_cache_local_to_utc (day * SECS_PER_DAY + 12 * 3600,
+                                        &retval.tv_sec, &span))
+        {
+            slot->local_day = day;
+            slot->noon = retval.tv_sec;
+            found = TRUE;
+        }
+    }
+    G_UNLOCK (tz_cache);
+    if (!found)
+    {
+        gnc_localtime_r(&t_secs, &tm);
+        gnc_tm_set_day_middle(&tm);
+        retval.tv_sec = gnc_mktime(&tm);
+    }
     retval.tv_nsec = 0;
     return retval;
 }
@@ -1318,6 +1655,95 @@ gnc_date_timestamp (void)
  * support timezones, so we have to do this with sscanf.
  */
 
+static inline gboolean
+iso8601_get_int (const char **str, int width, int *value)
+{
+    int i, result = 0;
+    for (i = 0; i < width; i++)
+    {
+        char c = (*str)[i];
+        if (c < '0' || c > '9')
+            return FALSE;
+        result = result * 10 + c - '0';
+    }
+    *str += width;
+    *value = result;
+    return TRUE;
+}
+
+const char*
+gnc_iso8601_scan_fixed (const char *str, Timespec *ts, gboolean *has_zone)
+{
+    const char *p = str;
+    int year, month, day, hour, minute, second, usecs = 0, digits = 0;
+    int zone_hours = 0, zone_minutes = 0, zone_sign = 0;
+    int check_year, check_month, check_day;
+    gint64 days;
+
+    g_return_val_if_fail (ts != NULL, NULL);
+    if (str == NULL)
+        return NULL;
+
+    if (!iso8601_get_int (&p, 4, &year) || *p++ != '-' ||
+        !iso8601_get_int (&p, 2, &month) || *p++ != '-' ||
+        !iso8601_get_int (&p, 2, &day) || *p++ != ' ' ||
+        !iso8601_get_int (&p, 2, &hour) || *p++ != ':' ||
+        !iso8601_get_int (&p, 2, &minute) || *p++ != ':' ||
+        !iso8601_get_int (&p, 2, &second))
+        return NULL;
+    if (*p == '.')
+    {
+        /* Microseconds, like GDateTime; further digits are dropped. */
+        for (++p; *p >= '0' && *p <= '9'; ++p, ++digits)
+            if (digits < 6)
+                usecs = usecs * 10 + *p - '0';
+        if (digits == 0)
+            return NULL;
+        for (; digits < 6; ++digits)
+            usecs *= 10;
+    }
+    {
+        const char *zone = p;
+        while (*zone == ' ')
+            ++zone;
+        if (*zone == 'Z')
+        {
+            zone_sign = 1;
+            p = zone + 1;
+        }
+        else if (*zone == '+' || *zone == '-')
+        {
+            zone_sign = *zone++ == '-' ? -1 : 1;
+            if (!iso8601_get_int (&zone, 2, &zone_hours))
+                return NULL;
+            if (*zone == ':')
+            {
+                ++zone;
+                if (!iso8601_get_int (&zone, 2, &zone_minutes))
+                    return NULL;
+            }
+            else if (*zone >= '0' && *zone <= '9' &&
+                     !iso8601_get_int (&zone, 2, &zone_minutes))
+                return NULL;
+            p = zone;
+        }
+    }
+    if (year < 1 || month < 1 || month > 12 || hour > 23 || minute > 59 ||
+        second > 59 || zone_hours > 23 || zone_minutes > 59)
+        return NULL;
+    days = tz_days_from_civil (year, month, day);
+    tz_civil_from_days (days, &check_year, &check_month, &check_day);
+    if (day < 1 || check_day != day)
+        return NULL;
+
+    ts->tv_sec = days * SECS_PER_DAY + hour * 3600 + minute * 60 + second -
+                 zone_sign * (zone_hours * 3600 + zone_minutes * 60);
+    ts->tv_nsec = usecs * 1000;
+    if (has_zone)
+        *has_zone = zone_sign != 0;
+    return p;
+}
+
 #define ISO_DATE_FORMAT "%d-%d-%d %d:%d:%lf%s"
 Timespec
 gnc_iso8601_to_timespec_gmt(const char *str)
@@ -1328,12 +1754,20 @@ gnc_iso8601_to_timespec_gmt(const char *str)
     char zone[12];
     double second = 0.0;
     int fields;
+    const char *end;
 
     memset (zone, 0, sizeof (zone));
 
     if (!str)
 	return time;
 
+    /* The backends' fixed format doesn't need sscanf or a GDateTime. */
+    end = gnc_iso8601_scan_fixed (str, &time, NULL);
+    if (end != NULL && *end == '\0')
+	return time;
+    time.tv_sec = 0;
+    time.tv_nsec = 0;
+
     fields = sscanf (str, ISO_DATE_FORMAT, &year, &month,
 			  &day, &hour, &minute, &second, zone);
     if (fields < 1)
@@ -1362,6 +1796,75 @@ gnc_iso8601_to_timespec_gmt(const char *str)
 /********************************************************************\
 \********************************************************************/
 
+static inline char*
+iso8601_put_int (char *buff, int value, int width)
+{
+    int i;
+    for (i = width - 1; i >= 0; i--)
+    {
+        buff[i] = '0' + value % 10;
+        value /= 10;
+    }
+    return buff + width;
+}
+
+/* Writes "YYYY-MM-DD HH:MM:SS[.uuuuuu] +HHMM" for times the timezone
+ * cache covers, returning NULL for the rest. */
+static char*
+iso8601_format_cached (time64 secs, int usecs, gboolean with_usecs, char *buff)
+{
+    GncTzSpan span;
+    struct tm tm;
+    int offset;
+    char *p = buff;
+
+    if (!tz_cache_lookup (secs, &span))
+        return NULL;
+    tz_fill_struct_tm (secs + span.offset, span.isdst, &tm);
+    p = iso8601_put_int (p, tm.tm_year + 1900, 4);
+    *p++ = '-';
+    p = iso8601_put_int (p, tm.tm_mon + 1, 2);
+    *p++ = '-';
+    p = iso8601_put_int (p, tm.tm_mday, 2);
+    *p++ = ' ';
+    p = iso8601_put_int (p, tm.tm_hour, 2);
+    *p++ = ':';
+    p = iso8601_put_int (p, tm.tm_min, 2);
+    *p++ = ':';
+    p = iso8601_put_int (p, tm.tm_sec, 2);
+    if (with_usecs)
+    {
+        *p++ = '.';
+        p = iso8601_put_int (p, usecs, 6);
+    }
+    *p++ = ' ';
+    *p++ = span.offset < 0 ? '-' : '+';
+    offset = ABS (span.offset);
+    p = iso8601_put_int (p, offset / 3600, 2);
+    p = iso8601_put_int (p, offset / 60 % 60, 2);
+    *p = '\0';
+    return p;
+}
+
+char *
+gnc_time64_to_iso8601_buff (time64 time, char * buff)
+{
+    GDateTime *gdt;
+    char *end, *str;
+
+    g_return_val_if_fail (buff != NULL, NULL);
+    end = iso8601_format_cached (time, 0, FALSE, buff);
+    if (end != NULL)
+        return end;
+    gdt = gnc_g_date_time_new_from_unix_local (time);
+    g_return_val_if_fail (gdt != NULL, NULL);
+    str = g_date_time_format (gdt, "%Y-%m-%d %H:%M:%S %z");
+    g_strlcpy (buff, str, MAX_DATE_LENGTH);
+    g_free (str);
+    g_date_time_unref (gdt);
+    return buff + strlen (buff);
+}
+
 char *
 gnc_timespec_to_iso8601_buff (Timespec ts, char * buff)
 {
@@ -1370,6 +1873,13 @@ gnc_timespec_to_iso8601_buff (Timespec ts, char * buff)
     char *time_base, *tz;
 
     g_return_val_if_fail (buff != NULL, NULL);
+    if (ts.tv_nsec >= 0 && ts.tv_nsec < NANOS_PER_SECOND)
+    {
+        char *end = iso8601_format_cached (ts.tv_sec, ts.tv_nsec / 1000,
+                                           TRUE, buff);
+        if (end != NULL)
+            return end;
+    }
     gdt = gnc_g_date_time_new_from_timespec_local (ts);
     g_return_val_if_fail (gdt != NULL, NULL);
     time_base = g_date_time_format (gdt, fmt1);
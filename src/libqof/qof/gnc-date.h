@@ -362,6 +362,20 @@ Timespec gnc_dmy2timespec_end (int day, int month, int year);
  */
 Timespec gnc_iso8601_to_timespec_gmt(const char *);
 
+/** The gnc_iso8601_scan_fixed() routine parses the fixed form
+ *    "YYYY-MM-DD HH:MM:SS[.ffffff][ ][Z|+HH[[:]MM]]" written by
+ *    gnc_timespec_to_iso8601_buff() and the file backends, without
+ *    allocating.  A missing zone means UTC.
+ *
+ * @param str The string to parse.
+ * @param ts Set to the parsed time if the parse succeeds.
+ * @param has_zone If not NULL, set to whether the string had a zone.
+ * @return A pointer to the first character after the timestamp, or NULL
+ *    if str doesn't start with one in the fixed form.
+ */
+const char* gnc_iso8601_scan_fixed (const char *str, Timespec *ts,
+                                    gboolean *has_zone);
+
 /** The gnc_timespec_to_iso8601_buff() routine takes the input
  *    UTC Timespec value and prints it as an ISO-8601 style string.
  *    The buffer must be long enough to contain the NULL-terminated
@@ -380,6 +394,13 @@ Timespec gnc_iso8601_to_timespec_gmt(const char *);
  */
 char * gnc_timespec_to_iso8601_buff (Timespec ts, char * buff);
 
+/** The gnc_time64_to_iso8601_buff() routine is like
+ *    gnc_timespec_to_iso8601_buff() but leaves out the fractional
+ *    seconds, giving "YYYY-MM-DD HH:MM:SS +HHMM" as the XML backend
+ *    writes it.
+ */
+char * gnc_time64_to_iso8601_buff (time64 time, char * buff);
+
 /** Set the proleptic Gregorian day, month, and year from a Timespec
  * \param ts: input timespec
  * \param day: output day, 1 - 31
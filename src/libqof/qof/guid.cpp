@@ -58,6 +58,9 @@
 
 
 /* Static global variables *****************************************/
+/* guid_context and the counter in guid_new() are shared by every
+ * thread which makes guids. */
+G_LOCK_DEFINE_STATIC (guid_context);
 static bool guid_initialized = false;
 static struct md5_ctx guid_context;
 
@@ -305,7 +308,9 @@ init_from_time(void)
 
     total = 0;
 
-    time = gnc_time (NULL);
+    /* The seconds are the same in any time zone; looking up the local
+     * one costs more than the rest of making a guid. */
+    time = gnc_time_utc (NULL);
     md5_process_bytes(&time, sizeof(time), &guid_context);
     total += sizeof(time);
 
@@ -338,8 +343,19 @@ init_from_buff(unsigned char * buf, size_t buflen)
     return buflen;
 }
 
+static void guid_init_locked(void);
+
 void
 guid_init(void)
+{
+    G_LOCK (guid_context);
+    guid_init_locked ();
+    G_UNLOCK (guid_context);
+}
+
+/* Called with the guid_context lock held. */
+static void
+guid_init_locked(void)
 {
     size_t bytes = 0;
 
@@ -518,8 +534,9 @@ guid_new(GncGUID *guid)
     if (guid == NULL)
         return;
 
+    G_LOCK (guid_context);
     if (!guid_initialized)
-        guid_init();
+        guid_init_locked();
 
     /* make the id */
     ctx = guid_context;
@@ -548,7 +565,10 @@ guid_new(GncGUID *guid)
 
         fp = g_fopen ("/dev/urandom", "r");
         if (fp == NULL)
+        {
+            G_UNLOCK (guid_context);
             return;
+        }
 
         init_from_stream(fp, 32);
 
@@ -558,6 +578,7 @@ guid_new(GncGUID *guid)
     }
 
     counter--;
+    G_UNLOCK (guid_context);
 }
 
 GncGUID
@@ -1491,15 +1491,20 @@ int
 kvp_frame_compare(const KvpFrame *fa, const KvpFrame *fb)
 {
     kvp_frame_cmp_status status;
+    bool a_empty, b_empty;
 
     if (fa == fb) return 0;
     /* nothing is always less than something */
     if (!fa && fb) return -1;
     if (fa && !fb) return 1;
 
-    /* nothing is always less than something */
-    if (!fa->hash && fb->hash) return -1;
-    if (fa->hash && !fb->hash) return 1;
+    /* nothing is always less than something; a frame whose slots have
+     * all been removed keeps its hash table but holds nothing either */
+    a_empty = !fa->hash || g_hash_table_size (fa->hash) == 0;
+    b_empty = !fb->hash || g_hash_table_size (fb->hash) == 0;
+    if (a_empty && b_empty) return 0;
+    if (a_empty) return -1;
+    if (b_empty) return 1;
 
     status.compare = 0;
     status.other_frame = (KvpFrame *) fb;
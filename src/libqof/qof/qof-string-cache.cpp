@@ -40,40 +40,125 @@ static QofLogModule log_module = QOF_MOD_UTIL;
 /* =================================================================== */
 /* The QOF string cache                                                */
 /*                                                                     */
-/* The cache is a GHashTable where a copy of the string is the key,    */
-/* and a ref count is the value                                        */
+/* The cache is split into shards, picked by the string's hash, so     */
+/* threads interning different strings seldom wait for each other.     */
+/* Each shard is a GHashTable set guarded by its own mutex.  A cached  */
+/* string lives in a single block just after its refcount, so a new    */
+/* string costs one allocation and the string is its own hash key.     */
 /* =================================================================== */
 
-static GHashTable* qof_string_cache = NULL;
+#define QOF_STRING_CACHE_SHARDS 16
 
-static GHashTable*
-qof_get_string_cache(void)
+typedef struct
 {
-    if (!qof_string_cache)
+    guint refcount;
+    gchar str[1];
+} QofStringEntry;
+
+#define STR_TO_ENTRY(s) \
+    ((QofStringEntry *) ((gchar *) (s) - G_STRUCT_OFFSET (QofStringEntry, str)))
+
+typedef struct
+{
+    GMutex      lock;
+    GHashTable *table;      /* the cached strings; key and value alike */
+    guint64     lookups;
+    guint64     hits;
+    guint       refs;
+    gsize       bytes;
+} QofStringShard;
+
+/* Statically allocated GMutexes need no initialization, so the shards
+ * are usable before qof_string_cache_init. */
+static QofStringShard qof_string_shards[QOF_STRING_CACHE_SHARDS];
+
+/* The low bits of the hash pick the bucket inside the shard's table, so
+ * use the high ones to pick the shard.  g_str_hash leaves the high bits
+ * of short strings -- "", nums, actions -- all zero, so spread the hash
+ * over the whole word first with a golden-ratio multiply. */
+static inline QofStringShard *
+qof_string_cache_shard (guint hash)
+{
+    guint32 mixed = (guint32) hash * 0x9E3779B1u;
+
+    return &qof_string_shards[(mixed >> 28) % QOF_STRING_CACHE_SHARDS];
+}
+
+/* Insert key into shard, whose lock the caller holds. */
+static gchar *
+qof_string_shard_insert (QofStringShard *shard, const gchar *key)
+{
+    QofStringEntry *entry;
+    gpointer cache_key;
+    gsize len;
+
+    if (!shard->table)
+        shard->table = g_hash_table_new (g_str_hash, g_str_equal);
+
+    shard->lookups++;
+    cache_key = g_hash_table_lookup (shard->table, key);
+    if (cache_key)
     {
-        qof_string_cache = g_hash_table_new_full(
-                               g_str_hash,               /* hash_func          */
-                               g_str_equal,              /* key_equal_func     */
-                               g_free,                   /* key_destroy_func   */
-                               g_free);                  /* value_destroy_func */
+        entry = STR_TO_ENTRY (cache_key);
+        entry->refcount++;
+        shard->hits++;
+        shard->refs++;
+        return entry->str;
     }
-    return qof_string_cache;
+
+    len = strlen (key);
+    entry = (QofStringEntry *) g_malloc (sizeof (QofStringEntry) + len);
+    entry->refcount = 1;
+    memcpy (entry->str, key, len + 1);
+    g_hash_table_add (shard->table, entry->str);
+    shard->refs++;
+    shard->bytes += sizeof (QofStringEntry) + len;
+    return entry->str;
 }
 
 void
 qof_string_cache_init(void)
 {
-    (void)qof_get_string_cache();
+    guint i;
+
+    for (i = 0; i < QOF_STRING_CACHE_SHARDS; i++)
+    {
+        QofStringShard *shard = &qof_string_shards[i];
+
+        g_mutex_lock (&shard->lock);
+        if (!shard->table)
+            shard->table = g_hash_table_new (g_str_hash, g_str_equal);
+        g_mutex_unlock (&shard->lock);
+    }
+}
+
+static void
+qof_string_entry_free (gpointer key, gpointer value, gpointer user_data)
+{
+    g_free (STR_TO_ENTRY (key));
 }
 
 void
 qof_string_cache_destroy (void)
 {
-    if (qof_string_cache)
+    guint i;
+
+    for (i = 0; i < QOF_STRING_CACHE_SHARDS; i++)
     {
-        g_hash_table_destroy(qof_string_cache);
+        QofStringShard *shard = &qof_string_shards[i];
+
+        g_mutex_lock (&shard->lock);
+        if (shard->table)
+        {
+            g_hash_table_foreach (shard->table, qof_string_entry_free, NULL);
+            g_hash_table_destroy (shard->table);
+            shard->table = NULL;
+        }
+        shard->lookups = shard->hits = 0;
+        shard->refs = 0;
+        shard->bytes = 0;
+        g_mutex_unlock (&shard->lock);
     }
-    qof_string_cache = NULL;
 }
 
 /* If the key exists in the cache, check the refcount.  If 1, just
@@ -81,24 +166,27 @@ qof_string_cache_destroy (void)
 void
 qof_string_cache_remove(const void * key)
 {
-    if (key)
+    QofStringShard *shard;
+    gpointer cache_key;
+
+    if (!key) return;
+
+    shard = qof_string_cache_shard (g_str_hash (key));
+    g_mutex_lock (&shard->lock);
+    if (shard->table
+            && (cache_key = g_hash_table_lookup (shard->table, key)) != NULL)
     {
-        GHashTable* cache = qof_get_string_cache();
-        gpointer value;
-        gpointer cache_key;
-        if (g_hash_table_lookup_extended(cache, key, &cache_key, &value))
+        QofStringEntry *entry = STR_TO_ENTRY (cache_key);
+
+        shard->refs--;
+        if (--entry->refcount == 0)
         {
-            guint* refcount = (guint*)value;
-            if (*refcount == 1)
-            {
-                g_hash_table_remove(cache, key);
-            }
-            else
-            {
-                --(*refcount);
-            }
+            g_hash_table_remove (shard->table, cache_key);
+            shard->bytes -= sizeof (QofStringEntry) + strlen (entry->str);
+            g_free (entry);
         }
     }
+    g_mutex_unlock (&shard->lock);
 }
 
 /* If the key exists in the cache, increment the refcount.  Otherwise,
@@ -106,27 +194,94 @@ qof_string_cache_remove(const void * key)
 gpointer
 qof_string_cache_insert(const void * key)
 {
-    if (key)
+    QofStringShard *shard;
+    gchar *cached;
+
+    if (!key) return NULL;
+
+    shard = qof_string_cache_shard (g_str_hash (key));
+    g_mutex_lock (&shard->lock);
+    cached = qof_string_shard_insert (shard, (const gchar *) key);
+    g_mutex_unlock (&shard->lock);
+    return cached;
+}
+
+void
+qof_string_cache_insert_many (const char **keys, const char **cached, guint n)
+{
+    guint counts[QOF_STRING_CACHE_SHARDS + 1] = { 0 };
+    guint8 *shard_of;
+    guint *order;
+    guint i, s;
+
+    if (n == 0) return;
+    g_return_if_fail (keys != NULL && cached != NULL);
+
+    /* Sort the keys by shard so each lock is taken only once. */
+    shard_of = g_new (guint8, n);
+    order = g_new (guint, n);
+    for (i = 0; i < n; i++)
+    {
+        shard_of[i] = keys[i]
+                      ? (guint8) (qof_string_cache_shard (g_str_hash (keys[i]))
+                                  - qof_string_shards)
+                      : 0;
+        counts[shard_of[i] + 1]++;
+    }
+    for (s = 1; s <= QOF_STRING_CACHE_SHARDS; s++)
+        counts[s] += counts[s - 1];
+    for (i = 0; i < n; i++)
+        order[counts[shard_of[i]]++] = i;
+
+    /* counts[s] now marks the end of shard s's keys in order. */
+    i = 0;
+    for (s = 0; s < QOF_STRING_CACHE_SHARDS; s++)
     {
-        GHashTable* cache = qof_get_string_cache();
-        gpointer value;
-        gpointer cache_key;
-        if (g_hash_table_lookup_extended(cache, key, &cache_key, &value))
+        QofStringShard *shard = &qof_string_shards[s];
+
+        if (i == counts[s]) continue;
+        g_mutex_lock (&shard->lock);
+        for (; i < counts[s]; i++)
         {
-            guint* refcount = (guint*)value;
-            ++(*refcount);
-            return cache_key;
+            const char *key = keys[order[i]];
+            cached[order[i]] = key ? qof_string_shard_insert (shard, key) : NULL;
         }
-        else
+        g_mutex_unlock (&shard->lock);
+    }
+
+    g_free (order);
+    g_free (shard_of);
+}
+
+void
+qof_string_cache_get_stats (QofStringCacheStats *stats)
+{
+    guint i;
+
+    g_return_if_fail (stats != NULL);
+
+    memset (stats, 0, sizeof (QofStringCacheStats));
+    for (i = 0; i < QOF_STRING_CACHE_SHARDS; i++)
+    {
+        QofStringShard *shard = &qof_string_shards[i];
+
+        g_mutex_lock (&shard->lock);
+        stats->lookups += shard->lookups;
+        stats->hits += shard->hits;
+        stats->refs += shard->refs;
+        stats->bytes += shard->bytes;
+        if (shard->table)
         {
-            gpointer new_key = g_strdup(key);
-            guint* refcount = g_malloc(sizeof(guint));
-            *refcount = 1;
-            g_hash_table_insert(cache, new_key, refcount);
-            return new_key;
+            if (g_hash_table_size (shard->table) > 0)
+                stats->shards_used++;
+            stats->strings += g_hash_table_size (shard->table);
+            /* The table's own arrays hold a hash and a key per slot,
+             * with at least as many slots as strings. */
+            stats->table_bytes += g_hash_table_size (shard->table)
+                                  * (sizeof (guint) + sizeof (gpointer));
         }
+        g_mutex_unlock (&shard->lock);
     }
-    return NULL;
 }
 
 /* ************************ END OF FILE ***************************** */
@@ -44,6 +44,8 @@
 #include "qofinstance.h"
 #endif
 
+#include <glib.h>
+
 #define QOF_MOD_UTIL "qof.utilities"
 
 /** The QOF String Cache:
@@ -74,6 +76,10 @@
  *
  * The string cache is demand-created on first use.
  *
+ * The cache may be used from several threads at once.  It is split
+ * into shards by the strings' hash, each with its own lock, so threads
+ * working on different strings rarely contend.
+ *
  **/
 
 /** Initialize the string cache */
@@ -92,6 +98,31 @@ void qof_string_cache_remove(const void * key);
 */
 void * qof_string_cache_insert(const void * key);
 
+/** Insert the n strings in keys at once, storing the cached copy of
+ *  keys[i] in cached[i] exactly as qof_string_cache_insert would.  NULL
+ *  keys give NULL.  Loaders interning a batch of rows should prefer this:
+ *  each shard's lock is taken once for the whole batch instead of once
+ *  per string.  keys and cached may be the same array.
+ */
+void qof_string_cache_insert_many(const char **keys, const char **cached,
+                                  guint n);
+
+/** Usage figures for the string cache, see qof_string_cache_get_stats. */
+typedef struct
+{
+    guint64 lookups;        /**< Strings inserted since the cache was created */
+    guint64 hits;           /**< Of those, the ones already cached */
+    guint   strings;        /**< Distinct strings now cached */
+    guint   refs;           /**< References held on them */
+    gsize   bytes;          /**< Memory used by the strings and their refcounts */
+    gsize   table_bytes;    /**< Lower bound on memory used by the hash tables */
+    guint   shards_used;    /**< Shards holding at least one string */
+} QofStringCacheStats;
+
+/** Fill in stats with the cache's current figures.  The hit rate is
+ *  hits / lookups; refs - strings is the number of copies saved. */
+void qof_string_cache_get_stats(QofStringCacheStats *stats);
+
 #define CACHE_INSERT(str) qof_string_cache_insert((const void *)(str))
 #define CACHE_REMOVE(str) qof_string_cache_remove((str))
 
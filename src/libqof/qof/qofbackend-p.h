@@ -320,6 +320,12 @@ struct QofBackend
     bool (*process_events) (QofBackend *);
 
     QofBePercentageFunc percentage;
+    /** Set by the session while an asynchronous load is running; see
+     *  qof_backend_report_load_stage(). */
+    QofBeLoadStageFunc load_stage;
+    /** Set by the session while an asynchronous load is running; see
+     *  qof_backend_load_yield(). */
+    QofBeLoadYieldFunc load_yield;
 
     QofBackendProvider *provider;
 
@@ -350,6 +356,12 @@ struct QofBackend
      */
     void (*export_fn) (QofBackend *, QofBook *);
 
+    /** Backends which only load part of the book (e.g. the most recent
+     * transactions) fault in everything posted on or after the given
+     * date.  NULL for backends which always hold the whole book.
+     */
+    void (*load_since) (QofBackend *, QofBook *, Timespec);
+
     QofBackend();
 };
 
@@ -56,13 +56,18 @@ QofBackend::QofBackend()
     get_config = NULL;
     events_pending = NULL;
     process_events = NULL;
+    percentage = NULL;
     provider = NULL;
+    last_err = ERR_BACKEND_NO_ERR;
     error_msg = NULL;
     backend_configuration = NULL;
     config_count = 0;
     fullpath = NULL;
     price_lookup = NULL;
     export_fn = NULL;
+    load_since = NULL;
+    load_stage = NULL;
+    load_yield = NULL;
 }
 
 /* *******************************************************************\
@@ -166,11 +171,14 @@ qof_backend_init(QofBackend *be)
     if (be->error_msg) g_free (be->error_msg);
     be->error_msg = NULL;
     be->percentage = NULL;
+    be->load_stage = NULL;
+    be->load_yield = NULL;
     be->backend_configuration = kvp_frame_new();
 
     /* to be removed */
     be->price_lookup = NULL;
     be->export_fn = NULL;
+    be->load_since = NULL;
 }
 
 void
@@ -196,6 +204,45 @@ qof_backend_run_begin(QofBackend *be, QofInstance *inst)
     (be->begin) (be, inst);
 }
 
+void
+qof_backend_run_load_since(QofBackend *be, QofBook *book, Timespec since)
+{
+    if (!be || !book)
+    {
+        return;
+    }
+    if (!be->load_since)
+    {
+        return;
+    }
+    (be->load_since) (be, book, since);
+}
+
+void
+qof_backend_report_load_stage(QofBackend *be, QofBook *book,
+                              QofBackendLoadStage stage)
+{
+    if (!be || !book)
+    {
+        return;
+    }
+    if (!be->load_stage)
+    {
+        return;
+    }
+    (be->load_stage) (be, book, stage);
+}
+
+void
+qof_backend_load_yield(QofBackend *be)
+{
+    if (!be || !be->load_yield)
+    {
+        return;
+    }
+    (be->load_yield) (be);
+}
+
 bool
 qof_backend_begin_exists(const QofBackend *be)
 {
@@ -100,6 +100,8 @@ enum QofBackendError
                                     for internal use by GnuCash */
     ERR_FILEIO_FILE_UPGRADE,   /**< file will be upgraded and not be able to be
                                     read by prior versions - warn users*/
+    ERR_FILEIO_JOURNAL_MISMATCH, /**< the file's journal of changes was written
+                                    against a different version of the file */
 
     /* network errors */
     ERR_NETIO_SHORT_READ = 2000,  /**< not enough bytes received */
@@ -145,6 +147,21 @@ struct QofBackend;
 /** \brief DOCUMENT ME! */
 typedef void (*QofBePercentageFunc) (/*@ null @*/ const char *message, double percent);
 
+/** Milestones a backend reaches while loading a book. */
+typedef enum
+{
+    QOF_LOAD_STAGE_ACCOUNTS,    /**< The account tree has been read */
+} QofBackendLoadStage;
+
+/** Tells whoever started a load that the book has reached a stage.
+ *  It is called on the thread running the load. */
+typedef void (*QofBeLoadStageFunc) (QofBackend *be, QofBook *book,
+                                    QofBackendLoadStage stage);
+
+/** Lets whoever started a load have the engine for a while.  It is
+ *  called on the thread running the load. */
+typedef void (*QofBeLoadYieldFunc) (QofBackend *be);
+
 /** @name Allow access to the begin routine for this backend. */
 //@{
 
@@ -157,6 +174,22 @@ void qof_backend_run_commit(QofBackend *be, QofInstance *inst);
 bool qof_backend_commit_exists(const QofBackend *be);
 //@}
 
+/** Asks a partially loaded backend to bring every object posted on or
+ *  after 'since' into the book.  A no-op for backends which always load
+ *  the whole book. */
+void qof_backend_run_load_since(QofBackend *be, QofBook *book, Timespec since);
+
+/** Called by a backend's load routine as the book passes each stage.
+ *  A no-op unless the load was started by qof_session_load_async(). */
+void qof_backend_report_load_stage(QofBackend *be, QofBook *book,
+                                   QofBackendLoadStage stage);
+
+/** Called by a backend's load routine between the objects it reads, so
+ *  that a long load doesn't keep the main loop waiting for the engine.
+ *  Cheap enough to call for every object.  A no-op unless the load was
+ *  started by qof_session_load_async(). */
+void qof_backend_load_yield(QofBackend *be);
+
 /** The qof_backend_set_error() routine pushes an error code onto the error
  *  stack. (FIXME: the stack is 1 deep in current implementation).
  */
@@ -48,6 +48,10 @@ static FILE *fout = NULL;
 static char* function_buffer = NULL;
 static int qof_log_num_spaces = 0;
 static GHashTable *log_table = NULL;
+/* The most verbose level any module has been set to, which lets
+ * qof_log_check turn down the common debug and info checks without
+ * looking at the table. */
+static QofLogLevel log_max_level = QOF_LOG_WARNING;
 static GLogFunc previous_handler = NULL;
 
 inline QofLogLevel gLogLevelToQofLogLevel(GLogLevelFlags gll)
@@ -204,6 +208,7 @@ qof_log_shutdown (void)
         g_hash_table_destroy(log_table);
         log_table = NULL;
     }
+    log_max_level = QOF_LOG_WARNING;
 
     if (previous_handler != NULL)
     {
@@ -224,6 +229,8 @@ qof_log_set_level(QofLogModule log_module, QofLogLevel level)
         log_table = g_hash_table_new(g_str_hash, g_str_equal);
     }
     g_hash_table_insert(log_table, g_strdup((gchar*)log_module), GINT_TO_POINTER((gint)level));
+    if (level > log_max_level)
+        log_max_level = level;
 }
 
 const char *
@@ -350,11 +357,16 @@ qof_log_check(QofLogModule log_domain, QofLogLevel log_level)
 //#define _QLC_DBG(x) x
 #define _QLC_DBG(x)
     GHashTable *log_levels = log_table;
-    gchar *domain_copy = g_strdup(log_domain == NULL ? "" : log_domain);
-    gchar *dot_pointer = domain_copy;
+    gchar *domain_copy;
+    gchar *dot_pointer;
     static const QofLogLevel default_log_thresh = QOF_LOG_WARNING;
     QofLogLevel longest_match_level = default_log_thresh;
 
+    if (log_level > log_max_level)
+        return FALSE;
+    domain_copy = g_strdup(log_domain == NULL ? "" : log_domain);
+    dot_pointer = domain_copy;
+
     {
         gpointer match_level;
         if ((match_level = g_hash_table_lookup(log_levels, "")) != NULL)
@@ -21,1943 +21,545 @@
  *                                                                  *
 \********************************************************************/
 
-//#include "config.h"
-//
-//#include <sys/types.h>
-//#include <time.h>
-//#include <glib.h>
-//#include <regex.h>
-//#include <string.h>
-//
-//#include "qof.h"
-//#include "qofbackend-p.h"
-//#include "qofbook-p.h"
-//#include "qofclass-p.h"
-//#include "qofquery-p.h"
-//#include "qofquerycore-p.h"
-//
-//static QofLogModule log_module = QOF_MOD_QUERY;
-//
-//struct QofQueryTerm
-//{
-//    QofQueryParamList *     param_list;
-//    QofQueryPredData        *pdata;
-//    bool                    invert;
-//
-//    /* These values are filled in during "compilation" of the query
-//     * term, based upon the obj_name, param_name, and searched-for
-//     * object type.  If conv_fcn is NULL, then we don't know how to
-//     * convert types.
-//     */
-//    GSList *                param_fcns;
-//    QofQueryPredicateFunc   pred_fcn;
-//    
-//    QofQueryTerm()
-//    {
-//        param_list = NULL;
-//        pdata = NULL;
-//        invert = false;
-//        param_fcns = NULL;
-//        pred_fcn = NULL;
-//    }
-//};
-//
-//struct QofQuerySort
-//{
-//    QofQueryParamList * param_list;
-//    int                 options;
-//    bool                increasing;
-//
-//    /* These values are filled in during "compilation" of the query
-//     * term, based upon the obj_name, param_name, and searched-for
-//     * object type.  If conv_fcn is NULL, then we don't know how to
-//     * convert types.
-//     */
-//    bool                use_default;
-//    GSList *            param_fcns;     /* Chain of paramters to walk */
-//    QofSortFunc         obj_cmp;        /* In case you are comparing objects */
-//    QofCompareFunc      comp_fcn;       /* When you are comparing core types */
-//    
-//    QofQuerySort()
-//    {
-//        param_list = NULL;
-//        options = 0;
-//        increasing = false;
-//        use_default = false;
-//        param_fcns = NULL;
-//        obj_cmp = NULL;
-//        comp_fcn = NULL;
-//    }
-//};
-//
-///* The QUERY structure */
-//struct QofQuery
-//{
-//    /* The object type that we're searching for */
-//    QofIdType         search_for;
-//
-//    /* terms is a list of the OR-terms in a sum-of-products
-//     * logical expression. */
-//    QofTermList       terms;
-//
-//    /* sorting and chopping is independent of the search filter */
-//
-//    QofQuerySort      primary_sort;
-//    QofQuerySort      secondary_sort;
-//    QofQuerySort      tertiary_sort;
-//    QofSortFunc       defaultSort;        /* <- Computed from search_for */
-//
-//    /* The maximum number of results to return */
-//    int               max_results;
-//
-//    /* list of books that will be participating in the query */
-//    GList *           books;
-//
-//    /* a map of book to backend-compiled queries */
-//    GHashTable*       be_compiled;
-//
-//    /* cache the results so we don't have to run the whole search
-//     * again until it's really necessary */
-//    int               changed;
-//
-//    GList *           results;
-//    
-//    QofQuery()
-//    {
-//        search_for = 0;
-//        defaultSort = NULL;
-//        max_results = 0;
-//        books = NULL;
-//        be_compiled = NULL;
-//        changed = 0;
-//        results = NULL;
-//    }
-//};
-//
-//struct QofQueryCB
-//{
-//    QofQuery *        query;
-//    GList *           list;
-//    int               count;
-//    
-//    QofQueryCB()
-//    {
-//        query = NULL;
-//        list = NULL;
-//        count = 0;
-//    }
-//};
-//
-///* initial_term will be owned by the new Query */
-//static void query_init (QofQuery *q, QofQueryTerm *initial_term)
-//{
-//    QofOrTermList  l_or;
-//    QofAndTermList l_and;
-//    GHashTable *ht;
-//
-//    if (initial_term)
-//    {
-//        l_and.push_back(initial_term);
-//        l_or.push_back(l_and);
-//    }
-//
-//    if (! q->terms.empty())
-//        qof_query_clear (q);
-//
-//    g_list_free (q->results);
-//    g_list_free (q->books);
-//
-//    g_slist_free (q->primary_sort.param_list);
-//    g_slist_free (q->secondary_sort.param_list);
-//    g_slist_free (q->tertiary_sort.param_list);
-//
-//    g_slist_free (q->primary_sort.param_fcns);
-//    g_slist_free (q->secondary_sort.param_fcns);
-//    g_slist_free (q->tertiary_sort.param_fcns);
-//
-//    ht = q->be_compiled;
-//    memset (q, 0, sizeof (*q));
-//    q->be_compiled = ht;
-//
-//    q->terms = l_or;
-//    q->changed = 1;
-//    q->max_results = -1;
-//
-//    q->primary_sort.param_list = g_slist_prepend (NULL, QUERY_DEFAULT_SORT);
-//    q->primary_sort.increasing = TRUE;
-//    q->secondary_sort.increasing = TRUE;
-//    q->tertiary_sort.increasing = TRUE;
-//}
-//
-//static void swap_terms (QofQuery *q1, QofQuery *q2)
-//{
-//    if (!q1 || !q2) return;
-//
-//    QofTermList g = q1->terms;
-//    q1->terms = q2->terms;
-//    q2->terms = g;
-//
-//    GList * gb = q1->books;
-//    q1->books = q2->books;
-//    q2->books = gb;
-//
-//    q1->changed = 1;
-//    q2->changed = 1;
-//}
-//
-//static void free_query_term (QofQueryTerm *qt)
-//{
-//    if (!qt) return;
-//
-//    qof_query_core_predicate_free (qt->pdata);
-//    g_slist_free (qt->param_list);
-//    g_slist_free (qt->param_fcns);
-//    //g_free (qt);
-//    delete qt;
-//}
-//
-//static QofQueryTerm * copy_query_term (const QofQueryTerm *qt)
-//{
-//    QofQueryTerm *new_qt;
-//    if (!qt) return NULL;
-//
-//    new_qt = new QofQueryTerm;//g_new0 (QofQueryTerm, 1);
-//    memcpy (new_qt, qt, sizeof(QofQueryTerm));
-//    new_qt->param_list = g_slist_copy (qt->param_list);
-//    new_qt->param_fcns = g_slist_copy (qt->param_fcns);
-//    new_qt->pdata = qof_query_core_predicate_copy (qt->pdata);
-//    return new_qt;
-//}
-//
-//static QofAndTermList copy_and_terms (const QofAndTermList &and_terms)
-//{
-//    QofAndTermList l_and;
-//
-//    for (QofAndTermList::const_iterator it = and_terms.begin(); 
-//            it != and_terms.end(); it++)
-//    {
-//        l_and.push_back(copy_query_term (*it));
-//    }
-//
-//    return l_and;
-//}
-//
-//static QofOrTermList
-//copy_or_terms(const QofOrTermList &or_terms)
-//{
-//    QofOrTermList l_or;
-//
-//    for (QofOrTermList::const_iterator it = or_terms.begin(); 
-//            it != or_terms.end(); it++)
-//    {
-//        l_or.push_back(copy_and_terms(*it));
-//    }
-//
-//    return l_or;
-//}
-//
-//static void copy_sort (QofQuerySort *dst, const QofQuerySort *src)
-//{
-//    memcpy (dst, src, sizeof (*dst));
-//    dst->param_list = g_slist_copy (src->param_list);
-//    dst->param_fcns = g_slist_copy (src->param_fcns);
-//}
-//
-//static void free_sort (QofQuerySort *s)
-//{
-//    g_slist_free (s->param_list);
-//    s->param_list = NULL;
-//
-//    g_slist_free (s->param_fcns);
-//    s->param_fcns = NULL;
-//}
-//
-//static void free_members (QofQuery *q)
-//{
-//    if (q == NULL) return;
-//
-//    for (QofOrTermList::iterator cur_or = q->terms.begin();
-//            cur_or != q->terms.end(); cur_or++)
-//    {
-//        QofAndTermList &and_terms = *cur_or;
-//        for (QofAndTermList::iterator cur_and = and_terms.begin();
-//                cur_and != and_terms.end(); cur_and++)
-//        {
-//            free_query_term(*cur_and);
-////            cur_and->data = NULL;
-//        }
-//
-////        cur_or->data = NULL;
-//    }
-//
-//    free_sort (&(q->primary_sort));
-//    free_sort (&(q->secondary_sort));
-//    free_sort (&(q->tertiary_sort));
-//
-//    q->terms.clear();
-//
-//    g_list_free(q->books);
-//    q->books = NULL;
-//
-//    g_list_free(q->results);
-//    q->results = NULL;
-//}
-//
-//static int cmp_func (const QofQuerySort *sort, QofSortFunc default_sort,
-//                     const void * a, const void * b)
-//{
-//    QofParam *param = NULL;
-//    GSList *node;
-//    gpointer conva, convb;
-//
-//    g_return_val_if_fail (sort, 0);
-//
-//    /* See if this is a default sort */
-//    if (sort->use_default)
-//    {
-//        if (default_sort) return default_sort (a, b);
-//        return 0;
-//    }
-//
-//    /* If no parameters, consider them equal */
-//    if (!sort->param_fcns) return 0;
-//
-//    /* no compare function, consider the two objects equal */
-//    if (!sort->comp_fcn && !sort->obj_cmp) return 0;
-//
-//    /* Do the list of conversions */
-//    conva = (gpointer)a;
-//    convb = (gpointer)b;
-//    for (node = sort->param_fcns; node; node = node->next)
-//    {
-//        param = node->data;
-//
-//        /* The last term is really the "parameter getter",
-//         * unless we're comparing objects ;) */
-//        if (!node->next && !sort->obj_cmp)
-//            break;
-//
-//        /* Do the converstions */
-//        conva = (param->param_getfcn) (conva, param);
-//        convb = (param->param_getfcn) (convb, param);
-//    }
-//
-//    /* And now return the (appropriate) compare */
-//    if (sort->comp_fcn)
-//    {
-//        int rc = sort->comp_fcn (conva, convb, sort->options, param);
-//        return rc;
-//    }
-//
-//    return sort->obj_cmp (conva, convb);
-//}
-//
-//static int sort_func (const void * a, const void * b, const void * q)
-//{
-//    int retval;
-//    const QofQuery *sortQuery = q;
-//
-//    g_return_val_if_fail (sortQuery, 0);
-//
-//    retval = cmp_func (&(sortQuery->primary_sort), sortQuery->defaultSort, a, b);
-//    if (retval == 0)
-//    {
-//        retval = cmp_func (&(sortQuery->secondary_sort), sortQuery->defaultSort,
-//                           a, b);
-//        if (retval == 0)
-//        {
-//            retval = cmp_func (&(sortQuery->tertiary_sort), sortQuery->defaultSort,
-//                               a, b);
-//            return sortQuery->tertiary_sort.increasing ? retval : -retval;
-//        }
-//        else
-//        {
-//            return sortQuery->secondary_sort.increasing ? retval : -retval;
-//        }
-//    }
-//    else
-//    {
-//        return sortQuery->primary_sort.increasing ? retval : -retval;
-//    }
-//}
-//
-///* ==================================================================== */
-///* This is the main workhorse for performing the query.  For each
-// * object, it walks over all of the query terms to see if the
-// * object passes the seive.
-// */
-//
-//static int
-//check_object (const QofQuery *q, void * object)
-//{
-//    const QofQueryTerm * qt;
-//    int       and_terms_ok = 1;
-//
-//    for (QofOrTermList::const_iterator or_ptr = q->terms.begin(); 
-//            or_ptr != q->terms.end(); or_ptr++)
-//    {
-//        and_terms_ok = 1;
-//        const QofAndTermList &and_terms = *or_ptr;
-//        for (QofAndTermList::const_iterator and_ptr = and_terms.begin();
-//                and_ptr != and_terms.end(); and_ptr++)
-//        {
-//            qt = *and_ptr;
-//            if (qt->param_fcns && qt->pred_fcn)
-//            {
-//                const GSList *node;
-//                QofParam *param = NULL;
-//                gpointer conv_obj = object;
-//
-//                /* iterate through the conversions */
-//                for (node = qt->param_fcns; node; node = node->next)
-//                {
-//                    param = node->data;
-//
-//                    /* The last term is the actual parameter getter */
-//                    if (!node->next) break;
-//
-//                    conv_obj = param->param_getfcn (conv_obj, param);
-//                }
-//
-//                if (((qt->pred_fcn)(conv_obj, param, qt->pdata)) == qt->invert)
-//                {
-//                    and_terms_ok = 0;
-//                    break;
-//                }
-//            }
-//            else
-//            {
-//                /* XXX: Don't know how to do this conversion -- do we care? */
-//            }
-//        }
-//        if (and_terms_ok)
-//        {
-//            return 1;
-//        }
-//    }
-//
-//    /* If there are no terms, assume a "match any" applies.
-//     * A query with no terms is still meaningful, since the user
-//     * may want to get all objects, but in a particular sorted
-//     * order.
-//     */
-//    if (q->terms.empty()) return 1;
-//    return 0;
-//}
-//
-///* walk the list of parameters, starting with the given object, and
-// * compile the list of parameter get-functions.  Save the last valid
-// * parameter definition in "final" and return the list of functions.
-// *
-// * returns NULL if the first parameter is bad (and final is unchanged).
-// */
-//static GSList *
-//compile_params (QofQueryParamList *param_list, QofIdType start_obj,
-//                QofParam const **final)
-//{
-//    const QofParam *objDef = NULL;
-//    GSList *fcns = NULL;
-//
-//    ENTER ("param_list=%p id=%s", param_list, start_obj);
-//    g_return_val_if_fail (param_list, NULL);
-//    g_return_val_if_fail (start_obj, NULL);
-//    g_return_val_if_fail (final, NULL);
-//
-//    for (; param_list; param_list = param_list->next)
-//    {
-//        QofIdType param_name = param_list->data;
-//        objDef = qof_class_get_parameter (start_obj, param_name);
-//
-//        /* If it doesn't exist, then we've reached the end */
-//        if (!objDef) break;
-//
-//        /* Save off this parameter */
-//        fcns = g_slist_prepend (fcns, (gpointer) objDef);
-//
-//        /* Save this off, just in case */
-//        *final = objDef;
-//
-//        /* And reset for the next parameter */
-//        start_obj = (QofIdType) objDef->param_type;
-//    }
-//
-//    LEAVE ("fcns=%p", fcns);
-//    return (g_slist_reverse (fcns));
-//}
-//
-//static void
-//compile_sort (QofQuerySort *sort, QofIdType obj)
-//{
-//    const QofParam *resObj = NULL;
-//
-//    ENTER ("sort=%p id=%s params=%p", sort, obj, sort->param_list);
-//    sort->use_default = FALSE;
-//
-//    g_slist_free (sort->param_fcns);
-//    sort->param_fcns = NULL;
-//    sort->comp_fcn = NULL;
-//    sort->obj_cmp = NULL;
-//
-//    /* An empty param_list implies "no sort" */
-//    if (!sort->param_list)
-//    {
-//        LEAVE (" ");
-//        return;
-//    }
-//
-//    /* Walk the parameter list of obtain the parameter functions */
-//    sort->param_fcns = compile_params (sort->param_list, obj, &resObj);
-//
-//    /* If we have valid parameters, grab the compare function,
-//     * If not, check if this is the default sort.
-//     */
-//    if (sort->param_fcns)
-//    {
-//        /* First, check if this parameter has a sort function override.
-//         * if not then check if there's a global compare function for the type
-//         */
-//        if (resObj->param_compfcn)
-//            sort->comp_fcn = resObj->param_compfcn;
-//        else
-//            sort->comp_fcn = qof_query_core_get_compare (resObj->param_type);
-//
-//        /* Next, perhaps this is an object compare, not a core type compare? */
-//        if (sort->comp_fcn == NULL)
-//            sort->obj_cmp = qof_class_get_default_sort (resObj->param_type);
-//    }
-//    else if (!g_strcmp0 (sort->param_list->data, QUERY_DEFAULT_SORT))
-//    {
-//        sort->use_default = TRUE;
-//    }
-//    LEAVE ("sort=%p id=%s", sort, obj);
-//}
-//
-//static void compile_terms (QofQuery *q)
-//{
-//    ENTER (" query=%p", q);
-//    /* Find the specific functions for this Query.  Note that the
-//     * Query's search_for should now be set to the new type.
-//     */
-//    for (QofOrTermList::iterator or_ptr = q->terms.begin(); 
-//            or_ptr != q->terms.end(); or_ptr++)
-//    {
-//        QofAndTermList &and_terms = *or_ptr;
-//        for (QofAndTermList::iterator and_ptr = and_terms.begin(); 
-//                and_ptr != and_terms.end(); and_ptr++)
-//        {
-//            QofQueryTerm *qt = *and_ptr;
-//            const QofParam *resObj = NULL;
-//
-//            g_slist_free (qt->param_fcns);
-//            qt->param_fcns = NULL;
-//
-//            /* Walk the parameter list of obtain the parameter functions */
-//            qt->param_fcns = compile_params (qt->param_list, q->search_for,
-//                                             &resObj);
-//
-//            /* If we have valid parameters, grab the predicate function,
-//             * If not, see if this is the default sort.
-//             */
-//
-//            if (qt->param_fcns)
-//                qt->pred_fcn = qof_query_core_get_predicate (resObj->param_type);
-//            else
-//                qt->pred_fcn = NULL;
-//        }
-//    }
-//
-//    /* Update the sort functions */
-//    compile_sort (&(q->primary_sort), q->search_for);
-//    compile_sort (&(q->secondary_sort), q->search_for);
-//    compile_sort (&(q->tertiary_sort), q->search_for);
-//
-//    q->defaultSort = qof_class_get_default_sort (q->search_for);
-//
-//    /* Now compile the backend instances */
-//    for (GList *node = q->books; node; node = node->next)
-//    {
-//        QofBook *book = node->data;
-//        QofBackend *be = book->backend;
-//
-//        if (be && be->compile_query)
-//        {
-//            gpointer result = (be->compile_query)(be, q);
-//            if (result)
-//                g_hash_table_insert (q->be_compiled, book, result);
-//        }
-//    }
-//    LEAVE (" query=%p", q);
-//}
-//
-//static void check_item_cb (void * object, void * user_data)
-//{
-//    QofQueryCB *ql = user_data;
-//
-//    if (!object || !ql) return;
-//
-//    if (check_object (ql->query, object))
-//    {
-//        ql->list = g_list_prepend (ql->list, object);
-//        ql->count++;
-//    }
-//    return;
-//}
-//
-//static int param_list_cmp (const QofQueryParamList *l1, const QofQueryParamList *l2)
-//{
-//    int ret;
-//
-//    while (1)
-//    {
-//
-//        /* Check the easy stuff */
-//        if (!l1 && !l2) return 0;
-//        if (!l1 && l2) return -1;
-//        if (l1 && !l2) return 1;
-//
-//        ret = g_strcmp0 (l1->data, l2->data);
-//        if (ret)
-//            break;
-//
-//        l1 = l1->next;
-//        l2 = l2->next;
-//    }
-//    return ret;
-//}
-//
-//static GList * merge_books (GList *l1, GList *l2)
-//{
-//    GList *res = NULL;
-//    GList *node;
-//
-//    res = g_list_copy (l1);
-//
-//    for (node = l2; node; node = node->next)
-//    {
-//        if (g_list_index (res, node->data) == -1)
-//            res = g_list_prepend (res, node->data);
-//    }
-//
-//    return res;
-//}
-//
-//static bool
-//query_free_compiled (void * key, void * value, void * not_used)
-//{
-//    QofBook* book = key;
-//    QofBackend* be = book->backend;
-//
-//    if (be && be->free_query)
-//        (be->free_query)(be, value);
-//
-//    return true;
-//}
-//
-///* clear out any cached query_compilations */
-//static void query_clear_compiles (QofQuery *q)
-//{
-//    g_hash_table_foreach_remove (q->be_compiled, query_free_compiled, NULL);
-//}
-//
-///********************************************************************/
-///* PUBLISHED API FUNCTIONS */
-//
-//QofQueryParamList *
-//qof_query_build_param_list (char const *param, ...)
-//{
-//    QofQueryParamList *param_list = NULL;
-//    char const *this_param;
-//    va_list ap;
-//
-//    if (!param)
-//        return NULL;
-//
-//    va_start (ap, param);
-//
-//    for (this_param = param; this_param; this_param = va_arg (ap, const char *))
-//        param_list = g_slist_prepend (param_list, (gpointer)this_param);
-//
-//    va_end (ap);
-//
-//    return g_slist_reverse (param_list);
-//}
-//
-//void qof_query_add_term (QofQuery *q, QofQueryParamList *param_list,
-//                         QofQueryPredData *pred_data, QofQueryOp op)
-//{
-//    QofQueryTerm *qt;
-//    QofQuery *qr, *qs;
-//
-//    if (!q || !param_list || !pred_data) return;
-//
-//    qt = new QofQueryTerm;//g_new0 (QofQueryTerm, 1);
-//    qt->param_list = param_list;
-//    qt->pdata = pred_data;
-//    qs = qof_query_create ();
-//    query_init (qs, qt);
-//
-//    if (qof_query_has_terms (q))
-//        qr = qof_query_merge (q, qs, op);
-//    else
-//        qr = qof_query_merge (q, qs, QOF_QUERY_OR);
-//
-//    swap_terms (q, qr);
-//    qof_query_destroy (qs);
-//    qof_query_destroy (qr);
-//}
-//
-//void qof_query_purge_terms (QofQuery *q, QofQueryParamList *param_list)
-//{
-//    if (!q || !param_list) return;
-//
-//    for (QofOrTermList::iterator l_or = q->terms.begin();
-//            l_or != q->terms.end(); l_or++)
-//    {
-//        QofAndTermList &and_terms = *l_or;
-//        for (QofAndTermList::iterator l_and = and_terms.begin(); l_and != and_terms.end(); l_and++)
-//        {
-//            QofQueryTerm *qt = *l_and;
-//            if (!param_list_cmp (qt->param_list, param_list))
-//            {
-//                if (and_terms.size() == 1)
-//                {
-//                    q->terms.erase(l_or);
-//                    l_or = q->terms.begin();
-//                    break;
-//                }
-//                else
-//                {
-//                    and_terms.erase(l_and);
-//                    l_and = and_terms.begin();
-//                    if (l_and == and_terms.end()) break;
-//                }
-//                q->changed = 1;
-//                free_query_term (qt);
-//            }
-//        }
-//        if (l_or == q->terms.end()) break;
-//    }
-//}
-//
-//static GList * qof_query_run_internal (QofQuery *q,
-//                                       void(*run_cb)(QofQueryCB*, void *),
-//                                       void * cb_arg)
-//{
-//    GList *matching_objects = NULL;
-//    int        object_count = 0;
-//
-//    if (!q) return NULL;
-//    g_return_val_if_fail (q->search_for, NULL);
-//    g_return_val_if_fail (q->books, NULL);
-//    g_return_val_if_fail (run_cb, NULL);
-//    ENTER (" q=%p", q);
-//
-//    /* XXX: Prioritize the query terms? */
-//
-//    /* prepare the Query for processing */
-//    if (q->changed)
-//    {
-//        query_clear_compiles (q);
-//        compile_terms (q);
-//    }
-//
-//    /* Maybe log this sucker */
-//    if (qof_log_check (log_module, QOF_LOG_DEBUG))
-//        qof_query_print (q);
-//
-//    /* Now run the query over all the objects and save the results */
-//    {
-//        QofQueryCB qcb;
-//
-//        memset (&qcb, 0, sizeof (qcb));
-//        qcb.query = q;
-//
-//        /* Run the query callback */
-//        run_cb(&qcb, cb_arg);
-//
-//        matching_objects = qcb.list;
-//        object_count = qcb.count;
-//    }
-//    PINFO ("matching objects=%p count=%d", matching_objects, object_count);
-//
-//    /* There is no absolute need to reverse this list, since it's being
-//     * sorted below. However, in the common case, we will be searching
-//     * in a confined location where the objects are already in order,
-//     * thus reversing will put us in the correct order we want and make
-//     * the sorting go much faster.
-//     */
-//    matching_objects = g_list_reverse(matching_objects);
-//
-//    /* Now sort the matching objects based on the search criteria */
-//    if (q->primary_sort.comp_fcn || q->primary_sort.obj_cmp ||
-//            (q->primary_sort.use_default && q->defaultSort))
-//    {
-//        matching_objects = g_list_sort_with_data(matching_objects, sort_func, q);
-//    }
-//
-//    /* Crop the list to limit the number of splits. */
-//    if ((object_count > q->max_results) && (q->max_results > -1))
-//    {
-//        if (q->max_results > 0)
-//        {
-//            GList *mptr;
-//
-//            /* mptr is set to the first node of what will be the new list */
-//            mptr = g_list_nth(matching_objects, object_count - q->max_results);
-//            /* mptr should not be NULL, but let's be safe */
-//            if (mptr != NULL)
-//            {
-//                if (mptr->prev != NULL) mptr->prev->next = NULL;
-//                mptr->prev = NULL;
-//            }
-//            g_list_free(matching_objects);
-//            matching_objects = mptr;
-//        }
-//        else
-//        {
-//            /* q->max_results == 0 */
-//            g_list_free(matching_objects);
-//            matching_objects = NULL;
-//        }
-//        object_count = q->max_results;
-//    }
-//
-//    q->changed = 0;
-//
-//    g_list_free(q->results);
-//    q->results = matching_objects;
-//
-//    LEAVE (" q=%p", q);
-//    return matching_objects;
-//}
-//
-//static void qof_query_run_cb(QofQueryCB* qcb, void * cb_arg)
-//{
-//    GList *node;
-//
-//    (void)cb_arg; /* unused */
-//    g_return_if_fail(qcb);
-//
-//    for (node = qcb->query->books; node; node = node->next)
-//    {
-//        QofBook *book = node->data;
-//        QofBackend *be = book->backend;
-//
-//        /* run the query in the backend */
-//        if (be)
-//        {
-//            gpointer compiled_query = g_hash_table_lookup (qcb->query->be_compiled,
-//                                      book);
-//
-//            if (compiled_query && be->run_query)
-//            {
-//                (be->run_query) (be, compiled_query);
-//            }
-//        }
-//
-//        /* And then iterate over all the objects */
-//        qof_object_foreach (qcb->query->search_for, book,
-//                            (QofInstanceForeachCB) check_item_cb, qcb);
-//    }
-//}
-//
-//GList * qof_query_run (QofQuery *q)
-//{
-//    /* Just a wrapper */
-//    return qof_query_run_internal(q, qof_query_run_cb, NULL);
-//}
-//
-//static void qof_query_run_subq_cb(QofQueryCB* qcb, void * cb_arg)
-//{
-//    QofQuery* pq = cb_arg;
-//
-//    g_return_if_fail(pq);
-//    g_list_foreach(qof_query_last_run(pq), check_item_cb, qcb);
-//}
-//
-//GList *
-//qof_query_run_subquery (QofQuery *subq, const QofQuery* primaryq)
-//{
-//    if (!subq) return NULL;
-//    if (!primaryq) return NULL;
-//
-//    /* Make sure we're searching for the same thing */
-//    g_return_val_if_fail (subq->search_for, NULL);
-//    g_return_val_if_fail (primaryq->search_for, NULL);
-//    g_return_val_if_fail(!g_strcmp0(subq->search_for, primaryq->search_for),
-//                         NULL);
-//
-//    /* Perform the subquery */
-//    return qof_query_run_internal(subq, qof_query_run_subq_cb,
-//                                  (gpointer)primaryq);
-//}
-//
-//GList *
-//qof_query_last_run (QofQuery *query)
-//{
-//    if (!query)
-//        return NULL;
-//
-//    return query->results;
-//}
-//
-//void qof_query_clear (QofQuery *query)
-//{
-//    QofQuery *q2 = qof_query_create ();
-//    swap_terms (query, q2);
-//    qof_query_destroy (q2);
-//
-//    g_list_free (query->books);
-//    query->books = NULL;
-//    g_list_free (query->results);
-//    query->results = NULL;
-//    query->changed = 1;
-//}
-//
-//QofQuery * qof_query_create (void)
-//{
-//    QofQuery *qp = new QofQuery;// g_new0 (QofQuery, 1);
-//    qp->be_compiled = g_hash_table_new (g_direct_hash, g_direct_equal);
-//    query_init (qp, NULL);
-//    return qp;
-//}
-//
-//void qof_query_search_for (QofQuery *q, QofIdTypeConst obj_type)
-//{
-//    if (!q || !obj_type)
-//        return;
-//
-//    if (g_strcmp0 (q->search_for, obj_type))
-//    {
-//        q->search_for = (QofIdType) obj_type;
-//        q->changed = 1;
-//    }
-//}
-//
-//QofQuery * qof_query_create_for (QofIdTypeConst obj_type)
-//{
-//    QofQuery *q;
-//    if (!obj_type)
-//        return NULL;
-//    q = qof_query_create ();
-//    qof_query_search_for (q, obj_type);
-//    return q;
-//}
-//
-//int qof_query_has_terms (QofQuery *q)
-//{
-//    if (!q) return 0;
-//    return q->terms.size();
-//}
-//
-//int qof_query_num_terms (QofQuery *q)
-//{
-//    int n = 0;
-//    if (!q) return 0;
-//    for (QofTermList::const_iterator o = q->terms.begin(); 
-//            o != q->terms.end(); o++)
-//        n += (*o).size();
-//    return n;
-//}
-//
-//bool qof_query_has_term_type (QofQuery *q, QofQueryParamList *term_param)
-//{
-//    if (!q || !term_param)
-//        return false;
-//
-//    for (QofOrTermList::const_iterator l_or = q->terms.begin();
-//            l_or != q->terms.end(); l_or++)
-//    {
-//        const QofAndTermList and_terms = *l_or;
-//        for (QofAndTermList::const_iterator l_and = and_terms.begin();
-//                l_and != and_terms.end(); l_and++)
-//        {
-//            QofQueryTerm *qt = *l_and;
-//            if (!param_list_cmp (term_param, qt->param_list))
-//                return true;
-//        }
-//    }
-//
-//    return false;
-//}
-//
-//GSList * qof_query_get_term_type (QofQuery *q, QofQueryParamList *term_param)
-//{
-//    GSList *results = NULL;
-//
-//    if (!q || !term_param)
-//        return FALSE;
-//
-//    for (QofOrTermList::const_iterator l_or = q->terms.begin();
-//            l_or != q->terms.end(); l_or++)
-//    {
-//        const QofAndTermList and_terms = *l_or;
-//        for (QofAndTermList::const_iterator l_and = and_terms.begin();
-//                l_and != and_terms.end(); l_and++)
-//        {
-//            QofQueryTerm *qt = *l_and;
-//            if (!param_list_cmp (term_param, qt->param_list))
-//                results = g_slist_append(results, qt->pdata);
-//        }
-//    }
-//
-//    return results;
-//}
-//
-//void qof_query_destroy (QofQuery *q)
-//{
-//    if (!q) return;
-//    free_members (q);
-//    query_clear_compiles (q);
-//    g_hash_table_destroy (q->be_compiled);
-//    //g_free (q);
-//    delete q;
-//}
-//
-//QofQuery * qof_query_copy (QofQuery *q)
-//{
-//    QofQuery *copy;
-//    GHashTable *ht;
-//
-//    if (!q) return NULL;
-//    copy = qof_query_create ();
-//    ht = copy->be_compiled;
-//    free_members (copy);
-//
-//    memcpy (copy, q, sizeof (QofQuery));
-//
-//    copy->be_compiled = ht;
-//    copy->terms = copy_or_terms (q->terms);
-//    copy->books = g_list_copy (q->books);
-//    copy->results = g_list_copy (q->results);
-//
-//    copy_sort (&(copy->primary_sort), &(q->primary_sort));
-//    copy_sort (&(copy->secondary_sort), &(q->secondary_sort));
-//    copy_sort (&(copy->tertiary_sort), &(q->tertiary_sort));
-//
-//    copy->changed = 1;
-//
-//    return copy;
-//}
-//
-///* *******************************************************************
-// * qof_query_invert
-// * return a newly-allocated Query object which is the
-// * logical inverse of the original.
-// ********************************************************************/
-//
-//QofQuery * qof_query_invert (QofQuery *q)
-//{
-//    QofQuery  * retval;
-//    QofQuery  * right, * left, * iright, * ileft;
-//    QofQueryTerm * qt;
-//    QofAndTermList aterms;
-//    QofAndTermList new_oterm;
-//    int    num_or_terms;
-//
-//    if (!q)
-//        return NULL;
-//
-//    num_or_terms = q->terms.size();
-//    QofOrTermList::iterator rest;
-//    
-//    switch (num_or_terms)
-//    {
-//    case 0:
-//        retval = qof_query_create();
-//        retval->max_results = q->max_results;
-//        break;
-//
-//        /* This is the DeMorgan expansion for a single AND expression. */
-//        /* !(abc) = !a + !b + !c */
-//    case 1:
-//        retval = qof_query_create();
-//        retval->max_results = q->max_results;
-//        retval->books = g_list_copy (q->books);
-//        retval->search_for = q->search_for;
-//        retval->changed = 1;
-//
-//        aterms = *(q->terms.begin());
-//        new_oterm.clear();
-//        for (QofAndTermList::iterator cur = aterms.begin(); cur != aterms.end(); cur++)
-//        {
-//            qt = copy_query_term(*cur);
-//            qt->invert = !(qt->invert);
-//            new_oterm.push_back(qt);
-//            retval->terms.push_back(new_oterm);
-//        }
-//        break;
-//
-//        /* If there are multiple OR-terms, we just recurse by
-//         * breaking it down to !(a + b + c) =
-//         * !a * !(b + c) = !a * !b * !c.  */
-//    default:
-//        right        = qof_query_create();
-//        rest = q->terms.begin();
-//        rest++;
-//        right->terms = QofOrTermList(rest, q->terms.end());
-//
-//        left         = qof_query_create();
-//        left->terms.push_back( copy_and_terms( *(q->terms.begin())) );
-//
-//        iright       = qof_query_invert(right);
-//        ileft        = qof_query_invert(left);
-//
-//        retval = qof_query_merge(iright, ileft, QOF_QUERY_AND);
-//        retval->books          = g_list_copy (q->books);
-//        retval->max_results    = q->max_results;
-//        retval->search_for     = q->search_for;
-//        retval->changed        = 1;
-//
-//        qof_query_destroy(iright);
-//        qof_query_destroy(ileft);
-//        qof_query_destroy(right);
-//        qof_query_destroy(left);
-//        break;
-//    }
-//
-//    return retval;
-//}
-//
-///* *******************************************************************
-// * qof_query_merge
-// * combine 2 Query objects by the logical operation in "op".
-// ********************************************************************/
-//
-//QofQuery *
-//qof_query_merge(QofQuery *q1, QofQuery *q2, QofQueryOp op)
-//{
-//
-//    QofQuery * retval = NULL;
-//    QofQuery * i1, * i2;
-//    QofQuery * t1, * t2;
-//    QofIdType search_for;
-//
-//    if (!q1) return q2;
-//    if (!q2) return q1;
-//
-//    if (q1->search_for && q2->search_for)
-//        g_return_val_if_fail (g_strcmp0 (q1->search_for, q2->search_for) == 0,
-//                              NULL);
-//
-//    search_for = (q1->search_for ? q1->search_for : q2->search_for);
-//
-//    /* Avoid merge surprises if op==QOF_QUERY_AND but q1 is empty.
-//     * The goal of this tweak is to allow the user to start with
-//     * an empty q1 and then append to it recursively
-//     * (and q1 (and q2 (and q3 (and q4 ....))))
-//     * without bombing out because the append started with an
-//     * empty list.
-//     * We do essentially the same check in qof_query_add_term()
-//     * so that the first term added to an empty query doesn't screw up.
-//     */
-//    if ((QOF_QUERY_AND == op) &&
-//            ( (0 == qof_query_has_terms (q1)) || (0 == qof_query_has_terms (q2)) ))
-//    {
-//        op = QOF_QUERY_OR;
-//    }
-//
-//    switch (op)
-//    {
-//    case QOF_QUERY_OR:
-//        retval = qof_query_create();
-//        {
-//            retval->terms = copy_or_terms(q1->terms);
-//            QofOrTermList t2 = copy_or_terms(q2->terms);
-//            retval->terms.splice(retval->terms.end(), t2);
-//        }
-//        retval->books           = merge_books (q1->books, q2->books);
-//        retval->max_results    = q1->max_results;
-//        retval->changed        = 1;
-//        break;
-//
-//    case QOF_QUERY_AND:
-//        retval = qof_query_create();
-//        retval->books          = merge_books (q1->books, q2->books);
-//        retval->max_results    = q1->max_results;
-//        retval->changed        = 1;
-//
-//        /* g_list_append() can take forever, so let's build the list in
-//         * reverse and then reverse it at the end, to deal better with
-//         * "large" queries.
-//         */
-//        for (QofOrTermList::iterator i = q1->terms.begin(); i != q1->terms.end(); i++)
-//        {
-//            for (QofOrTermList::iterator j = q2->terms.begin(); j != q2->terms.end(); j++)
-//            {
-//                QofAndTermList t = copy_and_terms(*i);
-//                QofAndTermList tj = copy_and_terms(*j);
-//                t.splice(t.end(), tj);
-//                retval->terms.push_back(t);
-//            }
-//        }
-//        break;
-//
-//    case QOF_QUERY_NAND:
-//        /* !(a*b) = (!a + !b) */
-//        i1     = qof_query_invert(q1);
-//        i2     = qof_query_invert(q2);
-//        retval = qof_query_merge(i1, i2, QOF_QUERY_OR);
-//        qof_query_destroy(i1);
-//        qof_query_destroy(i2);
-//        break;
-//
-//    case QOF_QUERY_NOR:
-//        /* !(a+b) = (!a*!b) */
-//        i1     = qof_query_invert(q1);
-//        i2     = qof_query_invert(q2);
-//        retval = qof_query_merge(i1, i2, QOF_QUERY_AND);
-//        qof_query_destroy(i1);
-//        qof_query_destroy(i2);
-//        break;
-//
-//    case QOF_QUERY_XOR:
-//        /* a xor b = (a * !b) + (!a * b) */
-//        i1     = qof_query_invert(q1);
-//        i2     = qof_query_invert(q2);
-//        t1     = qof_query_merge(q1, i2, QOF_QUERY_AND);
-//        t2     = qof_query_merge(i1, q2, QOF_QUERY_AND);
-//        retval = qof_query_merge(t1, t2, QOF_QUERY_OR);
-//
-//        qof_query_destroy(i1);
-//        qof_query_destroy(i2);
-//        qof_query_destroy(t1);
-//        qof_query_destroy(t2);
-//        break;
-//    }
-//
-//    retval->search_for = search_for;
-//    return retval;
-//}
-//
-//void
-//qof_query_merge_in_place(QofQuery *q1, QofQuery *q2, QofQueryOp op)
-//{
-//    QofQuery *tmp_q;
-//
-//    if (!q1 || !q2)
-//        return;
-//
-//    tmp_q = qof_query_merge (q1, q2, op);
-//    swap_terms (q1, tmp_q);
-//    qof_query_destroy (tmp_q);
-//}
-//
-//void
-//qof_query_set_sort_order (QofQuery *q,
-//                          QofQueryParamList *params1, QofQueryParamList *params2, QofQueryParamList *params3)
-//{
-//    if (!q) return;
-//    if (q->primary_sort.param_list)
-//        g_slist_free (q->primary_sort.param_list);
-//    q->primary_sort.param_list = params1;
-//    q->primary_sort.options = 0;
-//
-//    if (q->secondary_sort.param_list)
-//        g_slist_free (q->secondary_sort.param_list);
-//    q->secondary_sort.param_list = params2;
-//    q->secondary_sort.options = 0;
-//
-//    if (q->tertiary_sort.param_list)
-//        g_slist_free (q->tertiary_sort.param_list);
-//    q->tertiary_sort.param_list = params3;
-//    q->tertiary_sort.options = 0;
-//
-//    q->changed = 1;
-//}
-//
-//void qof_query_set_sort_options (QofQuery *q, int prim_op, int sec_op,
-//                                 int tert_op)
-//{
-//    if (!q) return;
-//    q->primary_sort.options = prim_op;
-//    q->secondary_sort.options = sec_op;
-//    q->tertiary_sort.options = tert_op;
-//}
-//
-//void qof_query_set_sort_increasing (QofQuery *q, bool prim_inc,
-//                                    bool sec_inc, bool tert_inc)
-//{
-//    if (!q) return;
-//    q->primary_sort.increasing = prim_inc;
-//    q->secondary_sort.increasing = sec_inc;
-//    q->tertiary_sort.increasing = tert_inc;
-//}
-//
-//void qof_query_set_max_results (QofQuery *q, int n)
-//{
-//    if (!q) return;
-//    q->max_results = n;
-//}
-//
-//void qof_query_add_guid_list_match (QofQuery *q, QofQueryParamList *param_list,
-//                                    GList *guid_list, QofGuidMatch options,
-//                                    QofQueryOp op)
-//{
-//    QofQueryPredData *pdata;
-//
-//    if (!q || !param_list) return;
-//
-//    if (!guid_list)
-//        g_return_if_fail (options == QOF_GUID_MATCH_NULL);
-//
-//    pdata = qof_query_guid_predicate (options, guid_list);
-//    qof_query_add_term (q, param_list, pdata, op);
-//}
-//
-//void qof_query_add_guid_match (QofQuery *q, QofQueryParamList *param_list,
-//                               const GncGUID *guid, QofQueryOp op)
-//{
-//    GList *g = NULL;
-//
-//    if (!q || !param_list) return;
-//
-//    if (guid)
-//        g = g_list_prepend (g, (gpointer)guid);
-//
-//    qof_query_add_guid_list_match (q, param_list, g,
-//                                   g ? QOF_GUID_MATCH_ANY : QOF_GUID_MATCH_NULL, op);
-//
-//    g_list_free (g);
-//}
-//
-//void qof_query_set_book (QofQuery *q, QofBook *book)
-//{
-//    QofQueryParamList *slist = NULL;
-//    if (!q || !book) return;
-//
-//    /* Make sure this book is only in the list once */
-//    if (g_list_index (q->books, book) == -1)
-//        q->books = g_list_prepend (q->books, book);
-//
-//    slist = g_slist_prepend (slist, QOF_PARAM_GUID);
-//    slist = g_slist_prepend (slist, QOF_PARAM_BOOK);
-//    qof_query_add_guid_match (q, slist,
-//                              qof_instance_get_guid(book), QOF_QUERY_AND);
-//}
-//
-//GList * qof_query_get_books (QofQuery *q)
-//{
-//    if (!q) return NULL;
-//    return q->books;
-//}
-//
-//void qof_query_add_boolean_match (QofQuery *q, QofQueryParamList *param_list, bool value,
-//                                  QofQueryOp op)
-//{
-//    QofQueryPredData *pdata;
-//    if (!q || !param_list) return;
-//
-//    pdata = qof_query_boolean_predicate (QOF_COMPARE_EQUAL, value);
-//    qof_query_add_term (q, param_list, pdata, op);
-//}
-//
-///**********************************************************************/
-///* PRIVATE PUBLISHED API FUNCTIONS                                    */
-//
-//void qof_query_init (void)
-//{
-//    ENTER (" ");
-//    qof_query_core_init ();
-//    qof_class_init ();
-//    LEAVE ("Completed initialization of QofQuery");
-//}
-//
-//void qof_query_shutdown (void)
-//{
-//    qof_class_shutdown ();
-//    qof_query_core_shutdown ();
-//}
-//
-//int qof_query_get_max_results (const QofQuery *q)
-//{
-//    if (!q) return 0;
-//    return q->max_results;
-//}
-//
-//QofIdType qof_query_get_search_for (const QofQuery *q)
-//{
-//    if (!q) return NULL;
-//    return q->search_for;
-//}
-//
-//QofTermList qof_query_get_terms (const QofQuery *q)
-//{
-//    if (!q) return QofTermList();
-//    return q->terms;
-//}
-//
-//QofQueryParamList * qof_query_term_get_param_path (const QofQueryTerm *qt)
-//{
-//    if (!qt)
-//        return NULL;
-//    return qt->param_list;
-//}
-//
-//QofQueryPredData *qof_query_term_get_pred_data (const QofQueryTerm *qt)
-//{
-//    if (!qt)
-//        return NULL;
-//    return qt->pdata;
-//}
-//
-//bool qof_query_term_is_inverted (const QofQueryTerm *qt)
-//{
-//    if (!qt)
-//        return false;
-//    return qt->invert;
-//}
-//
-//void qof_query_get_sorts (QofQuery *q, QofQuerySort **primary,
-//                          QofQuerySort **secondary, QofQuerySort **tertiary)
-//{
-//    if (!q)
-//        return;
-//    if (primary)
-//        *primary = &(q->primary_sort);
-//    if (secondary)
-//        *secondary = &(q->secondary_sort);
-//    if (tertiary)
-//        *tertiary = &(q->tertiary_sort);
-//}
-//
-//QofQueryParamList * qof_query_sort_get_param_path (const QofQuerySort *qs)
-//{
-//    if (!qs)
-//        return NULL;
-//    return qs->param_list;
-//}
-//
-//int qof_query_sort_get_sort_options (const QofQuerySort *qs)
-//{
-//    if (!qs)
-//        return 0;
-//    return qs->options;
-//}
-//
-//bool qof_query_sort_get_increasing (const QofQuerySort *qs)
-//{
-//    if (!qs)
-//        return false;
-//    return qs->increasing;
-//}
-//
-//static bool
-//qof_query_term_equal (const QofQueryTerm *qt1, const QofQueryTerm *qt2)
-//{
-//    if (qt1 == qt2) return true;
-//    if (!qt1 || !qt2) return false;
-//
-//    if (qt1->invert != qt2->invert) return false;
-//    if (param_list_cmp (qt1->param_list, qt2->param_list)) return false;
-//    return qof_query_core_predicate_equal (qt1->pdata, qt2->pdata);
-//}
-//
-//static bool
-//qof_query_sort_equal (const QofQuerySort* qs1, const QofQuerySort* qs2)
-//{
-//    if (qs1 == qs2) return true;
-//    if (!qs1 || !qs2) return false;
-//
-//    /* "Empty" sorts are equivalent, regardless of the flags */
-//    if (!qs1->param_list && !qs2->param_list) return true;
-//
-//    if (qs1->options != qs2->options) return false;
-//    if (qs1->increasing != qs2->increasing) return false;
-//    return (param_list_cmp (qs1->param_list, qs2->param_list) == 0);
-//}
-//
-//bool qof_query_equal (const QofQuery *q1, const QofQuery *q2)
-//{
-//    if (q1 == q2) return true;
-//    if (!q1 || !q2) return false;
-//
-//    if (q1->terms.size() != q2->terms.size()) return false;
-//    if (q1->max_results != q2->max_results) return false;
-//
-//    QofOrTermList::const_iterator or1, or2;
-//    for (or1 = q1->terms.begin(), or2 = q2->terms.begin(); or1 != q1->terms.end();
-//            or1++, or2++)
-//    {
-//        const QofAndTermList &and1 = *or1;
-//        const QofAndTermList &and2 = *or2;
-//
-//        if (and1.size() != and2.size()) return false;
-//
-//        QofAndTermList::const_iterator ait1, ait2;
-//        for(ait1 = and1.begin(), ait2 = and2.begin(); ait1 != and1.end(); ait1++, ait2++)
-//            if (!qof_query_term_equal (*ait1, *ait2))
-//                return false;
-//    }
-//
-//    if (!qof_query_sort_equal (&(q1->primary_sort), &(q2->primary_sort)))
-//        return false;
-//    if (!qof_query_sort_equal (&(q1->secondary_sort), &(q2->secondary_sort)))
-//        return false;
-//    if (!qof_query_sort_equal (&(q1->tertiary_sort), &(q2->tertiary_sort)))
-//        return false;
-//
-//    return true;
-//}
-//
-///* **************************************************************************/
-///* Query Print functions for use with qof_log_set_level.
-//*/
-//
-///* Static prototypes */
-//static GList *qof_query_printSearchFor (QofQuery * query, GList * output);
-//static GList *qof_query_printTerms (QofQuery * query, GList * output);
-//static GList *qof_query_printSorts (QofQuerySort *s[], const int numSorts,
-//                                    GList * output);
-//static GList *qof_query_printAndTerms (const QofAndTermList &terms, GList * output);
-//static gchar *qof_query_printStringForHow (QofQueryCompare how);
-//static gchar *qof_query_printStringMatch (QofStringMatch s);
-//static gchar *qof_query_printDateMatch (QofDateMatch d);
-//static gchar *qof_query_printNumericMatch (QofNumericMatch n);
-//static gchar *qof_query_printGuidMatch (QofGuidMatch g);
-//static gchar *qof_query_printCharMatch (QofCharMatch c);
-//static GList *qof_query_printPredData (QofQueryPredData *pd, GList *lst);
-//static GString *qof_query_printParamPath (QofQueryParamList * parmList);
-//static void qof_query_printValueForParam (QofQueryPredData *pd, GString * gs);
-//static void qof_query_printOutput (GList * output);
-//
-///** \deprecated access via qof_log instead.
-// The query will be logged automatically if qof_log_set_default
-// or qof_log_set_level(QOF_MOD_QUERY, ...) are set to QOF_LOG_DEBUG
-// or higher.
-//
-// This function cycles through a QofQuery object, and
-// prints out the values of the various members of the query
-//*/
-//void
-//qof_query_print (QofQuery * query)
-//{
-//    GList *output;
-//    GString *str;
-//    QofQuerySort *s[3];
-//    gint maxResults = 0, numSorts = 3;
-//
-//    ENTER (" ");
-//
-//    if (!query)
-//    {
-//        LEAVE("query is (null)");
-//        return;
-//    }
-//
-//    output = NULL;
-//    str = NULL;
-//    maxResults = qof_query_get_max_results (query);
-//
-//    output = qof_query_printSearchFor (query, output);
-//    output = qof_query_printTerms (query, output);
-//
-//    qof_query_get_sorts (query, &s[0], &s[1], &s[2]);
-//
-//    if (s[0])
-//    {
-//        output = qof_query_printSorts (s, numSorts, output);
-//    }
-//
-//    str = g_string_new (" ");
-//    g_string_printf (str, "Maximum number of results: %d", maxResults);
-//    output = g_list_append (output, str);
-//
-//    qof_query_printOutput (output);
-//    LEAVE (" ");
-//}
-//
-//static void
-//qof_query_printOutput (GList * output)
-//{
-//    GList *lst;
-//
-//    for (lst = output; lst; lst = lst->next)
-//    {
-//        GString *line = (GString *) lst->data;
-//
-//        DEBUG (" %s", line->str);
-//        g_string_free (line, TRUE);
-//        line = NULL;
-//    }
-//}
-//
-///*
-//        Get the search_for type--This is the type of Object
-//        we are searching for (SPLIT, TRANS, etc)
-//*/
-//static GList *
-//qof_query_printSearchFor (QofQuery * query, GList * output)
-//{
-//    QofIdType searchFor;
-//    GString *gs;
-//
-//    searchFor = qof_query_get_search_for (query);
-//    gs = g_string_new ("Query Object Type: ");
-//    g_string_append (gs, (NULL == searchFor) ? "(null)" : searchFor);
-//    output = g_list_append (output, gs);
-//
-//    return output;
-//}       /* qof_query_printSearchFor */
-//
-///*
-//        Run through the terms of the query.  This is a outer-inner
-//        loop.  The elements of the outer loop are ORed, and the
-//        elements of the inner loop are ANDed.
-//*/
-//static GList *
-//qof_query_printTerms (QofQuery * query, GList * output)
-//{
-//    QofTermList terms = qof_query_get_terms (query);
-//
-//    for (QofOrTermList::iterator lst = terms.begin(); lst != terms.end(); lst++)
-//    {
-//        output = g_list_append (output, g_string_new ("OR and AND Terms:"));
-//
-//        if ( !lst->empty() )
-//        {
-//            output = qof_query_printAndTerms (*lst, output);
-//        }
-//        else
-//        {
-//            output =
-//                g_list_append (output, g_string_new ("  No data for AND terms"));
-//        }
-//    }
-//
-//    return output;
-//}       /* qof_query_printTerms */
-//
-///*
-//        Process the sort parameters
-//        If this function is called, the assumption is that the first sort
-//        not null.
-//*/
-//static GList *
-//qof_query_printSorts (QofQuerySort *s[], const int numSorts, GList * output)
-//{
-//    QofQueryParamList *gsl, *n = NULL;
-//    gint curSort;
-//    GString *gs = g_string_new ("Sort Parameters:   ");
-//
-//    for (curSort = 0; curSort < numSorts; curSort++)
-//    {
-//        bool increasing;
-//        if (!s[curSort])
-//        {
-//            break;
-//        }
-//        increasing = qof_query_sort_get_increasing (s[curSort]);
-//
-//        gsl = qof_query_sort_get_param_path (s[curSort]);
-//        if (gsl) g_string_append_printf (gs, " Param: ");
-//        for (n = gsl; n; n = n->next)
-//        {
-//            QofIdType param_name = n->data;
-//            if (gsl != n) g_string_append_printf (gs, " ");
-//            g_string_append_printf (gs, "%s", param_name);
-//        }
-//        if (gsl)
-//        {
-//            g_string_append_printf (gs, " %s ", increasing ? "DESC" : "ASC");
-//            g_string_append_printf (gs, " Options: 0x%x ", s[curSort]->options);
-//        }
-//    }
-//
-//    output = g_list_append (output, gs);
-//    return output;
-//
-//}      /* qof_query_printSorts */
-//
-///*
-//        Process the AND terms of the query.  This is a GList
-//        of WHERE terms that will be ANDed
-//*/
-//static GList *
-//qof_query_printAndTerms (const QofAndTermList & terms, GList * output)
-//{
-//    const char *prefix = "AND Terms:";
-//    QofQueryTerm *qt;
-//    QofQueryPredData *pd;
-//    QofQueryParamList *path;
-//    bool invert;
-//
-//    output = g_list_append (output, g_string_new (prefix));
-//    for (QofAndTermList::const_iterator lst = terms.begin(); lst != terms.end(); lst++)
-//    {
-//        qt = *lst;
-//        pd = qof_query_term_get_pred_data (qt);
-//        path = qof_query_term_get_param_path (qt);
-//        invert = qof_query_term_is_inverted (qt);
-//
-//        if (invert) output = g_list_append (output,
-//                                                g_string_new(" INVERT SENSE "));
-//        output = g_list_append (output, qof_query_printParamPath (path));
-//        output = qof_query_printPredData (pd, output);
-////    output = g_list_append (output, g_string_new(" "));
-//    }
-//
-//    return output;
-//}        /* qof_query_printAndTerms */
-//
-///*
-//        Process the parameter types of the predicate data
-//*/
-//static GString *
-//qof_query_printParamPath (QofQueryParamList * parmList)
-//{
-//    QofQueryParamList *list = NULL;
-//    GString *gs = g_string_new ("Param List: ");
-//    g_string_append (gs, " ");
-//    for (list = parmList; list; list = list->next)
-//    {
-//        g_string_append (gs, (gchar *) list->data);
-//        if (list->next)
-//            g_string_append (gs, "->");
-//    }
-//
-//    return gs;
-//}        /* qof_query_printParamPath */
-//
-///*
-//        Process the PredData of the AND terms
-//*/
-//static GList *
-//qof_query_printPredData (QofQueryPredData *pd, GList *lst)
-//{
-//    GString *gs;
-//
-//    gs = g_string_new ("Pred Data: ");
-//    g_string_append (gs, (gchar *) pd->type_name);
-//
-//    /* Char Predicate and GncGUID predicate don't use the 'how' field. */
-//    if (g_strcmp0 (pd->type_name, QOF_TYPE_CHAR) &&
-//            g_strcmp0 (pd->type_name, QOF_TYPE_GUID))
-//    {
-//        g_string_append_printf (gs, " how: %s",
-//                                qof_query_printStringForHow (pd->how));
-//    }
-//    lst = g_list_append(lst, gs);
-//    gs = g_string_new ("");
-//    qof_query_printValueForParam (pd, gs);
-//    lst = g_list_append(lst, gs);
-//    return lst;
-//} /* qof_query_printPredData */
-//
-///*
-//        Get a string representation for the
-//        QofCompareFunc enum type.
-//*/
-//static gchar *
-//qof_query_printStringForHow (QofQueryCompare how)
-//{
-//
-//    switch (how)
-//    {
-//    case QOF_COMPARE_LT:
-//        return "QOF_COMPARE_LT";
-//    case QOF_COMPARE_LTE:
-//        return "QOF_COMPARE_LTE";
-//    case QOF_COMPARE_EQUAL:
-//        return "QOF_COMPARE_EQUAL";
-//    case QOF_COMPARE_GT:
-//        return "QOF_COMPARE_GT";
-//    case QOF_COMPARE_GTE:
-//        return "QOF_COMPARE_GTE";
-//    case QOF_COMPARE_NEQ:
-//        return "QOF_COMPARE_NEQ";
-//    }
-//
-//    return "INVALID HOW";
-//}         /* qncQueryPrintStringForHow */
-//
-//
-//static void
-//qof_query_printValueForParam (QofQueryPredData *pd, GString * gs)
-//{
-//
-//    if (!g_strcmp0 (pd->type_name, QOF_TYPE_GUID))
-//    {
-//        GList *node;
-//        query_guid_t pdata = (query_guid_t) pd;
-//        g_string_append_printf (gs, "Match type %s",
-//                                qof_query_printGuidMatch (pdata->options));
-//        for (node = pdata->guids; node; node = node->next)
-//        {
-//            /* THREAD-UNSAFE */
-//            g_string_append_printf (gs, ", guids: %s",
-//                                    guid_to_string ((GncGUID *) node->data));
-//        }
-//        return;
-//    }
-//    if (!g_strcmp0 (pd->type_name, QOF_TYPE_STRING))
-//    {
-//        query_string_t pdata = (query_string_t) pd;
-//        g_string_append_printf (gs, " Match type %s",
-//                                qof_query_printStringMatch (pdata->options));
-//        g_string_append_printf (gs, " %s string: %s",
-//                                pdata->is_regex ? "Regex" : "Not regex",
-//                                pdata->matchstring);
-//        return;
-//    }
-//    if (!g_strcmp0 (pd->type_name, QOF_TYPE_NUMERIC))
-//    {
-//        query_numeric_t pdata = (query_numeric_t) pd;
-//        g_string_append_printf (gs, " Match type %s",
-//                                qof_query_printNumericMatch (pdata->options));
-//        g_string_append_printf (gs, " gnc_numeric: %s",
-//                                gnc_num_dbg_to_string (pdata->amount));
-//        return;
-//    }
-//    if (!g_strcmp0 (pd->type_name, QOF_TYPE_KVP))
-//    {
-//        GSList *node;
-//        query_kvp_t pdata = (query_kvp_t) pd;
-//        g_string_append_printf (gs, " kvp path: ");
-//        for (node = pdata->path; node; node = node->next)
-//        {
-//            g_string_append_printf (gs, "/%s", (gchar *) node->data);
-//        }
-//        g_string_append_printf (gs, " kvp value: %s ",
-//                                kvp_value_to_string (pdata->value));
-//        return;
-//    }
-//    if (!g_strcmp0 (pd->type_name, QOF_TYPE_INT64))
-//    {
-//        query_int64_t pdata = (query_int64_t) pd;
-//        g_string_append_printf (gs, " int64: %" G_GINT64_FORMAT, pdata->val);
-//        return;
-//    }
-//    if (!g_strcmp0 (pd->type_name, QOF_TYPE_INT32))
-//    {
-//        query_int32_t pdata = (query_int32_t) pd;
-//        g_string_append_printf (gs, " int32: %d", pdata->val);
-//        return;
-//    }
-//    if (!g_strcmp0 (pd->type_name, QOF_TYPE_DOUBLE))
-//    {
-//        query_double_t pdata = (query_double_t) pd;
-//        g_string_append_printf (gs, " double: %.18g", pdata->val);
-//        return;
-//    }
-//    if (!g_strcmp0 (pd->type_name, QOF_TYPE_DATE))
-//    {
-//        query_date_t pdata = (query_date_t) pd;
-//        g_string_append_printf (gs, " Match type %s",
-//                                qof_query_printDateMatch (pdata->options));
-//        g_string_append_printf (gs, " query_date: %s", gnc_print_date (pdata->date));
-//        return;
-//    }
-//    if (!g_strcmp0 (pd->type_name, QOF_TYPE_CHAR))
-//    {
-//        query_char_t pdata = (query_char_t) pd;
-//        g_string_append_printf (gs, " Match type %s",
-//                                qof_query_printCharMatch (pdata->options));
-//        g_string_append_printf (gs, " char list: %s", pdata->char_list);
-//        return;
-//    }
-//    if (!g_strcmp0 (pd->type_name, QOF_TYPE_BOOLEAN))
-//    {
-//        query_boolean_t pdata = (query_boolean_t) pd;
-//        g_string_append_printf (gs, " boolean: %s", pdata->val ? "TRUE" : "FALSE");
-//        return;
-//    }
-//    /** \todo QOF_TYPE_COLLECT */
-//    return;
-//}        /* qof_query_printValueForParam */
-//
-///*
-// * Print out a string representation of the
-// * QofStringMatch enum
-// */
-//static gchar *
-//qof_query_printStringMatch (QofStringMatch s)
-//{
-//    switch (s)
-//    {
-//    case QOF_STRING_MATCH_NORMAL:
-//        return "QOF_STRING_MATCH_NORMAL";
-//    case QOF_STRING_MATCH_CASEINSENSITIVE:
-//        return "QOF_STRING_MATCH_CASEINSENSITIVE";
-//    }
-//    return "UNKNOWN MATCH TYPE";
-//}           /* qof_query_printStringMatch */
-//
-///*
-// * Print out a string representation of the
-// * QofDateMatch enum
-// */
-//static gchar *
-//qof_query_printDateMatch (QofDateMatch d)
-//{
-//    switch (d)
-//    {
-//    case QOF_DATE_MATCH_NORMAL:
-//        return "QOF_DATE_MATCH_NORMAL";
-//    case QOF_DATE_MATCH_DAY:
-//        return "QOF_DATE_MATCH_DAY";
-//    }
-//    return "UNKNOWN MATCH TYPE";
-//}            /* qof_query_printDateMatch */
-//
-///*
-// * Print out a string representation of the
-// * QofNumericMatch enum
-// */
-//static gchar *
-//qof_query_printNumericMatch (QofNumericMatch n)
-//{
-//    switch (n)
-//    {
-//    case QOF_NUMERIC_MATCH_DEBIT:
-//        return "QOF_NUMERIC_MATCH_DEBIT";
-//    case QOF_NUMERIC_MATCH_CREDIT:
-//        return "QOF_NUMERIC_MATCH_CREDIT";
-//    case QOF_NUMERIC_MATCH_ANY:
-//        return "QOF_NUMERIC_MATCH_ANY";
-//    }
-//    return "UNKNOWN MATCH TYPE";
-//}        /* qof_query_printNumericMatch */
-//
-///*
-// * Print out a string representation of the
-// * QofGuidMatch enum
-// */
-//static gchar *
-//qof_query_printGuidMatch (QofGuidMatch g)
-//{
-//    switch (g)
-//    {
-//    case QOF_GUID_MATCH_ANY:
-//        return "QOF_GUID_MATCH_ANY";
-//    case QOF_GUID_MATCH_ALL:
-//        return "QOF_GUID_MATCH_ALL";
-//    case QOF_GUID_MATCH_NONE:
-//        return "QOF_GUID_MATCH_NONE";
-//    case QOF_GUID_MATCH_NULL:
-//        return "QOF_GUID_MATCH_NULL";
-//    case QOF_GUID_MATCH_LIST_ANY:
-//        return "QOF_GUID_MATCH_LIST_ANY";
-//    }
-//
-//    return "UNKNOWN MATCH TYPE";
-//}         /* qof_query_printGuidMatch */
-//
-///*
-// * Print out a string representation of the
-// * QofCharMatch enum
-// */
-//static gchar *
-//qof_query_printCharMatch (QofCharMatch c)
-//{
-//    switch (c)
-//    {
-//    case QOF_CHAR_MATCH_ANY:
-//        return "QOF_CHAR_MATCH_ANY";
-//    case QOF_CHAR_MATCH_NONE:
-//        return "QOF_CHAR_MATCH_NONE";
-//    }
-//    return "UNKNOWN MATCH TYPE";
-//}         /* qof_query_printGuidMatch */
-//
-///* ======================== END OF FILE =================== */
+#include "config.h"
+
+#include <glib.h>
+#include <string.h>
+#include <list>
+
+#include "qof.h"
+
+static QofLogModule log_module = QOF_MOD_QUERY;
+
+typedef std::list<QofQueryPredicate*> QofAndTermList;
+typedef std::list<QofAndTermList>     QofOrTermList;
+
+/* The QUERY structure */
+struct QofQuery
+{
+    /* The object type that we're searching for */
+    QofIdType         search_for;
+
+    /* terms is a list of the OR-terms in a sum-of-products
+     * logical expression. */
+    QofOrTermList     terms;
+
+    /* sorting and chopping is independent of the search filter */
+    GCompareFunc      sort;
+    gboolean          sort_increasing;
+
+    /* The maximum number of results to return */
+    int               max_results;
+
+    /* list of books that will be participating in the query */
+    GList *           books;
+
+    GList *           results;
+
+    QofQuery()
+    {
+        search_for = NULL;
+        sort = NULL;
+        sort_increasing = TRUE;
+        max_results = -1;
+        books = NULL;
+        results = NULL;
+    }
+};
+
+/* State of one scan over the candidates of a product term. */
+typedef struct
+{
+    const QofAndTermList *and_terms;
+    GHashTable *          seen;         /* NULL unless several OR-terms */
+    GList *               list;         /* matches, most recent first */
+    int                   count;
+    int                   limit;        /* stop at this many, or -1 */
+    gboolean              stopped;
+} QofQueryScan;
+
+static QofAndTermList
+copy_and_terms (const QofAndTermList &and_terms)
+{
+    QofAndTermList l_and;
+
+    for (QofAndTermList::const_iterator it = and_terms.begin();
+            it != and_terms.end(); it++)
+    {
+        l_and.push_back (qof_query_predicate_ref (*it));
+    }
+    return l_and;
+}
+
+static QofOrTermList
+copy_or_terms (const QofOrTermList &or_terms)
+{
+    QofOrTermList l_or;
+
+    for (QofOrTermList::const_iterator it = or_terms.begin();
+            it != or_terms.end(); it++)
+    {
+        l_or.push_back (copy_and_terms (*it));
+    }
+    return l_or;
+}
+
+static void
+free_terms (QofOrTermList &terms)
+{
+    for (QofOrTermList::iterator cur_or = terms.begin();
+            cur_or != terms.end(); cur_or++)
+    {
+        for (QofAndTermList::iterator cur_and = cur_or->begin();
+                cur_and != cur_or->end(); cur_and++)
+        {
+            qof_query_predicate_unref (*cur_and);
+        }
+    }
+    terms.clear ();
+}
+
+QofQuery *
+qof_query_create_for (QofIdTypeConst obj_type)
+{
+    QofQuery *q = new QofQuery;
+
+    q->search_for = obj_type;
+    return q;
+}
+
+void
+qof_query_destroy (QofQuery *q)
+{
+    if (!q) return;
+
+    free_terms (q->terms);
+    g_list_free (q->books);
+    g_list_free (q->results);
+    delete q;
+}
+
+QofIdTypeConst
+qof_query_get_search_for (const QofQuery *q)
+{
+    g_return_val_if_fail (q, NULL);
+    return q->search_for;
+}
+
+void
+qof_query_set_book (QofQuery *q, QofBook *book)
+{
+    g_return_if_fail (q);
+    g_return_if_fail (book);
+
+    /* Make sure this book is only in the list once */
+    if (g_list_index (q->books, book) == -1)
+        q->books = g_list_prepend (q->books, book);
+}
+
+GList *
+qof_query_get_books (QofQuery *q)
+{
+    g_return_val_if_fail (q, NULL);
+    return q->books;
+}
+
+void
+qof_query_clear (QofQuery *q)
+{
+    g_return_if_fail (q);
+
+    free_terms (q->terms);
+    g_list_free (q->results);
+    q->results = NULL;
+}
+
+int
+qof_query_has_terms (QofQuery *q)
+{
+    g_return_val_if_fail (q, 0);
+    return !q->terms.empty ();
+}
+
+int
+qof_query_num_terms (QofQuery *q)
+{
+    int n = 0;
+
+    g_return_val_if_fail (q, 0);
+    for (QofOrTermList::const_iterator it = q->terms.begin();
+            it != q->terms.end(); it++)
+        n += it->size ();
+    return n;
+}
+
+QofQuery *
+qof_query_copy (QofQuery *q)
+{
+    QofQuery *copy;
+
+    g_return_val_if_fail (q, NULL);
+
+    copy = new QofQuery;
+    copy->search_for = q->search_for;
+    copy->terms = copy_or_terms (q->terms);
+    copy->sort = q->sort;
+    copy->sort_increasing = q->sort_increasing;
+    copy->max_results = q->max_results;
+    copy->books = g_list_copy (q->books);
+    return copy;
+}
+
+QofQuery *
+qof_query_merge (QofQuery *q1, QofQuery *q2, QofQueryOp op)
+{
+    QofQuery *retval;
+    QofIdType search_for;
+
+    if (!q1) return q2;
+    if (!q2) return q1;
+
+    if (q1->search_for && q2->search_for)
+        g_return_val_if_fail (g_strcmp0 (q1->search_for, q2->search_for) == 0,
+                              NULL);
+
+    search_for = (q1->search_for ? q1->search_for : q2->search_for);
+
+    /* An empty query matches nothing, so merging with it leaves the
+     * other query as it was. */
+    if (q1->terms.empty ())
+    {
+        retval = qof_query_copy (q2);
+        retval->search_for = search_for;
+        return retval;
+    }
+    if (q2->terms.empty ())
+    {
+        retval = qof_query_copy (q1);
+        retval->search_for = search_for;
+        return retval;
+    }
+
+    switch (op)
+    {
+    case QOF_QUERY_OR:
+        retval = qof_query_copy (q1);
+        {
+            QofOrTermList more = copy_or_terms (q2->terms);
+            retval->terms.splice (retval->terms.end (), more);
+        }
+        break;
+
+    case QOF_QUERY_AND:
+        retval = qof_query_copy (q1);
+        free_terms (retval->terms);
+        /* (a + b)(c + d) = ac + ad + bc + bd */
+        for (QofOrTermList::const_iterator i = q1->terms.begin();
+                i != q1->terms.end(); i++)
+        {
+            for (QofOrTermList::const_iterator j = q2->terms.begin();
+                    j != q2->terms.end(); j++)
+            {
+                QofAndTermList l_and = copy_and_terms (*i);
+                QofAndTermList more = copy_and_terms (*j);
+                l_and.splice (l_and.end (), more);
+                retval->terms.push_back (l_and);
+            }
+        }
+        break;
+
+    default:
+        PWARN ("unknown query operator %d", op);
+        return NULL;
+    }
+
+    retval->search_for = search_for;
+    return retval;
+}
+
+void
+qof_query_merge_in_place (QofQuery *q1, QofQuery *q2, QofQueryOp op)
+{
+    QofQuery *merged;
+
+    g_return_if_fail (q1);
+    if (!q2) return;
+
+    merged = qof_query_merge (q1, q2, op);
+    if (!merged || merged == q1) return;
+
+    /* Only the terms change; q1 keeps its books, sort and limit. */
+    free_terms (q1->terms);
+    q1->terms.swap (merged->terms);
+    q1->search_for = merged->search_for;
+    g_list_free (q1->results);
+    q1->results = NULL;
+    qof_query_destroy (merged);
+}
+
+void
+qof_query_add_term (QofQuery *q, QofQueryPredicate *pred, QofQueryOp op)
+{
+    QofQuery *qt;
+
+    g_return_if_fail (q);
+    g_return_if_fail (pred);
+
+    qt = qof_query_create_for (q->search_for);
+    qt->terms.push_back (QofAndTermList (1, pred));
+    qof_query_merge_in_place (q, qt, op);
+    qof_query_destroy (qt);
+}
+
+void
+qof_query_set_sort (QofQuery *q, GCompareFunc compare, gboolean increasing)
+{
+    g_return_if_fail (q);
+    q->sort = compare;
+    q->sort_increasing = increasing;
+}
+
+void
+qof_query_set_max_results (QofQuery *q, int n)
+{
+    g_return_if_fail (q);
+    q->max_results = n;
+}
+
+/* ================================================================ */
+/* Running a query */
+
+static gboolean
+check_object (const QofAndTermList *and_terms, gconstpointer object)
+{
+    for (QofAndTermList::const_iterator it = and_terms->begin();
+            it != and_terms->end(); it++)
+    {
+        if (!qof_query_predicate_match (*it, object))
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static gboolean
+scan_visit (gpointer object, gpointer user_data)
+{
+    QofQueryScan *scan = (QofQueryScan *) user_data;
+
+    if (scan->stopped)
+        return FALSE;
+
+    if (!check_object (scan->and_terms, object))
+        return TRUE;
+
+    if (scan->seen)
+    {
+        if (g_hash_table_lookup (scan->seen, object))
+            return TRUE;
+        g_hash_table_insert (scan->seen, object, object);
+    }
+
+    scan->list = g_list_prepend (scan->list, object);
+    if (++scan->count == scan->limit)
+        scan->stopped = TRUE;
+    return !scan->stopped;
+}
+
+static void
+scan_collection_cb (QofInstance *inst, gpointer user_data)
+{
+    scan_visit (inst, user_data);
+}
+
+/* Pick the predicate of and_terms whose index visits the fewest
+ * objects of book, or NULL if none has one.  If ordered_by is
+ * non-NULL, an index visiting the objects in that order wins
+ * regardless, because the scan can stop early. */
+static const QofQueryPredicate *
+plan_and_term (QofBook *book, const QofAndTermList &and_terms,
+               GCompareFunc ordered_by)
+{
+    const QofQueryPredicate *best = NULL;
+    gboolean best_ordered = FALSE;
+    gsize best_estimate = 0;
+
+    for (QofAndTermList::const_iterator it = and_terms.begin();
+            it != and_terms.end(); it++)
+    {
+        const QofQueryIndex *index = qof_query_predicate_get_index (*it);
+        gboolean ordered;
+        gsize estimate;
+
+        if (!index) continue;
+
+        ordered = (ordered_by && index->order == ordered_by);
+        estimate = index->estimate (book, qof_query_predicate_get_data (*it));
+        if (!best || (ordered && !best_ordered)
+                || ((ordered == best_ordered) && (estimate < best_estimate)))
+        {
+            best = *it;
+            best_ordered = ordered;
+            best_estimate = estimate;
+        }
+    }
+    return best;
+}
+
+static void
+scan_and_term (QofQuery *q, QofBook *book, const QofQueryPredicate *index_pred,
+               gboolean reverse, QofQueryScan *scan)
+{
+    if (index_pred)
+    {
+        const QofQueryIndex *index = qof_query_predicate_get_index (index_pred);
+        GList *and_terms = NULL;
+
+        for (QofAndTermList::const_reverse_iterator it = scan->and_terms->rbegin();
+                it != scan->and_terms->rend(); it++)
+            and_terms = g_list_prepend (and_terms, *it);
+
+        index->scan (book, qof_query_predicate_get_data (index_pred), and_terms,
+                     reverse, scan_visit, scan);
+        g_list_free (and_terms);
+    }
+    else
+    {
+        qof_collection_foreach (qof_book_get_collection (book, q->search_for),
+                                scan_collection_cb, scan);
+    }
+}
+
+static gint
+sort_func (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    const QofQuery *q = (const QofQuery *) user_data;
+    gint retval = q->sort (a, b);
+
+    return q->sort_increasing ? retval : -retval;
+}
+
+/* Run the only product term of q over its only book, stopping as
+ * soon as the max_results results are known.  That needs an index
+ * which visits the objects in the sort order; returns FALSE if the
+ * term has none. */
+static gboolean
+run_limited (QofQuery *q)
+{
+    QofBook *book = (QofBook *) q->books->data;
+    const QofQueryPredicate *index_pred;
+    QofQueryScan scan;
+    gboolean reverse = FALSE;
+
+    index_pred = plan_and_term (book, q->terms.front (), q->sort);
+    if (!index_pred || qof_query_predicate_get_index (index_pred)->order != q->sort)
+        return FALSE;
+
+    /* The results are the last max_results in the sort order, so walk
+     * back from its end: from the end of the index order if the sort
+     * is increasing, from the start if decreasing. */
+    reverse = q->sort_increasing;
+
+    PINFO ("limited scan of %s for %d results", q->search_for, q->max_results);
+
+    memset (&scan, 0, sizeof (scan));
+    scan.and_terms = &q->terms.front ();
+    scan.limit = q->max_results;
+    scan_and_term (q, book, index_pred, reverse, &scan);
+
+    /* Visited from the far end of the sort order and prepended, the
+     * matches are in order already. */
+    q->results = scan.list;
+    return TRUE;
+}
+
+GList *
+qof_query_run (QofQuery *q)
+{
+    GHashTable *seen = NULL;
+    GList *results = NULL;
+    GList *node;
+    int n_results = 0;
+    gboolean stop_early;
+
+    g_return_val_if_fail (q, NULL);
+
+    g_list_free (q->results);
+    q->results = NULL;
+
+    if (!q->search_for || q->terms.empty () || !q->books || q->max_results == 0)
+        return NULL;
+
+    ENTER ("query=%p search_for=%s", q, q->search_for);
+
+    if (q->max_results > 0 && q->sort && !q->books->next
+            && q->terms.size () == 1 && run_limited (q))
+    {
+        LEAVE ("query=%p, %d results", q, g_list_length (q->results));
+        return q->results;
+    }
+
+    /* An object can satisfy more than one product term. */
+    if (q->terms.size () > 1)
+        seen = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+    /* Without a sort order any max_results matches will do, so stop
+     * at the first ones found. */
+    stop_early = (q->max_results > 0 && !q->sort);
+
+    for (node = q->books; node; node = node->next)
+    {
+        QofBook *book = (QofBook *) node->data;
+
+        for (QofOrTermList::const_iterator it = q->terms.begin();
+                it != q->terms.end(); it++)
+        {
+            QofQueryScan scan;
+
+            if (stop_early && n_results >= q->max_results)
+                break;
+
+            memset (&scan, 0, sizeof (scan));
+            scan.and_terms = &(*it);
+            scan.seen = seen;
+            scan.limit = stop_early ? q->max_results : -1;
+            scan.count = n_results;
+            scan.list = results;
+            scan_and_term (q, book, plan_and_term (book, *it, NULL), FALSE, &scan);
+            results = scan.list;
+            n_results = scan.count;
+        }
+    }
+
+    if (seen)
+        g_hash_table_destroy (seen);
+
+    if (q->sort)
+        results = g_list_sort_with_data (results, sort_func, q);
+    else
+        results = g_list_reverse (results);
+
+    /* Keep the last max_results */
+    n_results = g_list_length (results);
+    if (q->max_results > 0 && n_results > q->max_results)
+    {
+        GList *keep = g_list_nth (results, n_results - q->max_results);
+
+        keep->prev->next = NULL;
+        keep->prev = NULL;
+        g_list_free (results);
+        results = keep;
+    }
+
+    q->results = results;
+    LEAVE ("query=%p, %d results", q, g_list_length (q->results));
+    return q->results;
+}
+
+GList *
+qof_query_last_run (QofQuery *q)
+{
+    g_return_val_if_fail (q, NULL);
+    return q->results;
+}
+
+/* ========================== END OF FILE ======================= */
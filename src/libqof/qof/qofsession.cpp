@@ -1222,13 +1222,51 @@ qof_session_begin (QofSession *session, const char * book_id,
 
 /* ====================================================================== */
 
+/* Drop a book which the session no longer uses. */
+static void
+qof_session_discard_book (QofBook *book)
+{
+    qof_book_set_backend (book, NULL);
+    qof_book_destroy (book);
+}
+
+/* Keep newbook if the backend loaded it, otherwise put oldbook back.
+ * Returns TRUE if newbook was kept; if not, the caller still has to
+ * discard newbook. */
+static bool
+qof_session_load_finish (QofSession *session, QofBook *oldbook,
+                         QofBook *newbook)
+{
+    QofBackendError err;
+
+    /* XXX if the load fails, then we try to restore the old set of books;
+    * however, we don't undo the session id (the URL).  Thus if the
+    * user attempts to save after a failed load, they weill be trying to
+    * save to some bogus URL.   This is wrong. XXX  FIXME.
+    */
+    err = qof_session_get_error(session);
+    if ((err != ERR_BACKEND_NO_ERR) &&
+            (err != ERR_FILEIO_FILE_TOO_OLD) &&
+            (err != ERR_FILEIO_NO_ENCODING) &&
+            (err != ERR_FILEIO_FILE_UPGRADE) &&
+            (err != ERR_SQL_DB_TOO_OLD) &&
+            (err != ERR_SQL_DB_TOO_NEW))
+    {
+        /* Something broke, put back the old stuff */
+        session->book = oldbook;
+        return FALSE;
+    }
+    session->book = newbook;
+    qof_session_discard_book (oldbook);
+    return TRUE;
+}
+
 void
 qof_session_load (QofSession *session,
                   QofPercentageFunc percentage_func)
 {
     QofBook *newbook, *oldbook;
     QofBackend *be;
-    QofBackendError err;
 
     if (!session) return;
     if (!session->book_id) return;
@@ -1276,33 +1314,411 @@ qof_session_load (QofSession *session,
         }
     }
 
-    /* XXX if the load fails, then we try to restore the old set of books;
-    * however, we don't undo the session id (the URL).  Thus if the
-    * user attempts to save after a failed load, they weill be trying to
-    * save to some bogus URL.   This is wrong. XXX  FIXME.
-    */
-    err = qof_session_get_error(session);
-    if ((err != ERR_BACKEND_NO_ERR) &&
-            (err != ERR_FILEIO_FILE_TOO_OLD) &&
-            (err != ERR_FILEIO_NO_ENCODING) &&
-            (err != ERR_FILEIO_FILE_UPGRADE) &&
-            (err != ERR_SQL_DB_TOO_OLD) &&
-            (err != ERR_SQL_DB_TOO_NEW))
+    if (!qof_session_load_finish (session, oldbook, newbook))
     {
-        /* Something broke, put back the old stuff */
-        qof_book_set_backend (newbook, NULL);
-        qof_book_destroy (newbook);
-        session->book = oldbook;
+        qof_session_discard_book (newbook);
         LEAVE("error from backend %d", qof_session_get_error(session));
         return;
     }
-    qof_book_set_backend (oldbook, NULL);
-    qof_book_destroy (oldbook);
 
     LEAVE ("sess = %p, book_id=%s", session, session->book_id
            ? session->book_id : "(null)");
 }
 
+/* ====================================================================== */
+/* Loading on a worker thread.
+ *
+ * The worker runs the backend's load into a new book.  Everything it has
+ * to tell the main loop -- progress, stages, completion -- is recorded in
+ * the QofSessionAsyncLoad under its lock and delivered by a single idle
+ * handler, so the callbacks arrive on the main loop in order and the
+ * record is freed only by the dispatch which sees the load finished.
+ *
+ * The engine isn't thread safe, so the two threads take turns with it.
+ * The main thread has the engine whenever it isn't waiting in poll().
+ * The worker keeps it for at least ENGINE_TURN_USEC, and then hands it
+ * back at the next progress report or qof_backend_load_yield() if the
+ * main thread is waiting.  Main loop handlers therefore run only between
+ * the objects the backend loads, just as they did when the progress
+ * callback of a synchronous load pumped the main loop.
+ *
+ * The new book stays out of the session until the load is finished, so
+ * nothing the main loop runs can see it half built.
+ *
+ * The backend's percentage callback carries no user data, which is why
+ * there can only be one asynchronous load at a time.
+ */
+
+typedef struct
+{
+    QofSession *session;
+    QofBook *oldbook;
+    QofBook *newbook;
+    QofPercentageFunc percentage_func;
+    QofSessionLoadCB accounts_ready;
+    QofSessionLoadCB done;
+    gpointer user_data;
+    GThread *thread;
+
+    /* Guarded by the async_load lock */
+    char *message;
+    double percent;
+    bool progress_changed;
+    bool accounts_loaded;
+    bool accounts_reported;
+    bool finished;
+    bool dispatch_queued;
+} QofSessionAsyncLoad;
+
+static QofSessionAsyncLoad *async_load = NULL;
+G_LOCK_DEFINE_STATIC (async_load);
+
+/* How long the worker keeps the engine before letting a waiting main
+ * loop have it: short enough for the window to keep redrawing, long
+ * enough that taking turns costs the load little. */
+#define ENGINE_TURN_USEC 20000
+
+/* Turns with the engine.  When both threads are waiting, the one which
+ * didn't have it last goes next. */
+typedef enum
+{
+    ENGINE_MAIN,
+    ENGINE_WORKER,
+    ENGINE_ANYONE
+} QofEngineUser;
+
+#ifdef HAVE_GLIB_2_32
+static GMutex engine_mutex_s;
+static GCond engine_cond_s;
+#define engine_mutex (&engine_mutex_s)
+#define engine_cond (&engine_cond_s)
+#else
+static GMutex *engine_mutex = NULL;
+static GCond *engine_cond = NULL;
+#endif
+static bool engine_held = FALSE;
+static QofEngineUser engine_next = ENGINE_ANYONE;
+static int engine_waiting[ENGINE_ANYONE];
+/* When the worker's turn started; only used on the worker */
+static gint64 worker_turn_start = 0;
+/* The main context's own poll function; only used on the main thread */
+static GPollFunc engine_main_poll = NULL;
+
+static gboolean async_load_dispatch (gpointer data);
+
+/* Called with engine_mutex held. */
+static void
+engine_wait (QofEngineUser user)
+{
+    QofEngineUser other = (user == ENGINE_MAIN) ? ENGINE_WORKER : ENGINE_MAIN;
+
+    engine_waiting[user]++;
+    while (engine_held ||
+            (engine_next == other && engine_waiting[other] > 0))
+        g_cond_wait (engine_cond, engine_mutex);
+    engine_waiting[user]--;
+    engine_held = TRUE;
+    engine_next = ENGINE_ANYONE;
+}
+
+/* Called with engine_mutex held. */
+static void
+engine_give_up (QofEngineUser user)
+{
+    engine_held = FALSE;
+    engine_next = (user == ENGINE_MAIN) ? ENGINE_WORKER : ENGINE_MAIN;
+    g_cond_broadcast (engine_cond);
+}
+
+static void
+engine_acquire (QofEngineUser user)
+{
+    g_mutex_lock (engine_mutex);
+    engine_wait (user);
+    g_mutex_unlock (engine_mutex);
+}
+
+static void
+engine_release (QofEngineUser user)
+{
+    g_mutex_lock (engine_mutex);
+    engine_give_up (user);
+    g_mutex_unlock (engine_mutex);
+}
+
+/* Once its turn is up, the worker lets the main thread have the engine
+ * if it is waiting. */
+static void
+engine_yield (void)
+{
+    if (g_get_monotonic_time () - worker_turn_start < ENGINE_TURN_USEC)
+        return;
+
+    g_mutex_lock (engine_mutex);
+    if (engine_waiting[ENGINE_MAIN] > 0)
+    {
+        engine_give_up (ENGINE_WORKER);
+        engine_wait (ENGINE_WORKER);
+    }
+    g_mutex_unlock (engine_mutex);
+    worker_turn_start = g_get_monotonic_time ();
+}
+
+/* Replaces the default main context's poll function while a load runs:
+ * the worker has the engine while the main loop is idle. */
+static gint
+async_load_poll (GPollFD *ufds, guint nfds, gint timeout)
+{
+    gint ready;
+
+    engine_release (ENGINE_MAIN);
+    ready = engine_main_poll (ufds, nfds, timeout);
+    engine_acquire (ENGINE_MAIN);
+    return ready;
+}
+
+/* Called with the async_load lock held. */
+static void
+async_load_queue_dispatch (QofSessionAsyncLoad *load)
+{
+    if (load->dispatch_queued) return;
+    load->dispatch_queued = TRUE;
+    g_idle_add (async_load_dispatch, load);
+}
+
+/* The backend's percentage callback while the worker runs.  Only the
+ * latest figure is kept; the main loop shows it when it gets round to
+ * it. */
+static void
+async_load_percentage (const char *message, double percent)
+{
+    G_LOCK (async_load);
+    if (async_load)
+    {
+        if (message)
+        {
+            g_free (async_load->message);
+            async_load->message = g_strdup (message);
+        }
+        async_load->percent = percent;
+        async_load->progress_changed = TRUE;
+        async_load_queue_dispatch (async_load);
+    }
+    G_UNLOCK (async_load);
+    engine_yield ();
+}
+
+static void
+async_load_stage (QofBackend *be, QofBook *book, QofBackendLoadStage stage)
+{
+    if (stage != QOF_LOAD_STAGE_ACCOUNTS) return;
+
+    G_LOCK (async_load);
+    if (async_load && async_load->newbook == book)
+    {
+        async_load->accounts_loaded = TRUE;
+        async_load_queue_dispatch (async_load);
+    }
+    G_UNLOCK (async_load);
+    engine_yield ();
+}
+
+static void
+async_load_yield (QofBackend *be)
+{
+    engine_yield ();
+}
+
+static gpointer
+async_load_thread (gpointer data)
+{
+    QofSessionAsyncLoad *load = (QofSessionAsyncLoad *) data;
+    QofBackend *be;
+
+    engine_acquire (ENGINE_WORKER);
+    worker_turn_start = g_get_monotonic_time ();
+
+    be = load->session->backend;
+    if (be && be->load)
+        be->load (be, load->newbook, LOAD_TYPE_INITIAL_LOAD);
+
+    G_LOCK (async_load);
+    load->finished = TRUE;
+    async_load_queue_dispatch (load);
+    G_UNLOCK (async_load);
+
+    engine_release (ENGINE_WORKER);
+    return NULL;
+}
+
+/* Back on the main loop once the worker is done: swap the book in, or
+ * throw it away, just as qof_session_load does. */
+static void
+async_load_finish (QofSessionAsyncLoad *load)
+{
+    QofSession *session = load->session;
+    QofBackend *be = session->backend;
+    bool loaded;
+
+    g_thread_join (load->thread);
+
+    /* The engine is the main thread's alone again */
+    g_main_context_set_poll_func (NULL, engine_main_poll);
+    engine_release (ENGINE_MAIN);
+
+    G_LOCK (async_load);
+    async_load = NULL;
+    G_UNLOCK (async_load);
+
+    if (be)
+    {
+        be->percentage = load->percentage_func;
+        be->load_stage = NULL;
+        be->load_yield = NULL;
+        if (be->load)
+            qof_session_push_error (session, qof_backend_get_error(be), NULL);
+    }
+
+    loaded = qof_session_load_finish (session, load->oldbook, load->newbook);
+    PINFO ("sess=%p load %s", session, loaded ? "done" : "failed");
+
+    /* Backends which don't report stages have their accounts ready now */
+    if (loaded && !load->accounts_reported && load->accounts_ready)
+        load->accounts_ready (session, session->book, load->user_data);
+    if (load->done)
+        load->done (session, session->book, load->user_data);
+
+    /* Only after done, which may still compare session->book with the
+     * book accounts_ready was given. */
+    if (!loaded)
+        qof_session_discard_book (load->newbook);
+
+    g_free (load->message);
+    g_free (load);
+}
+
+/* The callbacks may run the main loop themselves, which can dispatch
+ * the next batch and even finish the load, so everything needed from
+ * load is copied before calling them. */
+static gboolean
+async_load_dispatch (gpointer data)
+{
+    QofSessionAsyncLoad *load = (QofSessionAsyncLoad *) data;
+    QofSession *session = load->session;
+    QofBook *book = load->newbook;
+    QofPercentageFunc percentage_func = load->percentage_func;
+    QofSessionLoadCB accounts_ready = load->accounts_ready;
+    gpointer user_data = load->user_data;
+    char *message;
+    double percent;
+    bool progress, accounts, finished;
+
+    G_LOCK (async_load);
+    load->dispatch_queued = FALSE;
+    message = load->message;
+    load->message = NULL;
+    percent = load->percent;
+    progress = load->progress_changed;
+    load->progress_changed = FALSE;
+    accounts = load->accounts_loaded && !load->accounts_reported;
+    load->accounts_reported = load->accounts_loaded;
+    finished = load->finished;
+    G_UNLOCK (async_load);
+
+    if (accounts && accounts_ready)
+        accounts_ready (session, book, user_data);
+    if (progress && percentage_func)
+        percentage_func (message, percent);
+    g_free (message);
+
+    /* The worker queues nothing after finishing, so no nested dispatch
+     * can have freed load if this one saw it finished. */
+    if (finished)
+        async_load_finish (load);
+    return FALSE;
+}
+
+bool
+qof_session_load_async (QofSession *session,
+                        QofPercentageFunc percentage_func,
+                        QofSessionLoadCB accounts_ready,
+                        QofSessionLoadCB done, gpointer user_data)
+{
+    QofSessionAsyncLoad *load;
+    QofBackend *be;
+
+    if (!session) return FALSE;
+    if (!session->book_id) return FALSE;
+
+    ENTER ("sess=%p book_id=%s", session, session->book_id);
+
+    G_LOCK (async_load);
+    if (async_load)
+    {
+        G_UNLOCK (async_load);
+        PWARN ("a load is already in progress");
+        LEAVE (" ");
+        return FALSE;
+    }
+    load = g_new0 (QofSessionAsyncLoad, 1);
+    async_load = load;
+    G_UNLOCK (async_load);
+
+#ifndef HAVE_GLIB_2_32
+    if (!engine_mutex)
+    {
+        engine_mutex = g_mutex_new ();
+        engine_cond = g_cond_new ();
+    }
+#endif
+    /* The caller has the engine until the main loop next waits */
+    engine_acquire (ENGINE_MAIN);
+    engine_main_poll = g_main_context_get_poll_func (NULL);
+    g_main_context_set_poll_func (NULL, async_load_poll);
+
+    load->session = session;
+    load->percentage_func = percentage_func;
+    load->accounts_ready = accounts_ready;
+    load->done = done;
+    load->user_data = user_data;
+
+    /* The session keeps its old book until the load is finished */
+    load->oldbook = session->book;
+    load->newbook = qof_book_new ();
+    PINFO ("new book=%p", load->newbook);
+
+    qof_session_clear_error (session);
+
+    be = session->backend;
+    qof_book_set_backend (load->newbook, be);
+    if (be)
+    {
+        be->percentage = async_load_percentage;
+        be->load_stage = async_load_stage;
+        be->load_yield = async_load_yield;
+    }
+
+#ifdef HAVE_GLIB_2_32
+    load->thread = g_thread_new ("qof-session-load", async_load_thread, load);
+#else
+    load->thread = g_thread_create (async_load_thread, load, TRUE, NULL);
+#endif
+
+    LEAVE (" ");
+    return TRUE;
+}
+
+bool
+qof_session_load_in_progress (const QofSession *session)
+{
+    bool in_progress;
+
+    G_LOCK (async_load);
+    in_progress = (session && async_load && async_load->session == session);
+    G_UNLOCK (async_load);
+    return in_progress;
+}
+
 /* ====================================================================== */
 
 static bool
@@ -1507,6 +1923,7 @@ void
 qof_session_end (QofSession *session)
 {
     if (!session) return;
+    g_return_if_fail (!qof_session_load_in_progress (session));
 
     ENTER ("sess=%p book_id=%s", session, session->book_id
            ? session->book_id : "(null)");
@@ -1530,6 +1947,7 @@ void
 qof_session_destroy (QofSession *session)
 {
     if (!session) return;
+    g_return_if_fail (!qof_session_load_in_progress (session));
 
     ENTER ("sess=%p book_id=%s", session, session->book_id
            ? session->book_id : "(null)");
@@ -169,6 +169,49 @@ typedef void (*QofPercentageFunc) (const char *message, double percent);
 void qof_session_load (QofSession *session,
                        QofPercentageFunc percentage_func);
 
+/** Called on the main loop as an asynchronous load progresses. */
+typedef void (*QofSessionLoadCB) (QofSession *session, QofBook *book,
+                                  gpointer user_data);
+
+/**
+ * The qof_session_load_async() method loads the book like
+ *    qof_session_load(), but runs the backend on a worker thread and
+ *    returns at once.  It must be called from the thread which runs
+ *    the default GMainContext.  Progress is passed to percentage_func,
+ *    and the other callbacks are called, from that context, so the
+ *    caller has to keep the main loop running.
+ *
+ *    The engine is not thread safe, so the two threads take turns with
+ *    it.  The worker only runs while the main loop is waiting for
+ *    events, and hands the engine back every few hundredths of a
+ *    second, so main loop handlers may use the engine as usual.
+ *
+ *    accounts_ready is called once the backend has read the account
+ *    tree, while transactions are still loading, so that the caller
+ *    can say so.  The book it is passed is the one being loaded; it
+ *    stays out of the session, and must not be used, until done is
+ *    called.  Backends which don't report their stages get
+ *    accounts_ready just before done.
+ *
+ *    done is called once the new book has replaced the old one, or
+ *    the old one has been put back, exactly as qof_session_load()
+ *    would; check qof_session_get_error() to tell which.  A new book
+ *    which failed to load is destroyed after done returns.
+ *
+ *    Only one asynchronous load can run at a time, and the session
+ *    must not be saved, ended or destroyed until done is called.
+ *    Callers should suspend events for the duration, as they do around
+ *    qof_session_load().  Returns FALSE, without calling anything, if
+ *    the load could not be started.
+ */
+bool qof_session_load_async (QofSession *session,
+                             QofPercentageFunc percentage_func,
+                             QofSessionLoadCB accounts_ready,
+                             QofSessionLoadCB done, gpointer user_data);
+
+/** Returns TRUE while an asynchronous load of session is running. */
+bool qof_session_load_in_progress (const QofSession *session);
+
 /** @name Session Errors
  @{ */
 /** The qof_session_get_error() routine can be used to obtain the reason
@@ -622,6 +622,133 @@ test_timespecCanonicalDayTime (void)
     g_assert_cmpint (nb.tv_sec, ==, rb.tv_sec);
     g_assert_cmpint (nc.tv_sec, ==, rc.tv_sec);
  }
+/* gnc_localtime_r, gnc_mktime and timespecCanonicalDayTime convert through
+ * a cached table of the local timezone's transitions. Check them against
+ * GDateTime across 1800-2199, in the local zone and in one with DST rules.
+ */
+#define TZ_SAMPLES 20000
+#define TZ_BENCH_SAMPLES 100000
+#define TZ_BENCH_SAMPLES_PERF 10000000
+static const time64 tz_sample_start = -5364662400LL; /* 1800-01-01 UTC */
+static const time64 tz_sample_end = 7258118400LL; /* 2200-01-01 UTC */
+
+static time64
+tz_sample_time (gint ind, gint n_samples)
+{
+    time64 step = (tz_sample_end - tz_sample_start) / n_samples;
+    return tz_sample_start + ind * step + (ind * 7919LL) % 86400;
+}
+
+static gint
+check_tz_sample (void)
+{
+    gint ind, dst_hits = 0;
+    for (ind = 0; ind < TZ_SAMPLES; ind++)
+    {
+	time64 secs = tz_sample_time (ind, TZ_SAMPLES);
+	struct tm tm;
+	GDateTime *gdt = gncdt.new_from_unix_local (secs);
+	time64 offset = g_date_time_get_utc_offset (gdt) / G_TIME_SPAN_SECOND;
+	Timespec ts = { secs, 0 };
+	Timespec noon = compute_noon_of_day (&ts);
+
+	g_assert (gnc_localtime_r (&secs, &tm) != NULL);
+	g_assert_cmpint (tm.tm_year + 1900, ==, g_date_time_get_year (gdt));
+	g_assert_cmpint (tm.tm_mon + 1, ==, g_date_time_get_month (gdt));
+	g_assert_cmpint (tm.tm_mday, ==, g_date_time_get_day_of_month (gdt));
+	g_assert_cmpint (tm.tm_hour, ==, g_date_time_get_hour (gdt));
+	g_assert_cmpint (tm.tm_min, ==, g_date_time_get_minute (gdt));
+	g_assert_cmpint (tm.tm_sec, ==, g_date_time_get_second (gdt));
+	g_assert_cmpint (tm.tm_wday, ==, g_date_time_get_day_of_week (gdt));
+	g_assert_cmpint (tm.tm_yday, ==, g_date_time_get_day_of_year (gdt));
+	g_assert_cmpint (tm.tm_isdst, ==,
+			 g_date_time_is_daylight_savings (gdt) ? 1 : 0);
+	g_assert_cmpint (tm.tm_gmtoff, ==, offset);
+	if (tm.tm_isdst)
+	    ++dst_hits;
+	g_date_time_unref (gdt);
+
+	tm.tm_isdst = -1;
+	gdt = gncdt.new_local (tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+			       tm.tm_hour, tm.tm_min, (gdouble)tm.tm_sec);
+	g_assert_cmpint (gnc_mktime (&tm), ==, g_date_time_to_unix (gdt));
+	g_assert_cmpint (tm.tm_gmtoff, ==,
+			 g_date_time_get_utc_offset (gdt) / G_TIME_SPAN_SECOND);
+	g_date_time_unref (gdt);
+
+	g_assert_cmpint (timespecCanonicalDayTime (ts).tv_sec, ==, noon.tv_sec);
+    }
+    return dst_hits;
+}
+
+static void
+test_gnc_date_tz_cache (void)
+{
+    gchar *old_tz = g_strdup (g_getenv ("TZ"));
+
+    check_tz_sample ();
+    g_setenv ("TZ", "EST5EDT,M3.2.0,M11.1.0", TRUE);
+    g_assert_cmpint (check_tz_sample (), >, 0);
+    if (old_tz)
+	g_setenv ("TZ", old_tz, TRUE);
+    else
+	g_unsetenv ("TZ");
+    g_free (old_tz);
+    check_tz_sample ();
+}
+
+/* Times local conversions through the cache against GDateTime. Run with
+ * -m perf for ten million timestamps each way. */
+static void
+test_gnc_date_tz_cache_perf (void)
+{
+    gint n_samples = g_test_perf () ? TZ_BENCH_SAMPLES_PERF : TZ_BENCH_SAMPLES;
+    gint ind;
+    gint64 checksum = 0, glib_checksum = 0;
+    gdouble elapsed;
+    struct tm tm;
+
+    g_test_timer_start ();
+    for (ind = 0; ind < n_samples; ind++)
+    {
+	time64 secs = tz_sample_time (ind, n_samples);
+	gnc_localtime_r (&secs, &tm);
+	checksum += tm.tm_mday + tm.tm_hour;
+    }
+    elapsed = g_test_timer_elapsed ();
+    if (g_test_perf ())
+	g_test_minimized_result (elapsed, "gnc_localtime_r: %d times in %g seconds",
+				 n_samples, elapsed);
+
+    g_test_timer_start ();
+    for (ind = 0; ind < n_samples; ind++)
+    {
+	time64 secs = tz_sample_time (ind, n_samples);
+	GDateTime *gdt = gncdt.new_from_unix_local (secs);
+	glib_checksum += g_date_time_get_day_of_month (gdt) +
+			 g_date_time_get_hour (gdt);
+	g_date_time_unref (gdt);
+    }
+    elapsed = g_test_timer_elapsed ();
+    if (g_test_perf ())
+	g_test_minimized_result (elapsed, "GDateTime: %d times in %g seconds",
+				 n_samples, elapsed);
+    g_assert_cmpint (checksum, ==, glib_checksum);
+
+    g_test_timer_start ();
+    for (ind = 0; ind < n_samples; ind++)
+    {
+	time64 secs = tz_sample_time (ind, n_samples);
+	gnc_localtime_r (&secs, &tm);
+	tm.tm_isdst = -1;
+	checksum += gnc_mktime (&tm);
+    }
+    elapsed = g_test_timer_elapsed ();
+    if (g_test_perf ())
+	g_test_minimized_result (elapsed, "gnc_localtime_r and gnc_mktime: %d times in %g seconds",
+				 n_samples, elapsed);
+}
+
 
 /* gnc_date_get_last_mday
 int gnc_date_get_last_mday (int month, int year)// C: 1  Local: 1:0:0
@@ -1677,6 +1804,107 @@ test_gnc_timespec_to_iso8601_buff (void)
     g_time_zone_unref (tz05);
     g_time_zone_unref (tz0840);
 }
+
+static void
+test_gnc_iso8601_scan_fixed (void)
+{
+    GTimeZone *tz0530 = g_time_zone_new ("+05:30");
+    GDateTime *gdt1 = g_date_time_new_utc (1989, 3, 27, 13, 43, 27.0);
+    GDateTime *gdt2 = g_date_time_new (tz0530, 2012, 7, 4, 19, 27, 44.0);
+    const gchar *bad[] = { "", "2020-11-7 06:21:19 -05", "2013-02-29 00:00:00",
+			   "1989-03-27T13:43:27", "1989-03-27 24:00:00",
+			   "1989-03-27 13:43:27.", "1989-03-27 13:43:27 +5" };
+    const gchar *str, *end;
+    Timespec t = { 0, 0 };
+    gboolean has_zone = TRUE;
+    guint ind;
+
+    str = "1989-03-27 13:43:27.345";
+    end = gnc_iso8601_scan_fixed (str, &t, &has_zone);
+    g_assert (end == str + strlen (str));
+    g_assert (!has_zone);
+    g_assert_cmpint (t.tv_sec, ==, g_date_time_to_unix (gdt1));
+    g_assert_cmpint (t.tv_nsec, ==, 345000000);
+
+    str = "2012-07-04 19:27:44 +0530 trailing";
+    end = gnc_iso8601_scan_fixed (str, &t, &has_zone);
+    g_assert_cmpstr (end, ==, " trailing");
+    g_assert (has_zone);
+    g_assert_cmpint (t.tv_sec, ==, g_date_time_to_unix (gdt2));
+    g_assert_cmpint (t.tv_nsec, ==, 0);
+
+    end = gnc_iso8601_scan_fixed ("2012-07-04 19:27:44+05:30", &t, NULL);
+    g_assert (end != NULL && *end == '\0');
+    g_assert_cmpint (t.tv_sec, ==, g_date_time_to_unix (gdt2));
+
+    end = gnc_iso8601_scan_fixed ("1989-03-27 13:43:27Z", &t, &has_zone);
+    g_assert (end != NULL && *end == '\0');
+    g_assert (has_zone);
+    g_assert_cmpint (t.tv_sec, ==, g_date_time_to_unix (gdt1));
+
+    for (ind = 0; ind < G_N_ELEMENTS (bad); ind++)
+	g_assert (gnc_iso8601_scan_fixed (bad[ind], &t, NULL) == NULL);
+    g_assert (gnc_iso8601_scan_fixed (NULL, &t, NULL) == NULL);
+
+    g_date_time_unref (gdt1);
+    g_date_time_unref (gdt2);
+    g_time_zone_unref (tz0530);
+}
+
+/* Round trips through the fixed format must agree with the GDateTime
+ * based formatting. Run with -m perf for timings. */
+#define ISO8601_SAMPLES 10000
+#define ISO8601_SAMPLES_PERF 1000000
+static void
+test_gnc_iso8601_round_trip (void)
+{
+    gint n_samples = g_test_perf () ? ISO8601_SAMPLES_PERF : ISO8601_SAMPLES;
+    gchar buff[ISO8601_SIZE];
+    gint ind;
+    gdouble elapsed;
+
+    for (ind = 0; ind < n_samples; ind++)
+    {
+	Timespec t = { tz_sample_time (ind, n_samples), (ind * 7919L) % 1000000 * 1000 };
+	GDateTime *gdt = gncdt.new_from_unix_local (t.tv_sec);
+	GDateTime *ngdt = g_date_time_add (gdt, t.tv_nsec / 1000);
+	gchar *time_str = format_timestring (ngdt);
+	gboolean has_zone = FALSE;
+	Timespec parsed;
+
+	g_assert (gnc_timespec_to_iso8601_buff (t, buff) == buff + strlen (buff));
+	g_assert_cmpstr (buff, ==, time_str);
+	parsed = gnc_iso8601_to_timespec_gmt (buff);
+	g_assert_cmpint (parsed.tv_sec, ==, t.tv_sec);
+	g_assert_cmpint (parsed.tv_nsec, ==, t.tv_nsec);
+
+	g_assert (gnc_time64_to_iso8601_buff (t.tv_sec, buff) != NULL);
+	g_assert (gnc_iso8601_scan_fixed (buff, &parsed, &has_zone) != NULL);
+	g_assert (has_zone);
+	g_assert_cmpint (parsed.tv_sec, ==, t.tv_sec);
+	g_free (time_str);
+	g_date_time_unref (ngdt);
+	g_date_time_unref (gdt);
+    }
+
+    if (!g_test_perf ())
+	return;
+    g_test_timer_start ();
+    for (ind = 0; ind < n_samples; ind++)
+    {
+	Timespec t = { tz_sample_time (ind, n_samples), 0 };
+	gnc_timespec_to_iso8601_buff (t, buff);
+    }
+    elapsed = g_test_timer_elapsed ();
+    g_test_minimized_result (elapsed, "Formatted %d timestamps in %g seconds",
+			     n_samples, elapsed);
+    g_test_timer_start ();
+    for (ind = 0; ind < n_samples; ind++)
+	gnc_iso8601_to_timespec_gmt (buff);
+    elapsed = g_test_timer_elapsed ();
+    g_test_minimized_result (elapsed, "Parsed %d timestamps in %g seconds",
+			     n_samples, elapsed);
+}
 /* gnc_timespec2dmy
 void
 gnc_timespec2dmy (Timespec t, int *day, int *month, int *year)// C: 1  Local: 0:0:0
@@ -2280,6 +2508,8 @@ test_suite_gnc_date (void)
     GNC_TEST_ADD_FUNC (suitename, "timespec diff", test_timespec_diff);
     GNC_TEST_ADD_FUNC (suitename, "timespec abs", test_timespec_abs);
     GNC_TEST_ADD_FUNC (suitename, "timespecCanonicalDayTime", test_timespecCanonicalDayTime);
+    GNC_TEST_ADD_FUNC (suitename, "gnc date tz cache", test_gnc_date_tz_cache);
+    GNC_TEST_ADD_FUNC (suitename, "gnc date tz cache perf", test_gnc_date_tz_cache_perf);
     GNC_TEST_ADD_FUNC (suitename, "date get last mday", test_gnc_date_get_last_mday);
     GNC_TEST_ADD_FUNC (suitename, "qof date format set", test_qof_date_format_set);
 // GNC_TEST_ADD_FUNC (suitename, "qof date completion set", test_qof_date_completion_set);
@@ -2299,6 +2529,8 @@ test_suite_gnc_date (void)
     GNC_TEST_ADD_FUNC (suitename, "gnc_date_timestamp", test_gnc_date_timestamp);
     GNC_TEST_ADD_FUNC (suitename, "gnc iso8601 to timespec gmt", test_gnc_iso8601_to_timespec_gmt);
     GNC_TEST_ADD_FUNC (suitename, "gnc timespec to iso8601 buff", test_gnc_timespec_to_iso8601_buff);
+    GNC_TEST_ADD_FUNC (suitename, "gnc iso8601 scan fixed", test_gnc_iso8601_scan_fixed);
+    GNC_TEST_ADD_FUNC (suitename, "gnc iso8601 round trip", test_gnc_iso8601_round_trip);
     GNC_TEST_ADD_FUNC (suitename, "gnc timespec2dmy", test_gnc_timespec2dmy);
 // GNC_TEST_ADD_FUNC (suitename, "gnc dmy2timespec internal", test_gnc_dmy2timespec_internal);
     GNC_TEST_ADD_FUNC (suitename, "gnc dmy2timespec", test_gnc_dmy2timespec);
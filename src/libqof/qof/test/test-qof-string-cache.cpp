@@ -77,8 +77,155 @@ test_qof_string_cache( void )
     g_assert(str1_1 != str1_4);
 }
 
+static void
+test_qof_string_cache_insert_many( void )
+{
+    const char *keys[] = { "alpha", "beta", NULL, "alpha", "gamma", "" };
+    const char *cached[G_N_ELEMENTS(keys)];
+    guint i;
+
+    qof_string_cache_insert_many(keys, cached, G_N_ELEMENTS(keys));
+    for (i = 0; i < G_N_ELEMENTS(keys); i++)
+    {
+        if (keys[i] == NULL)
+        {
+            g_assert(cached[i] == NULL);
+            continue;
+        }
+        g_assert(cached[i] != keys[i]);
+        g_assert_cmpstr(cached[i], ==, keys[i]);
+        /* Bulk inserts share strings with single ones */
+        g_assert(qof_string_cache_insert(keys[i]) == cached[i]);
+        qof_string_cache_remove(cached[i]);
+    }
+    g_assert(cached[0] == cached[3]);
+
+    /* The results may overwrite the keys */
+    qof_string_cache_insert_many(keys, keys, G_N_ELEMENTS(keys));
+    for (i = 0; i < G_N_ELEMENTS(keys); i++)
+        g_assert(keys[i] == cached[i]);
+
+    for (i = 0; i < G_N_ELEMENTS(keys); i++)
+    {
+        qof_string_cache_remove(keys[i]);
+        qof_string_cache_remove(cached[i]);
+    }
+}
+
+static void
+test_qof_string_cache_stats( void )
+{
+    QofStringCacheStats stats;
+    const char *str1, *str2;
+
+    qof_string_cache_destroy();
+    qof_string_cache_get_stats(&stats);
+    g_assert_cmpuint(stats.lookups, ==, 0);
+    g_assert_cmpuint(stats.strings, ==, 0);
+    g_assert_cmpuint(stats.bytes, ==, 0);
+
+    str1 = (const char*)qof_string_cache_insert("memo");
+    str2 = (const char*)qof_string_cache_insert("memo");
+    qof_string_cache_insert("action");
+    qof_string_cache_get_stats(&stats);
+    g_assert_cmpuint(stats.lookups, ==, 3);
+    g_assert_cmpuint(stats.hits, ==, 1);
+    g_assert_cmpuint(stats.strings, ==, 2);
+    g_assert_cmpuint(stats.refs, ==, 3);
+    g_assert_cmpuint(stats.bytes, >=, strlen("memo") + strlen("action") + 2);
+    g_assert_cmpuint(stats.table_bytes, >, 0);
+
+    qof_string_cache_remove(str1);
+    qof_string_cache_remove(str2);
+    qof_string_cache_remove("action");
+    qof_string_cache_get_stats(&stats);
+    g_assert_cmpuint(stats.strings, ==, 0);
+    g_assert_cmpuint(stats.refs, ==, 0);
+    g_assert_cmpuint(stats.bytes, ==, 0);
+    g_assert_cmpuint(stats.lookups, ==, 3);
+}
+
+/* Short strings, the most common ones, must not all land in one shard */
+static void
+test_qof_string_cache_shards( void )
+{
+    const char *keys[] = { "", "1", "2", "10", "Buy", "Sell", "abc", "x" };
+    QofStringCacheStats stats;
+    guint i;
+
+    qof_string_cache_destroy();
+    for (i = 0; i < G_N_ELEMENTS(keys); i++)
+        qof_string_cache_insert(keys[i]);
+    qof_string_cache_get_stats(&stats);
+    g_assert_cmpuint(stats.strings, ==, G_N_ELEMENTS(keys));
+    g_assert_cmpuint(stats.shards_used, >=, 4);
+    for (i = 0; i < G_N_ELEMENTS(keys); i++)
+        qof_string_cache_remove(keys[i]);
+}
+
+#define N_THREADS 8
+#define N_ROUNDS 2000
+
+/* Each thread takes and drops references to the same few strings, and
+ * to some of its own, so every shard sees contention. */
+static gpointer
+string_cache_thread( gpointer data )
+{
+    guint id = GPOINTER_TO_UINT(data);
+    gchar name[32];
+    int i;
+
+    for (i = 0; i < N_ROUNDS; i++)
+    {
+        const char *shared, *own;
+
+        g_snprintf(name, sizeof(name), "shared-%d", i % 50);
+        shared = (const char*)qof_string_cache_insert(name);
+        if (g_strcmp0(shared, name) != 0)
+            return GUINT_TO_POINTER(FALSE);
+        g_snprintf(name, sizeof(name), "thread-%u-%d", id, i % 50);
+        own = (const char*)qof_string_cache_insert(name);
+        if (g_strcmp0(own, name) != 0)
+            return GUINT_TO_POINTER(FALSE);
+        qof_string_cache_remove(own);
+        qof_string_cache_remove(shared);
+    }
+    return GUINT_TO_POINTER(TRUE);
+}
+
+static void
+test_qof_string_cache_threads( void )
+{
+    GThread *threads[N_THREADS];
+    QofStringCacheStats stats;
+    const char *anchor;
+    guint i;
+
+    qof_string_cache_destroy();
+    /* Held across the run, so this one string is never freed */
+    anchor = (const char*)qof_string_cache_insert("shared-0");
+
+    for (i = 0; i < N_THREADS; i++)
+        threads[i] = g_thread_new("string-cache", string_cache_thread,
+                                  GUINT_TO_POINTER(i));
+    for (i = 0; i < N_THREADS; i++)
+        g_assert(GPOINTER_TO_UINT(g_thread_join(threads[i])));
+
+    g_assert(qof_string_cache_insert("shared-0") == anchor);
+    qof_string_cache_get_stats(&stats);
+    g_assert_cmpuint(stats.strings, ==, 1);
+    g_assert_cmpuint(stats.refs, ==, 2);
+    g_assert_cmpuint(stats.lookups, ==, 2 * N_THREADS * N_ROUNDS + 2);
+    qof_string_cache_remove(anchor);
+    qof_string_cache_remove(anchor);
+}
+
 void
 test_suite_qof_string_cache ( void )
 {
     GNC_TEST_ADD_FUNC( suitename, "string-cache", test_qof_string_cache);
+    GNC_TEST_ADD_FUNC( suitename, "insert-many", test_qof_string_cache_insert_many);
+    GNC_TEST_ADD_FUNC( suitename, "stats", test_qof_string_cache_stats);
+    GNC_TEST_ADD_FUNC( suitename, "shards", test_qof_string_cache_shards);
+    GNC_TEST_ADD_FUNC( suitename, "threads", test_qof_string_cache_threads);
 }
@@ -280,6 +280,170 @@ test_qof_session_load (Fixture *fixture, gconstpointer pData)
     g_assert (load_session_struct.load_called);
 }
 
+#define ASYNC_LOAD_OBJECTS 200
+
+static struct
+{
+    GThread *main_thread;
+    QofBook *oldbook;
+    QofBook *loading_book;
+    gboolean error;
+    gboolean accounts_ready;
+    gboolean done;
+    double percent;
+    gboolean worker_in_engine;
+    gint main_turns;
+} async_load_struct;
+
+static void
+mock_async_load (QofBackend *be, QofBook *book, QofBackendLoadType type)
+{
+    gint i, turns;
+    gint64 start;
+
+    g_assert (g_thread_self () != async_load_struct.main_thread);
+    g_assert (qof_book_get_backend (book) == be);
+    async_load_struct.loading_book = book;
+    for (i = 0; i < ASYNC_LOAD_OBJECTS; i++)
+    {
+        GncGUID guid;
+
+        /* Load an "object", then report progress */
+        async_load_struct.worker_in_engine = TRUE;
+        guid_new (&guid);
+        async_load_struct.worker_in_engine = FALSE;
+        (be->percentage) (i == 0 ? "loading" : NULL,
+                          (i * 100.0) / ASYNC_LOAD_OBJECTS);
+        if (i == ASYNC_LOAD_OBJECTS / 2)
+            qof_backend_report_load_stage (be, book, QOF_LOAD_STAGE_ACCOUNTS);
+    }
+    /* A long stretch without progress reports still lets the main loop
+     * have its turns */
+    if (!async_load_struct.error)
+    {
+        turns = async_load_struct.main_turns;
+        start = g_get_monotonic_time ();
+        while (async_load_struct.main_turns == turns
+                && g_get_monotonic_time () - start < 10 * G_USEC_PER_SEC)
+        {
+            GncGUID guid;
+
+            async_load_struct.worker_in_engine = TRUE;
+            guid_new (&guid);
+            async_load_struct.worker_in_engine = FALSE;
+            qof_backend_load_yield (be);
+        }
+        g_assert_cmpint (async_load_struct.main_turns, >, turns);
+    }
+    (be->percentage) (NULL, 100.0);
+    if (async_load_struct.error)
+        qof_backend_set_error (be, ERR_BACKEND_DATA_CORRUPT);
+}
+
+/* Stands for whatever else the main loop runs during the load */
+static gboolean
+async_main_loop_user (gpointer data)
+{
+    GncGUID guid;
+
+    g_assert (!async_load_struct.worker_in_engine);
+    guid_new (&guid);
+    async_load_struct.main_turns++;
+    return TRUE;
+}
+
+static void
+async_percentage_fn (const char* message, double percent)
+{
+    g_assert (g_thread_self () == async_load_struct.main_thread);
+    async_load_struct.percent = percent;
+}
+
+static void
+async_accounts_ready (QofSession *session, QofBook *book, gpointer user_data)
+{
+    g_assert (g_thread_self () == async_load_struct.main_thread);
+    g_assert (!async_load_struct.accounts_ready);
+    g_assert (!async_load_struct.done);
+    /* The session doesn't show the new book until it is loaded */
+    g_assert (book == async_load_struct.loading_book);
+    g_assert (qof_session_get_book (session) == async_load_struct.oldbook);
+    g_assert (qof_session_load_in_progress (session));
+    async_load_struct.accounts_ready = TRUE;
+}
+
+static void
+async_done (QofSession *session, QofBook *book, gpointer user_data)
+{
+    g_assert (g_thread_self () == async_load_struct.main_thread);
+    g_assert (user_data == &async_load_struct);
+    g_assert (book == qof_session_get_book (session));
+    g_assert (!qof_session_load_in_progress (session));
+    /* A book which failed to load is still there for done to clean up */
+    g_assert (!qof_book_shutting_down (async_load_struct.loading_book));
+    async_load_struct.done = TRUE;
+}
+
+static void
+test_qof_session_load_async (Fixture *fixture, gconstpointer pData)
+{
+    QofBackend *be = new QofBackend;
+    guint source;
+    gchar *msg = "[qof_session_load_async()] a load is already in progress";
+    gint loglevel = G_LOG_LEVEL_WARNING | G_LOG_FLAG_FATAL;
+    TestErrorStruct check = { loglevel, "qof.session", msg, 0 };
+    GLogFunc hdlr;
+
+    fixture->session->book_id = g_strdup ("my book");
+    fixture->session->backend = be;
+    be->load = mock_async_load;
+    async_load_struct.main_thread = g_thread_self ();
+
+    g_test_message ("Test when no error is produced");
+    async_load_struct.oldbook = qof_session_get_book (fixture->session);
+    async_load_struct.error = FALSE;
+    async_load_struct.accounts_ready = FALSE;
+    async_load_struct.done = FALSE;
+    async_load_struct.main_turns = 0;
+    g_assert (qof_session_load_async (fixture->session, async_percentage_fn,
+                                      async_accounts_ready, async_done,
+                                      &async_load_struct));
+    g_assert (qof_session_load_in_progress (fixture->session));
+    /* Only one load at a time */
+    hdlr = g_log_set_default_handler ((GLogFunc)test_null_handler, &check);
+    g_test_log_set_fatal_handler ((GTestLogFatalFunc)test_checked_handler, &check);
+    g_assert (!qof_session_load_async (fixture->session, NULL, NULL, NULL, NULL));
+    g_assert_cmpint (check.hits, ==, 1);
+    g_log_set_default_handler (hdlr, NULL);
+    /* The main loop keeps running, and takes turns with the worker */
+    source = g_idle_add (async_main_loop_user, NULL);
+    while (!async_load_struct.done)
+        g_main_context_iteration (NULL, TRUE);
+    g_source_remove (source);
+    g_assert_cmpint (async_load_struct.main_turns, >, 0);
+    g_assert (async_load_struct.accounts_ready);
+    g_assert_cmpfloat (async_load_struct.percent, ==, 100.0);
+    g_assert (qof_session_get_book (fixture->session) == async_load_struct.loading_book);
+    g_assert (qof_session_get_error (fixture->session) == ERR_BACKEND_NO_ERR);
+    g_assert (be->percentage == async_percentage_fn);
+    g_assert (be->load_stage == NULL);
+    g_assert (be->load_yield == NULL);
+
+    g_test_message ("Test when an error is produced");
+    async_load_struct.oldbook = qof_session_get_book (fixture->session);
+    async_load_struct.error = TRUE;
+    async_load_struct.accounts_ready = FALSE;
+    async_load_struct.done = FALSE;
+    g_assert (qof_session_load_async (fixture->session, async_percentage_fn,
+                                      async_accounts_ready, async_done,
+                                      &async_load_struct));
+    while (!async_load_struct.done)
+        g_main_context_iteration (NULL, TRUE);
+    g_assert (async_load_struct.accounts_ready);
+    g_assert (qof_session_get_book (fixture->session) == async_load_struct.oldbook);
+    g_assert (qof_session_get_error (fixture->session) == ERR_BACKEND_DATA_CORRUPT);
+}
+
 static struct
 {
     QofBackend *be;
@@ -984,6 +1148,7 @@ test_suite_qofsession ( void )
     GNC_TEST_ADD (suitename, "qof session safe save", Fixture, NULL, setup, test_session_safe_save, teardown);
     GNC_TEST_ADD (suitename, "qof session load backend", Fixture, NULL, setup, test_qof_session_load_backend, teardown);
     GNC_TEST_ADD (suitename, "qof session load", Fixture, NULL, setup, test_qof_session_load, teardown);
+    GNC_TEST_ADD (suitename, "qof session load async", Fixture, NULL, setup, test_qof_session_load_async, teardown);
     GNC_TEST_ADD (suitename, "qof session begin", Fixture, NULL, setup, test_qof_session_begin, teardown);
     GNC_TEST_ADD (suitename, "qof session save", Fixture, NULL, setup, test_qof_session_save, teardown);
     GNC_TEST_ADD (suitename, "qof session destroy backend", Fixture, NULL, setup, test_qof_session_destroy_backend, teardown);
@@ -36,6 +36,7 @@
 #include "gnc-event.h"
 #include "gnc-gconf-utils.h"
 #include "gnc-ledger-display.h"
+#include "gnc-session.h"
 #include "gnc-ui-util.h"
 #include "split-register-control.h"
 #include "split-register-model.h"
@@ -51,7 +52,7 @@ struct gnc_ledger_display
 {
     GncGUID leader;
 
-//    Query *query;
+    Query *query;
 
     GNCLedgerDisplayType ld_type;
 
@@ -83,6 +84,7 @@ gnc_ledger_display_internal (Account *lead_account, /*Query *q,*/
                              gboolean is_template);
 static void gnc_ledger_display_refresh_internal (GNCLedgerDisplay *ld,
         SplitList_t &splits);
+static SplitList_t gnc_ledger_display_run_query (GNCLedgerDisplay *ld);
 
 
 /** Implementations *************************************************/
@@ -582,17 +584,28 @@ refresh_handler (GHashTable *changes, gpointer user_data)
      * changed, requiring a full new query.  Similar considerations
      * needed for multi-user mode.
      */
-//    GList * results = qof_query_run (ld->query);
-//    qof_query_results_into(splits, results);
-    Account *leader = gnc_ledger_display_leader (ld);
-    splits = xaccAccountGetSplitList(leader);
-    
+    splits = gnc_ledger_display_run_query (ld);
+
     gnc_ledger_display_set_watches (ld, splits);
 
     gnc_ledger_display_refresh_internal (ld, splits);
     LEAVE(" ");
 }
 
+/* The splits to show: the query's results, or all of the leader's
+ * splits for the ledgers which have no query. */
+static SplitList_t
+gnc_ledger_display_run_query (GNCLedgerDisplay *ld)
+{
+    SplitList_t splits;
+
+    if (ld->query)
+        qof_query_results_into(splits, qof_query_run (ld->query));
+    else
+        splits = xaccAccountGetSplitList (gnc_ledger_display_leader (ld));
+    return splits;
+}
+
 static void
 close_handler (gpointer user_data)
 {
@@ -609,8 +622,8 @@ close_handler (gpointer user_data)
     gnc_split_register_destroy (ld->reg);
     ld->reg = NULL;
 
-//    qof_query_destroy (ld->query);
-//    ld->query = NULL;
+    qof_query_destroy (ld->query);
+    ld->query = NULL;
 
     g_free (ld);
 }
@@ -639,17 +652,27 @@ gnc_ledger_display_make_query (GNCLedgerDisplay *ld,
         return;
     }
 
-//    qof_query_destroy (ld->query);
-//    ld->query = qof_query_create_for(GNC_ID_SPLIT);
+    /* A book opened with a load window holds only its recent
+     * transactions.  A register that isn't limited to the most recent
+     * splits shows the accounts' whole history, so read the rest now. */
+    if ((limit == 0) || (type == SEARCH_LEDGER))
+        qof_session_ensure_all_data_loaded (gnc_get_current_session ());
+
+    qof_query_destroy (ld->query);
+    ld->query = qof_query_create_for(GNC_ID_SPLIT);
 
     /* This is a bit of a hack. The number of splits should be
      * configurable, or maybe we should go back a time range instead
      * of picking a number, or maybe we should be able to exclude
      * based on reconciled status. Anyway, this works for now. */
-//    if ((limit != 0) && (type != SEARCH_LEDGER))
-//        qof_query_set_max_results (ld->query, limit);
-//
-//    qof_query_set_book (ld->query, gnc_get_current_book());
+    if ((limit != 0) && (type != SEARCH_LEDGER))
+        qof_query_set_max_results (ld->query, limit);
+
+    /* Sorted the way the accounts keep their splits, a limited query
+     * only has to look at the most recent splits of the accounts. */
+    qof_query_set_sort (ld->query, xaccQuerySplitOrder, TRUE);
+
+    qof_query_set_book (ld->query, gnc_get_current_book());
 
     leader = gnc_ledger_display_leader (ld);
 
@@ -659,8 +682,8 @@ gnc_ledger_display_make_query (GNCLedgerDisplay *ld,
 
     accounts.push_front(leader);
 
-//    xaccQueryAddAccountMatch (ld->query, accounts,
-//                              QOF_GUID_MATCH_ANY, QOF_QUERY_AND);
+    xaccQueryAddAccountMatch (ld->query, accounts,
+                              QOF_GUID_MATCH_ANY, QOF_QUERY_AND);
 }
 
 ///* Opens up a ledger window for an arbitrary query. */
@@ -760,7 +783,7 @@ gnc_ledger_display_internal (Account *lead_account, /*Query *q,*/
     ld = g_new (GNCLedgerDisplay, 1);
 
     ld->leader = *xaccAccountGetGUID (lead_account);
-//    ld->query = NULL;
+    ld->query = NULL;
     ld->ld_type = ld_type;
     ld->loading = FALSE;
     ld->destroy = NULL;
@@ -789,10 +812,8 @@ gnc_ledger_display_internal (Account *lead_account, /*Query *q,*/
 
     gnc_split_register_set_data (ld->reg, ld, gnc_ledger_display_parent);
 
-//    GList * results = qof_query_run (ld->query);
-//    qof_query_results_into(splits, results);
-    splits = xaccAccountGetSplitList(lead_account);
-    
+    splits = gnc_ledger_display_run_query (ld);
+
     gnc_ledger_display_set_watches (ld, splits);
 
     gnc_ledger_display_refresh_internal (ld, splits);
@@ -859,11 +880,7 @@ gnc_ledger_display_refresh (GNCLedgerDisplay *ld)
         return;
     }
 
-//    GList * results = qof_query_run (ld->query);
-    SplitList_t res_splits;
-//    qof_query_results_into(res_splits, results);
-    Account *leader = gnc_ledger_display_leader (ld);
-    res_splits = xaccAccountGetSplitList(leader);
+    SplitList_t res_splits = gnc_ledger_display_run_query (ld);
     gnc_ledger_display_refresh_internal (ld, res_splits);
     LEAVE(" ");
 }